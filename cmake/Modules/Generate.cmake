@@ -10,8 +10,31 @@
 # SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
 #
 
+if(CMAKE_SCRIPT_MODE_FILE AND DEFINED IDLC_CHECK_OUTPUTS)
+  # Run before the commands generated for WRITE_IF_CHANGED with Makefile generators:
+  # Make has no rule for recreating a byproduct, so remove the stamp file if one of
+  # its outputs is missing to make idlc run again. Each line of the file lists a
+  # stamp file followed by its outputs.
+  file(STRINGS "${IDLC_CHECK_OUTPUTS}" _lines)
+  foreach(_line ${_lines})
+    string(REPLACE "|" ";" _line "${_line}")
+    list(GET _line 0 _stamp)
+    list(REMOVE_AT _line 0)
+    foreach(_output ${_line})
+      if(NOT EXISTS "${_output}")
+        file(REMOVE "${_stamp}")
+        break()
+      endif()
+    endforeach()
+  endforeach()
+  return()
+endif()
+
+# functions are global, but variables set here aren't visible in sibling directories
+set_property(GLOBAL PROPERTY IDLC_GENERATE_MODULE "${CMAKE_CURRENT_LIST_FILE}")
+
 function(IDLC_GENERATE)
-  set(options NO_TYPE_INFO WERROR)
+  set(options NO_TYPE_INFO WERROR WRITE_IF_CHANGED)
   set(one_value_keywords TARGET DEFAULT_EXTENSIBILITY BASE_DIR OUTPUT_DIR)
   set(multi_value_keywords FILES FEATURES INCLUDES WARNINGS)
   cmake_parse_arguments(
@@ -63,11 +86,15 @@ function(IDLC_GENERATE)
     list(APPEND gen_args WERROR)
   endif()
 
+  if(${IDLC_WRITE_IF_CHANGED})
+    list(APPEND gen_args WRITE_IF_CHANGED)
+  endif()
+
   idlc_generate_generic(${gen_args})
 endfunction()
 
 function(IDLC_GENERATE_GENERIC)
-  set(options NO_TYPE_INFO WERROR)
+  set(options NO_TYPE_INFO WERROR WRITE_IF_CHANGED)
   set(one_value_keywords TARGET BACKEND DEFAULT_EXTENSIBILITY BASE_DIR OUTPUT_DIR)
   set(multi_value_keywords FILES FEATURES INCLUDES WARNINGS SUFFIXES DEPENDS)
   cmake_parse_arguments(
@@ -205,14 +232,51 @@ function(IDLC_GENERATE_GENERIC)
     endforeach()
 
     list(APPEND _outputs ${_file_outputs})
+  endforeach()
+
+  # all files are compiled in a single run of idlc
+  if(NOT IDLC_WRITE_IF_CHANGED)
     add_custom_command(
-      OUTPUT   ${_file_outputs}
+      OUTPUT   ${_outputs}
       COMMAND  ${_idlc_executable}
-      ARGS     ${_language} ${IDLC_ARGS} ${IDLC_INCLUDE_DIRS} ${_file}
+      ARGS     ${_language} ${IDLC_ARGS} ${IDLC_INCLUDE_DIRS} ${_files}
       DEPENDS  ${_files} ${_depends})
-  endforeach()
+    add_custom_target("${_target}_generate" DEPENDS ${_outputs})
+  else()
+    # outputs that do not change keep their modification time, so that what is
+    # compiled from them is not rebuilt, e.g. after a rebuild of idlc. They are
+    # byproducts because they may be older than the inputs, the stamp file tells
+    # whether idlc needs to run again.
+    set(_stamp "${CMAKE_CURRENT_BINARY_DIR}/${_target}_idlc.stamp")
+    add_custom_command(
+      OUTPUT     ${_stamp}
+      BYPRODUCTS ${_outputs}
+      COMMAND    ${_idlc_executable}
+      ARGS       ${_language} ${IDLC_ARGS} -f write-if-changed ${IDLC_INCLUDE_DIRS} ${_files}
+      COMMAND    ${CMAKE_COMMAND} -E touch ${_stamp}
+      DEPENDS    ${_files} ${_depends})
+    add_custom_target("${_target}_generate" DEPENDS ${_stamp})
+    if(CMAKE_GENERATOR MATCHES "Make")
+      # Ninja re-runs a command if a byproduct is missing, Make doesn't. A single
+      # target per directory checks the outputs, to limit the cost of a build in
+      # which nothing changed.
+      get_directory_property(_check_target IDLC_CHECK_OUTPUTS_TARGET)
+      set(_check_list "${CMAKE_CURRENT_BINARY_DIR}/idlc_check_outputs.txt")
+      if(NOT _check_target)
+        set(_check_target "${_target}_check_outputs")
+        get_property(_idlc_generate_module GLOBAL PROPERTY IDLC_GENERATE_MODULE)
+        set_directory_properties(PROPERTIES IDLC_CHECK_OUTPUTS_TARGET ${_check_target})
+        file(WRITE "${_check_list}" "")
+        add_custom_target(${_check_target}
+          COMMAND ${CMAKE_COMMAND} "-DIDLC_CHECK_OUTPUTS=${_check_list}" -P "${_idlc_generate_module}"
+          VERBATIM)
+      endif()
+      string(REPLACE ";" "|" _check_line "${_stamp};${_outputs}")
+      file(APPEND "${_check_list}" "${_check_line}\n")
+      add_dependencies("${_target}_generate" ${_check_target})
+    endif()
+  endif()
 
-  add_custom_target("${_target}_generate" DEPENDS "${_outputs}")
   add_library(${_target} INTERFACE)
   target_sources(${_target} INTERFACE ${_outputs})
   target_include_directories(${_target} INTERFACE "${_dir}")
@@ -235,6 +235,57 @@ DDS_EXPORT bool dds_stream_extract_keyBE_from_data (dds_istream_t *is, dds_ostre
 /** @component cdr_serializer */
 DDS_EXPORT void dds_stream_extract_keyBE_from_key (dds_istream_t *is, dds_ostreamBE_t *os, enum dds_cdr_key_serialization_kind ser_kind, const struct dds_cdrstream_allocator *allocator, const struct dds_cdrstream_desc *desc);
 
+/**
+ * @brief Looks up the member at an offset in the sample
+ * @component cdr_serializer
+ *
+ * The member is identified by the indices of the members to descend into in
+ * the instructions, starting at the top-level type.  Only primitive types,
+ * enums and (bounded) strings in final or appendable types are supported, and
+ * not when they are optional or external or contained in a collection or a
+ * union.
+ *
+ * @param[in] ops Instructions of the type
+ * @param[in] offset Offset of the member in the sample (e.g., from offsetof)
+ * @param[out] path Member indices
+ * @param[out] npath Number of entries in path
+ * @param[in] maxpath Size of path
+ * @returns Address of the ADR instruction of the member or NULL if not supported
+ */
+DDS_EXPORT const uint32_t *dds_stream_member_path (const uint32_t *ops, size_t offset, uint32_t *path, uint32_t *npath, uint32_t maxpath);
+
+/**
+ * @brief Looks up the member identified by a path of member indices
+ * @component cdr_serializer
+ *
+ * The inverse of dds_stream_member_path, for validating a path obtained from
+ * elsewhere (e.g., from a remote reader) against the instructions of a type.
+ *
+ * @param[in] ops Instructions of the type
+ * @param[in] npath Number of entries in path
+ * @param[in] path Member indices
+ * @param[out] offset Offset of the member in the sample
+ * @returns Address of the ADR instruction of the member or NULL if not supported
+ */
+DDS_EXPORT const uint32_t *dds_stream_member_at_path (const uint32_t *ops, uint32_t npath, const uint32_t *path, size_t *offset);
+
+/**
+ * @brief Positions a normalized input stream at the value of a member
+ * @component cdr_serializer
+ *
+ * Skips over the members preceding the one identified by path (see
+ * dds_stream_member_path) without deserializing anything.  On success, the
+ * stream is positioned at the (aligned) value of the member, for strings at
+ * the length.
+ *
+ * @param[in,out] is Input stream, positioned at the start of the data
+ * @param[in] ops Instructions of the type
+ * @param[in] npath Number of entries in path
+ * @param[in] path Member indices
+ * @returns false if the member is not present in the data
+ */
+DDS_EXPORT bool dds_stream_locate_member (dds_istream_t *is, const uint32_t *ops, uint32_t npath, const uint32_t *path);
+
 /** @component cdr_serializer */
 DDS_EXPORT const uint32_t *dds_stream_read (dds_istream_t *is, char *data, const struct dds_cdrstream_allocator *allocator, const uint32_t *ops);
 
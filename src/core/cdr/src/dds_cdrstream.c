@@ -5032,6 +5032,141 @@ void dds_stream_extract_keyBE_from_key (dds_istream_t *is, dds_ostreamBE_t *os,
 
 #endif /* if DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN */
 
+/*******************************************************************************************
+ **
+ **  Locating individual members in serialized data (e.g., for content filters)
+ **
+ *******************************************************************************************/
+
+static bool member_path_supported_type (uint32_t insn)
+{
+  if (op_type_external (insn) || op_type_optional (insn))
+    return false;
+  switch (DDS_OP_TYPE (insn))
+  {
+    case DDS_OP_VAL_BLN: case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY:
+    case DDS_OP_VAL_ENU: case DDS_OP_VAL_STR: case DDS_OP_VAL_BST:
+      return true;
+    default:
+      return false;
+  }
+}
+
+const uint32_t *dds_stream_member_path (const uint32_t *ops, size_t offset, uint32_t *path, uint32_t *npath, uint32_t maxpath)
+{
+  *npath = 0;
+  while (*npath < maxpath)
+  {
+    if (ops[0] == DDS_OP_DLC)
+      ops++;
+    /* members are in the same order in the instructions as in memory, so the
+       member containing offset is the last one that starts at or before it */
+    const uint32_t *member = NULL;
+    uint32_t insn, idx = 0, member_idx = 0;
+    while ((insn = *ops) != DDS_OP_RTS)
+    {
+      /* mutable types (PLC) have no fixed member order in the data */
+      if (DDS_OP (insn) != DDS_OP_ADR)
+        return NULL;
+      if (ops[1] <= offset)
+      {
+        member = ops;
+        member_idx = idx;
+      }
+      ops = dds_stream_skip_adr (insn, ops);
+      idx++;
+    }
+    if (member == NULL)
+      return NULL;
+    path[(*npath)++] = member_idx;
+    insn = member[0];
+    if (DDS_OP_TYPE (insn) == DDS_OP_VAL_EXT && !op_type_external (insn) && !op_type_optional (insn))
+    {
+      offset -= member[1];
+      ops = member + DDS_OP_ADR_JSR (member[2]);
+    }
+    else if (member[1] == offset && member_path_supported_type (insn))
+      return member;
+    else
+      return NULL;
+  }
+  return NULL;
+}
+
+const uint32_t *dds_stream_member_at_path (const uint32_t *ops, uint32_t npath, const uint32_t *path, size_t *offset)
+{
+  *offset = 0;
+  for (uint32_t l = 0; l < npath; l++)
+  {
+    if (ops[0] == DDS_OP_DLC)
+      ops++;
+    for (uint32_t i = 0; i < path[l]; i++)
+    {
+      if (DDS_OP (ops[0]) != DDS_OP_ADR)
+        return NULL;
+      ops = dds_stream_skip_adr (ops[0], ops);
+    }
+    const uint32_t insn = ops[0];
+    if (DDS_OP (insn) != DDS_OP_ADR)
+      return NULL;
+    *offset += ops[1];
+    if (l + 1 == npath)
+      return member_path_supported_type (insn) ? ops : NULL;
+    else if (DDS_OP_TYPE (insn) != DDS_OP_VAL_EXT || op_type_external (insn) || op_type_optional (insn))
+      return NULL;
+    ops += DDS_OP_ADR_JSR (ops[2]);
+  }
+  return NULL;
+}
+
+bool dds_stream_locate_member (dds_istream_t *is, const uint32_t *ops, uint32_t npath, const uint32_t *path)
+{
+  uint32_t end = is->m_size, remain = UINT32_MAX;
+  bool base = false;
+  for (uint32_t l = 0; l < npath; l++)
+  {
+    if (ops[0] == DDS_OP_DLC)
+    {
+      /* base type members follow those of the derived type without a DHEADER */
+      if (!base)
+      {
+        const uint32_t sz = dds_is_get4 (is);
+        end = is->m_index + sz;
+      }
+      ops++;
+    }
+    for (uint32_t i = 0; i < path[l] && is->m_index < end; i++)
+      ops = dds_stream_extract_key_from_data_adr (ops[0], is, NULL, NULL, ops, ops, false, false, 0, &remain);
+    /* an appendable type may have been serialized without the trailing members */
+    if (is->m_index >= end)
+      return false;
+    if (l + 1 < npath)
+    {
+      assert (DDS_OP_TYPE (ops[0]) == DDS_OP_VAL_EXT);
+      base = op_type_base (ops[0]);
+      ops += DDS_OP_ADR_JSR (ops[2]);
+    }
+  }
+  const uint32_t insn = ops[0];
+  uint32_t sz;
+  switch (DDS_OP_TYPE (insn))
+  {
+    case DDS_OP_VAL_BLN: case DDS_OP_VAL_1BY: case DDS_OP_VAL_2BY: case DDS_OP_VAL_4BY: case DDS_OP_VAL_8BY:
+      sz = get_primitive_size (DDS_OP_TYPE (insn));
+      break;
+    case DDS_OP_VAL_ENU:
+      sz = DDS_OP_TYPE_SZ (insn);
+      break;
+    case DDS_OP_VAL_STR: case DDS_OP_VAL_BST:
+      sz = 4;
+      break;
+    default:
+      return false;
+  }
+  dds_cdr_alignto (is, dds_cdr_get_align (is->m_xcdr_version, sz));
+  return is->m_index + sz <= end;
+}
+
 /*******************************************************************************************
  **
  **  Pretty-printing
@@ -1616,6 +1616,7 @@ enum dds_topic_filter_mode {
   DDS_TOPIC_FILTER_SAMPLE_ARG,            /**< Use with \ref dds_topic_filter_sample_arg_fn */
   DDS_TOPIC_FILTER_SAMPLEINFO_ARG,        /**< Use with \ref dds_topic_filter_sampleinfo_arg_fn */
   DDS_TOPIC_FILTER_SAMPLE_SAMPLEINFO_ARG, /**< Use with \ref dds_topic_filter_sample_sampleinfo_arg_fn */
+  DDS_TOPIC_FILTER_PREDICATES,            /**< Set using \ref dds_set_topic_filter_predicates, no filter function */
 };
 
 /**
@@ -1736,6 +1737,84 @@ dds_get_topic_filter_extended (
   dds_entity_t topic,
   struct dds_topic_filter *filter);
 
+/**
+ * @brief Comparison operators for topic filter predicates
+ * @ingroup topic_filter
+ * @warning Unstable API
+ */
+enum dds_topic_filter_op {
+  DDS_TOPIC_FILTER_OP_EQ, /**< member == value */
+  DDS_TOPIC_FILTER_OP_NE, /**< member != value */
+  DDS_TOPIC_FILTER_OP_LT, /**< member < value */
+  DDS_TOPIC_FILTER_OP_LE, /**< member <= value */
+  DDS_TOPIC_FILTER_OP_GT, /**< member > value */
+  DDS_TOPIC_FILTER_OP_GE  /**< member >= value */
+};
+
+/**
+ * @brief Value to compare a member with in a topic filter predicate
+ * @ingroup topic_filter
+ * @warning Unstable API
+ *
+ * Which field is used depends on the type of the member.
+ */
+union dds_topic_filter_value {
+  int64_t i;     /**< For signed integer types and enums */
+  uint64_t u;    /**< For unsigned integer types, octet, char and boolean */
+  double d;      /**< For float and double */
+  const char *s; /**< For strings and bounded strings, compared using strcmp */
+};
+
+/**
+ * @brief Topic filter predicate: comparison of a member of the sample with a constant
+ * @ingroup topic_filter
+ * @warning Unstable API
+ */
+struct dds_topic_filter_predicate {
+  size_t offset;                      /**< Offset of the member in the sample, e.g., offsetof (T, a.b) */
+  enum dds_topic_filter_op op;        /**< Comparison operator */
+  union dds_topic_filter_value value; /**< Value to compare with */
+};
+
+/**
+ * @anchor dds_set_topic_filter_predicates
+ * @brief Sets a filter on a topic consisting of a conjunction of predicates on members
+ * @ingroup topic_filter
+ * @component topic
+ * @warning Unstable API
+ *
+ * Unlike filter functions, a filter consisting of predicates is evaluated on the
+ * serialized representation of the data: only the members that are referenced are
+ * looked at, and there is no need to deserialize the sample.  It replaces any filter
+ * function set on the topic, and vice versa (use \ref dds_set_topic_filter_extended
+ * with mode DDS_TOPIC_FILTER_NONE to remove it).
+ *
+ * The members must be of a primitive type, an enum or a (bounded) string; they must
+ * not be optional or external and not be contained in a collection or a union.  The
+ * types containing them must be final or appendable.  It requires that the topic was
+ * created using a topic descriptor.
+ *
+ * The same restrictions on concurrent use as for \ref dds_set_topic_filter_extended
+ * apply.
+ *
+ * @param[in]  topic        The topic on which the content filter is set.
+ * @param[in]  npredicates  Number of predicates, 0 is the same as removing the filter.
+ * @param[in]  predicates   The predicates, all of which must be satisfied for a sample
+ *                          to pass the filter. Strings are copied.
+ *
+ * @returns A dds_return_t indicating success or failure.
+ *
+ * @retval DDS_RETCODE_OK  Filter set successfully
+ * @retval DDS_RETCODE_BAD_PARAMETER  The topic handle is invalid or a predicate is
+ *             invalid or refers to an unsupported member
+ * @retval DDS_RETCODE_UNSUPPORTED  The topic does not use a topic descriptor
+ */
+DDS_EXPORT dds_return_t
+dds_set_topic_filter_predicates (
+  dds_entity_t topic,
+  uint32_t npredicates,
+  const struct dds_topic_filter_predicate *predicates);
+
 /**
  * @defgroup subscriber (Subscriber)
  * @ingroup subscription
@@ -2532,6 +2611,105 @@ dds_write_ts(
   const void *data,
   dds_time_t timestamp);
 
+/**
+ * @brief Write a batch of samples
+ * @ingroup writing
+ * @component write_data
+ *
+ * Writes the samples in order, as if by consecutive calls to @ref dds_write, but
+ * locking the writer once for the entire batch and deferring the flushing of the
+ * network packets to the end of the batch, so that the samples are packed into as
+ * few messages as possible.  All samples get the same source timestamp.
+ *
+ * The samples may be loans obtained from @ref dds_request_loan, in which case the
+ * loans are returned just like with @ref dds_write.
+ *
+ * Writing stops at the first sample that fails.  The loans of the samples following
+ * the one that failed remain owned by the caller and must be returned with
+ * @ref dds_return_loan.
+ *
+ * @param[in]  writer The writer entity.
+ * @param[in]  data Array of pointers to the samples to be written.
+ * @param[in]  n Number of samples in `data` (<= INT32_MAX).
+ *
+ * @returns The number of samples written (n if all succeeded), or an error code
+ *   if writing the first sample failed.
+ *
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             One of the given arguments is not valid.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The entity has already been deleted.
+ * @retval DDS_RETCODE_TIMEOUT
+ *             The writer failed to write the first sample reliably within the specified max_blocking_time.
+ */
+DDS_EXPORT dds_return_t
+dds_write_n(
+  dds_entity_t writer,
+  const void * const *data,
+  uint32_t n);
+
+/**
+ * @brief Write a batch of samples with the source timestamp passed.
+ * @ingroup writing
+ * @component write_data
+ *
+ * See @ref dds_write_n.
+ *
+ * @param[in]  writer The writer entity.
+ * @param[in]  data Array of pointers to the samples to be written.
+ * @param[in]  n Number of samples in `data` (<= INT32_MAX).
+ * @param[in]  timestamp Source timestamp (>= 0) for all samples.
+ *
+ * @returns The number of samples written (n if all succeeded), or an error code
+ *   if writing the first sample failed.
+ */
+DDS_EXPORT dds_return_t
+dds_write_n_ts(
+  dds_entity_t writer,
+  const void * const *data,
+  uint32_t n,
+  dds_time_t timestamp);
+
+/**
+ * @brief Write a batch of serialized samples
+ * @ingroup writing
+ * @component write_data
+ *
+ * Writes the serialized samples in order, as if by consecutive calls to
+ * @ref dds_writecdr, but locking the writer once for the entire batch and deferring
+ * the flushing of the network packets to the end of the batch.  Timestamp and
+ * statusinfo fields are set to the current time and 0, respectively.
+ *
+ * Writing stops at the first sample that fails.  Like @ref dds_writecdr, it consumes
+ * a reference to each of the serdatas, including those that were not written, unless
+ * it returns DDS_RETCODE_BAD_PARAMETER or fails to lock the writer.
+ *
+ * @param[in]  writer The writer entity.
+ * @param[in]  serdata Array of serialized values to be written.
+ * @param[in]  n Number of entries in `serdata` (<= INT32_MAX).
+ *
+ * @returns The number of samples written (n if all succeeded), or an error code
+ *   if writing the first sample failed.
+ *
+ * @retval DDS_RETCODE_ERROR
+ *             An internal error has occurred.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             One of the given arguments is not valid.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The entity has already been deleted.
+ * @retval DDS_RETCODE_TIMEOUT
+ *             The writer failed to write the first sample reliably within the specified max_blocking_time.
+ */
+DDS_EXPORT dds_return_t
+dds_writecdr_n(
+  dds_entity_t writer,
+  struct ddsi_serdata **serdata,
+  uint32_t n);
+
 /**
  * @defgroup readcondition (ReadCondition)
  * @ingroup condition
@@ -2640,6 +2818,45 @@ dds_create_querycondition(
   uint32_t mask,
   dds_querycondition_filter_fn filter);
 
+/**
+ * @brief Creates a querycondition with a filter on the key fields only
+ * @ingroup querycondition
+ * @component data_query
+ *
+ * The same as @ref dds_create_querycondition, except that the application
+ * declares that the filter only depends on the key fields of the sample. The
+ * filter is then only evaluated once for each instance, on a sample in which
+ * only the key fields are set, and the outcome applies to all samples of that
+ * instance.
+ *
+ * This avoids deserializing and filtering every incoming sample, and the reader
+ * keeps an index of the matching instances so that reading or taking through
+ * the condition only visits those instances. This makes a big difference for
+ * readers with many instances and conditions selecting a few of them.
+ *
+ * The result is undefined if the filter depends on non-key fields.
+ *
+ * @param[in]  reader  Reader to associate the condition to.
+ * @param[in]  mask    Interest (dds_sample_state_t|dds_view_state_t|dds_instance_state_t).
+ * @param[in]  filter  Callback that the application can use to filter specific instances.
+ *
+ * @returns A valid condition handle or an error code
+ *
+ * @retval >=0
+ *             A valid condition handle.
+ * @retval DDS_RETCODE_ERROR
+ *             An internal error has occurred.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The entity has already been deleted.
+ */
+DDS_EXPORT dds_entity_t
+dds_create_key_querycondition(
+  dds_entity_t reader,
+  uint32_t mask,
+  dds_querycondition_filter_fn filter);
+
 /**
  * @brief Creates a guardcondition.
  * @ingroup guardcondition
@@ -3069,6 +3286,46 @@ dds_waitset_wait_until(
   size_t nxs,
   dds_time_t abstimeout);
 
+/**
+ * @brief Get a file descriptor that is readable when the waitset has triggered
+ * @ingroup waitset
+ * @component waitset
+ *
+ * This allows integrating a waitset in an application's own event loop (e.g.,
+ * one based on poll, epoll or io_uring) without needing a separate thread that
+ * blocks in dds_waitset_wait.  The descriptor is created on the first call and
+ * owned by the waitset: it must not be closed or read by the application and
+ * remains valid until the waitset is deleted.
+ *
+ * The descriptor becomes readable when one of the attached entities triggers.
+ * It is reset by dds_waitset_wait/dds_waitset_wait_until when those find that
+ * none of the attached entities is triggered anymore.  The intended use is
+ * therefore: when it is readable, call dds_waitset_wait with a 0 timeout,
+ * handle the triggered entities and repeat until that returns 0.
+ *
+ * @param[in]  waitset  The waitset.
+ * @param[out] fd       Where to store the file descriptor.
+ *
+ * @returns A dds_return_t indicating success or failure.
+ *
+ * @retval DDS_RETCODE_OK
+ *             Success, fd set.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             The given waitset is not valid or fd is a null pointer.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The waitset has already been deleted.
+ * @retval DDS_RETCODE_OUT_OF_RESOURCES
+ *             Creating the file descriptor failed.
+ * @retval DDS_RETCODE_UNSUPPORTED
+ *             The platform has no suitable file descriptors (e.g., Windows).
+ */
+DDS_EXPORT dds_return_t
+dds_waitset_get_fd(
+  dds_entity_t waitset,
+  int *fd);
+
 /**
  * @defgroup reading (Reading Data)
  * @ingroup reader
@@ -4257,6 +4514,125 @@ dds_take_with_collector (
   dds_read_with_collector_fn_t collect_sample,
   void *collect_sample_arg);
 
+/**
+ * @brief Function deserializing the sample at the given index in a deferred read/take
+ * @ingroup reading
+ *
+ * @param[in] job_arg Argument passed to the executor
+ * @param[in] index Index of the sample to deserialize (0 .. njobs-1)
+ */
+typedef void (*dds_deserialize_job_fn_t) (void *job_arg, uint32_t index);
+
+/**
+ * @brief Function type for executing the deserialization jobs of a deferred read/take
+ * @ingroup reading
+ *
+ * This allows the application to deserialize the samples returned by @ref dds_read_deferred
+ * and @ref dds_take_deferred in parallel, using whatever thread pool it has available.  The
+ * function must call `job (job_arg, i)` exactly once for each `i` in `0 .. njobs-1`, in any
+ * order and on any thread, and may only return once all these calls have completed.  The
+ * jobs do not depend on each other, do not call Cyclone DDS API functions and only write
+ * to the sample at their own index.
+ *
+ * @param[in] executor_arg Argument passed to read/take
+ * @param[in] njobs Number of jobs (> 0)
+ * @param[in] job Function to call for each job
+ * @param[in] job_arg Argument to pass to job
+ */
+typedef void (*dds_deserialize_executor_fn_t) (void *executor_arg, uint32_t njobs, dds_deserialize_job_fn_t job, void *job_arg);
+
+/**
+ * @brief Read samples, deserializing them after releasing the history cache
+ * @ingroup reading
+ * @component read_data
+ *
+ * Behaves like @ref dds_read_mask with application-provided memory, except that it only
+ * collects references to the serialized samples and the sample infos while holding the
+ * reader history cache lock.  The samples are deserialized into `buf` after releasing the
+ * lock, so that incoming data is not blocked by the cost of deserialization.  This makes a
+ * difference when reading large batches of samples or expensive types.
+ *
+ * The deserialization is done using `executor` if it is not a null pointer, else by the
+ * calling thread.
+ *
+ * Loans are not supported: `buf` must be fully initialized with pointers to samples owned
+ * by the application.
+ *
+ * @param[in] reader_or_condition Handle of a reader or a read/query condition
+ * @param[in,out] buf An array of pointers to samples into which data is read
+ * @param[out] si Pointer to an array of @ref dds_sample_info_t returned for each data value
+ * @param[in] bufsz The size of buffer provided
+ * @param[in] maxs Maximum number of samples to read
+ * @param[in] mask Filter the data based on dds_sample_state_t|dds_view_state_t|dds_instance_state_t
+ * @param[in] executor Function for executing the deserialization jobs, or NULL
+ * @param[in] executor_arg Argument passed to executor
+ * @return The number of samples read or an error code
+ * @retval >= 0 number of samples read
+ * @retval DDS_RETCODE_ERROR
+ *             Deserialization of the first sample failed.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             One of the given arguments is not valid.
+ * @retval DDS_RETCODE_PRECONDITION_NOT_MET
+ *             The buffer contains loaned samples.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The entity has already been deleted.
+ */
+DDS_EXPORT dds_return_t
+dds_read_deferred (
+  dds_entity_t reader_or_condition,
+  void **buf,
+  dds_sample_info_t *si,
+  size_t bufsz,
+  uint32_t maxs,
+  uint32_t mask,
+  dds_deserialize_executor_fn_t executor,
+  void *executor_arg);
+
+/**
+ * @brief Take samples, deserializing them after releasing the history cache
+ * @ingroup reading
+ * @component read_data
+ *
+ * Behaves like @ref dds_take_mask with application-provided memory, otherwise the same as
+ * @ref dds_read_deferred.
+ *
+ * If deserializing a sample fails, the result is truncated to the samples preceding it;
+ * the remaining samples have been removed from the reader history cache nonetheless.
+ *
+ * @param[in] reader_or_condition Handle of a reader or a read/query condition
+ * @param[in,out] buf An array of pointers to samples into which data is read
+ * @param[out] si Pointer to an array of @ref dds_sample_info_t returned for each data value
+ * @param[in] bufsz The size of buffer provided
+ * @param[in] maxs Maximum number of samples to take
+ * @param[in] mask Filter the data based on dds_sample_state_t|dds_view_state_t|dds_instance_state_t
+ * @param[in] executor Function for executing the deserialization jobs, or NULL
+ * @param[in] executor_arg Argument passed to executor
+ * @return The number of samples taken or an error code
+ * @retval >= 0 number of samples taken
+ * @retval DDS_RETCODE_ERROR
+ *             Deserialization of the first sample failed.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             One of the given arguments is not valid.
+ * @retval DDS_RETCODE_PRECONDITION_NOT_MET
+ *             The buffer contains loaned samples.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The entity has already been deleted.
+ */
+DDS_EXPORT dds_return_t
+dds_take_deferred (
+  dds_entity_t reader_or_condition,
+  void **buf,
+  dds_sample_info_t *si,
+  size_t bufsz,
+  uint32_t maxs,
+  uint32_t mask,
+  dds_deserialize_executor_fn_t executor,
+  void *executor_arg);
+
 /**
  * @anchor DDS_HAS_READCDR
  * @ingroup reading
@@ -194,6 +194,67 @@ DDS_EXPORT dds_return_t dds_reader_store_loaned_sample (dds_entity_t reader, dds
 DDS_EXPORT dds_return_t dds_reader_store_loaned_sample_wr_metadata (dds_entity_t reader, dds_loaned_sample_t *data, int32_t ownership_strength, bool autodispose_unregistered_instances, dds_duration_t lifespan_duration)
   ddsrt_nonnull_all;
 
+/**
+ * @brief insert data from a batch of loaned samples into the reader history cache
+ * @ingroup reading
+ *
+ * Equivalent to calling `dds_reader_store_loaned_sample` for each of the `n` samples in
+ * `data`, in order, but the reader and its history cache are locked only once for (up to
+ * 32 samples of) the batch and readers waiting for data, listeners and waitsets are
+ * notified once rather than for every sample.
+ *
+ * The caller retains its references to the loaned samples.
+ *
+ * @param[in] reader The reader entity.
+ * @param[in] n The number of loaned samples in `data`
+ * @param[in] data Array of pointers to the loaned samples received
+ *
+ * @returns A dds_return_t indicating success or failure.
+ *
+ * @retval DDS_RETCODE_OK
+ *             All samples were stored successfully.
+ * @retval DDS_RETCODE_ERROR
+ *             One or more samples could not be stored, the other samples have been stored.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             One or more parameters are invalid.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The reader entity has already been deleted.
+ */
+DDS_EXPORT dds_return_t dds_reader_store_loaned_samples (dds_entity_t reader, uint32_t n, dds_loaned_sample_t * const *data)
+  ddsrt_nonnull_all;
+
+/**
+ * @brief insert data from a batch of loaned samples into the reader history cache using the provided writer meta-data
+ * @ingroup reading
+ *
+ * Batched version of `dds_reader_store_loaned_sample_wr_metadata`, see
+ * `dds_reader_store_loaned_samples`.  The writer meta-data applies to all samples.
+ *
+ * @param[in] reader The reader entity.
+ * @param[in] n The number of loaned samples in `data`
+ * @param[in] data Array of pointers to the loaned samples received
+ * @param[in] ownership_strength The ownership strength of the writer
+ * @param[in] autodispose_unregistered_instances Writer setting for auto-disposing unregistered entities
+ * @param[in] lifespan_duration Lifespan duration value configured for the writer
+ *
+ * @returns A dds_return_t indicating success or failure.
+ *
+ * @retval DDS_RETCODE_OK
+ *             All samples were stored successfully.
+ * @retval DDS_RETCODE_ERROR
+ *             One or more samples could not be stored, the other samples have been stored.
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             One or more parameters are invalid.
+ * @retval DDS_RETCODE_ILLEGAL_OPERATION
+ *             The operation is invoked on an inappropriate object.
+ * @retval DDS_RETCODE_ALREADY_DELETED
+ *             The reader entity has already been deleted.
+ */
+DDS_EXPORT dds_return_t dds_reader_store_loaned_samples_wr_metadata (dds_entity_t reader, uint32_t n, dds_loaned_sample_t * const *data, int32_t ownership_strength, bool autodispose_unregistered_instances, dds_duration_t lifespan_duration)
+  ddsrt_nonnull_all;
+
 #if defined(__cplusplus)
 }
 #endif
@@ -553,6 +553,20 @@ typedef dds_loaned_sample_t * (*dds_psmx_endpoint_take_fn) (struct dds_psmx_endp
  * ```
  * (alternatively calling `dds_reader_store_loaned_sample_wr_metadata` for each sample)
  *
+ * Plugins that have multiple samples available at once should preferably deliver them in
+ * batches, as in:
+ * ```
+ *   dds_loaned_sample_t *ls[N];
+ *   uint32_t n = 0;
+ *   while (n < N && (ls[n] = dds_psmx_endpoint_ops.take(psmx_endpoint)) != NULL)
+ *     n++;
+ *   dds_reader_store_loaned_samples(reader, n, ls);
+ *   for (uint32_t i = 0; i < n; i++)
+ *     dds_loaned_sample_unref(ls[i]);
+ * ```
+ * as that amortizes the locking of the reader history cache and the triggering of
+ * listeners and waitsets over the batch.
+ *
  * @param[in] psmx_endpoint    The PSMX Reader on which to enable asynchronous delivery
  * @param[in] reader           The DDS Reader to which the data is to be delivered
  * @returns a DDS return code
@@ -29,6 +29,8 @@ struct ddsi_tkmap;
 typedef dds_return_t (*dds_rhc_associate_t) (struct dds_rhc *rhc, struct dds_reader *reader, const struct ddsi_sertype *type, struct ddsi_tkmap *tkmap);
 typedef int32_t (*dds_rhc_read_take_t) (struct dds_rhc *rhc, int32_t max_samples, uint32_t mask, dds_instance_handle_t handle, struct dds_readcond *cond, dds_read_with_collector_fn_t collect_sample, void *collect_sample_arg);
 
+typedef void (*dds_rhc_store_n_t) (struct dds_rhc *rhc, uint32_t n, const struct ddsi_writer_info *wr_info, struct ddsi_serdata * const *samples, struct ddsi_tkmap_instance * const *tks, bool *delivered);
+
 typedef bool (*dds_rhc_add_readcondition_t) (struct dds_rhc *rhc, struct dds_readcond *cond);
 typedef void (*dds_rhc_remove_readcondition_t) (struct dds_rhc *rhc, struct dds_readcond *cond);
 
@@ -42,6 +44,7 @@ struct dds_rhc_ops {
   dds_rhc_add_readcondition_t add_readcondition;
   dds_rhc_remove_readcondition_t remove_readcondition;
   dds_rhc_associate_t associate;
+  dds_rhc_store_n_t store_n; /**< may be null, in which case samples are stored one at a time */
 };
 
 struct dds_rhc {
@@ -63,6 +66,17 @@ DDS_INLINE_EXPORT inline bool dds_rhc_store (struct dds_rhc *rhc, const struct d
   return rhc->common.ops->rhc_ops.store (&rhc->common.rhc, wr_info, sample, tk);
 }
 
+/** @component rhc */
+DDS_INLINE_EXPORT inline void dds_rhc_store_n (struct dds_rhc *rhc, uint32_t n, const struct ddsi_writer_info *wr_info, struct ddsi_serdata * const *samples, struct ddsi_tkmap_instance * const *tks, bool *delivered) {
+  if (rhc->common.ops->store_n)
+    rhc->common.ops->store_n (rhc, n, wr_info, samples, tks, delivered);
+  else
+  {
+    for (uint32_t i = 0; i < n; i++)
+      delivered[i] = rhc->common.ops->rhc_ops.store (&rhc->common.rhc, &wr_info[i], samples[i], tks[i]);
+  }
+}
+
 /** @component rhc */
 DDS_INLINE_EXPORT inline void dds_rhc_unregister_wr (struct dds_rhc *rhc, const struct ddsi_writer_info *wr_info) {
   rhc->common.ops->rhc_ops.unregister_wr (&rhc->common.rhc, wr_info);
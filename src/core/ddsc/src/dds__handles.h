@@ -39,8 +39,11 @@ struct dds_entity;
  * handle. This will not remove any information within the handleserver, it just prevents
  * new claims. The delete will actually free handleserver internal memory.
  *
- * There's currently a global lock in the handle server that is used with every API call.
- * Maybe the internals can be improved to circumvent the need for that...
+ * Claiming and releasing a handle is lock-free: the handle is an index into a table of
+ * slots plus a generation counter, the lock is only used for creating and deleting
+ * handles and for waking up a thread waiting for the claims to be released.  The index
+ * and the generation share 31 bits, which limits the number of handles that can exist
+ * at the same time to ~4M (see dds_handles.c).
  */
 
 
@@ -18,6 +18,7 @@ extern "C" {
 #endif
 
 struct dds_loaned_sample;
+struct dds_heap_loan_pool;
 
 dds_return_t dds_heap_loan (const struct ddsi_sertype *type, dds_loaned_sample_state_t sample_state, struct dds_loaned_sample **loaned_sample)
   ddsrt_nonnull_all;
@@ -25,6 +26,46 @@ dds_return_t dds_heap_loan (const struct ddsi_sertype *type, dds_loaned_sample_s
 void dds_heap_loan_reset (struct dds_loaned_sample *loaned_sample)
   ddsrt_nonnull_all;
 
+/**
+ * @brief Create a pool for recycling heap loans of a type
+ *
+ * Heap loans allocated from the pool return to it when their last reference is dropped,
+ * from whatever thread that happens, up to `max_cached` of them.  The pool is reference
+ * counted by its loans and so may outlive its owner.
+ *
+ * @param[out] ppool the new pool
+ * @param[in] type type of the samples, all loans have the same size
+ * @param[in] max_cached maximum number of unused loans retained for reuse
+ * @return a DDS return code
+ */
+dds_return_t dds_heap_loan_pool_create (struct dds_heap_loan_pool **ppool, const struct ddsi_sertype *type, uint32_t max_cached)
+  ddsrt_nonnull_all;
+
+/**
+ * @brief Releases the owner's reference to a heap loan pool, freeing all cached loans
+ *
+ * @param[in] pool the pool
+ */
+void dds_heap_loan_pool_free (struct dds_heap_loan_pool *pool)
+  ddsrt_nonnull_all;
+
+/**
+ * @brief Get a heap loan from a pool, allocating a new one if none is available
+ *
+ * @param[in] pool the pool
+ * @param[in] sample_state initial sample state
+ * @param[out] loaned_sample the loan
+ * @return a DDS return code
+ */
+dds_return_t dds_heap_loan_from_pool (struct dds_heap_loan_pool *pool, dds_loaned_sample_state_t sample_state, struct dds_loaned_sample **loaned_sample)
+  ddsrt_nonnull_all;
+
+/**
+ * @brief Number of loans obtained from a pool that were recycled (hits) and newly allocated (misses)
+ */
+void dds_heap_loan_pool_stats (struct dds_heap_loan_pool *pool, uint64_t *hits, uint64_t *misses)
+  ddsrt_nonnull_all;
+
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,77 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDS__LISTENER_DISPATCH_H
+#define DDS__LISTENER_DISPATCH_H
+
+#include "dds__types.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Creates and starts the listener threads for a domain
+ * @component entity_listener
+ *
+ * @param[in] gv        domain, for the thread properties
+ * @param[in] nthreads  number of threads, must be > 0
+ * @returns the new instance or NULL on failure to create the threads
+ */
+struct dds_listener_dispatch *dds_listener_dispatch_new (const struct ddsi_domaingv *gv, uint32_t nthreads);
+
+/**
+ * @brief Stops the listener threads and frees the instance
+ * @component entity_listener
+ *
+ * All entities of the domain must have been deleted already, which means the queue is empty.
+ *
+ * @param[in] ld  instance to free
+ */
+void dds_listener_dispatch_free (struct dds_listener_dispatch *ld);
+
+/**
+ * @brief Queues a status change for invoking the listener on a listener thread
+ * @component entity_listener
+ *
+ * The entity stays queued at most once: further status changes are combined with the pending
+ * one, also while a listener thread is handling it, so it never occupies more than one
+ * listener thread.  While queued, the entity's `m_cb_pending_count` is incremented, so listener changes
+ * and deletion wait for it to be handled (or cancelled).  The listener threads invoke the
+ * listeners through `dds_entity_deriver_invoke_cbs_for_pending_events`, like `dds_set_listener`
+ * does for events that occurred before the listener was set.  The caller is therefore
+ * responsible for setting the status and triggering waitsets.
+ *
+ * @note expects `e->m_observers_lock` to be held
+ *
+ * @param[in] e       entity for which the status changed
+ * @param[in] status  status mask
+ * @returns false if listeners are invoked synchronously in this domain, true if queued
+ */
+bool dds_listener_dispatch_enqueue (struct dds_entity *e, uint32_t status);
+
+/**
+ * @brief Removes an entity from the queue
+ * @component entity_listener
+ *
+ * For deleting an entity: it removes the need for waiting until it is processed, which
+ * could deadlock if the entity is deleted from a listener running on the only listener
+ * thread.  An invocation that is already in progress is unaffected.
+ *
+ * @note expects `e->m_observers_lock` to be held
+ *
+ * @param[in] e  entity to remove
+ */
+void dds_listener_dispatch_cancel (struct dds_entity *e);
+
+#if defined (__cplusplus)
+}
+#endif
+#endif /* DDS__LISTENER_DISPATCH_H */
@@ -76,6 +76,16 @@ dds_return_t dds_loan_pool_add_loan (dds_loan_pool_t *pool, dds_loaned_sample_t
 dds_loaned_sample_t *dds_loan_pool_find_and_remove_loan (dds_loan_pool_t *pool, const void *sample_ptr)
   ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
 
+/**
+ * @brief Checks whether a sample pointer refers to a loan in the loan pool
+ *
+ * @param[in] pool  Loan pool to search
+ * @param[in] sample_ptr  Pointer of the sample to search for
+ * @return true iff the pool contains a loan for `sample_ptr`
+ */
+bool dds_loan_pool_contains_loan (const dds_loan_pool_t *pool, const void *sample_ptr)
+  ddsrt_nonnull_all ddsrt_attribute_warn_unused_result;
+
 /**
  * @brief Gets the first loan from this pool and removes it from the pool
  *
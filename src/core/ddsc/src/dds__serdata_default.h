@@ -146,6 +146,16 @@ struct dds_serdatapool * dds_serdatapool_new (void);
 /** @component typesupport_c */
 void dds_serdatapool_free (struct dds_serdatapool * pool);
 
+/**
+ * @brief Initializes an input stream for the serialized data in a serdata of the default type
+ * @component typesupport_c
+ *
+ * @param[in] serdata_common serdata, must contain data and not just a key
+ * @param[out] is input stream, positioned at the start of the data
+ * @returns false if the serdata only has a raw sample (in a loan) rather than serialized data
+ */
+bool dds_serdata_default_istream (const struct ddsi_serdata *serdata_common, dds_istream_t *is);
+
 /** @component typesupport_c */
 dds_return_t dds_sertype_default_init (const struct dds_domain *domain, struct dds_sertype_default *st, const dds_topic_descriptor_t *desc, uint16_t min_xcdrv, dds_data_representation_id_t data_representation);
 
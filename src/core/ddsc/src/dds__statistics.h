@@ -27,9 +27,26 @@ struct dds_stat_descriptor {
   const struct dds_stat_keyvalue_descriptor *kv;
 };
 
+/* Key-value descriptors for the summary of a stage latency histogram, all
+   values are in nanoseconds */
+#define DDS_STAT_LATENCY_KV(stage) \
+  { "latency_" stage "_count", DDS_STAT_KIND_UINT64 }, \
+  { "latency_" stage "_p50", DDS_STAT_KIND_UINT64 }, \
+  { "latency_" stage "_p90", DDS_STAT_KIND_UINT64 }, \
+  { "latency_" stage "_p99", DDS_STAT_KIND_UINT64 }, \
+  { "latency_" stage "_max", DDS_STAT_KIND_UINT64 }
+
+#define DDS_STAT_LATENCY_NKV 5
+
+struct ddsi_lathist;
+
 /** @component statistics */
 struct dds_statistics *dds_alloc_statistics (const struct dds_entity *e, const struct dds_stat_descriptor *d);
 
+/** @brief Fills DDS_STAT_LATENCY_NKV entries starting at kv from a histogram, h may be NULL
+ * @component statistics */
+void dds_stat_fill_latency (struct dds_stat_keyvalue *kv, const struct ddsi_lathist *h);
+
 #if defined (__cplusplus)
 }
 #endif
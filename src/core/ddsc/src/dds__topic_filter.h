@@ -0,0 +1,66 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDS__TOPIC_FILTER_H
+#define DDS__TOPIC_FILTER_H
+
+#include "dds__types.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#define DDS_TOPIC_FILTER_MAX_DEPTH 8
+
+/* Predicate compiled against the serializer instructions of the type */
+struct dds_topic_filter_cpred {
+  uint32_t insn;   /* ADR instruction of the member */
+  uint32_t offset; /* for evaluating on samples */
+  enum dds_topic_filter_op op;
+  union dds_topic_filter_value value; /* string is owned */
+  uint32_t npath;
+  uint32_t path[DDS_TOPIC_FILTER_MAX_DEPTH];
+};
+
+struct dds_topic_filter_predicates {
+  const uint32_t *ops;
+  uint32_t n;
+  struct dds_topic_filter_cpred p[];
+};
+
+/** @component topic */
+dds_return_t dds_topic_filter_predicates_compile (struct dds_topic_filter_predicates **compiled, const struct ddsi_sertype *st, uint32_t npredicates, const struct dds_topic_filter_predicate *predicates);
+
+/** @component topic */
+void dds_topic_filter_predicates_free (struct dds_topic_filter_predicates *compiled);
+
+/** @component topic */
+bool dds_topic_filter_predicates_accept_serdata (const struct dds_topic_filter_predicates *compiled, const struct ddsi_serdata *sd);
+
+/** @component topic */
+bool dds_topic_filter_predicates_accept_sample (const struct dds_topic_filter_predicates *compiled, const void *sample);
+
+/** @component topic */
+struct ddsi_content_filter_property *dds_topic_filter_predicates_to_property (const char *topic_name, const struct dds_topic_filter_predicates *compiled);
+
+/** @component topic */
+struct ddsi_sertype_content_filter *dds_topic_filter_content_filter_new (const struct ddsi_sertype *st, const struct ddsi_content_filter_property *cfp);
+
+/** @component topic */
+struct ddsi_content_filter_property *dds_topic_filter_reader_content_filter (struct dds_topic *tp);
+
+/** @component topic */
+void dds_topic_filter_update_reader_content_filter (struct dds_reader *rd);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDS__TOPIC_FILTER_H */
@@ -15,6 +15,7 @@
 
 #include "dds/dds.h"
 #include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/eventfd.h"
 #include "dds/ddsi/ddsi_protocol.h"
 #include "dds/ddsi/ddsi_domaingv.h"
 #ifdef DDS_HAS_TOPIC_DISCOVERY
@@ -44,6 +45,8 @@ struct dds_readcond;
 struct dds_guardcond;
 struct dds_statuscond;
 struct dds_loan_pool;
+struct dds_heap_loan_pool;
+struct ddsi_lathist;
 
 struct ddsi_sertype;
 struct ddsi_rhc;
@@ -122,14 +125,16 @@ typedef struct dds_entity_deriver {
 } dds_entity_deriver;
 
 struct dds_waitset;
-typedef void (*dds_entity_callback_t) (struct dds_waitset *observer, dds_entity_t observed);
-typedef bool (*dds_entity_attach_callback_t) (struct dds_waitset *observer, struct dds_entity *observed, void *attach_arg);
-typedef void (*dds_entity_delete_callback_t) (struct dds_waitset *observer, dds_entity_t observed);
+struct dds_attachment;
+typedef void (*dds_entity_callback_t) (struct dds_waitset *observer, struct dds_attachment *attachment);
+typedef struct dds_attachment * (*dds_entity_attach_callback_t) (struct dds_waitset *observer, struct dds_entity *observed, void *attach_arg);
+typedef void (*dds_entity_delete_callback_t) (struct dds_waitset *observer, struct dds_attachment *attachment);
 
 typedef struct dds_entity_observer {
   dds_entity_callback_t m_cb;
   dds_entity_delete_callback_t m_delete_cb;
   struct dds_waitset *m_observer;
+  struct dds_attachment *m_attachment; /* owned by m_observer, valid until m_delete_cb */
   struct dds_entity_observer *m_next;
 } dds_entity_observer;
 
@@ -168,6 +173,9 @@ typedef struct dds_entity {
   uint32_t m_cb_count;              /* [m_observers_lock] */
   uint32_t m_cb_pending_count;      /* [m_observers_lock] */
   dds_entity_observer *m_observers; /* [m_observers_lock] */
+  uint32_t m_dispatch_status;       /* [m_observers_lock] events queued for the listener threads */
+  bool m_dispatch_busy;             /* [m_observers_lock] queued or being handled by a listener thread */
+  struct dds_entity *m_dispatch_next; /* [listener dispatch lock] */
 } dds_entity;
 
 extern const ddsrt_avl_treedef_t dds_topictree_def;
@@ -316,6 +324,9 @@ typedef struct dds_domain {
   struct dds_serdatapool *serpool;
 
   struct dds_psmx_set psmx_instances;
+
+  /* Listener threads, NULL if listeners are invoked synchronously */
+  struct dds_listener_dispatch *listener_dispatch;
 } dds_domain;
 
 typedef struct dds_subscriber {
@@ -405,6 +416,11 @@ typedef struct dds_reader {
   struct dds_loan_pool *m_loans; /* administration of outstanding loans */
   struct dds_loan_pool *m_heap_loan_cache;
 
+  /* Stage latency histograms, NULL unless enabled in the configuration */
+  struct ddsi_lathist *m_lathist_rhc; /* storing a sample in the default RHC */
+  struct ddsi_lathist *m_lathist_listener; /* invoking the data available listener */
+  struct ddsi_lathist *m_lathist_take; /* time from storing until first read/take */
+
   /* Status metrics */
   dds_sample_rejected_status_t m_sample_rejected_status;
   dds_liveliness_changed_status_t m_liveliness_changed_status;
@@ -423,7 +439,9 @@ typedef struct dds_writer {
   struct ddsi_whc *m_whc; /* FIXME: ownership still with underlying DDSI writer (cos of DDSI built-in writers )*/
   bool whc_batch; /* FIXME: channels + latency budget */
   struct dds_loan_pool *m_loans; /* administration of associated loans */
+  struct dds_heap_loan_pool *m_heap_loan_pool; /* recycled heap loans */
   ddsi_protocol_version_t protocol_version; /* copy of configured protocol version */
+  struct ddsi_lathist *m_lathist_serialize; /* stage latency histogram, NULL unless enabled */
 
   /* Status metrics */
 
@@ -439,6 +457,7 @@ typedef struct dds_topic {
   struct ddsi_sertype *m_stype;
   struct dds_ktopic *m_ktopic; /* refc'd, constant */
   struct dds_topic_filter m_filter;
+  struct dds_topic_filter_predicates *m_filter_preds; /* compiled filter if mode = PREDICATES */
   dds_inconsistent_topic_status_t m_inconsistent_topic_status; /* Status metrics */
 } dds_topic;
 
@@ -454,6 +473,8 @@ typedef struct dds_readcond {
   struct {
     dds_querycondition_filter_fn m_filter;
     dds_querycond_mask_t m_qcmask; /* condition mask in RHC*/
+    bool m_key_only; /* filter only depends on the key fields */
+    struct ddsrt_hh *m_index; /* [RHC lock] instances matching a key-only filter, maintained by RHC */
   } m_query;
 } dds_readcond;
 
@@ -465,6 +486,7 @@ typedef struct dds_attachment {
   dds_entity *entity;
   dds_entity_t handle;
   dds_attach_t arg;
+  size_t index;             /* [wait_lock] position in waitset's entities array */
 } dds_attachment;
 
 typedef struct dds_waitset {
@@ -477,7 +499,15 @@ typedef struct dds_waitset {
   ddsrt_cond_t wait_cond;
   size_t nentities;         /* [wait_lock] */
   size_t ntriggered;        /* [wait_lock] */
-  dds_attachment *entities; /* [wait_lock] 0 .. ntriggered are triggred, ntriggred .. nentities are not */
+  dds_attachment **entities; /* [wait_lock] 0 .. ntriggered are triggred, ntriggred .. nentities are not */
+
+#if DDSRT_HAVE_EVENTFD
+  /* Optional file descriptor for integrating with poll/epoll, created on first request;
+     readable while ntriggered > 0 (as far as the waitset knows, see dds_waitset_get_fd) */
+  bool have_notify_fd;      /* [wait_lock] */
+  bool notify_fd_signalled; /* [wait_lock] */
+  ddsrt_eventfd_t notify_fd; /* [wait_lock] only valid if have_notify_fd */
+#endif
 } dds_waitset;
 
 extern dds_cyclonedds_entity dds_global;
@@ -14,6 +14,7 @@
 #include "dds/ddsrt/process.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/hopscotch.h"
+#include "dds/ddsrt/bintrace.h"
 #include "dds/ddsi/ddsi_iid.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsi/ddsi_serdata.h"
@@ -23,6 +24,7 @@
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_typelib.h"
 #include "dds/ddsi/ddsi_init.h"
+#include "dds/ddsi/ddsi_statistics.h"
 #include "dds/ddsc/dds_rhc.h"
 #include "dds__init.h"
 #include "dds__domain.h"
@@ -31,17 +33,64 @@
 #include "dds__entity.h"
 #include "dds__serdata_default.h"
 #include "dds__psmx.h"
+#include "dds__statistics.h"
+#include "dds__listener_dispatch.h"
 
 static dds_return_t dds_domain_free (dds_entity *vdomain);
 
+static const struct dds_stat_keyvalue_descriptor dds_domain_statistics_kv[] = {
+  { "secrecv_packets", DDS_STAT_KIND_UINT64 },
+  { "secrecv_bytes", DDS_STAT_KIND_UINT64 },
+  { "secrecv_time_queued", DDS_STAT_KIND_UINT64 },
+  { "secrecv_time_process", DDS_STAT_KIND_UINT64 },
+  { "secrecv_queue_max", DDS_STAT_KIND_UINT32 },
+  // stage latencies: only present if enabled in the configuration
+  DDS_STAT_LATENCY_KV ("xpack"),
+  DDS_STAT_LATENCY_KV ("send"),
+  DDS_STAT_LATENCY_KV ("recv"),
+  DDS_STAT_LATENCY_KV ("dqueue")
+};
+
+#define DDS_DOMAIN_STATISTICS_NLAT 4
+
+static const struct dds_stat_descriptor dds_domain_statistics_desc = {
+  .count = sizeof (dds_domain_statistics_kv) / sizeof (dds_domain_statistics_kv[0]) - DDS_DOMAIN_STATISTICS_NLAT * DDS_STAT_LATENCY_NKV,
+  .kv = dds_domain_statistics_kv
+};
+
+static const struct dds_stat_descriptor dds_domain_statistics_lat_desc = {
+  .count = sizeof (dds_domain_statistics_kv) / sizeof (dds_domain_statistics_kv[0]),
+  .kv = dds_domain_statistics_kv
+};
+
+static struct dds_statistics *dds_domain_create_statistics (const struct dds_entity *entity)
+{
+  const struct dds_domain *domain = (const struct dds_domain *) entity;
+  return dds_alloc_statistics (entity, domain->gv.lathist_xpack ? &dds_domain_statistics_lat_desc : &dds_domain_statistics_desc);
+}
+
+static void dds_domain_refresh_statistics (const struct dds_entity *entity, struct dds_statistics *stat)
+{
+  const struct dds_domain *domain = (const struct dds_domain *) entity;
+  ddsi_get_secrecv_stats (&domain->gv, &stat->kv[0].u.u64, &stat->kv[1].u.u64, &stat->kv[2].u.u64, &stat->kv[3].u.u64, &stat->kv[4].u.u32);
+  if (stat->count > dds_domain_statistics_desc.count)
+  {
+    struct dds_stat_keyvalue * const kvlat = &stat->kv[dds_domain_statistics_desc.count];
+    dds_stat_fill_latency (&kvlat[0], domain->gv.lathist_xpack);
+    dds_stat_fill_latency (&kvlat[DDS_STAT_LATENCY_NKV], domain->gv.lathist_send);
+    dds_stat_fill_latency (&kvlat[2 * DDS_STAT_LATENCY_NKV], domain->gv.lathist_recv);
+    dds_stat_fill_latency (&kvlat[3 * DDS_STAT_LATENCY_NKV], domain->gv.lathist_dqueue);
+  }
+}
+
 const struct dds_entity_deriver dds_entity_deriver_domain = {
   .interrupt = dds_entity_deriver_dummy_interrupt,
   .close = dds_entity_deriver_dummy_close,
   .delete = dds_domain_free,
   .set_qos = dds_entity_deriver_dummy_set_qos,
   .validate_status = dds_entity_deriver_dummy_validate_status,
-  .create_statistics = dds_entity_deriver_dummy_create_statistics,
-  .refresh_statistics = dds_entity_deriver_dummy_refresh_statistics,
+  .create_statistics = dds_domain_create_statistics,
+  .refresh_statistics = dds_domain_refresh_statistics,
   .invoke_cbs_for_pending_events = dds_entity_deriver_dummy_invoke_cbs_for_pending_events
 };
 
@@ -152,6 +201,17 @@ static dds_entity_t dds_domain_init (dds_domain *domain, dds_domainid_t domain_i
 
   domain->serpool = dds_serdatapool_new ();
 
+  domain->listener_dispatch = NULL;
+  if (domain->gv.config.listener_threads > 0)
+  {
+    if ((domain->listener_dispatch = dds_listener_dispatch_new (&domain->gv, domain->gv.config.listener_threads)) == NULL)
+    {
+      DDS_ILOG (DDS_LC_ERROR, domain->m_id, "Failed to start the listener threads\n");
+      ret = DDS_RETCODE_OUT_OF_RESOURCES;
+      goto fail_listener_dispatch;
+    }
+  }
+
   /* Start monitoring the liveliness of threads if this is the first
      domain to configured to do so. */
   if (domain->gv.config.liveliness_monitoring)
@@ -201,6 +261,9 @@ fail_threadmon_start:
     dds_global.threadmon = NULL;
   }
 fail_threadmon_new:
+  if (domain->listener_dispatch)
+    dds_listener_dispatch_free (domain->listener_dispatch);
+fail_listener_dispatch:
   ddsi_fini (&domain->gv);
   dds_serdatapool_free (domain->serpool);
 fail_ddsi_init:
@@ -209,6 +272,8 @@ fail_psmx_init:
 fail_ddsi_config:
   if (domain->cfgst)
     ddsi_config_fini (domain->cfgst);
+  else if (domain->gv.config.tracebt)
+    ddsrt_bintrace_free (domain->gv.config.tracebt);
 fail_config:
   dds_handle_delete (&domain->m_entity.m_hdllink);
   return ret;
@@ -326,6 +391,8 @@ dds_entity_t dds_create_domain_with_rawconfig (const dds_domainid_t domain, cons
 static dds_return_t dds_domain_free (dds_entity *vdomain)
 {
   struct dds_domain *domain = (struct dds_domain *) vdomain;
+  if (domain->listener_dispatch)
+    dds_listener_dispatch_free (domain->listener_dispatch);
   ddsi_stop (&domain->gv);
   dds__builtin_fini (domain);
 
@@ -351,6 +418,8 @@ static dds_return_t dds_domain_free (dds_entity *vdomain)
   dds_entity_final_deinit_before_free (vdomain);
   if (domain->cfgst)
     ddsi_config_fini (domain->cfgst);
+  else if (domain->gv.config.tracebt)
+    ddsrt_bintrace_free (domain->gv.config.tracebt);
   dds_free (vdomain);
   ddsrt_cond_broadcast (&dds_global.m_cond);
   ddsrt_mutex_unlock (&dds_global.m_mutex);
@@ -18,6 +18,7 @@
 #include "dds__writer.h"
 #include "dds__reader.h"
 #include "dds__listener.h"
+#include "dds__listener_dispatch.h"
 #include "dds__qos.h"
 #include "dds__topic.h"
 #include "dds__builtin.h"
@@ -234,6 +235,9 @@ dds_entity_t dds_entity_init (dds_entity *e, dds_entity *parent, dds_entity_kind
   e->m_qos = qos;
   e->m_cb_count = 0;
   e->m_cb_pending_count = 0;
+  e->m_dispatch_status = 0;
+  e->m_dispatch_busy = false;
+  e->m_dispatch_next = NULL;
   e->m_observers = NULL;
 
   /* TODO: CHAM-96: Implement dynamic enabling of entity. */
@@ -466,6 +470,7 @@ static dds_return_t really_delete_pinned_closed_locked (struct dds_entity *e, en
      - Reset all listeners so no new listener invocations will occur
      - Wait for all pending ones ones to end as well */
   ddsrt_mutex_lock (&e->m_observers_lock);
+  dds_listener_dispatch_cancel (e);
   while (e->m_cb_pending_count > 0)
     ddsrt_cond_wait (&e->m_observers_cond, &e->m_observers_lock);
   dds_reset_listener (&e->m_listener);
@@ -1389,12 +1394,13 @@ static bool in_observer_list_p (const struct dds_entity *observed, const dds_wai
 
 dds_return_t dds_entity_observer_register (dds_entity *observed, dds_waitset *observer, dds_entity_callback_t cb, dds_entity_attach_callback_t attach_cb, void *attach_arg, dds_entity_delete_callback_t delete_cb)
 {
+  struct dds_attachment *attachment;
   dds_return_t rc;
   assert (observed);
   ddsrt_mutex_lock (&observed->m_observers_lock);
   if (in_observer_list_p (observed, observer))
     rc = DDS_RETCODE_PRECONDITION_NOT_MET;
-  else if (!attach_cb (observer, observed, attach_arg))
+  else if ((attachment = attach_cb (observer, observed, attach_arg)) == NULL)
     rc = DDS_RETCODE_BAD_PARAMETER;
   else
   {
@@ -1402,6 +1408,7 @@ dds_return_t dds_entity_observer_register (dds_entity *observed, dds_waitset *ob
     o->m_cb = cb;
     o->m_delete_cb = delete_cb;
     o->m_observer = observer;
+    o->m_attachment = attachment;
     o->m_next = observed->m_observers;
     observed->m_observers = o;
     rc = DDS_RETCODE_OK;
@@ -1432,7 +1439,7 @@ dds_return_t dds_entity_observer_unregister (dds_entity *observed, dds_waitset *
     else
       prev->m_next = idx->m_next;
     if (invoke_delete_cb)
-      idx->m_delete_cb (idx->m_observer, observed->m_hdllink.hdl);
+      idx->m_delete_cb (idx->m_observer, idx->m_attachment);
     ddsrt_free (idx);
     rc = DDS_RETCODE_OK;
   }
@@ -1443,7 +1450,7 @@ dds_return_t dds_entity_observer_unregister (dds_entity *observed, dds_waitset *
 void dds_entity_observers_signal (dds_entity *observed)
 {
   for (dds_entity_observer *idx = observed->m_observers; idx; idx = idx->m_next)
-    idx->m_cb (idx->m_observer, observed->m_hdllink.hdl);
+    idx->m_cb (idx->m_observer, idx->m_attachment);
 }
 
 static void dds_entity_observers_signal_delete (dds_entity *observed)
@@ -1453,7 +1460,7 @@ static void dds_entity_observers_signal_delete (dds_entity *observed)
   while (idx != NULL)
   {
     dds_entity_observer *next = idx->m_next;
-    idx->m_delete_cb (idx->m_observer, observed->m_hdllink.hdl);
+    idx->m_delete_cb (idx->m_observer, idx->m_attachment);
     ddsrt_free (idx);
     idx = next;
   }
@@ -14,7 +14,6 @@
 #include "dds/ddsrt/sync.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/random.h"
-#include "dds/ddsrt/hopscotch.h"
 #include "dds/ddsi/ddsi_thread.h"
 #include "dds__handles.h"
 #include "dds__types.h"
@@ -44,73 +43,256 @@ built-in topics:
   - implicit variant of a topic
 */
 
-/* Maximum number of handles is INT32_MAX - 1, but as the allocator relies on a
-   random generator for finding a free one, the time spent in the dds_handle_create
-   increases with an increasing number of handles.  16M handles seems likely to be
-   enough and makes the likely cost of allocating a new handle somewhat more
-   reasonable */
-#define MAX_HANDLES (INT32_MAX / 128)
+/* Handles index a table of slots, the index is in the low HDL_IDX_BITS bits
+   and a generation counter that gets incremented whenever the slot is reused
+   in the bits above that.  Looking up a handle is therefore a few loads and
+   doesn't require a lock: only creating and deleting do.
+
+   The table consists of chunks that are allocated on demand and that never
+   move or get freed until the handle server is torn down, so a slot can
+   always be accessed safely.  The entity containing the handle link can be
+   freed once it has been deleted, and so a lookup first increments the
+   slot's "inflight" counter, then loads the link pointer from the slot, and
+   decrements the counter when it no longer accesses the link.  Deleting
+   clears the pointer and then waits until no lookups are in progress.
+
+   Freed slots are reused in FIFO order and only once there are many of them,
+   so that a stale handle is unlikely to refer to a new entity.  Each slot
+   starts with a random generation to avoid handles being predictable.
+
+   Handles in the pseudo-handle range (only DDS_CYCLONEDDS_HANDLE in
+   practice) are kept in a small separate table.  The handle value is stored
+   next to it so that a lookup can find the slot without dereferencing the
+   link before incrementing "inflight".
+
+   Handles are positive 31-bit numbers below DDS_MIN_PSEUDO_HANDLE, so the
+   index and the generation have to share 31 bits, giving the limits:
+
+   - at most 2^HDL_IDX_BITS - 1 = 4194303 handles can exist at the same time
+     (the hash table used before allowed INT32_MAX/128, or ~16M);
+   - HDL_GEN_MAX = 511 generations per slot: a slot gets reused only when at
+     least HDL_MIN_FREE slots are free, so a stale handle can't refer to a
+     new entity until at least HDL_GEN_MAX * HDL_MIN_FREE (~2M) handles have
+     been deleted after it, unless the table is full (with random 31-bit
+     handles as before, there was a small probability of this happening at
+     any time). */
+#define HDL_IDX_BITS 22
+#define HDL_IDX_MASK ((1u << HDL_IDX_BITS) - 1)
+#define HDL_GEN_MAX ((uint32_t) DDS_MIN_PSEUDO_HANDLE >> HDL_IDX_BITS)
+#define HDL_CHUNK_BITS 10
+#define HDL_CHUNK_SIZE (1u << HDL_CHUNK_BITS)
+#define HDL_NCHUNKS (1u << (HDL_IDX_BITS - HDL_CHUNK_BITS))
+#define HDL_MIN_FREE 4096
+#define HDL_NSPECIAL 4
+#define MAX_HANDLES HDL_IDX_MASK
+#define HDL_UNPUBLISH_SPINS 100
+#define HDL_UNPUBLISH_MAX_DELAY DDS_MSECS (1)
+
+/* a slot per cache line: threads pinning different entities shouldn't interfere */
+struct dds_handle_slot {
+  ddsrt_atomic_voidp_t link;       /* link of the entity using this slot, NULL if free */
+  ddsrt_atomic_uint32_t inflight;  /* number of lookups in progress */
+  uint32_t gen;                    /* protected by handles.lock */
+  uint32_t next_free;              /* protected by handles.lock */
+  char pad[DDSI_CACHE_LINE_SIZE - sizeof (ddsrt_atomic_voidp_t) - 3 * sizeof (uint32_t)];
+};
 
 struct dds_handle_server {
-  struct ddsrt_hh *ht;
+  bool initialized;
   size_t count;
+  uint32_t nslots;                 /* number of slots in allocated chunks, slot 0 is never used */
+  uint32_t nfree, free_head, free_tail;
+  ddsrt_atomic_voidp_t chunks[HDL_NCHUNKS];
+  struct dds_handle_slot special[HDL_NSPECIAL];
+  ddsrt_atomic_uint32_t special_hdl[HDL_NSPECIAL]; /* handle last registered in special[i] */
   ddsrt_mutex_t lock;
   ddsrt_cond_t cond;
 };
 
 static struct dds_handle_server handles;
 
-static uint32_t handle_hash (const void *va)
+static struct dds_handle_slot *handle_slot (dds_handle_t hdl)
+{
+  if (hdl <= 0)
+    return NULL;
+  else if (hdl >= DDS_MIN_PSEUDO_HANDLE)
+  {
+    for (uint32_t i = 0; i < HDL_NSPECIAL; i++)
+    {
+      if (ddsrt_atomic_ld32 (&handles.special_hdl[i]) == (uint32_t) hdl)
+        return &handles.special[i];
+    }
+    return NULL;
+  }
+  else
+  {
+    const uint32_t idx = (uint32_t) hdl & HDL_IDX_MASK;
+    struct dds_handle_slot * const chunk = ddsrt_atomic_ldvoidp (&handles.chunks[idx >> HDL_CHUNK_BITS]);
+    return chunk ? &chunk[idx & (HDL_CHUNK_SIZE - 1)] : NULL;
+  }
+}
+
+static struct dds_handle_slot *slot_by_index (uint32_t idx)
+{
+  struct dds_handle_slot * const chunk = ddsrt_atomic_ldvoidp (&handles.chunks[idx >> HDL_CHUNK_BITS]);
+  assert (chunk != NULL);
+  return &chunk[idx & (HDL_CHUNK_SIZE - 1)];
+}
+
+static struct dds_handle_link *handle_lookup_begin (dds_handle_t hdl, struct dds_handle_slot **slot)
+{
+  if ((*slot = handle_slot (hdl)) == NULL)
+    return NULL;
+  ddsrt_atomic_inc32 (&(*slot)->inflight);
+  /* the increment must be visible before loading the link, see handle_unpublish */
+  ddsrt_atomic_fence ();
+  struct dds_handle_link * const link = ddsrt_atomic_ldvoidp (&(*slot)->link);
+  ddsrt_atomic_fence_ldld ();
+  return (link && link->hdl == hdl) ? link : NULL;
+}
+
+static void handle_lookup_end (struct dds_handle_slot *slot)
+{
+  if (slot)
+  {
+    ddsrt_atomic_fence_rel ();
+    ddsrt_atomic_dec32 (&slot->inflight);
+  }
+}
+
+static void handle_publish (struct dds_handle_slot *slot, struct dds_handle_link *link)
 {
-  /* handles are already pseudo-random numbers, so not much point in hashing it again */
-  const struct dds_handle_link *a = va;
-  return (uint32_t) a->hdl;
+  ddsrt_atomic_fence_rel ();
+  ddsrt_atomic_stvoidp (&slot->link, link);
 }
 
-static bool handle_equal (const void *va, const void *vb)
+static void handle_unpublish (struct dds_handle_slot *slot)
 {
-  const struct dds_handle_link *a = va;
-  const struct dds_handle_link *b = vb;
-  return a->hdl == b->hdl;
+  /* once the link pointer is cleared, no new lookup can reach the link; those
+     that loaded the pointer before have their inflight increment visible */
+  ddsrt_atomic_stvoidp (&slot->link, NULL);
+  ddsrt_atomic_fence ();
+  /* a lookup takes only a few instructions, so this is almost never needed
+     for long, unless a thread got preempted in the middle of one: spin for a
+     bit before sleeping, and then back off exponentially */
+  uint32_t nspins = 0;
+  dds_duration_t delay = DDS_USECS (1);
+  while (ddsrt_atomic_ld32 (&slot->inflight) != 0)
+  {
+    if (nspins < HDL_UNPUBLISH_SPINS)
+      nspins++;
+    else
+    {
+      dds_sleepfor (delay);
+      if (delay < HDL_UNPUBLISH_MAX_DELAY)
+        delay *= 2;
+    }
+  }
 }
 
 dds_return_t dds_handle_server_init (void)
 {
   /* called with ddsrt's singleton mutex held (see dds_init/fini) */
-  if (handles.ht == NULL)
+  if (!handles.initialized)
   {
-    handles.ht = ddsrt_hh_new (128, handle_hash, handle_equal);
+    handles.initialized = true;
     handles.count = 0;
+    handles.nslots = 1;
+    handles.nfree = handles.free_head = handles.free_tail = 0;
+    for (uint32_t i = 0; i < HDL_NCHUNKS; i++)
+      ddsrt_atomic_stvoidp (&handles.chunks[i], NULL);
+    for (uint32_t i = 0; i < HDL_NSPECIAL; i++)
+    {
+      ddsrt_atomic_stvoidp (&handles.special[i].link, NULL);
+      ddsrt_atomic_st32 (&handles.special[i].inflight, 0);
+      ddsrt_atomic_st32 (&handles.special_hdl[i], 0);
+    }
     ddsrt_mutex_init (&handles.lock);
     ddsrt_cond_init (&handles.cond);
   }
   return DDS_RETCODE_OK;
 }
 
+#ifndef NDEBUG
+static void report_leaked_handle (const struct dds_handle_slot *slot)
+{
+  struct dds_handle_link const * const link = ddsrt_atomic_ldvoidp (&slot->link);
+  if (link == NULL)
+    return;
+  uintptr_t cf = ddsrt_atomic_ldptr (&link->cnt_flags);
+  DDS_ERROR ("handle %"PRId32" pin %"PRIuPTR" refc %"PRIuPTR"%s%s%s\n", link->hdl,
+             (uintptr_t) (cf & HDL_PINCOUNT_MASK),
+             (uintptr_t) ((cf & HDL_REFCOUNT_MASK) >> HDL_REFCOUNT_SHIFT),
+             cf & HDL_FLAG_PENDING ? " pending" : "",
+             cf & HDL_FLAG_CLOSING ? " closing" : "",
+             cf & HDL_FLAG_DELETE_DEFERRED ? " delete-deferred" : "");
+}
+#endif
+
 void dds_handle_server_fini (void)
 {
   /* called with ddsrt's singleton mutex held (see dds_init/fini) */
-  if (handles.ht != NULL)
+  if (handles.initialized)
   {
 #ifndef NDEBUG
-    struct ddsrt_hh_iter it;
-    for (struct dds_handle_link *link = ddsrt_hh_iter_first (handles.ht, &it); link != NULL; link = ddsrt_hh_iter_next (&it))
+    for (uint32_t i = 1; i < handles.nslots; i++)
+      report_leaked_handle (slot_by_index (i));
+    for (uint32_t i = 0; i < HDL_NSPECIAL; i++)
+      report_leaked_handle (&handles.special[i]);
+    assert (handles.count == 0);
+#endif
+    for (uint32_t i = 0; i < HDL_NCHUNKS; i++)
     {
-      uintptr_t cf = ddsrt_atomic_ldptr (&link->cnt_flags);
-      DDS_ERROR ("handle %"PRId32" pin %"PRIuPTR" refc %"PRIuPTR"%s%s%s\n", link->hdl,
-                 (uintptr_t) (cf & HDL_PINCOUNT_MASK),
-                 (uintptr_t) ((cf & HDL_REFCOUNT_MASK) >> HDL_REFCOUNT_SHIFT),
-                 cf & HDL_FLAG_PENDING ? " pending" : "",
-                 cf & HDL_FLAG_CLOSING ? " closing" : "",
-                 cf & HDL_FLAG_DELETE_DEFERRED ? " delete-deferred" : "");
+      ddsrt_free (ddsrt_atomic_ldvoidp (&handles.chunks[i]));
+      ddsrt_atomic_stvoidp (&handles.chunks[i], NULL);
     }
-    assert (ddsrt_hh_iter_first (handles.ht, &it) == NULL);
-#endif
-    ddsrt_hh_free (handles.ht);
     ddsrt_cond_destroy (&handles.cond);
     ddsrt_mutex_destroy (&handles.lock);
-    handles.ht = NULL;
+    handles.initialized = false;
+  }
+}
+
+static uint32_t alloc_slot (void)
+{
+  /* called with handles.lock held and handles.count < MAX_HANDLES */
+  uint32_t idx;
+  if (handles.nfree > 0 && (handles.nfree >= HDL_MIN_FREE || handles.nslots > MAX_HANDLES))
+  {
+    idx = handles.free_head;
+    handles.free_head = slot_by_index (idx)->next_free;
+    if (--handles.nfree == 0)
+      handles.free_tail = 0;
+    return idx;
   }
+  idx = handles.nslots++;
+  if ((idx & (HDL_CHUNK_SIZE - 1)) == 0 || idx == 1)
+  {
+    struct dds_handle_slot *chunk = ddsrt_malloc (HDL_CHUNK_SIZE * sizeof (*chunk));
+    for (uint32_t i = 0; i < HDL_CHUNK_SIZE; i++)
+    {
+      ddsrt_atomic_stvoidp (&chunk[i].link, NULL);
+      ddsrt_atomic_st32 (&chunk[i].inflight, 0);
+      chunk[i].gen = ddsrt_random () % HDL_GEN_MAX;
+      chunk[i].next_free = 0;
+    }
+    ddsrt_atomic_fence_rel ();
+    ddsrt_atomic_stvoidp (&handles.chunks[idx >> HDL_CHUNK_BITS], chunk);
+  }
+  return idx;
+}
+
+static void free_slot (uint32_t idx)
+{
+  /* called with handles.lock held */
+  struct dds_handle_slot * const slot = slot_by_index (idx);
+  if (++slot->gen == HDL_GEN_MAX)
+    slot->gen = 0;
+  slot->next_free = 0;
+  if (handles.nfree++ == 0)
+    handles.free_head = idx;
+  else
+    slot_by_index (handles.free_tail)->next_free = idx;
+  handles.free_tail = idx;
 }
 
 static dds_handle_t dds_handle_create_int (struct dds_handle_link *link, bool implicit, bool refc_counts_children, bool user_access)
@@ -120,11 +302,11 @@ static dds_handle_t dds_handle_create_int (struct dds_handle_link *link, bool im
   flags |= refc_counts_children ? HDL_FLAG_ALLOW_CHILDREN : 0;
   flags |= user_access ? 0 : HDL_FLAG_NO_USER_ACCESS;
   ddsrt_atomic_stptr (&link->cnt_flags, flags | 1u);
-  do {
-    do {
-      link->hdl = (int32_t) (ddsrt_random () & INT32_MAX);
-    } while (link->hdl == 0 || link->hdl >= DDS_MIN_PSEUDO_HANDLE);
-  } while (!ddsrt_hh_add (handles.ht, link));
+  const uint32_t idx = alloc_slot ();
+  struct dds_handle_slot * const slot = slot_by_index (idx);
+  link->hdl = (int32_t) ((slot->gen << HDL_IDX_BITS) | idx);
+  assert (link->hdl > 0 && link->hdl < DDS_MIN_PSEUDO_HANDLE);
+  handle_publish (slot, link);
   return link->hdl;
 }
 
@@ -150,26 +332,33 @@ dds_handle_t dds_handle_create (struct dds_handle_link *link, bool implicit, boo
 dds_return_t dds_handle_register_special (struct dds_handle_link *link, bool implicit, bool allow_children, dds_handle_t handle)
 {
   dds_return_t ret;
-  if (handle <= 0)
+  if (handle < DDS_MIN_PSEUDO_HANDLE)
     return DDS_RETCODE_BAD_PARAMETER;
   ddsrt_mutex_lock (&handles.lock);
-  if (handles.count == MAX_HANDLES)
+  struct dds_handle_slot *slot = NULL;
+  for (uint32_t i = 0; i < HDL_NSPECIAL; i++)
   {
-    ddsrt_mutex_unlock (&handles.lock);
-    ret = DDS_RETCODE_OUT_OF_RESOURCES;
+    struct dds_handle_link const * const x = ddsrt_atomic_ldvoidp (&handles.special[i].link);
+    if (x && x->hdl == handle)
+    {
+      slot = NULL;
+      break;
+    }
+    else if (x == NULL && slot == NULL)
+      slot = &handles.special[i];
   }
+  if (slot == NULL)
+    ret = DDS_RETCODE_BAD_PARAMETER;
   else
   {
     handles.count++;
     ddsrt_atomic_stptr (&link->cnt_flags, HDL_FLAG_PENDING | (implicit ? HDL_FLAG_IMPLICIT : HDL_REFCOUNT_UNIT) | (allow_children ? HDL_FLAG_ALLOW_CHILDREN : 0) | 1u);
     link->hdl = handle;
-    if (ddsrt_hh_add (handles.ht, link))
-      ret = handle;
-    else
-      ret = DDS_RETCODE_BAD_PARAMETER;
-    ddsrt_mutex_unlock (&handles.lock);
-    assert (ret > 0);
+    ddsrt_atomic_st32 (&handles.special_hdl[slot - handles.special], (uint32_t) handle);
+    handle_publish (slot, link);
+    ret = handle;
   }
+  ddsrt_mutex_unlock (&handles.lock);
   return ret;
 }
 
@@ -198,8 +387,12 @@ int32_t dds_handle_delete (struct dds_handle_link *link)
   }
   assert ((cf & HDL_PINCOUNT_MASK) == 1u);
 #endif
+  struct dds_handle_slot * const slot = handle_slot (link->hdl);
+  assert (slot && ddsrt_atomic_ldvoidp (&slot->link) == link);
+  handle_unpublish (slot);
   ddsrt_mutex_lock (&handles.lock);
-  ddsrt_hh_remove_present (handles.ht, link);
+  if (link->hdl < DDS_MIN_PSEUDO_HANDLE)
+    free_slot ((uint32_t) link->hdl & HDL_IDX_MASK);
   assert (handles.count > 0);
   handles.count--;
   ddsrt_mutex_unlock (&handles.lock);
@@ -208,7 +401,7 @@ int32_t dds_handle_delete (struct dds_handle_link *link)
 
 static int32_t dds_handle_pin_int (dds_handle_t hdl, uintptr_t delta, bool from_user, struct dds_handle_link **link)
 {
-  struct dds_handle_link dummy = { .hdl = hdl };
+  struct dds_handle_slot *slot;
   int32_t rc;
   /* it makes sense to check here for initialization: the first thing any operation
      (other than create_participant) does is to call dds_handle_pin on the supplied
@@ -218,11 +411,10 @@ static int32_t dds_handle_pin_int (dds_handle_t hdl, uintptr_t delta, bool from_
 
      One could check that the handle is > 0, but that would catch fewer errors
      without any advantages. */
-  if (handles.ht == NULL)
+  if (!handles.initialized)
     return DDS_RETCODE_PRECONDITION_NOT_MET;
 
-  ddsrt_mutex_lock (&handles.lock);
-  *link = ddsrt_hh_lookup (handles.ht, &dummy);
+  *link = handle_lookup_begin (hdl, &slot);
   if (*link == NULL)
     rc = DDS_RETCODE_BAD_PARAMETER;
   else
@@ -248,7 +440,7 @@ static int32_t dds_handle_pin_int (dds_handle_t hdl, uintptr_t delta, bool from_
       }
     } while (!ddsrt_atomic_casptr (&(*link)->cnt_flags, cf, cf + delta));
   }
-  ddsrt_mutex_unlock (&handles.lock);
+  handle_lookup_end (slot);
   return rc;
 }
 
@@ -264,7 +456,7 @@ int32_t dds_handle_pin_with_origin (dds_handle_t hdl, bool from_user, struct dds
 
 int32_t dds_handle_pin_for_delete (dds_handle_t hdl, bool explicit, bool from_user, struct dds_handle_link **link)
 {
-  struct dds_handle_link dummy = { .hdl = hdl };
+  struct dds_handle_slot *slot;
   int32_t rc;
   /* it makes sense to check here for initialization: the first thing any operation
      (other than create_participant) does is to call dds_handle_pin on the supplied
@@ -274,11 +466,10 @@ int32_t dds_handle_pin_for_delete (dds_handle_t hdl, bool explicit, bool from_us
 
      One could check that the handle is > 0, but that would catch fewer errors
      without any advantages. */
-  if (handles.ht == NULL)
+  if (!handles.initialized)
     return DDS_RETCODE_PRECONDITION_NOT_MET;
 
-  ddsrt_mutex_lock (&handles.lock);
-  *link = ddsrt_hh_lookup (handles.ht, &dummy);
+  *link = handle_lookup_begin (hdl, &slot);
   if (*link == NULL)
     rc = DDS_RETCODE_BAD_PARAMETER;
   else
@@ -382,14 +573,13 @@ int32_t dds_handle_pin_for_delete (dds_handle_t hdl, bool explicit, bool from_us
       rc = ((cf1 & HDL_REFCOUNT_MASK) == 0 || (cf1 & HDL_FLAG_ALLOW_CHILDREN)) ? DDS_RETCODE_OK : DDS_RETCODE_TRY_AGAIN;
     } while (!ddsrt_atomic_casptr (&(*link)->cnt_flags, cf, cf1));
   }
-  ddsrt_mutex_unlock (&handles.lock);
+  handle_lookup_end (slot);
   return rc;
 }
 
 bool dds_handle_drop_childref_and_pin (struct dds_handle_link *link, bool may_delete_parent)
 {
   bool del_parent = false;
-  ddsrt_mutex_lock (&handles.lock);
   uintptr_t cf, cf1;
   do {
     cf = ddsrt_atomic_ldptr (&link->cnt_flags);
@@ -427,7 +617,6 @@ bool dds_handle_drop_childref_and_pin (struct dds_handle_link *link, bool may_de
       }
     }
   } while (!ddsrt_atomic_casptr (&link->cnt_flags, cf, cf1));
-  ddsrt_mutex_unlock (&handles.lock);
   return del_parent;
 }
 
@@ -442,6 +631,16 @@ void dds_handle_repin (struct dds_handle_link *link)
   (void) x;
 }
 
+static void signal_close_waiter (void)
+{
+  /* The waiter in dds_handle_close_wait checks the pin count with the lock
+     held, so taking the lock here after updating it suffices to not lose
+     the wakeup; everyone else can skip the lock. */
+  ddsrt_mutex_lock (&handles.lock);
+  ddsrt_cond_broadcast (&handles.cond);
+  ddsrt_mutex_unlock (&handles.lock);
+}
+
 void dds_handle_unpin (struct dds_handle_link *link)
 {
 #ifndef NDEBUG
@@ -451,12 +650,8 @@ void dds_handle_unpin (struct dds_handle_link *link)
   else
     assert ((cf & HDL_PINCOUNT_MASK) >= 1u);
 #endif
-  ddsrt_mutex_lock (&handles.lock);
   if ((ddsrt_atomic_decptr_nv (&link->cnt_flags) & (HDL_FLAG_CLOSING | HDL_PINCOUNT_MASK)) == (HDL_FLAG_CLOSING | 1u))
-  {
-    ddsrt_cond_broadcast (&handles.cond);
-  }
-  ddsrt_mutex_unlock (&handles.lock);
+    signal_close_waiter ();
 }
 
 void dds_handle_add_ref (struct dds_handle_link *link)
@@ -472,12 +667,8 @@ bool dds_handle_drop_ref (struct dds_handle_link *link)
     assert ((old & HDL_REFCOUNT_MASK) > 0);
     new = old - HDL_REFCOUNT_UNIT;
   } while (!ddsrt_atomic_casptr (&link->cnt_flags, old, new));
-  ddsrt_mutex_lock (&handles.lock);
   if ((new & (HDL_FLAG_CLOSING | HDL_PINCOUNT_MASK)) == (HDL_FLAG_CLOSING | 1u))
-  {
-    ddsrt_cond_broadcast (&handles.cond);
-  }
-  ddsrt_mutex_unlock (&handles.lock);
+    signal_close_waiter ();
   return ((new & HDL_REFCOUNT_MASK) == 0);
 }
 
@@ -490,12 +681,8 @@ bool dds_handle_unpin_and_drop_ref (struct dds_handle_link *link)
     assert ((old & HDL_PINCOUNT_MASK) > 0);
     new = old - HDL_REFCOUNT_UNIT - 1u;
   } while (!ddsrt_atomic_casptr (&link->cnt_flags, old, new));
-  ddsrt_mutex_lock (&handles.lock);
   if ((new & (HDL_FLAG_CLOSING | HDL_PINCOUNT_MASK)) == (HDL_FLAG_CLOSING | 1u))
-  {
-    ddsrt_cond_broadcast (&handles.cond);
-  }
-  ddsrt_mutex_unlock (&handles.lock);
+    signal_close_waiter ();
   return ((new & HDL_REFCOUNT_MASK) == 0);
 }
 
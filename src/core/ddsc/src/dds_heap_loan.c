@@ -10,6 +10,7 @@
 
 #include <string.h>
 #include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
 #include "dds/ddsi/ddsi_sertype.h"
 #include "dds/cdr/dds_cdrstream.h"
 #include "dds__loaned_sample.h"
@@ -20,19 +21,69 @@ typedef struct dds_heap_loan {
   dds_loaned_sample_t c;
   struct dds_psmx_metadata metadata; // pointed to by c.metadata
   const struct ddsi_sertype *m_stype;
+  struct dds_heap_loan_pool *m_pool; // pool it returns to when freed, or null
 } dds_heap_loan_t;
 
+struct dds_heap_loan_pool {
+  ddsrt_mutex_t lock;
+  // one for the owner, plus one for each loan allocated from the pool that hasn't been
+  // freed yet, whether it is in use or cached
+  ddsrt_atomic_uint32_t refc;
+  const struct ddsi_sertype *type;
+  dds_loan_pool_t *cache; // loans ready for reuse, all of type->sizeof_type bytes
+  uint32_t max_cached;
+  bool closed;
+  uint64_t hits;
+  uint64_t misses;
+};
+
 static void heap_loan_free (dds_loaned_sample_t *loaned_sample)
   ddsrt_nonnull_all;
 
-static void heap_loan_free (dds_loaned_sample_t *loaned_sample)
+static void heap_loan_pool_unref (struct dds_heap_loan_pool *pool)
+{
+  if (ddsrt_atomic_dec32_ov (&pool->refc) == 1)
+  {
+    assert (pool->closed && pool->cache->n_samples == 0);
+    (void) dds_loan_pool_free (pool->cache);
+    ddsrt_mutex_destroy (&pool->lock);
+    ddsrt_free (pool);
+  }
+}
+
+static void heap_loan_fini (dds_heap_loan_t *hl)
 {
-  dds_heap_loan_t *hl = (dds_heap_loan_t *) loaned_sample;
   assert (hl->c.sample_ptr != NULL);
   ddsi_sertype_free_sample (hl->m_stype, hl->c.sample_ptr, DDS_FREE_ALL);
   ddsrt_free (hl);
 }
 
+static void heap_loan_free (dds_loaned_sample_t *loaned_sample)
+{
+  dds_heap_loan_t *hl = (dds_heap_loan_t *) loaned_sample;
+  struct dds_heap_loan_pool * const pool = hl->m_pool;
+  if (pool == NULL)
+  {
+    heap_loan_fini (hl);
+    return;
+  }
+
+  // The last reference can be dropped by any thread, e.g., when the WHC drops a sample
+  // once it has been acknowledged. Returning it to the pool doesn't involve the writer,
+  // and so it is fine if the writer has been deleted already.
+  bool cached = false;
+  dds_heap_loan_reset (&hl->c);
+  ddsrt_mutex_lock (&pool->lock);
+  if (!pool->closed && pool->cache->n_samples < pool->max_cached)
+    cached = (dds_loan_pool_add_loan (pool->cache, &hl->c) == DDS_RETCODE_OK);
+  ddsrt_mutex_unlock (&pool->lock);
+  if (!cached)
+  {
+    heap_loan_fini (hl);
+    heap_loan_pool_unref (pool);
+  }
+}
+
 void dds_heap_loan_reset (struct dds_loaned_sample *loaned_sample)
 {
   dds_heap_loan_t *hl = (dds_heap_loan_t *) loaned_sample;
@@ -45,6 +96,16 @@ const dds_loaned_sample_ops_t dds_loan_heap_ops = {
   .free = heap_loan_free
 };
 
+static void heap_loan_init_metadata (dds_heap_loan_t *s, dds_loaned_sample_state_t sample_state)
+{
+  s->c.metadata->sample_state = sample_state;
+  s->c.metadata->cdr_identifier = DDSI_RTPS_SAMPLE_NATIVE;
+  s->c.metadata->cdr_options = 0;
+  s->c.metadata->sample_size = s->m_stype->sizeof_type;
+  s->c.metadata->instance_id = 0;
+  s->c.metadata->data_type = 0;
+}
+
 dds_return_t dds_heap_loan (const struct ddsi_sertype *type, dds_loaned_sample_state_t sample_state, struct dds_loaned_sample **loaned_sample)
 {
   assert (sample_state == DDS_LOANED_SAMPLE_STATE_UNITIALIZED || sample_state == DDS_LOANED_SAMPLE_STATE_RAW_KEY || sample_state == DDS_LOANED_SAMPLE_STATE_RAW_DATA);
@@ -56,21 +117,97 @@ dds_return_t dds_heap_loan (const struct ddsi_sertype *type, dds_loaned_sample_s
   s->c.metadata = &s->metadata;
   s->c.ops = dds_loan_heap_ops;
   s->m_stype = type;
+  s->m_pool = NULL;
   if ((s->c.sample_ptr = ddsi_sertype_alloc_sample (type)) == NULL)
   {
     dds_free (s);
     return DDS_RETCODE_OUT_OF_RESOURCES;
   }
 
-  s->c.metadata->sample_state = sample_state;
-  s->c.metadata->cdr_identifier = DDSI_RTPS_SAMPLE_NATIVE;
-  s->c.metadata->cdr_options = 0;
-  s->c.metadata->sample_size = type->sizeof_type;
-  s->c.metadata->instance_id = 0;
-  s->c.metadata->data_type = 0;
+  heap_loan_init_metadata (s, sample_state);
   s->c.loan_origin.origin_kind = DDS_LOAN_ORIGIN_KIND_HEAP;
   s->c.loan_origin.psmx_endpoint = NULL;
   ddsrt_atomic_st32 (&s->c.refc, 1);
   *loaned_sample = &s->c;
   return DDS_RETCODE_OK;
 }
+
+dds_return_t dds_heap_loan_pool_create (struct dds_heap_loan_pool **ppool, const struct ddsi_sertype *type, uint32_t max_cached)
+{
+  struct dds_heap_loan_pool *pool;
+  dds_return_t ret;
+  if ((pool = ddsrt_malloc (sizeof (*pool))) == NULL)
+    return DDS_RETCODE_OUT_OF_RESOURCES;
+  if ((ret = dds_loan_pool_create (&pool->cache, 0)) != DDS_RETCODE_OK)
+  {
+    ddsrt_free (pool);
+    return ret;
+  }
+  ddsrt_mutex_init (&pool->lock);
+  ddsrt_atomic_st32 (&pool->refc, 1);
+  pool->type = type;
+  pool->max_cached = max_cached;
+  pool->closed = false;
+  pool->hits = 0;
+  pool->misses = 0;
+  *ppool = pool;
+  return DDS_RETCODE_OK;
+}
+
+void dds_heap_loan_pool_free (struct dds_heap_loan_pool *pool)
+{
+  // Loans still in use remain valid, they'll be freed instead of cached when they are
+  // released and the last one to go takes the pool with it
+  dds_loaned_sample_t *ls;
+  ddsrt_mutex_lock (&pool->lock);
+  pool->closed = true;
+  while ((ls = dds_loan_pool_get_loan (pool->cache)) != NULL)
+  {
+    ddsrt_mutex_unlock (&pool->lock);
+    heap_loan_fini ((dds_heap_loan_t *) ls);
+    heap_loan_pool_unref (pool);
+    ddsrt_mutex_lock (&pool->lock);
+  }
+  ddsrt_mutex_unlock (&pool->lock);
+  heap_loan_pool_unref (pool);
+}
+
+dds_return_t dds_heap_loan_from_pool (struct dds_heap_loan_pool *pool, dds_loaned_sample_state_t sample_state, struct dds_loaned_sample **loaned_sample)
+{
+  dds_loaned_sample_t *ls;
+  dds_return_t ret;
+  ddsrt_mutex_lock (&pool->lock);
+  if ((ls = dds_loan_pool_get_loan (pool->cache)) != NULL)
+    pool->hits++;
+  else
+    pool->misses++;
+  ddsrt_mutex_unlock (&pool->lock);
+
+  if (ls != NULL)
+  {
+    // reset when it was returned to the pool, the pool keeps its reference
+    dds_heap_loan_t *s = (dds_heap_loan_t *) ls;
+    assert (s->m_pool == pool && ddsrt_atomic_ld32 (&s->c.refc) == 0);
+    heap_loan_init_metadata (s, sample_state);
+    ddsrt_atomic_st32 (&s->c.refc, 1);
+  }
+  else if ((ret = dds_heap_loan (pool->type, sample_state, &ls)) != DDS_RETCODE_OK)
+  {
+    return ret;
+  }
+  else
+  {
+    ((dds_heap_loan_t *) ls)->m_pool = pool;
+    ddsrt_atomic_inc32 (&pool->refc);
+  }
+  *loaned_sample = ls;
+  return DDS_RETCODE_OK;
+}
+
+void dds_heap_loan_pool_stats (struct dds_heap_loan_pool *pool, uint64_t *hits, uint64_t *misses)
+{
+  ddsrt_mutex_lock (&pool->lock);
+  *hits = pool->hits;
+  *misses = pool->misses;
+  ddsrt_mutex_unlock (&pool->lock);
+}
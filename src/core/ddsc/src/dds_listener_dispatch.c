@@ -0,0 +1,181 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "dds/ddsi/ddsi_log.h"
+#include "dds/ddsi/ddsi_thread.h"
+#include "dds__entity.h"
+#include "dds__listener_dispatch.h"
+
+struct dds_listener_dispatch {
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  bool terminate;                   /* [lock] */
+  struct dds_entity *first, *last;  /* [lock] FIFO linked through m_dispatch_next */
+  uint32_t nthreads;
+  struct ddsi_thread_state **threads;
+};
+
+static void dispatch_entity (struct dds_entity *e)
+{
+  // The same protocol as for invoking listeners synchronously: m_cb_pending_count was
+  // incremented when queueing it and m_cb_count excludes invocations from other threads.
+  // Those can only be application threads (in dds_set_listener), because m_dispatch_busy
+  // prevents queueing it again until this thread is done with it.
+  ddsrt_mutex_lock (&e->m_observers_lock);
+  assert (e->m_dispatch_busy);
+  while (e->m_cb_count > 0)
+    ddsrt_cond_wait (&e->m_observers_cond, &e->m_observers_lock);
+  e->m_cb_count++;
+  // One status at a time, because the lock is released while invoking a listener and the
+  // application may reset the next one in the meantime (e.g., by taking the data or reading
+  // the status).  Those are skipped: there is nothing left to report.  Events that occur
+  // while processing the entity only get added to m_dispatch_status and are picked up here.
+  uint32_t status;
+  while ((status = e->m_dispatch_status) != 0)
+  {
+    const uint32_t one = status & (~status + 1);
+    e->m_dispatch_status &= ~one;
+    if (ddsrt_atomic_ld32 (&e->m_status.m_status_and_mask) & one)
+      dds_entity_deriver_invoke_cbs_for_pending_events (e, one);
+  }
+  e->m_dispatch_busy = false;
+  e->m_cb_count--;
+  e->m_cb_pending_count--;
+  ddsrt_cond_broadcast (&e->m_observers_cond);
+  ddsrt_mutex_unlock (&e->m_observers_lock);
+}
+
+static uint32_t listener_dispatch_thread (void *varg)
+{
+  struct dds_listener_dispatch * const ld = varg;
+  ddsrt_mutex_lock (&ld->lock);
+  while (!ld->terminate)
+  {
+    struct dds_entity * const e = ld->first;
+    if (e == NULL)
+      ddsrt_cond_wait (&ld->cond, &ld->lock);
+    else
+    {
+      if ((ld->first = e->m_dispatch_next) == NULL)
+        ld->last = NULL;
+      e->m_dispatch_next = NULL;
+      ddsrt_mutex_unlock (&ld->lock);
+      dispatch_entity (e);
+      ddsrt_mutex_lock (&ld->lock);
+    }
+  }
+  ddsrt_mutex_unlock (&ld->lock);
+  return 0;
+}
+
+static void stop_threads (struct dds_listener_dispatch *ld, uint32_t nthreads)
+{
+  ddsrt_mutex_lock (&ld->lock);
+  ld->terminate = true;
+  ddsrt_cond_broadcast (&ld->cond);
+  ddsrt_mutex_unlock (&ld->lock);
+  for (uint32_t i = 0; i < nthreads; i++)
+    ddsi_join_thread (ld->threads[i]);
+}
+
+struct dds_listener_dispatch *dds_listener_dispatch_new (const struct ddsi_domaingv *gv, uint32_t nthreads)
+{
+  assert (nthreads > 0);
+  struct dds_listener_dispatch *ld = ddsrt_malloc (sizeof (*ld));
+  ddsrt_mutex_init (&ld->lock);
+  ddsrt_cond_init (&ld->cond);
+  ld->terminate = false;
+  ld->first = ld->last = NULL;
+  ld->nthreads = nthreads;
+  ld->threads = ddsrt_malloc (nthreads * sizeof (*ld->threads));
+  for (uint32_t i = 0; i < nthreads; i++)
+  {
+    if (ddsi_create_thread (&ld->threads[i], gv, "listen", listener_dispatch_thread, ld) != DDS_RETCODE_OK)
+    {
+      GVERROR ("failed to create listener thread\n");
+      stop_threads (ld, i);
+      ddsrt_free (ld->threads);
+      ddsrt_cond_destroy (&ld->cond);
+      ddsrt_mutex_destroy (&ld->lock);
+      ddsrt_free (ld);
+      return NULL;
+    }
+  }
+  return ld;
+}
+
+void dds_listener_dispatch_free (struct dds_listener_dispatch *ld)
+{
+  assert (ld->first == NULL);
+  stop_threads (ld, ld->nthreads);
+  ddsrt_free (ld->threads);
+  ddsrt_cond_destroy (&ld->cond);
+  ddsrt_mutex_destroy (&ld->lock);
+  ddsrt_free (ld);
+}
+
+bool dds_listener_dispatch_enqueue (struct dds_entity *e, uint32_t status)
+{
+  struct dds_listener_dispatch * const ld = e->m_domain->listener_dispatch;
+  if (ld == NULL)
+    return false;
+  // If it is queued or being handled by a listener thread, that thread will pick up the
+  // additional events before it is done with the entity
+  e->m_dispatch_status |= status;
+  if (!e->m_dispatch_busy)
+  {
+    e->m_dispatch_busy = true;
+    e->m_cb_pending_count++;
+    ddsrt_mutex_lock (&ld->lock);
+    e->m_dispatch_next = NULL;
+    if (ld->last)
+      ld->last->m_dispatch_next = e;
+    else
+      ld->first = e;
+    ld->last = e;
+    ddsrt_cond_signal (&ld->cond);
+    ddsrt_mutex_unlock (&ld->lock);
+  }
+  return true;
+}
+
+void dds_listener_dispatch_cancel (struct dds_entity *e)
+{
+  struct dds_listener_dispatch * const ld = e->m_domain ? e->m_domain->listener_dispatch : NULL;
+  if (ld == NULL || !e->m_dispatch_busy)
+    return;
+  ddsrt_mutex_lock (&ld->lock);
+  struct dds_entity *prev = NULL, *cur = ld->first;
+  while (cur != NULL && cur != e)
+  {
+    prev = cur;
+    cur = cur->m_dispatch_next;
+  }
+  if (cur != NULL)
+  {
+    if (prev)
+      prev->m_dispatch_next = e->m_dispatch_next;
+    else
+      ld->first = e->m_dispatch_next;
+    if (ld->last == e)
+      ld->last = prev;
+    e->m_dispatch_next = NULL;
+    e->m_dispatch_status = 0;
+    e->m_dispatch_busy = false;
+    e->m_cb_pending_count--;
+    ddsrt_cond_broadcast (&e->m_observers_cond);
+  }
+  ddsrt_mutex_unlock (&ld->lock);
+}
@@ -113,6 +113,14 @@ dds_loaned_sample_t *dds_loan_pool_find_and_remove_loan (dds_loan_pool_t *pool,
   return NULL;
 }
 
+bool dds_loan_pool_contains_loan (const dds_loan_pool_t *pool, const void *sample_ptr)
+{
+  for (uint32_t i = 0; i < pool->n_samples; i++)
+    if (pool->samples[i]->sample_ptr == sample_ptr)
+      return true;
+  return false;
+}
+
 dds_loaned_sample_t *dds_loan_pool_get_loan (dds_loan_pool_t *pool)
 {
   if (pool->n_samples == 0)
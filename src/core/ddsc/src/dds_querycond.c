@@ -18,7 +18,7 @@
 #include "dds__readcond.h"
 #include "dds/ddsi/ddsi_serdata.h"
 
-dds_entity_t dds_create_querycondition (dds_entity_t reader, uint32_t mask, dds_querycondition_filter_fn filter)
+static dds_entity_t dds_create_querycondition_impl (dds_entity_t reader, uint32_t mask, dds_querycondition_filter_fn filter, bool key_only)
 {
   dds_reader *rd;
   dds_readcond *cond;
@@ -26,7 +26,7 @@ dds_entity_t dds_create_querycondition (dds_entity_t reader, uint32_t mask, dds_
 
   if ((rc = dds_reader_lock (reader, &rd)) != DDS_RETCODE_OK)
     return rc;
-  else if ((rc = dds_create_readcond_impl (&cond, rd, DDS_KIND_COND_QUERY, mask, filter)) != DDS_RETCODE_OK)
+  else if ((rc = dds_create_readcond_impl (&cond, rd, DDS_KIND_COND_QUERY, mask, filter, key_only)) != DDS_RETCODE_OK)
   {
     dds_reader_unlock (rd);
     return rc;
@@ -39,3 +39,13 @@ dds_entity_t dds_create_querycondition (dds_entity_t reader, uint32_t mask, dds_
     return hdl;
   }
 }
+
+dds_entity_t dds_create_querycondition (dds_entity_t reader, uint32_t mask, dds_querycondition_filter_fn filter)
+{
+  return dds_create_querycondition_impl (reader, mask, filter, false);
+}
+
+dds_entity_t dds_create_key_querycondition (dds_entity_t reader, uint32_t mask, dds_querycondition_filter_fn filter)
+{
+  return dds_create_querycondition_impl (reader, mask, filter, true);
+}
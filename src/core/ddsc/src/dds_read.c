@@ -10,6 +10,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include "dds/ddsrt/heap.h"
 #include "dds__entity.h"
 #include "dds__reader.h"
 #include "dds__read.h"
@@ -34,23 +35,26 @@ void dds_read_collect_sample_arg_init (struct dds_read_collect_sample_arg *arg,
   arg->heap_loan_cache = heap_loan_cache;
 }
 
-dds_return_t dds_read_collect_sample (void *varg, const dds_sample_info_t *si, const struct ddsi_sertype *st, struct ddsi_serdata *sd)
+static bool deserialize_sample (bool valid_data, const struct ddsi_sertype *st, struct ddsi_serdata *sd, void *sample)
 {
-  struct dds_read_collect_sample_arg * const arg = varg;
-  bool ok;
-  arg->infos[arg->next_idx] = *si;
-
-  if (si->valid_data)
-    ok = ddsi_serdata_to_sample (sd, arg->ptrs[arg->next_idx], NULL, NULL);
+  if (valid_data)
+    return ddsi_serdata_to_sample (sd, sample, NULL, NULL);
   else
   {
     /* ddsi_serdata_untyped_to_sample just deals with the key value, without paying any attention to attributes;
        but that makes life harder for the user: the attributes of an invalid sample would be garbage, but would
        nonetheless have to be freed in the end.  Zero'ing it explicitly solves that problem. */
-    ddsi_sertype_free_sample (st, arg->ptrs[arg->next_idx], DDS_FREE_CONTENTS);
-    ddsi_sertype_zero_sample (st, arg->ptrs[arg->next_idx]);
-    ok = ddsi_serdata_untyped_to_sample (st, sd, arg->ptrs[arg->next_idx], NULL, NULL);
+    ddsi_sertype_free_sample (st, sample, DDS_FREE_CONTENTS);
+    ddsi_sertype_zero_sample (st, sample);
+    return ddsi_serdata_untyped_to_sample (st, sd, sample, NULL, NULL);
   }
+}
+
+dds_return_t dds_read_collect_sample (void *varg, const dds_sample_info_t *si, const struct ddsi_sertype *st, struct ddsi_serdata *sd)
+{
+  struct dds_read_collect_sample_arg * const arg = varg;
+  arg->infos[arg->next_idx] = *si;
+  const bool ok = deserialize_sample (si->valid_data, st, sd, arg->ptrs[arg->next_idx]);
   arg->next_idx++;
   return ok ? DDS_RETCODE_OK : DDS_RETCODE_ERROR;
 }
@@ -459,6 +463,92 @@ dds_return_t dds_take_with_collector (dds_entity_t reader_or_condition, uint32_t
   return dds_read_with_collector_impl (READ_OPER_TAKE, reader_or_condition, maxs, mask, handle, false, collect_sample, collect_sample_arg);
 }
 
+struct deferred_deserialize_arg {
+  const struct ddsi_sertype *st;
+  struct ddsi_serdata **sds;
+  void **ptrs;
+  const dds_sample_info_t *infos;
+  ddsrt_atomic_uint32_t first_failed; /* lowest index for which deserialization failed */
+};
+
+static void deferred_deserialize_job (void *varg, uint32_t index)
+{
+  struct deferred_deserialize_arg * const arg = varg;
+  if (deserialize_sample (arg->infos[index].valid_data, arg->st, arg->sds[index], arg->ptrs[index]))
+    return;
+  uint32_t ff;
+  do {
+    ff = ddsrt_atomic_ld32 (&arg->first_failed);
+  } while (index < ff && !ddsrt_atomic_cas32 (&arg->first_failed, ff, index));
+}
+
+static dds_return_t dds_read_deferred_impl (enum dds_read_impl_common_oper oper, dds_entity_t reader_or_condition, void **buf, size_t bufsz, uint32_t maxs, dds_sample_info_t *si, uint32_t mask, dds_deserialize_executor_fn_t executor, void *executor_arg)
+{
+  if (buf == NULL || si == NULL || maxs == 0 || bufsz == 0 || bufsz < maxs || maxs > INT32_MAX || buf[0] == NULL)
+    return DDS_RETCODE_BAD_PARAMETER;
+
+  dds_return_t ret;
+  struct dds_entity *entity;
+  struct dds_reader *rd;
+  struct dds_readcond *cond;
+  if ((ret = dds_read_impl_setup (reader_or_condition, false, &entity, &rd, &cond, &mask)) < 0)
+    return ret;
+
+  // Deserializing into loaned samples would be possible, but the only interesting case is
+  // that of heap loans and for those dds_take does a fine job already.  Deserializing into
+  // a loan by accident would be bad, so check.
+  ddsrt_mutex_lock (&rd->m_entity.m_mutex);
+  if (dds_loan_pool_contains_loan (rd->m_loans, buf[0]))
+    ret = DDS_RETCODE_PRECONDITION_NOT_MET;
+  ddsrt_mutex_unlock (&rd->m_entity.m_mutex);
+  if (ret < 0)
+    goto err_loan;
+
+  struct ddsi_serdata **sds = ddsrt_malloc (maxs * sizeof (*sds));
+  struct dds_read_collect_sample_arg collect_arg;
+  dds_read_collect_sample_arg_init (&collect_arg, (void **) sds, si, NULL, NULL);
+  struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  ddsi_thread_state_awake (thrst, &entity->m_domain->gv);
+  ret = dds_read_impl_common (oper, rd, cond, maxs, mask, 0, dds_read_collect_sample_refs, &collect_arg);
+  ddsi_thread_state_asleep (thrst);
+
+  // History cache no longer locked, the samples are kept alive by the references
+  if (ret > 0)
+  {
+    const uint32_t n = (uint32_t) ret;
+    struct deferred_deserialize_arg job_arg = {
+      .st = rd->m_topic->m_stype, .sds = sds, .ptrs = buf, .infos = si
+    };
+    ddsrt_atomic_st32 (&job_arg.first_failed, n);
+    if (executor)
+      executor (executor_arg, n, deferred_deserialize_job, &job_arg);
+    else
+    {
+      for (uint32_t i = 0; i < n; i++)
+        deferred_deserialize_job (&job_arg, i);
+    }
+    for (uint32_t i = 0; i < n; i++)
+      ddsi_serdata_unref (sds[i]);
+    const uint32_t ff = ddsrt_atomic_ld32 (&job_arg.first_failed);
+    if (ff < n)
+      ret = (ff == 0) ? DDS_RETCODE_ERROR : (int32_t) ff;
+  }
+  ddsrt_free (sds);
+err_loan:
+  dds_entity_unpin (entity);
+  return ret;
+}
+
+dds_return_t dds_read_deferred (dds_entity_t reader_or_condition, void **buf, dds_sample_info_t *si, size_t bufsz, uint32_t maxs, uint32_t mask, dds_deserialize_executor_fn_t executor, void *executor_arg)
+{
+  return dds_read_deferred_impl (READ_OPER_READ, reader_or_condition, buf, bufsz, maxs, si, mask, executor, executor_arg);
+}
+
+dds_return_t dds_take_deferred (dds_entity_t reader_or_condition, void **buf, dds_sample_info_t *si, size_t bufsz, uint32_t maxs, uint32_t mask, dds_deserialize_executor_fn_t executor, void *executor_arg)
+{
+  return dds_read_deferred_impl (READ_OPER_TAKE, reader_or_condition, buf, bufsz, maxs, si, mask, executor, executor_arg);
+}
+
 static void return_reader_loan_locked_onesample (dds_reader *rd, dds_loaned_sample_t *loan, bool reset)
 {
   if (loan->loan_origin.origin_kind != DDS_LOAN_ORIGIN_KIND_HEAP || ddsrt_atomic_ld32 (&loan->refc) != 1)
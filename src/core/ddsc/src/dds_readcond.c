@@ -41,9 +41,9 @@ const struct dds_entity_deriver dds_entity_deriver_readcondition = {
   .invoke_cbs_for_pending_events = dds_entity_deriver_dummy_invoke_cbs_for_pending_events
 };
 
-dds_return_t dds_create_readcond_impl (dds_readcond **rdcond_out, dds_reader *rd, dds_entity_kind_t kind, uint32_t mask, dds_querycondition_filter_fn filter)
+dds_return_t dds_create_readcond_impl (dds_readcond **rdcond_out, dds_reader *rd, dds_entity_kind_t kind, uint32_t mask, dds_querycondition_filter_fn filter, bool key_only)
 {
-  assert ((kind == DDS_KIND_COND_READ && filter == 0) || (kind == DDS_KIND_COND_QUERY && filter != 0));
+  assert ((kind == DDS_KIND_COND_READ && filter == 0 && !key_only) || (kind == DDS_KIND_COND_QUERY && filter != 0));
   dds_readcond *cond = dds_alloc (sizeof (*cond));
   dds_return_t ret;
   ret = dds_entity_init (&cond->m_entity, &rd->m_entity, kind, false, true, NULL, NULL, 0);
@@ -60,6 +60,8 @@ dds_return_t dds_create_readcond_impl (dds_readcond **rdcond_out, dds_reader *rd
   {
     cond->m_query.m_filter = filter;
     cond->m_query.m_qcmask = 0;
+    cond->m_query.m_key_only = key_only;
+    cond->m_query.m_index = NULL;
   }
   if (!dds_rhc_add_readcondition (rd->m_rhc, cond))
   {
@@ -81,7 +83,7 @@ dds_entity_t dds_create_readcondition (dds_entity_t reader, uint32_t mask)
 
   if ((rc = dds_reader_lock (reader, &rd)) != DDS_RETCODE_OK)
     return rc;
-  else if ((rc = dds_create_readcond_impl (&cond, rd, DDS_KIND_COND_READ, mask, NULL)) != DDS_RETCODE_OK)
+  else if ((rc = dds_create_readcond_impl (&cond, rd, DDS_KIND_COND_READ, mask, NULL, false)) != DDS_RETCODE_OK)
   {
     dds_reader_unlock (rd);
     return rc;
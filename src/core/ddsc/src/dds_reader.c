@@ -24,6 +24,7 @@
 #include "dds/ddsi/ddsi_entity_index.h"
 #include "dds/ddsi/ddsi_security_omg.h"
 #include "dds/ddsi/ddsi_statistics.h"
+#include "dds/ddsi/ddsi_lathist.h"
 #include "dds/ddsi/ddsi_endpoint_match.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsc/dds_rhc.h"
@@ -32,9 +33,11 @@
 #include "dds__subscriber.h"
 #include "dds__reader.h"
 #include "dds__listener.h"
+#include "dds__listener_dispatch.h"
 #include "dds__init.h"
 #include "dds__rhc_default.h"
 #include "dds__topic.h"
+#include "dds__topic_filter.h"
 #include "dds__get_status.h"
 #include "dds__qos.h"
 #include "dds__builtin.h"
@@ -83,6 +86,9 @@ static dds_return_t dds_reader_delete (dds_entity *e)
   dds_loan_pool_free (rd->m_heap_loan_cache);
   dds_loan_pool_free (rd->m_loans);
   dds_endpoint_remove_psmx_endpoints (&rd->m_endpoint);
+  ddsi_lathist_free (rd->m_lathist_rhc);
+  ddsi_lathist_free (rd->m_lathist_listener);
+  ddsi_lathist_free (rd->m_lathist_take);
 
   dds_entity_drop_ref (&rd->m_topic->m_entity);
   return ret;
@@ -226,11 +232,19 @@ void dds_reader_data_available_cb (struct dds_reader *rd)
   const uint32_t status_and_mask = ddsrt_atomic_ld32 (&rd->m_entity.m_status.m_status_and_mask);
   if (lst->on_data_on_readers == NULL && lst->on_data_available == NULL)
     signal = data_avail_cb_set_status (&rd->m_entity, status_and_mask);
+  else if (dds_listener_dispatch_enqueue (&rd->m_entity, DDS_DATA_AVAILABLE_STATUS))
+  {
+    // Set the status so the listener thread knows there is something to report.  That
+    // also makes repeated events between queueing it and invoking the listener cheap.
+    signal = data_avail_cb_set_status (&rd->m_entity, status_and_mask);
+  }
   else
   {
     // "lock" listener object so we can look at "lst" without holding m_observers_lock
     data_avail_cb_enter_listener_exclusive_access (&rd->m_entity);
+    const ddsrt_mtime_t tlistener = ddsi_lathist_start (rd->m_lathist_listener);
     signal = da_or_dor_cb_invoke(rd, lst, status_and_mask, true);
+    ddsi_lathist_record_since (rd->m_lathist_listener, tlistener);
     data_avail_cb_leave_listener_exclusive_access (&rd->m_entity);
   }
   data_avail_cb_trigger_waitsets (&rd->m_entity, signal);
@@ -441,22 +455,36 @@ void dds_reader_invoke_cbs_for_pending_events(struct dds_entity *e, uint32_t sta
   }
   if ((status & DDS_DATA_AVAILABLE_STATUS)) {
     const uint32_t status_and_mask = ddsrt_atomic_ld32 (&e->m_status.m_status_and_mask);
-    (void) da_or_dor_cb_invoke(rdr, lst, status_and_mask, false);
+    // exclusive access to the subscriber's listener is needed because the listener threads
+    // may be handling other readers of the same subscriber concurrently
+    (void) da_or_dor_cb_invoke(rdr, lst, status_and_mask, true);
   }
 }
 
 static const struct dds_stat_keyvalue_descriptor dds_reader_statistics_kv[] = {
-  { "discarded_bytes", DDS_STAT_KIND_UINT64 }
+  { "discarded_bytes", DDS_STAT_KIND_UINT64 },
+  // stage latencies: only present if enabled in the configuration
+  DDS_STAT_LATENCY_KV ("rhc"),
+  DDS_STAT_LATENCY_KV ("listener"),
+  DDS_STAT_LATENCY_KV ("take")
 };
 
+#define DDS_READER_STATISTICS_NLAT 3
+
 static const struct dds_stat_descriptor dds_reader_statistics_desc = {
+  .count = sizeof (dds_reader_statistics_kv) / sizeof (dds_reader_statistics_kv[0]) - DDS_READER_STATISTICS_NLAT * DDS_STAT_LATENCY_NKV,
+  .kv = dds_reader_statistics_kv
+};
+
+static const struct dds_stat_descriptor dds_reader_statistics_lat_desc = {
   .count = sizeof (dds_reader_statistics_kv) / sizeof (dds_reader_statistics_kv[0]),
   .kv = dds_reader_statistics_kv
 };
 
 static struct dds_statistics *dds_reader_create_statistics (const struct dds_entity *entity)
 {
-  return dds_alloc_statistics (entity, &dds_reader_statistics_desc);
+  const struct dds_reader *rd = (const struct dds_reader *) entity;
+  return dds_alloc_statistics (entity, rd->m_lathist_rhc ? &dds_reader_statistics_lat_desc : &dds_reader_statistics_desc);
 }
 
 static void dds_reader_refresh_statistics (const struct dds_entity *entity, struct dds_statistics *stat)
@@ -464,6 +492,13 @@ static void dds_reader_refresh_statistics (const struct dds_entity *entity, stru
   const struct dds_reader *rd = (const struct dds_reader *) entity;
   if (rd->m_rd)
     ddsi_get_reader_stats (rd->m_rd, &stat->kv[0].u.u64);
+  if (stat->count > dds_reader_statistics_desc.count)
+  {
+    struct dds_stat_keyvalue * const kvlat = &stat->kv[dds_reader_statistics_desc.count];
+    dds_stat_fill_latency (&kvlat[0], rd->m_lathist_rhc);
+    dds_stat_fill_latency (&kvlat[DDS_STAT_LATENCY_NKV], rd->m_lathist_listener);
+    dds_stat_fill_latency (&kvlat[2 * DDS_STAT_LATENCY_NKV], rd->m_lathist_take);
+  }
 }
 
 const struct dds_entity_deriver dds_entity_deriver_reader = {
@@ -618,6 +653,12 @@ static dds_entity_t dds_create_reader_int (dds_entity_t participant_or_subscribe
   ddsrt_atomic_or32 (&rd->m_entity.m_status.m_status_and_mask, DDS_DATA_ON_READERS_STATUS << SAM_ENABLED_SHIFT);
   rd->m_sample_rejected_status.last_reason = DDS_NOT_REJECTED;
   rd->m_topic = tp;
+  if (gv->config.stage_latency_statistics)
+  {
+    rd->m_lathist_rhc = ddsi_lathist_new ();
+    rd->m_lathist_listener = ddsi_lathist_new ();
+    rd->m_lathist_take = ddsi_lathist_new ();
+  }
   rd->m_rhc = rhc ? rhc : dds_rhc_default_new (rd, tp->m_stype);
   rc = dds_loan_pool_create (&rd->m_loans, 0);
   assert (rc == DDS_RETCODE_OK); // FIXME: can be out of resources
@@ -655,15 +696,20 @@ static dds_entity_t dds_create_reader_int (dds_entity_t participant_or_subscribe
 
   struct ddsi_psmx_locators_set *vl_set = dds_get_psmx_locators_set (rqos, &rd->m_entity.m_domain->psmx_instances);
 
+  /* Holding the subscriber lock means changes to the topic's filter can't be propagated
+     until the reader is among its children, so it is fine to get the filter now */
+  struct ddsi_content_filter_property *cfp = dds_topic_filter_reader_content_filter (tp);
+
   /* Reader gets the sertype from the topic, as the serdata functions the reader uses are
      not specific for a data representation (the representation can be retrieved from the cdr header) */
-  rc = ddsi_new_reader (&rd->m_rd, &rd->m_entity.m_guid, NULL, pp, tp->m_name, tp->m_stype, rqos, &rd->m_rhc->common.rhc, dds_reader_status_cb, rd, vl_set);
+  rc = ddsi_new_reader (&rd->m_rd, &rd->m_entity.m_guid, NULL, pp, tp->m_name, tp->m_stype, rqos, cfp, &rd->m_rhc->common.rhc, dds_reader_status_cb, rd, vl_set);
   if (rc != DDS_RETCODE_OK)
   {
     /* FIXME: can be out-of-resources at the very least; would leak allocated entity id */
     abort ();
   }
   dds_psmx_locators_set_free (vl_set);
+  ddsi_content_filter_property_free (cfp);
   ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
 
   rd->m_entity.m_iid = ddsi_get_entity_instanceid (&rd->m_entity.m_domain->gv, &rd->m_entity.m_guid);
@@ -751,24 +797,9 @@ err:
   return ret;
 }
 
-static dds_return_t dds_reader_store_loaned_sample_impl (dds_entity_t reader, dds_loaned_sample_t *data, const struct writer_metadata *writer_md)
+static dds_return_t make_loaned_sample_serdata (struct ddsi_domaingv *gv, struct ddsi_reader *rd, dds_loaned_sample_t *data, const struct writer_metadata *writer_md, struct ddsi_serdata **sd, struct ddsi_writer_info *wi, struct ddsi_tkmap_instance **tk)
 {
-  dds_return_t ret = DDS_RETCODE_OK;
-  dds_entity * e;
-  if ((ret = dds_entity_pin (reader, &e)) < 0)
-    return ret;
-  else if (dds_entity_kind (e) != DDS_KIND_READER)
-  {
-    dds_entity_unpin (e);
-    return DDS_RETCODE_ILLEGAL_OPERATION;
-  }
-
-  dds_reader *dds_rd = (dds_reader *) e;
-  struct ddsi_reader *rd = dds_rd->m_rd;
-  struct ddsi_domaingv *gv = rd->e.gv;
-
-  ddsi_thread_state_awake (ddsi_lookup_thread_state (), gv);
-  ddsrt_mutex_lock (&rd->e.lock);
+  dds_return_t ret;
 
   // FIXME: what if the sample is overwritten?
   // if the sample is not matched to this reader, return ownership to the PSMX?
@@ -778,38 +809,78 @@ static dds_return_t dds_reader_store_loaned_sample_impl (dds_entity_t reader, dd
   struct ddsi_entity_common *lookup_entity = NULL;
   if ((lookup_entity = ddsi_entidx_lookup_guid_untyped (gv->entity_index, &ddsi_guid)) != NULL &&
       lookup_entity->kind == DDSI_EK_WRITER)
-    goto drop_local;
-
-  struct ddsi_serdata * sd = ddsi_serdata_from_psmx (rd->type, data);
-  if (sd == NULL)
   {
-    ret = DDS_RETCODE_ERROR;
-    goto fail_serdata;
+    *sd = NULL;
+    return DDS_RETCODE_OK;
   }
 
-  struct ddsi_writer_info wi;
-  if ((ret = get_writer_info (gv, &ddsi_guid, sd->statusinfo, writer_md, &wi)) != DDS_RETCODE_OK)
+  if ((*sd = ddsi_serdata_from_psmx (rd->type, data)) == NULL)
+    return DDS_RETCODE_ERROR;
+  if ((ret = get_writer_info (gv, &ddsi_guid, (*sd)->statusinfo, writer_md, wi)) != DDS_RETCODE_OK)
     goto fail_get_writer_info;
-
-  struct ddsi_tkmap_instance * tk = ddsi_tkmap_lookup_instance_ref (gv->m_tkmap, sd);
-  if (tk == NULL)
+  if ((*tk = ddsi_tkmap_lookup_instance_ref (gv->m_tkmap, *sd)) == NULL)
   {
     ret = DDS_RETCODE_BAD_PARAMETER;
     goto fail_get_writer_info;
   }
+  return DDS_RETCODE_OK;
+
+fail_get_writer_info:
+  ddsi_serdata_unref (*sd);
+  *sd = NULL;
+  return ret;
+}
 
-  if (!dds_rhc_store (dds_rd->m_rhc, &wi, sd, tk))
+// Number of loaned samples converted and stored in the RHC in one go, bounded so the
+// intermediate arrays can live on the stack
+#define STORE_LOANED_SAMPLES_BATCH 32
+
+static dds_return_t dds_reader_store_loaned_samples_impl (dds_entity_t reader, uint32_t n, dds_loaned_sample_t * const *data, const struct writer_metadata *writer_md)
+{
+  dds_return_t ret = DDS_RETCODE_OK;
+  dds_entity * e;
+  if ((ret = dds_entity_pin (reader, &e)) < 0)
+    return ret;
+  else if (dds_entity_kind (e) != DDS_KIND_READER)
   {
-    ret = DDS_RETCODE_ERROR;
-    goto fail_rhc_store;
+    dds_entity_unpin (e);
+    return DDS_RETCODE_ILLEGAL_OPERATION;
   }
 
-fail_rhc_store:
-  ddsi_tkmap_instance_unref (gv->m_tkmap, tk);
-fail_get_writer_info:
-  ddsi_serdata_unref (sd);
-drop_local:
-fail_serdata:
+  dds_reader *dds_rd = (dds_reader *) e;
+  struct ddsi_reader *rd = dds_rd->m_rd;
+  struct ddsi_domaingv *gv = rd->e.gv;
+
+  ddsi_thread_state_awake (ddsi_lookup_thread_state (), gv);
+  ddsrt_mutex_lock (&rd->e.lock);
+  uint32_t i = 0;
+  while (i < n)
+  {
+    struct ddsi_serdata *sds[STORE_LOANED_SAMPLES_BATCH];
+    struct ddsi_writer_info wis[STORE_LOANED_SAMPLES_BATCH];
+    struct ddsi_tkmap_instance *tks[STORE_LOANED_SAMPLES_BATCH];
+    bool delivered[STORE_LOANED_SAMPLES_BATCH];
+    uint32_t m = 0;
+    for (; i < n && m < STORE_LOANED_SAMPLES_BATCH; i++)
+    {
+      dds_return_t ret1 = make_loaned_sample_serdata (gv, rd, data[i], writer_md, &sds[m], &wis[m], &tks[m]);
+      if (ret1 != DDS_RETCODE_OK && ret == DDS_RETCODE_OK)
+        ret = ret1;
+      if (sds[m] != NULL)
+        m++;
+    }
+    if (m > 0)
+    {
+      dds_rhc_store_n (dds_rd->m_rhc, m, wis, sds, tks, delivered);
+      for (uint32_t j = 0; j < m; j++)
+      {
+        if (!delivered[j] && ret == DDS_RETCODE_OK)
+          ret = DDS_RETCODE_ERROR;
+        ddsi_tkmap_instance_unref (gv->m_tkmap, tks[j]);
+        ddsi_serdata_unref (sds[j]);
+      }
+    }
+  }
   ddsrt_mutex_unlock (&rd->e.lock);
   ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
   dds_entity_unpin (e);
@@ -818,13 +889,24 @@ fail_serdata:
 
 dds_return_t dds_reader_store_loaned_sample (dds_entity_t reader, dds_loaned_sample_t *data)
 {
-  return dds_reader_store_loaned_sample_impl (reader, data, NULL);
+  return dds_reader_store_loaned_samples_impl (reader, 1, &data, NULL);
 }
 
 dds_return_t dds_reader_store_loaned_sample_wr_metadata (dds_entity_t reader, dds_loaned_sample_t *data, int32_t ownership_strength, bool autodispose_unregistered_instances, dds_duration_t lifespan_duration)
 {
   struct writer_metadata writer_md = { .ownership_strength = ownership_strength, .autodispose_unregistered_instances = autodispose_unregistered_instances, .lifespan_duration = lifespan_duration };
-  return dds_reader_store_loaned_sample_impl (reader, data, &writer_md);
+  return dds_reader_store_loaned_samples_impl (reader, 1, &data, &writer_md);
+}
+
+dds_return_t dds_reader_store_loaned_samples (dds_entity_t reader, uint32_t n, dds_loaned_sample_t * const *data)
+{
+  return dds_reader_store_loaned_samples_impl (reader, n, data, NULL);
+}
+
+dds_return_t dds_reader_store_loaned_samples_wr_metadata (dds_entity_t reader, uint32_t n, dds_loaned_sample_t * const *data, int32_t ownership_strength, bool autodispose_unregistered_instances, dds_duration_t lifespan_duration)
+{
+  struct writer_metadata writer_md = { .ownership_strength = ownership_strength, .autodispose_unregistered_instances = autodispose_unregistered_instances, .lifespan_duration = lifespan_duration };
+  return dds_reader_store_loaned_samples_impl (reader, n, data, &writer_md);
 }
 
 dds_entity_t dds_create_reader (dds_entity_t participant_or_subscriber, dds_entity_t topic, const dds_qos_t *qos, const dds_listener_t *listener)
@@ -16,6 +16,7 @@
 
 DDS_EXPORT extern inline dds_return_t dds_rhc_associate (struct dds_rhc *rhc, struct dds_reader *reader, const struct ddsi_sertype *type, struct ddsi_tkmap *tkmap);
 DDS_EXPORT extern inline bool dds_rhc_store (struct dds_rhc *rhc, const struct ddsi_writer_info *wr_info, struct ddsi_serdata *sample, struct ddsi_tkmap_instance *tk);
+DDS_EXPORT extern inline void dds_rhc_store_n (struct dds_rhc *rhc, uint32_t n, const struct ddsi_writer_info *wr_info, struct ddsi_serdata * const *samples, struct ddsi_tkmap_instance * const *tks, bool *delivered);
 DDS_EXPORT extern inline void dds_rhc_unregister_wr (struct dds_rhc *rhc, const struct ddsi_writer_info *wr_info);
 DDS_EXPORT extern inline void dds_rhc_relinquish_ownership (struct dds_rhc *rhc, const uint64_t wr_iid);
 DDS_EXPORT extern inline void dds_rhc_set_qos (struct dds_rhc *rhc, const struct dds_qos *qos);
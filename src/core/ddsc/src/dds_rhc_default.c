@@ -25,6 +25,7 @@
 
 #include "dds__entity.h"
 #include "dds__reader.h"
+#include "dds__topic_filter.h"
 #include "dds__loaned_sample.h"
 #include "dds/ddsc/dds_rhc.h"
 #include "dds__rhc_default.h"
@@ -39,6 +40,8 @@
 #include "dds/ddsi/ddsi_radmin.h" /* sampleinfo */
 #include "dds/ddsi/ddsi_entity.h"
 #include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_lathist.h"
+#include "dds/ddsi/ddsi_deliver_locally.h"
 #ifdef DDS_HAS_LIFESPAN
 #include "dds/ddsi/ddsi_lifespan.h"
 #endif
@@ -245,6 +248,7 @@ struct rhc_sample {
   bool isread;                 /* READ or NOT_READ sample state */
   uint32_t disposed_gen;       /* snapshot of instance counter at time of insertion */
   uint32_t no_writers_gen;     /* __/ */
+  ddsrt_mtime_t tstore;        /* time of insertion, only set if lathist_take */
 #ifdef DDS_HAS_LIFESPAN
   struct ddsi_lifespan_fhnode lifespan;  /* fibheap node for lifespan */
   struct rhc_instance *inst;   /* reference to rhc instance */
@@ -319,12 +323,15 @@ struct dds_rhc_default {
   struct ddsi_domaingv *gv;          /* globals -- so far only for log config */
   const struct ddsi_sertype *type;   /* type description */
   uint32_t history_depth;            /* depth, 1 for KEEP_LAST_1, 2**32-1 for KEEP_ALL */
+  struct ddsi_lathist *lathist_store;  /* reader's stage latency histograms, NULL if disabled */
+  struct ddsi_lathist *lathist_take;   /* __/ */
 
   ddsrt_mutex_t lock;
   dds_readcond * conds;              /* List of associated read conditions */
   uint32_t nconds;                   /* Number of associated read conditions */
   uint32_t nqconds;                  /* Number of associated query conditions */
   dds_querycond_mask_t qconds_samplest;  /* Mask of associated query conditions that check the sample state */
+  dds_querycond_mask_t qconds_key;   /* Mask of associated query conditions that only depend on the key */
   void *qcond_eval_samplebuf;        /* Temporary storage for evaluating query conditions, NULL if no qconds */
 #ifdef DDS_HAS_LIFESPAN
   struct ddsi_lifespan_adm lifespan;      /* Lifespan administration */
@@ -576,6 +583,11 @@ struct dds_rhc *dds_rhc_default_new_xchecks (dds_reader *reader, struct ddsi_dom
   rhc->tkmap = gv->m_tkmap;
   rhc->gv = gv;
   rhc->xchecks = xchecks;
+  if (reader != NULL)
+  {
+    rhc->lathist_store = reader->m_lathist_rhc;
+    rhc->lathist_take = reader->m_lathist_take;
+  }
 
 #ifdef DDS_HAS_LIFESPAN
   ddsi_lifespan_init (gv, &rhc->lifespan, offsetof(struct dds_rhc_default, lifespan), offsetof(struct rhc_sample, lifespan), dds_rhc_default_sample_expired_cb);
@@ -619,6 +631,16 @@ static void dds_rhc_default_set_qos (struct ddsi_rhc *rhc_common, const dds_qos_
   rhc->deadline.dur = qos->deadline.deadline; */
 }
 
+static void dds_rhc_default_get_stats (struct ddsi_rhc *rhc_common, struct ddsi_rhc_stats *stats)
+{
+  struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
+  ddsrt_mutex_lock (&rhc->lock);
+  stats->n_instances = rhc->n_instances;
+  stats->n_samples = rhc->n_vsamples + rhc->n_invsamples;
+  stats->n_read = rhc->n_vread + rhc->n_invread;
+  ddsrt_mutex_unlock (&rhc->lock);
+}
+
 static bool eval_predicate_sample (const struct dds_rhc_default *rhc, const struct ddsi_serdata *sample, bool (*pred) (const void *sample))
 {
   // What to do if deserialization fails? Consider it matching or not?
@@ -640,6 +662,67 @@ static bool eval_predicate_invsample (const struct dds_rhc_default *rhc, const s
   return ret;
 }
 
+static dds_querycond_mask_t eval_qconds_sample (const struct dds_rhc_default *rhc, const struct rhc_instance *inst, const struct ddsi_serdata *sample)
+{
+  // Key-only conditions were evaluated when the instance was created, for the others the
+  // sample needs to be deserialized, but only once for all of them
+  dds_querycond_mask_t conds = inst->conds & rhc->qconds_key;
+  bool deserialized = false, asifmatch = false;
+  for (dds_readcond *rc = rhc->conds; rc != NULL; rc = rc->m_next)
+  {
+    if (rc->m_query.m_filter == NULL || rc->m_query.m_key_only)
+      continue;
+    if (!deserialized)
+    {
+      // Follow error handling choices made in eval_predicate_sample()
+      asifmatch = !ddsi_serdata_to_sample (sample, rhc->qcond_eval_samplebuf, NULL, NULL);
+      deserialized = true;
+    }
+    if (asifmatch || rc->m_query.m_filter (rhc->qcond_eval_samplebuf))
+      conds |= rc->m_query.m_qcmask;
+  }
+  return conds;
+}
+
+static dds_querycond_mask_t eval_qconds_invsample (const struct dds_rhc_default *rhc, const struct rhc_instance *inst)
+{
+  dds_querycond_mask_t conds = 0;
+  bool converted = false;
+  for (dds_readcond *rc = rhc->conds; rc != NULL; rc = rc->m_next)
+  {
+    assert ((dds_entity_kind (&rc->m_entity) == DDS_KIND_COND_READ && rc->m_query.m_filter == 0) ||
+            (dds_entity_kind (&rc->m_entity) == DDS_KIND_COND_QUERY && rc->m_query.m_filter != 0));
+    if (rc->m_query.m_filter == NULL)
+      continue;
+    if (!converted)
+    {
+      untyped_to_clean_invsample (rhc->type, inst->tk->m_sample, rhc->qcond_eval_samplebuf, NULL, NULL);
+      converted = true;
+    }
+    if (rc->m_query.m_filter (rhc->qcond_eval_samplebuf))
+      conds |= rc->m_query.m_qcmask;
+  }
+  return conds;
+}
+
+static void qcond_index_add_instance (const struct dds_rhc_default *rhc, struct rhc_instance *inst)
+{
+  if ((inst->conds & rhc->qconds_key) == 0)
+    return;
+  for (dds_readcond *rc = rhc->conds; rc != NULL; rc = rc->m_next)
+    if (rc->m_query.m_index && (inst->conds & rc->m_query.m_qcmask))
+      ddsrt_hh_add_absent (rc->m_query.m_index, inst);
+}
+
+static void qcond_index_remove_instance (const struct dds_rhc_default *rhc, struct rhc_instance *inst)
+{
+  if ((inst->conds & rhc->qconds_key) == 0)
+    return;
+  for (dds_readcond *rc = rhc->conds; rc != NULL; rc = rc->m_next)
+    if (rc->m_query.m_index && (inst->conds & rc->m_query.m_qcmask))
+      ddsrt_hh_remove_present (rc->m_query.m_index, inst);
+}
+
 static struct rhc_sample *alloc_sample (struct rhc_instance *inst)
 {
   if (inst->a_sample_free)
@@ -914,19 +997,14 @@ static bool add_sample (struct dds_rhc_default *rhc, struct rhc_instance *inst,
   s->isread = false;
   s->disposed_gen = inst->disposed_gen;
   s->no_writers_gen = inst->no_writers_gen;
+  s->tstore = ddsi_lathist_start (rhc->lathist_take);
 #ifdef DDS_HAS_LIFESPAN
   s->inst = inst;
   s->lifespan.t_expire = wrinfo->lifespan_exp;
   ddsi_lifespan_register_sample_locked (&rhc->lifespan, &s->lifespan);
 #endif
 
-  s->conds = 0;
-  if (rhc->nqconds != 0)
-  {
-    for (dds_readcond *rc = rhc->conds; rc != NULL; rc = rc->m_next)
-      if (rc->m_query.m_filter != NULL && eval_predicate_sample (rhc, s->sample, rc->m_query.m_filter))
-        s->conds |= rc->m_query.m_qcmask;
-  }
+  s->conds = (rhc->nqconds != 0) ? eval_qconds_sample (rhc, inst, s->sample) : 0;
 
   trig_qc->inc_conds_sample = s->conds;
   inst->latest = s;
@@ -972,6 +1050,9 @@ static bool content_filter_accepts (const dds_reader *reader, const struct ddsi_
       case DDS_TOPIC_FILTER_NONE:
         ret = true;
         break;
+      case DDS_TOPIC_FILTER_PREDICATES:
+        ret = dds_topic_filter_predicates_accept_serdata (tp->m_filter_preds, sample);
+        break;
       case DDS_TOPIC_FILTER_SAMPLEINFO_ARG: {
         struct dds_sample_info si;
         content_filter_make_sampleinfo (&si, sample, inst, wr_iid, iid);
@@ -981,9 +1062,18 @@ static bool content_filter_accepts (const dds_reader *reader, const struct ddsi_
       case DDS_TOPIC_FILTER_SAMPLE:
       case DDS_TOPIC_FILTER_SAMPLE_ARG:
       case DDS_TOPIC_FILTER_SAMPLE_SAMPLEINFO_ARG: {
-        char *tmp;
-        tmp = ddsi_sertype_alloc_sample (tp->m_stype);
-        if (!ddsi_serdata_to_sample (sample, tmp, NULL, NULL))
+        // readers receiving the same payload share the deserialized sample,
+        // outside local delivery (e.g., PSMX) there is nothing to share
+        void *tmp = NULL;
+        bool valid;
+        const void *fs = ddsi_deliver_locally_sample (sample, &valid);
+        if (fs == NULL)
+        {
+          tmp = ddsi_sertype_alloc_sample (tp->m_stype);
+          valid = ddsi_serdata_to_sample (sample, tmp, NULL, NULL);
+          fs = tmp;
+        }
+        if (!valid)
         {
           // Samples we can't deserialize are (presumably) best never inserted
           ret = false;
@@ -994,22 +1084,24 @@ static bool content_filter_accepts (const dds_reader *reader, const struct ddsi_
           {
             case DDS_TOPIC_FILTER_NONE:
             case DDS_TOPIC_FILTER_SAMPLEINFO_ARG:
+            case DDS_TOPIC_FILTER_PREDICATES:
               assert (0);
             case DDS_TOPIC_FILTER_SAMPLE:
-              ret = (tp->m_filter.f.sample) (tmp);
+              ret = (tp->m_filter.f.sample) (fs);
               break;
             case DDS_TOPIC_FILTER_SAMPLE_ARG:
-              ret = (tp->m_filter.f.sample_arg) (tmp, tp->m_filter.arg);
+              ret = (tp->m_filter.f.sample_arg) (fs, tp->m_filter.arg);
               break;
             case DDS_TOPIC_FILTER_SAMPLE_SAMPLEINFO_ARG: {
               struct dds_sample_info si;
               content_filter_make_sampleinfo (&si, sample, inst, wr_iid, iid);
-              ret = tp->m_filter.f.sample_sampleinfo_arg (tmp, &si, tp->m_filter.arg);
+              ret = tp->m_filter.f.sample_sampleinfo_arg (fs, &si, tp->m_filter.arg);
               break;
             }
           }
         }
-        ddsi_sertype_free_sample (tp->m_stype, tmp, DDS_FREE_ALL);
+        if (tmp)
+          ddsi_sertype_free_sample (tp->m_stype, tmp, DDS_FREE_ALL);
         break;
       }
     }
@@ -1098,6 +1190,7 @@ static void drop_instance_noupdate_no_writers (struct dds_rhc_default *rhc, stru
   if (inst->isnew)
     rhc->n_new--;
 
+  qcond_index_remove_instance (rhc, inst);
   ddsrt_hh_remove_present (rhc->instances, inst);
   free_empty_instance (inst, rhc);
   *instptr = NULL;
@@ -1416,15 +1509,7 @@ static struct rhc_instance *alloc_new_instance (struct dds_rhc_default *rhc, con
   inst->strength = wrinfo->ownership_strength;
 
   if (rhc->nqconds != 0)
-  {
-    for (dds_readcond *c = rhc->conds; c != NULL; c = c->m_next)
-    {
-      assert ((dds_entity_kind (&c->m_entity) == DDS_KIND_COND_READ && c->m_query.m_filter == 0) ||
-              (dds_entity_kind (&c->m_entity) == DDS_KIND_COND_QUERY && c->m_query.m_filter != 0));
-      if (c->m_query.m_filter && eval_predicate_invsample (rhc, inst, c->m_query.m_filter))
-        inst->conds |= c->m_query.m_qcmask;
-    }
-  }
+    inst->conds = eval_qconds_invsample (rhc, inst);
   return inst;
 }
 
@@ -1482,6 +1567,7 @@ static rhc_store_result_t rhc_store_new_instance (struct rhc_instance **out_inst
   ret = ddsrt_hh_add (rhc->instances, inst);
   assert (ret);
   (void) ret;
+  qcond_index_add_instance (rhc, inst);
   rhc->n_instances++;
   rhc->n_new++;
 
@@ -1567,11 +1653,13 @@ static void update_viewstate_and_disposedness (struct dds_rhc_default *rhc, stru
 /*
   dds_rhc_store: DDSI up call into read cache to store new sample. Returns whether sample
   delivered (true unless a reliable sample rejected).
+
+  The locked variant requires the caller to hold rhc->lock and to invoke the data
+  available and status callbacks after releasing it.
 */
 
-static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct ddsi_writer_info *wrinfo, struct ddsi_serdata *sample, struct ddsi_tkmap_instance *tk)
+static bool dds_rhc_default_store_locked (struct dds_rhc_default * const rhc, const struct ddsi_writer_info *wrinfo, struct ddsi_serdata *sample, struct ddsi_tkmap_instance *tk, bool *notify_data_available_out, ddsi_status_cb_data_t *cb_data)
 {
-  struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
   const uint64_t wr_iid = wrinfo->iid;
   const uint32_t statusinfo = sample->statusinfo;
   const bool has_data = (sample->kind == SDK_DATA);
@@ -1582,9 +1670,9 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
   struct trigger_info_post post;
   struct trigger_info_qcond trig_qc;
   rhc_store_result_t stored;
-  ddsi_status_cb_data_t cb_data;   /* Callback data for reader status callback */
   bool notify_data_available;
 
+  cb_data->raw_status_id = -1;
   TRACE ("rhc_store %"PRIx64",%"PRIx64" si %"PRIx32" has_data %d:", tk->m_iid, wr_iid, statusinfo, has_data);
   if (!has_data && statusinfo == 0)
   {
@@ -1598,12 +1686,9 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
   notify_data_available = false;
   dummy_instance.iid = tk->m_iid;
   stored = RHC_FILTERED;
-  cb_data.raw_status_id = -1;
 
   init_trigger_info_qcond (&trig_qc);
 
-  ddsrt_mutex_lock (&rhc->lock);
-
   inst = ddsrt_hh_lookup (rhc->instances, &dummy_instance);
   if (inst == NULL)
   {
@@ -1619,7 +1704,7 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
     else
     {
       TRACE (" new instance\n");
-      stored = rhc_store_new_instance (&inst, rhc, wrinfo, sample, tk, has_data, &cb_data, &trig_qc, &notify_data_available);
+      stored = rhc_store_new_instance (&inst, rhc, wrinfo, sample, tk, has_data, cb_data, &trig_qc, &notify_data_available);
       if (stored != RHC_STORED)
         goto error_or_nochange;
 
@@ -1652,10 +1737,10 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
     }
 
     /* notify sample lost */
-    cb_data.raw_status_id = (int) DDS_SAMPLE_LOST_STATUS_ID;
-    cb_data.extra = 0;
-    cb_data.handle = 0;
-    cb_data.add = true;
+    cb_data->raw_status_id = (int) DDS_SAMPLE_LOST_STATUS_ID;
+    cb_data->extra = 0;
+    cb_data->handle = 0;
+    cb_data->add = true;
   }
   else
   {
@@ -1690,7 +1775,7 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
       if (has_data)
       {
         TRACE (" add_sample");
-        if (!add_sample (rhc, inst, wrinfo, sample, &cb_data, &trig_qc, &notify_data_available))
+        if (!add_sample (rhc, inst, wrinfo, sample, cb_data, &trig_qc, &notify_data_available))
         {
           TRACE ("(reject)\n");
           stored = RHC_REJECTED;
@@ -1758,7 +1843,23 @@ static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct dds
   postprocess_instance_update (rhc, &inst, &pre, &post, &trig_qc);
 
 error_or_nochange:
+  if (notify_data_available)
+    *notify_data_available_out = true;
+  return !(rhc->reliable && stored == RHC_REJECTED);
+}
+
+static bool dds_rhc_default_store (struct ddsi_rhc *rhc_common, const struct ddsi_writer_info *wrinfo, struct ddsi_serdata *sample, struct ddsi_tkmap_instance *tk)
+{
+  struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
+  ddsi_status_cb_data_t cb_data;   /* Callback data for reader status callback */
+  bool notify_data_available = false;
+  bool delivered;
+
+  const ddsrt_mtime_t tstart = ddsi_lathist_start (rhc->lathist_store);
+  ddsrt_mutex_lock (&rhc->lock);
+  delivered = dds_rhc_default_store_locked (rhc, wrinfo, sample, tk, &notify_data_available, &cb_data);
   ddsrt_mutex_unlock (&rhc->lock);
+  ddsi_lathist_record_since (rhc->lathist_store, tstart);
 
   if (rhc->reader)
   {
@@ -1767,7 +1868,36 @@ error_or_nochange:
     if (cb_data.raw_status_id >= 0)
       dds_reader_status_cb (&rhc->reader->m_entity, &cb_data);
   }
-  return !(rhc->reliable && stored == RHC_REJECTED);
+  return delivered;
+}
+
+static void dds_rhc_default_store_n (struct dds_rhc *rhc_common, uint32_t n, const struct ddsi_writer_info *wrinfo, struct ddsi_serdata * const *samples, struct ddsi_tkmap_instance * const *tks, bool *delivered)
+{
+  struct dds_rhc_default * const rhc = (struct dds_rhc_default *) rhc_common;
+  bool notify_data_available = false;
+
+  const ddsrt_mtime_t tstart = ddsi_lathist_start (rhc->lathist_store);
+  ddsrt_mutex_lock (&rhc->lock);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    ddsi_status_cb_data_t cb_data;
+    delivered[i] = dds_rhc_default_store_locked (rhc, &wrinfo[i], samples[i], tks[i], &notify_data_available, &cb_data);
+    if (cb_data.raw_status_id >= 0 && rhc->reader)
+    {
+      /* Status callbacks are rare (sample lost/rejected) and must be invoked without
+         holding the RHC lock; data available is signalled only once for the batch */
+      ddsrt_mutex_unlock (&rhc->lock);
+      dds_reader_status_cb (&rhc->reader->m_entity, &cb_data);
+      ddsrt_mutex_lock (&rhc->lock);
+    }
+  }
+  ddsrt_mutex_unlock (&rhc->lock);
+  // attribute an equal share of the time to each sample in the batch
+  if (rhc->lathist_store && n > 0)
+    ddsi_lathist_record_n (rhc->lathist_store, (ddsrt_time_monotonic ().v - tstart.v) / n, n);
+
+  if (rhc->reader && notify_data_available)
+    dds_reader_data_available_cb (rhc->reader);
 }
 
 static void dds_rhc_default_unregister_wr (struct ddsi_rhc *rhc_common, const struct ddsi_writer_info *wrinfo)
@@ -2003,8 +2133,10 @@ struct readtake_w_qminv_inst_state {
   int32_t *limit;
   uint32_t qminv;
   dds_querycond_mask_t qcmask;
+  const dds_readcond *keycond; /* key-only query condition, its index is used if attached to this RHC */
   dds_read_with_collector_fn_t collect_sample;
   void *collect_sample_arg;
+  ddsrt_mtime_t tnow; /* only set if rhc->lathist_take */
 };
 
 static bool readtake_w_qminv_inst_get_rank_info_shortcut (const struct readtake_w_qminv_inst_state *state, struct rhc_instance * const inst, int32_t *limit_at_end_of_instance, uint32_t *last_generation_in_result, bool *invalid_sample_included)
@@ -2143,6 +2275,8 @@ static int32_t read_w_qminv_inst_validsamples (const struct readtake_w_qminv_ins
       }
       if (mark_as_read && !sample->isread)
       {
+        if (state->rhc->lathist_take)
+          ddsi_lathist_record (state->rhc->lathist_take, state->tnow.v - sample->tstore.v);
         read_sample_update_conditions (state->rhc, pre, post, trig_qc, inst, sample->conds, false);
         sample->isread = true;
         inst->nvread++;
@@ -2194,6 +2328,10 @@ static int32_t take_w_qminv_inst_validsamples (const struct readtake_w_qminv_ins
         inst->nvread--;
         state->rhc->n_vread--;
       }
+      else if (state->rhc->lathist_take)
+      {
+        ddsi_lathist_record (state->rhc->lathist_take, state->tnow.v - sample->tstore.v);
+      }
       if (--inst->nvsamples == 0)
         inst->latest = NULL;
       else
@@ -2330,12 +2468,25 @@ abort_on_error: ;
   return rc;
 }
 
+static struct ddsrt_hh *keycond_index_locked (const struct dds_rhc_default *rhc, const dds_readcond *keycond)
+{
+  // The index can only be used if the condition is attached to this RHC: rhc_torture also
+  // uses conditions to read from RHCs they are not attached to
+  if (keycond == NULL)
+    return NULL;
+  for (const dds_readcond *rc = rhc->conds; rc != NULL; rc = rc->m_next)
+    if (rc == keycond)
+      return keycond->m_query.m_index;
+  return NULL;
+}
+
 static dds_return_t read_w_qminv (const struct readtake_w_qminv_inst_state *state, bool mark_as_read, dds_instance_handle_t handle)
 {
   struct dds_rhc_default * const rhc = state->rhc;
   dds_return_t rc = DDS_RETCODE_OK;
   assert (0 < *state->limit && *state->limit <= INT32_MAX);
   ddsrt_mutex_lock (&rhc->lock);
+  struct ddsrt_hh * const index = keycond_index_locked (rhc, state->keycond);
 
   TRACE ("read_w_qminv(%p,%"PRId32",%"PRIx32",%"PRIx64") - inst %"PRIu32" nonempty %"PRIu32" disp %"PRIu32" nowr %"PRIu32" new %"PRIu32" samples %"PRIu32"+%"PRIu32" read %"PRIu32"+%"PRIu32"\n", (void*) rhc, *state->limit, state->qminv, handle,
     rhc->n_instances, rhc->n_nonempty_instances, rhc->n_not_alive_disposed,
@@ -2350,6 +2501,14 @@ static dds_return_t read_w_qminv (const struct readtake_w_qminv_inst_state *stat
     else
       rc = DDS_RETCODE_PRECONDITION_NOT_MET;
   }
+  else if (index)
+  {
+    // Only the instances matching a key-only query condition can contribute (the index also
+    // contains empty instances, but those are skipped by read_w_qminv_inst)
+    struct ddsrt_hh_iter it;
+    for (struct rhc_instance *inst = ddsrt_hh_iter_first (index, &it); inst != NULL && rc >= 0 && *state->limit > 0; inst = ddsrt_hh_iter_next (&it))
+      rc = read_w_qminv_inst (state, mark_as_read, inst);
+  }
   else if (!ddsrt_circlist_isempty (&rhc->nonempty_instances))
   {
     struct rhc_instance * inst = oldest_nonempty_instance (rhc);
@@ -2371,6 +2530,7 @@ static dds_return_t take_w_qminv (const struct readtake_w_qminv_inst_state *stat
   dds_return_t rc = DDS_RETCODE_OK;
   assert (0 < *state->limit && *state->limit <= INT32_MAX);
   ddsrt_mutex_lock (&rhc->lock);
+  struct ddsrt_hh * const index = keycond_index_locked (rhc, state->keycond);
 
   TRACE ("take_w_qminv(%p,%"PRId32",%"PRIx32",%"PRIx64") - inst %"PRIu32" nonempty %"PRIu32" disp %"PRIu32" nowr %"PRIu32" new %"PRIu32" samples %"PRIu32"+%"PRIu32" read %"PRIu32"+%"PRIu32"\n", (void*) rhc, *state->limit, state->qminv, handle,
     rhc->n_instances, rhc->n_nonempty_instances, rhc->n_not_alive_disposed,
@@ -2385,6 +2545,18 @@ static dds_return_t take_w_qminv (const struct readtake_w_qminv_inst_state *stat
     else
       rc = DDS_RETCODE_PRECONDITION_NOT_MET;
   }
+  else if (index)
+  {
+    // Taking may drop the instance and remove it from the index, but removing an entry
+    // from a hopscotch hash table doesn't move other entries and so the iterator remains
+    // valid
+    struct ddsrt_hh_iter it;
+    for (struct rhc_instance *inst = ddsrt_hh_iter_first (index, &it); inst != NULL && rc >= 0 && *state->limit > 0; inst = ddsrt_hh_iter_next (&it))
+    {
+      struct rhc_instance *inst1 = inst;
+      rc = take_w_qminv_inst (state, &inst1);
+    }
+  }
   else if (!ddsrt_circlist_isempty (&rhc->nonempty_instances))
   {
     struct rhc_instance *inst = oldest_nonempty_instance (rhc);
@@ -2506,6 +2678,12 @@ static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_r
   {
     if (cond_is_sample_state_dependent (cond))
       rhc->qconds_samplest |= cond->m_query.m_qcmask;
+    if (cond->m_query.m_key_only)
+    {
+      rhc->qconds_key |= cond->m_query.m_qcmask;
+      assert (cond->m_query.m_index == NULL);
+      cond->m_query.m_index = ddsrt_hh_new (1, instance_iid_hash, instance_iid_eq);
+    }
     if (rhc->nqconds++ == 0)
     {
       assert (rhc->qcond_eval_samplebuf == NULL);
@@ -2513,7 +2691,8 @@ static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_r
     }
 
     /* Attaching a query condition means clearing the allocated bit in all instances and
-       samples, except for those that match the predicate. */
+       samples, except for those that match the predicate.  For a key-only condition, the
+       outcome for the instance applies to all its samples. */
     const dds_querycond_mask_t qcmask = cond->m_query.m_qcmask;
     for (struct rhc_instance *inst = ddsrt_hh_iter_first (rhc->instances, &it); inst != NULL; inst = ddsrt_hh_iter_next (&it))
     {
@@ -2521,11 +2700,13 @@ static bool dds_rhc_default_add_readcondition (struct dds_rhc *rhc_common, dds_r
       uint32_t matches = 0;
 
       inst->conds = (inst->conds & ~qcmask) | (instmatch ? qcmask : 0);
+      if (instmatch && cond->m_query.m_index)
+        ddsrt_hh_add_absent (cond->m_query.m_index, inst);
       if (inst->latest)
       {
         struct rhc_sample *sample = inst->latest->next, * const end = sample;
         do {
-          const bool m = eval_predicate_sample (rhc, sample->sample, cond->m_query.m_filter);
+          const bool m = cond->m_query.m_key_only ? instmatch : eval_predicate_sample (rhc, sample->sample, cond->m_query.m_filter);
           sample->conds = (sample->conds & ~qcmask) | (m ? qcmask : 0);
           matches += m;
           sample = sample->next;
@@ -2565,7 +2746,13 @@ static void dds_rhc_default_remove_readcondition (struct dds_rhc *rhc_common, dd
   {
     rhc->nqconds--;
     rhc->qconds_samplest &= ~cond->m_query.m_qcmask;
+    rhc->qconds_key &= ~cond->m_query.m_qcmask;
     cond->m_query.m_qcmask = 0;
+    if (cond->m_query.m_index)
+    {
+      ddsrt_hh_free (cond->m_query.m_index);
+      cond->m_query.m_index = NULL;
+    }
     if (rhc->nqconds == 0)
     {
       assert (rhc->qcond_eval_samplebuf != NULL);
@@ -2607,8 +2794,9 @@ static bool update_conditions_locked (struct dds_rhc_default *rhc, bool called_f
     m_post = ((post->c.qminst & iter->m_qminv) == 0);
 
     /* Fast path out: instance did not and will not match based on instance, view states, so no
-       need to evaluate anything else */
-    if (!m_pre && !m_post)
+       need to evaluate anything else; same if the instance doesn't match a key-only query
+       condition, because then none of its samples do */
+    if ((!m_pre && !m_post) || (inst && iter->m_query.m_key_only && !(inst->conds & iter->m_query.m_qcmask)))
     {
       iter = iter->m_next;
       continue;
@@ -2790,8 +2978,10 @@ static struct readtake_w_qminv_inst_state make_readtake_w_qminv_inst_state (stru
     .limit = limit,
     .qminv = qmask_from_mask_n_cond (mask, cond),
     .qcmask = (cond && cond->m_query.m_filter) ? cond->m_query.m_qcmask : 0,
+    .keycond = (cond && cond->m_query.m_key_only) ? cond : NULL,
     .collect_sample = collect_sample,
-    .collect_sample_arg = collect_sample_arg
+    .collect_sample_arg = collect_sample_arg,
+    .tnow = ddsi_lathist_start (rhc->lathist_take)
   };
   return st;
 }
@@ -2919,6 +3109,9 @@ static bool rhc_check_counts_locked (struct dds_rhc_default *rhc, bool check_con
           if (rciter->m_query.m_filter != 0 && rciter->m_query.m_filter (rhc->qcond_eval_samplebuf))
             qcmask |= rciter->m_query.m_qcmask;
         assert ((inst->conds & enabled_qcmask) == qcmask);
+        for (rciter = rhc->conds; rciter; rciter = rciter->m_next)
+          if (rciter->m_query.m_index)
+            assert ((ddsrt_hh_lookup (rciter->m_query.m_index, inst) != NULL) == ((inst->conds & rciter->m_query.m_qcmask) != 0));
         if (inst->latest)
         {
           struct rhc_sample *sample = inst->latest->next, * const end = sample;
@@ -2927,8 +3120,14 @@ static bool rhc_check_counts_locked (struct dds_rhc_default *rhc, bool check_con
             const bool asifmatch = !ddsi_serdata_to_sample (sample->sample, rhc->qcond_eval_samplebuf, NULL, NULL);
             qcmask = 0;
             for (rciter = rhc->conds; rciter; rciter = rciter->m_next)
-              if (rciter->m_query.m_filter != 0 && (asifmatch || rciter->m_query.m_filter (rhc->qcond_eval_samplebuf)))
+            {
+              if (rciter->m_query.m_filter == 0)
+                continue;
+              else if (rciter->m_query.m_key_only)
+                qcmask |= inst->conds & rciter->m_query.m_qcmask;
+              else if (asifmatch || rciter->m_query.m_filter (rhc->qcond_eval_samplebuf))
                 qcmask |= rciter->m_query.m_qcmask;
+            }
             assert ((sample->conds & enabled_qcmask) == qcmask);
             sample = sample->next;
           } while (sample != end);
@@ -3007,12 +3206,14 @@ static const struct dds_rhc_ops dds_rhc_default_ops = {
     .unregister_wr = dds_rhc_default_unregister_wr,
     .relinquish_ownership = dds_rhc_default_relinquish_ownership,
     .set_qos = dds_rhc_default_set_qos,
-    .free = dds_rhc_default_free
+    .free = dds_rhc_default_free,
+    .get_stats = dds_rhc_default_get_stats
   },
   .peek = dds_rhc_default_peek,
   .read = dds_rhc_default_read,
   .take = dds_rhc_default_take,
   .add_readcondition = dds_rhc_default_add_readcondition,
   .remove_readcondition = dds_rhc_default_remove_readcondition,
-  .associate = dds_rhc_default_associate
+  .associate = dds_rhc_default_associate,
+  .store_n = dds_rhc_default_store_n
 };
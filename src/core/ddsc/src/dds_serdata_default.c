@@ -538,6 +538,18 @@ static void istream_from_serdata_default (dds_istream_t *s, const struct dds_ser
   s->m_xcdr_version = ddsi_sertype_enc_id_xcdr_version (d->hdr.identifier);
 }
 
+bool dds_serdata_default_istream (const struct ddsi_serdata *serdata_common, dds_istream_t *is)
+{
+  const struct dds_serdata_default *d = (const struct dds_serdata_default *) serdata_common;
+  assert (d->c.kind == SDK_DATA);
+  if (d->c.loan != NULL &&
+      (d->c.loan->metadata->sample_state == DDS_LOANED_SAMPLE_STATE_RAW_DATA ||
+       d->c.loan->metadata->sample_state == DDS_LOANED_SAMPLE_STATE_RAW_KEY))
+    return false;
+  istream_from_serdata_default (is, d);
+  return true;
+}
+
 static void ostream_from_serdata_default (dds_ostream_t *s, const struct dds_serdata_default *d)
 {
   s->m_buffer = (unsigned char *) d;
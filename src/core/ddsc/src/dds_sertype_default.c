@@ -27,6 +27,7 @@
 #include "dds/cdr/dds_cdrstream.h"
 #include "dds__serdata_default.h"
 #include "dds__psmx.h"
+#include "dds__topic_filter.h"
 
 static bool sertype_default_equal (const struct ddsi_sertype *acmn, const struct ddsi_sertype *bcmn)
 {
@@ -242,7 +243,7 @@ static bool sertype_default_serialize_into (const struct ddsi_sertype *tpcmn, en
 }
 
 const struct ddsi_sertype_ops dds_sertype_ops_default = {
-  .version = ddsi_sertype_v0,
+  .version = ddsi_sertype_v1,
   .arg = 0,
   .equal = sertype_default_equal,
   .hash = sertype_default_hash,
@@ -261,7 +262,8 @@ const struct ddsi_sertype_ops dds_sertype_ops_default = {
 #endif
   .derive_sertype = sertype_default_derive_sertype,
   .get_serialized_size = sertype_default_get_serialized_size,
-  .serialize_into = sertype_default_serialize_into
+  .serialize_into = sertype_default_serialize_into,
+  .content_filter_new = dds_topic_filter_content_filter_new
 };
 
 dds_return_t dds_sertype_default_init (const struct dds_domain *domain, struct dds_sertype_default *st, const dds_topic_descriptor_t *desc, uint16_t min_xcdrv, dds_data_representation_id_t data_representation)
@@ -14,6 +14,7 @@
 #include "dds/ddsc/dds_statistics.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/log.h"
+#include "dds/ddsi/ddsi_lathist.h"
 #include "dds__entity.h"
 #include "dds__statistics.h"
 
@@ -33,6 +34,18 @@ struct dds_statistics *dds_alloc_statistics (const struct dds_entity *e, const s
   return s;
 }
 
+void dds_stat_fill_latency (struct dds_stat_keyvalue *kv, const struct ddsi_lathist *h)
+{
+  struct ddsi_lathist_summary s = { 0 };
+  if (h)
+    ddsi_lathist_summarize (h, &s);
+  kv[0].u.u64 = s.count;
+  kv[1].u.u64 = s.p50;
+  kv[2].u.u64 = s.p90;
+  kv[3].u.u64 = s.p99;
+  kv[4].u.u64 = s.max;
+}
+
 struct dds_statistics *dds_create_statistics (dds_entity_t entity)
 {
   dds_entity *e;
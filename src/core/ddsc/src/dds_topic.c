@@ -18,6 +18,7 @@
 #include "dds/ddsrt/string.h"
 #include "dds/ddsrt/hopscotch.h"
 #include "dds__topic.h"
+#include "dds__topic_filter.h"
 #include "dds__listener.h"
 #include "dds__participant.h"
 #include "dds__init.h"
@@ -239,6 +240,7 @@ static void dds_topic_close (dds_entity *e)
   ddsi_type_unref_sertype (&e->m_domain->gv, tp->m_stype);
 #endif
   dds_free (tp->m_name);
+  dds_topic_filter_predicates_free (tp->m_filter_preds);
 
   ddsrt_mutex_lock (&pp->m_entity.m_mutex);
 
@@ -963,6 +965,48 @@ dds_entity_t dds_find_topic_scoped (dds_find_scope_t scope, dds_entity_t partici
   return dds_find_topic_impl (scope, participant, name, NULL, timeout);
 }
 
+static void update_readers_content_filter (dds_entity_t topic)
+{
+  // Readers advertise the predicates in discovery, so that remote writers can
+  // do the filtering.  Lock order is subscriber, then topic.
+  dds_participant *pp;
+  dds_entity *sub;
+  dds_topic *t;
+  if (dds_topic_pin (topic, &t) < 0)
+    return;
+  pp = dds_entity_participant (&t->m_entity);
+  ddsi_thread_state_awake (ddsi_lookup_thread_state (), &t->m_entity.m_domain->gv);
+  ddsrt_mutex_lock (&pp->m_entity.m_mutex);
+  dds_instance_handle_t last_iid = 0;
+  while ((sub = ddsrt_avl_lookup_succ (&dds_entity_children_td, &pp->m_entity.m_children, &last_iid)) != NULL)
+  {
+    dds_entity *x;
+    last_iid = sub->m_iid;
+    if (dds_entity_kind (sub) != DDS_KIND_SUBSCRIBER || dds_entity_pin (sub->m_hdllink.hdl, &x) < 0)
+      continue;
+    ddsrt_mutex_unlock (&pp->m_entity.m_mutex);
+    ddsrt_mutex_lock (&x->m_mutex);
+    ddsrt_avl_iter_t it;
+    for (dds_entity *rd = ddsrt_avl_iter_first (&dds_entity_children_td, &x->m_children, &it); rd; rd = ddsrt_avl_iter_next (&it))
+    {
+      dds_entity *y;
+      if (dds_entity_kind (rd) != DDS_KIND_READER || ((dds_reader *) rd)->m_topic != t)
+        continue;
+      if (dds_entity_pin (rd->m_hdllink.hdl, &y) < 0)
+        continue;
+      if (((dds_reader *) y)->m_rd)
+        dds_topic_filter_update_reader_content_filter ((dds_reader *) y);
+      dds_entity_unpin (y);
+    }
+    ddsrt_mutex_unlock (&x->m_mutex);
+    dds_entity_unpin (x);
+    ddsrt_mutex_lock (&pp->m_entity.m_mutex);
+  }
+  ddsrt_mutex_unlock (&pp->m_entity.m_mutex);
+  ddsi_thread_state_asleep (ddsi_lookup_thread_state ());
+  dds_topic_unpin (t);
+}
+
 dds_return_t dds_set_topic_filter_extended (dds_entity_t topic, const struct dds_topic_filter *filter)
 {
   struct dds_topic_filter f;
@@ -994,6 +1038,9 @@ dds_return_t dds_set_topic_filter_extended (dds_entity_t topic, const struct dds
         // can safely use any of the function pointers
         valid = (filter->f.sample != NULL);
         break;
+      case DDS_TOPIC_FILTER_PREDICATES:
+        // only via dds_set_topic_filter_predicates
+        break;
     }
     if (!valid)
     {
@@ -1004,8 +1051,34 @@ dds_return_t dds_set_topic_filter_extended (dds_entity_t topic, const struct dds
 
   if ((rc = dds_topic_lock (topic, &t)) != DDS_RETCODE_OK)
     return rc;
+  const bool had_preds = (t->m_filter_preds != NULL);
   t->m_filter = f;
+  dds_topic_filter_predicates_free (t->m_filter_preds);
+  t->m_filter_preds = NULL;
+  dds_topic_unlock (t);
+  if (had_preds)
+    update_readers_content_filter (topic);
+  return DDS_RETCODE_OK;
+}
+
+dds_return_t dds_set_topic_filter_predicates (dds_entity_t topic, uint32_t npredicates, const struct dds_topic_filter_predicate *predicates)
+{
+  struct dds_topic_filter_predicates *compiled = NULL;
+  dds_topic *t;
+  dds_return_t rc;
+
+  if ((rc = dds_topic_lock (topic, &t)) != DDS_RETCODE_OK)
+    return rc;
+  if (npredicates > 0 && (rc = dds_topic_filter_predicates_compile (&compiled, t->m_stype, npredicates, predicates)) != DDS_RETCODE_OK)
+  {
+    dds_topic_unlock (t);
+    return rc;
+  }
+  dds_topic_filter_predicates_free (t->m_filter_preds);
+  t->m_filter_preds = compiled;
+  t->m_filter = (struct dds_topic_filter) { .mode = compiled ? DDS_TOPIC_FILTER_PREDICATES : DDS_TOPIC_FILTER_NONE, .f = { .sample = NULL }, .arg = NULL };
   dds_topic_unlock (t);
+  update_readers_content_filter (topic);
   return DDS_RETCODE_OK;
 }
 
@@ -1052,6 +1125,7 @@ dds_return_t dds_get_topic_filter_and_arg (dds_entity_t topic, dds_topic_filter_
     case DDS_TOPIC_FILTER_SAMPLE:
     case DDS_TOPIC_FILTER_SAMPLEINFO_ARG:
     case DDS_TOPIC_FILTER_SAMPLE_SAMPLEINFO_ARG:
+    case DDS_TOPIC_FILTER_PREDICATES:
       rc = DDS_RETCODE_PRECONDITION_NOT_MET;
       break;
   }
@@ -0,0 +1,435 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <string.h>
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/io.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/strtol.h"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_sertype.h"
+#include "dds/ddsi/ddsi_plist.h"
+#include "dds/ddsi/ddsi_endpoint.h"
+#include "dds/cdr/dds_cdrstream.h"
+#include "dds__topic_filter.h"
+#include "dds__serdata_default.h"
+#include "dds__loaned_sample.h"
+
+static bool is_string_member (uint32_t insn)
+{
+  return DDS_OP_TYPE (insn) == DDS_OP_VAL_STR || DDS_OP_TYPE (insn) == DDS_OP_VAL_BST;
+}
+
+dds_return_t dds_topic_filter_predicates_compile (struct dds_topic_filter_predicates **compiled, const struct ddsi_sertype *st, uint32_t npredicates, const struct dds_topic_filter_predicate *predicates)
+{
+  if (st->ops != &dds_sertype_ops_default)
+    return DDS_RETCODE_UNSUPPORTED;
+  if (npredicates > 0 && predicates == NULL)
+    return DDS_RETCODE_BAD_PARAMETER;
+
+  const struct dds_sertype_default *stdef = (const struct dds_sertype_default *) st;
+  struct dds_topic_filter_predicates *c = ddsrt_malloc (sizeof (*c) + npredicates * sizeof (c->p[0]));
+  c->ops = stdef->type.ops.ops;
+  c->n = 0;
+  for (uint32_t i = 0; i < npredicates; i++)
+  {
+    const struct dds_topic_filter_predicate *pred = &predicates[i];
+    struct dds_topic_filter_cpred *cp = &c->p[c->n];
+    switch (pred->op)
+    {
+      case DDS_TOPIC_FILTER_OP_EQ: case DDS_TOPIC_FILTER_OP_NE:
+      case DDS_TOPIC_FILTER_OP_LT: case DDS_TOPIC_FILTER_OP_LE:
+      case DDS_TOPIC_FILTER_OP_GT: case DDS_TOPIC_FILTER_OP_GE:
+        break;
+      default:
+        goto err;
+    }
+    const uint32_t *insnp;
+    if (pred->offset > UINT32_MAX || (insnp = dds_stream_member_path (c->ops, pred->offset, cp->path, &cp->npath, DDS_TOPIC_FILTER_MAX_DEPTH)) == NULL)
+      goto err;
+    cp->insn = *insnp;
+    cp->offset = (uint32_t) pred->offset;
+    cp->op = pred->op;
+    cp->value = pred->value;
+    if (is_string_member (cp->insn))
+    {
+      if (pred->value.s == NULL)
+        goto err;
+      cp->value.s = ddsrt_strdup (pred->value.s);
+    }
+    c->n++;
+  }
+  *compiled = c;
+  return DDS_RETCODE_OK;
+
+err:
+  dds_topic_filter_predicates_free (c);
+  return DDS_RETCODE_BAD_PARAMETER;
+}
+
+void dds_topic_filter_predicates_free (struct dds_topic_filter_predicates *compiled)
+{
+  if (compiled == NULL)
+    return;
+  for (uint32_t i = 0; i < compiled->n; i++)
+  {
+    if (is_string_member (compiled->p[i].insn))
+      ddsrt_free ((char *) compiled->p[i].value.s);
+  }
+  ddsrt_free (compiled);
+}
+
+/* Comparison results: -1, 0, 1, or 2 for unordered (NaN) */
+static int cmp_i (int64_t a, int64_t b) { return (a < b) ? -1 : (a > b); }
+static int cmp_u (uint64_t a, uint64_t b) { return (a < b) ? -1 : (a > b); }
+static int cmp_d (double a, double b) { return (a < b) ? -1 : (a > b) ? 1 : (a == b) ? 0 : 2; }
+static int cmp_s (const char *a, const char *b) { const int c = strcmp (a, b); return (c < 0) ? -1 : (c > 0); }
+
+static bool cmp_result (enum dds_topic_filter_op op, int c)
+{
+  switch (op)
+  {
+    case DDS_TOPIC_FILTER_OP_EQ: return c == 0;
+    case DDS_TOPIC_FILTER_OP_NE: return c != 0;
+    case DDS_TOPIC_FILTER_OP_LT: return c == -1;
+    case DDS_TOPIC_FILTER_OP_LE: return c == -1 || c == 0;
+    case DDS_TOPIC_FILTER_OP_GT: return c == 1;
+    case DDS_TOPIC_FILTER_OP_GE: return c == 1 || c == 0;
+  }
+  return false;
+}
+
+/* Primitive values are the same in memory and in (normalized) CDR, except for
+   enums that are always 32 bits in memory but may be smaller in CDR */
+static bool eval_cpred (const struct dds_topic_filter_cpred *p, const void *addr, uint32_t enum_size, const char *str)
+{
+  const uint32_t flags = DDS_OP_FLAGS (p->insn);
+  const bool sgn = (flags & DDS_OP_FLAG_SGN), fp = (flags & DDS_OP_FLAG_FP);
+  int c = 2;
+  switch (DDS_OP_TYPE (p->insn))
+  {
+    case DDS_OP_VAL_BLN: case DDS_OP_VAL_1BY:
+      c = sgn ? cmp_i (*(const int8_t *) addr, p->value.i) : cmp_u (*(const uint8_t *) addr, p->value.u);
+      break;
+    case DDS_OP_VAL_2BY:
+      c = sgn ? cmp_i (*(const int16_t *) addr, p->value.i) : cmp_u (*(const uint16_t *) addr, p->value.u);
+      break;
+    case DDS_OP_VAL_4BY:
+      if (fp)
+        c = cmp_d (*(const float *) addr, p->value.d);
+      else
+        c = sgn ? cmp_i (*(const int32_t *) addr, p->value.i) : cmp_u (*(const uint32_t *) addr, p->value.u);
+      break;
+    case DDS_OP_VAL_8BY:
+      if (fp)
+        c = cmp_d (*(const double *) addr, p->value.d);
+      else
+        c = sgn ? cmp_i (*(const int64_t *) addr, p->value.i) : cmp_u (*(const uint64_t *) addr, p->value.u);
+      break;
+    case DDS_OP_VAL_ENU:
+      switch (enum_size)
+      {
+        case 1: c = cmp_i (*(const uint8_t *) addr, p->value.i); break;
+        case 2: c = cmp_i (*(const uint16_t *) addr, p->value.i); break;
+        default: c = cmp_i (*(const uint32_t *) addr, p->value.i); break;
+      }
+      break;
+    case DDS_OP_VAL_STR: case DDS_OP_VAL_BST:
+      c = cmp_s (str, p->value.s);
+      break;
+    default:
+      assert (0);
+  }
+  return cmp_result (p->op, c);
+}
+
+bool dds_topic_filter_predicates_accept_sample (const struct dds_topic_filter_predicates *compiled, const void *sample)
+{
+  for (uint32_t i = 0; i < compiled->n; i++)
+  {
+    const struct dds_topic_filter_cpred *p = &compiled->p[i];
+    const char *addr = (const char *) sample + p->offset;
+    const char *str = NULL;
+    if (DDS_OP_TYPE (p->insn) == DDS_OP_VAL_STR)
+    {
+      if ((str = *(const char * const *) addr) == NULL)
+        str = "";
+    }
+    else if (DDS_OP_TYPE (p->insn) == DDS_OP_VAL_BST)
+      str = addr;
+    if (!eval_cpred (p, addr, 4, str))
+      return false;
+  }
+  return true;
+}
+
+bool dds_topic_filter_predicates_accept_serdata (const struct dds_topic_filter_predicates *compiled, const struct ddsi_serdata *sd)
+{
+  static const uint64_t zero = 0;
+  dds_istream_t is0;
+  if (!dds_serdata_default_istream (sd, &is0))
+    return dds_topic_filter_predicates_accept_sample (compiled, sd->loan->sample_ptr);
+  for (uint32_t i = 0; i < compiled->n; i++)
+  {
+    const struct dds_topic_filter_cpred *p = &compiled->p[i];
+    dds_istream_t is = is0;
+    const void *addr;
+    const char *str = "";
+    if (dds_stream_locate_member (&is, compiled->ops, p->npath, p->path))
+    {
+      addr = is.m_buffer + is.m_index;
+      // strings in normalized CDR always have a length > 0 that includes the terminating 0
+      if (is_string_member (p->insn))
+        str = (const char *) addr + 4;
+    }
+    else
+    {
+      // missing trailing members in appendable types have their default value
+      addr = &zero;
+    }
+    if (!eval_cpred (p, addr, DDS_OP_TYPE_SZ (p->insn), str))
+      return false;
+  }
+  return true;
+}
+
+/* Predicates are advertised to remote writers in the content filter property
+   of the reader's discovery data, using a vendor-specific filter class:
+
+     expression: terms joined by " AND ", each term "PATH OP %K" with
+       PATH the member indices joined by "." (see dds_stream_member_path)
+       OP one of = <> < <= > >=
+       K the index of the parameter
+     parameters: signed integers and enums in decimal, unsigned integers in
+       decimal, floating-point numbers as the hexadecimal bit pattern of the
+       IEEE 754 double, strings as-is
+
+   That avoids a full SQL parser and, for floating-point values, is exact. */
+#define DDS_TOPIC_FILTER_CLASS_NAME "CYCLONEDDS_PREDICATES"
+
+static const struct { const char *s; enum dds_topic_filter_op op; } filter_ops[] = {
+  /* longest match first */
+  { "<>", DDS_TOPIC_FILTER_OP_NE }, { "<=", DDS_TOPIC_FILTER_OP_LE }, { ">=", DDS_TOPIC_FILTER_OP_GE },
+  { "=", DDS_TOPIC_FILTER_OP_EQ }, { "<", DDS_TOPIC_FILTER_OP_LT }, { ">", DDS_TOPIC_FILTER_OP_GT }
+};
+
+static const char *filter_op_str (enum dds_topic_filter_op op)
+{
+  for (size_t i = 0; i < sizeof (filter_ops) / sizeof (filter_ops[0]); i++)
+    if (filter_ops[i].op == op)
+      return filter_ops[i].s;
+  assert (0);
+  return "?";
+}
+
+static char *filter_value_str (uint32_t insn, const union dds_topic_filter_value *v)
+{
+  char *str;
+  if (is_string_member (insn))
+    return ddsrt_strdup (v->s);
+  else if (DDS_OP_FLAGS (insn) & DDS_OP_FLAG_FP)
+  {
+    uint64_t bits;
+    memcpy (&bits, &v->d, sizeof (bits));
+    (void) ddsrt_asprintf (&str, "0x%"PRIx64, bits);
+  }
+  else if (DDS_OP_TYPE (insn) == DDS_OP_VAL_ENU || (DDS_OP_FLAGS (insn) & DDS_OP_FLAG_SGN))
+    (void) ddsrt_asprintf (&str, "%"PRId64, v->i);
+  else
+    (void) ddsrt_asprintf (&str, "%"PRIu64, v->u);
+  return str;
+}
+
+static bool parse_filter_value (uint32_t insn, const char *str, union dds_topic_filter_value *v)
+{
+  char *end;
+  if (is_string_member (insn))
+  {
+    v->s = str;
+    return true;
+  }
+  else if (DDS_OP_FLAGS (insn) & DDS_OP_FLAG_FP)
+  {
+    unsigned long long bits;
+    if (ddsrt_strtoull (str, &end, 16, &bits) != DDS_RETCODE_OK || end == str || *end)
+      return false;
+    const uint64_t bits64 = bits;
+    memcpy (&v->d, &bits64, sizeof (v->d));
+    return true;
+  }
+  else if (DDS_OP_TYPE (insn) == DDS_OP_VAL_ENU || (DDS_OP_FLAGS (insn) & DDS_OP_FLAG_SGN))
+  {
+    long long x;
+    if (ddsrt_strtoll (str, &end, 10, &x) != DDS_RETCODE_OK || end == str || *end)
+      return false;
+    v->i = x;
+    return true;
+  }
+  else
+  {
+    unsigned long long x;
+    if (ddsrt_strtoull (str, &end, 10, &x) != DDS_RETCODE_OK || end == str || *end)
+      return false;
+    v->u = x;
+    return true;
+  }
+}
+
+static bool parse_uint32 (const char **str, uint32_t *v)
+{
+  const char *p = *str;
+  uint64_t x = 0;
+  if (!(*p >= '0' && *p <= '9'))
+    return false;
+  while (*p >= '0' && *p <= '9')
+  {
+    if ((x = 10 * x + (uint64_t) (*p++ - '0')) > UINT32_MAX)
+      return false;
+  }
+  *v = (uint32_t) x;
+  *str = p;
+  return true;
+}
+
+struct ddsi_content_filter_property *dds_topic_filter_predicates_to_property (const char *topic_name, const struct dds_topic_filter_predicates *compiled)
+{
+  if (compiled == NULL || compiled->n == 0)
+    return NULL;
+  struct ddsi_content_filter_property *cfp = ddsrt_malloc (sizeof (*cfp));
+  cfp->content_filtered_topic_name = ddsrt_strdup (topic_name);
+  cfp->related_topic_name = ddsrt_strdup (topic_name);
+  cfp->filter_class_name = ddsrt_strdup (DDS_TOPIC_FILTER_CLASS_NAME);
+  cfp->expression_parameters.n = compiled->n;
+  cfp->expression_parameters.strs = ddsrt_malloc (compiled->n * sizeof (*cfp->expression_parameters.strs));
+  char *expr = ddsrt_strdup ("");
+  for (uint32_t i = 0; i < compiled->n; i++)
+  {
+    const struct dds_topic_filter_cpred *p = &compiled->p[i];
+    char *path = ddsrt_strdup (""), *tmp;
+    for (uint32_t j = 0; j < p->npath; j++)
+    {
+      (void) ddsrt_asprintf (&tmp, "%s%s%"PRIu32, path, (j == 0) ? "" : ".", p->path[j]);
+      ddsrt_free (path);
+      path = tmp;
+    }
+    (void) ddsrt_asprintf (&tmp, "%s%s%s %s %%%"PRIu32, expr, (i == 0) ? "" : " AND ", path, filter_op_str (p->op), i);
+    ddsrt_free (path);
+    ddsrt_free (expr);
+    expr = tmp;
+    cfp->expression_parameters.strs[i] = filter_value_str (p->insn, &p->value);
+  }
+  cfp->filter_expression = expr;
+  return cfp;
+}
+
+static bool parse_filter_term (const char **str, const uint32_t *ops, const ddsi_stringseq_t *params, struct dds_topic_filter_predicate *pred)
+{
+  const char *e = *str;
+  uint32_t path[DDS_TOPIC_FILTER_MAX_DEPTH], npath = 0, k;
+  do {
+    if (npath == DDS_TOPIC_FILTER_MAX_DEPTH || !parse_uint32 (&e, &path[npath++]))
+      return false;
+  } while (*e == '.' && *++e);
+  if (*e++ != ' ')
+    return false;
+  size_t i;
+  for (i = 0; i < sizeof (filter_ops) / sizeof (filter_ops[0]); i++)
+    if (strncmp (e, filter_ops[i].s, strlen (filter_ops[i].s)) == 0)
+      break;
+  if (i == sizeof (filter_ops) / sizeof (filter_ops[0]))
+    return false;
+  e += strlen (filter_ops[i].s);
+  if (*e++ != ' ' || *e++ != '%' || !parse_uint32 (&e, &k) || k >= params->n)
+    return false;
+  const uint32_t *insnp;
+  if ((insnp = dds_stream_member_at_path (ops, npath, path, &pred->offset)) == NULL)
+    return false;
+  pred->op = filter_ops[i].op;
+  if (!parse_filter_value (*insnp, params->strs[k], &pred->value))
+    return false;
+  *str = e;
+  return true;
+}
+
+struct dds_topic_filter_content_filter {
+  struct ddsi_sertype_content_filter c;
+  struct dds_topic_filter_predicates *compiled;
+};
+
+static bool dds_topic_filter_content_filter_accept (const struct ddsi_sertype_content_filter *cf, const struct ddsi_serdata *sd)
+{
+  const struct dds_topic_filter_content_filter *x = (const struct dds_topic_filter_content_filter *) cf;
+  // invalid samples (dispose, unregister) are never filtered
+  if (sd->kind != SDK_DATA)
+    return true;
+  return dds_topic_filter_predicates_accept_serdata (x->compiled, sd);
+}
+
+static void dds_topic_filter_content_filter_free (struct ddsi_sertype_content_filter *cf)
+{
+  struct dds_topic_filter_content_filter *x = (struct dds_topic_filter_content_filter *) cf;
+  dds_topic_filter_predicates_free (x->compiled);
+  ddsrt_free (x);
+}
+
+struct ddsi_sertype_content_filter *dds_topic_filter_content_filter_new (const struct ddsi_sertype *st, const struct ddsi_content_filter_property *cfp)
+{
+  if (cfp->filter_class_name == NULL || strcmp (cfp->filter_class_name, DDS_TOPIC_FILTER_CLASS_NAME) != 0 || cfp->filter_expression == NULL)
+    return NULL;
+  const struct dds_sertype_default *stdef = (const struct dds_sertype_default *) st;
+  const char *e = cfp->filter_expression;
+  uint32_t npreds = 0, size = 0;
+  struct dds_topic_filter_predicate *preds = NULL;
+  struct dds_topic_filter_predicates *compiled = NULL;
+  while (*e)
+  {
+    if (npreds == size)
+    {
+      size = size ? 2 * size : 4;
+      preds = ddsrt_realloc (preds, size * sizeof (*preds));
+    }
+    if (!parse_filter_term (&e, stdef->type.ops.ops, &cfp->expression_parameters, &preds[npreds++]))
+      goto err;
+    if (*e && strncmp (e, " AND ", 5) != 0)
+      goto err;
+    else if (*e && *(e += 5) == 0)
+      goto err;
+  }
+  if (npreds == 0 || dds_topic_filter_predicates_compile (&compiled, st, npreds, preds) != DDS_RETCODE_OK)
+    goto err;
+  ddsrt_free (preds);
+  struct dds_topic_filter_content_filter *x = ddsrt_malloc (sizeof (*x));
+  x->c.accept = dds_topic_filter_content_filter_accept;
+  x->c.free = dds_topic_filter_content_filter_free;
+  x->compiled = compiled;
+  return &x->c;
+
+err:
+  ddsrt_free (preds);
+  return NULL;
+}
+
+struct ddsi_content_filter_property *dds_topic_filter_reader_content_filter (struct dds_topic *tp)
+{
+  struct ddsi_content_filter_property *cfp = NULL;
+  ddsrt_mutex_lock (&tp->m_entity.m_mutex);
+  if (tp->m_filter.mode == DDS_TOPIC_FILTER_PREDICATES)
+    cfp = dds_topic_filter_predicates_to_property (tp->m_name, tp->m_filter_preds);
+  ddsrt_mutex_unlock (&tp->m_entity.m_mutex);
+  return cfp;
+}
+
+void dds_topic_filter_update_reader_content_filter (struct dds_reader *rd)
+{
+  struct ddsi_content_filter_property *cfp = dds_topic_filter_reader_content_filter (rd->m_topic);
+  ddsi_update_reader_content_filter (rd->m_rd, cfp);
+  ddsi_content_filter_property_free (cfp);
+}
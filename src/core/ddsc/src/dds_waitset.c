@@ -40,6 +40,32 @@ static bool is_triggered (struct dds_entity *e)
   return t;
 }
 
+static void swap_attachments (dds_waitset *ws, size_t i, size_t j)
+{
+  dds_attachment * const tmp = ws->entities[i];
+  ws->entities[i] = ws->entities[j];
+  ws->entities[i]->index = i;
+  ws->entities[j] = tmp;
+  tmp->index = j;
+}
+
+/* Brings the state of the notification fd in line with ntriggered; it is only touched on a
+   transition to avoid system calls for every status change */
+static void notify_fd_update (dds_waitset *ws)
+{
+#if DDSRT_HAVE_EVENTFD
+  if (!ws->have_notify_fd || ws->notify_fd_signalled == (ws->ntriggered > 0))
+    return;
+  if (ws->ntriggered > 0)
+    ddsrt_eventfd_signal (&ws->notify_fd);
+  else
+    ddsrt_eventfd_drain (&ws->notify_fd);
+  ws->notify_fd_signalled = (ws->ntriggered > 0);
+#else
+  (void) ws;
+#endif
+}
+
 static dds_return_t dds_waitset_wait_impl (dds_entity_t waitset, dds_attach_t *xs, size_t nxs, dds_time_t abstimeout)
 {
   dds_waitset *ws;
@@ -68,13 +94,10 @@ static dds_return_t dds_waitset_wait_impl (dds_entity_t waitset, dds_attach_t *x
   ws->ntriggered = 0;
   for (size_t i = 0; i < previous_ntriggered; i++)
   {
-    if (is_triggered (ws->entities[i].entity))
-    {
-      dds_attachment tmp = ws->entities[i];
-      ws->entities[i] = ws->entities[ws->ntriggered];
-      ws->entities[ws->ntriggered++] = tmp;
-    }
+    if (is_triggered (ws->entities[i]->entity))
+      swap_attachments (ws, i, ws->ntriggered++);
   }
+  notify_fd_update (ws);
 
   /* Only wait/keep waiting when we have something to observe and there aren't any triggers yet. */
   while (ws->nentities > 0 && ws->ntriggered == 0 && !dds_handle_is_closed (&ws->m_entity.m_hdllink))
@@ -83,7 +106,7 @@ static dds_return_t dds_waitset_wait_impl (dds_entity_t waitset, dds_attach_t *x
 
   ret = (int32_t) ws->ntriggered;
   for (size_t i = 0; i < ws->ntriggered && i < nxs; i++)
-    xs[i] = ws->entities[i].arg;
+    xs[i] = ws->entities[i]->arg;
   ddsrt_mutex_unlock (&ws->wait_lock);
   dds_entity_unpin (&ws->m_entity);
   return ret;
@@ -105,7 +128,7 @@ static void dds_waitset_close (struct dds_entity *e)
   while (ws->nentities > 0)
   {
     dds_entity *observed;
-    if (dds_entity_pin (ws->entities[0].handle, &observed) < 0)
+    if (dds_entity_pin (ws->entities[0]->handle, &observed) < 0)
     {
       /* can't be pinned => being deleted => will be removed from wait set soon enough
        and go through delete_observer (which will trigger the condition variable) */
@@ -117,7 +140,7 @@ static void dds_waitset_close (struct dds_entity *e)
       ddsrt_mutex_unlock (&ws->wait_lock);
       (void) dds_entity_observer_unregister (observed, ws, true);
       ddsrt_mutex_lock (&ws->wait_lock);
-      assert (ws->nentities == 0 || ws->entities[0].entity != observed);
+      assert (ws->nentities == 0 || ws->entities[0]->entity != observed);
       dds_entity_unpin (observed);
     }
   }
@@ -129,7 +152,12 @@ static dds_return_t dds_waitset_delete (struct dds_entity *e)
   dds_waitset *ws = (dds_waitset *) e;
   ddsrt_mutex_destroy (&ws->wait_lock);
   ddsrt_cond_destroy (&ws->wait_cond);
+  assert (ws->nentities == 0);
   ddsrt_free (ws->entities);
+#if DDSRT_HAVE_EVENTFD
+  if (ws->have_notify_fd)
+    ddsrt_eventfd_fini (&ws->notify_fd);
+#endif
   return DDS_RETCODE_OK;
 }
 
@@ -179,6 +207,10 @@ dds_entity_t dds_create_waitset (dds_entity_t owner)
   waitset->nentities = 0;
   waitset->ntriggered = 0;
   waitset->entities = NULL;
+#if DDSRT_HAVE_EVENTFD
+  waitset->have_notify_fd = false;
+  waitset->notify_fd_signalled = false;
+#endif
   dds_entity_init_complete (&waitset->m_entity);
   dds_entity_unlock (e);
   dds_entity_unpin_and_drop_ref (&dds_global.m_entity);
@@ -209,7 +241,7 @@ dds_return_t dds_waitset_get_entities (dds_entity_t waitset, dds_entity_t *entit
     if (entities != NULL)
     {
       for (size_t i = 0; i < ws->nentities && i < size; i++)
-        entities[i] = ws->entities[i].handle;
+        entities[i] = ws->entities[i]->handle;
     }
     ret = (int32_t) ws->nentities;
     ddsrt_mutex_unlock (&ws->wait_lock);
@@ -218,23 +250,23 @@ dds_return_t dds_waitset_get_entities (dds_entity_t waitset, dds_entity_t *entit
   }
 }
 
-/* This is called when the observed entity signals a status change. */
-static void dds_waitset_observer (struct dds_waitset *ws, dds_entity_t observed)
+/* This is called when the observed entity signals a status change, with the observed
+   entity's m_observers_lock held.  The attachment is passed in by the entity, so there is no
+   need for searching, and the waiting threads need waking up only if this is the first one
+   to trigger: they only block while nothing is triggered. */
+static void dds_waitset_observer (struct dds_waitset *ws, struct dds_attachment *att)
 {
   ddsrt_mutex_lock (&ws->wait_lock);
-  /* Move observed entity to triggered list. */
-  size_t i;
-  for (i = 0; i < ws->nentities; i++)
-    if (ws->entities[i].handle == observed)
-      break;
-  if (i < ws->nentities && i >= ws->ntriggered)
+  assert (att->index < ws->nentities && ws->entities[att->index] == att);
+  if (att->index >= ws->ntriggered)
   {
-    dds_attachment tmp = ws->entities[i];
-    ws->entities[i] = ws->entities[ws->ntriggered];
-    ws->entities[ws->ntriggered++] = tmp;
+    swap_attachments (ws, att->index, ws->ntriggered++);
+    if (ws->ntriggered == 1)
+    {
+      ddsrt_cond_broadcast (&ws->wait_cond);
+      notify_fd_update (ws);
+    }
   }
-  /* Trigger waitset to wake up. */
-  ddsrt_cond_broadcast (&ws->wait_cond);
   ddsrt_mutex_unlock (&ws->wait_lock);
 }
 
@@ -242,48 +274,38 @@ struct dds_waitset_attach_observer_arg {
   dds_attach_t x;
 };
 
-static bool dds_waitset_attach_observer (struct dds_waitset *ws, struct dds_entity *observed, void *varg)
+static struct dds_attachment *dds_waitset_attach_observer (struct dds_waitset *ws, struct dds_entity *observed, void *varg)
 {
   struct dds_waitset_attach_observer_arg *arg = varg;
+  dds_attachment *att = ddsrt_malloc (sizeof (*att));
+  att->arg = arg->x;
+  att->entity = observed;
+  att->handle = observed->m_hdllink.hdl;
   ddsrt_mutex_lock (&ws->wait_lock);
   ws->entities = ddsrt_realloc (ws->entities, (ws->nentities + 1) * sizeof (*ws->entities));
-  ws->entities[ws->nentities].arg = arg->x;
-  ws->entities[ws->nentities].entity = observed;
-  ws->entities[ws->nentities].handle = observed->m_hdllink.hdl;
-  ws->nentities++;
+  att->index = ws->nentities;
+  ws->entities[ws->nentities++] = att;
   if (is_triggered (observed))
   {
-    const size_t i = ws->nentities - 1;
-    dds_attachment tmp = ws->entities[i];
-    ws->entities[i] = ws->entities[ws->ntriggered];
-    ws->entities[ws->ntriggered++] = tmp;
+    swap_attachments (ws, att->index, ws->ntriggered++);
+    notify_fd_update (ws);
   }
   ddsrt_cond_broadcast (&ws->wait_cond);
   ddsrt_mutex_unlock (&ws->wait_lock);
-  return true;
+  return att;
 }
 
-static void dds_waitset_delete_observer (struct dds_waitset *ws, dds_entity_t observed)
+static void dds_waitset_delete_observer (struct dds_waitset *ws, struct dds_attachment *att)
 {
-  size_t i;
   ddsrt_mutex_lock (&ws->wait_lock);
-  for (i = 0; i < ws->nentities; i++)
-    if (ws->entities[i].handle == observed)
-      break;
-  if (i < ws->nentities)
-  {
-    if (i < ws->ntriggered)
-    {
-      ws->entities[i] = ws->entities[--ws->ntriggered];
-      ws->entities[ws->ntriggered] = ws->entities[--ws->nentities];
-    }
-    else
-    {
-      ws->entities[i] = ws->entities[--ws->nentities];
-    }
-  }
+  assert (att->index < ws->nentities && ws->entities[att->index] == att);
+  if (att->index < ws->ntriggered)
+    swap_attachments (ws, att->index, --ws->ntriggered);
+  swap_attachments (ws, att->index, --ws->nentities);
+  notify_fd_update (ws);
   ddsrt_cond_broadcast (&ws->wait_cond);
   ddsrt_mutex_unlock (&ws->wait_lock);
+  ddsrt_free (att);
 }
 
 dds_return_t dds_waitset_attach (dds_entity_t waitset, dds_entity_t entity, dds_attach_t x)
@@ -417,3 +439,37 @@ dds_return_t dds_waitset_set_trigger (dds_entity_t waitset, bool trigger)
     return DDS_RETCODE_OK;
   }
 }
+
+dds_return_t dds_waitset_get_fd (dds_entity_t waitset, int *fd)
+{
+  dds_entity *ent;
+  dds_return_t rc;
+  if (fd == NULL)
+    return DDS_RETCODE_BAD_PARAMETER;
+  if ((rc = dds_entity_pin (waitset, &ent)) != DDS_RETCODE_OK)
+    return rc;
+  else if (dds_entity_kind (ent) != DDS_KIND_WAITSET)
+  {
+    dds_entity_unpin (ent);
+    return DDS_RETCODE_ILLEGAL_OPERATION;
+  }
+  else
+  {
+#if DDSRT_HAVE_EVENTFD
+    dds_waitset *ws = (dds_waitset *) ent;
+    ddsrt_mutex_lock (&ws->wait_lock);
+    if (!ws->have_notify_fd && (rc = ddsrt_eventfd_init (&ws->notify_fd)) == DDS_RETCODE_OK)
+    {
+      ws->have_notify_fd = true;
+      notify_fd_update (ws);
+    }
+    if (rc == DDS_RETCODE_OK)
+      *fd = ddsrt_eventfd_get_fd (&ws->notify_fd);
+    ddsrt_mutex_unlock (&ws->wait_lock);
+#else
+    rc = DDS_RETCODE_UNSUPPORTED;
+#endif
+    dds_entity_unpin (ent);
+    return rc;
+  }
+}
@@ -25,12 +25,14 @@
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_deliver_locally.h"
 #include "dds/ddsi/ddsi_addrset.h"
+#include "dds/ddsi/ddsi_lathist.h"
 #include "dds__heap_loan.h"
 #include "dds__writer.h"
 #include "dds__write.h"
 #include "dds__loaned_sample.h"
 #include "dds__psmx.h"
 #include "dds__guid.h"
+#include "dds__topic_filter.h"
 
 extern inline bool dds_source_timestamp_is_valid_ddsi_time (dds_time_t timestamp, ddsi_protocol_version_t protover);
 
@@ -170,6 +172,70 @@ dds_return_t dds_write_ts (dds_entity_t writer, const void *data, dds_time_t tim
   return ret;
 }
 
+dds_return_t dds_write_n (dds_entity_t writer, const void * const *data, uint32_t n)
+{
+  return dds_write_n_ts (writer, data, n, dds_time ());
+}
+
+dds_return_t dds_write_n_ts (dds_entity_t writer, const void * const *data, uint32_t n, dds_time_t timestamp)
+{
+  dds_return_t ret;
+  dds_writer *wr;
+
+  if (data == NULL || n == 0 || n > INT32_MAX)
+    return DDS_RETCODE_BAD_PARAMETER;
+  for (uint32_t i = 0; i < n; i++)
+    if (data[i] == NULL)
+      return DDS_RETCODE_BAD_PARAMETER;
+
+  if ((ret = dds_writer_lock (writer, &wr)) != DDS_RETCODE_OK)
+    return ret;
+  ret = dds_write_n_impl (wr, data, n, timestamp);
+  dds_writer_unlock (wr);
+  return ret;
+}
+
+dds_return_t dds_writecdr_n (dds_entity_t writer, struct ddsi_serdata **serdata, uint32_t n)
+{
+  dds_return_t ret;
+  dds_writer *wr;
+
+  if (serdata == NULL || n == 0 || n > INT32_MAX)
+    return DDS_RETCODE_BAD_PARAMETER;
+  for (uint32_t i = 0; i < n; i++)
+    if (serdata[i] == NULL)
+      return DDS_RETCODE_BAD_PARAMETER;
+
+  if ((ret = dds_writer_lock (writer, &wr)) != DDS_RETCODE_OK)
+    return ret;
+  if (wr->m_topic->m_filter.mode != DDS_TOPIC_FILTER_NONE)
+  {
+    dds_writer_unlock (wr);
+    for (uint32_t j = 0; j < n; j++)
+      ddsi_serdata_unref (serdata[j]);
+    return DDS_RETCODE_ERROR;
+  }
+  const dds_time_t tnow = dds_time ();
+  uint32_t i;
+  ret = DDS_RETCODE_OK;
+  for (i = 0; i < n && ret == DDS_RETCODE_OK; i++)
+  {
+    serdata[i]->statusinfo = 0;
+    serdata[i]->timestamp.v = tnow;
+    ret = dds_writecdr_impl (wr, wr->m_xp, serdata[i], false);
+  }
+  if (!wr->whc_batch)
+    ddsi_xpack_send (wr->m_xp, false);
+  dds_writer_unlock (wr);
+  if (ret == DDS_RETCODE_OK)
+    return (dds_return_t) n;
+  // dds_writecdr_impl consumed the one that failed, the remaining ones are consumed
+  // here so that the caller needn't figure out which ones still need to be released
+  for (uint32_t j = i; j < n; j++)
+    ddsi_serdata_unref (serdata[j]);
+  return (i > 1) ? (dds_return_t) (i - 1) : ret;
+}
+
 struct local_sourceinfo {
   const struct ddsi_sertype *src_type;
   struct ddsi_serdata *src_payload;
@@ -284,7 +350,7 @@ static struct ddsi_serdata_any *convert_serdata (struct ddsi_writer *ddsi_wr, st
   }
   else
   {
-    assert (din->a.type->ops->version == ddsi_sertype_v0);
+    assert (din->a.type->ops->version == ddsi_sertype_v0 || din->a.type->ops->version == ddsi_sertype_v1);
     // deliberately allowing mismatches between d->type and ddsi_wr->type:
     // that way we can allow transferring data from one domain to another
     dout = (struct ddsi_serdata_any *) ddsi_serdata_ref_as_type (ddsi_wr->type, &din->a);
@@ -542,6 +608,10 @@ static bool evaluate_topic_filter (const dds_writer *wr, const void *data, enum
     case DDS_TOPIC_FILTER_NONE:
     case DDS_TOPIC_FILTER_SAMPLEINFO_ARG:
       break;
+    case DDS_TOPIC_FILTER_PREDICATES:
+      if (!dds_topic_filter_predicates_accept_sample (wr->m_topic->m_filter_preds, data))
+        return false;
+      break;
     case DDS_TOPIC_FILTER_SAMPLE:
       if (!f->f.sample (data))
         return false;
@@ -562,7 +632,7 @@ static bool evaluate_topic_filter (const dds_writer *wr, const void *data, enum
 }
 
 ddsrt_nonnull_all
-static dds_return_t dds_write_impl_deliver_via_ddsi (struct ddsi_thread_state * const ts, dds_writer *wr, struct ddsi_serdata *d)
+static dds_return_t dds_write_impl_deliver_via_ddsi (struct ddsi_thread_state * const ts, dds_writer *wr, struct ddsi_serdata *d, bool flush)
 {
   struct ddsi_writer *ddsi_wr = wr->m_wr;
   dds_return_t ret = DDS_RETCODE_OK;
@@ -572,8 +642,8 @@ static dds_return_t dds_write_impl_deliver_via_ddsi (struct ddsi_thread_state *
   (void) ddsi_serdata_ref(d);
   ret = ddsi_write_sample_gc (ts, wr->m_xp, ddsi_wr, d, tk);
   if (ret >= 0) {
-    /* Flush out write unless configured to batch */
-    if (!wr->whc_batch)
+    /* Flush out write unless configured to batch or the caller does it */
+    if (flush)
       ddsi_xpack_send (wr->m_xp, false);
     ret = DDS_RETCODE_OK;
   } else if (ret != DDS_RETCODE_TIMEOUT) {
@@ -805,7 +875,8 @@ static dds_return_t dds_write_impl_psmxloan_serdata (struct dds_writer *wr, cons
   }
 }
 
-dds_return_t dds_write_impl (dds_writer *wr, const void *data, dds_time_t timestamp, dds_write_action action)
+ddsrt_attribute_warn_unused_result ddsrt_nonnull_all
+static dds_return_t dds_write_impl_common (dds_writer *wr, const void *data, dds_time_t timestamp, dds_write_action action, bool flush)
 {
   struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
   const enum ddsi_serdata_kind sdkind = (action & DDS_WR_KEY_BIT) ? SDK_KEY : SDK_DATA;
@@ -863,7 +934,10 @@ dds_return_t dds_write_impl (dds_writer *wr, const void *data, dds_time_t timest
   // of the key.  So it can't be freed by "dds_write_impl_psmxloan_serdata".
   struct dds_loaned_sample *loan_to_be_freed;
   dds_return_t ret = DDS_RETCODE_OK;
-  if ((ret = dds_write_impl_psmxloan_serdata (wr, data, sdkind, timestamp, statusinfo, &psmx_loan, &serdata, &loan_to_be_freed)) == DDS_RETCODE_OK)
+  const ddsrt_mtime_t tserialize = ddsi_lathist_start (wr->m_lathist_serialize);
+  ret = dds_write_impl_psmxloan_serdata (wr, data, sdkind, timestamp, statusinfo, &psmx_loan, &serdata, &loan_to_be_freed);
+  ddsi_lathist_record_since (wr->m_lathist_serialize, tserialize);
+  if (ret == DDS_RETCODE_OK)
   {
     assert (psmx_loan != NULL || serdata != NULL);
     assert ((psmx_loan == NULL) == (wr->m_endpoint.psmx_endpoints.length == 0));
@@ -932,7 +1006,7 @@ dds_return_t dds_write_impl (dds_writer *wr, const void *data, dds_time_t timest
     if (serdata != NULL)
     {
       if (ret == DDS_RETCODE_OK)
-        ret = dds_write_impl_deliver_via_ddsi (thrst, wr, serdata);
+        ret = dds_write_impl_deliver_via_ddsi (thrst, wr, serdata, flush);
       ddsi_serdata_unref (serdata);
     }
 
@@ -943,6 +1017,28 @@ dds_return_t dds_write_impl (dds_writer *wr, const void *data, dds_time_t timest
   return ret;
 }
 
+dds_return_t dds_write_impl (dds_writer *wr, const void *data, dds_time_t timestamp, dds_write_action action)
+{
+  return dds_write_impl_common (wr, data, timestamp, action, !wr->whc_batch);
+}
+
+dds_return_t dds_write_n_impl (dds_writer *wr, const void * const *data, uint32_t n, dds_time_t timestamp)
+{
+  // Packing the samples into as few messages as possible only requires not flushing
+  // until the end.  Each sample still goes through the WHC and the transmit path
+  // individually, because that's where throttling and heartbeat scheduling happen.
+  dds_return_t ret = DDS_RETCODE_OK;
+  uint32_t i;
+  for (i = 0; i < n && ret == DDS_RETCODE_OK; i++)
+    ret = dds_write_impl_common (wr, data[i], timestamp, DDS_WR_ACTION_WRITE, false);
+  if (!wr->whc_batch)
+    ddsi_xpack_send (wr->m_xp, false);
+  if (ret == DDS_RETCODE_OK)
+    return (dds_return_t) n;
+  else
+    return (i > 1) ? (dds_return_t) (i - 1) : ret;
+}
+
 dds_return_t dds_writecdr_impl (dds_writer *wr, struct ddsi_xpack *xp, struct ddsi_serdata *d, bool flush)
 {
   dds_return_t ret = dds_writecdr_impl_common (wr, wr->m_wr, xp, (struct ddsi_serdata_any *) d, flush);
@@ -25,11 +25,13 @@
 #include "dds/ddsi/ddsi_security_omg.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsi/ddsi_statistics.h"
+#include "dds/ddsi/ddsi_lathist.h"
 #include "dds/ddsi/ddsi_sertype.h"
 #include "dds/cdr/dds_cdrstream.h"
 #include "dds/ddsc/dds_internal_api.h"
 #include "dds__writer.h"
 #include "dds__listener.h"
+#include "dds__listener_dispatch.h"
 #include "dds__init.h"
 #include "dds__publisher.h"
 #include "dds__topic.h"
@@ -219,7 +221,9 @@ static dds_return_t dds_writer_delete (dds_entity *e)
   // up the endpoints. And m_loans is not used anymore from this point, so can also
   // be freed safely.
   dds_loan_pool_free (wr->m_loans);
+  dds_heap_loan_pool_free (wr->m_heap_loan_pool);
   dds_endpoint_remove_psmx_endpoints (&wr->m_endpoint);
+  ddsi_lathist_free (wr->m_lathist_serialize);
 
   /* FIXME: not freeing WHC here because it is owned by the DDSI entity */
   ddsi_thread_state_awake (ddsi_lookup_thread_state (), &e->m_domain->gv);
@@ -229,6 +233,19 @@ static dds_return_t dds_writer_delete (dds_entity *e)
   return ret;
 }
 
+/* Maximum number of unused heap loans a writer retains for reuse, further limited by the
+   resource limits QoS: there is no point in keeping more than max_samples loans around */
+#define DDS_WRITER_HEAP_LOAN_POOL_SIZE 16
+
+static uint32_t dds_writer_heap_loan_pool_size (const dds_qos_t *wqos)
+{
+  assert (wqos->present & DDSI_QP_RESOURCE_LIMITS);
+  const int32_t max_samples = wqos->resource_limits.max_samples;
+  if (max_samples != DDS_LENGTH_UNLIMITED && max_samples < DDS_WRITER_HEAP_LOAN_POOL_SIZE)
+    return (uint32_t) max_samples;
+  return DDS_WRITER_HEAP_LOAN_POOL_SIZE;
+}
+
 static dds_return_t validate_writer_qos (const dds_qos_t *wqos)
 {
 #ifndef DDS_HAS_LIFESPAN
@@ -266,24 +283,45 @@ static const struct dds_stat_keyvalue_descriptor dds_writer_statistics_kv[] = {
   { "rexmit_bytes", DDS_STAT_KIND_UINT64 },
   { "throttle_count", DDS_STAT_KIND_UINT32 },
   { "time_throttle", DDS_STAT_KIND_UINT64 },
-  { "time_rexmit", DDS_STAT_KIND_UINT64 }
+  { "time_rexmit", DDS_STAT_KIND_UINT64 },
+  { "loan_pool_hits", DDS_STAT_KIND_UINT64 },
+  { "loan_pool_misses", DDS_STAT_KIND_UINT64 },
+  { "filtered_count", DDS_STAT_KIND_UINT64 },
+  // stage latencies: only present if enabled in the configuration
+  DDS_STAT_LATENCY_KV ("serialize"),
+  DDS_STAT_LATENCY_KV ("whc")
 };
 
+#define DDS_WRITER_STATISTICS_NLAT 2
+
 static const struct dds_stat_descriptor dds_writer_statistics_desc = {
+  .count = sizeof (dds_writer_statistics_kv) / sizeof (dds_writer_statistics_kv[0]) - DDS_WRITER_STATISTICS_NLAT * DDS_STAT_LATENCY_NKV,
+  .kv = dds_writer_statistics_kv
+};
+
+static const struct dds_stat_descriptor dds_writer_statistics_lat_desc = {
   .count = sizeof (dds_writer_statistics_kv) / sizeof (dds_writer_statistics_kv[0]),
   .kv = dds_writer_statistics_kv
 };
 
 static struct dds_statistics *dds_writer_create_statistics (const struct dds_entity *entity)
 {
-  return dds_alloc_statistics (entity, &dds_writer_statistics_desc);
+  const struct dds_writer *wr = (const struct dds_writer *) entity;
+  return dds_alloc_statistics (entity, wr->m_lathist_serialize ? &dds_writer_statistics_lat_desc : &dds_writer_statistics_desc);
 }
 
 static void dds_writer_refresh_statistics (const struct dds_entity *entity, struct dds_statistics *stat)
 {
   const struct dds_writer *wr = (const struct dds_writer *) entity;
   if (wr->m_wr)
-    ddsi_get_writer_stats (wr->m_wr, &stat->kv[0].u.u64, &stat->kv[1].u.u32, &stat->kv[2].u.u64, &stat->kv[3].u.u64);
+    ddsi_get_writer_stats (wr->m_wr, &stat->kv[0].u.u64, &stat->kv[1].u.u32, &stat->kv[2].u.u64, &stat->kv[3].u.u64, &stat->kv[6].u.u64);
+  dds_heap_loan_pool_stats (wr->m_heap_loan_pool, &stat->kv[4].u.u64, &stat->kv[5].u.u64);
+  if (stat->count > dds_writer_statistics_desc.count)
+  {
+    struct dds_stat_keyvalue * const kvlat = &stat->kv[dds_writer_statistics_desc.count];
+    dds_stat_fill_latency (&kvlat[0], wr->m_lathist_serialize);
+    dds_stat_fill_latency (&kvlat[DDS_STAT_LATENCY_NKV], wr->m_wr ? wr->m_wr->lathist_whc : NULL);
+  }
 }
 
 const struct dds_entity_deriver dds_entity_deriver_writer = {
@@ -411,6 +449,8 @@ static dds_entity_t dds_create_writer_int (dds_entity_t participant_or_publisher
   wr->m_whc = dds_whc_new (gv, wrinfo);
   rc = dds_loan_pool_create (&wr->m_loans, 0);
   assert(rc == DDS_RETCODE_OK); // FIXME: can be out of resources
+  rc = dds_heap_loan_pool_create (&wr->m_heap_loan_pool, tp->m_stype, dds_writer_heap_loan_pool_size (wqos));
+  assert(rc == DDS_RETCODE_OK); // FIXME: can be out of resources
   dds_whc_free_wrinfo (wrinfo);
   // We now have the QoS which defaults to "false", but it used to be controlled by a global setting
   // (that most people were sensible enough to leave at false and that this deprecated now).  Or'ing
@@ -419,6 +459,7 @@ static dds_entity_t dds_create_writer_int (dds_entity_t participant_or_publisher
   // we can have another look.
   wr->whc_batch = wqos->writer_batching.batch_updates || gv->config.whc_batch;
   wr->protocol_version = gv->config.protocol_version;
+  wr->m_lathist_serialize = gv->config.stage_latency_statistics ? ddsi_lathist_new () : NULL;
 
   if ((rc = dds_endpoint_add_psmx_endpoint (&wr->m_endpoint, wqos, &tp->m_ktopic->psmx_topics, DDS_PSMX_ENDPOINT_TYPE_WRITER)) != DDS_RETCODE_OK)
     goto err_pipe_open;
@@ -567,7 +608,7 @@ dds_return_t dds_request_writer_loan (dds_writer *wr, enum dds_writer_loan_type
           ret = DDS_RETCODE_OK;
       }
       else
-        ret = dds_heap_loan (wr->m_topic->m_stype, DDS_LOANED_SAMPLE_STATE_UNITIALIZED, &loan);
+        ret = dds_heap_loan_from_pool (wr->m_heap_loan_pool, DDS_LOANED_SAMPLE_STATE_UNITIALIZED, &loan);
       break;
   }
 
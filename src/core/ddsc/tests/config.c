@@ -18,6 +18,8 @@
 #include "dds/ddsrt/cdtors.h"
 #include "dds/ddsrt/environ.h"
 #include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/rusage.h"
+#include "dds/ddsrt/threads.h"
 #include "ddsi__misc.h"
 #include "dds/ddsi/ddsi_xqos.h"
 
@@ -481,6 +483,34 @@ CU_Test(ddsc_config, multiple_domains, .init = ddsrt_init, .fini = ddsrt_fini)
   dds_set_trace_sink (NULL, NULL);
 }
 
+#if DDSRT_HAVE_RUSAGE && DDSRT_HAVE_THREAD_LIST
+CU_Test(ddsc_config, thread_cpu_warning, .init = ddsrt_init, .fini = ddsrt_fini)
+{
+  const char *log_expected[] = {
+    "*thread * CPU utilization *% exceeds threshold of 10%*",
+    NULL
+  };
+
+  dds_set_log_mask (DDS_LC_FATAL|DDS_LC_ERROR|DDS_LC_WARNING);
+  dds_set_log_sink (&logger, (void *) log_expected);
+  dds_set_trace_sink (&logger, (void *) log_expected);
+
+  found = 0;
+  dds_entity_t domain = dds_create_domain (0, "<Internal><LivelinessMonitoring CpuWarningThreshold=\"10\">true</LivelinessMonitoring></Internal>");
+  CU_ASSERT_FATAL (domain > 0);
+  // keep this thread busy until the monitor complains about it (or it took too long),
+  // the first sample only establishes a baseline and needs about a second
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  while (found == 0 && dds_time () < tend)
+    ; // spin
+  CU_ASSERT (found == 0x1);
+  dds_delete (domain);
+
+  dds_set_log_sink (NULL, NULL);
+  dds_set_trace_sink (NULL, NULL);
+}
+#endif
+
 CU_Test(ddsc_config, bad_configs_listelems)
 {
   // The first one is thanks to OSS-Fuzz, the fact that it is so easy
@@ -0,0 +1,182 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CUnit/Theory.h"
+#include "Space.h"
+#include "test_util.h"
+
+#include "dds/dds.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/io.h"
+#include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/random.h"
+#include "dds/ddsrt/sockets.h"
+
+#define DEBMON_CONFIG \
+  "<General><Interfaces><NetworkInterface address=\"127.0.0.1\"/></Interfaces></General>" \
+  "<Discovery><ExternalDomainId>0</ExternalDomainId><Tag>${CYCLONEDDS_PID}</Tag></Discovery>" \
+  "<Internal><MonitorPort>%"PRIu32"</MonitorPort><StageLatencyStatistics>true</StageLatencyStatistics></Internal>"
+
+static dds_entity_t create_debmon_domain (dds_domainid_t domid, uint32_t *port)
+{
+  // Same as the TCP tests: pick a random port and retry a few times if it happens
+  // to be in use already
+  dds_entity_t dom = -1;
+  for (int i = 0; i < 10 && dom < 0; i++)
+  {
+    char *conf_raw, *conf;
+    *port = 20000 + ddsrt_random () % 20000;
+    (void) ddsrt_asprintf (&conf_raw, DEBMON_CONFIG, *port);
+    conf = ddsrt_expand_envvars (conf_raw, domid);
+    dom = dds_create_domain (domid, conf);
+    ddsrt_free (conf);
+    ddsrt_free (conf_raw);
+  }
+  CU_ASSERT_FATAL (dom > 0);
+  return dom;
+}
+
+static char *http_get (uint32_t port, const char *path)
+{
+  ddsrt_socket_t sock;
+  struct sockaddr_in addr;
+  dds_return_t rc;
+  rc = ddsrt_socket (&sock, AF_INET, SOCK_STREAM, 0);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  memset (&addr, 0, sizeof (addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons ((uint16_t) port);
+  addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  rc = ddsrt_connect (sock, (struct sockaddr *) &addr, sizeof (addr));
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+
+  char *req;
+  ssize_t n;
+  (void) ddsrt_asprintf (&req, "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", path);
+  rc = ddsrt_send (sock, req, strlen (req), 0, &n);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK && (size_t) n == strlen (req));
+  ddsrt_free (req);
+
+  size_t size = 4096, pos = 0;
+  char *buf = ddsrt_malloc (size);
+  while ((rc = ddsrt_recv (sock, buf + pos, size - pos - 1, 0, &n)) == DDS_RETCODE_OK && n > 0)
+  {
+    pos += (size_t) n;
+    if (size - pos < 1024)
+      buf = ddsrt_realloc (buf, size *= 2);
+  }
+  buf[pos] = 0;
+  ddsrt_close (sock);
+  return buf;
+}
+
+static char *http_body (char *resp)
+{
+  // Undo the chunked transfer encoding in place: size CRLF data CRLF ... 0 CRLF CRLF
+  char *src = strstr (resp, "\r\n\r\n"), *dst;
+  CU_ASSERT_FATAL (src != NULL);
+  src = dst = src + 4;
+  char *body = dst;
+  unsigned long chunksz;
+  while ((chunksz = strtoul (src, &src, 16)) > 0)
+  {
+    CU_ASSERT_FATAL (strncmp (src, "\r\n", 2) == 0);
+    memmove (dst, src + 2, chunksz);
+    dst += chunksz;
+    src += 2 + chunksz;
+    CU_ASSERT_FATAL (strncmp (src, "\r\n", 2) == 0);
+    src += 2;
+  }
+  *dst = 0;
+  return body;
+}
+
+static double metric_value (const char *body, const char *series)
+{
+  // series is the name including labels, value follows after a space
+  const char *p = body;
+  const size_t len = strlen (series);
+  while ((p = strstr (p, series)) != NULL)
+  {
+    if ((p == body || p[-1] == '\n') && p[len] == ' ')
+      return strtod (p + len + 1, NULL);
+    p += len;
+  }
+  CU_FAIL_FATAL ("series not found");
+  return 0.0;
+}
+
+CU_Test (ddsc_debmon, metrics)
+{
+  uint32_t port;
+  const dds_entity_t dom = create_debmon_domain (0, &port);
+  const dds_entity_t pp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_debmon", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t tp = dds_create_topic (pp, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  const dds_entity_t rd = dds_create_reader (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+  for (int32_t i = 0; i < 3; i++)
+  {
+    dds_return_t rc = dds_write (wr, &(Space_Type1){ i, 0, 0 });
+    CU_ASSERT_FATAL (rc == 0);
+  }
+
+  char *resp = http_get (port, "/metrics");
+  CU_ASSERT_FATAL (strncmp (resp, "HTTP/1.1 200 OK\r\n", 17) == 0);
+  CU_ASSERT (strstr (resp, "Content-Type: application/openmetrics-text") != NULL);
+  const char *body = http_body (resp);
+  const size_t bodylen = strlen (body);
+  CU_ASSERT_FATAL (bodylen > 6 && strcmp (body + bodylen - 6, "# EOF\n") == 0);
+
+  dds_guid_t wrguid, rdguid;
+  dds_return_t rc;
+  rc = dds_get_guid (wr, &wrguid);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_get_guid (rd, &rdguid);
+  CU_ASSERT_FATAL (rc == 0);
+  char series[300];
+  const uint8_t *w = wrguid.v, *r = rdguid.v;
+#define GUIDFMT "%"PRIx32":%"PRIx32":%"PRIx32":%"PRIx32
+#define GUIDV(g) ((uint32_t) g[0] << 24 | (uint32_t) g[1] << 16 | (uint32_t) g[2] << 8 | g[3]), ((uint32_t) g[4] << 24 | (uint32_t) g[5] << 16 | (uint32_t) g[6] << 8 | g[7]), ((uint32_t) g[8] << 24 | (uint32_t) g[9] << 16 | (uint32_t) g[10] << 8 | g[11]), ((uint32_t) g[12] << 24 | (uint32_t) g[13] << 16 | (uint32_t) g[14] << 8 | g[15])
+  (void) snprintf (series, sizeof (series), "cyclonedds_writer_samples_total{guid=\""GUIDFMT"\",topic=\"%s\"}", GUIDV (w), topicname);
+  CU_ASSERT (metric_value (body, series) == 3.0);
+  (void) snprintf (series, sizeof (series), "cyclonedds_reader_rhc_samples{guid=\""GUIDFMT"\",topic=\"%s\"}", GUIDV (r), topicname);
+  CU_ASSERT (metric_value (body, series) == 3.0);
+  (void) snprintf (series, sizeof (series), "cyclonedds_reader_rhc_instances{guid=\""GUIDFMT"\",topic=\"%s\"}", GUIDV (r), topicname);
+  CU_ASSERT (metric_value (body, series) == 3.0);
+#undef GUIDV
+#undef GUIDFMT
+  CU_ASSERT (metric_value (body, "cyclonedds_dqueue_max_samples{queue=\"user\"}") > 0.0);
+  CU_ASSERT (metric_value (body, "cyclonedds_rbufpool_buffers{thread=\"recv\"}") >= 1.0);
+  CU_ASSERT (strstr (body, "\ncyclonedds_xevent_lateness_seconds_count ") != NULL);
+  ddsrt_free (resp);
+
+  // anything else still gets the JSON dump
+  resp = http_get (port, "/");
+  CU_ASSERT (strstr (resp, "Content-Type: application/json") != NULL);
+  CU_ASSERT (strstr (http_body (resp), "{\"participants\":[") != NULL);
+  ddsrt_free (resp);
+
+  rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+}
@@ -0,0 +1,158 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CUnit/Theory.h"
+#include "Space.h"
+#include "test_util.h"
+
+#include "dds/dds.h"
+#include "dds/ddsc/dds_statistics.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/io.h"
+#include "dds/ddsrt/environ.h"
+
+#define EMU_CONFIG \
+  "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}" \
+  "<General><Transport>emu</Transport></General>" \
+  "<Internal><Test><NetworkEmulation>" \
+    "<Seed>%"PRIu32"</Seed>" \
+    "<Loss>%"PRIu32"</Loss>" \
+    "<LossBurstLength>%"PRIu32"</LossBurstLength>" \
+    "<Latency>%s</Latency>" \
+    "<Jitter>%s</Jitter>" \
+    "<Reordering>%"PRIu32"</Reordering>" \
+    "<Bandwidth>%s</Bandwidth>" \
+  "</NetworkEmulation></Test></Internal>" \
+  "<Discovery><ExternalDomainId>0</ExternalDomainId></Discovery>"
+
+struct emu_params {
+  uint32_t loss, burst;
+  const char *latency, *jitter;
+  uint32_t reorder;
+  const char *bandwidth;
+};
+
+static dds_entity_t create_emu_domain (dds_domainid_t domid, const struct emu_params *p)
+{
+  char *conf_raw, *conf;
+  (void) ddsrt_asprintf (&conf_raw, EMU_CONFIG, (uint32_t) domid, p->loss, p->burst, p->latency, p->jitter, p->reorder, p->bandwidth);
+  conf = ddsrt_expand_envvars (conf_raw, domid);
+  const dds_entity_t dom = dds_create_domain (domid, conf);
+  ddsrt_free (conf);
+  ddsrt_free (conf_raw);
+  CU_ASSERT_FATAL (dom > 0);
+  return dom;
+}
+
+static void do_emu_test (const struct emu_params *p, bool expect_rexmit)
+{
+  const dds_entity_t dom_rd = create_emu_domain (0, p);
+  const dds_entity_t dom_wr = create_emu_domain (1, p);
+  const dds_entity_t pp_rd = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp_rd > 0);
+  const dds_entity_t pp_wr = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_wr > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_emunet", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t tp_rd = dds_create_topic (pp_rd, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_rd > 0);
+  const dds_entity_t tp_wr = dds_create_topic (pp_wr, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_wr > 0);
+  const dds_entity_t rd = dds_create_reader (pp_rd, tp_rd, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp_wr, tp_wr, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+  sync_reader_writer (pp_rd, rd, pp_wr, wr);
+
+  // Reliable communication must recover from whatever the emulated network does
+  // to the packets, and deliver everything in order
+  const int32_t nsamples = 500;
+  dds_return_t rc;
+  for (int32_t i = 0; i < nsamples; i++)
+  {
+    rc = dds_write (wr, &(Space_Type1){ 0, i, 0 });
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  rc = dds_wait_for_acks (wr, DDS_SECS (20));
+  CU_ASSERT_FATAL (rc == 0);
+
+  // All samples having been acknowledged doesn't mean they have all been stored in
+  // the reader history cache yet, so wait for them to arrive
+  const dds_entity_t ws = dds_create_waitset (pp_rd);
+  CU_ASSERT_FATAL (ws > 0);
+  const dds_entity_t rdcond = dds_create_readcondition (rd, DDS_ANY_STATE);
+  CU_ASSERT_FATAL (rdcond > 0);
+  rc = dds_waitset_attach (ws, rdcond, 0);
+  CU_ASSERT_FATAL (rc == 0);
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  int32_t next = 0;
+  while (next < nsamples)
+  {
+    Space_Type1 sample;
+    void *raw = &sample;
+    dds_sample_info_t si;
+    rc = dds_take (rd, &raw, &si, 1, 1);
+    CU_ASSERT_FATAL (rc == 0 || rc == 1);
+    if (rc == 0)
+    {
+      rc = dds_waitset_wait_until (ws, NULL, 0, tend);
+      CU_ASSERT_FATAL (rc > 0);
+      continue;
+    }
+    CU_ASSERT_FATAL (si.valid_data);
+    CU_ASSERT_FATAL (sample.long_2 == next);
+    next++;
+  }
+
+  struct dds_statistics *stats = dds_create_statistics (wr);
+  CU_ASSERT_FATAL (stats != NULL);
+  const struct dds_stat_keyvalue *kv = dds_lookup_statistic (stats, "rexmit_bytes");
+  CU_ASSERT_FATAL (kv != NULL);
+  if (expect_rexmit)
+    CU_ASSERT (kv->u.u64 > 0);
+  dds_delete_statistics (stats);
+
+  rc = dds_delete (dom_wr);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom_rd);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+CU_Test (ddsc_emunet, perfect, .timeout = 30)
+{
+  do_emu_test (&(struct emu_params){ 0, 1, "0 s", "0 s", 0, "0 B" }, false);
+}
+
+CU_Test (ddsc_emunet, loss, .timeout = 60)
+{
+  do_emu_test (&(struct emu_params){ 100, 1, "0 s", "0 s", 0, "0 B" }, true);
+}
+
+CU_Test (ddsc_emunet, burst_loss, .timeout = 60)
+{
+  do_emu_test (&(struct emu_params){ 100, 4, "100 us", "0 s", 0, "0 B" }, true);
+}
+
+CU_Test (ddsc_emunet, delay_reorder, .timeout = 60)
+{
+  do_emu_test (&(struct emu_params){ 0, 1, "500 us", "500 us", 100, "0 B" }, false);
+}
+
+CU_Test (ddsc_emunet, bandwidth, .timeout = 60)
+{
+  do_emu_test (&(struct emu_params){ 20, 1, "1 ms", "0 s", 0, "1 MB" }, false);
+}
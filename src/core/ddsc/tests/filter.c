@@ -24,10 +24,19 @@
 #include <assert.h>
 #include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "dds/features.h"
 #include "dds/dds.h"
+#include "dds/ddsc/dds_statistics.h"
+#include "dds/ddsrt/environ.h"
 #include "dds/ddsrt/misc.h"
 #include "dds/ddsrt/attributes.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsi/ddsi_sertype.h"
+#include "dds/ddsi/ddsi_plist.h"
+#include "dds__topic.h"
+#include "dds__topic_filter.h"
 
 #include "test_common.h"
 
@@ -646,3 +655,370 @@ CU_Test (ddsc_filter, sampleinfo)
   dds_delete (dp);
 }
 
+
+CU_Test (ddsc_filter, predicates_invalid)
+{
+  const dds_entity_t dp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (dp > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_filter", topicname, sizeof (topicname));
+  const dds_entity_t tp = dds_create_topic (dp, &Space_filter_type_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  dds_return_t ret;
+
+  // unsupported members, bad offsets, bad operators
+  const struct dds_topic_filter_predicate invalid[] = {
+    { offsetof (Space_filter_type, seq), DDS_TOPIC_FILTER_OP_EQ, { .u = 0 } },
+    { offsetof (Space_filter_type, opt), DDS_TOPIC_FILTER_OP_EQ, { .i = 0 } },
+    { offsetof (Space_filter_type, inner.bs) + 1, DDS_TOPIC_FILTER_OP_EQ, { .s = "" } },
+    { offsetof (Space_filter_type, inner.d) + 1, DDS_TOPIC_FILTER_OP_EQ, { .d = 0 } },
+    { sizeof (Space_filter_type), DDS_TOPIC_FILTER_OP_EQ, { .i = 0 } },
+    { offsetof (Space_filter_type, str), DDS_TOPIC_FILTER_OP_EQ, { .s = NULL } },
+    { offsetof (Space_filter_type, id), (enum dds_topic_filter_op) 99, { .i = 0 } }
+  };
+  for (size_t i = 0; i < sizeof (invalid) / sizeof (invalid[0]); i++)
+  {
+    ret = dds_set_topic_filter_predicates (tp, 1, &invalid[i]);
+    CU_ASSERT (ret == DDS_RETCODE_BAD_PARAMETER);
+  }
+
+  // mutable types have no fixed member order in the serialized data
+  create_unique_topic_name ("ddsc_filter", topicname, sizeof (topicname));
+  const dds_entity_t tpm = dds_create_topic (dp, &Space_filter_mutable_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tpm > 0);
+  ret = dds_set_topic_filter_predicates (tpm, 1, &(struct dds_topic_filter_predicate){ offsetof (Space_filter_mutable, a), DDS_TOPIC_FILTER_OP_EQ, { .i = 0 } });
+  CU_ASSERT (ret == DDS_RETCODE_BAD_PARAMETER);
+
+  // predicates show up as a mode without a function and can't be set that way
+  ret = dds_set_topic_filter_predicates (tp, 1, &(struct dds_topic_filter_predicate){ offsetof (Space_filter_type, id), DDS_TOPIC_FILTER_OP_EQ, { .i = 0 } });
+  CU_ASSERT_FATAL (ret == 0);
+  struct dds_topic_filter filter;
+  ret = dds_get_topic_filter_extended (tp, &filter);
+  CU_ASSERT_FATAL (ret == 0);
+  CU_ASSERT (filter.mode == DDS_TOPIC_FILTER_PREDICATES && filter.f.sample == 0 && filter.arg == NULL);
+  dds_topic_filter_arg_fn fn;
+  void *arg;
+  ret = dds_get_topic_filter_and_arg (tp, &fn, &arg);
+  CU_ASSERT (ret == DDS_RETCODE_PRECONDITION_NOT_MET);
+  ret = dds_set_topic_filter_extended (tp, &filter);
+  CU_ASSERT (ret == DDS_RETCODE_BAD_PARAMETER);
+  ret = dds_set_topic_filter_predicates (tp, 0, NULL);
+  CU_ASSERT_FATAL (ret == 0);
+  ret = dds_get_topic_filter_extended (tp, &filter);
+  CU_ASSERT_FATAL (ret == 0);
+  CU_ASSERT (filter.mode == DDS_TOPIC_FILTER_NONE);
+  dds_delete (dp);
+}
+
+static uint32_t take_filter_type_ids (dds_entity_t rd)
+{
+  void *raw[16] = { NULL };
+  dds_sample_info_t si[16];
+  uint32_t ids = 0;
+  const dds_return_t n = dds_take (rd, raw, si, 16, 16);
+  CU_ASSERT_FATAL (n >= 0);
+  for (int32_t i = 0; i < n; i++)
+  {
+    const Space_filter_type *s = raw[i];
+    CU_ASSERT_FATAL (s->id >= 0 && s->id < 32);
+    ids |= 1u << s->id;
+  }
+  (void) dds_return_loan (rd, raw, n);
+  return ids;
+}
+
+struct filter_type_samples_buf {
+  char bs[8][8];
+  int32_t seqbuf[8];
+};
+
+static void init_filter_type_samples (Space_filter_type samples[8], struct filter_type_samples_buf *buf)
+{
+  // id i has a sequence of length i and the optional member only if i is odd, so
+  // that locating the members requires skipping variable-length data
+  for (int32_t i = 0; i < 8; i++)
+  {
+    buf->seqbuf[i] = i;
+    (void) snprintf (buf->bs[i], sizeof (buf->bs[i]), "bs%"PRId32, i);
+    samples[i] = (Space_filter_type) {
+      .id = i,
+      .seq = { ._length = (uint32_t) i, ._maximum = (uint32_t) i, ._buffer = buf->seqbuf, ._release = false },
+      .opt = (i % 2) ? &buf->seqbuf[i] : NULL,
+      .inner = { .s = (int16_t) (i - 4), .d = i * 0.5 },
+      .c = (Space_filter_color) (i % 3),
+      .str = (i % 2) ? "odd" : "even",
+      .ll = -(int64_t) i * 1000000000000,
+      .ull = UINT64_MAX - (uint64_t) i,
+      .f = (float) i,
+      .b = (i % 2)
+    };
+    (void) ddsrt_strlcpy (samples[i].inner.bs, buf->bs[i], sizeof (samples[i].inner.bs));
+  }
+}
+
+CU_Test (ddsc_filter, predicates)
+{
+  const dds_entity_t dp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (dp > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_filter", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t tpu = dds_create_topic (dp, &Space_filter_type_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tpu > 0);
+  const dds_entity_t rdu = dds_create_reader (dp, tpu, qos, NULL);
+  CU_ASSERT_FATAL (rdu > 0);
+  const dds_entity_t wru = dds_create_writer (dp, tpu, qos, NULL);
+  CU_ASSERT_FATAL (wru > 0);
+
+  Space_filter_type samples[8];
+  struct filter_type_samples_buf buf;
+  init_filter_type_samples (samples, &buf);
+
+#define P(m, o, v) { offsetof (Space_filter_type, m), DDS_TOPIC_FILTER_OP_##o, { v } }
+  static const struct {
+    uint32_t n;
+    struct dds_topic_filter_predicate p[3];
+    uint32_t exp;
+  } cases[] = {
+    { 1, { P (inner.s, LT, .i = 0) }, 0x0f },
+    { 1, { P (inner.d, GE, .d = 2.0) }, 0xf0 },
+    { 1, { P (inner.bs, EQ, .s = "bs5") }, 0x20 },
+    { 1, { P (c, EQ, .i = Space_FC_BLUE) }, 0x24 },
+    { 2, { P (str, EQ, .s = "odd"), P (b, EQ, .u = 1) }, 0xaa },
+    { 3, { P (str, NE, .s = "even"), P (b, EQ, .u = 1), P (ull, GT, .u = UINT64_MAX - 3) }, 0x02 },
+    { 1, { P (ll, LE, .i = -5000000000000) }, 0xe0 },
+    { 1, { P (f, NE, .d = 3.0) }, 0xf7 },
+    { 1, { P (id, GT, .i = 5) }, 0xc0 }
+  };
+#undef P
+  for (size_t k = 0; k < sizeof (cases) / sizeof (cases[0]); k++)
+  {
+    dds_return_t ret;
+    const dds_entity_t tpf = dds_create_topic (dp, &Space_filter_type_desc, topicname, qos, NULL);
+    CU_ASSERT_FATAL (tpf > 0);
+    ret = dds_set_topic_filter_predicates (tpf, cases[k].n, cases[k].p);
+    CU_ASSERT_FATAL (ret == 0);
+    const dds_entity_t rdf = dds_create_reader (dp, tpf, qos, NULL);
+    CU_ASSERT_FATAL (rdf > 0);
+    const dds_entity_t wrf = dds_create_writer (dp, tpf, qos, NULL);
+    CU_ASSERT_FATAL (wrf > 0);
+
+    // reader-side: evaluated on the serialized data
+    for (int32_t i = 0; i < 8; i++)
+    {
+      ret = dds_write (wru, &samples[i]);
+      CU_ASSERT_FATAL (ret == 0);
+    }
+    uint32_t ids = take_filter_type_ids (rdf);
+    printf ("case %zu: reader %"PRIx32" expected %"PRIx32"\n", k, ids, cases[k].exp);
+    CU_ASSERT (ids == cases[k].exp);
+    CU_ASSERT (take_filter_type_ids (rdu) == 0xff);
+
+    // writer-side: evaluated on the sample
+    for (int32_t i = 0; i < 8; i++)
+    {
+      ret = dds_write (wrf, &samples[i]);
+      CU_ASSERT_FATAL (ret == 0);
+    }
+    ids = take_filter_type_ids (rdu);
+    printf ("case %zu: writer %"PRIx32" expected %"PRIx32"\n", k, ids, cases[k].exp);
+    CU_ASSERT (ids == cases[k].exp);
+    (void) take_filter_type_ids (rdf);
+    dds_delete (tpf);
+  }
+  dds_delete_qos (qos);
+  dds_delete (dp);
+}
+
+#ifdef DDS_HAS_TYPELIB
+static uint64_t writer_filtered_count (dds_entity_t wr)
+{
+  struct dds_statistics *stats = dds_create_statistics (wr);
+  CU_ASSERT_FATAL (stats != NULL);
+  const struct dds_stat_keyvalue *kv = dds_lookup_statistic (stats, "filtered_count");
+  CU_ASSERT_FATAL (kv != NULL);
+  const uint64_t n = kv->u.u64;
+  dds_delete_statistics (stats);
+  return n;
+}
+
+CU_Test (ddsc_filter, predicates_writer_side, .timeout = 30)
+{
+  // a remote writer evaluates the predicates advertised by the reader and sends
+  // GAPs for what the reader doesn't want
+  const char *config = "\
+${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}\
+<Discovery>\
+  <ExternalDomainId>0</ExternalDomainId>\
+  <Tag>\\${CYCLONEDDS_PID}</Tag>\
+</Discovery>";
+  char *conf_wr = ddsrt_expand_envvars (config, 0);
+  char *conf_rd = ddsrt_expand_envvars (config, 1);
+  const dds_entity_t dom_wr = dds_create_domain (0, conf_wr);
+  CU_ASSERT_FATAL (dom_wr > 0);
+  const dds_entity_t dom_rd = dds_create_domain (1, conf_rd);
+  CU_ASSERT_FATAL (dom_rd > 0);
+  ddsrt_free (conf_wr);
+  ddsrt_free (conf_rd);
+  const dds_entity_t dp_wr = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (dp_wr > 0);
+  const dds_entity_t dp_rd = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (dp_rd > 0);
+
+  char topicname[100];
+  create_unique_topic_name ("ddsc_filter", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t tp_wr = dds_create_topic (dp_wr, &Space_filter_type_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_wr > 0);
+  const dds_entity_t tp_rd = dds_create_topic (dp_rd, &Space_filter_type_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_rd > 0);
+  const struct dds_topic_filter_predicate preds[] = {
+    { offsetof (Space_filter_type, str), DDS_TOPIC_FILTER_OP_EQ, { .s = "odd" } },
+    { offsetof (Space_filter_type, inner.d), DDS_TOPIC_FILTER_OP_GE, { .d = 1.0 } },
+    { offsetof (Space_filter_type, ll), DDS_TOPIC_FILTER_OP_GT, { .i = -7000000000000 } }
+  };
+  dds_return_t ret = dds_set_topic_filter_predicates (tp_rd, 3, preds);
+  CU_ASSERT_FATAL (ret == 0);
+  const dds_entity_t rd = dds_create_reader (dp_rd, tp_rd, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (dp_wr, tp_wr, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+  sync_reader_writer (dp_rd, rd, dp_wr, wr);
+
+  Space_filter_type samples[8];
+  struct filter_type_samples_buf buf;
+  init_filter_type_samples (samples, &buf);
+
+  // the content filter is part of the reader's first discovery message, so
+  // the writer already knows it when it matches the reader
+  CU_ASSERT (writer_filtered_count (wr) == 0);
+  for (int32_t i = 0; i < 8; i++)
+  {
+    ret = dds_write (wr, &samples[i]);
+    CU_ASSERT_FATAL (ret == 0);
+  }
+  // GAPs for the rejected ones mean the reader can acknowledge everything
+  ret = dds_wait_for_acks (wr, DDS_SECS (5));
+  CU_ASSERT_FATAL (ret == 0);
+  const uint64_t filtered = writer_filtered_count (wr);
+  printf ("filtered at writer: %"PRIu64"\n", filtered);
+  CU_ASSERT (filtered == 6);
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  uint32_t ids = 0;
+  while (ids != 0x28 && dds_time () < tend)
+  {
+    ids |= take_filter_type_ids (rd);
+    dds_sleepfor (DDS_MSECS (10));
+  }
+  CU_ASSERT (ids == 0x28);
+
+  ret = dds_delete (dom_wr);
+  CU_ASSERT_FATAL (ret == 0);
+  ret = dds_delete (dom_rd);
+  CU_ASSERT_FATAL (ret == 0);
+}
+#endif
+
+struct shared_sample_arg {
+  int n;
+  const void *samples[6];
+  int32_t long_1[6];
+};
+
+static bool filter_record_sample (const void *sample, void *varg)
+{
+  struct shared_sample_arg *arg = varg;
+  if (arg->n < 6)
+  {
+    arg->samples[arg->n] = sample;
+    arg->long_1[arg->n] = ((const Space_Type1 *) sample)->long_1;
+  }
+  arg->n++;
+  return true;
+}
+
+CU_Test (ddsc_filter, shared_sample)
+{
+  // readers receiving the same data evaluate the filter function on the same
+  // deserialized sample, also if they use different topic entities, and the
+  // next write gets deserialized again
+  const dds_entity_t dp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (dp > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_filter", topicname, sizeof (topicname));
+  struct shared_sample_arg arg = { .n = 0 };
+  for (int i = 0; i < 3; i++)
+  {
+    const dds_entity_t tp = dds_create_topic (dp, &Space_Type1_desc, topicname, NULL, NULL);
+    CU_ASSERT_FATAL (tp > 0);
+    dds_return_t ret = dds_set_topic_filter_and_arg (tp, filter_record_sample, &arg);
+    CU_ASSERT_FATAL (ret == 0);
+    const dds_entity_t rd = dds_create_reader (dp, tp, NULL, NULL);
+    CU_ASSERT_FATAL (rd > 0);
+    if (i == 0)
+    {
+      const dds_entity_t rd2 = dds_create_reader (dp, tp, NULL, NULL);
+      CU_ASSERT_FATAL (rd2 > 0);
+    }
+  }
+  const dds_entity_t tpw = dds_create_topic (dp, &Space_Type1_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tpw > 0);
+  const dds_entity_t wr = dds_create_writer (dp, tpw, NULL, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_return_t ret = dds_write (wr, &(Space_Type1){ 1, 2, 3 });
+  CU_ASSERT_FATAL (ret == 0);
+  CU_ASSERT_FATAL (arg.n == 4);
+  for (int i = 0; i < 4; i++)
+  {
+    CU_ASSERT (arg.samples[i] == arg.samples[0]);
+    CU_ASSERT (arg.long_1[i] == 1);
+  }
+  ret = dds_write (wr, &(Space_Type1){ 4, 5, 6 });
+  CU_ASSERT_FATAL (ret == 0);
+  CU_ASSERT_FATAL (arg.n == 8);
+  CU_ASSERT (arg.long_1[4] == 4 && arg.long_1[5] == 4);
+  CU_ASSERT (arg.samples[4] == arg.samples[5]);
+  dds_delete (dp);
+}
+
+CU_Test (ddsc_filter, sertype_ops_version)
+{
+  // content_filter_new only exists in version 1 of the sertype operations: an
+  // operations table of version 0 can't have it and mustn't be looked at
+  const dds_entity_t dp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (dp > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_filter", topicname, sizeof (topicname));
+  const dds_entity_t tp = dds_create_topic (dp, &Space_filter_type_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  const struct dds_topic_filter_predicate pred = { offsetof (Space_filter_type, str), DDS_TOPIC_FILTER_OP_EQ, { .s = "odd" } };
+  dds_return_t ret = dds_set_topic_filter_predicates (tp, 1, &pred);
+  CU_ASSERT_FATAL (ret == 0);
+
+  struct dds_topic *x;
+  ret = dds_topic_pin (tp, &x);
+  CU_ASSERT_FATAL (ret == 0);
+  struct ddsi_content_filter_property *cfp = dds_topic_filter_predicates_to_property (x->m_name, x->m_filter_preds);
+  CU_ASSERT_FATAL (cfp != NULL);
+  const struct ddsi_sertype *st = x->m_stype;
+  CU_ASSERT_FATAL (st->ops->version == ddsi_sertype_v1);
+  struct ddsi_sertype_content_filter *f = ddsi_sertype_content_filter_new (st, cfp);
+  CU_ASSERT_FATAL (f != NULL);
+  f->free (f);
+
+  struct ddsi_sertype_ops ops_v0 = *st->ops;
+  ops_v0.version = ddsi_sertype_v0;
+  struct ddsi_sertype st_v0;
+  memcpy (&st_v0, st, sizeof (st_v0));
+  st_v0.ops = &ops_v0;
+  CU_ASSERT (ddsi_sertype_content_filter_new (&st_v0, cfp) == NULL);
+
+  ddsi_content_filter_property_free (cfp);
+  dds_topic_unpin (x);
+  dds_delete (dp);
+}
@@ -0,0 +1,209 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdlib.h>
+
+#include "CUnit/Test.h"
+
+#include "dds/dds.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/time.h"
+#include "dds/ddsrt/random.h"
+#include "dds__handles.h"
+
+#define MAX_THREADS 16
+#define N_ENTITIES 64
+
+struct pin_arg {
+  ddsrt_atomic_uint32_t *stop;
+  ddsrt_atomic_uint32_t *entities;
+  uint32_t nentities;
+  uint64_t npins;
+  uint64_t nfailed;
+  uint64_t nwrong; /* pinned an entity other than the one asked for */
+};
+
+static uint32_t pin_unpin_thread (void *varg)
+{
+  struct pin_arg * const arg = varg;
+  uint32_t i = 0;
+  while (!ddsrt_atomic_ld32 (arg->stop))
+  {
+    struct dds_handle_link *link;
+    const dds_entity_t e = (dds_entity_t) ddsrt_atomic_ld32 (&arg->entities[i]);
+    if (dds_handle_pin (e, &link) != DDS_RETCODE_OK)
+      arg->nfailed++;
+    else
+    {
+      if (link->hdl != e)
+        arg->nwrong++;
+      dds_handle_unpin (link);
+      arg->npins++;
+    }
+    if (++i == arg->nentities)
+      i = 0;
+  }
+  return 0;
+}
+
+static void run_pin_threads (uint32_t nthreads, struct pin_arg *args, dds_duration_t duration)
+{
+  ddsrt_thread_t tids[MAX_THREADS];
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  for (uint32_t i = 0; i < nthreads; i++)
+  {
+    dds_return_t rc = ddsrt_thread_create (&tids[i], "pin", &tattr, pin_unpin_thread, &args[i]);
+    CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  }
+  dds_sleepfor (duration);
+  ddsrt_atomic_st32 (args[0].stop, 1);
+  for (uint32_t i = 0; i < nthreads; i++)
+    (void) ddsrt_thread_join (tids[i], NULL);
+}
+
+CU_Test (ddsc_handles, pin_unpin_concurrent)
+{
+  // Each thread pins and unpins a handle of its own, like application threads
+  // each writing with their own writer, and then all of them the same handle.
+  // Pinning must never fail and all pins must be released afterwards.  The
+  // throughput is measured by src/core/xtests/handle_bench.
+  ddsrt_atomic_uint32_t entities[MAX_THREADS];
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  for (uint32_t i = 0; i < MAX_THREADS; i++)
+  {
+    const dds_entity_t gc = dds_create_guardcondition (pp);
+    CU_ASSERT_FATAL (gc > 0);
+    ddsrt_atomic_st32 (&entities[i], (uint32_t) gc);
+  }
+  for (int shared = 0; shared <= 1; shared++)
+  {
+    for (uint32_t nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2)
+    {
+      ddsrt_atomic_uint32_t stop = DDSRT_ATOMIC_UINT32_INIT (0);
+      struct pin_arg args[MAX_THREADS];
+      for (uint32_t i = 0; i < nthreads; i++)
+        args[i] = (struct pin_arg) { .stop = &stop, .entities = &entities[shared ? 0 : i], .nentities = 1, .npins = 0, .nfailed = 0, .nwrong = 0 };
+      run_pin_threads (nthreads, args, DDS_MSECS (50));
+      for (uint32_t i = 0; i < nthreads; i++)
+      {
+        CU_ASSERT (args[i].nfailed == 0);
+        CU_ASSERT (args[i].nwrong == 0);
+        CU_ASSERT (args[i].npins > 0);
+      }
+    }
+  }
+  for (uint32_t i = 0; i < MAX_THREADS; i++)
+  {
+    struct dds_handle_link *link;
+    dds_return_t rc = dds_handle_pin ((dds_entity_t) ddsrt_atomic_ld32 (&entities[i]), &link);
+    CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+    // only the one just taken
+    CU_ASSERT ((ddsrt_atomic_ldptr (&link->cnt_flags) & HDL_PINCOUNT_MASK) == 1);
+    dds_handle_unpin (link);
+  }
+  dds_return_t rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+CU_Test (ddsc_handles, pin_while_deleting)
+{
+  // Pinning must be safe against concurrent deletion: stale handles must
+  // fail cleanly and never yield an entity other than the one asked for
+  ddsrt_atomic_uint32_t entities[N_ENTITIES];
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  for (uint32_t i = 0; i < N_ENTITIES; i++)
+  {
+    const dds_entity_t gc = dds_create_guardcondition (pp);
+    CU_ASSERT_FATAL (gc > 0);
+    ddsrt_atomic_st32 (&entities[i], (uint32_t) gc);
+  }
+
+  const uint32_t nthreads = 4;
+  ddsrt_atomic_uint32_t stop = DDSRT_ATOMIC_UINT32_INIT (0);
+  struct pin_arg args[MAX_THREADS];
+  ddsrt_thread_t tids[MAX_THREADS];
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  for (uint32_t i = 0; i < nthreads; i++)
+  {
+    args[i] = (struct pin_arg) { .stop = &stop, .entities = entities, .nentities = N_ENTITIES, .npins = 0, .nfailed = 0, .nwrong = 0 };
+    dds_return_t rc = ddsrt_thread_create (&tids[i], "pin", &tattr, pin_unpin_thread, &args[i]);
+    CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  }
+  const dds_time_t tend = dds_time () + DDS_MSECS (500);
+  uint32_t ndeleted = 0;
+  while (dds_time () < tend)
+  {
+    const uint32_t i = ddsrt_random () % N_ENTITIES;
+    // the old handle is still being used by the pinning threads until they
+    // see the new one, so it must not be valid anymore
+    const dds_entity_t old = (dds_entity_t) ddsrt_atomic_ld32 (&entities[i]);
+    dds_return_t rc = dds_delete (old);
+    CU_ASSERT_FATAL (rc == 0);
+    const dds_entity_t gc = dds_create_guardcondition (pp);
+    CU_ASSERT_FATAL (gc > 0 && gc != old);
+    ddsrt_atomic_st32 (&entities[i], (uint32_t) gc);
+    struct dds_handle_link *link;
+    CU_ASSERT (dds_handle_pin (old, &link) == DDS_RETCODE_BAD_PARAMETER);
+    ndeleted++;
+  }
+  ddsrt_atomic_st32 (&stop, 1);
+  uint64_t npins = 0;
+  for (uint32_t i = 0; i < nthreads; i++)
+  {
+    (void) ddsrt_thread_join (tids[i], NULL);
+    CU_ASSERT (args[i].nwrong == 0);
+    npins += args[i].npins;
+  }
+  CU_ASSERT (ndeleted > 0);
+  CU_ASSERT (npins > 0);
+  dds_return_t rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+static int cmp_entity (const void *va, const void *vb)
+{
+  const dds_entity_t *a = va, *b = vb;
+  return (*a == *b) ? 0 : (*a < *b) ? -1 : 1;
+}
+
+CU_Test (ddsc_handles, stale_handles)
+{
+  // Handles of deleted entities get reused only after very many other
+  // entities have been deleted, this cycles through the slots a few times
+  // and all handles must still be unique and the stale ones invalid
+  const uint32_t n = 20000;
+  dds_entity_t *hs = ddsrt_malloc (n * sizeof (*hs));
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    hs[i] = dds_create_guardcondition (pp);
+    CU_ASSERT_FATAL (hs[i] > 0);
+    dds_return_t rc = dds_delete (hs[i]);
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  for (uint32_t i = 0; i < n; i++)
+  {
+    struct dds_handle_link *link;
+    CU_ASSERT (dds_handle_pin (hs[i], &link) == DDS_RETCODE_BAD_PARAMETER);
+  }
+  qsort (hs, n, sizeof (*hs), cmp_entity);
+  for (uint32_t i = 1; i < n; i++)
+    CU_ASSERT (hs[i] != hs[i - 1]);
+  dds_return_t rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+  ddsrt_free (hs);
+}
@@ -8,6 +8,7 @@
 //
 // SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "dds/dds.h"
@@ -16,6 +17,8 @@
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/string.h"
 #include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/io.h"
+#include "dds/ddsrt/threads.h"
 #include "test_common.h"
 #include "test_oneliner.h"
 
@@ -491,3 +494,222 @@ CU_Test (ddsc_listener, liveliness_changed)
   dotest ("pm w lc sm r ; ?pm w ?sm r ; ?lc(1,0,1,0,w) r ; -w ; ?lc(0,0,-1,0,w) r");
   dotest ("pm w lc sm r' ; ?pm w ?sm r' ; ?lc(1,0,1,0,w) r' ; -w ; ?lc(0,0,-1,0,w) r'");
 }
+
+/**************************************************
+ ****                                          ****
+ ****  listener threads                        ****
+ ****                                          ****
+ **************************************************/
+
+struct blocking_listener_arg {
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  bool block, blocked;
+  uint32_t ncalls, ntaken;
+  bool other_thread;
+  ddsrt_thread_t app_thread;
+};
+
+static void blocking_data_available_cb (dds_entity_t reader, void *varg)
+{
+  struct blocking_listener_arg * const arg = varg;
+  ddsrt_mutex_lock (&arg->lock);
+  arg->ncalls++;
+  if (ddsrt_thread_equal (ddsrt_thread_self (), arg->app_thread))
+    arg->other_thread = false;
+  arg->blocked = true;
+  ddsrt_cond_broadcast (&arg->cond);
+  while (arg->block)
+    ddsrt_cond_wait (&arg->cond, &arg->lock);
+  arg->blocked = false;
+  ddsrt_mutex_unlock (&arg->lock);
+
+  Space_Type1 sample;
+  void *raw = &sample;
+  dds_sample_info_t si;
+  int32_t n;
+  while ((n = dds_take (reader, &raw, &si, 1, 1)) > 0)
+  {
+    ddsrt_mutex_lock (&arg->lock);
+    arg->ntaken += (uint32_t) n;
+    ddsrt_cond_broadcast (&arg->cond);
+    ddsrt_mutex_unlock (&arg->lock);
+  }
+}
+
+static void blocking_listener_init (struct blocking_listener_arg *arg)
+{
+  ddsrt_mutex_init (&arg->lock);
+  ddsrt_cond_init (&arg->cond);
+  arg->block = true;
+  arg->blocked = false;
+  arg->ncalls = arg->ntaken = 0;
+  arg->other_thread = true;
+  arg->app_thread = ddsrt_thread_self ();
+}
+
+static void blocking_listener_fini (struct blocking_listener_arg *arg)
+{
+  ddsrt_cond_destroy (&arg->cond);
+  ddsrt_mutex_destroy (&arg->lock);
+}
+
+static bool blocking_listener_wait (struct blocking_listener_arg *arg, bool blocked, uint32_t ntaken)
+{
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  bool ok = true;
+  ddsrt_mutex_lock (&arg->lock);
+  while (ok && (arg->blocked != blocked || arg->ntaken < ntaken))
+    ok = ddsrt_cond_waituntil (&arg->cond, &arg->lock, tend);
+  ddsrt_mutex_unlock (&arg->lock);
+  return ok;
+}
+
+static void blocking_listener_release (struct blocking_listener_arg *arg)
+{
+  ddsrt_mutex_lock (&arg->lock);
+  arg->block = false;
+  ddsrt_cond_broadcast (&arg->cond);
+  ddsrt_mutex_unlock (&arg->lock);
+}
+
+static dds_entity_t create_reader_with_blocking_listener (dds_entity_t pp, dds_entity_t *writer, struct blocking_listener_arg *arg)
+{
+  char topicname[100];
+  create_unique_topic_name ("ddsc_listener_threads", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t tp = dds_create_topic (pp, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  dds_listener_t *list = dds_create_listener (arg);
+  dds_lset_data_available (list, blocking_data_available_cb);
+  const dds_entity_t rd = dds_create_reader (pp, tp, qos, list);
+  CU_ASSERT_FATAL (rd > 0);
+  dds_delete_listener (list);
+  *writer = dds_create_writer (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (*writer > 0);
+  dds_delete_qos (qos);
+  return rd;
+}
+
+static dds_entity_t create_listener_threads_domain (uint32_t nthreads)
+{
+  char *conf_raw, *conf;
+  (void) ddsrt_asprintf (&conf_raw,
+    "${CYCLONEDDS_URI}${CYCLONEDDS_URI:+,}<Discovery><Tag>${CYCLONEDDS_PID}</Tag></Discovery>"
+    "<Internal><ListenerThreads>%"PRIu32"</ListenerThreads></Internal>", nthreads);
+  conf = ddsrt_expand_envvars (conf_raw, 0);
+  const dds_entity_t dom = dds_create_domain (0, conf);
+  CU_ASSERT_FATAL (dom > 0);
+  ddsrt_free (conf);
+  ddsrt_free (conf_raw);
+  return dom;
+}
+
+CU_Test (ddsc_listener, threads_data_available)
+{
+  // A blocked listener must not block the writer (local delivery is synchronous, so
+  // without listener threads it would), and the data available events that occur
+  // while it is blocked don't cause another invocation: it takes all data
+  const dds_entity_t dom = create_listener_threads_domain (2);
+  const dds_entity_t pp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  struct blocking_listener_arg arg;
+  blocking_listener_init (&arg);
+  dds_entity_t wr;
+  const dds_entity_t rd = create_reader_with_blocking_listener (pp, &wr, &arg);
+  dds_return_t rc;
+  rc = dds_write (wr, &(Space_Type1){ 0, 0, 0 });
+  CU_ASSERT_FATAL (rc == 0);
+  CU_ASSERT_FATAL (blocking_listener_wait (&arg, true, 0));
+  for (int32_t i = 1; i < 10; i++)
+  {
+    rc = dds_write (wr, &(Space_Type1){ i, 0, 0 });
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  blocking_listener_release (&arg);
+  CU_ASSERT_FATAL (blocking_listener_wait (&arg, false, 10));
+  // give a spurious extra invocation a chance to show up
+  dds_sleepfor (DDS_MSECS (100));
+  ddsrt_mutex_lock (&arg.lock);
+  CU_ASSERT (arg.ncalls == 1);
+  CU_ASSERT (arg.ntaken == 10);
+  CU_ASSERT (arg.other_thread);
+  ddsrt_mutex_unlock (&arg.lock);
+  rc = dds_delete (rd);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+  blocking_listener_fini (&arg);
+}
+
+CU_Test (ddsc_listener, threads_blocked_entity)
+{
+  // Events for an entity whose listener is blocked must not occupy another listener
+  // thread, so that the remaining one can still handle events for other entities
+  const dds_entity_t dom = create_listener_threads_domain (2);
+  const dds_entity_t pp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  struct blocking_listener_arg arg1, arg2;
+  blocking_listener_init (&arg1);
+  blocking_listener_init (&arg2);
+  blocking_listener_release (&arg2);
+  dds_entity_t wr1, wr2;
+  (void) create_reader_with_blocking_listener (pp, &wr1, &arg1);
+  (void) create_reader_with_blocking_listener (pp, &wr2, &arg2);
+  dds_return_t rc;
+  rc = dds_write (wr1, &(Space_Type1){ 0, 0, 0 });
+  CU_ASSERT_FATAL (rc == 0);
+  CU_ASSERT_FATAL (blocking_listener_wait (&arg1, true, 0));
+  for (int32_t i = 1; i < 10; i++)
+  {
+    rc = dds_write (wr1, &(Space_Type1){ i, 0, 0 });
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  for (int32_t i = 0; i < 10; i++)
+  {
+    rc = dds_write (wr2, &(Space_Type1){ i, 0, 0 });
+    CU_ASSERT_FATAL (rc == 0);
+    CU_ASSERT_FATAL (blocking_listener_wait (&arg2, false, (uint32_t) i + 1));
+  }
+  ddsrt_mutex_lock (&arg1.lock);
+  CU_ASSERT (arg1.blocked && arg1.ncalls == 1);
+  ddsrt_mutex_unlock (&arg1.lock);
+  blocking_listener_release (&arg1);
+  CU_ASSERT_FATAL (blocking_listener_wait (&arg1, false, 10));
+  rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+  blocking_listener_fini (&arg1);
+  blocking_listener_fini (&arg2);
+}
+
+CU_Test (ddsc_listener, threads_delete_queued)
+{
+  // With a single listener thread busy in a listener for reader 1, an event for reader 2
+  // can only be queued; deleting reader 2 must not wait for it to be processed
+  const dds_entity_t dom = create_listener_threads_domain (1);
+  const dds_entity_t pp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  struct blocking_listener_arg arg1, arg2;
+  blocking_listener_init (&arg1);
+  blocking_listener_init (&arg2);
+  dds_entity_t wr1, wr2;
+  (void) create_reader_with_blocking_listener (pp, &wr1, &arg1);
+  const dds_entity_t rd2 = create_reader_with_blocking_listener (pp, &wr2, &arg2);
+  dds_return_t rc;
+  rc = dds_write (wr1, &(Space_Type1){ 0, 0, 0 });
+  CU_ASSERT_FATAL (rc == 0);
+  CU_ASSERT_FATAL (blocking_listener_wait (&arg1, true, 0));
+  rc = dds_write (wr2, &(Space_Type1){ 0, 0, 0 });
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (rd2);
+  CU_ASSERT_FATAL (rc == 0);
+  blocking_listener_release (&arg1);
+  CU_ASSERT_FATAL (blocking_listener_wait (&arg1, false, 1));
+  CU_ASSERT (arg2.ncalls == 0);
+  rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+  blocking_listener_fini (&arg1);
+  blocking_listener_fini (&arg2);
+}
@@ -10,6 +10,7 @@
 
 #include <stdio.h>
 #include "dds/dds.h"
+#include "dds/ddsc/dds_statistics.h"
 #include "test_common.h"
 #include "build_options.h"
 
@@ -345,3 +346,56 @@ CU_Test (ddsc_loan, read_cleanup, .init = create_entities, .fini = delete_entiti
   CU_ASSERT_FATAL (result == DDS_RETCODE_OK);
 }
 
+
+CU_Test (ddsc_loan, writer_heap_loan_pool, .init = create_entities, .fini = delete_entities)
+{
+  // Heap loans on a writer without PSMX get recycled once the data written with them
+  // has been dropped: keep-last 1 history in the reader means that happens on the next
+  // write.  The keep-all reader created by the fixture would hold on to all of them.
+  const int nwrites = 10;
+  dds_return_t result;
+  result = dds_delete (reader);
+  CU_ASSERT_FATAL (result == DDS_RETCODE_OK);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_history (qos, DDS_HISTORY_KEEP_LAST, 1);
+  const dds_entity_t wr = dds_create_writer (participant, topic, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  const dds_entity_t rd = dds_create_reader (participant, topic, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  dds_delete_qos (qos);
+  for (int i = 0; i < nwrites; i++)
+  {
+    void *sample;
+    result = dds_request_loan (wr, &sample);
+    CU_ASSERT_FATAL (result == DDS_RETCODE_OK);
+    RoundTripModule_DataType *s = sample;
+    CU_ASSERT_FATAL (s->payload._length == 0 && s->payload._buffer == NULL);
+    s->payload._length = s->payload._maximum = 1;
+    s->payload._buffer = dds_alloc (1);
+    s->payload._buffer[0] = (uint8_t) i;
+    s->payload._release = true;
+    result = dds_write (wr, sample);
+    CU_ASSERT_FATAL (result == DDS_RETCODE_OK);
+  }
+
+  struct dds_statistics *stats = dds_create_statistics (wr);
+  CU_ASSERT_FATAL (stats != NULL);
+  const struct dds_stat_keyvalue *hits = dds_lookup_statistic (stats, "loan_pool_hits");
+  const struct dds_stat_keyvalue *misses = dds_lookup_statistic (stats, "loan_pool_misses");
+  CU_ASSERT_FATAL (hits != NULL && misses != NULL);
+  CU_ASSERT_FATAL (hits->u.u64 + misses->u.u64 == (uint64_t) nwrites);
+  CU_ASSERT_FATAL (hits->u.u64 >= (uint64_t) nwrites - 2);
+  dds_delete_statistics (stats);
+
+  // The last sample is still in the reader and references the loan, deleting the
+  // writer first means it can no longer be returned to the pool
+  result = dds_delete (wr);
+  CU_ASSERT_FATAL (result == DDS_RETCODE_OK);
+  void *ptrs[1] = { NULL };
+  dds_sample_info_t si;
+  int32_t n = dds_take (rd, ptrs, &si, 1, 1);
+  CU_ASSERT_FATAL (n == 1);
+  CU_ASSERT_FATAL (((RoundTripModule_DataType *) ptrs[0])->payload._buffer[0] == (uint8_t) (nwrites - 1));
+  result = dds_return_loan (rd, ptrs, n);
+  CU_ASSERT_FATAL (result == DDS_RETCODE_OK);
+}
@@ -0,0 +1,451 @@
+// Copyright(c) 2026 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CUnit/Test.h"
+#include "dds/dds.h"
+#include "dds/ddsrt/bswap.h"
+#include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/io.h"
+#include "dds/ddsrt/misc.h"
+#include "dds/ddsrt/process.h"
+#include "dds/ddsrt/sockets.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "ddsi__pcap.h"
+#include "dds__types.h"
+#include "dds__entity.h"
+
+#define PCAP_CONFIG \
+  "<General><Interfaces><NetworkInterface address=\"127.0.0.1\"/></Interfaces></General>" \
+  "<Discovery><ExternalDomainId>0</ExternalDomainId><Tag>${CYCLONEDDS_PID}</Tag></Discovery>" \
+  "<Tracing><PacketCaptureFile SnapLength=\"%"PRIu32"\" SampleInterval=\"%"PRIu32"\" BufferSize=\"%"PRIu32"B\">%s</PacketCaptureFile></Tracing>"
+
+#define PCAP_FILEHDR_SIZE 24
+#define PCAP_RECHDR_SIZE 16
+#define IPUDP_HDR_SIZE 28
+
+// Injected packets are addressed to 192.0.2.1 (TEST-NET-1) so that they can
+// be told apart from the packets the domain itself sends and receives. The
+// source port identifies the stream and the first 4 bytes of the payload
+// hold the sequence number within the stream.
+static const unsigned char inject_dstip[4] = { 192, 0, 2, 1 };
+
+static char pcap_file[64];
+
+static dds_entity_t create_pcap_domain (uint32_t snaplen, uint32_t sample_interval, uint32_t bufsize, struct ddsi_domaingv **gv)
+{
+  char *conf_raw, *conf;
+  (void) snprintf (pcap_file, sizeof (pcap_file), "ddsc_pcap_%"PRIdPID".pcap", ddsrt_getpid ());
+  (void) ddsrt_asprintf (&conf_raw, PCAP_CONFIG, snaplen, sample_interval, bufsize, pcap_file);
+  conf = ddsrt_expand_envvars (conf_raw, 0);
+  const dds_entity_t dom = dds_create_domain (0, conf);
+  CU_ASSERT_FATAL (dom > 0);
+  ddsrt_free (conf);
+  ddsrt_free (conf_raw);
+  struct dds_entity *x;
+  dds_return_t rc = dds_entity_pin (dom, &x);
+  CU_ASSERT_FATAL (rc == 0);
+  *gv = &((struct dds_domain *) x)->gv;
+  dds_entity_unpin (x);
+  CU_ASSERT_FATAL ((*gv)->pcap != NULL);
+  return dom;
+}
+
+struct inject_arg {
+  struct ddsi_domaingv *gv;
+  uint16_t port;
+  uint32_t n;
+  size_t size;
+  int64_t tbase; // 0: use current time, else timestamp of packet i is tbase + i * tstep
+  int64_t tstep;
+  bool received;
+  bool stop_on_drop; // stop once a packet was dropped, n is updated to the number injected
+};
+
+static void inject (struct ddsi_domaingv *gv, bool received, ddsrt_wctime_t ts, uint16_t port, uint32_t seq, size_t size)
+{
+  union { struct sockaddr_storage x; struct sockaddr_in a4; } src, dst;
+  memset (&src, 0, sizeof (src));
+  memset (&dst, 0, sizeof (dst));
+  src.a4.sin_family = dst.a4.sin_family = AF_INET;
+  src.a4.sin_addr.s_addr = ddsrt_toBE4u (0x7f000001);
+  src.a4.sin_port = ddsrt_toBE2u (port);
+  memcpy (&dst.a4.sin_addr.s_addr, inject_dstip, sizeof (inject_dstip));
+  dst.a4.sin_port = ddsrt_toBE2u (7400);
+  unsigned char *buf = ddsrt_malloc (size);
+  for (size_t i = 0; i < size; i++)
+    buf[i] = (unsigned char) (seq + i);
+  memcpy (buf, &seq, sizeof (seq));
+  if (received)
+    ddsi_write_pcap_received (gv, ts, &src.x, &dst.x, buf, size);
+  else
+  {
+    // split the payload over two iovecs to also cover gathering it
+    ddsrt_iovec_t iov[2] = {
+      { .iov_base = buf, .iov_len = (ddsrt_iov_len_t) (size / 2) },
+      { .iov_base = buf + size / 2, .iov_len = (ddsrt_iov_len_t) (size - size / 2) }
+    };
+    ddsrt_msghdr_t msg;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_name = &dst.x;
+    msg.msg_namelen = (socklen_t) sizeof (dst.a4);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    ddsi_write_pcap_sent (gv, ts, &src.x, &msg, size);
+  }
+  ddsrt_free (buf);
+}
+
+static uint32_t injector (void *varg)
+{
+  struct inject_arg * const arg = varg;
+  struct ddsi_pcap_stats st0, st;
+  ddsi_pcap_get_stats (arg->gv->pcap, &st0);
+  for (uint32_t i = 0; i < arg->n; i++)
+  {
+    const ddsrt_wctime_t ts = (arg->tbase == 0) ? ddsrt_time_wallclock () : (ddsrt_wctime_t){ arg->tbase + i * arg->tstep };
+    inject (arg->gv, arg->received, ts, arg->port, i, arg->size);
+    // checking only occasionally because getting the stats locks out the writer thread
+    if (arg->stop_on_drop && (i % 16) == 15)
+    {
+      ddsi_pcap_get_stats (arg->gv->pcap, &st);
+      if (st.dropped > st0.dropped)
+      {
+        arg->n = i + 1;
+        break;
+      }
+    }
+  }
+  return 0;
+}
+
+static void run_injector (struct inject_arg *arg)
+{
+  // each thread has its own buffer that gets released when the thread terminates
+  ddsrt_thread_t tid;
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  CU_ASSERT_FATAL (ddsrt_thread_create (&tid, "inject", &tattr, injector, arg) == DDS_RETCODE_OK);
+  CU_ASSERT_FATAL (ddsrt_thread_join (tid, NULL) == DDS_RETCODE_OK);
+}
+
+struct pcap_rec {
+  int64_t ts; // us
+  uint32_t incl_len, orig_len;
+  const unsigned char *data;
+  uint16_t port;
+  uint32_t seq;
+};
+
+struct pcap_contents {
+  unsigned char *buf;
+  size_t size;
+  uint32_t snaplen;
+  uint32_t nrecs; // total number of records
+  uint32_t ninj; // number of injected records
+  struct pcap_rec *inj;
+};
+
+static uint16_t ld16be (const unsigned char *p) { return (uint16_t) ((p[0] << 8) | p[1]); }
+
+static long file_size (const char *name)
+{
+  DDSRT_WARNING_MSVC_OFF(4996);
+  FILE *fp = fopen (name, "rb");
+  DDSRT_WARNING_MSVC_ON(4996);
+  if (fp == NULL)
+    return -1;
+  (void) fseek (fp, 0, SEEK_END);
+  const long sz = ftell (fp);
+  fclose (fp);
+  return sz;
+}
+
+static void read_pcap (struct pcap_contents *pc)
+{
+  DDSRT_WARNING_MSVC_OFF(4996);
+  FILE *fp = fopen (pcap_file, "rb");
+  DDSRT_WARNING_MSVC_ON(4996);
+  CU_ASSERT_FATAL (fp != NULL);
+  (void) fseek (fp, 0, SEEK_END);
+  pc->size = (size_t) ftell (fp);
+  (void) fseek (fp, 0, SEEK_SET);
+  pc->buf = ddsrt_malloc (pc->size);
+  CU_ASSERT_FATAL (fread (pc->buf, 1, pc->size, fp) == pc->size);
+  fclose (fp);
+  (void) remove (pcap_file);
+
+  // file header, written in native byte order
+  CU_ASSERT_FATAL (pc->size >= PCAP_FILEHDR_SIZE);
+  uint32_t magic, network;
+  uint16_t vmaj, vmin;
+  memcpy (&magic, pc->buf, 4);
+  memcpy (&vmaj, pc->buf + 4, 2);
+  memcpy (&vmin, pc->buf + 6, 2);
+  memcpy (&pc->snaplen, pc->buf + 16, 4);
+  memcpy (&network, pc->buf + 20, 4);
+  CU_ASSERT (magic == 0xa1b2c3d4);
+  CU_ASSERT (vmaj == 2 && vmin == 4);
+  CU_ASSERT (network == 101);
+
+  pc->nrecs = pc->ninj = 0;
+  pc->inj = NULL;
+  size_t pos = PCAP_FILEHDR_SIZE;
+  while (pos < pc->size)
+  {
+    CU_ASSERT_FATAL (pos + PCAP_RECHDR_SIZE <= pc->size);
+    int32_t ts_sec, ts_usec;
+    struct pcap_rec r;
+    memcpy (&ts_sec, pc->buf + pos, 4);
+    memcpy (&ts_usec, pc->buf + pos + 4, 4);
+    memcpy (&r.incl_len, pc->buf + pos + 8, 4);
+    memcpy (&r.orig_len, pc->buf + pos + 12, 4);
+    r.ts = (int64_t) ts_sec * 1000000 + ts_usec;
+    r.data = pc->buf + pos + PCAP_RECHDR_SIZE;
+    CU_ASSERT_FATAL (r.incl_len <= pc->snaplen && r.incl_len <= r.orig_len);
+    CU_ASSERT_FATAL (r.incl_len >= IPUDP_HDR_SIZE);
+    CU_ASSERT_FATAL (pos + PCAP_RECHDR_SIZE + r.incl_len <= pc->size);
+    pos += PCAP_RECHDR_SIZE + r.incl_len;
+    pc->nrecs++;
+
+    // every record gets a valid IPv4 header
+    uint32_t cksum = 0;
+    for (int i = 0; i < 20; i += 2)
+      cksum += ld16be (r.data + i);
+    cksum = (cksum & 0xffff) + (cksum >> 16);
+    CU_ASSERT (cksum == 0xffff);
+    CU_ASSERT (r.data[0] == 0x45 && r.data[9] == 17);
+    CU_ASSERT (ld16be (r.data + 2) == r.orig_len);
+    CU_ASSERT (ld16be (r.data + 24) == r.orig_len - 20);
+    if (memcmp (r.data + 16, inject_dstip, sizeof (inject_dstip)) != 0)
+      continue;
+
+    // injected ones also have a known payload
+    CU_ASSERT_FATAL (r.incl_len >= IPUDP_HDR_SIZE + 4);
+    r.port = ld16be (r.data + 20);
+    memcpy (&r.seq, r.data + IPUDP_HDR_SIZE, 4);
+    for (uint32_t i = 4; i < r.incl_len - IPUDP_HDR_SIZE; i++)
+      CU_ASSERT (r.data[IPUDP_HDR_SIZE + i] == (unsigned char) (r.seq + i));
+    pc->inj = ddsrt_realloc (pc->inj, (pc->ninj + 1) * sizeof (*pc->inj));
+    pc->inj[pc->ninj++] = r;
+  }
+}
+
+static void free_pcap (struct pcap_contents *pc)
+{
+  ddsrt_free (pc->inj);
+  ddsrt_free (pc->buf);
+}
+
+CU_Test (ddsc_pcap, contents)
+{
+  struct ddsi_domaingv *gv;
+  const dds_entity_t dom = create_pcap_domain (65535, 1, 1048576, &gv);
+  const dds_entity_t pp = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  struct inject_arg args[2] = {
+    { .gv = gv, .port = 1000, .n = 10, .size = 100, .received = false },
+    { .gv = gv, .port = 1001, .n = 10, .size = 3000, .received = true }
+  };
+  for (size_t i = 0; i < sizeof (args) / sizeof (args[0]); i++)
+    run_injector (&args[i]);
+
+  // capturing is asynchronous: the writer thread gets them into the file
+  // without any further packets being captured or the domain being deleted
+  struct ddsi_pcap_stats st;
+  const long minsize = PCAP_FILEHDR_SIZE + 20 * (PCAP_RECHDR_SIZE + IPUDP_HDR_SIZE) + 10 * 100 + 10 * 3000;
+  dds_time_t tend = dds_time () + DDS_SECS (10);
+  do {
+    ddsi_pcap_get_stats (gv->pcap, &st);
+    if (st.written >= 20 && file_size (pcap_file) >= minsize)
+      break;
+    dds_sleepfor (DDS_MSECS (10));
+  } while (dds_time () < tend);
+  CU_ASSERT (st.written >= 20);
+  CU_ASSERT (st.dropped == 0);
+  CU_ASSERT (file_size (pcap_file) >= minsize);
+
+  dds_return_t rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+
+  struct pcap_contents pc;
+  read_pcap (&pc);
+  CU_ASSERT (pc.snaplen == 65535);
+  CU_ASSERT (pc.nrecs >= 20);
+  CU_ASSERT_FATAL (pc.ninj == 20);
+  uint32_t next[2] = { 0, 0 };
+  for (uint32_t i = 0; i < pc.ninj; i++)
+  {
+    const struct pcap_rec *r = &pc.inj[i];
+    CU_ASSERT_FATAL (r->port == 1000 || r->port == 1001);
+    const struct inject_arg *a = &args[r->port - 1000];
+    CU_ASSERT (r->seq == next[r->port - 1000]++);
+    CU_ASSERT (r->orig_len == IPUDP_HDR_SIZE + a->size);
+    CU_ASSERT (r->incl_len == r->orig_len);
+    CU_ASSERT (r->data[8] == (a->received ? 128 : 255));
+    CU_ASSERT (ld16be (r->data + 12) == 0x7f00 && ld16be (r->data + 14) == 0x0001);
+    CU_ASSERT (ld16be (r->data + 22) == 7400);
+  }
+  free_pcap (&pc);
+}
+
+CU_Test (ddsc_pcap, snaplen)
+{
+  struct ddsi_domaingv *gv;
+  const dds_entity_t dom = create_pcap_domain (100, 1, 1048576, &gv);
+  static const size_t sizes[] = { 4, 72, 73, 1000, 60000 };
+  struct inject_arg args[sizeof (sizes) / sizeof (sizes[0])];
+  for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+  {
+    args[i] = (struct inject_arg){ .gv = gv, .port = (uint16_t) (1000 + i), .n = 1, .size = sizes[i], .received = (i % 2) == 0 };
+    run_injector (&args[i]);
+  }
+  dds_return_t rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+
+  struct pcap_contents pc;
+  read_pcap (&pc);
+  CU_ASSERT (pc.snaplen == 100);
+  CU_ASSERT_FATAL (pc.ninj == sizeof (sizes) / sizeof (sizes[0]));
+  for (uint32_t i = 0; i < pc.ninj; i++)
+  {
+    const struct pcap_rec *r = &pc.inj[i];
+    CU_ASSERT_FATAL (r->port >= 1000 && r->port < 1000 + sizeof (sizes) / sizeof (sizes[0]));
+    const size_t sz = sizes[r->port - 1000];
+    CU_ASSERT (r->orig_len == IPUDP_HDR_SIZE + sz);
+    CU_ASSERT (r->incl_len == (IPUDP_HDR_SIZE + sz < 100 ? IPUDP_HDR_SIZE + sz : 100));
+  }
+  free_pcap (&pc);
+}
+
+CU_Test (ddsc_pcap, sample_interval)
+{
+  struct ddsi_domaingv *gv;
+  const dds_entity_t dom = create_pcap_domain (65535, 3, 1048576, &gv);
+  // each thread captures 1 out of every 3, starting with the first
+  struct inject_arg args[2] = {
+    { .gv = gv, .port = 1000, .n = 10, .size = 100, .received = false },
+    { .gv = gv, .port = 1001, .n = 2, .size = 100, .received = true }
+  };
+  for (size_t i = 0; i < sizeof (args) / sizeof (args[0]); i++)
+    run_injector (&args[i]);
+  dds_return_t rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+
+  struct pcap_contents pc;
+  read_pcap (&pc);
+  static const struct { uint16_t port; uint32_t seq; } exp[] = {
+    { 1000, 0 }, { 1000, 3 }, { 1000, 6 }, { 1000, 9 }, { 1001, 0 }
+  };
+  CU_ASSERT_FATAL (pc.ninj == sizeof (exp) / sizeof (exp[0]));
+  uint32_t k[2] = { 0, 4 };
+  for (uint32_t i = 0; i < pc.ninj; i++)
+  {
+    const struct pcap_rec *r = &pc.inj[i];
+    CU_ASSERT_FATAL (r->port == 1000 || r->port == 1001);
+    const uint32_t j = k[r->port - 1000]++;
+    CU_ASSERT (r->port == exp[j].port && r->seq == exp[j].seq);
+  }
+  free_pcap (&pc);
+}
+
+CU_Test (ddsc_pcap, ordering)
+{
+  struct ddsi_domaingv *gv;
+  const dds_entity_t dom = create_pcap_domain (65535, 1, 1048576, &gv);
+  // Two threads capture packets with interleaved timestamps, one after the
+  // other. If the writer thread didn't get to them in between, they end up
+  // in a single merge and so must be perfectly interleaved in the file. The
+  // writer thread drains the buffers every 10ms, so it usually works out on
+  // the first attempt; retry a few times with a different pair of ports.
+  const int64_t tbase = ddsrt_time_wallclock ().v;
+  const uint32_t n = 50;
+  uint16_t good_port = 0;
+  for (uint16_t port = 1000; port < 1020 && good_port == 0; port += 2)
+  {
+    struct ddsi_pcap_stats st0, st1;
+    struct inject_arg args[2] = {
+      { .gv = gv, .port = port, .n = n, .size = 100, .tbase = tbase + DDS_USECS (1), .tstep = DDS_USECS (2), .received = false },
+      { .gv = gv, .port = (uint16_t) (port + 1), .n = n, .size = 100, .tbase = tbase, .tstep = DDS_USECS (2), .received = true }
+    };
+    ddsi_pcap_get_stats (gv->pcap, &st0);
+    for (size_t i = 0; i < sizeof (args) / sizeof (args[0]); i++)
+      run_injector (&args[i]);
+    ddsi_pcap_get_stats (gv->pcap, &st1);
+    if (st1.drains == st0.drains)
+      good_port = port;
+  }
+  CU_ASSERT_FATAL (good_port != 0);
+  dds_return_t rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+
+  struct pcap_contents pc;
+  read_pcap (&pc);
+  // per thread, the order is always preserved
+  uint32_t next[20];
+  memset (next, 0, sizeof (next));
+  uint32_t k = 0;
+  for (uint32_t i = 0; i < pc.ninj; i++)
+  {
+    const struct pcap_rec *r = &pc.inj[i];
+    CU_ASSERT_FATAL (r->port >= 1000 && r->port < 1020);
+    CU_ASSERT (r->seq == next[r->port - 1000]++);
+    CU_ASSERT (r->ts == (tbase + (r->port % 2 ? 0 : DDS_USECS (1)) + r->seq * DDS_USECS (2)) / 1000);
+    if (r->port == good_port || r->port == good_port + 1)
+    {
+      // merged: alternating between the two threads, starting with the 2nd
+      CU_ASSERT (r->port == good_port + 1 - (k % 2));
+      CU_ASSERT (r->seq == k / 2);
+      k++;
+    }
+  }
+  CU_ASSERT (k == 2 * n);
+  free_pcap (&pc);
+}
+
+CU_Test (ddsc_pcap, drop_when_full)
+{
+  struct ddsi_domaingv *gv;
+  // 4kB is the minimum buffer size and with this snap length, it holds only
+  // a handful of packets, so it can't possibly keep up with a tight loop
+  const dds_entity_t dom = create_pcap_domain (1000, 1, 4096, &gv);
+  struct ddsi_pcap_stats st0, st1;
+  ddsi_pcap_get_stats (gv->pcap, &st0);
+  struct inject_arg arg = { .gv = gv, .port = 1000, .n = 100000, .size = 2000, .received = false, .stop_on_drop = true };
+  run_injector (&arg);
+  ddsi_pcap_get_stats (gv->pcap, &st1);
+  CU_ASSERT_FATAL (st1.dropped > st0.dropped);
+  CU_ASSERT (arg.n < 100000);
+  dds_return_t rc = dds_delete (dom);
+  CU_ASSERT_FATAL (rc == 0);
+
+  // Packets that were captured end up in the file, in order, those that
+  // didn't fit are counted as dropped. Drops from the domain's own traffic
+  // are not likely but could happen, so that only gives a lower bound.
+  struct pcap_contents pc;
+  read_pcap (&pc);
+  CU_ASSERT (pc.ninj < arg.n);
+  CU_ASSERT (pc.ninj + (st1.dropped - st0.dropped) >= arg.n);
+  uint32_t prevseq = 0;
+  for (uint32_t i = 0; i < pc.ninj; i++)
+  {
+    const struct pcap_rec *r = &pc.inj[i];
+    CU_ASSERT (r->port == 1000);
+    CU_ASSERT (i == 0 || r->seq > prevseq);
+    CU_ASSERT (r->incl_len == 1000 && r->orig_len == IPUDP_HDR_SIZE + 2000);
+    prevseq = r->seq;
+  }
+  free_pcap (&pc);
+}
@@ -1390,6 +1390,183 @@ CU_Test (ddsc_psmx, local_zero_copy)
   dds_delete (dds_get_parent (pp));
 }
 
+CU_Test (ddsc_psmx, write_n)
+{
+  dds_return_t rc;
+  const dds_entity_t pp = create_participant (0);
+  CU_ASSERT_FATAL (pp > 0);
+  char topicname[100];
+  create_unique_topic_name ("write_n", topicname, sizeof (topicname));
+  const dds_entity_t tp = dds_create_topic (pp, &SC_Model_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  for (int psmx_enabled_i = 0; psmx_enabled_i <= 1; psmx_enabled_i++)
+  {
+    const bool psmx_enabled = psmx_enabled_i;
+    dds_qos_t *qos = dds_create_qos ();
+    dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+    if (!psmx_enabled)
+      dds_qset_psmx_instances (qos, 0, NULL);
+    for (int wrloan_i = 0; wrloan_i <= 1; wrloan_i++)
+    {
+      const bool wrloan = wrloan_i;
+      printf ("ddsc_psmx write_n: psmx %d wrloan %d\n", psmx_enabled, wrloan);
+      fflush (stdout);
+
+      const dds_entity_t wr = dds_create_writer (pp, tp, qos, NULL);
+      CU_ASSERT_FATAL (wr > 0);
+      CU_ASSERT_FATAL (endpoint_has_psmx_enabled (wr) == psmx_enabled);
+      const dds_entity_t rd = dds_create_reader (pp, tp, qos, NULL);
+      CU_ASSERT_FATAL (rd > 0);
+      CU_ASSERT_FATAL (endpoint_has_psmx_enabled (rd) == psmx_enabled);
+      sync_reader_writer (pp, rd, pp, wr);
+
+      SC_Model samples[3];
+      const void *wrdata[3];
+      for (uint8_t i = 0; i < 3; i++)
+      {
+        samples[i] = (SC_Model){ i, (uint8_t) (i + 1), (uint8_t) (i + 2) };
+        if (!wrloan)
+          wrdata[i] = &samples[i];
+        else
+        {
+          void *tmp;
+          rc = dds_request_loan (wr, &tmp);
+          CU_ASSERT_FATAL (rc == 0);
+          memcpy (tmp, &samples[i], sizeof (samples[i]));
+          wrdata[i] = tmp;
+        }
+      }
+      rc = dds_write_n (wr, wrdata, 3);
+      CU_ASSERT_FATAL (rc == 3);
+
+      SC_Model rddata[3];
+      int32_t nrd = 0;
+      const dds_time_t tend = dds_time () + DDS_SECS (10);
+      while (nrd < 3 && dds_time () < tend)
+      {
+        void *ptrs[3];
+        dds_sample_info_t si[3];
+        for (int32_t i = 0; i < 3 - nrd; i++)
+          ptrs[i] = &rddata[nrd + i];
+        rc = dds_take (rd, ptrs, si, (size_t) (3 - nrd), (uint32_t) (3 - nrd));
+        CU_ASSERT_FATAL (rc >= 0);
+        nrd += rc;
+        if (nrd < 3)
+          dds_sleepfor (DDS_MSECS (10));
+      }
+      CU_ASSERT_FATAL (nrd == 3);
+      for (int32_t i = 0; i < 3; i++)
+        CU_ASSERT (memcmp (&rddata[i], &samples[i], sizeof (samples[i])) == 0);
+
+      rc = dds_delete (wr);
+      CU_ASSERT_FATAL (rc == 0);
+      rc = dds_delete (rd);
+      CU_ASSERT_FATAL (rc == 0);
+    }
+    dds_delete_qos (qos);
+  }
+  dds_delete (dds_get_parent (pp));
+}
+
+static void heap_loan_free (dds_loaned_sample_t *loaned_sample)
+{
+  dds_free (loaned_sample->metadata);
+  dds_free (loaned_sample->sample_ptr);
+  dds_free (loaned_sample);
+}
+
+static dds_loaned_sample_t *make_heap_loan (const dds_guid_t *wrguid, const SC_Model *sample, dds_time_t timestamp)
+{
+  dds_loaned_sample_t *ls = dds_alloc (sizeof (*ls));
+  ls->ops.free = heap_loan_free;
+  ls->loan_origin.origin_kind = DDS_LOAN_ORIGIN_KIND_HEAP;
+  ls->loan_origin.psmx_endpoint = NULL;
+  ls->metadata = dds_alloc (sizeof (*ls->metadata));
+  memset (ls->metadata, 0, sizeof (*ls->metadata));
+  ls->metadata->sample_state = DDS_LOANED_SAMPLE_STATE_RAW_DATA;
+  ls->metadata->sample_size = sizeof (*sample);
+  ls->metadata->guid = *wrguid;
+  ls->metadata->timestamp = timestamp;
+  ls->metadata->cdr_identifier = DDSI_RTPS_SAMPLE_NATIVE;
+  ls->sample_ptr = dds_alloc (sizeof (*sample));
+  memcpy (ls->sample_ptr, sample, sizeof (*sample));
+  ddsrt_atomic_st32 (&ls->refc, 1);
+  return ls;
+}
+
+CU_Test (ddsc_psmx, store_loaned_samples)
+{
+  // More samples than dds_reader_store_loaned_samples converts in one go, to cover the
+  // chunking as well
+  #define N_LOANS 70
+  dds_return_t rc;
+  const dds_entity_t pp = create_participant (0);
+  CU_ASSERT_FATAL (pp > 0);
+  char topicname[100];
+  create_unique_topic_name ("store_loaned_samples", topicname, sizeof (topicname));
+  const dds_entity_t tp = dds_create_topic (pp, &SC_Model_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  dds_qset_destination_order (qos, DDS_DESTINATIONORDER_BY_SOURCE_TIMESTAMP);
+  const dds_entity_t rd = dds_create_reader (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  dds_qset_psmx_instances (qos, 0, NULL);
+  const dds_entity_t wr = dds_create_writer (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+
+  const dds_guid_t remote_guid = { .v = { 1,2,3,4, 5,6,7,8, 9,10,11,12, 0,0,1,0x02 } };
+  dds_guid_t local_guid;
+  rc = dds_get_guid (wr, &local_guid);
+  CU_ASSERT_FATAL (rc == 0);
+
+  const dds_time_t tbase = dds_time ();
+  dds_loaned_sample_t *loans[N_LOANS];
+  for (uint32_t i = 0; i < N_LOANS; i++)
+    loans[i] = make_heap_loan (&remote_guid, &(SC_Model){ (uint8_t) i, (uint8_t) (i + 1), (uint8_t) (i + 2) }, tbase + i);
+
+  // Not a reader
+  rc = dds_reader_store_loaned_samples (pp, N_LOANS, loans);
+  CU_ASSERT (rc == DDS_RETCODE_ILLEGAL_OPERATION);
+  // Without writer meta-data, the writer must be known to the reader
+  rc = dds_reader_store_loaned_samples (rd, N_LOANS, loans);
+  CU_ASSERT (rc == DDS_RETCODE_NOT_FOUND);
+  // Samples of local writers get delivered by Cyclone itself and must be ignored
+  dds_loaned_sample_t *local_loan = make_heap_loan (&local_guid, &(SC_Model){ 0, 0, 0 }, tbase);
+  rc = dds_reader_store_loaned_samples (rd, 1, &local_loan);
+  CU_ASSERT (rc == 0);
+  dds_loaned_sample_unref (local_loan);
+  void *ptrs[N_LOANS + 1] = { NULL };
+  dds_sample_info_t si[N_LOANS + 1];
+  rc = dds_take (rd, ptrs, si, N_LOANS + 1, N_LOANS + 1);
+  CU_ASSERT_FATAL (rc == 0);
+
+  rc = dds_reader_store_loaned_samples_wr_metadata (rd, N_LOANS, loans, 0, true, DDS_INFINITY);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_take (rd, ptrs, si, N_LOANS + 1, N_LOANS + 1);
+  CU_ASSERT_FATAL (rc == N_LOANS);
+  for (int32_t i = 0; i < rc; i++)
+  {
+    const SC_Model *s = ptrs[i];
+    CU_ASSERT_FATAL (si[i].valid_data);
+    CU_ASSERT (si[i].source_timestamp == tbase + i);
+    CU_ASSERT (si[i].publication_handle == si[0].publication_handle);
+    CU_ASSERT (s->a == (uint8_t) i && s->b == (uint8_t) (i + 1) && s->c == (uint8_t) (i + 2));
+  }
+  rc = dds_return_loan (rd, ptrs, N_LOANS);
+  CU_ASSERT_FATAL (rc == 0);
+
+  // The reader no longer references any of the loans
+  for (uint32_t i = 0; i < N_LOANS; i++)
+  {
+    CU_ASSERT (ddsrt_atomic_ld32 (&loans[i]->refc) == 1);
+    dds_loaned_sample_unref (loans[i]);
+  }
+  dds_delete (dds_get_parent (pp));
+  #undef N_LOANS
+}
+
 static void deepcopy_sample_contents (const dds_topic_descriptor_t *tpdesc, void *output, const void *input)
 {
   struct dds_cdrstream_desc desc;
@@ -359,6 +359,9 @@ static dds_loaned_sample_t * incoming_sample_to_loan (struct cdds_psmx_endpoint
 // FIXME: I think so, this eats a lot of stack, is extremely unlikely to ever occur in general, and more specifically so in our test cases
 #define MAX_TRIGGERS 999
 
+// Maximum number of samples handed to Cyclone in a single dds_reader_store_loaned_samples
+#define DELIVERY_BATCH 8
+
 static uint32_t on_data_available_thread (void *a)
 {
   struct on_data_available_thread_arg *args = (struct on_data_available_thread_arg *) a;
@@ -391,20 +394,22 @@ static uint32_t on_data_available_thread (void *a)
         if (ddsrt_atomic_ld32 (&cpsmx->on_data_thread_state) == ON_DATA_RUNNING)
         {
           assert (cep);
-          dds_sample_info_t si;
+          dds_sample_info_t si[DELIVERY_BATCH];
           dds_return_t n, rc;
-          void *raw = NULL;
-          while ((n = dds_take (cep->psmx_cdds_endpoint, &raw, &si, 1, 1)) == 1)
+          void *raw[DELIVERY_BATCH] = { NULL };
+          while ((n = dds_take (cep->psmx_cdds_endpoint, raw, si, DELIVERY_BATCH, DELIVERY_BATCH)) > 0)
           {
-            if (si.valid_data)
-            {
-              dds_loaned_sample_t *loaned_sample = incoming_sample_to_loan (cep, raw);
-              (void) dds_reader_store_loaned_sample (cep->cdds_endpoint, loaned_sample);
-              dds_loaned_sample_unref (loaned_sample);
-            }
-            rc = dds_return_loan (cep->psmx_cdds_endpoint, &raw, n);
+            dds_loaned_sample_t *loaned_samples[DELIVERY_BATCH];
+            uint32_t nls = 0;
+            for (int32_t i = 0; i < n; i++)
+              if (si[i].valid_data)
+                loaned_samples[nls++] = incoming_sample_to_loan (cep, raw[i]);
+            (void) dds_reader_store_loaned_samples (cep->cdds_endpoint, nls, loaned_samples);
+            for (uint32_t i = 0; i < nls; i++)
+              dds_loaned_sample_unref (loaned_samples[i]);
+            rc = dds_return_loan (cep->psmx_cdds_endpoint, raw, n);
             assert (rc == 0);
-            assert (raw == NULL);
+            assert (raw[0] == NULL);
             (void) rc;
           }
           assert (n == 0);
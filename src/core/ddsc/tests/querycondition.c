@@ -1567,3 +1567,83 @@ CU_Test(ddsc_querycondition_take, some_from_instance, .init=querycondition_init_
     CU_ASSERT_EQUAL_FATAL (ret, DDS_RETCODE_OK);
 }
 /*************************************************************************************************/
+
+/*************************************************************************************************/
+CU_Test(ddsc_querycondition_key, read_take, .init=querycondition_init, .fini=querycondition_fini)
+{
+    dds_entity_t condition, condition_nr;
+    dds_return_t ret;
+    uint32_t seen;
+
+    /* filter_mod2 only looks at long_1, which is the key field */
+    condition = dds_create_key_querycondition(g_reader, DDS_ANY_SAMPLE_STATE | DDS_ANY_VIEW_STATE | DDS_ANY_INSTANCE_STATE, filter_mod2);
+    CU_ASSERT_FATAL(condition > 0);
+    ret = dds_get_mask(condition, &seen);
+    CU_ASSERT_EQUAL_FATAL(ret, DDS_RETCODE_OK);
+    CU_ASSERT_EQUAL_FATAL(seen, DDS_ANY_SAMPLE_STATE | DDS_ANY_VIEW_STATE | DDS_ANY_INSTANCE_STATE);
+    ret = dds_triggered(condition);
+    CU_ASSERT_EQUAL_FATAL(ret, 1);
+
+    /* Instances are visited in an unspecified order, so check the set of keys */
+    ret = dds_read(condition, g_samples, g_info, MAX_SAMPLES, MAX_SAMPLES);
+    CU_ASSERT_EQUAL_FATAL(ret, 4);
+    seen = 0;
+    for (int i = 0; i < ret; i++) {
+        Space_Type1 *sample = (Space_Type1*)g_samples[i];
+        CU_ASSERT_FATAL(sample->long_1 % 2 == 0);
+        CU_ASSERT_EQUAL_FATAL(sample->long_2, sample->long_1/2);
+        CU_ASSERT_EQUAL_FATAL(g_info[i].instance_state, SAMPLE_IST(sample->long_1));
+        seen |= 1u << sample->long_1;
+    }
+    CU_ASSERT_EQUAL_FATAL(seen, 0x55);
+
+    /* All samples were read, so no match for not-read samples */
+    condition_nr = dds_create_key_querycondition(g_reader, DDS_NOT_READ_SAMPLE_STATE, filter_mod2);
+    CU_ASSERT_FATAL(condition_nr > 0);
+    ret = dds_triggered(condition_nr);
+    CU_ASSERT_EQUAL_FATAL(ret, 0);
+    ret = dds_take(condition_nr, g_samples, g_info, MAX_SAMPLES, MAX_SAMPLES);
+    CU_ASSERT_EQUAL_FATAL(ret, 0);
+
+    /* New data for an existing matching instance, a new matching instance and a new
+       non-matching instance */
+    for (int32_t k = 6; k <= 9; k += 2) {
+        ret = dds_write(g_writer, &(Space_Type1){ k, 0, 0 });
+        CU_ASSERT_EQUAL_FATAL(ret, DDS_RETCODE_OK);
+    }
+    ret = dds_write(g_writer, &(Space_Type1){ 9, 0, 0 });
+    CU_ASSERT_EQUAL_FATAL(ret, DDS_RETCODE_OK);
+    ret = dds_triggered(condition_nr);
+    CU_ASSERT_EQUAL_FATAL(ret, 1);
+    ret = dds_take(condition_nr, g_samples, g_info, MAX_SAMPLES, MAX_SAMPLES);
+    CU_ASSERT_EQUAL_FATAL(ret, 2);
+    seen = 0;
+    for (int i = 0; i < ret; i++) {
+        Space_Type1 *sample = (Space_Type1*)g_samples[i];
+        CU_ASSERT_EQUAL_FATAL(sample->long_2, 0);
+        seen |= 1u << sample->long_1;
+    }
+    CU_ASSERT_EQUAL_FATAL(seen, 0x140);
+
+    /* Taking all remaining data for the matching instances drops the ones without writers
+       from the reader, the condition should no longer trigger and the reader still has the
+       data for the other instances */
+    ret = dds_take(condition, g_samples, g_info, MAX_SAMPLES, MAX_SAMPLES);
+    CU_ASSERT_EQUAL_FATAL(ret, 3);
+    ret = dds_triggered(condition);
+    CU_ASSERT_EQUAL_FATAL(ret, 0);
+    ret = dds_triggered(condition_nr);
+    CU_ASSERT_EQUAL_FATAL(ret, 0);
+    ret = dds_read(g_reader, g_samples, g_info, MAX_SAMPLES, MAX_SAMPLES);
+    CU_ASSERT_EQUAL_FATAL(ret, 4);
+    for (int i = 0; i < ret; i++) {
+        Space_Type1 *sample = (Space_Type1*)g_samples[i];
+        CU_ASSERT_FATAL(sample->long_1 % 2 == 1);
+    }
+
+    ret = dds_delete(condition_nr);
+    CU_ASSERT_EQUAL_FATAL(ret, DDS_RETCODE_OK);
+    ret = dds_delete(condition);
+    CU_ASSERT_EQUAL_FATAL(ret, DDS_RETCODE_OK);
+}
+/*************************************************************************************************/
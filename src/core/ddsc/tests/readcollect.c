@@ -175,3 +175,145 @@ CU_Test(ddsc_read_with_collector, take)
 {
   dotest (dds_take_with_collector);
 }
+
+struct two_thread_executor_arg {
+  uint32_t njobs;
+  dds_deserialize_job_fn_t job;
+  void *job_arg;
+  uint32_t first;
+  uint32_t ncalls;
+};
+
+static uint32_t two_thread_executor_thread (void *varg)
+{
+  struct two_thread_executor_arg * const arg = varg;
+  for (uint32_t i = arg->first; i < arg->njobs; i += 2)
+  {
+    arg->job (arg->job_arg, i);
+    arg->ncalls++;
+  }
+  return 0;
+}
+
+static void two_thread_executor (void *executor_arg, uint32_t njobs, dds_deserialize_job_fn_t job, void *job_arg)
+{
+  uint32_t * const ncalls = executor_arg;
+  struct two_thread_executor_arg args[2];
+  ddsrt_thread_t tids[2];
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    args[i] = (struct two_thread_executor_arg){ .njobs = njobs, .job = job, .job_arg = job_arg, .first = i, .ncalls = 0 };
+    dds_return_t rc = ddsrt_thread_create (&tids[i], "deser", &tattr, two_thread_executor_thread, &args[i]);
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    dds_return_t rc = ddsrt_thread_join (tids[i], NULL);
+    CU_ASSERT_FATAL (rc == 0);
+    *ncalls += args[i].ncalls;
+  }
+}
+
+CU_Test(ddsc_read_deferred, basic)
+{
+  const dds_entity_t dp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (dp > 0);
+  char topicname[100];
+  create_unique_topic_name("ddsc_read_deferred", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability(qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t tp = dds_create_topic (dp, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  dds_delete_qos (qos);
+  const dds_entity_t rd = dds_create_reader (dp, tp, NULL, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (dp, tp, NULL, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+
+  dds_return_t rc;
+  for (int32_t k = 0; k < 4; k++)
+  {
+    for (int32_t v = 0; v < 5; v++)
+    {
+      rc = dds_write (wr, &(Space_Type1){ .long_1 = k, .long_2 = v, .long_3 = k * v });
+      CU_ASSERT_FATAL (rc == 0);
+    }
+  }
+  // an invalid sample: only the key may be set, everything else must be zero
+  dds_instance_handle_t ih;
+  rc = dds_register_instance (wr, &ih, &(Space_Type1){ .long_1 = 4 });
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_dispose_ih (wr, ih);
+  CU_ASSERT_FATAL (rc == 0);
+
+  Space_Type1 xs[30];
+  dds_sample_info_t si[30];
+  void *ptrs[30];
+  for (uint32_t i = 0; i < 30; i++)
+  {
+    xs[i] = (Space_Type1){ .long_1 = -1, .long_2 = -1, .long_3 = -1 };
+    ptrs[i] = &xs[i];
+  }
+
+  // no loans and no user-provided memory is not supported
+  void *nullptrs[1] = { NULL };
+  rc = dds_take_deferred (rd, nullptrs, si, 1, 1, 0, NULL, NULL);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_BAD_PARAMETER);
+
+  // read without an executor: the deserialization happens on this thread
+  rc = dds_read_deferred (rd, ptrs, si, 30, 30, DDS_ANY_STATE, NULL, NULL);
+  CU_ASSERT_FATAL (rc == 21);
+  for (int32_t i = 0; i < rc; i++)
+  {
+    CU_ASSERT_FATAL (si[i].sample_state == DDS_NOT_READ_SAMPLE_STATE);
+    CU_ASSERT_FATAL (xs[i].long_3 == xs[i].long_1 * xs[i].long_2);
+  }
+
+  // take using an executor, the number of samples is odd to make things a little bit
+  // more interesting
+  uint32_t ncalls = 0;
+  for (uint32_t i = 0; i < 30; i++)
+    xs[i] = (Space_Type1){ .long_1 = -1, .long_2 = -1, .long_3 = -1 };
+  rc = dds_take_deferred (rd, ptrs, si, 30, 21, DDS_ANY_STATE, two_thread_executor, &ncalls);
+  CU_ASSERT_FATAL (rc == 21);
+  CU_ASSERT_FATAL (ncalls == 21);
+  int ninvalid = 0;
+  for (int32_t i = 0; i < rc; i++)
+  {
+    if (si[i].valid_data)
+    {
+      CU_ASSERT_FATAL (si[i].sample_state == DDS_READ_SAMPLE_STATE);
+      CU_ASSERT_FATAL (xs[i].long_1 >= 0 && xs[i].long_1 < 4);
+      CU_ASSERT_FATAL (xs[i].long_3 == xs[i].long_1 * xs[i].long_2);
+    }
+    else
+    {
+      CU_ASSERT_FATAL (si[i].instance_state == DDS_NOT_ALIVE_DISPOSED_INSTANCE_STATE);
+      CU_ASSERT_FATAL (si[i].sample_state == DDS_READ_SAMPLE_STATE);
+      CU_ASSERT_FATAL (xs[i].long_1 == 4 && xs[i].long_2 == 0 && xs[i].long_3 == 0);
+      ninvalid++;
+    }
+  }
+  CU_ASSERT_FATAL (ninvalid == 1);
+  rc = dds_take (rd, ptrs, si, 30, 30);
+  CU_ASSERT_FATAL (rc == 0);
+
+  // loans can't be used
+  rc = dds_write (wr, &(Space_Type1){ .long_1 = 0, .long_2 = 0, .long_3 = 0 });
+  CU_ASSERT_FATAL (rc == 0);
+  void *loan[1] = { NULL };
+  rc = dds_read (rd, loan, si, 1, 1);
+  CU_ASSERT_FATAL (rc == 1);
+  rc = dds_take_deferred (rd, loan, si, 1, 1, 0, NULL, NULL);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_PRECONDITION_NOT_MET);
+  rc = dds_return_loan (rd, loan, 1);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_take_deferred (rd, ptrs, si, 1, 1, 0, NULL, NULL);
+  CU_ASSERT_FATAL (rc == 1);
+
+  rc = dds_delete (dp);
+  CU_ASSERT_FATAL (rc == 0);
+}
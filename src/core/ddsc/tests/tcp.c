@@ -0,0 +1,386 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CUnit/Theory.h"
+#include "Space.h"
+#include "test_util.h"
+
+#include "dds/dds.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/io.h"
+#include "dds/ddsrt/environ.h"
+#include "dds/ddsrt/random.h"
+#include "dds/ddsrt/sockets.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "ddsi__tcp.h"
+#include "ddsi__tran.h"
+#include "dds__types.h"
+#include "dds__entity.h"
+
+#define TCP_CONFIG \
+  "%s" \
+  "<General>" \
+    "<Interfaces><NetworkInterface address=\"127.0.0.1\"/></Interfaces>" \
+    "<Transport>tcp</Transport>" \
+  "</General>" \
+  "<TCP><Port>%"PRIu32"</Port><ReadBufferSize>%s</ReadBufferSize><SendQueueSize>%s</SendQueueSize>%s</TCP>" \
+  "<Discovery>" \
+    "<ExternalDomainId>0</ExternalDomainId>" \
+    "<Tag>${CYCLONEDDS_PID}</Tag>" \
+    "%s" \
+  "</Discovery>"
+
+static dds_entity_t create_tcp_domain (dds_domainid_t domid, const char *extra, const char *rbufsize, const char *sendqsize, const char *tcp_extra, const char *peers, uint32_t *port)
+{
+  // The TCP listener needs a fixed port number, try a few random ones in case the
+  // first happens to be in use already
+  dds_entity_t dom = -1;
+  for (int i = 0; i < 10 && dom < 0; i++)
+  {
+    char *conf_raw, *conf;
+    *port = 20000 + ddsrt_random () % 20000;
+    (void) ddsrt_asprintf (&conf_raw, TCP_CONFIG, extra, *port, rbufsize, sendqsize, tcp_extra, peers);
+    conf = ddsrt_expand_envvars (conf_raw, domid);
+    dom = dds_create_domain (domid, conf);
+    ddsrt_free (conf);
+    ddsrt_free (conf_raw);
+  }
+  CU_ASSERT_FATAL (dom > 0);
+  return dom;
+}
+
+static void do_tcp_test (const char *rbufsize, const char *sendqsize)
+{
+  // The reader's domain accepts the connection, so all messages from the writer end up
+  // being read from the accepted connection using the configured read buffer size.
+  uint32_t port_rd, port_wr;
+  const dds_entity_t dom_rd = create_tcp_domain (0, "", rbufsize, sendqsize, "", "", &port_rd);
+  char peers[100];
+  (void) snprintf (peers, sizeof (peers), "<Peers><Peer address=\"127.0.0.1:%"PRIu32"\"/></Peers>", port_rd);
+  const dds_entity_t dom_wr = create_tcp_domain (1, "", rbufsize, sendqsize, "", peers, &port_wr);
+
+  const dds_entity_t pp_rd = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp_rd > 0);
+  const dds_entity_t pp_wr = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_wr > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_tcp", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t tp_rd = dds_create_topic (pp_rd, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_rd > 0);
+  const dds_entity_t tp_wr = dds_create_topic (pp_wr, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_wr > 0);
+  const dds_entity_t rd = dds_create_reader (pp_rd, tp_rd, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp_wr, tp_wr, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+  sync_reader_writer (pp_rd, rd, pp_wr, wr);
+
+  // Lots of small messages in quick succession, so that typically several are present in
+  // the socket receive buffer when the receive thread reads from it
+  const int32_t nsamples = 1000;
+  dds_return_t rc;
+  for (int32_t i = 0; i < nsamples; i++)
+  {
+    rc = dds_write (wr, &(Space_Type1){ 0, i, 0 });
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  rc = dds_wait_for_acks (wr, DDS_SECS (10));
+  CU_ASSERT_FATAL (rc == 0);
+
+  // All samples having been acknowledged doesn't mean they have all been stored in
+  // the reader history cache yet, so wait for them to arrive
+  const dds_entity_t ws = dds_create_waitset (pp_rd);
+  CU_ASSERT_FATAL (ws > 0);
+  const dds_entity_t rdcond = dds_create_readcondition (rd, DDS_ANY_STATE);
+  CU_ASSERT_FATAL (rdcond > 0);
+  rc = dds_waitset_attach (ws, rdcond, 0);
+  CU_ASSERT_FATAL (rc == 0);
+  const dds_time_t tend = dds_time () + DDS_SECS (10);
+  int32_t next = 0;
+  while (next < nsamples)
+  {
+    Space_Type1 sample;
+    void *raw = &sample;
+    dds_sample_info_t si;
+    rc = dds_take (rd, &raw, &si, 1, 1);
+    CU_ASSERT_FATAL (rc == 0 || rc == 1);
+    if (rc == 0)
+    {
+      rc = dds_waitset_wait_until (ws, NULL, 0, tend);
+      CU_ASSERT_FATAL (rc > 0);
+      continue;
+    }
+    CU_ASSERT_FATAL (si.valid_data);
+    CU_ASSERT_FATAL (sample.long_2 == next);
+    next++;
+  }
+
+  rc = dds_delete (dom_wr);
+  CU_ASSERT_FATAL (rc == 0);
+  rc = dds_delete (dom_rd);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+CU_TheoryDataPoints (ddsc_tcp, read_buffer) = {
+  CU_DataPoints (const char *, "0 B", "16 B", "100 B", "64 kB"),
+};
+
+CU_Theory ((const char *rbufsize), ddsc_tcp, read_buffer, .timeout = 30)
+{
+  do_tcp_test (rbufsize, "0 B");
+}
+
+CU_TheoryDataPoints (ddsc_tcp, send_queue) = {
+  CU_DataPoints (const char *, "1 B", "1 kB", "1 MB"),
+};
+
+CU_Theory ((const char *sendqsize), ddsc_tcp, send_queue, .timeout = 30)
+{
+  // Reliable data is never dropped, even if the queue is tiny: the writer must then
+  // block until the sender thread has made room
+  do_tcp_test ("64 kB", sendqsize);
+}
+
+#define STALLED_MSGSIZE 4096
+
+struct stalled_peer {
+  ddsrt_socket_t listener;
+  uint32_t port;
+  uint32_t nmsgs; // number of messages to read once it starts reading
+  bool ok;
+};
+
+static void stalled_peer_init (struct stalled_peer *peer)
+{
+  // The peer never accepts the connection before it starts reading, so the data ends
+  // up in the kernel's buffers of the accept queue; a small receive buffer (inherited
+  // by the accepted socket) keeps the amount of data needed to fill it up reasonable
+  struct sockaddr_in addr;
+  socklen_t addrlen = sizeof (addr);
+  const int rcvbuf = 4096;
+  memset (&addr, 0, sizeof (addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  CU_ASSERT_FATAL (ddsrt_socket (&peer->listener, AF_INET, SOCK_STREAM, 0) == DDS_RETCODE_OK);
+  CU_ASSERT_FATAL (ddsrt_setsockopt (peer->listener, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof (rcvbuf)) == DDS_RETCODE_OK);
+  CU_ASSERT_FATAL (ddsrt_bind (peer->listener, (struct sockaddr *) &addr, sizeof (addr)) == DDS_RETCODE_OK);
+  CU_ASSERT_FATAL (ddsrt_listen (peer->listener, 1) == DDS_RETCODE_OK);
+  CU_ASSERT_FATAL (ddsrt_getsockname (peer->listener, (struct sockaddr *) &addr, &addrlen) == DDS_RETCODE_OK);
+  peer->port = ntohs (addr.sin_port);
+  peer->nmsgs = 0;
+  peer->ok = false;
+}
+
+static uint32_t stalled_peer_reader (void *varg)
+{
+  // Start reading only after the writer has had plenty of time to fill the queue
+  struct stalled_peer * const peer = varg;
+  ddsrt_socket_t sock;
+  unsigned char buf[65536];
+  size_t pos = 0;
+  const size_t total = peer->nmsgs * (size_t) STALLED_MSGSIZE;
+  dds_sleepfor (DDS_MSECS (500));
+  if (ddsrt_accept (peer->listener, NULL, NULL, &sock) != DDS_RETCODE_OK)
+    return 0;
+  peer->ok = true;
+  while (pos < total && peer->ok)
+  {
+    ssize_t n;
+    if (ddsrt_recv (sock, buf, sizeof (buf), 0, &n) != DDS_RETCODE_OK || n <= 0)
+      peer->ok = false;
+    else
+    {
+      // Every byte of message i is (unsigned char) i, so this verifies nothing was lost
+      // or reordered
+      for (size_t k = 0; k < (size_t) n && peer->ok; k++)
+        if (buf[k] != (unsigned char) ((pos + k) / STALLED_MSGSIZE))
+          peer->ok = false;
+      pos += (size_t) n;
+    }
+  }
+  (void) ddsrt_close (sock);
+  return 0;
+}
+
+static bool stalled_peer_write (struct ddsi_domaingv *gv, const struct stalled_peer *peer, uint32_t i, uint32_t flags)
+{
+  unsigned char buf[STALLED_MSGSIZE];
+  ddsi_locator_t loc;
+  memset (&loc, 0, sizeof (loc));
+  loc.kind = DDSI_LOCATOR_KIND_TCPv4;
+  loc.port = peer->port;
+  loc.address[12] = 127; loc.address[15] = 1;
+  memset (buf, (unsigned char) i, sizeof (buf));
+  DDSI_DECL_CONST_TRAN_WRITE_MSGFRAGS_PTR (msgfrags, ((ddsrt_iovec_t){ .iov_base = buf, .iov_len = sizeof (buf) }));
+  return ddsi_conn_write (gv->xmit_conns[0], &loc, msgfrags, flags) == (ssize_t) sizeof (buf);
+}
+
+static struct ddsi_tcp_sendq_stats stalled_peer_stats (struct ddsi_domaingv *gv, const struct stalled_peer *peer)
+{
+  struct ddsi_tcp_sendq_stats *stats, res;
+  const size_t n = ddsi_tcp_get_sendq_stats (gv->m_factory, &stats);
+  size_t i;
+  for (i = 0; i < n; i++)
+    if (stats[i].peer.port == peer->port)
+      break;
+  CU_ASSERT_FATAL (i < n);
+  res = stats[i];
+  ddsrt_free (stats);
+  return res;
+}
+
+CU_TheoryDataPoints (ddsc_tcp, send_queue_stalled) = {
+  CU_DataPoints (bool, true, false),
+};
+
+CU_Theory ((bool best_effort), ddsc_tcp, send_queue_stalled, .timeout = 60)
+{
+  // A peer that doesn't read: best-effort messages must be dropped once the queue is
+  // full, other messages must wait until the peer starts reading again and then all
+  // arrive in order
+  const size_t sendqsize = 16384;
+  const char *policies =
+    "<SendQueueBestEffortPolicy>drop</SendQueueBestEffortPolicy>"
+    "<SendQueueReliablePolicy>block</SendQueueReliablePolicy>"
+    "<WriteTimeout>10 s</WriteTimeout>";
+  struct stalled_peer peer;
+  stalled_peer_init (&peer);
+  uint32_t port;
+  const dds_entity_t dom = create_tcp_domain (0, "", "64 kB", "16 kB", policies, "", &port);
+  dds_entity *x;
+  CU_ASSERT_FATAL (dds_entity_pin (dom, &x) == 0);
+  struct ddsi_domaingv * const gv = &((struct dds_domain *) x)->gv;
+
+  struct ddsi_tcp_sendq_stats stats;
+  if (best_effort)
+  {
+    // Write until the first message gets dropped: loopback buffers are large and
+    // auto-tuned, so there is no telling how many messages fit in advance
+    uint32_t i = 0;
+    do {
+      CU_ASSERT_FATAL (stalled_peer_write (gv, &peer, i, DDSI_TRAN_BEST_EFFORT));
+      stats = stalled_peer_stats (gv, &peer);
+    } while (stats.dropped == 0 && ++i < 100000);
+    CU_ASSERT_FATAL (stats.dropped == 1);
+    // With the peer still not reading, each subsequent message must be dropped, too,
+    // without ever blocking the writer or exceeding the queue size
+    for (uint32_t j = 0; j < 10; j++)
+      CU_ASSERT_FATAL (stalled_peer_write (gv, &peer, i + j, DDSI_TRAN_BEST_EFFORT));
+    stats = stalled_peer_stats (gv, &peer);
+    CU_ASSERT (stats.dropped == 11);
+    CU_ASSERT (stats.blocked == 0);
+    CU_ASSERT (stats.queued > sendqsize - STALLED_MSGSIZE && stats.queued <= sendqsize);
+    CU_ASSERT (stats.queued_max <= sendqsize);
+  }
+  else
+  {
+    // Write more than fits in the socket buffers and the queue combined, so that the
+    // writer has to wait for the peer to start reading
+    ddsrt_threadattr_t tattr;
+    ddsrt_thread_t tid;
+    ddsrt_threadattr_init (&tattr);
+    peer.nmsgs = 16384;
+    CU_ASSERT_FATAL (ddsrt_thread_create (&tid, "stalled_peer", &tattr, stalled_peer_reader, &peer) == DDS_RETCODE_OK);
+    for (uint32_t i = 0; i < peer.nmsgs; i++)
+      CU_ASSERT_FATAL (stalled_peer_write (gv, &peer, i, 0));
+    stats = stalled_peer_stats (gv, &peer);
+    CU_ASSERT_FATAL (ddsrt_thread_join (tid, NULL) == DDS_RETCODE_OK);
+    CU_ASSERT (peer.ok);
+    CU_ASSERT (stats.dropped == 0);
+    CU_ASSERT (stats.blocked > 0);
+    CU_ASSERT (stats.queued_max > sendqsize - STALLED_MSGSIZE && stats.queued_max <= sendqsize);
+  }
+
+  dds_entity_unpin (x);
+  CU_ASSERT_FATAL (dds_delete (dom) == 0);
+  (void) ddsrt_close (peer.listener);
+}
+
+static ddsrt_atomic_uint32_t conns_created, conns_freed, conns_warnings;
+
+static void count_tcp_conns (void *ptr, const dds_log_data_t *data)
+{
+  (void) ptr;
+  const char *msg = data->message;
+  if (strncmp (msg, "tcp cache added ", 16) == 0 || strncmp (msg, "tcp cache updated ", 18) == 0)
+    ddsrt_atomic_inc32 (&conns_created);
+  else if (strncmp (msg, "tcp free ", 9) == 0)
+    ddsrt_atomic_inc32 (&conns_freed);
+  else if (strstr (msg, "references at de-initialization") != NULL)
+    ddsrt_atomic_inc32 (&conns_warnings);
+}
+
+CU_TheoryDataPoints (ddsc_tcp, teardown_live) = {
+  CU_DataPoints (bool, false, true),
+};
+
+CU_Theory ((bool delete_reader_first), ddsc_tcp, teardown_live, .timeout = 30)
+{
+  // Deleting the domains while the connections are still in use, every connection
+  // ever created must be freed, whether it is held by the cache, a receive thread
+  // or both (and in the second domain, also after the peer went away)
+  ddsrt_atomic_st32 (&conns_created, 0);
+  ddsrt_atomic_st32 (&conns_freed, 0);
+  ddsrt_atomic_st32 (&conns_warnings, 0);
+  dds_set_log_mask (DDS_LC_FATAL | DDS_LC_ERROR | DDS_LC_WARNING | DDS_LC_TCP);
+  dds_set_log_sink (count_tcp_conns, NULL);
+  dds_set_trace_sink (count_tcp_conns, NULL);
+
+  const char *tracing = "<Tracing><Category>tcp</Category><OutputFile>stderr</OutputFile></Tracing>";
+  uint32_t port_rd, port_wr;
+  const dds_entity_t dom_rd = create_tcp_domain (0, tracing, "64 kB", "64 kB", "", "", &port_rd);
+  char peers[100];
+  (void) snprintf (peers, sizeof (peers), "<Peers><Peer address=\"127.0.0.1:%"PRIu32"\"/></Peers>", port_rd);
+  const dds_entity_t dom_wr = create_tcp_domain (1, tracing, "64 kB", "64 kB", "", peers, &port_wr);
+
+  const dds_entity_t pp_rd = dds_create_participant (0, NULL, NULL);
+  CU_ASSERT_FATAL (pp_rd > 0);
+  const dds_entity_t pp_wr = dds_create_participant (1, NULL, NULL);
+  CU_ASSERT_FATAL (pp_wr > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_tcp", topicname, sizeof (topicname));
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_reliability (qos, DDS_RELIABILITY_RELIABLE, DDS_INFINITY);
+  const dds_entity_t tp_rd = dds_create_topic (pp_rd, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_rd > 0);
+  const dds_entity_t tp_wr = dds_create_topic (pp_wr, &Space_Type1_desc, topicname, qos, NULL);
+  CU_ASSERT_FATAL (tp_wr > 0);
+  const dds_entity_t rd = dds_create_reader (pp_rd, tp_rd, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp_wr, tp_wr, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+  sync_reader_writer (pp_rd, rd, pp_wr, wr);
+
+  // Keep data flowing up to the moment the first domain is deleted
+  for (int32_t i = 0; i < 100; i++)
+  {
+    dds_return_t rc = dds_write (wr, &(Space_Type1){ 0, i, 0 });
+    CU_ASSERT_FATAL (rc == 0);
+  }
+  CU_ASSERT_FATAL (dds_delete (delete_reader_first ? dom_rd : dom_wr) == 0);
+  CU_ASSERT_FATAL (dds_delete (delete_reader_first ? dom_wr : dom_rd) == 0);
+
+  dds_set_log_sink (NULL, NULL);
+  dds_set_trace_sink (NULL, NULL);
+  CU_ASSERT (ddsrt_atomic_ld32 (&conns_created) > 0);
+  CU_ASSERT (ddsrt_atomic_ld32 (&conns_freed) == ddsrt_atomic_ld32 (&conns_created));
+  CU_ASSERT (ddsrt_atomic_ld32 (&conns_warnings) == 0);
+}
@@ -113,6 +113,7 @@ CU_Test (ddsc_uninitialized, various)
   };
   check (dds_set_topic_filter_and_arg (1, filter_arg_fn, NULL));
   check (dds_set_topic_filter_extended (1, &filter));
+  check (dds_set_topic_filter_predicates (1, 0, NULL));
 
   check (dds_get_topic_filter_and_arg (1, NULL, NULL));
   check (dds_get_topic_filter_extended (1, &filter));
@@ -147,9 +148,15 @@ CU_Test (ddsc_uninitialized, various)
   check (dds_writecdr (1, &serdata));
   check (dds_forwardcdr (1, &serdata));
   check (dds_write_ts (1, &data, 1));
+  const void *pdatas[] = { &data };
+  check (dds_write_n (1, pdatas, 1));
+  check (dds_write_n_ts (1, pdatas, 1, 1));
+  struct ddsi_serdata *pserdatas[] = { &serdata };
+  check (dds_writecdr_n (1, pserdatas, 1));
 
   check (dds_create_readcondition (1, DDS_ANY_STATE));
   check (dds_create_querycondition (1, DDS_ANY_STATE, filter_fn));
+  check (dds_create_key_querycondition (1, DDS_ANY_STATE, filter_fn));
 
   check (dds_set_guardcondition (1, true));
   bool triggered;
@@ -162,6 +169,8 @@ CU_Test (ddsc_uninitialized, various)
   check (dds_waitset_set_trigger (1, true));
   check (dds_waitset_wait (1, NULL, 0, 0));
   check (dds_waitset_wait_until (1, NULL, 0, DDS_NEVER));
+  int fd;
+  check (dds_waitset_get_fd (1, &fd));
 
   void *raw = NULL;
   dds_sample_info_t si;
@@ -190,6 +199,9 @@ CU_Test (ddsc_uninitialized, various)
   check (dds_readcdr_instance (1, &pserdata, 1, &si, 1, DDS_ANY_STATE));
   check (dds_takecdr (1, &pserdata, 1, &si, DDS_ANY_STATE));
   check (dds_takecdr_instance (1, &pserdata, 1, &si, 1, DDS_ANY_STATE));
+  void *pdata = &data;
+  check (dds_read_deferred (1, &pdata, &si, 1, 1, DDS_ANY_STATE, NULL, NULL));
+  check (dds_take_deferred (1, &pdata, &si, 1, 1, DDS_ANY_STATE, NULL, NULL));
 
   check (dds_return_loan (1, &raw, 1));
   check_ih (dds_lookup_instance (1, &data));
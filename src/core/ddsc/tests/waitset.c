@@ -10,6 +10,9 @@
 
 #include <assert.h>
 #include <limits.h>
+#ifndef _WIN32
+#include <poll.h>
+#endif
 
 #include "dds/dds.h"
 #include "dds/ddsrt/cdtors.h"
@@ -418,6 +421,114 @@ CU_Test(ddsc_waitset_attach_detach, combinations, .init=ddsc_waitset_init, .fini
   }
 }
 
+CU_Test(ddsc_waitset_triggered, many_attached, .init=ddsc_waitset_basic_init, .fini=ddsc_waitset_basic_fini)
+{
+  // Only the triggered attachments are to be returned, also after triggers
+  // come and go and with attachments being detached in between
+  enum { N = 1000 };
+  static dds_entity_t gcs[N];
+  dds_attach_t xs[N];
+  dds_return_t ret;
+  for (int i = 0; i < N; i++)
+  {
+    gcs[i] = dds_create_guardcondition (participant);
+    CU_ASSERT_FATAL (gcs[i] > 0);
+    ret = dds_waitset_attach (waitset, gcs[i], i);
+    CU_ASSERT_FATAL (ret == 0);
+  }
+  ret = dds_waitset_wait (waitset, xs, N, 0);
+  CU_ASSERT_FATAL (ret == 0);
+  for (int i = 0; i < N; i += 100)
+  {
+    ret = dds_set_guardcondition (gcs[i], true);
+    CU_ASSERT_FATAL (ret == 0);
+  }
+  ret = dds_waitset_wait (waitset, xs, N, DDS_SECS (1));
+  CU_ASSERT_FATAL (ret == N / 100);
+  for (int i = 0; i < ret; i++)
+    CU_ASSERT (xs[i] % 100 == 0 && xs[i] < N);
+
+  // detach a triggered and an untriggered one, reset half of the triggered ones
+  ret = dds_waitset_detach (waitset, gcs[0]);
+  CU_ASSERT_FATAL (ret == 0);
+  ret = dds_waitset_detach (waitset, gcs[1]);
+  CU_ASSERT_FATAL (ret == 0);
+  for (int i = 100; i < N; i += 200)
+  {
+    ret = dds_set_guardcondition (gcs[i], false);
+    CU_ASSERT_FATAL (ret == 0);
+  }
+  ret = dds_waitset_wait (waitset, xs, N, 0);
+  CU_ASSERT_FATAL (ret == N / 200 - 1);
+  for (int i = 0; i < ret; i++)
+    CU_ASSERT (xs[i] % 200 == 0 && xs[i] > 0 && xs[i] < N);
+  ret = dds_waitset_get_entities (waitset, NULL, 0);
+  CU_ASSERT_FATAL (ret == N - 2);
+}
+
+#ifndef _WIN32
+static bool fd_readable (int fd)
+{
+  struct pollfd pfd = { .fd = fd, .events = POLLIN };
+  int n = poll (&pfd, 1, 0);
+  CU_ASSERT_FATAL (n >= 0);
+  return n > 0 && (pfd.revents & POLLIN);
+}
+
+CU_Test(ddsc_waitset_triggered, fd, .init=ddsc_waitset_basic_init, .fini=ddsc_waitset_basic_fini)
+{
+  dds_attach_t xs[2];
+  dds_return_t ret;
+  int fd, fd1;
+  ret = dds_waitset_get_fd (waitset, NULL);
+  CU_ASSERT_FATAL (ret == DDS_RETCODE_BAD_PARAMETER);
+  ret = dds_waitset_get_fd (participant, &fd);
+  CU_ASSERT_FATAL (ret == DDS_RETCODE_ILLEGAL_OPERATION);
+
+  // a guard condition that is already triggered when the fd gets created
+  dds_entity_t gc1 = dds_create_guardcondition (participant);
+  CU_ASSERT_FATAL (gc1 > 0);
+  dds_entity_t gc2 = dds_create_guardcondition (participant);
+  CU_ASSERT_FATAL (gc2 > 0);
+  ret = dds_set_guardcondition (gc1, true);
+  CU_ASSERT_FATAL (ret == 0);
+  ret = dds_waitset_attach (waitset, gc1, 1);
+  CU_ASSERT_FATAL (ret == 0);
+  ret = dds_waitset_attach (waitset, gc2, 2);
+  CU_ASSERT_FATAL (ret == 0);
+  ret = dds_waitset_get_fd (waitset, &fd);
+  CU_ASSERT_FATAL (ret == 0);
+  ret = dds_waitset_get_fd (waitset, &fd1);
+  CU_ASSERT_FATAL (ret == 0 && fd1 == fd);
+  CU_ASSERT (fd_readable (fd));
+
+  // it stays readable as long as something is triggered
+  ret = dds_waitset_wait (waitset, xs, 2, 0);
+  CU_ASSERT_FATAL (ret == 1 && xs[0] == 1);
+  CU_ASSERT (fd_readable (fd));
+
+  // reset after finding that nothing triggers anymore
+  bool triggered;
+  ret = dds_take_guardcondition (gc1, &triggered);
+  CU_ASSERT_FATAL (ret == 0 && triggered);
+  ret = dds_waitset_wait (waitset, xs, 2, 0);
+  CU_ASSERT_FATAL (ret == 0);
+  CU_ASSERT (!fd_readable (fd));
+
+  // becomes readable again on the next trigger
+  ret = dds_set_guardcondition (gc2, true);
+  CU_ASSERT_FATAL (ret == 0);
+  CU_ASSERT (fd_readable (fd));
+  ret = dds_waitset_wait (waitset, xs, 2, 0);
+  CU_ASSERT_FATAL (ret == 1 && xs[0] == 2);
+
+  // detaching the only triggered entity also resets it
+  ret = dds_waitset_detach (waitset, gc2);
+  CU_ASSERT_FATAL (ret == 0);
+  CU_ASSERT (!fd_readable (fd));
+}
+#endif
+
 CU_Test(ddsc_waitset_delete_attached, self, .init=ddsc_waitset_basic_init, .fini=ddsc_waitset_basic_fini)
 {
   dds_return_t ret;
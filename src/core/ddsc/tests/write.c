@@ -17,6 +17,7 @@
 #include "test_util.h"
 
 #include "dds/dds.h"
+#include "dds/ddsi/ddsi_serdata.h"
 #include "dds/ddsrt/io.h"
 #include "dds/ddsrt/misc.h"
 #include "dds/ddsrt/heap.h"
@@ -132,6 +133,132 @@ CU_Test(ddsc_write_ts, bad_timestamp, .init = setup, .fini = teardown)
     CU_ASSERT_EQUAL_FATAL(status, DDS_RETCODE_BAD_PARAMETER);
 }
 
+CU_Test(ddsc_write_n, bad_param, .init = setup, .fini = teardown)
+{
+    const void *samples[] = { &data, NULL };
+    dds_return_t status;
+
+    status = dds_write_n(writer, NULL, 1);
+    CU_ASSERT_EQUAL_FATAL(status, DDS_RETCODE_BAD_PARAMETER);
+    status = dds_write_n(writer, samples, 0);
+    CU_ASSERT_EQUAL_FATAL(status, DDS_RETCODE_BAD_PARAMETER);
+    status = dds_write_n(writer, samples, 2);
+    CU_ASSERT_EQUAL_FATAL(status, DDS_RETCODE_BAD_PARAMETER);
+    status = dds_write_n(publisher, samples, 1);
+    CU_ASSERT_EQUAL_FATAL(status, DDS_RETCODE_ILLEGAL_OPERATION);
+    status = dds_write_n_ts(writer, samples, 1, -1);
+    CU_ASSERT_EQUAL_FATAL(status, DDS_RETCODE_BAD_PARAMETER);
+    status = dds_writecdr_n(writer, NULL, 1);
+    CU_ASSERT_EQUAL_FATAL(status, DDS_RETCODE_BAD_PARAMETER);
+}
+
+CU_Test(ddsc_write_n, basic)
+{
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_write_n", topicname, sizeof (topicname));
+  const dds_entity_t tp = dds_create_topic (pp, &Space_Type1_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  dds_qos_t *qos = dds_create_qos ();
+  dds_qset_history (qos, DDS_HISTORY_KEEP_ALL, 0);
+  const dds_entity_t rd = dds_create_reader (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (rd > 0);
+  const dds_entity_t wr = dds_create_writer (pp, tp, qos, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+  dds_delete_qos (qos);
+
+  // plain samples, two instances interleaved, all get the same timestamp
+  Space_Type1 samples[6];
+  const void *ptrs[6];
+  for (int32_t i = 0; i < 6; i++)
+  {
+    samples[i] = (Space_Type1){ i % 2, i, 0 };
+    ptrs[i] = &samples[i];
+  }
+  dds_return_t rc = dds_write_n_ts (wr, ptrs, 4, DDS_SECS (1));
+  CU_ASSERT_FATAL (rc == 4);
+
+  // serialized samples
+  const struct ddsi_sertype *st;
+  rc = dds_get_entity_sertype (wr, &st);
+  CU_ASSERT_FATAL (rc == 0);
+  struct ddsi_serdata *sds[2];
+  for (int32_t i = 0; i < 2; i++)
+  {
+    sds[i] = ddsi_serdata_from_sample (st, SDK_DATA, &samples[4 + i]);
+    CU_ASSERT_FATAL (sds[i] != NULL);
+  }
+  rc = dds_writecdr_n (wr, sds, 2);
+  CU_ASSERT_FATAL (rc == 2);
+
+  Space_Type1 rdsamples[8];
+  void *rdptrs[8];
+  dds_sample_info_t si[8];
+  for (int32_t i = 0; i < 8; i++)
+    rdptrs[i] = &rdsamples[i];
+  for (int32_t k = 0; k < 2; k++)
+  {
+    // local delivery is synchronous, and history is per instance
+    rc = dds_take_instance (rd, rdptrs, si, 8, 8, dds_lookup_instance (rd, &samples[k]));
+    CU_ASSERT_FATAL (rc == 3);
+    for (int32_t i = 0; i < 3; i++)
+    {
+      CU_ASSERT (rdsamples[i].long_1 == k);
+      CU_ASSERT (rdsamples[i].long_2 == k + 2 * i);
+      if (i < 2)
+        CU_ASSERT (si[i].source_timestamp == DDS_SECS (1));
+    }
+  }
+
+  rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
+static bool accept_all (const void *sample, void *arg)
+{
+  (void) sample; (void) arg;
+  return true;
+}
+
+CU_Test(ddsc_write_n, filtered_topic)
+{
+  // writing serialized data with a filter on the topic is not supported, the
+  // references must still be consumed
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  CU_ASSERT_FATAL (pp > 0);
+  char topicname[100];
+  create_unique_topic_name ("ddsc_write_n", topicname, sizeof (topicname));
+  const dds_entity_t tp = dds_create_topic (pp, &Space_Type1_desc, topicname, NULL, NULL);
+  CU_ASSERT_FATAL (tp > 0);
+  dds_return_t rc = dds_set_topic_filter_and_arg (tp, accept_all, NULL);
+  CU_ASSERT_FATAL (rc == 0);
+  const dds_entity_t wr = dds_create_writer (pp, tp, NULL, NULL);
+  CU_ASSERT_FATAL (wr > 0);
+
+  const struct ddsi_sertype *st;
+  rc = dds_get_entity_sertype (wr, &st);
+  CU_ASSERT_FATAL (rc == 0);
+  Space_Type1 samples[2] = { { 0, 0, 0 }, { 1, 0, 0 } };
+  struct ddsi_serdata *sds[2];
+  for (int32_t i = 0; i < 2; i++)
+  {
+    sds[i] = ddsi_serdata_from_sample (st, SDK_DATA, &samples[i]);
+    CU_ASSERT_FATAL (sds[i] != NULL);
+    (void) ddsi_serdata_ref (sds[i]);
+  }
+  rc = dds_writecdr_n (wr, sds, 2);
+  CU_ASSERT (rc == DDS_RETCODE_ERROR);
+  for (int32_t i = 0; i < 2; i++)
+  {
+    CU_ASSERT (ddsrt_atomic_ld32 (&sds[i]->refc) == 1);
+    ddsi_serdata_unref (sds[i]);
+  }
+
+  rc = dds_delete (pp);
+  CU_ASSERT_FATAL (rc == 0);
+}
+
 CU_Test(ddsc_write, simpletypes)
 {
     dds_return_t status;
@@ -48,7 +48,11 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
 #endif /* DDS_HAS_TOPIC_DISCOVERY */
   cfg->lease_duration = INT64_C (10000000000);
   cfg->tracefile = "cyclonedds.log";
+  cfg->tracing_binary_buffer_size = UINT32_C (1048576);
   cfg->pcap_file = "";
+  cfg->pcap_snaplen = UINT32_C (65535);
+  cfg->pcap_sample_interval = UINT32_C (1);
+  cfg->pcap_buffer_size = UINT32_C (1048576);
   cfg->delivery_queue_maxsamples = UINT32_C (256);
   cfg->primary_reorder_maxsamples = UINT32_C (128);
   cfg->secondary_reorder_maxsamples = UINT32_C (128);
@@ -79,6 +83,10 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
   cfg->monitor_port = INT32_C (-1);
   cfg->prioritize_retransmit = INT32_C (1);
   cfg->recv_thread_stop_maxretries = UINT32_C (4294967295);
+#ifdef DDS_HAS_SECURITY
+#endif /* DDS_HAS_SECURITY */
+  cfg->emu_loss_burst = UINT32_C (1);
+  cfg->emu_reorder_delay = INT64_C (1000000);
   cfg->whc_lowwater_mark = UINT32_C (1024);
   cfg->whc_highwater_mark = UINT32_C (512000);
   cfg->whc_init_highwater_mark.isdefault = 0;
@@ -91,6 +99,8 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
   cfg->tcp_nodelay = INT32_C (1);
   cfg->tcp_port = INT32_C (-1);
   cfg->tcp_read_timeout = INT64_C (2000000000);
+  cfg->tcp_read_buffer_size = UINT32_C (65536);
+  cfg->tcp_sendq_policy_reliable = INT32_C (1);
   cfg->tcp_write_timeout = INT64_C (2000000000);
 #ifdef DDS_HAS_TCP_TLS
   cfg->ssl_verify = INT32_C (1);
@@ -103,14 +113,14 @@ void ddsi_config_init_default (struct ddsi_config *cfg)
   cfg->ssl_min_version.minor = 3;
 #endif /* DDS_HAS_TCP_TLS */
 }
-/* generated from ddsi_config.h[d7db98ce697e409412ec7fb0b900e10261a66c44] */
-/* generated from ddsi_config.c[184d7299baad5acc9b96884de77770aac009a11a] */
-/* generated from ddsi__cfgelems.h[741151ccf40cab43638e8c32cac3a4b9c3e73566] */
+/* generated from ddsi_config.h[5663372d0339cfefff6fe3a53ce30a635d028a01] */
+/* generated from ddsi_config.c[614686eb12f17704f640f63c38540407230cb85b] */
+/* generated from ddsi__cfgelems.h[a2788a0b018c593d8bd689946176695c04b5c29e] */
 /* generated from cfgunits.h[05f093223fce107d24dd157ebaafa351dc9df752] */
-/* generated from _confgen.h[fd29634526c05c3237dbc3f785030fe022eb7875] */
+/* generated from _confgen.h[2b6028203e76ff24c134bcde0b90afac58a09ed6] */
 /* generated from _confgen.c[0d833a6f2c98902f1249e63aed03a6164f0791d6] */
 /* generated from generate_rnc.c[b50e4b7ab1d04b2bc1d361a0811247c337b74934] */
 /* generated from generate_md.c[789b92e422631684352909cfb8bf43f6ceb16a01] */
 /* generated from generate_rst.c[3c4b523fbb57c8e4a7e247379d06a8021ccc21c4] */
 /* generated from generate_xsd.c[9bb91084fff7495aee9c025db3108549a0141957] */
-/* generated from generate_defconfig.c[ba599ccf70b6f1929c08a597a6c555ff2375e458] */
+/* generated from generate_defconfig.c[bc0b57f247378f0676b526c2902c06c4803fe9b9] */
@@ -27,6 +27,7 @@ extern "C" {
 #endif
 
 struct ddsi_config;
+struct ddsrt_bintrace;
 
 enum ddsi_standards_conformance {
   DDSI_SC_PEDANTIC,
@@ -48,6 +49,16 @@ enum ddsi_retransmit_merging {
   DDSI_REXMIT_MERGE_ALWAYS
 };
 
+enum ddsi_tcp_sendq_policy {
+  DDSI_TCP_SENDQ_DROP,
+  DDSI_TCP_SENDQ_BLOCK
+};
+
+enum ddsi_trace_format {
+  DDSI_TRACE_FORMAT_TEXT,
+  DDSI_TRACE_FORMAT_BINARY
+};
+
 enum ddsi_boolean_default {
   DDSI_BOOLDEF_DEFAULT,
   DDSI_BOOLDEF_FALSE,
@@ -166,6 +177,7 @@ enum ddsi_transport_selector {
   DDSI_TRANS_TCP,
   DDSI_TRANS_TCP6,
   DDSI_TRANS_RAWETH,
+  DDSI_TRANS_EMU,
   DDSI_TRANS_NONE /* FIXME: see FIXME above ... :( */
 };
 
@@ -275,6 +287,9 @@ struct ddsi_config
   uint32_t tracemask;
   uint32_t enabled_xchecks;
   char *pcap_file;
+  uint32_t pcap_snaplen;
+  uint32_t pcap_sample_interval;
+  uint32_t pcap_buffer_size;
 
   /* interfaces */
   struct ddsi_config_network_interface_listelem *network_interfaces;
@@ -290,8 +305,11 @@ struct ddsi_config
   char *externalAddressString;
   char *externalMaskString;
   FILE *tracefp;
+  struct ddsrt_bintrace *tracebt;
   char *tracefile;
   int tracingAppendToFile;
+  enum ddsi_trace_format tracing_format;
+  uint32_t tracing_binary_buffer_size;
   enum ddsi_transport_selector transport_selector;
   enum ddsi_boolean_default compat_use_ipv6;
   enum ddsi_boolean_default compat_tcp_enable;
@@ -319,15 +337,21 @@ struct ddsi_config
   int liveliness_monitoring;
   int noprogress_log_stacktraces;
   int64_t liveliness_monitoring_interval;
+  uint32_t thread_cpu_warning_threshold;
   int prioritize_retransmit;
   enum ddsi_boolean_default multiple_recv_threads;
   unsigned recv_thread_stop_maxretries;
+#ifdef DDS_HAS_SECURITY
+  unsigned secure_recv_threads;
+#endif
 
   unsigned primary_reorder_maxsamples;
   unsigned secondary_reorder_maxsamples;
 
   unsigned delivery_queue_maxsamples;
 
+  unsigned listener_threads;
+
   uint16_t fragment_size;
   uint32_t max_msg_size;
   uint32_t max_rexmit_msg_size;
@@ -346,6 +370,10 @@ struct ddsi_config
   int tcp_nodelay;
   int tcp_port;
   int64_t tcp_read_timeout;
+  uint32_t tcp_read_buffer_size;
+  uint32_t tcp_sendq_size;
+  enum ddsi_tcp_sendq_policy tcp_sendq_policy_best_effort;
+  enum ddsi_tcp_sendq_policy tcp_sendq_policy_reliable;
   int64_t tcp_write_timeout;
   int tcp_use_peeraddr_for_unicast;
 
@@ -374,10 +402,19 @@ struct ddsi_config
 
   /* debug/test/undoc features: */
   int xmit_lossiness;           /**<< fraction of packets to drop on xmit, in units of 1e-3 */
+  uint32_t emu_seed;            /**<< seed for the emulated network's random number generator */
+  uint32_t emu_loss;            /**<< emulated network: average packet loss, in units of 1e-3 */
+  uint32_t emu_loss_burst;      /**<< emulated network: average length of a burst of lost packets */
+  int64_t emu_latency;          /**<< emulated network: one-way latency */
+  int64_t emu_jitter;           /**<< emulated network: maximum additional random delay */
+  uint32_t emu_reorder;         /**<< emulated network: fraction of packets to delay extra, in units of 1e-3 */
+  int64_t emu_reorder_delay;    /**<< emulated network: additional delay for those packets */
+  uint32_t emu_bandwidth;       /**<< emulated network: outgoing bandwidth in bytes/s, 0 is unlimited */
   uint32_t rmsg_chunk_size;          /**<< size of a chunk in the receive buffer */
   uint32_t rbuf_size;                /* << size of a single receiver buffer */
   enum ddsi_besmode besmode;
   int meas_hb_to_ack_latency;
+  int stage_latency_statistics;
   int synchronous_delivery_priority_threshold;
   int64_t synchronous_delivery_latency_bound;
 
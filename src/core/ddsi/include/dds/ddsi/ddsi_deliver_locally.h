@@ -53,6 +53,19 @@ struct ddsi_deliver_locally_ops {
 /** @component local_delivery */
 dds_return_t ddsi_deliver_locally_allinsync (struct ddsi_domaingv *gv, struct ddsi_entity_common *source_entity, bool source_entity_locked, struct ddsi_local_reader_ary *fastpath_rdary, const struct ddsi_writer_info *wrinfo, const struct ddsi_deliver_locally_ops *ops, void *vsourceinfo);
 
+/** @brief Deserialized sample of the payload being delivered locally
+ * @component local_delivery
+ *
+ * All readers receiving the same payload in a local delivery can share a
+ * single deserialized copy, e.g., for evaluating content filters. It is
+ * created on the first call and freed when the delivery no longer needs the
+ * payload.
+ *
+ * @param[in] payload  payload passed to the reader history cache
+ * @param[out] valid   whether the payload could be deserialized
+ * @returns the sample, or NULL if the calling thread is not delivering data */
+const void *ddsi_deliver_locally_sample (const struct ddsi_serdata *payload, bool *valid);
+
 #if defined (__cplusplus)
 }
 #endif
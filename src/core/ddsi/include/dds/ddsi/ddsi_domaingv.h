@@ -50,6 +50,9 @@ struct dds_security_context;
 struct dds_security_match_index;
 struct ddsi_hsadmin;
 struct spdp_admin;
+struct ddsi_secrecv;
+struct ddsi_lathist;
+struct ddsi_pcap;
 
 struct ddsi_config_in_addr_node {
    ddsi_locator_t loc;
@@ -213,6 +216,14 @@ struct ddsi_domaingv {
     struct ddsi_recv_thread_arg arg;
   } recv_threads[MAX_RECV_THREADS];
 
+#ifdef DDS_HAS_SECURITY
+  /* Optional pool of worker threads for decoding and processing RTPS
+     messages that are protected at the message level, NULL if disabled.
+     Like the receive buffer pools of the receive threads, it needs to be
+     freed way later than the worker threads terminate. */
+  struct ddsi_secrecv *secrecv;
+#endif
+
   /* Listener thread for connection based transports */
   struct ddsi_thread_state *listen_ts;
 
@@ -293,9 +304,18 @@ struct ddsi_domaingv {
   bool sendq_running;
   ddsrt_mutex_t sendq_running_lock;
 
-  /* File for dumping captured packets, NULL if disabled */
-  FILE *pcap_fp;
-  ddsrt_mutex_t pcap_lock;
+  /* Packet capture, NULL if disabled */
+  struct ddsi_pcap *pcap;
+
+  /* Latency histograms for the domain-wide stages of the data path, all
+     NULL unless Internal/StageLatencyStatistics is set: time messages wait
+     in an xpack before it gets sent, time spent sending a packet, time
+     spent processing a received packet and time samples wait in a delivery
+     queue */
+  struct ddsi_lathist *lathist_xpack;
+  struct ddsi_lathist *lathist_send;
+  struct ddsi_lathist *lathist_recv;
+  struct ddsi_lathist *lathist_dqueue;
 
   struct ddsi_builtin_topic_interface *builtin_topic_interface;
 
@@ -30,6 +30,7 @@ struct ddsi_entity_common;
 struct ddsi_endpoint_common;
 struct ddsi_ldur_fhnode;
 struct ddsi_entity_index;
+struct ddsi_lathist;
 struct dds_qos;
 
 /* Liveliness changed is more complicated than just add/remove. Encode the event
@@ -66,6 +67,8 @@ enum ddsi_writer_state {
 
 typedef ddsrt_atomic_uint64_t seq_xmit_t;
 
+struct ddsi_content_filter_property;
+
 struct ddsi_writer
 {
   struct ddsi_entity_common e;
@@ -111,6 +114,7 @@ struct ddsi_writer
   uint32_t num_readers; /* total number of matching PROXY readers */
   uint32_t num_reliable_readers; /* number of matching reliable PROXY readers */
   uint32_t num_readers_requesting_keyhash; /* also +1 for protected keys and config override for generating keyhash */
+  uint32_t num_readers_content_filtered; /* number of matching PROXY readers with a content filter this writer can evaluate */
   ddsrt_avl_tree_t readers; /* all matching PROXY readers, see struct ddsi_wr_prd_match */
   ddsrt_avl_tree_t local_readers; /* all matching LOCAL readers, see struct ddsi_wr_rd_match */
 #ifdef DDS_HAS_NETWORK_PARTITIONS
@@ -125,6 +129,10 @@ struct ddsi_writer
   uint64_t rexmit_bytes; /* cum bytes queued for retransmit */
   uint64_t time_throttled; /* cum time in throttled state */
   uint64_t time_retransmit; /* cum time in retransmitting state */
+  uint64_t filtered_count; /* cum samples not sent because all matching PROXY readers filter them out */
+  ddsi_seqno_t filtered_gap_start; /* filtered samples [start,end) for which no GAP has been sent yet, start = end if none */
+  ddsi_seqno_t filtered_gap_end;
+  struct ddsi_lathist *lathist_whc; /* time spent inserting samples in WHC, NULL unless enabled */
   struct ddsi_xeventq *evq; /* timed event queue to be used by this writer */
   struct ddsi_local_reader_ary rdary; /* LOCAL readers for fast-pathing; if not fast-pathed, fall back to scanning local_readers */
   struct ddsi_lease *lease; /* for liveliness administration (writer can only become inactive when using manual liveliness) */
@@ -157,6 +165,7 @@ struct ddsi_reader
   struct ddsi_networkpartition_address *mc_as;
 #endif
   const struct ddsi_sertype * type; /* type of the data read by this reader */
+  struct ddsi_content_filter_property *content_filter; /* content filter advertised in discovery, or NULL */
   uint32_t num_writers; /* total number of matching PROXY writers */
   ddsrt_avl_tree_t writers; /* all matching PROXY writers, see struct ddsi_rd_pwr_match */
   ddsrt_avl_tree_t local_writers; /* all matching LOCAL writers, see struct ddsi_rd_wr_match */
@@ -222,12 +231,30 @@ struct ddsi_reader *ddsi_writer_next_in_sync_reader (struct ddsi_entity_index *e
 /** @component ddsi_endpoint */
 dds_return_t ddsi_generate_reader_guid (struct ddsi_guid *rdguid, struct ddsi_participant *participant, const struct ddsi_sertype *sertype);
 
-/** @component ddsi_endpoint */
-dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_guid *guid, const struct ddsi_guid *group_guid, struct ddsi_participant *pp, const char *topic_name, const struct ddsi_sertype *type, const struct dds_qos *xqos, struct ddsi_rhc *rhc, ddsi_status_cb_t status_cb, void * status_entity, struct ddsi_psmx_locators_set *psmx_locators);
+/**
+ * @brief Creates a reader
+ * @component ddsi_endpoint
+ *
+ * The content filter (copied, NULL for none) is included in the first discovery message
+ * for the reader, see also @ref ddsi_update_reader_content_filter.
+ */
+dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_guid *guid, const struct ddsi_guid *group_guid, struct ddsi_participant *pp, const char *topic_name, const struct ddsi_sertype *type, const struct dds_qos *xqos, const struct ddsi_content_filter_property *content_filter, struct ddsi_rhc *rhc, ddsi_status_cb_t status_cb, void * status_entity, struct ddsi_psmx_locators_set *psmx_locators);
 
 /** @component ddsi_endpoint */
 void ddsi_update_reader_qos (struct ddsi_reader *rd, const struct dds_qos *xqos);
 
+/**
+ * @brief Sets the content filter a reader advertises in discovery
+ * @component ddsi_endpoint
+ *
+ * Remote writers that understand the filter may use it to avoid sending data that the
+ * reader would discard anyway.  The reader must still filter the data it receives.
+ *
+ * @param[in] rd  reader
+ * @param[in] content_filter  filter to advertise (copied), or NULL for none
+ */
+void ddsi_update_reader_content_filter (struct ddsi_reader *rd, const struct ddsi_content_filter_property *content_filter);
+
 /** @component ddsi_endpoint */
 dds_return_t ddsi_delete_reader (struct ddsi_domaingv *gv, const struct ddsi_guid *guid);
 
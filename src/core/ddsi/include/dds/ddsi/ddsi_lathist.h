@@ -0,0 +1,90 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI_LATHIST_H
+#define DDSI_LATHIST_H
+
+#include <stdint.h>
+
+#include "dds/export.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/time.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/* Latency histogram in the style of an HDR histogram: values (in ns) below
+   2^SUBBITS are counted exactly, every power of two above that is split in
+   2^SUBBITS equally sized buckets, so that the relative error in reported
+   percentiles is at most 2^-SUBBITS.  Anything over 2^MAXEXP ns (~18 minutes)
+   ends up in the last bucket.  Updates are lock-free and may come from any
+   thread. */
+#define DDSI_LATHIST_SUBBITS 4
+#define DDSI_LATHIST_MAXEXP 40
+#define DDSI_LATHIST_NBUCKETS ((DDSI_LATHIST_MAXEXP - DDSI_LATHIST_SUBBITS + 1) << DDSI_LATHIST_SUBBITS)
+
+struct ddsi_lathist {
+  ddsrt_atomic_uint32_t bucket[DDSI_LATHIST_NBUCKETS];
+};
+
+struct ddsi_lathist_summary {
+  uint64_t count;
+  uint64_t p50, p90, p99, max; /* in ns */
+};
+
+/** @component latency_stats */
+DDS_EXPORT struct ddsi_lathist *ddsi_lathist_new (void);
+
+/** @component latency_stats */
+DDS_EXPORT void ddsi_lathist_free (struct ddsi_lathist *h);
+
+/** @component latency_stats */
+DDS_EXPORT void ddsi_lathist_record (struct ddsi_lathist *h, int64_t dt);
+
+/** @brief Records n samples of latency dt
+ * @component latency_stats */
+DDS_EXPORT void ddsi_lathist_record_n (struct ddsi_lathist *h, int64_t dt, uint32_t n);
+
+/** @component latency_stats */
+DDS_EXPORT void ddsi_lathist_summarize (const struct ddsi_lathist *h, struct ddsi_lathist_summary *s);
+
+/** @brief Returns the highest value (in ns) counted in bucket idx
+ * @component latency_stats
+ *
+ * The bucket boundaries are the same for every histogram, so histograms
+ * (also those from different processes) can be merged by adding the counts.
+ */
+DDS_EXPORT uint64_t ddsi_lathist_bucket_upper_bound (uint32_t idx);
+
+/** @brief Records the time elapsed since t0 if h is non-null
+ * @component latency_stats
+ *
+ * Intended for use in combination with @ref ddsi_lathist_start, so that
+ * there is no measurable cost when the histogram hasn't been allocated.
+ */
+DDS_INLINE_EXPORT inline void ddsi_lathist_record_since (struct ddsi_lathist *h, ddsrt_mtime_t t0)
+{
+  if (h)
+    ddsi_lathist_record (h, ddsrt_time_monotonic ().v - t0.v);
+}
+
+/** @brief Returns the current time if h is non-null, 0 otherwise
+ * @component latency_stats */
+DDS_INLINE_EXPORT inline ddsrt_mtime_t ddsi_lathist_start (const struct ddsi_lathist *h)
+{
+  return h ? ddsrt_time_monotonic () : (ddsrt_mtime_t) { 0 };
+}
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI_LATHIST_H */
@@ -93,6 +93,16 @@ typedef struct ddsi_reader_favours_ssm {
 #endif /* DDSRT_HAVE_SSM */
 
 
+/* Content filter advertised by a reader (DDSI 9.6.3.1), the filter expression
+   and parameters are only meaningful for the given filter class */
+typedef struct ddsi_content_filter_property {
+  char *content_filtered_topic_name;
+  char *related_topic_name;
+  char *filter_class_name;
+  char *filter_expression;
+  ddsi_stringseq_t expression_parameters;
+} ddsi_content_filter_property_t;
+
 typedef struct ddsi_adlink_participant_version_info
 {
   uint32_t version;
@@ -119,7 +129,7 @@ typedef struct ddsi_plist {
   unsigned char expects_inline_qos;
   ddsi_count_t participant_manual_liveliness_count;
   uint32_t participant_builtin_endpoints;
-  /* ddsi_content_filter_property_t content_filter_property; */
+  ddsi_content_filter_property_t content_filter_property;
   ddsi_guid_t participant_guid;
   ddsi_guid_t endpoint_guid;
   ddsi_guid_t group_guid;
@@ -176,6 +186,33 @@ DDS_EXPORT void ddsi_plist_init_empty (ddsi_plist_t *dest);
  */
 DDS_EXPORT void ddsi_plist_fini (ddsi_plist_t *ps);
 
+/**
+ * @brief Deep copy of a content filter property
+ * @component parameter_list
+ *
+ * @param[in] src  content filter property to copy
+ * @returns newly allocated copy, to be freed with `ddsi_content_filter_property_free`
+ */
+struct ddsi_content_filter_property *ddsi_content_filter_property_dup (const struct ddsi_content_filter_property *src);
+
+/**
+ * @brief Free a heap-allocated content filter property, e.g., one returned by `ddsi_content_filter_property_dup`
+ * @component parameter_list
+ *
+ * @param[in] cfp  content filter property to free, may be NULL
+ */
+void ddsi_content_filter_property_free (struct ddsi_content_filter_property *cfp);
+
+/**
+ * @brief Compare two content filter properties, either of which may be NULL
+ * @component parameter_list
+ *
+ * @param[in] a  content filter property
+ * @param[in] b  content filter property
+ * @returns true iff both are NULL or both are non-NULL and equal
+ */
+bool ddsi_content_filter_property_equal (const struct ddsi_content_filter_property *a, const struct ddsi_content_filter_property *b);
+
 #if defined (__cplusplus)
 }
 #endif
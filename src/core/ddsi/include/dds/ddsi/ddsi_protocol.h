@@ -36,6 +36,7 @@ extern "C" {
 #define DDSI_LOCATOR_KIND_TCPv6 8
 #define DDSI_LOCATOR_KIND_PSMX 16
 #define DDSI_LOCATOR_KIND_RAWETH 0x02000000
+#define DDSI_LOCATOR_KIND_EMU 0x02000001
 #define DDSI_LOCATOR_KIND_UDPv4MCGEN 0x4fff0000
 #define DDSI_LOCATOR_PORT_INVALID 0
 
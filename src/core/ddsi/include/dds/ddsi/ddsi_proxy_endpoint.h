@@ -84,6 +84,8 @@ struct ddsi_proxy_writer {
 };
 
 
+struct ddsi_content_filter_property;
+
 typedef int (*ddsi_filter_fn_t)(struct ddsi_writer *wr, struct ddsi_proxy_reader *prd, struct ddsi_serdata *serdata);
 
 struct ddsi_proxy_reader {
@@ -100,6 +102,7 @@ struct ddsi_proxy_reader {
   ddsrt_avl_tree_t writers; /* matching LOCAL writers */
   uint32_t receive_buffer_size; /* assumed receive buffer size inherited from proxypp */
   ddsi_filter_fn_t filter;
+  struct ddsi_content_filter_property *content_filter; /* content filter advertised by the reader, or NULL */
 };
 
 
@@ -47,12 +47,21 @@ typedef void (*ddsi_rhc_unregister_wr_t) (struct ddsi_rhc *rhc, const struct dds
 typedef void (*ddsi_rhc_relinquish_ownership_t) (struct ddsi_rhc *rhc, const uint64_t wr_iid);
 typedef void (*ddsi_rhc_set_qos_t) (struct ddsi_rhc *rhc, const struct dds_qos *qos);
 
+struct ddsi_rhc_stats {
+  uint32_t n_instances;       /**< number of instances, including empty ones */
+  uint32_t n_samples;         /**< number of samples, including invalid ones */
+  uint32_t n_read;            /**< number of samples that have been read */
+};
+
+typedef void (*ddsi_rhc_get_stats_t) (struct ddsi_rhc *rhc, struct ddsi_rhc_stats *stats);
+
 struct ddsi_rhc_ops {
   ddsi_rhc_store_t store;
   ddsi_rhc_unregister_wr_t unregister_wr;
   ddsi_rhc_relinquish_ownership_t relinquish_ownership;
   ddsi_rhc_set_qos_t set_qos;
   ddsi_rhc_free_t free;
+  ddsi_rhc_get_stats_t get_stats; /**< may be null, used for monitoring only */
 };
 
 struct ddsi_rhc {
@@ -132,15 +132,34 @@ typedef ddsi_typeinfo_t * (*ddsi_sertype_typeinfo_t) (const struct ddsi_sertype
    serdata_ops for the provided data representation */
 typedef struct ddsi_sertype * (*ddsi_sertype_derive_t) (const struct ddsi_sertype *sertype, dds_data_representation_id_t data_representation, dds_type_consistency_enforcement_qospolicy_t tce_qos);
 
+/* Content filter advertised by a remote reader, prepared for evaluating it on
+   serialized samples of this type prior to transmitting them */
+struct ddsi_content_filter_property;
+struct ddsi_sertype_content_filter {
+  bool (*accept) (const struct ddsi_sertype_content_filter *filter, const struct ddsi_serdata *serdata);
+  void (*free) (struct ddsi_sertype_content_filter *filter);
+};
+
+/* Returns NULL if the filter class or expression is not supported for this type; the
+   filter is guaranteed to be in terms of this type (not merely an assignable one) */
+typedef struct ddsi_sertype_content_filter * (*ddsi_sertype_content_filter_new_t) (const struct ddsi_sertype *tp, const struct ddsi_content_filter_property *cfp);
+
 struct ddsi_sertype_v0;
 typedef void (*ddsi_sertype_v0_t) (struct ddsi_sertype_v0 *dummy);
 
+/* Version 1 of the operations adds "content_filter_new", which does not exist in
+   (and may therefore not be read from) operations tables of version 0 */
+
 // Because Windows ... just can't get its act together ...
 #ifndef _WIN32
 /** @component typesupport_if */
 DDS_EXPORT void ddsi_sertype_v0 (struct ddsi_sertype_v0 *dummy);
+
+/** @component typesupport_if */
+DDS_EXPORT void ddsi_sertype_v1 (struct ddsi_sertype_v0 *dummy);
 #else
 #define ddsi_sertype_v0 ((ddsi_sertype_v0_t) 1)
+#define ddsi_sertype_v1 ((ddsi_sertype_v0_t) 2)
 #endif
 
 struct ddsi_sertype_ops {
@@ -159,6 +178,9 @@ struct ddsi_sertype_ops {
   ddsi_sertype_derive_t derive_sertype;
   ddsi_sertype_get_serialized_size_t get_serialized_size;
   ddsi_sertype_serialize_into_t serialize_into;
+
+  // Version 1 and later
+  ddsi_sertype_content_filter_new_t content_filter_new;
 };
 
 /** @component typesupport_if */
@@ -293,6 +315,13 @@ DDS_INLINE_EXPORT inline bool ddsi_sertype_serialize_into(const struct ddsi_sert
   return tp->ops->serialize_into(tp, sdkind, sample, dst_buffer, dst_size);
 }
 
+/** @component typesupport_if */
+DDS_INLINE_EXPORT inline struct ddsi_sertype_content_filter *ddsi_sertype_content_filter_new (const struct ddsi_sertype *tp, const struct ddsi_content_filter_property *cfp) {
+  if (tp->ops->version == ddsi_sertype_v0 || !tp->ops->content_filter_new)
+    return NULL;
+  return tp->ops->content_filter_new (tp, cfp);
+}
+
 #if defined (__cplusplus)
 }
 #endif
@@ -19,13 +19,17 @@ extern "C" {
 
 struct ddsi_reader;
 struct ddsi_writer;
+struct ddsi_domaingv;
 
 /** @component ddsi_statistics */
-void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit);
+void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit, uint64_t *filtered_count);
 
 /** @component ddsi_statistics */
 void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes);
 
+/** @component ddsi_statistics */
+void ddsi_get_secrecv_stats (const struct ddsi_domaingv *gv, uint64_t *packets, uint64_t *bytes, uint64_t *time_queued, uint64_t *time_process, uint32_t *queue_length_max);
+
 #if defined (__cplusplus)
 }
 #endif
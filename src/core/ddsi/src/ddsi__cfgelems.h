@@ -311,8 +311,10 @@ static struct cfgelem general_cfgelems[] = {
     FUNCTIONS(0, uf_transport_selector, 0, pf_transport_selector),
     DESCRIPTION(
       "<p>This element allows selecting the transport to be used (udp, udp6, "
-      "tcp, tcp6, raweth)</p>"),
-    VALUES("default","udp","udp6","tcp","tcp6","raweth")),
+      "tcp, tcp6, raweth, emu). The \"emu\" transport is an in-process "
+      "emulated network connecting all domains in the process that use it, "
+      "see Internal/Test/NetworkEmulation.</p>"),
+    VALUES("default","udp","udp6","tcp","tcp6","raweth","emu")),
   BOOL("EnableMulticastLoopback", NULL, 1, "true",
     MEMBER(enableMulticastLoopback),
     FUNCTIONS(0, uf_boolean, 0, pf_boolean),
@@ -880,6 +882,8 @@ static struct cfgelem thread_properties_cfgattrs[] = {
       "general timed-event handling, retransmits and discovery;</li>\n"
       "<li><i>fsm</i>: "
       "finite state machine thread for handling security handshake;</li>\n"
+      "<li><i>listen</i>: "
+      "listener invocation threads, see Internal/ListenerThreads;</li>\n"
       "<li><i>xmit.CHAN</i>: "
       "transmit thread for channel CHAN;</li>\n"
       "<li><i>dq.CHAN</i>: "
@@ -985,6 +989,70 @@ static struct cfgelem compatibility_cfgelems[] = {
   END_MARKER
 };
 
+static struct cfgelem internal_test_emu_cfgelems[] = {
+  INT("Seed", NULL, 1, "0",
+    MEMBER(emu_seed),
+    FUNCTIONS(0, uf_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This element sets the seed of the random number generators used "
+      "for emulating the network. Each domain has one for each thread "
+      "sending packets, initialized from the seed, the order in which the "
+      "domain was created and the name of the thread. For a given thread, "
+      "the seed determines which of its packets get dropped and delayed.</p>"
+    )),
+  INT("Loss", NULL, 1, "0",
+    MEMBER(emu_loss),
+    FUNCTIONS(0, uf_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This element sets the average fraction of outgoing packets that get "
+      "lost, specified as packets per thousand.</p>"
+    )),
+  INT("LossBurstLength", NULL, 1, "1",
+    MEMBER(emu_loss_burst),
+    FUNCTIONS(0, uf_pos_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This element sets the average number of consecutive packets lost "
+      "once a loss occurs. The value 1 means losses are independent.</p>"
+    )),
+  STRING("Latency", NULL, 1, "0 s",
+    MEMBER(emu_latency),
+    FUNCTIONS(0, uf_duration_us_1s, 0, pf_duration),
+    DESCRIPTION(
+      "<p>This element sets the one-way latency of outgoing packets.</p>"),
+    UNIT("duration")),
+  STRING("Jitter", NULL, 1, "0 s",
+    MEMBER(emu_jitter),
+    FUNCTIONS(0, uf_duration_us_1s, 0, pf_duration),
+    DESCRIPTION(
+      "<p>This element sets the maximum of the uniformly distributed random "
+      "delay added to the latency. Jitter can cause packets to be "
+      "reordered.</p>"),
+    UNIT("duration")),
+  INT("Reordering", NULL, 1, "0",
+    MEMBER(emu_reorder),
+    FUNCTIONS(0, uf_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This element sets the fraction of outgoing packets that get delayed "
+      "by an additional ReorderDelay, specified as packets per thousand.</p>"
+    )),
+  STRING("ReorderDelay", NULL, 1, "1 ms",
+    MEMBER(emu_reorder_delay),
+    FUNCTIONS(0, uf_duration_us_1s, 0, pf_duration),
+    DESCRIPTION(
+      "<p>This element sets the additional delay of packets selected for "
+      "reordering.</p>"),
+    UNIT("duration")),
+  STRING("Bandwidth", NULL, 1, "0 B",
+    MEMBER(emu_bandwidth),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This element sets the outgoing bandwidth of the emulated network "
+      "interface in bytes per second, 0 meaning unlimited. Packets are "
+      "dropped when more than a second worth of data is queued.</p>"),
+    UNIT("memsize")),
+  END_MARKER
+};
+
 static struct cfgelem internal_test_cfgelems[] = {
   INT("XmitLossiness", NULL, 1, "0",
     MEMBER(xmit_lossiness),
@@ -993,6 +1061,16 @@ static struct cfgelem internal_test_cfgelems[] = {
       "<p>This element controls the fraction of outgoing packets to drop, "
       "specified as samples per thousand.</p>"
     )),
+  GROUP("NetworkEmulation", internal_test_emu_cfgelems, NULL, 1,
+    NOMEMBER,
+    NOFUNCTIONS,
+    DESCRIPTION(
+      "<p>Settings for the emulated network used when General/Transport is "
+      "set to \"emu\". All domains in a process using this transport are "
+      "connected via the emulated network, and the settings here determine "
+      "how the packets sent by this domain are treated. Loss and delay "
+      "decisions are made by a pseudo-random number generator, so that runs "
+      "are reproducible.</p>")),
   END_MARKER
 };
 
@@ -1150,6 +1228,17 @@ static struct cfgelem liveliness_monitoring_attrs[] = {
       "threads have been making progress.</p>"),
     UNIT("duration"),
     RANGE("100ms;1hr")),
+  INT("CpuWarningThreshold", NULL, 1, "0",
+    MEMBER(thread_cpu_warning_threshold),
+    FUNCTIONS(0, uf_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This element sets the CPU utilization (in percent of a single "
+      "core, averaged over about a second) above which a warning is logged "
+      "for a thread in the process. 0 disables the warning.</p>\n"
+      "<p>With liveliness monitoring enabled, the per-thread CPU "
+      "utilization, the delay in handling timed events and the delivery "
+      "queue depths are also logged once per second under the "
+      "<code>timing</code> trace category.</p>")),
   END_MARKER
 };
 
@@ -1211,6 +1300,31 @@ static struct cfgelem sock_sndbuf_size_attrs[] = {
   END_MARKER
 };
 
+static struct cfgelem pcap_attrs[] = {
+  INT("SnapLength", NULL, 1, "65535",
+    MEMBER(pcap_snaplen),
+    FUNCTIONS(0, uf_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This sets the maximum number of bytes captured of each packet, "
+      "including the (fictitious) 28 bytes of IP and UDP headers.</p>")),
+  INT("SampleInterval", NULL, 1, "1",
+    MEMBER(pcap_sample_interval),
+    FUNCTIONS(0, uf_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This sets the fraction of packets captured: every thread "
+      "captures one packet out of each group of this many packets it sends "
+      "or receives. 0 and 1 both mean all packets are captured.</p>")),
+  STRING("BufferSize", NULL, 1, "1 MiB",
+    MEMBER(pcap_buffer_size),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This sets the size of the buffer of each thread for captured "
+      "packets. Packets are dropped from the capture when it is full, "
+      "which is reported in the log.</p>"),
+    UNIT("memsize")),
+  END_MARKER
+};
+
 static struct cfgelem internal_cfgelems[] = {
   MOVED("MaxMessageSize", "CycloneDDS/Domain/General/MaxMessageSize"),
   MOVED("FragmentSize", "CycloneDDS/Domain/General/FragmentSize"),
@@ -1222,6 +1336,21 @@ static struct cfgelem internal_cfgelems[] = {
       "expressed in samples. Once a delivery queue is full, incoming samples "
       "destined for that queue are dropped until space becomes available "
       "again.</p>")),
+  INT("ListenerThreads", NULL, 1, "0",
+    MEMBER(listener_threads),
+    FUNCTIONS(0, uf_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This element sets the number of threads used for invoking "
+      "listeners. With the default of 0, listeners are invoked on the thread "
+      "that causes the status change, which may be a thread that also handles "
+      "protocol messages for other readers and writers. With one or more "
+      "threads, status changes for readers and writers with a listener are "
+      "queued to these threads instead. Listener invocations for an entity "
+      "remain serialized, and events that occur while one is queued are "
+      "combined with it, so that, e.g., many samples arriving in quick "
+      "succession result in a single data available listener call.</p>\n"
+      "<p>The status is set when the event occurs, so waitsets and "
+      "dds_read_status may observe it before the listener is invoked.</p>")),
   INT("PrimaryReorderMaxSamples", NULL, 1, "128",
     MEMBER(primary_reorder_maxsamples),
     FUNCTIONS(0, uf_uint, 0, pf_uint),
@@ -1276,6 +1405,17 @@ static struct cfgelem internal_cfgelems[] = {
       "and calculating round trip times. This is non-standard behaviour. The "
       "measured latencies are quite noisy and are currently not used "
       "anywhere.</p>")),
+  BOOL("StageLatencyStatistics", NULL, 1, "false",
+    MEMBER(stage_latency_statistics),
+    FUNCTIONS(0, uf_boolean, 0, pf_boolean),
+    DESCRIPTION(
+      "<p>This element enables collecting histograms of the time spent in "
+      "the various stages of the data path: serialization and WHC insertion "
+      "for writers; packing, sending, receiving and queueing for delivery "
+      "for the domain; and storing, listener invocation and time until taken "
+      "for readers. The histograms are available as percentiles through the "
+      "statistics interface of writers, readers and the domain. Enabling "
+      "this adds a few clock reads to every sample written and received.</p>")),
   INT("SynchronousDeliveryPriorityThreshold", NULL, 1, "0",
     MEMBER(synchronous_delivery_priority_threshold),
     FUNCTIONS(0, uf_int, 0, pf_int),
@@ -1517,7 +1657,11 @@ static struct cfgelem internal_cfgelems[] = {
       "<p>This element allows configuring a service that dumps a text "
       "description of part the internal state to TCP clients. By default "
       "(-1), this is disabled; specifying 0 means a kernel-allocated port is "
-      "used; a positive number is used as the TCP port number.</p>"
+      "used; a positive number is used as the TCP port number.</p>\n"
+      "<p>An HTTP request for <code>/metrics</code> returns counters and "
+      "queue occupancies in the OpenMetrics (Prometheus) text format instead, "
+      "suitable for periodic scraping; any other request returns the "
+      "description of the internal state as JSON.</p>"
     )),
   STRING(DEPRECATED("AssumeMulticastCapable"), NULL, 1, "",
     MEMBER(depr_assumeMulticastCapable),
@@ -1569,6 +1713,22 @@ static struct cfgelem internal_cfgelems[] = {
     "transport (e.g., UDP) and ManySocketsMode not set to single (the "
     "default).</p>"),
     VALUES("false","true","default")),
+#ifdef DDS_HAS_SECURITY
+  INT("SecureReceiveThreads", NULL, 1, "0",
+    MEMBER(secure_recv_threads),
+    FUNCTIONS(0, uf_uint, 0, pf_uint),
+    DESCRIPTION(
+      "<p>This element sets the number of worker threads used for decoding "
+      "(decrypting and verifying) RTPS messages that are protected at the "
+      "RTPS message level and processing their contents. If set to 0, the "
+      "receive threads do this themselves. Messages from a single source "
+      "participant are always processed by the same worker thread, in the "
+      "order in which they were received.</p>"
+      "<p>Worker threads are only used for connectionless transports (e.g., "
+      "UDP).</p>"),
+    BEHIND_FLAG("DDS_HAS_SECURITY")
+  ),
+#endif
   GROUP("ControlTopic", control_topic_cfgelems, control_topic_cfgattrs, 1,
     NOMEMBER,
     NOFUNCTIONS,
@@ -1724,6 +1884,54 @@ static struct cfgelem tcp_cfgelems[] = {
       "<p>This element specifies the timeout for blocking TCP read "
       "operations. If this timeout expires then the connection is closed.</p>"),
     UNIT("duration")),
+  STRING("ReadBufferSize", NULL, 1, "64 kB",
+    MEMBER(tcp_read_buffer_size),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This element specifies the size of the per-connection buffer used "
+      "for reading from TCP connections. Cyclone DDS reads as much data as "
+      "is available into this buffer, so that multiple small DDSI messages "
+      "can be received with a single system call. Messages larger than the "
+      "buffer are read directly. Setting it to 0 disables buffering.</p>"),
+    UNIT("memsize")),
+  STRING("SendQueueSize", NULL, 1, "0 B",
+    MEMBER(tcp_sendq_size),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This element specifies the maximum amount of data queued for "
+      "transmission on a single TCP connection. If it is 0, writes block "
+      "when the socket's send buffer is full (for at most WriteTimeout). "
+      "Otherwise, data that can't be written immediately is queued and "
+      "transmitted in the background, so that a single slow peer does not "
+      "stall communication with other peers. What happens when the queue is "
+      "full is controlled by SendQueueBestEffortPolicy and "
+      "SendQueueReliablePolicy. It is not supported in combination with "
+      "SSL/TLS.</p>"),
+    UNIT("memsize")),
+  ENUM("SendQueueBestEffortPolicy", NULL, 1, "drop",
+    MEMBER(tcp_sendq_policy_best_effort),
+    FUNCTIONS(0, uf_tcp_sendq_policy, 0, pf_tcp_sendq_policy),
+    DESCRIPTION(
+      "<p>This element specifies what to do with a message containing only "
+      "data from best-effort writers if the send queue of the TCP "
+      "connection is full:</p>\n"
+      "<ul><li><i>drop</i>: discard the message;</li>\n"
+      "<li><i>block</i>: wait until there is space in the queue, for at most "
+      "WriteTimeout, after which the connection is closed.</li></ul>\n"
+      "<p>See also SendQueueSize.</p>"),
+    VALUES("drop","block")),
+  ENUM("SendQueueReliablePolicy", NULL, 1, "block",
+    MEMBER(tcp_sendq_policy_reliable),
+    FUNCTIONS(0, uf_tcp_sendq_policy, 0, pf_tcp_sendq_policy),
+    DESCRIPTION(
+      "<p>This element specifies what to do with any other message if the "
+      "send queue of the TCP connection is full:</p>\n"
+      "<ul><li><i>drop</i>: discard the message and rely on the reliable "
+      "protocol to recover from it;</li>\n"
+      "<li><i>block</i>: wait until there is space in the queue, for at most "
+      "WriteTimeout, after which the connection is closed.</li></ul>\n"
+      "<p>See also SendQueueSize.</p>"),
+    VALUES("drop","block")),
   STRING("WriteTimeout", NULL, 1, "2 s",
     MEMBER(tcp_write_timeout),
     FUNCTIONS(0, uf_duration_ms_1hr, 0, pf_duration),
@@ -2120,7 +2328,31 @@ static struct cfgelem tracing_cfgelems[] = {
       "existing log file. The default is to create a new log file each time, "
       "which is generally the best option if a detailed log is generated.</p>"
     )),
-  STRING("PacketCaptureFile", NULL, 1, "",
+  ENUM("OutputFormat", NULL, 1, "text",
+    MEMBER(tracing_format),
+    FUNCTIONS(0, uf_trace_format, 0, pf_trace_format),
+    DESCRIPTION(
+      "<p>This option specifies the format of the trace output:</p>\n"
+      "<ul><li><i>text</i>: human-readable text, formatted and written by "
+      "the thread generating the trace message;</li>\n"
+      "<li><i>binary</i>: the format string and the raw arguments are "
+      "recorded in a per-thread buffer that is written to the file by a "
+      "background thread, greatly reducing the impact of tracing on the "
+      "timing behaviour. The <i>decode-bintrace</i> tool converts it to the "
+      "text format.</li></ul>\n"
+      "<p>Binary output is only supported when writing to a file. Messages "
+      "in the warning and error categories are also written to the log in "
+      "text form.</p>"),
+    VALUES("text","binary")),
+  STRING("BinaryBufferSize", NULL, 1, "1 MiB",
+    MEMBER(tracing_binary_buffer_size),
+    FUNCTIONS(0, uf_memsize, 0, pf_memsize),
+    DESCRIPTION(
+      "<p>This option specifies the size of the buffer of each thread for "
+      "binary trace output. Trace messages are dropped when it is full, "
+      "which is recorded in the trace.</p>"),
+    UNIT("memsize")),
+  STRING("PacketCaptureFile", pcap_attrs, 1, "",
     MEMBER(pcap_file),
     FUNCTIONS(0, uf_string, ff_free, pf_string),
     DESCRIPTION(
@@ -2130,7 +2362,10 @@ static struct cfgelem tracing_cfgelems[] = {
       "fictitious, in particular the destination address of received packets. "
       "The TTL may be used to distinguish between sent and received packets: "
       "it is 255 for sent packets and 128 for received ones. Currently IPv4 "
-      "only.</p>"
+      "only.</p>\n"
+      "<p>Packets are copied into a buffer of the sending or receiving "
+      "thread and written to the file by a background thread, so capturing "
+      "does not block the network paths.</p>"
     )),
   END_MARKER
 };
@@ -0,0 +1,37 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI__EMU_H
+#define DDSI__EMU_H
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsi_domaingv;
+
+/** @brief Initializes the emulated network transport
+ * @component emulated_transport
+ *
+ * All domains in the process using this transport are attached to a single
+ * emulated network that applies the loss, delay, reordering and bandwidth
+ * settings in Internal/Test/NetworkEmulation to the packets sent by each of
+ * them.
+ *
+ * @param gv domain
+ * @return 0 on success, < 0 on failure
+ */
+int ddsi_emu_init (struct ddsi_domaingv *gv);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI__EMU_H */
@@ -109,6 +109,7 @@ struct ddsi_wr_prd_match {
   ddsrt_wctime_t hb_to_ack_latency_tlastlog;
   uint32_t non_responsive_count;
   uint32_t rexmit_requests;
+  struct ddsi_sertype_content_filter *content_filter; /* reader's content filter if the writer can evaluate it */
 #ifdef DDS_HAS_SECURITY
   int64_t crypto_handle;
 #endif
@@ -218,6 +219,9 @@ void ddsi_proxy_reader_add_connection (struct ddsi_proxy_reader *prd, struct dds
 /** @component endpoint_matching */
 void ddsi_writer_drop_connection (const struct ddsi_guid *wr_guid, const struct ddsi_proxy_reader *prd);
 
+/** @component endpoint_matching */
+void ddsi_writer_update_content_filter (struct ddsi_writer *wr, struct ddsi_proxy_reader *prd);
+
 /** @component endpoint_matching */
 void ddsi_writer_drop_local_connection (const struct ddsi_guid *wr_guid, struct ddsi_reader *rd);
 
@@ -20,9 +20,30 @@ extern "C" {
 #endif
 
 struct msghdr;
+struct ddsi_pcap;
 
 /** @component packet_capturing */
-FILE * ddsi_new_pcap_file (struct ddsi_domaingv *gv, const char *name);
+struct ddsi_pcap_stats {
+  uint64_t written;        /**< number of packets written to the file */
+  uint64_t dropped;        /**< number of packets dropped because a buffer was full */
+  uint64_t drains;         /**< number of times the writer thread emptied the buffers */
+};
+
+/** @brief Opens the capture file and starts the thread writing to it
+ * @component packet_capturing
+ *
+ * @returns the packet capture, or NULL if capturing is not possible */
+struct ddsi_pcap *ddsi_pcap_new (struct ddsi_domaingv *gv, const char *name);
+
+/** @brief Writes out the remaining captured packets and closes the file
+ * @component packet_capturing
+ *
+ * No packets may be captured once this has been called */
+void ddsi_pcap_free (struct ddsi_pcap *pcap);
+
+/** @brief Returns the packet capture statistics
+ * @component packet_capturing */
+void ddsi_pcap_get_stats (struct ddsi_pcap *pcap, struct ddsi_pcap_stats *stats);
 
 /** @component packet_capturing */
 void ddsi_write_pcap_received (struct ddsi_domaingv *gv, ddsrt_wctime_t tstamp, const struct sockaddr_storage *src, const struct sockaddr_storage *dst, unsigned char *buf, size_t sz);
@@ -113,6 +113,18 @@ typedef int32_t ddsi_reorder_result_t;
 
 typedef void (*ddsi_dqueue_callback_t) (void *arg);
 
+struct ddsi_rbufpool_stats {
+  uint32_t rbuf_size;  /* size of a single receive buffer */
+  uint32_t n_rbufs;    /* number of receive buffers currently allocated, including the current one */
+  uint32_t n_allocs;   /* number of receive buffers allocated since the pool was created (wraps) */
+};
+
+struct ddsi_dqueue_stats {
+  const char *name;
+  uint32_t nof_samples; /* samples currently queued */
+  uint32_t max_samples;
+};
+
 enum ddsi_defrag_nackmap_result {
   DDSI_DEFRAG_NACKMAP_UNKNOWN_SAMPLE,
   DDSI_DEFRAG_NACKMAP_ALL_ADVERTISED_FRAGMENTS_KNOWN,
@@ -128,6 +140,9 @@ void ddsi_rbufpool_setowner (struct ddsi_rbufpool *rbp, ddsrt_thread_t tid);
 /** @component receive_buffers */
 void ddsi_rbufpool_free (struct ddsi_rbufpool *rbp);
 
+/** @component receive_buffers */
+void ddsi_rbufpool_get_stats (struct ddsi_rbufpool *rbp, struct ddsi_rbufpool_stats *stats);
+
 /** @component receive_buffers */
 struct ddsi_rmsg *ddsi_rmsg_new (struct ddsi_rbufpool *rbufpool);
 
@@ -143,6 +158,12 @@ void ddsi_rmsg_free (struct ddsi_rmsg *rmsg);
 /** @component receive_buffers */
 void *ddsi_rmsg_alloc (struct ddsi_rmsg *rmsg, uint32_t size);
 
+/** @component receive_buffers */
+void ddsi_rmsg_addref (struct ddsi_rmsg *rmsg);
+
+/** @component receive_buffers */
+void ddsi_rmsg_unref (struct ddsi_rmsg *rmsg);
+
 /** @component receive_buffers */
 struct ddsi_rdata *ddsi_rdata_new (struct ddsi_rmsg *rmsg, uint32_t start, uint32_t endp1, uint32_t submsg_offset, uint32_t payload_offset, uint32_t keyhash_offset);
 
@@ -244,6 +265,9 @@ int ddsi_dqueue_is_full (struct ddsi_dqueue *q);
 /** @component receive_buffers */
 void ddsi_dqueue_wait_until_empty_if_full (struct ddsi_dqueue *q);
 
+/** @component receive_buffers */
+void ddsi_dqueue_get_stats (struct ddsi_dqueue *q, struct ddsi_dqueue_stats *stats);
+
 /** @brief processes everything currently enqueued, dropping all data
     @component receive_buffers */
 bool ddsi_dqueue_step_deaf (struct ddsi_dqueue *q);
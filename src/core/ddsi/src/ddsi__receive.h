@@ -56,7 +56,12 @@ int ddsi_user_dqueue_handler (const struct ddsi_rsample_info *sampleinfo, const
 /** @component incoming_rtps */
 int ddsi_add_gap (struct ddsi_xmsg *msg, struct ddsi_writer *wr, struct ddsi_proxy_reader *prd, ddsi_seqno_t start, ddsi_seqno_t base, uint32_t numbits, const uint32_t *bits);
 
-/** @component incoming_rtps */
+/**
+ * @component incoming_rtps
+ *
+ * Processes an RTPS message on the calling thread, never handing it off to a
+ * secure receive worker.
+ */
 void ddsi_handle_rtps_message (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, struct ddsi_rmsg *rmsg, size_t sz, unsigned char *msg, const struct ddsi_network_packet_info *pktinfo);
 
 #if defined (__cplusplus)
@@ -48,6 +48,14 @@ inline void ddsi_rhc_free (struct ddsi_rhc *rhc) {
   rhc->ops->free (rhc);
 }
 
+/** @component rhc_if */
+inline bool ddsi_rhc_get_stats (struct ddsi_rhc *rhc, struct ddsi_rhc_stats *stats) {
+  if (rhc->ops->get_stats == NULL)
+    return false;
+  rhc->ops->get_stats (rhc, stats);
+  return true;
+}
+
 #if defined (__cplusplus)
 }
 #endif
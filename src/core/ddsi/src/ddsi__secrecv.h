@@ -0,0 +1,92 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSI__SECRECV_H
+#define DDSI__SECRECV_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "dds/ddsrt/retcode.h"
+#include "dds/ddsi/ddsi_guid.h"
+#include "ddsi__tran.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsi_domaingv;
+struct ddsi_tran_conn;
+struct ddsi_rmsg;
+struct ddsi_secrecv;
+
+/* The secure receive pool offloads decoding (decryption and MAC verification)
+   of RTPS messages protected at the RTPS message level, and the subsequent
+   processing of the decoded submessages, to a set of worker threads.
+
+   Each worker owns its own receive buffer pool and processes the packets in
+   the order they were handed to it.  All packets from a single source
+   participant are handed to the same worker, so the order in which messages
+   from one source are processed is the order in which they were received. */
+
+/** @component secure_receive */
+struct ddsi_secrecv *ddsi_secrecv_new (struct ddsi_domaingv *gv, uint32_t nworkers);
+
+/** @component secure_receive */
+dds_return_t ddsi_secrecv_start (struct ddsi_secrecv *sr);
+
+/**
+ * @component secure_receive
+ *
+ * Processes all queued packets and stops the worker threads; the receive
+ * threads must have been stopped already.
+ */
+void ddsi_secrecv_stop (struct ddsi_secrecv *sr);
+
+/**
+ * @component secure_receive
+ *
+ * Frees the pool, including the receive buffer pools of the workers.  Like
+ * for the receive threads, that must be delayed until all references to the
+ * receive buffers have been dropped.
+ */
+void ddsi_secrecv_free (struct ddsi_secrecv *sr);
+
+/**
+ * @component secure_receive
+ *
+ * Checks whether the packet (with a valid RTPS header and the GUID prefix
+ * still in network byte order) is protected at the RTPS message level and
+ * if so, queues it for the worker responsible for the source.  The packet is
+ * not copied: the worker holds a reference to the receive buffer until it is
+ * done with it, so the caller must still commit the rmsg as usual.
+ *
+ * @param[in] sr          secure receive pool
+ * @param[in] conn        connection on which the packet was received
+ * @param[in] guidprefix  local destination GUID prefix (may be NULL)
+ * @param[in] rmsg        uncommitted receive buffer containing the packet
+ * @param[in] msg         packet contents
+ * @param[in] sz          packet size
+ * @param[in] pktinfo     source and destination information of the packet
+ *
+ * @returns true if the packet was queued for processing by a worker, false if
+ * the caller should process it
+ */
+bool ddsi_secrecv_enqueue (struct ddsi_secrecv *sr, struct ddsi_tran_conn *conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rmsg *rmsg, unsigned char *msg, size_t sz, const struct ddsi_network_packet_info *pktinfo);
+
+/** @component secure_receive */
+void ddsi_secrecv_stats (const struct ddsi_secrecv *sr, uint64_t *packets, uint64_t *bytes, uint64_t *time_queued, uint64_t *time_process, uint32_t *queue_length_max);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSI__SECRECV_H */
@@ -19,9 +19,28 @@ extern "C" {
 
 struct ddsi_domaingv;
 
+/** @brief Send queue statistics of a TCP connection (see TCP/SendQueueSize) */
+struct ddsi_tcp_sendq_stats {
+  ddsi_locator_t peer;     /**< address of the peer */
+  size_t queued;           /**< number of bytes currently queued */
+  size_t queued_max;       /**< maximum number of bytes queued */
+  uint64_t dropped;        /**< number of messages dropped because the queue was full */
+  uint64_t blocked;        /**< number of times a write blocked because the queue was full */
+};
+
 /** @component tcp_transport */
 int ddsi_tcp_init (struct ddsi_domaingv *gv);
 
+/**
+ * @component tcp_transport
+ * @brief Get the send queue statistics of all connections with a send queue
+ *
+ * @param[in] fact TCP transport factory
+ * @param[out] stats set to a ddsrt_malloc'd array with the statistics, or to NULL if none
+ * @return number of entries in `stats`
+ */
+size_t ddsi_tcp_get_sendq_stats (struct ddsi_tran_factory *fact, struct ddsi_tcp_sendq_stats **stats);
+
 #if defined (__cplusplus)
 }
 #endif
@@ -34,6 +34,8 @@ struct ddsi_domaingv;
 
 /* Flags */
 #define DDSI_TRAN_ON_CONNECT 0x0001
+/* Message contains only data from best-effort writers */
+#define DDSI_TRAN_BEST_EFFORT 0x0002
 
 /* Magic value for port number argument in create_conn and create_listener to indicate
    that a random port number is requested.  Note that 0 also happens to be illegal in UDP
@@ -103,6 +105,7 @@ struct ddsi_network_packet_info {
 
 /* Function pointer types */
 typedef ssize_t (*ddsi_tran_read_fn_t) (struct ddsi_tran_conn *, unsigned char *, size_t, bool, struct ddsi_network_packet_info *pktinfo);
+typedef bool (*ddsi_tran_buffered_fn_t) (struct ddsi_tran_conn *);
 typedef ssize_t (*ddsi_tran_write_fn_t) (struct ddsi_tran_conn *, const ddsi_locator_t *, const ddsi_tran_write_msgfrags_t *, uint32_t);
 typedef int (*ddsi_tran_locator_fn_t) (struct ddsi_tran_factory *, struct ddsi_tran_base *, ddsi_locator_t *);
 typedef bool (*ddsi_tran_supports_fn_t) (const struct ddsi_tran_factory *, int32_t);
@@ -176,6 +179,7 @@ struct ddsi_tran_conn
   /* Functions */
 
   ddsi_tran_read_fn_t m_read_fn;
+  ddsi_tran_buffered_fn_t m_buffered_fn; /* optional, for transports buffering received data */
   ddsi_tran_write_fn_t m_write_fn;
   ddsi_tran_peer_locator_fn_t m_peer_locator_fn;
   ddsi_tran_disable_multiplexing_fn_t m_disable_multiplexing_fn;
@@ -397,6 +401,17 @@ inline ssize_t ddsi_conn_read (struct ddsi_tran_conn * conn, unsigned char * buf
   return conn->m_closed ? -1 : conn->m_read_fn (conn, buf, len, allow_spurious, pktinfo);
 }
 
+/**
+ * @component transport
+ *
+ * Checks whether a complete message has been received on the connection but not yet
+ * read. Connections that buffer received data (currently only TCP) can have one
+ * even though the socket isn't readable, and so must be read again without waiting.
+ */
+inline bool ddsi_conn_has_buffered_message (struct ddsi_tran_conn * conn) {
+  return !conn->m_closed && conn->m_buffered_fn != 0 && conn->m_buffered_fn (conn);
+}
+
 /** @component transport */
 bool ddsi_conn_peer_locator (struct ddsi_tran_conn * conn, ddsi_locator_t * loc);
 
@@ -58,6 +58,9 @@ int ddsi_enqueue_sample_wrlock_held (struct ddsi_writer *wr, ddsi_seqno_t seq, s
 /** @component outgoing_rtps */
 void ddsi_enqueue_spdp_sample_wrlock_held (struct ddsi_writer *wr, ddsi_seqno_t seq, struct ddsi_serdata *serdata, struct ddsi_proxy_reader *prd);
 
+/** @component outgoing_rtps */
+void ddsi_writer_send_filtered_gaps_wrlock_held (struct ddsi_writer *wr);
+
 /** @component outgoing_rtps */
 void ddsi_add_heartbeat (struct ddsi_xmsg *msg, struct ddsi_writer *wr, const struct ddsi_whc_state *whcst, enum ddsi_hbcontrol_ack_required hbansreq, int hbliveliness, ddsi_entityid_t dst, int issync);
 
@@ -14,6 +14,7 @@
 #include "dds/ddsrt/retcode.h"
 #include "dds/ddsi/ddsi_guid.h"
 #include "dds/ddsi/ddsi_xevent.h"
+#include "dds/ddsi/ddsi_lathist.h"
 
 #if defined (__cplusplus)
 extern "C" {
@@ -31,6 +32,16 @@ struct ddsi_proxy_reader;
 struct ddsi_domaingv;
 struct ddsi_xmsg;
 
+struct ddsi_xeventq_stats {
+  uint32_t n_timed;                  /* timed events scheduled */
+  size_t n_nontimed;                 /* non-timed events (mostly messages) queued */
+  size_t queued_rexmit_bytes;
+  size_t queued_rexmit_msgs;
+  uint64_t n_handled;                /* timed events handled so far */
+  uint64_t lateness_sum;             /* total time (ns) between scheduled and actual execution */
+  struct ddsi_lathist_summary lateness; /* lateness only measured if stage latency statistics enabled */
+};
+
 /** @component timed_events */
 struct ddsi_xeventq *ddsi_xeventq_new (struct ddsi_domaingv *gv, size_t max_queued_rexmit_bytes, size_t max_queued_rexmit_msgs);
 
@@ -58,6 +69,9 @@ dds_return_t ddsi_xeventq_start (struct ddsi_xeventq *evq, const char *name); /*
 /** @component timed_events */
 void ddsi_xeventq_stop (struct ddsi_xeventq *evq);
 
+/** @component timed_events */
+void ddsi_xeventq_get_stats (struct ddsi_xeventq *evq, struct ddsi_xeventq_stats *stats);
+
 /** @component timed_events */
 void ddsi_qxev_msg (struct ddsi_xeventq *evq, struct ddsi_xmsg *msg);
 
@@ -27,6 +27,7 @@
 #include "dds/ddsrt/misc.h"
 #include "dds/ddsrt/environ.h"
 #include "dds/ddsrt/avl.h"
+#include "dds/ddsrt/bintrace.h"
 #include "dds/ddsrt/xmlparser.h"
 #include "dds/ddsrt/io.h"
 #include "dds/ddsi/ddsi_log.h"
@@ -181,6 +182,8 @@ PF(maybe_duration);
 DUPF(standards_conformance);
 DUPF(besmode);
 DUPF(retransmit_merging);
+DUPF(tcp_sendq_policy);
+DUPF(trace_format);
 DUPF(sched_class);
 DUPF(random_seed);
 DUPF(entity_naming_mode);
@@ -987,12 +990,20 @@ static const char *en_retransmit_merging_vs[] = { "never", "adaptive", "always",
 static const enum ddsi_retransmit_merging en_retransmit_merging_ms[] = { DDSI_REXMIT_MERGE_NEVER, DDSI_REXMIT_MERGE_ADAPTIVE, DDSI_REXMIT_MERGE_ALWAYS, 0 };
 GENERIC_ENUM_CTYPE (retransmit_merging, enum ddsi_retransmit_merging)
 
+static const char *en_tcp_sendq_policy_vs[] = { "drop", "block", NULL };
+static const enum ddsi_tcp_sendq_policy en_tcp_sendq_policy_ms[] = { DDSI_TCP_SENDQ_DROP, DDSI_TCP_SENDQ_BLOCK, 0 };
+GENERIC_ENUM_CTYPE (tcp_sendq_policy, enum ddsi_tcp_sendq_policy)
+
+static const char *en_trace_format_vs[] = { "text", "binary", NULL };
+static const enum ddsi_trace_format en_trace_format_ms[] = { DDSI_TRACE_FORMAT_TEXT, DDSI_TRACE_FORMAT_BINARY, 0 };
+GENERIC_ENUM_CTYPE (trace_format, enum ddsi_trace_format)
+
 static const char *en_sched_class_vs[] = { "realtime", "timeshare", "default", NULL };
 static const ddsrt_sched_t en_sched_class_ms[] = { DDSRT_SCHED_REALTIME, DDSRT_SCHED_TIMESHARE, DDSRT_SCHED_DEFAULT, 0 };
 GENERIC_ENUM_CTYPE (sched_class, ddsrt_sched_t)
 
-static const char *en_transport_selector_vs[] = { "default", "udp", "udp6", "tcp", "tcp6", "raweth", "none", NULL };
-static const enum ddsi_transport_selector en_transport_selector_ms[] = { DDSI_TRANS_DEFAULT, DDSI_TRANS_UDP, DDSI_TRANS_UDP6, DDSI_TRANS_TCP, DDSI_TRANS_TCP6, DDSI_TRANS_RAWETH, DDSI_TRANS_NONE, 0 };
+static const char *en_transport_selector_vs[] = { "default", "udp", "udp6", "tcp", "tcp6", "raweth", "emu", "none", NULL };
+static const enum ddsi_transport_selector en_transport_selector_ms[] = { DDSI_TRANS_DEFAULT, DDSI_TRANS_UDP, DDSI_TRANS_UDP6, DDSI_TRANS_TCP, DDSI_TRANS_TCP6, DDSI_TRANS_RAWETH, DDSI_TRANS_EMU, DDSI_TRANS_NONE, 0 };
 GENERIC_ENUM_CTYPE (transport_selector, enum ddsi_transport_selector)
 
 /* by putting the  "true" and "false" aliases at the end, they won't come out of the
@@ -2742,6 +2753,7 @@ struct ddsi_cfgst *ddsi_config_init (const char *config, struct ddsi_config *cfg
         ok1 = !(cfgst->cfg->compat_tcp_enable == DDSI_BOOLDEF_TRUE || cfgst->cfg->compat_use_ipv6 == DDSI_BOOLDEF_FALSE);
         break;
       case DDSI_TRANS_RAWETH:
+      case DDSI_TRANS_EMU:
       case DDSI_TRANS_NONE:
         ok1 = !(cfgst->cfg->compat_tcp_enable == DDSI_BOOLDEF_TRUE || cfgst->cfg->compat_use_ipv6 == DDSI_BOOLDEF_TRUE);
         break;
@@ -2805,6 +2817,9 @@ void ddsi_config_fini (struct ddsi_cfgst *cfgst)
   free_all_elements (cfgst, cfgst->cfg, root_cfgelems);
   dds_set_log_file (stderr);
   dds_set_trace_file (stderr);
+  if (cfgst->cfg->tracebt) {
+    ddsrt_bintrace_free (cfgst->cfg->tracebt);
+  }
   if (cfgst->cfg->tracefp && cfgst->cfg->tracefp != stdout && cfgst->cfg->tracefp != stderr) {
     fclose(cfgst->cfg->tracefp);
   }
@@ -17,6 +17,10 @@
 #include "dds/ddsrt/sync.h"
 #include "dds/ddsrt/misc.h"
 #include "dds/ddsrt/avl.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/rusage.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/static_assert.h"
 #include "dds/ddsi/ddsi_proxy_participant.h"
 #include "dds/ddsi/ddsi_log.h"
 #include "dds/ddsi/ddsi_plist.h"
@@ -35,8 +39,13 @@
 #include "ddsi__debmon.h"
 #include "ddsi__tran.h"
 #include "ddsi__tcp.h"
+#include "ddsi__pcap.h"
 #include "ddsi__endpoint.h"
 #include "ddsi__proxy_endpoint.h"
+#include "ddsi__xevent.h"
+#include "ddsi__rhc.h"
+#include "dds/ddsi/ddsi_statistics.h"
+#include "dds/ddsi/ddsi_lathist.h"
 
 #include "dds__whc.h"
 
@@ -610,17 +619,573 @@ static void print_proxy_participants (struct st *st)
   ddsi_thread_state_asleep (st->thrst);
 }
 
+struct print_tcp_sendq_seq_arg {
+  size_t n;
+  const struct ddsi_tcp_sendq_stats *stats;
+};
+
+static void print_tcp_sendq (struct st *st, void *vs)
+{
+  const struct ddsi_tcp_sendq_stats *s = vs;
+  char buf[DDSI_LOCSTRLEN];
+  cpfkstr (st, "peer", ddsi_locator_to_string (buf, sizeof (buf), &s->peer));
+  cpfksize (st, "queued", s->queued);
+  cpfksize (st, "queued_max", s->queued_max);
+  cpfku64 (st, "dropped", s->dropped);
+  cpfku64 (st, "blocked", s->blocked);
+}
+
+static void print_tcp_sendq_seq (struct st *st, void *varg)
+{
+  struct print_tcp_sendq_seq_arg *arg = varg;
+  for (size_t i = 0; i < arg->n && !st->error; i++)
+    cpfobj (st, print_tcp_sendq, (void *) &arg->stats[i]);
+}
+
+static void print_tcp_send_queues (struct st *st)
+{
+  const enum ddsi_transport_selector ts = st->gv->config.transport_selector;
+  if (!(ts == DDSI_TRANS_TCP || ts == DDSI_TRANS_TCP6) || st->gv->config.tcp_sendq_size == 0)
+    return;
+  struct ddsi_tcp_sendq_stats *stats;
+  const size_t n = ddsi_tcp_get_sendq_stats (st->gv->m_factory, &stats);
+  cpfkseq (st, "tcp_send_queues", print_tcp_sendq_seq, &(struct print_tcp_sendq_seq_arg){ .n = n, .stats = stats });
+  ddsrt_free (stats);
+}
+
 static void print_domain (struct st *st, void *varg)
 {
   (void) varg;
   print_participants (st);
   print_proxy_participants (st);
+  print_tcp_send_queues (st);
+}
+
+/* OpenMetrics ------------------------------------------------------------
+
+   The "/metrics" path serves the counters in the OpenMetrics text format
+   so that the monitor port can be scraped directly by Prometheus and the
+   like.  All per-entity values are first copied into a snapshot with the
+   entities locked only briefly, then written out grouped by metric family
+   (as the format requires) without holding any locks.  The cost is linear
+   in the number of local readers and writers and a small constant for the
+   queues, so scraping it every second is fine. */
+
+enum om_type {
+  OMT_COUNTER,
+  OMT_GAUGE
+};
+
+struct om_desc {
+  const char *name;
+  enum om_type type;
+  const char *unit; /* NULL or the suffix of name */
+  const char *help;
+};
+
+enum om_writer_metric {
+  OMW_SAMPLES,
+  OMW_REXMIT_BYTES,
+  OMW_REXMITS,
+  OMW_REXMITS_LOST,
+  OMW_TIME_REXMIT,
+  OMW_THROTTLES,
+  OMW_TIME_THROTTLE,
+  OMW_ACKS,
+  OMW_NACKS,
+  OMW_WHC_UNACKED_BYTES,
+  OMW_WHC_SEQ_SPAN,
+  OMW_MATCHED_READERS,
+  OMW_COUNT
+};
+
+static const struct om_desc om_writer_desc[OMW_COUNT] = {
+  [OMW_SAMPLES] = { "cyclonedds_writer_samples", OMT_COUNTER, NULL, "Samples written" },
+  [OMW_REXMIT_BYTES] = { "cyclonedds_writer_rexmit_bytes", OMT_COUNTER, "bytes", "Bytes queued for retransmission" },
+  [OMW_REXMITS] = { "cyclonedds_writer_rexmits", OMT_COUNTER, NULL, "Samples retransmitted" },
+  [OMW_REXMITS_LOST] = { "cyclonedds_writer_rexmits_lost", OMT_COUNTER, NULL, "Retransmit requests for samples no longer available" },
+  [OMW_TIME_REXMIT] = { "cyclonedds_writer_rexmit_seconds", OMT_COUNTER, "seconds", "Time spent in retransmitting state" },
+  [OMW_THROTTLES] = { "cyclonedds_writer_throttles", OMT_COUNTER, NULL, "Times the writer was throttled because of a full WHC" },
+  [OMW_TIME_THROTTLE] = { "cyclonedds_writer_throttle_seconds", OMT_COUNTER, "seconds", "Time spent throttled" },
+  [OMW_ACKS] = { "cyclonedds_writer_acks", OMT_COUNTER, NULL, "ACKNACKs received without retransmit request" },
+  [OMW_NACKS] = { "cyclonedds_writer_nacks", OMT_COUNTER, NULL, "ACKNACKs received requesting retransmits" },
+  [OMW_WHC_UNACKED_BYTES] = { "cyclonedds_writer_whc_unacked_bytes", OMT_GAUGE, "bytes", "Unacknowledged data in the writer history cache" },
+  [OMW_WHC_SEQ_SPAN] = { "cyclonedds_writer_whc_seq_span", OMT_GAUGE, NULL, "Range of sequence numbers in the writer history cache" },
+  [OMW_MATCHED_READERS] = { "cyclonedds_writer_matched_proxy_readers", OMT_GAUGE, NULL, "Matched remote readers" }
+};
+
+enum om_reader_metric {
+  OMR_DISCARDED_BYTES,
+  OMR_RHC_INSTANCES,
+  OMR_RHC_SAMPLES,
+  OMR_RHC_READ_SAMPLES,
+  OMR_COUNT
+};
+
+static const struct om_desc om_reader_desc[OMR_COUNT] = {
+  [OMR_DISCARDED_BYTES] = { "cyclonedds_reader_discarded_bytes", OMT_COUNTER, "bytes", "Bytes received and discarded" },
+  [OMR_RHC_INSTANCES] = { "cyclonedds_reader_rhc_instances", OMT_GAUGE, NULL, "Instances in the reader history cache" },
+  [OMR_RHC_SAMPLES] = { "cyclonedds_reader_rhc_samples", OMT_GAUGE, NULL, "Samples in the reader history cache" },
+  [OMR_RHC_READ_SAMPLES] = { "cyclonedds_reader_rhc_read_samples", OMT_GAUGE, NULL, "Samples in the reader history cache that have been read" }
+};
+
+/* writers have more metrics than readers, used for both */
+#define OM_ENDPOINT_NMETRICS ((int) OMW_COUNT)
+DDSRT_STATIC_ASSERT ((int) OMR_COUNT <= OM_ENDPOINT_NMETRICS);
+
+struct om_endpoint {
+  char *labels; /* guid="...",topic="..." */
+  bool has_lat;
+  struct ddsi_lathist_summary lat;
+  bool valid[OM_ENDPOINT_NMETRICS];
+  double v[OM_ENDPOINT_NMETRICS];
+};
+
+struct om_endpoints {
+  uint32_t n, size;
+  struct om_endpoint *eps;
+};
+
+static size_t om_escape (char *dst, size_t size, const char *src)
+{
+  // label values: backslash, double-quote and line feed must be escaped
+  size_t i = 0;
+  assert (size > 0);
+  for (; *src && i + 2 < size; src++)
+  {
+    if (*src == '\\' || *src == '"')
+    {
+      dst[i++] = '\\';
+      dst[i++] = *src;
+    }
+    else if (*src == '\n')
+    {
+      dst[i++] = '\\';
+      dst[i++] = 'n';
+    }
+    else
+    {
+      dst[i++] = *src;
+    }
+  }
+  dst[i] = 0;
+  return i;
+}
+
+static struct om_endpoint *om_endpoints_append (struct om_endpoints *eps, const ddsi_guid_t *guid, const struct dds_qos *xqos)
+{
+  if (eps->n == eps->size)
+  {
+    eps->size = (eps->size == 0) ? 16 : 2 * eps->size;
+    eps->eps = ddsrt_realloc (eps->eps, eps->size * sizeof (*eps->eps));
+  }
+  struct om_endpoint * const ep = &eps->eps[eps->n++];
+  char topic[256];
+  (void) om_escape (topic, sizeof (topic), (xqos->present & DDSI_QP_TOPIC_NAME) ? xqos->topic_name : "");
+  const size_t lsize = sizeof (topic) + 64;
+  ep->labels = ddsrt_malloc (lsize);
+  (void) snprintf (ep->labels, lsize, "guid=\""PGUIDFMT"\",topic=\"%s\"", PGUID (*guid), topic);
+  ep->has_lat = false;
+  memset (ep->valid, 0, sizeof (ep->valid));
+  return ep;
+}
+
+static void om_endpoints_fini (struct om_endpoints *eps)
+{
+  for (uint32_t i = 0; i < eps->n; i++)
+    ddsrt_free (eps->eps[i].labels);
+  ddsrt_free (eps->eps);
+}
+
+static void om_setv (struct om_endpoint *ep, int idx, double v)
+{
+  ep->valid[idx] = true;
+  ep->v[idx] = v;
+}
+
+static void om_snapshot_writer (struct om_endpoints *eps, struct ddsi_writer *w)
+{
+  struct ddsi_whc_state whcst;
+  ddsrt_mutex_lock (&w->e.lock);
+  struct om_endpoint * const ep = om_endpoints_append (eps, &w->e.guid, w->xqos);
+  ddsi_whc_get_state (w->whc, &whcst);
+  om_setv (ep, OMW_SAMPLES, (double) w->seq);
+  om_setv (ep, OMW_REXMIT_BYTES, (double) w->rexmit_bytes);
+  om_setv (ep, OMW_REXMITS, (double) w->rexmit_count);
+  om_setv (ep, OMW_REXMITS_LOST, (double) w->rexmit_lost_count);
+  om_setv (ep, OMW_TIME_REXMIT, (double) w->time_retransmit / 1e9);
+  om_setv (ep, OMW_THROTTLES, (double) w->throttle_count);
+  om_setv (ep, OMW_TIME_THROTTLE, (double) w->time_throttled / 1e9);
+  if (w->reliable)
+  {
+    om_setv (ep, OMW_ACKS, (double) w->num_acks_received);
+    om_setv (ep, OMW_NACKS, (double) w->num_nacks_received);
+  }
+  om_setv (ep, OMW_WHC_UNACKED_BYTES, (double) whcst.unacked_bytes);
+  om_setv (ep, OMW_WHC_SEQ_SPAN, DDSI_WHCST_ISEMPTY (&whcst) ? 0.0 : (double) (whcst.max_seq - whcst.min_seq + 1));
+  om_setv (ep, OMW_MATCHED_READERS, (double) w->num_readers);
+  if (w->lathist_whc)
+  {
+    ep->has_lat = true;
+    ddsi_lathist_summarize (w->lathist_whc, &ep->lat);
+  }
+  ddsrt_mutex_unlock (&w->e.lock);
+}
+
+static void om_snapshot_reader (struct om_endpoints *eps, struct ddsi_reader *r)
+{
+  uint64_t discarded_bytes;
+  struct ddsi_rhc_stats rhcst;
+  ddsrt_mutex_lock (&r->e.lock);
+  struct om_endpoint * const ep = om_endpoints_append (eps, &r->e.guid, r->xqos);
+  ddsrt_mutex_unlock (&r->e.lock);
+  // both lock other things than just the reader
+  ddsi_get_reader_stats (r, &discarded_bytes);
+  om_setv (ep, OMR_DISCARDED_BYTES, (double) discarded_bytes);
+  if (r->rhc && ddsi_rhc_get_stats (r->rhc, &rhcst))
+  {
+    om_setv (ep, OMR_RHC_INSTANCES, rhcst.n_instances);
+    om_setv (ep, OMR_RHC_SAMPLES, rhcst.n_samples);
+    om_setv (ep, OMR_RHC_READ_SAMPLES, rhcst.n_read);
+  }
+}
+
+static void om_family (struct st *st, const struct om_desc *d)
+{
+  cpf (st, "# TYPE %s %s\n", d->name, (d->type == OMT_COUNTER) ? "counter" : "gauge");
+  if (d->unit)
+    cpf (st, "# UNIT %s %s\n", d->name, d->unit);
+  cpf (st, "# HELP %s %s\n", d->name, d->help);
+}
+
+static void om_sample (struct st *st, const struct om_desc *d, const char *labels, double v)
+{
+  const char *suffix = (d->type == OMT_COUNTER) ? "_total" : "";
+  if (labels == NULL)
+    cpf (st, "%s%s %.15g\n", d->name, suffix, v);
+  else
+    cpf (st, "%s%s{%s} %.15g\n", d->name, suffix, labels, v);
+}
+
+static void om_summary (struct st *st, const char *name, const char *labels, const struct ddsi_lathist_summary *s, const uint64_t *sum)
+{
+  static const char *quantiles[] = { "0.5", "0.9", "0.99", "1" };
+  const uint64_t qv[] = { s->p50, s->p90, s->p99, s->max };
+  const char *sep = labels ? "," : "";
+  const char *lopen = labels ? "{" : "", *lclose = labels ? "}" : "";
+  if (labels == NULL)
+    labels = "";
+  for (size_t i = 0; i < sizeof (quantiles) / sizeof (quantiles[0]); i++)
+    cpf (st, "%s{%s%squantile=\"%s\"} %.9g\n", name, labels, sep, quantiles[i], (double) qv[i] / 1e9);
+  cpf (st, "%s_count%s%s%s %"PRIu64"\n", name, lopen, labels, lclose, s->count);
+  if (sum)
+    cpf (st, "%s_sum%s%s%s %.9g\n", name, lopen, labels, lclose, (double) *sum / 1e9);
+}
+
+static void om_endpoint_families (struct st *st, const struct om_endpoints *eps, const struct om_desc *descs, int ndescs)
+{
+  for (int k = 0; k < ndescs && !st->error; k++)
+  {
+    om_family (st, &descs[k]);
+    for (uint32_t i = 0; i < eps->n; i++)
+      if (eps->eps[i].valid[k])
+        om_sample (st, &descs[k], eps->eps[i].labels, eps->eps[i].v[k]);
+  }
+}
+
+static void om_endpoints (struct st *st)
+{
+  struct om_endpoints wrs = { 0, 0, NULL }, rds = { 0, 0, NULL };
+  ddsi_thread_state_awake_fixed_domain (st->thrst);
+  {
+    struct ddsi_entity_enum_writer ew;
+    struct ddsi_writer *w;
+    ddsi_entidx_enum_writer_init (&ew, st->gv->entity_index);
+    while ((w = ddsi_entidx_enum_writer_next (&ew)) != NULL)
+      om_snapshot_writer (&wrs, w);
+    ddsi_entidx_enum_writer_fini (&ew);
+  }
+  {
+    struct ddsi_entity_enum_reader er;
+    struct ddsi_reader *r;
+    ddsi_entidx_enum_reader_init (&er, st->gv->entity_index);
+    while ((r = ddsi_entidx_enum_reader_next (&er)) != NULL)
+      om_snapshot_reader (&rds, r);
+    ddsi_entidx_enum_reader_fini (&er);
+  }
+  ddsi_thread_state_asleep (st->thrst);
+
+  om_endpoint_families (st, &wrs, om_writer_desc, OMW_COUNT);
+  if (st->gv->config.stage_latency_statistics)
+  {
+    cpf (st, "# TYPE cyclonedds_writer_whc_latency_seconds summary\n# UNIT cyclonedds_writer_whc_latency_seconds seconds\n# HELP cyclonedds_writer_whc_latency_seconds Time spent inserting samples in the WHC\n");
+    for (uint32_t i = 0; i < wrs.n && !st->error; i++)
+      if (wrs.eps[i].has_lat)
+        om_summary (st, "cyclonedds_writer_whc_latency_seconds", wrs.eps[i].labels, &wrs.eps[i].lat, NULL);
+  }
+  om_endpoint_families (st, &rds, om_reader_desc, OMR_COUNT);
+  om_endpoints_fini (&wrs);
+  om_endpoints_fini (&rds);
+}
+
+static void om_domain (struct st *st)
+{
+  static const struct om_desc secrecv_desc[] = {
+    { "cyclonedds_secrecv_packets", OMT_COUNTER, NULL, "Packets decoded by the security receive workers" },
+    { "cyclonedds_secrecv_bytes", OMT_COUNTER, "bytes", "Bytes decoded by the security receive workers" },
+    { "cyclonedds_secrecv_queued_seconds", OMT_COUNTER, "seconds", "Time packets spent queued for the security receive workers" },
+    { "cyclonedds_secrecv_process_seconds", OMT_COUNTER, "seconds", "Time spent decoding in the security receive workers" },
+    { "cyclonedds_secrecv_queue_max", OMT_GAUGE, NULL, "Maximum security receive worker queue length" }
+  };
+  uint64_t packets, bytes, time_queued, time_process;
+  uint32_t queue_max;
+  ddsi_get_secrecv_stats (st->gv, &packets, &bytes, &time_queued, &time_process, &queue_max);
+  const double secrecv[] = { (double) packets, (double) bytes, (double) time_queued / 1e9, (double) time_process / 1e9, (double) queue_max };
+  for (size_t i = 0; i < sizeof (secrecv_desc) / sizeof (secrecv_desc[0]); i++)
+  {
+    om_family (st, &secrecv_desc[i]);
+    om_sample (st, &secrecv_desc[i], NULL, secrecv[i]);
+  }
+
+  if (st->gv->config.stage_latency_statistics)
+  {
+    const struct { const char *stage; const struct ddsi_lathist *h; } stages[] = {
+      { "xpack", st->gv->lathist_xpack },
+      { "send", st->gv->lathist_send },
+      { "recv", st->gv->lathist_recv },
+      { "dqueue", st->gv->lathist_dqueue }
+    };
+    cpf (st, "# TYPE cyclonedds_stage_latency_seconds summary\n# UNIT cyclonedds_stage_latency_seconds seconds\n# HELP cyclonedds_stage_latency_seconds Time spent in data path stages\n");
+    for (size_t i = 0; i < sizeof (stages) / sizeof (stages[0]); i++)
+    {
+      if (stages[i].h == NULL)
+        continue;
+      struct ddsi_lathist_summary s;
+      char labels[32];
+      ddsi_lathist_summarize (stages[i].h, &s);
+      (void) snprintf (labels, sizeof (labels), "stage=\"%s\"", stages[i].stage);
+      om_summary (st, "cyclonedds_stage_latency_seconds", labels, &s, NULL);
+    }
+  }
+}
+
+static void om_queues (struct st *st)
+{
+  static const struct om_desc xevq_desc[] = {
+    { "cyclonedds_xevent_timed_events", OMT_GAUGE, NULL, "Timed events scheduled" },
+    { "cyclonedds_xevent_queued_messages", OMT_GAUGE, NULL, "Messages and other untimed events queued" },
+    { "cyclonedds_xevent_queued_rexmit_bytes", OMT_GAUGE, "bytes", "Bytes queued for retransmission" },
+    { "cyclonedds_xevent_queued_rexmit_messages", OMT_GAUGE, NULL, "Retransmit messages queued" }
+  };
+  struct ddsi_xeventq_stats xst;
+  ddsi_xeventq_get_stats (st->gv->xevents, &xst);
+  const double xevq[] = { (double) xst.n_timed, (double) xst.n_nontimed, (double) xst.queued_rexmit_bytes, (double) xst.queued_rexmit_msgs };
+  for (size_t i = 0; i < sizeof (xevq_desc) / sizeof (xevq_desc[0]); i++)
+  {
+    om_family (st, &xevq_desc[i]);
+    om_sample (st, &xevq_desc[i], NULL, xevq[i]);
+  }
+  if (st->gv->config.stage_latency_statistics)
+  {
+    cpf (st, "# TYPE cyclonedds_xevent_lateness_seconds summary\n# UNIT cyclonedds_xevent_lateness_seconds seconds\n# HELP cyclonedds_xevent_lateness_seconds Delay between scheduled and actual execution of timed events\n");
+    om_summary (st, "cyclonedds_xevent_lateness_seconds", NULL, &xst.lateness, &xst.lateness_sum);
+  }
+
+  static const struct om_desc dq_desc[] = {
+    { "cyclonedds_dqueue_samples", OMT_GAUGE, NULL, "Samples in the delivery queue" },
+    { "cyclonedds_dqueue_max_samples", OMT_GAUGE, NULL, "Delivery queue capacity" }
+  };
+  struct ddsi_dqueue_stats dqst[2];
+  ddsi_dqueue_get_stats (st->gv->builtins_dqueue, &dqst[0]);
+  ddsi_dqueue_get_stats (st->gv->user_dqueue, &dqst[1]);
+  for (size_t i = 0; i < sizeof (dq_desc) / sizeof (dq_desc[0]); i++)
+  {
+    om_family (st, &dq_desc[i]);
+    for (size_t j = 0; j < sizeof (dqst) / sizeof (dqst[0]); j++)
+    {
+      char labels[64];
+      (void) snprintf (labels, sizeof (labels), "queue=\"%s\"", dqst[j].name);
+      om_sample (st, &dq_desc[i], labels, (i == 0) ? dqst[j].nof_samples : dqst[j].max_samples);
+    }
+  }
+
+  static const struct om_desc rbp_desc[] = {
+    { "cyclonedds_rbufpool_buffers", OMT_GAUGE, NULL, "Receive buffers in use" },
+    { "cyclonedds_rbufpool_bytes", OMT_GAUGE, "bytes", "Memory held in receive buffers" },
+    { "cyclonedds_rbufpool_allocations", OMT_COUNTER, NULL, "Receive buffers allocated" }
+  };
+  struct ddsi_rbufpool_stats rbpst[MAX_RECV_THREADS];
+  for (uint32_t j = 0; j < st->gv->n_recv_threads; j++)
+    ddsi_rbufpool_get_stats (st->gv->recv_threads[j].arg.rbpool, &rbpst[j]);
+  for (size_t i = 0; i < sizeof (rbp_desc) / sizeof (rbp_desc[0]); i++)
+  {
+    om_family (st, &rbp_desc[i]);
+    for (uint32_t j = 0; j < st->gv->n_recv_threads; j++)
+    {
+      const double v[] = { rbpst[j].n_rbufs, (double) rbpst[j].n_rbufs * rbpst[j].rbuf_size, rbpst[j].n_allocs };
+      char labels[64];
+      (void) snprintf (labels, sizeof (labels), "thread=\"%s\"", st->gv->recv_threads[j].name);
+      om_sample (st, &rbp_desc[i], labels, v[i]);
+    }
+  }
+
+  const enum ddsi_transport_selector ts = st->gv->config.transport_selector;
+  if ((ts == DDSI_TRANS_TCP || ts == DDSI_TRANS_TCP6) && st->gv->config.tcp_sendq_size > 0)
+  {
+    static const struct om_desc tcp_desc[] = {
+      { "cyclonedds_tcp_sendq_queued_bytes", OMT_GAUGE, "bytes", "Bytes in the TCP send queue" },
+      { "cyclonedds_tcp_sendq_dropped", OMT_COUNTER, NULL, "Messages dropped from the TCP send queue" },
+      { "cyclonedds_tcp_sendq_blocked", OMT_COUNTER, NULL, "Times a sender blocked on a full TCP send queue" }
+    };
+    struct ddsi_tcp_sendq_stats *stats;
+    const size_t n = ddsi_tcp_get_sendq_stats (st->gv->m_factory, &stats);
+    for (size_t i = 0; i < sizeof (tcp_desc) / sizeof (tcp_desc[0]); i++)
+    {
+      om_family (st, &tcp_desc[i]);
+      for (size_t j = 0; j < n; j++)
+      {
+        const double v[] = { (double) stats[j].queued, (double) stats[j].dropped, (double) stats[j].blocked };
+        char buf[DDSI_LOCSTRLEN], labels[DDSI_LOCSTRLEN + 16];
+        (void) snprintf (labels, sizeof (labels), "peer=\"%s\"", ddsi_locator_to_string (buf, sizeof (buf), &stats[j].peer));
+        om_sample (st, &tcp_desc[i], labels, v[i]);
+      }
+    }
+    ddsrt_free (stats);
+  }
+
+  if (st->gv->pcap)
+  {
+    static const struct om_desc pcap_desc[] = {
+      { "cyclonedds_pcap_written_records", OMT_COUNTER, NULL, "Packets written to the packet capture file" },
+      { "cyclonedds_pcap_dropped_records", OMT_COUNTER, NULL, "Packets dropped from the packet capture because of full buffers" }
+    };
+    struct ddsi_pcap_stats pst;
+    ddsi_pcap_get_stats (st->gv->pcap, &pst);
+    const double v[] = { (double) pst.written, (double) pst.dropped };
+    for (size_t i = 0; i < sizeof (pcap_desc) / sizeof (pcap_desc[0]); i++)
+    {
+      om_family (st, &pcap_desc[i]);
+      om_sample (st, &pcap_desc[i], NULL, v[i]);
+    }
+  }
+}
+
+#if DDSRT_HAVE_RUSAGE && DDSRT_HAVE_THREAD_LIST
+struct om_thread_cpu {
+  char name[32];
+  double user, sys;
+};
+
+static void om_threads (struct st *st)
+{
+  static const struct om_desc desc = { "cyclonedds_thread_cpu_seconds", OMT_COUNTER, "seconds", "CPU time used by threads in this process, summed by thread name" };
+  ddsrt_thread_list_id_t tids[256];
+  struct om_thread_cpu cpu[256];
+  dds_return_t n;
+  uint32_t ncpu = 0;
+  if ((n = ddsrt_thread_list (tids, sizeof (tids) / sizeof (tids[0]))) <= 0)
+    return;
+  if (n > (dds_return_t) (sizeof (tids) / sizeof (tids[0])))
+    n = (dds_return_t) (sizeof (tids) / sizeof (tids[0]));
+  for (dds_return_t i = 0; i < n; i++)
+  {
+    ddsrt_rusage_t usage;
+    char name[32];
+    uint32_t k;
+    if (ddsrt_getrusage_anythread (tids[i], &usage) < 0)
+      continue;
+    if (ddsrt_thread_getname_anythread (tids[i], name, sizeof (name)) < 0)
+      continue;
+    // threads with the same name (e.g., those of multiple domains or an
+    // application's thread pool) are aggregated to keep the series unique
+    for (k = 0; k < ncpu && strcmp (cpu[k].name, name) != 0; k++)
+      ;
+    if (k == ncpu)
+    {
+      (void) ddsrt_strlcpy (cpu[k].name, name, sizeof (cpu[k].name));
+      cpu[k].user = cpu[k].sys = 0.0;
+      ncpu++;
+    }
+    cpu[k].user += (double) usage.utime / 1e9;
+    cpu[k].sys += (double) usage.stime / 1e9;
+  }
+  om_family (st, &desc);
+  for (uint32_t k = 0; k < ncpu; k++)
+  {
+    char name[64], labels[128];
+    (void) om_escape (name, sizeof (name), cpu[k].name);
+    (void) snprintf (labels, sizeof (labels), "thread=\"%s\",mode=\"user\"", name);
+    om_sample (st, &desc, labels, cpu[k].user);
+    (void) snprintf (labels, sizeof (labels), "thread=\"%s\",mode=\"system\"", name);
+    om_sample (st, &desc, labels, cpu[k].sys);
+  }
+}
+#else
+static void om_threads (struct st *st)
+{
+  (void) st;
+}
+#endif
+
+static void print_metrics (struct st *st)
+{
+  om_endpoints (st);
+  om_domain (st);
+  om_queues (st);
+  om_threads (st);
+  cpf (st, "# EOF\n");
+}
+
+enum debmon_request {
+  DMR_JSON,     /* no request or any other path: the JSON dump of the entities */
+  DMR_METRICS   /* GET /metrics */
+};
+
+static enum debmon_request debmon_read_request (struct ddsi_tran_conn *conn)
+{
+  /* Clients that simply connect and read (e.g., netcat) don't send a request,
+     so only wait a short while for one and serve the JSON dump if none
+     arrives. Only the request line matters, anything else is drained when
+     closing the connection. */
+  ddsrt_socket_t const sock = ddsi_tran_handle (&conn->m_base);
+  const dds_time_t tend = dds_time () + DDS_SECS (1);
+  char buf[256];
+  size_t pos = 0;
+  while (pos < sizeof (buf) - 1 && memchr (buf, '\n', pos) == NULL)
+  {
+    const dds_time_t tnow = dds_time ();
+    fd_set fds;
+    ssize_t n;
+    if (tnow >= tend)
+      break;
+    FD_ZERO (&fds);
+    FD_SET (sock, &fds);
+    if (ddsrt_select (sock + 1, &fds, NULL, NULL, tend - tnow) <= 0)
+      break;
+    if (ddsrt_recv (sock, buf + pos, sizeof (buf) - 1 - pos, 0, &n) != DDS_RETCODE_OK || n <= 0)
+      break;
+    pos += (size_t) n;
+  }
+  buf[pos] = 0;
+  if (strncmp (buf, "GET ", 4) == 0)
+  {
+    const char *path = buf + 4;
+    const size_t len = strcspn (path, " ?\r\n");
+    if (len == 8 && strncmp (path, "/metrics", len) == 0)
+      return DMR_METRICS;
+  }
+  return DMR_JSON;
 }
 
 static void debmon_handle_connection (struct ddsi_debug_monitor *dm, struct ddsi_tran_conn * conn)
 {
   ddsi_locator_t loc;
-  const char *http_header = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n";
+  const enum debmon_request req = debmon_read_request (conn);
+  const char *http_header;
+  if (req == DMR_METRICS)
+    http_header = "HTTP/1.1 200 OK\r\nContent-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\nTransfer-Encoding: chunked\r\n";
+  else
+    http_header = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n";
 
   struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
   struct st st = {
@@ -646,7 +1211,10 @@ static void debmon_handle_connection (struct ddsi_debug_monitor *dm, struct ddsi
   }
 
   // Encode data
-  cpfobj (&st, print_domain, NULL);
+  if (req == DMR_METRICS)
+    print_metrics (&st);
+  else
+    cpfobj (&st, print_domain, NULL);
 
   // Last content chunk
   if (st.pos > 8)
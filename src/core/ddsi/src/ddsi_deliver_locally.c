@@ -14,6 +14,7 @@
 #include "dds/ddsrt/log.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/avl.h"
+#include "dds/ddsrt/threads.h"
 #include "dds/ddsi/ddsi_sertype.h"
 #include "dds/ddsi/ddsi_serdata.h"
 #include "dds/ddsi/ddsi_tkmap.h"
@@ -58,10 +59,68 @@ static int cmp_type_ptrs (const void *va, const void *vb)
 
 static const ddsrt_avl_treedef_t tsc_large_td = DDSRT_AVL_TREEDEF_INITIALIZER_INDKEY (offsetof (struct type_sample_cache_large_entry, avlnode), offsetof (struct type_sample_cache_large_entry, type), cmp_type_ptrs, 0);
 
+/* Deserialized copy of a payload, created on demand by the first reader that
+   needs it (for a content filter) and shared by all readers receiving that
+   payload.  It lives on the stack of the delivering thread and is discarded
+   when the payload is, so it never outlives the delivery.  Deliveries can be
+   nested (e.g., a listener writing), hence the link to the outer one. */
+struct deliver_sample {
+  const struct ddsi_serdata *payload; /* NULL if no deserialized copy */
+  void *sample;
+  bool valid;
+};
+
+static ddsrt_thread_local struct deliver_sample *deliver_sample_current;
+
+static struct deliver_sample *deliver_sample_begin (struct deliver_sample *ds)
+{
+  struct deliver_sample * const outer = deliver_sample_current;
+  ds->payload = NULL;
+  deliver_sample_current = ds;
+  return outer;
+}
+
+static void deliver_sample_end (struct deliver_sample *ds, struct deliver_sample *outer)
+{
+  assert (deliver_sample_current == ds && ds->payload == NULL);
+  (void) ds;
+  deliver_sample_current = outer;
+}
+
+static void deliver_sample_drop (const struct ddsi_serdata *payload)
+{
+  struct deliver_sample * const ds = deliver_sample_current;
+  if (ds && ds->payload == payload)
+  {
+    ddsi_sertype_free_sample (payload->type, ds->sample, DDS_FREE_ALL);
+    ds->payload = NULL;
+  }
+}
+
+const void *ddsi_deliver_locally_sample (const struct ddsi_serdata *payload, bool *valid)
+{
+  struct deliver_sample * const ds = deliver_sample_current;
+  if (ds == NULL)
+    return NULL;
+  if (ds->payload != payload)
+  {
+    // the previous one is no longer needed if the payload changes: readers
+    // get the payloads one after the other
+    if (ds->payload)
+      deliver_sample_drop (ds->payload);
+    ds->sample = ddsi_sertype_alloc_sample (payload->type);
+    ds->valid = ddsi_serdata_to_sample (payload, ds->sample, NULL, NULL);
+    ds->payload = payload;
+  }
+  *valid = ds->valid;
+  return ds->sample;
+}
+
 static void free_sample_after_store (struct ddsi_domaingv *gv, struct ddsi_serdata *sample, struct ddsi_tkmap_instance *tk)
 {
   if (sample)
   {
+    deliver_sample_drop (sample);
     ddsi_tkmap_instance_unref (gv->m_tkmap, tk);
     ddsi_serdata_unref (sample);
   }
@@ -142,6 +201,7 @@ dds_return_t ddsi_deliver_locally_one (struct ddsi_domaingv *gv, struct ddsi_ent
   struct ddsi_tkmap_instance *tk;
   if ((payload = ops->makesample (&tk, gv, rd->type, vsourceinfo)) != NULL)
   {
+    struct deliver_sample ds, * const outer = deliver_sample_begin (&ds);
     EETRACE (source_entity, " =>"PGUIDFMT"\n", PGUID (*rdguid));
     /* FIXME: why look up rd,pwr again? Their states remains valid while the thread stays
        "awake" (although a delete can be initiated), and blocking like this is a stopgap
@@ -161,6 +221,7 @@ dds_return_t ddsi_deliver_locally_one (struct ddsi_domaingv *gv, struct ddsi_ent
       }
     }
     free_sample_after_store (gv, payload, tk);
+    deliver_sample_end (&ds, outer);
   }
   return DDS_RETCODE_OK;
 }
@@ -245,6 +306,7 @@ static dds_return_t deliver_locally_fastpath (struct ddsi_domaingv *gv, struct d
 
 dds_return_t ddsi_deliver_locally_allinsync (struct ddsi_domaingv *gv, struct ddsi_entity_common *source_entity, bool source_entity_locked, struct ddsi_local_reader_ary *fastpath_rdary, const struct ddsi_writer_info *wrinfo, const struct ddsi_deliver_locally_ops *ops, void *vsourceinfo)
 {
+  struct deliver_sample ds, * const outer = deliver_sample_begin (&ds);
   dds_return_t rc;
   /* FIXME: Retry loop for re-delivery of rejected reliable samples is a bad hack
      should instead throttle back the writer by skipping acknowledgement and retry */
@@ -265,5 +327,6 @@ dds_return_t ddsi_deliver_locally_allinsync (struct ddsi_domaingv *gv, struct dd
       rc = deliver_locally_slowpath (gv, source_entity, source_entity_locked, wrinfo, ops, vsourceinfo);
     }
   } while (rc == DDS_RETCODE_TRY_AGAIN);
+  deliver_sample_end (&ds, outer);
   return rc;
 }
@@ -177,6 +177,14 @@ static int sedp_write_endpoint_impl
         ps.present |= PP_CYCLONE_REQUESTS_KEYHASH;
         ps.cyclone_requests_keyhash = 1u;
       }
+      if (rd->content_filter)
+      {
+        // a copy because the plist always owns the buffers of generic sequences
+        struct ddsi_content_filter_property *cfp = ddsi_content_filter_property_dup (rd->content_filter);
+        ps.present |= PP_CONTENT_FILTER_PROPERTY;
+        ps.content_filter_property = *cfp;
+        ddsrt_free (cfp);
+      }
     }
 
 #ifdef DDSRT_HAVE_SSM
@@ -532,7 +540,7 @@ void ddsi_handle_sedp_alive_endpoint (const struct ddsi_receiver_state *rst, dds
     else
     {
       if (prd)
-        ddsi_update_proxy_reader (prd, seq, as, xqos, timestamp);
+        ddsi_update_proxy_reader (prd, seq, as, xqos, (datap->present & PP_CONTENT_FILTER_PROPERTY) ? &datap->content_filter_property : NULL, timestamp);
       else
       {
         struct ddsi_proxy_reader *proxy_reader;
@@ -0,0 +1,816 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <string.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/log.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/cdtors.h"
+#include "dds/ddsrt/fibheap.h"
+#include "dds/ddsrt/random.h"
+#include "dds/ddsrt/mh3.h"
+#include "dds/ddsrt/io.h"
+#include "dds/ddsi/ddsi_log.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "ddsi__tran.h"
+#include "ddsi__emu.h"
+
+#if !defined _WIN32 && !defined(LWIP_SOCKET) && !defined __ZEPHYR__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* The emulated network is a process-wide "switch" to which every domain that
+   uses the "emu" transport is attached as a node.  Nodes are numbered in the
+   order in which they attach, and a unicast locator is simply the node number
+   in the last 4 bytes of the address.  Multicast locators have 0xff as the
+   first byte and a group number in the last 4 bytes.
+
+   Each connection has a queue of received packets and a pipe containing one
+   byte for each packet in that queue, so that the regular receive threads
+   and socket waitsets can be used.  Sending a packet runs it through the
+   sending node's impairment model (loss, latency, jitter, reordering and
+   bandwidth).  The random choices are drawn from a PRNG per node and sending
+   thread, seeded from the configuration, the node number and the thread name,
+   so that the fate of the packets sent by a thread doesn't depend on how it
+   is scheduled relative to the other threads.  Packets that need not be delayed are delivered
+   immediately; the others are held in a priority queue ordered on delivery
+   time by a delivery thread.  There is one switch lock protecting
+   everything. */
+
+#define EMU_MC_MARKER 0xff
+#define EMU_FIRST_EPHEMERAL_PORT 49152u
+#define EMU_MAX_GROUPS 8
+
+struct emu_switch;
+
+struct emu_packet {
+  ddsrt_fibheap_node_t fhnode;
+  struct emu_packet *next;
+  ddsrt_mtime_t tdeliver;
+  uint64_t seq;
+  ddsi_locator_t src;
+  ddsi_locator_t dst;
+  size_t size;
+  unsigned char data[];
+};
+
+typedef struct ddsi_emu_conn {
+  struct ddsi_tran_conn m_base;
+  struct ddsi_emu_conn *next; // in switch's list of connections
+  uint32_t m_node;
+  int m_pipe[2];
+  uint32_t m_ngroups;
+  uint32_t m_groups[EMU_MAX_GROUPS];
+  struct emu_packet *rx_first, *rx_last;
+} *ddsi_emu_conn_t;
+
+/* Random state of a thread sending via a node, protected by switch lock */
+struct emu_sender {
+  struct emu_sender *next;
+  ddsrt_thread_t tid;
+  ddsrt_prng_t prng;
+  bool in_loss_burst;
+};
+
+typedef struct ddsi_emu_tran_factory {
+  struct ddsi_tran_factory m_base;
+  struct emu_switch *m_switch;
+  uint32_t m_node;
+
+  // impairment model, protected by switch lock
+  struct emu_sender *senders;
+  uint32_t loss_start_threshold;
+  uint32_t loss_end_threshold;
+  uint32_t reorder_threshold;
+  bool immediate;
+  ddsrt_mtime_t link_free;
+
+  // statistics, protected by switch lock
+  uint64_t n_sent, n_lost, n_overflow;
+} *ddsi_emu_tran_factory_t;
+
+struct emu_switch {
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  uint32_t refc;
+  uint32_t next_node;
+  uint32_t next_ephemeral_port;
+  uint64_t seq;
+  bool terminate;
+  ddsrt_thread_t tid;
+  struct ddsi_emu_conn *conns;
+  ddsrt_fibheap_t pending;
+};
+
+/* Protected by ddsrt_get_singleton_mutex () */
+static struct emu_switch *emu_switch;
+
+static int compare_packet (const void *va, const void *vb)
+{
+  const struct emu_packet *a = va;
+  const struct emu_packet *b = vb;
+  if (a->tdeliver.v != b->tdeliver.v)
+    return (a->tdeliver.v < b->tdeliver.v) ? -1 : 1;
+  return (a->seq == b->seq) ? 0 : (a->seq < b->seq) ? -1 : 1;
+}
+
+static const ddsrt_fibheap_def_t emu_pending_fhdef = DDSRT_FIBHEAPDEF_INITIALIZER (offsetof (struct emu_packet, fhnode), compare_packet);
+
+static bool emu_is_mcaddr (const ddsi_locator_t *loc)
+{
+  return loc->address[0] == EMU_MC_MARKER;
+}
+
+static uint32_t emu_addr_id (const ddsi_locator_t *loc)
+{
+  return ((uint32_t) loc->address[12] << 24) | ((uint32_t) loc->address[13] << 16) | ((uint32_t) loc->address[14] << 8) | loc->address[15];
+}
+
+static void emu_set_addr (ddsi_locator_t *loc, bool mc, uint32_t id)
+{
+  loc->kind = DDSI_LOCATOR_KIND_EMU;
+  memset (loc->address, 0, sizeof (loc->address));
+  if (mc)
+    loc->address[0] = EMU_MC_MARKER;
+  loc->address[12] = (unsigned char) (id >> 24);
+  loc->address[13] = (unsigned char) (id >> 16);
+  loc->address[14] = (unsigned char) (id >> 8);
+  loc->address[15] = (unsigned char) id;
+}
+
+static bool conn_is_member (const struct ddsi_emu_conn *conn, uint32_t group)
+{
+  for (uint32_t i = 0; i < conn->m_ngroups; i++)
+    if (conn->m_groups[i] == group)
+      return true;
+  return false;
+}
+
+static void enqueue_rx_locked (struct ddsi_emu_conn *conn, struct emu_packet *pkt)
+{
+  const char dummy = 0;
+  ssize_t n;
+  do {
+    n = write (conn->m_pipe[1], &dummy, 1);
+  } while (n < 0 && errno == EINTR);
+  if (n != 1)
+  {
+    // pipe full: behave like a socket with a full receive buffer
+    ddsi_emu_tran_factory_t fact = (ddsi_emu_tran_factory_t) conn->m_base.m_factory;
+    fact->n_overflow++;
+    ddsrt_free (pkt);
+    return;
+  }
+  pkt->next = NULL;
+  if (conn->rx_first == NULL)
+    conn->rx_first = pkt;
+  else
+    conn->rx_last->next = pkt;
+  conn->rx_last = pkt;
+}
+
+static struct emu_packet *dup_packet (const struct emu_packet *pkt)
+{
+  struct emu_packet *copy = ddsrt_malloc (sizeof (*copy) + pkt->size);
+  memcpy (copy, pkt, sizeof (*copy) + pkt->size);
+  return copy;
+}
+
+static void deliver_locked (struct emu_switch *sw, struct emu_packet *pkt)
+{
+  const uint32_t id = emu_addr_id (&pkt->dst);
+  if (!emu_is_mcaddr (&pkt->dst))
+  {
+    for (struct ddsi_emu_conn *conn = sw->conns; conn; conn = conn->next)
+    {
+      if (conn->m_node == id && conn->m_base.m_base.m_port == pkt->dst.port)
+      {
+        enqueue_rx_locked (conn, pkt);
+        return;
+      }
+    }
+  }
+  else
+  {
+    struct ddsi_emu_conn *prev = NULL;
+    for (struct ddsi_emu_conn *conn = sw->conns; conn; conn = conn->next)
+    {
+      if (conn->m_base.m_base.m_port == pkt->dst.port && conn_is_member (conn, id))
+      {
+        if (prev)
+          enqueue_rx_locked (prev, dup_packet (pkt));
+        prev = conn;
+      }
+    }
+    if (prev)
+    {
+      enqueue_rx_locked (prev, pkt);
+      return;
+    }
+  }
+  ddsrt_free (pkt);
+}
+
+static uint32_t emu_switch_thread (void *varg)
+{
+  struct emu_switch * const sw = varg;
+  ddsrt_mutex_lock (&sw->lock);
+  while (!sw->terminate)
+  {
+    struct emu_packet *pkt = ddsrt_fibheap_min (&emu_pending_fhdef, &sw->pending);
+    const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+    if (pkt == NULL)
+      ddsrt_cond_wait (&sw->cond, &sw->lock);
+    else if (pkt->tdeliver.v > tnow.v)
+      (void) ddsrt_cond_waitfor (&sw->cond, &sw->lock, pkt->tdeliver.v - tnow.v);
+    else
+    {
+      (void) ddsrt_fibheap_extract_min (&emu_pending_fhdef, &sw->pending);
+      deliver_locked (sw, pkt);
+    }
+  }
+  ddsrt_mutex_unlock (&sw->lock);
+  return 0;
+}
+
+static struct emu_switch *emu_switch_ref (void)
+{
+  struct emu_switch *sw;
+  ddsrt_mutex_lock (ddsrt_get_singleton_mutex ());
+  if ((sw = emu_switch) != NULL)
+    sw->refc++;
+  else
+  {
+    ddsrt_threadattr_t tattr;
+    sw = ddsrt_malloc (sizeof (*sw));
+    ddsrt_mutex_init (&sw->lock);
+    ddsrt_cond_init (&sw->cond);
+    sw->refc = 1;
+    sw->next_node = 1;
+    sw->next_ephemeral_port = EMU_FIRST_EPHEMERAL_PORT;
+    sw->seq = 0;
+    sw->terminate = false;
+    sw->conns = NULL;
+    ddsrt_fibheap_init (&emu_pending_fhdef, &sw->pending);
+    ddsrt_threadattr_init (&tattr);
+    if (ddsrt_thread_create (&sw->tid, "emunet", &tattr, emu_switch_thread, sw) != DDS_RETCODE_OK)
+    {
+      ddsrt_cond_destroy (&sw->cond);
+      ddsrt_mutex_destroy (&sw->lock);
+      ddsrt_free (sw);
+      sw = NULL;
+    }
+    emu_switch = sw;
+  }
+  ddsrt_mutex_unlock (ddsrt_get_singleton_mutex ());
+  return sw;
+}
+
+static void emu_switch_unref (void)
+{
+  struct emu_switch *sw = NULL;
+  ddsrt_mutex_lock (ddsrt_get_singleton_mutex ());
+  assert (emu_switch != NULL && emu_switch->refc > 0);
+  if (--emu_switch->refc == 0)
+  {
+    sw = emu_switch;
+    emu_switch = NULL;
+  }
+  ddsrt_mutex_unlock (ddsrt_get_singleton_mutex ());
+  if (sw == NULL)
+    return;
+
+  ddsrt_mutex_lock (&sw->lock);
+  sw->terminate = true;
+  ddsrt_cond_broadcast (&sw->cond);
+  ddsrt_mutex_unlock (&sw->lock);
+  (void) ddsrt_thread_join (sw->tid, NULL);
+  assert (sw->conns == NULL);
+  struct emu_packet *pkt;
+  while ((pkt = ddsrt_fibheap_extract_min (&emu_pending_fhdef, &sw->pending)) != NULL)
+    ddsrt_free (pkt);
+  ddsrt_cond_destroy (&sw->cond);
+  ddsrt_mutex_destroy (&sw->lock);
+  ddsrt_free (sw);
+}
+
+static uint32_t prob_threshold (double p)
+{
+  if (p <= 0.0)
+    return 0;
+  else if (p >= 1.0)
+    return UINT32_MAX;
+  else
+    return (uint32_t) (p * 4294967296.0);
+}
+
+static struct emu_sender *emu_get_sender_locked (ddsi_emu_tran_factory_t fact)
+{
+  const ddsrt_thread_t self = ddsrt_thread_self ();
+  struct emu_sender *snd;
+  for (snd = fact->senders; snd; snd = snd->next)
+    if (ddsrt_thread_equal (snd->tid, self))
+      return snd;
+  char name[64];
+  (void) ddsrt_thread_getname (name, sizeof (name));
+  const uint32_t seed = fact->m_base.gv->config.emu_seed ^ (fact->m_node * 0x9e3779b9u) ^ ddsrt_mh3 (name, strlen (name), 0);
+  snd = ddsrt_malloc (sizeof (*snd));
+  snd->tid = self;
+  ddsrt_prng_init_simple (&snd->prng, seed);
+  snd->in_loss_burst = false;
+  snd->next = fact->senders;
+  fact->senders = snd;
+  return snd;
+}
+
+static bool emu_lose_packet (ddsi_emu_tran_factory_t fact, struct emu_sender *snd)
+{
+  /* Gilbert model: a burst of losses starts with some probability for each
+     packet, and continues for a geometrically distributed number of packets
+     with the configured mean length */
+  if (snd->in_loss_burst)
+  {
+    if (ddsrt_prng_random (&snd->prng) < fact->loss_end_threshold)
+      snd->in_loss_burst = false;
+    return snd->in_loss_burst;
+  }
+  else if (fact->loss_start_threshold && ddsrt_prng_random (&snd->prng) < fact->loss_start_threshold)
+  {
+    snd->in_loss_burst = (fact->loss_end_threshold < UINT32_MAX);
+    return true;
+  }
+  return false;
+}
+
+static void emu_send_locked (struct emu_switch *sw, ddsi_emu_tran_factory_t fact, struct emu_packet *pkt)
+{
+  const struct ddsi_config * const cfg = &fact->m_base.gv->config;
+  struct emu_sender * const snd = emu_get_sender_locked (fact);
+  fact->n_sent++;
+  if (emu_lose_packet (fact, snd))
+  {
+    fact->n_lost++;
+    ddsrt_free (pkt);
+    return;
+  }
+  if (fact->immediate)
+  {
+    deliver_locked (sw, pkt);
+    return;
+  }
+
+  const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  ddsrt_mtime_t tsent = tnow;
+  if (cfg->emu_bandwidth > 0)
+  {
+    const int64_t txtime = (int64_t) ((uint64_t) pkt->size * (uint64_t) DDS_NSECS_IN_SEC / cfg->emu_bandwidth);
+    if (fact->link_free.v < tnow.v)
+      fact->link_free = tnow;
+    else if (fact->link_free.v - tnow.v > DDS_SECS (1))
+    {
+      // a second worth of data queued up: drop it at the tail
+      fact->n_overflow++;
+      ddsrt_free (pkt);
+      return;
+    }
+    fact->link_free.v += txtime;
+    tsent = fact->link_free;
+  }
+  int64_t delay = cfg->emu_latency;
+  if (cfg->emu_jitter > 0)
+    delay += (int64_t) (((uint64_t) ddsrt_prng_random (&snd->prng) * (uint64_t) cfg->emu_jitter) >> 32);
+  if (fact->reorder_threshold && ddsrt_prng_random (&snd->prng) < fact->reorder_threshold)
+    delay += cfg->emu_reorder_delay;
+  pkt->tdeliver.v = tsent.v + delay;
+  pkt->seq = sw->seq++;
+
+  const struct emu_packet *min = ddsrt_fibheap_min (&emu_pending_fhdef, &sw->pending);
+  ddsrt_fibheap_insert (&emu_pending_fhdef, &sw->pending, pkt);
+  if (min == NULL || pkt->tdeliver.v < min->tdeliver.v)
+    ddsrt_cond_broadcast (&sw->cond);
+}
+
+static char *ddsi_emu_to_string (char *dst, size_t sizeof_dst, const ddsi_locator_t *loc, struct ddsi_tran_conn * conn, int with_port)
+{
+  (void) conn;
+  const char *prefix = emu_is_mcaddr (loc) ? "mc" : "";
+  if (with_port)
+    (void) snprintf (dst, sizeof_dst, "%s%"PRIu32":%"PRIu32, prefix, emu_addr_id (loc), loc->port);
+  else
+    (void) snprintf (dst, sizeof_dst, "%s%"PRIu32, prefix, emu_addr_id (loc));
+  return dst;
+}
+
+static bool ddsi_emu_supports (const struct ddsi_tran_factory *fact, int32_t kind)
+{
+  (void) fact;
+  return (kind == DDSI_LOCATOR_KIND_EMU);
+}
+
+static ddsrt_socket_t ddsi_emu_conn_handle (struct ddsi_tran_base * base)
+{
+  return ((ddsi_emu_conn_t) base)->m_pipe[0];
+}
+
+static int ddsi_emu_conn_locator (struct ddsi_tran_factory * fact, struct ddsi_tran_base * base, ddsi_locator_t *loc)
+{
+  (void) fact;
+  ddsi_emu_conn_t conn = (ddsi_emu_conn_t) base;
+  emu_set_addr (loc, false, conn->m_node);
+  loc->port = conn->m_base.m_base.m_port;
+  return 0;
+}
+
+static ssize_t ddsi_emu_conn_read (struct ddsi_tran_conn * conn_cmn, unsigned char * buf, size_t len, bool allow_spurious, struct ddsi_network_packet_info *pktinfo)
+{
+  ddsi_emu_conn_t conn = (ddsi_emu_conn_t) conn_cmn;
+  struct emu_switch * const sw = ((ddsi_emu_tran_factory_t) conn_cmn->m_factory)->m_switch;
+  struct emu_packet *pkt;
+  char dummy;
+  ssize_t n;
+  (void) allow_spurious;
+  do {
+    n = read (conn->m_pipe[0], &dummy, 1);
+  } while (n < 0 && errno == EINTR);
+  if (n != 1)
+    return -1;
+
+  ddsrt_mutex_lock (&sw->lock);
+  if ((pkt = conn->rx_first) != NULL)
+  {
+    if ((conn->rx_first = pkt->next) == NULL)
+      conn->rx_last = NULL;
+  }
+  ddsrt_mutex_unlock (&sw->lock);
+  if (pkt == NULL)
+    return -1;
+
+  size_t sz = pkt->size;
+  if (sz > len)
+  {
+    char addrbuf[DDSI_LOCSTRLEN];
+    ddsi_locator_to_string (addrbuf, sizeof (addrbuf), &pkt->src);
+    DDS_CWARNING (&conn_cmn->m_base.gv->logconfig, "%s => %"PRIuSIZE" truncated to %"PRIuSIZE"\n", addrbuf, sz, len);
+    sz = len;
+  }
+  memcpy (buf, pkt->data, sz);
+  if (pktinfo)
+  {
+    pktinfo->src = pkt->src;
+    pktinfo->dst.kind = DDSI_LOCATOR_KIND_INVALID;
+    pktinfo->if_index = 0;
+  }
+  ddsrt_free (pkt);
+  return (ssize_t) sz;
+}
+
+static ssize_t ddsi_emu_conn_write (struct ddsi_tran_conn * conn_cmn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags)
+{
+  ddsi_emu_conn_t conn = (ddsi_emu_conn_t) conn_cmn;
+  ddsi_emu_tran_factory_t fact = (ddsi_emu_tran_factory_t) conn_cmn->m_factory;
+  struct emu_switch * const sw = fact->m_switch;
+  (void) flags;
+  size_t sz = 0;
+  for (size_t i = 0; i < msgfrags->niov; i++)
+    sz += msgfrags->iov[i].iov_len;
+  struct emu_packet *pkt = ddsrt_malloc (sizeof (*pkt) + sz);
+  size_t pos = 0;
+  for (size_t i = 0; i < msgfrags->niov; i++)
+  {
+    memcpy (pkt->data + pos, msgfrags->iov[i].iov_base, msgfrags->iov[i].iov_len);
+    pos += msgfrags->iov[i].iov_len;
+  }
+  pkt->size = sz;
+  (void) ddsi_emu_conn_locator (&fact->m_base, &conn->m_base.m_base, &pkt->src);
+  pkt->dst = *dst;
+  ddsrt_mutex_lock (&sw->lock);
+  emu_send_locked (sw, fact, pkt);
+  ddsrt_mutex_unlock (&sw->lock);
+  return (ssize_t) sz;
+}
+
+static bool port_in_use_locked (const struct emu_switch *sw, uint32_t node, uint32_t port)
+{
+  for (const struct ddsi_emu_conn *conn = sw->conns; conn; conn = conn->next)
+    if (conn->m_node == node && conn->m_base.m_base.m_port == port)
+      return true;
+  return false;
+}
+
+static dds_return_t ddsi_emu_create_conn (struct ddsi_tran_conn **conn_out, struct ddsi_tran_factory * fact_cmn, uint32_t port, const struct ddsi_tran_qos *qos)
+{
+  ddsi_emu_tran_factory_t fact = (ddsi_emu_tran_factory_t) fact_cmn;
+  struct ddsi_domaingv const * const gv = fact->m_base.gv;
+  struct ddsi_network_interface const * const intf = qos->m_interface ? qos->m_interface : &gv->interfaces[0];
+  struct emu_switch * const sw = fact->m_switch;
+  const bool mcast = (qos->m_purpose == DDSI_TRAN_QOS_RECV_MC);
+  int fds[2];
+
+  if (pipe (fds) == -1)
+  {
+    GVERROR ("ddsi_emu_create_conn: failed to create pipe (errno %d)\n", errno);
+    return DDS_RETCODE_ERROR;
+  }
+  (void) fcntl (fds[0], F_SETFD, fcntl (fds[0], F_GETFD) | FD_CLOEXEC);
+  (void) fcntl (fds[1], F_SETFD, fcntl (fds[1], F_GETFD) | FD_CLOEXEC);
+  (void) fcntl (fds[1], F_SETFL, fcntl (fds[1], F_GETFL) | O_NONBLOCK);
+
+  ddsrt_mutex_lock (&sw->lock);
+  if (port == DDSI_TRAN_RANDOM_PORT_NUMBER)
+  {
+    do {
+      port = sw->next_ephemeral_port++;
+      if (sw->next_ephemeral_port > 65535)
+        sw->next_ephemeral_port = EMU_FIRST_EPHEMERAL_PORT;
+    } while (port_in_use_locked (sw, fact->m_node, port));
+  }
+  else if (!mcast && port_in_use_locked (sw, fact->m_node, port))
+  {
+    // mimic the UDP transport's "address in use" so participant index selection works
+    ddsrt_mutex_unlock (&sw->lock);
+    close (fds[0]);
+    close (fds[1]);
+    return DDS_RETCODE_PRECONDITION_NOT_MET;
+  }
+
+  ddsi_emu_conn_t conn = ddsrt_malloc (sizeof (*conn));
+  memset (conn, 0, sizeof (*conn));
+  ddsi_factory_conn_init (&fact->m_base, intf, &conn->m_base);
+  conn->m_node = fact->m_node;
+  conn->m_pipe[0] = fds[0];
+  conn->m_pipe[1] = fds[1];
+  conn->m_base.m_base.m_port = port;
+  conn->m_base.m_base.m_trantype = DDSI_TRAN_CONN;
+  conn->m_base.m_base.m_multicast = mcast;
+  conn->m_base.m_base.m_handle_fn = ddsi_emu_conn_handle;
+  conn->m_base.m_locator_fn = ddsi_emu_conn_locator;
+  conn->m_base.m_read_fn = ddsi_emu_conn_read;
+  conn->m_base.m_write_fn = ddsi_emu_conn_write;
+  conn->m_base.m_disable_multiplexing_fn = 0;
+  conn->next = sw->conns;
+  sw->conns = conn;
+  ddsrt_mutex_unlock (&sw->lock);
+
+  GVTRACE ("ddsi_emu_create_conn %s node %"PRIu32" port %"PRIu32"\n", mcast ? "multicast" : "unicast", conn->m_node, port);
+  *conn_out = &conn->m_base;
+  return DDS_RETCODE_OK;
+}
+
+static void ddsi_emu_release_conn (struct ddsi_tran_conn * conn_cmn)
+{
+  ddsi_emu_conn_t conn = (ddsi_emu_conn_t) conn_cmn;
+  struct emu_switch * const sw = ((ddsi_emu_tran_factory_t) conn_cmn->m_factory)->m_switch;
+  DDS_CTRACE (&conn_cmn->m_base.gv->logconfig, "ddsi_emu_release_conn %s node %"PRIu32" port %"PRIu32"\n",
+              conn_cmn->m_base.m_multicast ? "multicast" : "unicast", conn->m_node, conn_cmn->m_base.m_port);
+  ddsrt_mutex_lock (&sw->lock);
+  struct ddsi_emu_conn **pp = &sw->conns;
+  while (*pp != conn)
+    pp = &(*pp)->next;
+  *pp = conn->next;
+  ddsrt_mutex_unlock (&sw->lock);
+  while (conn->rx_first)
+  {
+    struct emu_packet *pkt = conn->rx_first;
+    conn->rx_first = pkt->next;
+    ddsrt_free (pkt);
+  }
+  close (conn->m_pipe[0]);
+  close (conn->m_pipe[1]);
+  ddsrt_free (conn);
+}
+
+static int ddsi_emu_join_mc (struct ddsi_tran_conn * conn_cmn, const ddsi_locator_t *srcloc, const ddsi_locator_t *mcloc, const struct ddsi_network_interface *interf)
+{
+  ddsi_emu_conn_t conn = (ddsi_emu_conn_t) conn_cmn;
+  struct emu_switch * const sw = ((ddsi_emu_tran_factory_t) conn_cmn->m_factory)->m_switch;
+  const uint32_t group = emu_addr_id (mcloc);
+  int ret = 0;
+  (void) srcloc; (void) interf;
+  ddsrt_mutex_lock (&sw->lock);
+  if (conn_is_member (conn, group))
+    ;
+  else if (conn->m_ngroups == EMU_MAX_GROUPS)
+    ret = -1;
+  else
+    conn->m_groups[conn->m_ngroups++] = group;
+  ddsrt_mutex_unlock (&sw->lock);
+  return ret;
+}
+
+static int ddsi_emu_leave_mc (struct ddsi_tran_conn * conn_cmn, const ddsi_locator_t *srcloc, const ddsi_locator_t *mcloc, const struct ddsi_network_interface *interf)
+{
+  ddsi_emu_conn_t conn = (ddsi_emu_conn_t) conn_cmn;
+  struct emu_switch * const sw = ((ddsi_emu_tran_factory_t) conn_cmn->m_factory)->m_switch;
+  const uint32_t group = emu_addr_id (mcloc);
+  (void) srcloc; (void) interf;
+  ddsrt_mutex_lock (&sw->lock);
+  for (uint32_t i = 0; i < conn->m_ngroups; i++)
+  {
+    if (conn->m_groups[i] == group)
+    {
+      conn->m_groups[i] = conn->m_groups[--conn->m_ngroups];
+      break;
+    }
+  }
+  ddsrt_mutex_unlock (&sw->lock);
+  return 0;
+}
+
+static int ddsi_emu_is_loopbackaddr (const struct ddsi_tran_factory *tran, const ddsi_locator_t *loc)
+{
+  (void) tran;
+  (void) loc;
+  return 0;
+}
+
+static int ddsi_emu_is_mcaddr (const struct ddsi_tran_factory *tran, const ddsi_locator_t *loc)
+{
+  (void) tran;
+  assert (loc->kind == DDSI_LOCATOR_KIND_EMU);
+  return emu_is_mcaddr (loc);
+}
+
+static int ddsi_emu_is_ssm_mcaddr (const struct ddsi_tran_factory *tran, const ddsi_locator_t *loc)
+{
+  (void) tran;
+  (void) loc;
+  return 0;
+}
+
+static enum ddsi_nearby_address_result ddsi_emu_is_nearby_address (const ddsi_locator_t *loc, size_t ninterf, const struct ddsi_network_interface interf[], size_t *interf_idx)
+{
+  (void) ninterf;
+  if (interf_idx)
+    *interf_idx = 0;
+  if (memcmp (interf[0].loc.address, loc->address, sizeof (loc->address)) == 0)
+    return DNAR_SELF;
+  else
+    return DNAR_LOCAL;
+}
+
+static enum ddsi_locator_from_string_result ddsi_emu_address_from_string (const struct ddsi_tran_factory *tran, ddsi_locator_t *loc, const char *str)
+{
+  (void) tran;
+  bool mc = false;
+  uint32_t id, port = DDSI_LOCATOR_PORT_INVALID;
+  int pos;
+  if (strncmp (str, "mc", 2) == 0)
+  {
+    mc = true;
+    str += 2;
+  }
+  DDSRT_WARNING_MSVC_OFF(4996);
+  if (sscanf (str, "%"SCNu32"%n", &id, &pos) != 1)
+    return AFSR_INVALID;
+  str += pos;
+  if (*str == ':' && (sscanf (str, ":%"SCNu32"%n", &port, &pos) != 1 || port == 0))
+    return AFSR_INVALID;
+  DDSRT_WARNING_MSVC_ON(4996);
+  if (*str == ':')
+    str += pos;
+  if (*str != 0 || id == 0)
+    return AFSR_INVALID;
+  emu_set_addr (loc, mc, id);
+  loc->port = port;
+  return AFSR_OK;
+}
+
+static int ddsi_emu_enumerate_interfaces (struct ddsi_tran_factory * fact_cmn, enum ddsi_transport_selector transport_selector, ddsrt_ifaddrs_t **ifs)
+{
+  ddsi_emu_tran_factory_t fact = (ddsi_emu_tran_factory_t) fact_cmn;
+  (void) transport_selector;
+  *ifs = ddsrt_malloc (sizeof (**ifs));
+  (*ifs)->next = NULL;
+  (*ifs)->type = DDSRT_IFTYPE_UNKNOWN;
+  (*ifs)->name = ddsrt_strdup (fact->m_base.m_typename);
+  (*ifs)->index = 0;
+  (*ifs)->flags = IFF_UP | IFF_MULTICAST;
+  (*ifs)->addr = ddsrt_malloc (sizeof (struct sockaddr_storage));
+  memset ((*ifs)->addr, 0, sizeof (struct sockaddr_storage));
+  // node id stored after the address family, see ddsi_emu_locator_from_sockaddr
+  memcpy ((char *) (*ifs)->addr + sizeof ((*ifs)->addr->sa_family), &fact->m_node, sizeof (fact->m_node));
+  (*ifs)->netmask = NULL;
+  (*ifs)->broadaddr = NULL;
+  return 0;
+}
+
+static int ddsi_emu_is_valid_port (const struct ddsi_tran_factory *fact, uint32_t port)
+{
+  (void) fact;
+  return (port >= 1 && port <= 65535);
+}
+
+static uint32_t ddsi_emu_receive_buffer_size (const struct ddsi_tran_factory *fact)
+{
+  (void) fact;
+  return 0;
+}
+
+static int ddsi_emu_locator_from_sockaddr (const struct ddsi_tran_factory *tran, ddsi_locator_t *loc, const struct sockaddr *sockaddr)
+{
+  (void) tran;
+  uint32_t node;
+  if (sockaddr->sa_family != AF_UNSPEC)
+    return -1;
+  memcpy (&node, (const char *) sockaddr + sizeof (sockaddr->sa_family), sizeof (node));
+  emu_set_addr (loc, false, node);
+  loc->port = DDSI_LOCATOR_PORT_INVALID;
+  return 0;
+}
+
+static void ddsi_emu_deinit (struct ddsi_tran_factory * fact_cmn)
+{
+  ddsi_emu_tran_factory_t fact = (ddsi_emu_tran_factory_t) fact_cmn;
+  DDS_CLOG (DDS_LC_CONFIG, &fact_cmn->gv->logconfig, "emu node %"PRIu32" de-initialized: sent %"PRIu64" lost %"PRIu64" overflow %"PRIu64"\n",
+            fact->m_node, fact->n_sent, fact->n_lost, fact->n_overflow);
+  while (fact->senders)
+  {
+    struct emu_sender * const snd = fact->senders;
+    fact->senders = snd->next;
+    ddsrt_free (snd);
+  }
+  ddsrt_free (fact);
+  emu_switch_unref ();
+}
+
+int ddsi_emu_init (struct ddsi_domaingv *gv)
+{
+  const struct ddsi_config * const cfg = &gv->config;
+  if (cfg->emu_loss > 1000 || cfg->emu_reorder > 1000)
+  {
+    GVERROR ("emu: Loss and Reordering must be at most 1000 (per thousand)\n");
+    return -1;
+  }
+
+  struct emu_switch *sw;
+  if ((sw = emu_switch_ref ()) == NULL)
+  {
+    GVERROR ("emu: failed to start emulated network\n");
+    return -1;
+  }
+
+  ddsi_emu_tran_factory_t fact = ddsrt_malloc (sizeof (*fact));
+  memset (fact, 0, sizeof (*fact));
+  fact->m_switch = sw;
+  ddsrt_mutex_lock (&sw->lock);
+  fact->m_node = sw->next_node++;
+  ddsrt_mutex_unlock (&sw->lock);
+
+  /* Expected loss fraction is L / (L + 1/p_start) for a mean burst length of
+     L, solve for the probability of a burst starting */
+  const double loss = cfg->emu_loss / 1e3, burst = cfg->emu_loss_burst;
+  fact->loss_start_threshold = (loss >= 1.0) ? UINT32_MAX : prob_threshold (loss / (burst * (1.0 - loss)));
+  fact->loss_end_threshold = prob_threshold (1.0 / burst);
+  fact->reorder_threshold = prob_threshold (cfg->emu_reorder / 1e3);
+  fact->immediate = (cfg->emu_latency == 0 && cfg->emu_jitter == 0 && cfg->emu_reorder == 0 && cfg->emu_bandwidth == 0);
+  fact->link_free.v = 0;
+
+  fact->m_base.gv = gv;
+  fact->m_base.m_free_fn = ddsi_emu_deinit;
+  fact->m_base.m_typename = "emu";
+  fact->m_base.m_default_spdp_address = "emu/mc1";
+  fact->m_base.m_connless = 1;
+  fact->m_base.m_enable_spdp = 1;
+  fact->m_base.m_supports_fn = ddsi_emu_supports;
+  fact->m_base.m_create_conn_fn = ddsi_emu_create_conn;
+  fact->m_base.m_release_conn_fn = ddsi_emu_release_conn;
+  fact->m_base.m_join_mc_fn = ddsi_emu_join_mc;
+  fact->m_base.m_leave_mc_fn = ddsi_emu_leave_mc;
+  fact->m_base.m_is_loopbackaddr_fn = ddsi_emu_is_loopbackaddr;
+  fact->m_base.m_is_mcaddr_fn = ddsi_emu_is_mcaddr;
+  fact->m_base.m_is_ssm_mcaddr_fn = ddsi_emu_is_ssm_mcaddr;
+  fact->m_base.m_is_nearby_address_fn = ddsi_emu_is_nearby_address;
+  fact->m_base.m_locator_from_string_fn = ddsi_emu_address_from_string;
+  fact->m_base.m_locator_to_string_fn = ddsi_emu_to_string;
+  fact->m_base.m_enumerate_interfaces_fn = ddsi_emu_enumerate_interfaces;
+  fact->m_base.m_is_valid_port_fn = ddsi_emu_is_valid_port;
+  fact->m_base.m_receive_buffer_size_fn = ddsi_emu_receive_buffer_size;
+  fact->m_base.m_locator_from_sockaddr_fn = ddsi_emu_locator_from_sockaddr;
+  ddsi_factory_add (gv, &fact->m_base);
+  GVLOG (DDS_LC_CONFIG, "emu initialized as node %"PRIu32"\n", fact->m_node);
+  return 0;
+}
+
+#else
+
+int ddsi_emu_init (struct ddsi_domaingv *gv)
+{
+  GVERROR ("emu: emulated network transport not supported on this platform\n");
+  return -1;
+}
+
+#endif
@@ -20,6 +20,8 @@
 #include "dds/ddsi/ddsi_builtin_topic_if.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_lathist.h"
+#include "dds/ddsi/ddsi_plist.h"
 #include "ddsi__entity.h"
 #include "ddsi__endpoint_match.h"
 #include "ddsi__participant.h"
@@ -799,6 +801,7 @@ static void ddsi_new_writer_guid_common_init (struct ddsi_writer *wr, const char
   wr->num_readers = 0;
   wr->num_reliable_readers = 0;
   wr->num_readers_requesting_keyhash = 0;
+  wr->num_readers_content_filtered = 0;
   wr->num_acks_received = 0;
   wr->num_nacks_received = 0;
   wr->throttle_count = 0;
@@ -806,8 +809,11 @@ static void ddsi_new_writer_guid_common_init (struct ddsi_writer *wr, const char
   wr->rexmit_count = 0;
   wr->rexmit_lost_count = 0;
   wr->rexmit_bytes = 0;
+  wr->filtered_count = 0;
+  wr->filtered_gap_start = wr->filtered_gap_end = 0;
   wr->time_throttled = 0;
   wr->time_retransmit = 0;
+  wr->lathist_whc = gv->config.stage_latency_statistics ? ddsi_lathist_new () : NULL;
   wr->force_md5_keyhash = 0;
   wr->alive = 1;
   wr->test_ignore_acknack = 0;
@@ -1153,6 +1159,7 @@ static void gc_delete_writer (struct ddsi_gcreq *gcreq)
   ddsrt_free (wr->xqos);
   ddsi_local_reader_ary_fini (&wr->rdary);
   ddsrt_cond_destroy (&wr->throttle_cond);
+  ddsi_lathist_free (wr->lathist_whc);
 
   ddsi_sertype_unref ((struct ddsi_sertype *) wr->type);
   endpoint_common_fini (&wr->e, &wr->c);
@@ -1473,7 +1480,7 @@ static void reader_init_network_partition (struct ddsi_reader *rd)
 }
 #endif /* DDS_HAS_NETWORK_PARTITIONS */
 
-dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_guid *guid, const struct ddsi_guid *group_guid, struct ddsi_participant *pp, const char *topic_name, const struct ddsi_sertype *type, const struct dds_qos *xqos, struct ddsi_rhc *rhc, ddsi_status_cb_t status_cb, void * status_entity, struct ddsi_psmx_locators_set *psmx_locators)
+dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_guid *guid, const struct ddsi_guid *group_guid, struct ddsi_participant *pp, const char *topic_name, const struct ddsi_sertype *type, const struct dds_qos *xqos, const struct ddsi_content_filter_property *content_filter, struct ddsi_rhc *rhc, ddsi_status_cb_t status_cb, void * status_entity, struct ddsi_psmx_locators_set *psmx_locators)
 {
   /* see ddsi_new_writer for commenets */
 
@@ -1518,6 +1525,7 @@ dds_return_t ddsi_new_reader (struct ddsi_reader **rd_out, const struct ddsi_gui
   rd->handle_as_transient_local = (rd->xqos->durability.kind == DDS_DURABILITY_TRANSIENT_LOCAL) ||
                                   (rd->e.guid.entityid.u == DDSI_ENTITYID_P2P_BUILTIN_PARTICIPANT_VOLATILE_SECURE_READER);
   rd->type = ddsi_sertype_ref (type);
+  rd->content_filter = content_filter ? ddsi_content_filter_property_dup (content_filter) : NULL;
   rd->request_keyhash = rd->type->request_keyhash;
   rd->init_acknack_count = 1;
   rd->num_writers = 0;
@@ -1613,6 +1621,7 @@ static void gc_delete_reader (struct ddsi_gcreq *gcreq)
 
   ddsi_xqos_fini (rd->xqos);
   ddsrt_free (rd->xqos);
+  ddsi_content_filter_property_free (rd->content_filter);
   endpoint_common_fini (&rd->e, &rd->c);
   ddsrt_free (rd);
 }
@@ -1649,6 +1658,18 @@ void ddsi_update_reader_qos (struct ddsi_reader *rd, const struct dds_qos *xqos)
   ddsrt_mutex_unlock (&rd->e.lock);
 }
 
+void ddsi_update_reader_content_filter (struct ddsi_reader *rd, const struct ddsi_content_filter_property *content_filter)
+{
+  ddsrt_mutex_lock (&rd->e.lock);
+  if (!ddsi_content_filter_property_equal (rd->content_filter, content_filter))
+  {
+    ddsi_content_filter_property_free (rd->content_filter);
+    rd->content_filter = content_filter ? ddsi_content_filter_property_dup (content_filter) : NULL;
+    ddsi_sedp_write_reader (rd);
+  }
+  ddsrt_mutex_unlock (&rd->e.lock);
+}
+
 struct ddsi_reader *ddsi_writer_first_in_sync_reader (struct ddsi_entity_index *entity_index, struct ddsi_entity_common *wrcmn, ddsrt_avl_iter_t *it)
 {
   assert (wrcmn->kind == DDSI_EK_WRITER);
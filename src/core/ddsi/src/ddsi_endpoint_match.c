@@ -33,6 +33,7 @@
 #include "ddsi__vendor.h"
 #include "ddsi__lat_estim.h"
 #include "ddsi__acknack.h"
+#include "ddsi__transmit.h"
 #ifdef DDS_HAS_TYPE_DISCOVERY
 #include "ddsi__typelookup.h"
 #endif
@@ -614,6 +615,8 @@ void ddsi_free_wr_prd_match (const struct ddsi_domaingv *gv, const ddsi_guid_t *
     (void) wr_guid;
 #endif
     ddsi_lat_estim_fini (&m->hb_to_ack_latency);
+    if (m->content_filter)
+      m->content_filter->free (m->content_filter);
     ddsrt_free (m);
   }
 }
@@ -745,6 +748,25 @@ static bool connected_via_psmx (const struct ddsi_entity_common *a, const struct
   return false;
 }
 
+static struct ddsi_sertype_content_filter *writer_content_filter_for_prd (const struct ddsi_writer *wr, const struct ddsi_proxy_reader *prd)
+{
+  /* prd->e.lock must be held */
+  if (prd->content_filter == NULL)
+    return NULL;
+#ifdef DDS_HAS_TYPELIB
+  /* The filter refers to members of the reader's type, so it can only be
+     evaluated by the writer if the types are the same */
+  const ddsi_typeid_t *wr_tid = ddsi_type_pair_minimal_id (wr->c.type_pair);
+  const ddsi_typeid_t *prd_tid = ddsi_type_pair_minimal_id (prd->c.type_pair);
+  if (wr_tid == NULL || prd_tid == NULL || ddsi_typeid_compare (wr_tid, prd_tid) != 0)
+    return NULL;
+  return ddsi_sertype_content_filter_new (wr->type, prd->content_filter);
+#else
+  (void) wr;
+  return NULL;
+#endif
+}
+
 void ddsi_writer_add_connection (struct ddsi_writer *wr, struct ddsi_proxy_reader *prd, int64_t crypto_handle)
 {
   struct ddsi_wr_prd_match *m = ddsrt_malloc (sizeof (*m));
@@ -766,6 +788,7 @@ void ddsi_writer_add_connection (struct ddsi_writer *wr, struct ddsi_proxy_reade
 #endif
   /* m->demoted: see below */
   ddsrt_mutex_lock (&prd->e.lock);
+  m->content_filter = writer_content_filter_for_prd (wr, prd);
   if (prd->deleting)
   {
     ELOGDISC (wr, "  ddsi_writer_add_connection(wr "PGUIDFMT" prd "PGUIDFMT") - prd is being deleted\n",
@@ -802,16 +825,21 @@ void ddsi_writer_add_connection (struct ddsi_writer *wr, struct ddsi_proxy_reade
               PGUID (wr->e.guid), PGUID (prd->e.guid));
     ddsrt_mutex_unlock (&wr->e.lock);
     ddsi_lat_estim_fini (&m->hb_to_ack_latency);
+    if (m->content_filter)
+      m->content_filter->free (m->content_filter);
     ddsrt_free (m);
   }
   else
   {
-    ELOGDISC (wr, "  ddsi_writer_add_connection(wr "PGUIDFMT" prd "PGUIDFMT") - ack seq %"PRIu64"\n",
-              PGUID (wr->e.guid), PGUID (prd->e.guid), m->seq);
+    ELOGDISC (wr, "  ddsi_writer_add_connection(wr "PGUIDFMT" prd "PGUIDFMT") - ack seq %"PRIu64"%s\n",
+              PGUID (wr->e.guid), PGUID (prd->e.guid), m->seq, m->content_filter ? " content-filtered" : "");
+    /* pending GAPs are for the readers that filtered those samples */
+    ddsi_writer_send_filtered_gaps_wrlock_held (wr);
     ddsrt_avl_insert_ipath (&ddsi_wr_readers_treedef, &wr->readers, m, &path);
     wr->num_readers++;
     wr->num_reliable_readers += m->is_reliable;
     wr->num_readers_requesting_keyhash += prd->requests_keyhash ? 1 : 0;
+    wr->num_readers_content_filtered += (m->content_filter != NULL);
     ddsi_rebuild_writer_addrset (wr);
     ddsrt_mutex_unlock (&wr->e.lock);
 
@@ -851,6 +879,30 @@ void ddsi_writer_add_connection (struct ddsi_writer *wr, struct ddsi_proxy_reade
   }
 }
 
+void ddsi_writer_update_content_filter (struct ddsi_writer *wr, struct ddsi_proxy_reader *prd)
+{
+  struct ddsi_sertype_content_filter *cf;
+  struct ddsi_wr_prd_match *m;
+  ddsrt_mutex_lock (&prd->e.lock);
+  cf = writer_content_filter_for_prd (wr, prd);
+  ddsrt_mutex_unlock (&prd->e.lock);
+  ddsrt_mutex_lock (&wr->e.lock);
+  if ((m = ddsrt_avl_lookup (&ddsi_wr_readers_treedef, &wr->readers, &prd->e.guid)) != NULL)
+  {
+    struct ddsi_sertype_content_filter * const old = m->content_filter;
+    ELOGDISC (wr, "  ddsi_writer_update_content_filter(wr "PGUIDFMT" prd "PGUIDFMT") - %s\n",
+              PGUID (wr->e.guid), PGUID (prd->e.guid), cf ? "content-filtered" : "unfiltered");
+    ddsi_writer_send_filtered_gaps_wrlock_held (wr);
+    wr->num_readers_content_filtered -= (old != NULL);
+    wr->num_readers_content_filtered += (cf != NULL);
+    m->content_filter = cf;
+    cf = old;
+  }
+  ddsrt_mutex_unlock (&wr->e.lock);
+  if (cf)
+    cf->free (cf);
+}
+
 void ddsi_writer_add_local_connection (struct ddsi_writer *wr, struct ddsi_reader *rd)
 {
   struct ddsi_wr_rd_match *m = ddsrt_malloc (sizeof (*m));
@@ -1221,6 +1273,7 @@ void ddsi_writer_drop_connection (const struct ddsi_guid *wr_guid, const struct
       wr->num_readers--;
       wr->num_reliable_readers -= m->is_reliable;
       wr->num_readers_requesting_keyhash -= prd->requests_keyhash ? 1 : 0;
+      wr->num_readers_content_filtered -= (m->content_filter != NULL);
       ddsi_rebuild_writer_addrset (wr);
       ddsi_remove_acked_messages (wr, &whcst, &deferred_free_list);
     }
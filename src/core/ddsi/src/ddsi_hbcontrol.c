@@ -374,6 +374,10 @@ void ddsi_add_heartbeat (struct ddsi_xmsg *msg, struct ddsi_writer *wr, const st
   assert (wr->reliable);
   assert (hbliveliness >= 0);
 
+  /* The heartbeat covers the filtered samples, readers that didn't get a GAP
+     for them yet would request them */
+  ddsi_writer_send_filtered_gaps_wrlock_held (wr);
+
   if (gv->config.meas_hb_to_ack_latency)
   {
     /* If configured to measure heartbeat-to-ack latency, we must add
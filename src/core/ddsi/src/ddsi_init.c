@@ -18,6 +18,7 @@
 #include "dds/ddsrt/string.h"
 #include "dds/ddsrt/sync.h"
 #include "dds/ddsrt/avl.h"
+#include "dds/ddsrt/bintrace.h"
 #include "dds/version.h"
 
 #include "dds/ddsi/ddsi_init.h"
@@ -29,6 +30,7 @@
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsi/ddsi_iid.h"
 #include "dds/ddsi/ddsi_psmx.h"
+#include "dds/ddsi/ddsi_lathist.h"
 #include "ddsi__protocol.h"
 #include "ddsi__misc.h"
 #include "ddsi__config_impl.h"
@@ -53,6 +55,7 @@
 #include "ddsi__udp.h"
 #include "ddsi__tcp.h"
 #include "ddsi__raweth.h"
+#include "ddsi__emu.h"
 #include "ddsi__vnet.h"
 #include "ddsi__mcgroup.h"
 #include "ddsi__nwpart.h"
@@ -71,6 +74,9 @@
 #include "ddsi__vendor.h"
 #include "ddsi__sockwaitset.h"
 #include "ddsi__spdp_schedule.h"
+#ifdef DDS_HAS_SECURITY
+#include "ddsi__secrecv.h"
+#endif
 
 #include "dds__whc.h"
 #include "dds/cdr/dds_cdrstream.h"
@@ -445,6 +451,23 @@ static int ddsi_config_open_trace (struct ddsi_domaingv *gv)
     gv->config.tracefp = stderr;
     status = 1;
   }
+  else if (gv->config.tracing_format == DDSI_TRACE_FORMAT_BINARY)
+  {
+    if ((gv->config.tracefp = fopen (gv->config.tracefile, gv->config.tracingAppendToFile ? "ab" : "wb")) == NULL)
+    {
+      DDS_ILOG (DDS_LC_ERROR, gv->config.domainId, "%s: cannot open for writing\n", gv->config.tracefile);
+      status = 0;
+    }
+    else if ((gv->config.tracebt = ddsrt_bintrace_new (gv->config.tracefp, gv->config.domainId, gv->config.tracing_binary_buffer_size)) == NULL)
+    {
+      DDS_ILOG (DDS_LC_ERROR, gv->config.domainId, "%s: failed to initialise binary trace\n", gv->config.tracefile);
+      status = 0;
+    }
+    else
+    {
+      status = 1;
+    }
+  }
   else if ((gv->config.tracefp = fopen (gv->config.tracefile, gv->config.tracingAppendToFile ? "a" : "w")) == NULL)
   {
     DDS_ILOG (DDS_LC_ERROR, gv->config.domainId, "%s: cannot open for writing\n", gv->config.tracefile);
@@ -456,6 +479,7 @@ static int ddsi_config_open_trace (struct ddsi_domaingv *gv)
   }
 
   dds_log_cfg_init (&gv->logconfig, gv->config.domainId, gv->config.tracemask, stderr, gv->config.tracefp);
+  dds_log_cfg_set_bintrace (&gv->logconfig, gv->config.tracebt);
   return status;
   DDSRT_WARNING_MSVC_ON(4996);
 }
@@ -995,6 +1019,14 @@ void ddsi_set_deafmute (struct ddsi_domaingv *gv, bool deaf, bool mute, int64_t
   GVLOGDISC ("\n");
 }
 
+static void free_lathists (struct ddsi_domaingv *gv)
+{
+  ddsi_lathist_free (gv->lathist_xpack);
+  ddsi_lathist_free (gv->lathist_send);
+  ddsi_lathist_free (gv->lathist_recv);
+  ddsi_lathist_free (gv->lathist_dqueue);
+}
+
 static void free_conns (struct ddsi_domaingv *gv)
 {
   // Depending on settings, various "conn"s can alias others, this makes sure we free each one only once
@@ -1128,6 +1160,9 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
   gv->listener = NULL;
   gv->debmon = NULL;
   gv->n_recv_threads = 0;
+#ifdef DDS_HAS_SECURITY
+  gv->secrecv = NULL;
+#endif
   gv->ddsi_tran_factories = NULL;
 
   /* Print start time for referencing relative times in the remainder of the DDS_LOG. */
@@ -1184,6 +1219,13 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
         goto err_udp_tcp_init;
       gv->m_factory = ddsi_factory_find (gv, "raweth");
       break;
+    case DDSI_TRANS_EMU:
+      gv->config.publish_uc_locators = 1;
+      gv->config.enable_uc_locators = 1;
+      if (ddsi_emu_init (gv) < 0)
+        goto err_udp_tcp_init;
+      gv->m_factory = ddsi_factory_find (gv, "emu");
+      break;
     case DDSI_TRANS_NONE:
       gv->config.publish_uc_locators = 0;
       gv->config.enable_uc_locators = 0;
@@ -1471,16 +1513,20 @@ int ddsi_init (struct ddsi_domaingv *gv, struct ddsi_psmx_instance_locators *psm
   GVLOG (DDS_LC_CONFIG, "rtps_init: domainid %"PRIu32" participantid %d\n", gv->config.domainId, gv->config.participantIndex);
 
   if (gv->config.pcap_file && *gv->config.pcap_file)
+    gv->pcap = ddsi_pcap_new (gv, gv->config.pcap_file);
+  else
+    gv->pcap = NULL;
+
+  if (gv->config.stage_latency_statistics)
   {
-    gv->pcap_fp = ddsi_new_pcap_file (gv, gv->config.pcap_file);
-    if (gv->pcap_fp)
-    {
-      ddsrt_mutex_init (&gv->pcap_lock);
-    }
+    gv->lathist_xpack = ddsi_lathist_new ();
+    gv->lathist_send = ddsi_lathist_new ();
+    gv->lathist_recv = ddsi_lathist_new ();
+    gv->lathist_dqueue = ddsi_lathist_new ();
   }
   else
   {
-    gv->pcap_fp = NULL;
+    gv->lathist_xpack = gv->lathist_send = gv->lathist_recv = gv->lathist_dqueue = NULL;
   }
 
   gv->mship = ddsi_new_mcgroup_membership();
@@ -1628,8 +1674,9 @@ err_mc_conn:
   for (int i = 0; i < gv->n_interfaces; i++)
     gv->intf_xlocators[i].conn = NULL;
   free_conns (gv);
-  if (gv->pcap_fp)
-    ddsrt_mutex_destroy (&gv->pcap_lock);
+  if (gv->pcap)
+    ddsi_pcap_free (gv->pcap);
+  free_lathists (gv);
   ddsi_free_mcgroup_membership (gv->mship);
 err_unicast_sockets:
   ddsi_tkmap_free (gv->m_tkmap);
@@ -1710,8 +1757,23 @@ int ddsi_start (struct ddsi_domaingv *gv)
   if (ddsi_xeventq_start (gv->xevents, NULL) < 0)
     return -1;
 
+#ifdef DDS_HAS_SECURITY
+  if (gv->config.transport_selector != DDSI_TRANS_NONE && gv->config.secure_recv_threads > 0)
+  {
+    if ((gv->secrecv = ddsi_secrecv_new (gv, gv->config.secure_recv_threads)) == NULL || ddsi_secrecv_start (gv->secrecv) < 0)
+    {
+      ddsi_xeventq_stop (gv->xevents);
+      return -1;
+    }
+  }
+#endif
+
   if (gv->config.transport_selector != DDSI_TRANS_NONE && setup_and_start_recv_threads (gv) < 0)
   {
+#ifdef DDS_HAS_SECURITY
+    if (gv->secrecv)
+      ddsi_secrecv_stop (gv->secrecv);
+#endif
     ddsi_xeventq_stop (gv->xevents);
     return -1;
   }
@@ -1777,6 +1839,12 @@ void ddsi_stop (struct ddsi_domaingv *gv)
   ddsi_term_prep (gv);
   if (gv->config.transport_selector != DDSI_TRANS_NONE)
     wait_for_receive_threads (gv);
+#ifdef DDS_HAS_SECURITY
+  /* The secure receive workers are fed by the receive threads, so with those
+     stopped, the workers can finish whatever is queued and stop as well */
+  if (gv->secrecv)
+    ddsi_secrecv_stop (gv->secrecv);
+#endif
 
   if (gv->listener)
   {
@@ -1936,11 +2004,9 @@ void ddsi_fini (struct ddsi_domaingv *gv)
   ddsi_free_mcgroup_membership(gv->mship);
   ddsi_tran_factories_fini (gv);
 
-  if (gv->pcap_fp)
-  {
-    ddsrt_mutex_destroy (&gv->pcap_lock);
-    fclose (gv->pcap_fp);
-  }
+  if (gv->pcap)
+    ddsi_pcap_free (gv->pcap);
+  free_lathists (gv);
 
   ddsi_free_config_nwpart_addresses (gv);
 
@@ -1954,6 +2020,13 @@ void ddsi_fini (struct ddsi_domaingv *gv)
       ddsi_sock_waitset_free (gv->recv_threads[i].arg.u.many.ws);
     ddsi_rbufpool_free (gv->recv_threads[i].arg.rbpool);
   }
+#ifdef DDS_HAS_SECURITY
+  if (gv->secrecv)
+  {
+    ddsi_secrecv_free (gv->secrecv);
+    gv->secrecv = NULL;
+  }
+#endif
 
   ddsi_tkmap_free (gv->m_tkmap);
   ddsi_entity_index_free (gv->entity_index);
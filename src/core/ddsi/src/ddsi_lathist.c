@@ -0,0 +1,113 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <string.h>
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsi/ddsi_lathist.h"
+
+extern inline void ddsi_lathist_record_since (struct ddsi_lathist *h, ddsrt_mtime_t t0);
+extern inline ddsrt_mtime_t ddsi_lathist_start (const struct ddsi_lathist *h);
+
+#define SUBCOUNT (1u << DDSI_LATHIST_SUBBITS)
+
+struct ddsi_lathist *ddsi_lathist_new (void)
+{
+  struct ddsi_lathist *h = ddsrt_malloc (sizeof (*h));
+  for (uint32_t i = 0; i < DDSI_LATHIST_NBUCKETS; i++)
+    ddsrt_atomic_st32 (&h->bucket[i], 0);
+  return h;
+}
+
+void ddsi_lathist_free (struct ddsi_lathist *h)
+{
+  ddsrt_free (h);
+}
+
+static uint32_t floor_log2 (uint64_t x)
+{
+  assert (x > 0);
+#if defined __GNUC__ || defined __clang__
+  return 63 - (uint32_t) __builtin_clzll (x);
+#else
+  uint32_t n = 0;
+  if (x >> 32) { n += 32; x >>= 32; }
+  if (x >> 16) { n += 16; x >>= 16; }
+  if (x >> 8) { n += 8; x >>= 8; }
+  if (x >> 4) { n += 4; x >>= 4; }
+  if (x >> 2) { n += 2; x >>= 2; }
+  if (x >> 1) { n += 1; }
+  return n;
+#endif
+}
+
+static uint32_t bucket_index (uint64_t v)
+{
+  if (v < SUBCOUNT)
+    return (uint32_t) v;
+  const uint32_t e = floor_log2 (v);
+  if (e >= DDSI_LATHIST_MAXEXP)
+    return DDSI_LATHIST_NBUCKETS - 1;
+  const uint32_t sub = (uint32_t) (v >> (e - DDSI_LATHIST_SUBBITS)) & (SUBCOUNT - 1);
+  return ((e - DDSI_LATHIST_SUBBITS + 1) << DDSI_LATHIST_SUBBITS) + sub;
+}
+
+uint64_t ddsi_lathist_bucket_upper_bound (uint32_t idx)
+{
+  assert (idx < DDSI_LATHIST_NBUCKETS);
+  if (idx < SUBCOUNT)
+    return idx;
+  const uint32_t e = (idx >> DDSI_LATHIST_SUBBITS) + DDSI_LATHIST_SUBBITS - 1;
+  const uint64_t sub = idx & (SUBCOUNT - 1);
+  return ((SUBCOUNT + sub + 1) << (e - DDSI_LATHIST_SUBBITS)) - 1;
+}
+
+void ddsi_lathist_record (struct ddsi_lathist *h, int64_t dt)
+{
+  ddsrt_atomic_inc32 (&h->bucket[bucket_index ((dt < 0) ? 0 : (uint64_t) dt)]);
+}
+
+void ddsi_lathist_record_n (struct ddsi_lathist *h, int64_t dt, uint32_t n)
+{
+  ddsrt_atomic_add32 (&h->bucket[bucket_index ((dt < 0) ? 0 : (uint64_t) dt)], n);
+}
+
+void ddsi_lathist_summarize (const struct ddsi_lathist *h, struct ddsi_lathist_summary *s)
+{
+  uint32_t counts[DDSI_LATHIST_NBUCKETS];
+  uint64_t n = 0;
+  memset (s, 0, sizeof (*s));
+  /* concurrent updates are fine: it just gives a slightly outdated picture */
+  for (uint32_t i = 0; i < DDSI_LATHIST_NBUCKETS; i++)
+  {
+    counts[i] = ddsrt_atomic_ld32 (&h->bucket[i]);
+    n += counts[i];
+  }
+  if ((s->count = n) == 0)
+    return;
+  const uint64_t r50 = (n * 50 + 99) / 100, r90 = (n * 90 + 99) / 100, r99 = (n * 99 + 99) / 100;
+  uint64_t cum = 0;
+  for (uint32_t i = 0; i < DDSI_LATHIST_NBUCKETS; i++)
+  {
+    if (counts[i] == 0)
+      continue;
+    const uint64_t prev = cum;
+    cum += counts[i];
+    const uint64_t ub = ddsi_lathist_bucket_upper_bound (i);
+    if (prev < r50 && cum >= r50)
+      s->p50 = ub;
+    if (prev < r90 && cum >= r90)
+      s->p90 = ub;
+    if (prev < r99 && cum >= r99)
+      s->p99 = ub;
+    s->max = ub;
+  }
+}
@@ -9,11 +9,18 @@
 // SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
+#include "dds/ddsrt/atomics.h"
 #include "dds/ddsrt/endian.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/threadring.h"
 #include "dds/ddsi/ddsi_log.h"
 #include "dds/ddsi/ddsi_domaingv.h"
+#include "ddsi__thread.h"
 #include "ddsi__pcap.h"
 
 // pcap format info taken from http://wiki.wireshark.org/Development/LibpcapFileFormat
@@ -72,12 +79,204 @@ static const ipv4_hdr_t ipv4_hdr_template = {
 
 #define IPV4_HDR_SIZE 20
 #define UDP_HDR_SIZE 8
+#define PCAP_RECHDR_SIZE ((uint32_t) sizeof (pcaprec_hdr_t) + IPV4_HDR_SIZE + UDP_HDR_SIZE)
 
-FILE *ddsi_new_pcap_file (struct ddsi_domaingv *gv, const char *name)
+/* Captured packets are copied into a per-thread ring buffer of the sending
+   or receiving thread (see dds/ddsrt/threadring.h), a background thread
+   merges the contents of the rings in timestamp order and writes them to
+   the file.  Each entry in a ring is a u32 length
+   followed by the pcap record header, IP and UDP headers and the captured
+   part of the payload. */
+
+#define PCAP_DRAIN_INTERVAL DDS_MSECS (10)
+
+struct pcap_ring {
+  struct ddsrt_thread_ring c;
+  uint32_t sample_count; /* packets since the last one captured, only used by owning thread */
+};
+
+struct pcap_cursor {
+  struct ddsrt_thread_ring *r;
+  uint32_t pos, head;
+  uint32_t reclen;
+  int64_t ts; /* in us */
+};
+
+struct ddsi_pcap {
+  struct ddsi_domaingv *gv;
+  FILE *fp;
+  struct ddsrt_thread_ring_set rings;
+  uint32_t snaplen;
+  uint32_t sample_interval;
+  ddsrt_atomic_uint32_t ndropped;
+  uint32_t ndropped_reported;
+  uint64_t nwritten; /* protected by lock */
+  uint64_t ndrains; /* protected by lock */
+  ddsrt_mtime_t treported;
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  bool terminate;
+  size_t ncursors; /* [lock] number in use while draining */
+  size_t ncursors_max;
+  struct pcap_cursor *cursors;
+  struct ddsi_thread_state *thrst;
+};
+
+static struct pcap_ring *pcap_sample (struct ddsi_pcap *pc)
+{
+  struct pcap_ring * const r = (struct pcap_ring *) ddsrt_thread_ring_get (&pc->rings);
+  if (r == NULL)
+  {
+    ddsrt_atomic_inc32 (&pc->ndropped);
+    return NULL;
+  }
+  if (pc->sample_interval > 1)
+  {
+    const bool take = (r->sample_count == 0);
+    if (++r->sample_count == pc->sample_interval)
+      r->sample_count = 0;
+    if (!take)
+      return NULL;
+  }
+  return r;
+}
+
+static void pcap_put (struct ddsi_pcap *pc, struct pcap_ring *r, const unsigned char *hdrs, const ddsrt_iovec_t *iov, size_t niov, uint32_t len)
+{
+  const uint32_t reclen = PCAP_RECHDR_SIZE + len;
+  uint32_t pos;
+  if (!ddsrt_thread_ring_reserve (&r->c, (uint32_t) sizeof (reclen) + reclen, &pos))
+  {
+    ddsrt_atomic_inc32 (&pc->ndropped);
+    return;
+  }
+  pos = ddsrt_thread_ring_copy_in (&r->c, pos, &reclen, sizeof (reclen));
+  pos = ddsrt_thread_ring_copy_in (&r->c, pos, hdrs, PCAP_RECHDR_SIZE);
+  for (size_t i = 0; i < niov && len > 0; i++)
+  {
+    const uint32_t n = (iov[i].iov_len < len) ? (uint32_t) iov[i].iov_len : len;
+    pos = ddsrt_thread_ring_copy_in (&r->c, pos, iov[i].iov_base, n);
+    len -= n;
+  }
+  assert (len == 0);
+  /* no need to hold the lock: a missed wakeup only delays writing */
+  if (ddsrt_thread_ring_commit (&r->c, pos))
+    ddsrt_cond_broadcast (&pc->cond);
+}
+
+static bool pcap_cursor_peek (struct pcap_cursor *c)
+{
+  if (c->pos == c->head)
+    return false;
+  pcaprec_hdr_t h;
+  const uint32_t pos = ddsrt_thread_ring_copy_out (c->r, c->pos, &c->reclen, sizeof (c->reclen));
+  (void) ddsrt_thread_ring_copy_out (c->r, pos, &h, sizeof (h));
+  c->ts = (int64_t) h.ts_sec * 1000000 + h.ts_usec;
+  return true;
+}
+
+static void pcap_write_record (struct ddsi_pcap *pc, const struct pcap_cursor *c)
+{
+  const struct ddsrt_thread_ring * const r = c->r;
+  const uint32_t off = (c->pos + (uint32_t) sizeof (c->reclen)) & (r->size - 1);
+  if (off + c->reclen <= r->size)
+    (void) fwrite (r->buf + off, 1, c->reclen, pc->fp);
+  else
+  {
+    (void) fwrite (r->buf + off, 1, r->size - off, pc->fp);
+    (void) fwrite (r->buf, 1, c->reclen - (r->size - off), pc->fp);
+  }
+}
+
+static void pcap_report_drops (struct ddsi_pcap *pc, bool force)
+{
+  struct ddsi_domaingv * const gv = pc->gv;
+  const uint32_t nd = ddsrt_atomic_ld32 (&pc->ndropped);
+  if (nd == pc->ndropped_reported)
+    return;
+  const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  if (force || tnow.v >= pc->treported.v + DDS_SECS (1))
+  {
+    GVWARNING ("packet capture: %"PRIu32" packets dropped because of full buffers\n", nd - pc->ndropped_reported);
+    pc->ndropped_reported = nd;
+    pc->treported = tnow;
+  }
+}
+
+static void pcap_add_cursor (struct ddsrt_thread_ring *r, uint32_t tail, uint32_t head, void *vpc)
+{
+  struct ddsi_pcap * const pc = vpc;
+  if (pc->ncursors == pc->ncursors_max)
+  {
+    pc->ncursors_max = (pc->ncursors_max == 0) ? 8 : 2 * pc->ncursors_max;
+    pc->cursors = ddsrt_realloc (pc->cursors, pc->ncursors_max * sizeof (*pc->cursors));
+  }
+  struct pcap_cursor * const c = &pc->cursors[pc->ncursors++];
+  c->r = r;
+  c->pos = tail;
+  c->head = head;
+  (void) pcap_cursor_peek (c);
+}
+
+static void pcap_drain (struct ddsi_pcap *pc)
+{
+  /* Each ring is in timestamp order, so a merge of the rings gives the
+     file in timestamp order, except for packets captured while draining.
+     Rings that have data now are not removed before the next drain. */
+  pc->ndrains++;
+  pc->ncursors = 0;
+  ddsrt_thread_ring_set_drain (&pc->rings, pcap_add_cursor, pc);
+
+  size_t n = pc->ncursors;
+  const bool wrote = (n > 0);
+  while (n > 0)
+  {
+    size_t m = 0;
+    for (size_t i = 1; i < n; i++)
+      if (pc->cursors[i].ts < pc->cursors[m].ts)
+        m = i;
+    struct pcap_cursor * const c = &pc->cursors[m];
+    pcap_write_record (pc, c);
+    pc->nwritten++;
+    c->pos += (uint32_t) sizeof (c->reclen) + c->reclen;
+    ddsrt_thread_ring_consume (c->r, c->pos);
+    if (!pcap_cursor_peek (c))
+      *c = pc->cursors[--n];
+  }
+  if (wrote)
+    (void) fflush (pc->fp);
+  pcap_report_drops (pc, false);
+}
+
+static uint32_t pcap_writer_thread (void *vpc)
+{
+  struct ddsi_pcap * const pc = vpc;
+  ddsrt_mutex_lock (&pc->lock);
+  while (!pc->terminate)
+  {
+    pcap_drain (pc);
+    (void) ddsrt_cond_waitfor (&pc->cond, &pc->lock, PCAP_DRAIN_INTERVAL);
+  }
+  pcap_drain (pc);
+  ddsrt_mutex_unlock (&pc->lock);
+  return 0;
+}
+
+struct ddsi_pcap *ddsi_pcap_new (struct ddsi_domaingv *gv, const char *name)
 {
   DDSRT_WARNING_MSVC_OFF(4996);
+  struct ddsi_pcap *pc;
   FILE *fp;
   pcap_hdr_t hdr;
+  uint32_t snaplen = gv->config.pcap_snaplen, size = 4096;
+
+  if (snaplen < PCAP_RECHDR_SIZE - sizeof (pcaprec_hdr_t))
+    snaplen = PCAP_RECHDR_SIZE - sizeof (pcaprec_hdr_t);
+  else if (snaplen > 65535)
+    snaplen = 65535;
+  /* a ring must be able to hold at least one packet */
+  while ((size < gv->config.pcap_buffer_size || size < 2 * (sizeof (uint32_t) + sizeof (pcaprec_hdr_t) + snaplen)) && size < (1u << 30))
+    size *= 2;
 
   if ((fp = fopen (name, "wb")) == NULL)
   {
@@ -90,25 +289,64 @@ FILE *ddsi_new_pcap_file (struct ddsi_domaingv *gv, const char *name)
   hdr.version_minor = 4;
   hdr.thiszone = 0;
   hdr.sigfigs = 0;
-  hdr.snaplen = 65535;
+  hdr.snaplen = snaplen;
   hdr.network = LINKTYPE_RAW;
   (void) fwrite (&hdr, sizeof (hdr), 1, fp);
 
-  return fp;
+  pc = ddsrt_malloc (sizeof (*pc));
+  pc->gv = gv;
+  pc->fp = fp;
+  ddsrt_thread_ring_set_init (&pc->rings, size, sizeof (struct pcap_ring), NULL, NULL, NULL);
+  pc->snaplen = snaplen;
+  pc->sample_interval = gv->config.pcap_sample_interval;
+  ddsrt_atomic_st32 (&pc->ndropped, 0);
+  pc->ndropped_reported = 0;
+  pc->nwritten = 0;
+  pc->ndrains = 0;
+  pc->treported = ddsrt_time_monotonic ();
+  pc->terminate = false;
+  pc->ncursors = 0;
+  pc->ncursors_max = 0;
+  pc->cursors = NULL;
+  ddsrt_mutex_init (&pc->lock);
+  ddsrt_cond_init (&pc->cond);
+  if (ddsi_create_thread (&pc->thrst, gv, "pcap", pcap_writer_thread, pc) != DDS_RETCODE_OK)
+  {
+    GVWARNING ("packet capture disabled: failed to create writer thread\n");
+    ddsrt_cond_destroy (&pc->cond);
+    ddsrt_mutex_destroy (&pc->lock);
+    ddsrt_thread_ring_set_fini (&pc->rings);
+    ddsrt_free (pc);
+    fclose (fp);
+    return NULL;
+  }
+  return pc;
   DDSRT_WARNING_MSVC_ON(4996);
 }
 
-static void write_data (FILE *fp, const ddsrt_msghdr_t *msghdr, size_t sz)
+void ddsi_pcap_free (struct ddsi_pcap *pc)
 {
-  size_t i, n = 0;
-  for (i = 0; i < (size_t) msghdr->msg_iovlen && n < sz; i++)
-  {
-    size_t m1 = msghdr->msg_iov[i].iov_len;
-    size_t m = (n + m1 <= sz) ? m1 : sz - n;
-    (void) fwrite (msghdr->msg_iov[i].iov_base, m, 1, fp);
-    n += m;
-  }
-  assert (n == sz);
+  ddsrt_mutex_lock (&pc->lock);
+  pc->terminate = true;
+  ddsrt_cond_broadcast (&pc->cond);
+  ddsrt_mutex_unlock (&pc->lock);
+  (void) ddsi_join_thread (pc->thrst);
+  pcap_report_drops (pc, true);
+  ddsrt_thread_ring_set_fini (&pc->rings);
+  ddsrt_free (pc->cursors);
+  ddsrt_cond_destroy (&pc->cond);
+  ddsrt_mutex_destroy (&pc->lock);
+  fclose (pc->fp);
+  ddsrt_free (pc);
+}
+
+void ddsi_pcap_get_stats (struct ddsi_pcap *pc, struct ddsi_pcap_stats *stats)
+{
+  ddsrt_mutex_lock (&pc->lock);
+  stats->written = pc->nwritten;
+  stats->dropped = ddsrt_atomic_ld32 (&pc->ndropped);
+  stats->drains = pc->ndrains;
+  ddsrt_mutex_unlock (&pc->lock);
 }
 
 static uint16_t calc_ipv4_checksum (const uint16_t *x)
@@ -123,36 +361,50 @@ static uint16_t calc_ipv4_checksum (const uint16_t *x)
   return (uint16_t) ~s;
 }
 
+static uint32_t fill_headers (const struct ddsi_pcap *pc, unsigned char *hdrs, ddsrt_wctime_t tstamp, unsigned char ttl, const struct sockaddr_in *src, const struct sockaddr_in *dst, size_t sz)
+{
+  pcaprec_hdr_t pcap_hdr;
+  union {
+    ipv4_hdr_t ipv4_hdr;
+    uint16_t x[10];
+  } u;
+  udp_hdr_t udp_hdr;
+  const size_t sz_ud = sz + UDP_HDR_SIZE;
+  const size_t sz_iud = sz_ud + IPV4_HDR_SIZE;
+  const uint32_t incl_len = (sz_iud <= pc->snaplen) ? (uint32_t) sz_iud : pc->snaplen;
+  ddsrt_wctime_to_sec_usec (&pcap_hdr.ts_sec, &pcap_hdr.ts_usec, tstamp);
+  pcap_hdr.incl_len = incl_len;
+  pcap_hdr.orig_len = (uint32_t) sz_iud;
+  u.ipv4_hdr = ipv4_hdr_template;
+  u.ipv4_hdr.totallength = ddsrt_toBE2u ((unsigned short) sz_iud);
+  u.ipv4_hdr.ttl = ttl;
+  u.ipv4_hdr.srcip = src->sin_addr.s_addr;
+  u.ipv4_hdr.dstip = dst->sin_addr.s_addr;
+  u.ipv4_hdr.checksum = calc_ipv4_checksum (u.x);
+  udp_hdr.srcport = src->sin_port;
+  udp_hdr.dstport = dst->sin_port;
+  udp_hdr.length = ddsrt_toBE2u ((unsigned short) sz_ud);
+  udp_hdr.checksum = 0; /* don't have to compute a checksum for UDPv4 */
+  memcpy (hdrs, &pcap_hdr, sizeof (pcap_hdr));
+  memcpy (hdrs + sizeof (pcap_hdr), &u.ipv4_hdr, IPV4_HDR_SIZE);
+  memcpy (hdrs + sizeof (pcap_hdr) + IPV4_HDR_SIZE, &udp_hdr, UDP_HDR_SIZE);
+  /* number of payload bytes to capture */
+  return incl_len - IPV4_HDR_SIZE - UDP_HDR_SIZE;
+}
+
 void ddsi_write_pcap_received (struct ddsi_domaingv *gv, ddsrt_wctime_t tstamp, const struct sockaddr_storage *src, const struct sockaddr_storage *dst, unsigned char *buf, size_t sz)
 {
   if (gv->config.transport_selector == DDSI_TRANS_UDP)
   {
-    pcaprec_hdr_t pcap_hdr;
-    union {
-      ipv4_hdr_t ipv4_hdr;
-      uint16_t x[10];
-    } u;
-    udp_hdr_t udp_hdr;
-    size_t sz_ud = sz + UDP_HDR_SIZE;
-    size_t sz_iud = sz_ud + IPV4_HDR_SIZE;
-    ddsrt_mutex_lock (&gv->pcap_lock);
-    ddsrt_wctime_to_sec_usec (&pcap_hdr.ts_sec, &pcap_hdr.ts_usec, tstamp);
-    pcap_hdr.incl_len = pcap_hdr.orig_len = (uint32_t) sz_iud;
-    (void) fwrite (&pcap_hdr, sizeof (pcap_hdr), 1, gv->pcap_fp);
-    u.ipv4_hdr = ipv4_hdr_template;
-    u.ipv4_hdr.totallength = ddsrt_toBE2u ((unsigned short) sz_iud);
-    u.ipv4_hdr.ttl = 128;
-    u.ipv4_hdr.srcip = ((struct sockaddr_in*) src)->sin_addr.s_addr;
-    u.ipv4_hdr.dstip = ((struct sockaddr_in*) dst)->sin_addr.s_addr;
-    u.ipv4_hdr.checksum = calc_ipv4_checksum (u.x);
-    (void) fwrite (&u.ipv4_hdr, sizeof (u.ipv4_hdr), 1, gv->pcap_fp);
-    udp_hdr.srcport = ((struct sockaddr_in*) src)->sin_port;
-    udp_hdr.dstport = ((struct sockaddr_in*) dst)->sin_port;
-    udp_hdr.length = ddsrt_toBE2u ((unsigned short) sz_ud);
-    udp_hdr.checksum = 0; /* don't have to compute a checksum for UDPv4 */
-    (void) fwrite (&udp_hdr, sizeof (udp_hdr), 1, gv->pcap_fp);
-    (void) fwrite (buf, sz, 1, gv->pcap_fp);
-    ddsrt_mutex_unlock (&gv->pcap_lock);
+    struct ddsi_pcap * const pc = gv->pcap;
+    struct pcap_ring *r;
+    if ((r = pcap_sample (pc)) != NULL)
+    {
+      unsigned char hdrs[PCAP_RECHDR_SIZE];
+      const uint32_t len = fill_headers (pc, hdrs, tstamp, 128, (const struct sockaddr_in *) src, (const struct sockaddr_in *) dst, sz);
+      const ddsrt_iovec_t iov = { .iov_base = buf, .iov_len = (ddsrt_iov_len_t) sz };
+      pcap_put (pc, r, hdrs, &iov, 1, len);
+    }
   }
 }
 
@@ -160,31 +412,13 @@ void ddsi_write_pcap_sent (struct ddsi_domaingv *gv, ddsrt_wctime_t tstamp, cons
 {
   if (gv->config.transport_selector == DDSI_TRANS_UDP)
   {
-    pcaprec_hdr_t pcap_hdr;
-    union {
-      ipv4_hdr_t ipv4_hdr;
-      uint16_t x[10];
-    } u;
-    udp_hdr_t udp_hdr;
-    size_t sz_ud = sz + UDP_HDR_SIZE;
-    size_t sz_iud = sz_ud + IPV4_HDR_SIZE;
-    ddsrt_mutex_lock (&gv->pcap_lock);
-    ddsrt_wctime_to_sec_usec (&pcap_hdr.ts_sec, &pcap_hdr.ts_usec, tstamp);
-    pcap_hdr.incl_len = pcap_hdr.orig_len = (uint32_t) sz_iud;
-    (void) fwrite (&pcap_hdr, sizeof (pcap_hdr), 1, gv->pcap_fp);
-    u.ipv4_hdr = ipv4_hdr_template;
-    u.ipv4_hdr.totallength = ddsrt_toBE2u ((unsigned short) sz_iud);
-    u.ipv4_hdr.ttl = 255;
-    u.ipv4_hdr.srcip = ((struct sockaddr_in*) src)->sin_addr.s_addr;
-    u.ipv4_hdr.dstip = ((struct sockaddr_in*) hdr->msg_name)->sin_addr.s_addr;
-    u.ipv4_hdr.checksum = calc_ipv4_checksum (u.x);
-    (void) fwrite (&u.ipv4_hdr, sizeof (u.ipv4_hdr), 1, gv->pcap_fp);
-    udp_hdr.srcport = ((struct sockaddr_in*) src)->sin_port;
-    udp_hdr.dstport = ((struct sockaddr_in*) hdr->msg_name)->sin_port;
-    udp_hdr.length = ddsrt_toBE2u ((unsigned short) sz_ud);
-    udp_hdr.checksum = 0; /* don't have to compute a checksum for UDPv4 */
-    (void) fwrite (&udp_hdr, sizeof (udp_hdr), 1, gv->pcap_fp);
-    write_data (gv->pcap_fp, hdr, sz);
-    ddsrt_mutex_unlock (&gv->pcap_lock);
+    struct ddsi_pcap * const pc = gv->pcap;
+    struct pcap_ring *r;
+    if ((r = pcap_sample (pc)) != NULL)
+    {
+      unsigned char hdrs[PCAP_RECHDR_SIZE];
+      const uint32_t len = fill_headers (pc, hdrs, tstamp, 255, (const struct sockaddr_in *) src, (const struct sockaddr_in *) hdr->msg_name, sz);
+      pcap_put (pc, r, hdrs, hdr->msg_iov, (size_t) hdr->msg_iovlen, len);
+    }
   }
 }
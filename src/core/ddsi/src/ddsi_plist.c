@@ -2052,6 +2052,7 @@ static const struct piddesc piddesc_omg[] = {
   PP  (EXPECTS_INLINE_QOS,                  expects_inline_qos, Xb),
   PP  (PARTICIPANT_MANUAL_LIVELINESS_COUNT, participant_manual_liveliness_count, Xi),
   PP  (PARTICIPANT_BUILTIN_ENDPOINTS,       participant_builtin_endpoints, Xu),
+  PP  (CONTENT_FILTER_PROPERTY,             content_filter_property, XS, XS, XS, XS, XQ, XS, XSTOP),
   PPV (PARTICIPANT_GUID,                    participant_guid, XG),
   PPV (GROUP_GUID,                          group_guid, XG),
   PP  (BUILTIN_ENDPOINT_SET,                builtin_endpoint_set, Xu),
@@ -2226,11 +2227,11 @@ static const struct piddesc_index piddesc_vendor_index[] = {
    initialized by ddsi_plist_init_tables; will assert when
    table too small or too large */
 #ifdef DDS_HAS_TYPELIB
+static const struct piddesc *piddesc_unalias[20 + SECURITY_PROC_ARRAY_SIZE];
+static const struct piddesc *piddesc_fini[20 + SECURITY_PROC_ARRAY_SIZE];
+#else
 static const struct piddesc *piddesc_unalias[19 + SECURITY_PROC_ARRAY_SIZE];
 static const struct piddesc *piddesc_fini[19 + SECURITY_PROC_ARRAY_SIZE];
-#else
-static const struct piddesc *piddesc_unalias[18 + SECURITY_PROC_ARRAY_SIZE];
-static const struct piddesc *piddesc_fini[18 + SECURITY_PROC_ARRAY_SIZE];
 #endif
 static uint64_t plist_fini_mask, qos_fini_mask;
 static ddsrt_once_t table_init_control = DDSRT_ONCE_INIT;
@@ -2576,6 +2577,33 @@ void ddsi_plist_fini_mask (ddsi_plist_t *plist, uint64_t pmask, uint64_t qmask)
   plist->qos.aliased &= ~qmask;
 }
 
+static const enum ddsi_pserop content_filter_property_desc[] = { XS, XS, XS, XS, XQ, XS, XSTOP, XSTOP };
+
+struct ddsi_content_filter_property *ddsi_content_filter_property_dup (const struct ddsi_content_filter_property *src)
+{
+  struct ddsi_content_filter_property *dst = ddsrt_memdup (src, sizeof (*dst));
+  size_t dstoff = 0;
+  // the parameter sequence is shared with src after the memdup, so it needs copying as well
+  (void) unalias_generic (dst, &dstoff, true, content_filter_property_desc);
+  return dst;
+}
+
+void ddsi_content_filter_property_free (struct ddsi_content_filter_property *cfp)
+{
+  if (cfp)
+  {
+    ddsi_plist_fini_generic (cfp, content_filter_property_desc, false);
+    ddsrt_free (cfp);
+  }
+}
+
+bool ddsi_content_filter_property_equal (const struct ddsi_content_filter_property *a, const struct ddsi_content_filter_property *b)
+{
+  if (a == NULL || b == NULL)
+    return a == b;
+  return ddsi_plist_equal_generic (a, b, content_filter_property_desc);
+}
+
 void ddsi_plist_unalias (ddsi_plist_t *plist)
 {
   plist_or_xqos_unalias (plist, 0);
@@ -2912,6 +2940,10 @@ static enum do_locator_result do_locator (ddsi_locators_t *ls, uint64_t present,
       if (!locator_address_prefix_zero (&loc, 10))
         return DOLOC_INVALID;
       break;
+    case DDSI_LOCATOR_KIND_EMU:
+      if (!ddsi_is_valid_port (fact, loc.port))
+        return DOLOC_INVALID;
+      break;
     case DDSI_LOCATOR_KIND_PSMX:
       if (!ddsi_vendor_is_eclipse (dd->vendorid))
         return DOLOC_IGNORED;
@@ -659,6 +659,10 @@ int ddsi_new_proxy_reader (struct ddsi_proxy_reader **proxy_reader, struct ddsi_
 #else
   prd->filter = NULL;
 #endif
+  if (plist->present & PP_CONTENT_FILTER_PROPERTY)
+    prd->content_filter = ddsi_content_filter_property_dup (&plist->content_filter_property);
+  else
+    prd->content_filter = NULL;
 
   /* locking the entity prevents matching while the built-in topic hasn't been published yet */
   ddsrt_mutex_lock (&prd->e.lock);
@@ -671,10 +675,12 @@ int ddsi_new_proxy_reader (struct ddsi_proxy_reader **proxy_reader, struct ddsi_
   return DDS_RETCODE_OK;
 }
 
-void ddsi_update_proxy_reader (struct ddsi_proxy_reader *prd, ddsi_seqno_t seq, struct ddsi_addrset *as, const struct dds_qos *xqos, ddsrt_wctime_t timestamp)
+void ddsi_update_proxy_reader (struct ddsi_proxy_reader *prd, ddsi_seqno_t seq, struct ddsi_addrset *as, const struct dds_qos *xqos, const struct ddsi_content_filter_property *content_filter, ddsrt_wctime_t timestamp)
 {
   struct ddsi_prd_wr_match * m;
   ddsi_guid_t wrguid;
+  ddsi_guid_t *cf_wrguids = NULL;
+  uint32_t cf_nwrguids = 0;
 
   memset (&wrguid, 0, sizeof (wrguid));
 
@@ -724,9 +730,38 @@ void ddsi_update_proxy_reader (struct ddsi_proxy_reader *prd, ddsi_seqno_t seq,
       }
     }
 
+    if (!ddsi_content_filter_property_equal (prd->content_filter, content_filter))
+    {
+      /* Matched writers evaluating the old filter must switch to the new one,
+         that requires the writer lock and so can only be done once prd->e.lock
+         has been released */
+      ELOGDISC (prd, "ddsi_update_proxy_reader ("PGUIDFMT") content filter changed\n", PGUID (prd->e.guid));
+      ddsi_content_filter_property_free (prd->content_filter);
+      prd->content_filter = content_filter ? ddsi_content_filter_property_dup (content_filter) : NULL;
+      uint32_t cf_size = 0;
+      ddsrt_avl_iter_t it;
+      for (m = ddsrt_avl_iter_first (&ddsi_prd_writers_treedef, &prd->writers, &it); m; m = ddsrt_avl_iter_next (&it))
+      {
+        if (cf_nwrguids == cf_size)
+        {
+          cf_size = cf_size ? 2 * cf_size : 4;
+          cf_wrguids = ddsrt_realloc (cf_wrguids, cf_size * sizeof (*cf_wrguids));
+        }
+        cf_wrguids[cf_nwrguids++] = m->wr_guid;
+      }
+    }
+
     (void) ddsi_update_qos_locked (&prd->e, prd->c.xqos, xqos, timestamp);
   }
   ddsrt_mutex_unlock (&prd->e.lock);
+
+  for (uint32_t i = 0; i < cf_nwrguids; i++)
+  {
+    struct ddsi_writer *wr;
+    if ((wr = ddsi_entidx_lookup_writer_guid (prd->e.gv->entity_index, &cf_wrguids[i])) != NULL)
+      ddsi_writer_update_content_filter (wr, prd);
+  }
+  ddsrt_free (cf_wrguids);
 }
 
 static void proxy_reader_set_delete_and_ack_all_messages (struct ddsi_proxy_reader *prd)
@@ -802,6 +837,7 @@ static void gc_delete_proxy_reader (struct ddsi_gcreq *gcreq)
 #ifdef DDS_HAS_SECURITY
   ddsi_omg_security_deregister_remote_reader (prd);
 #endif
+  ddsi_content_filter_property_free (prd->content_filter);
   proxy_endpoint_common_fini (&prd->e, &prd->c);
   ddsrt_free (prd);
 }
@@ -30,6 +30,7 @@
 #include "dds/ddsi/ddsi_plist.h"
 #include "dds/ddsi/ddsi_unused.h"
 #include "dds/ddsi/ddsi_domaingv.h" /* for mattr, cattr */
+#include "dds/ddsi/ddsi_lathist.h"
 #include "ddsi__protocol.h"
 #include "ddsi__log.h"
 #include "ddsi__misc.h"
@@ -280,6 +281,9 @@ struct ddsi_rbufpool {
   uint32_t max_rmsg_size;
   const struct ddsrt_log_cfg *logcfg;
   bool trace;
+  /* For monitoring: number of live rbufs and number allocated in total */
+  ddsrt_atomic_uint32_t n_rbufs;
+  ddsrt_atomic_uint32_t n_allocs;
 #ifndef NDEBUG
   /* Thread that owns this pool, so we can check that no other thread
      is calling functions only the owner may use. */
@@ -355,6 +359,8 @@ struct ddsi_rbufpool *ddsi_rbufpool_new (const struct ddsrt_log_cfg *logcfg, uin
   rbp->max_rmsg_size = max_rmsg_size;
   rbp->logcfg = logcfg;
   rbp->trace = (logcfg->c.mask & DDS_LC_RADMIN) != 0;
+  ddsrt_atomic_st32 (&rbp->n_rbufs, 0);
+  ddsrt_atomic_st32 (&rbp->n_allocs, 0);
 
 #if USE_VALGRIND
   VALGRIND_CREATE_MEMPOOL (rbp, 0, 0);
@@ -398,6 +404,13 @@ void ddsi_rbufpool_free (struct ddsi_rbufpool *rbp)
   ddsrt_free (rbp);
 }
 
+void ddsi_rbufpool_get_stats (struct ddsi_rbufpool *rbp, struct ddsi_rbufpool_stats *stats)
+{
+  stats->rbuf_size = rbp->rbuf_size;
+  stats->n_rbufs = ddsrt_atomic_ld32 (&rbp->n_rbufs);
+  stats->n_allocs = ddsrt_atomic_ld32 (&rbp->n_allocs);
+}
+
 /* RBUF ---------------------------------------------------------------- */
 
 struct ddsi_rbuf {
@@ -441,6 +454,8 @@ static struct ddsi_rbuf *ddsi_rbuf_alloc_new (struct ddsi_rbufpool *rbp)
   rb->max_rmsg_size = rbp->max_rmsg_size;
   rb->freeptr = rb->raw;
   rb->trace = rbp->trace;
+  ddsrt_atomic_inc32 (&rbp->n_rbufs);
+  ddsrt_atomic_inc32 (&rbp->n_allocs);
   RBPTRACE ("rbuf_alloc_new(%p) = %p\n", (void *) rbp, (void *) rb);
   return rb;
 }
@@ -467,6 +482,7 @@ static void ddsi_rbuf_release (struct ddsi_rbuf *rbuf)
   if (ddsrt_atomic_dec32_ov (&rbuf->n_live_rmsg_chunks) == 1)
   {
     RBPTRACE ("rbuf_release(%p) free\n", (void *) rbuf);
+    ddsrt_atomic_dec32 (&rbp->n_rbufs);
     ddsrt_free (rbuf);
   }
 }
@@ -661,7 +677,18 @@ static void ddsi_rmsg_rmbias_and_adjust (struct ddsi_rmsg *rmsg, int adjust)
     ddsi_rmsg_free (rmsg);
 }
 
-static void ddsi_rmsg_unref (struct ddsi_rmsg *rmsg)
+void ddsi_rmsg_addref (struct ddsi_rmsg *rmsg)
+{
+  /* Note: only the receive thread that owns the receive pool may add a
+     reference, and only while the rmsg is still uncommitted; the reference
+     can be dropped by any thread using rmsg_unref. */
+  RMSGTRACE ("rmsg_addref(%p)\n", (void *) rmsg);
+  ASSERT_RBUFPOOL_OWNER (rmsg->chunk.rbuf->rbufpool);
+  ASSERT_RMSG_UNCOMMITTED (rmsg);
+  ddsrt_atomic_inc32 (&rmsg->refcount);
+}
+
+void ddsi_rmsg_unref (struct ddsi_rmsg *rmsg)
 {
   RMSGTRACE ("rmsg_unref(%p)\n", (void *) rmsg);
   assert (ddsrt_atomic_ld32 (&rmsg->refcount) > 0);
@@ -2504,6 +2531,7 @@ struct ddsi_dqueue {
   char *name;
   uint32_t max_samples;
   ddsrt_atomic_uint32_t nof_samples;
+  ddsrt_mtime_t tenqueue; /* time queue became non-empty, only if gv->lathist_dqueue */
 };
 
 enum dqueue_elem_kind {
@@ -2617,7 +2645,10 @@ static uint32_t dqueue_thread (void *vq)
       ddsrt_cond_wait (&q->cond, &q->lock);
     sc = q->sc;
     q->sc.first = q->sc.last = NULL;
+    const ddsrt_mtime_t tenqueue = q->tenqueue;
     ddsrt_mutex_unlock (&q->lock);
+    if (sc.first)
+      ddsi_lathist_record_since (q->gv->lathist_dqueue, tenqueue);
 
     ddsi_thread_state_awake_fixed_domain (thrst);
     while (sc.first)
@@ -2702,6 +2733,7 @@ struct ddsi_dqueue *ddsi_dqueue_new (const char *name, const struct ddsi_domaing
   q->sc.first = q->sc.last = NULL;
   q->gv = (struct ddsi_domaingv *) gv;
   q->thrst = NULL;
+  q->tenqueue.v = 0;
 
   ddsrt_mutex_init (&q->lock);
   ddsrt_cond_init (&q->cond);
@@ -2733,6 +2765,7 @@ static int ddsi_dqueue_enqueue_locked (struct ddsi_dqueue *q, struct ddsi_rsampl
   {
     must_signal = 1;
     q->sc = *sc;
+    q->tenqueue = ddsi_lathist_start (q->gv->lathist_dqueue);
   }
   else
   {
@@ -2825,6 +2858,13 @@ void ddsi_dqueue_enqueue1 (struct ddsi_dqueue *q, const ddsi_guid_t *rdguid, str
   ddsrt_mutex_unlock (&q->lock);
 }
 
+void ddsi_dqueue_get_stats (struct ddsi_dqueue *q, struct ddsi_dqueue_stats *stats)
+{
+  stats->name = q->name;
+  stats->nof_samples = ddsrt_atomic_ld32 (&q->nof_samples);
+  stats->max_samples = q->max_samples;
+}
+
 int ddsi_dqueue_is_full (struct ddsi_dqueue *q)
 {
   /* Reading nof_samples exactly once. It IS a 32-bit int, so at
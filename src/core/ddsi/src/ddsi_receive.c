@@ -26,6 +26,7 @@
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsi/ddsi_serdata.h"
+#include "dds/ddsi/ddsi_lathist.h"
 #include "ddsi__log.h"
 #include "ddsi__protocol.h"
 #include "ddsi__misc.h"
@@ -58,6 +59,9 @@
 #include "ddsi__vendor.h"
 #include "ddsi__hbcontrol.h"
 #include "ddsi__sockwaitset.h"
+#ifdef DDS_HAS_SECURITY
+#include "ddsi__secrecv.h"
+#endif
 
 #include "dds/cdr/dds_cdrstream.h"
 #include "dds__whc.h"
@@ -1026,7 +1030,7 @@ static int handle_AckNack (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
         if (!wr->retransmitting && sample.unacked)
           ddsi_writer_set_retransmitting (wr);
 
-        if (rst->gv->config.retransmit_merging != DDSI_REXMIT_MERGE_NEVER && rn->assumed_in_sync && !prd->filter)
+        if (rst->gv->config.retransmit_merging != DDSI_REXMIT_MERGE_NEVER && rn->assumed_in_sync && !prd->filter && !rn->content_filter)
         {
           /* send retransmit to all receivers, but skip if recently done */
           ddsrt_mtime_t tstamp = ddsrt_time_monotonic ();
@@ -1056,10 +1060,12 @@ static int handle_AckNack (struct ddsi_receiver_state *rst, ddsrt_etime_t tnow,
         }
         else
         {
-          /* Is this a volatile reader with a filter?
+          /* Is this a volatile reader with a filter or a reader with a content filter?
            * If so, call the filter to see if we should re-arrange the sequence gap when needed. */
           if (prd->filter && !prd->filter (wr, prd, sample.serdata))
             ddsi_gap_info_update (rst->gv, &gi, seqbase + i);
+          else if (rn->content_filter && !rn->content_filter->accept (rn->content_filter, sample.serdata))
+            ddsi_gap_info_update (rst->gv, &gi, seqbase + i);
           else
           {
             /* no merging, send directed retransmit */
@@ -3258,7 +3264,7 @@ static int handle_submsg_sequence
   }
 }
 
-static void handle_rtps_message (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, struct ddsi_rmsg *rmsg, size_t sz, unsigned char *msg, const struct ddsi_network_packet_info *pktinfo)
+static void handle_rtps_message (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, struct ddsi_rmsg *rmsg, size_t sz, unsigned char *msg, const struct ddsi_network_packet_info *pktinfo, bool allow_offload)
 {
   ddsi_rtps_header_t *hdr = (ddsi_rtps_header_t *) msg;
   assert (gv->config.protocol_version.major == DDSI_RTPS_MAJOR);
@@ -3275,6 +3281,12 @@ static void handle_rtps_message (struct ddsi_thread_state * const thrst, struct
     if (DDSI_SC_PEDANTIC_P (gv->config))
       malformed_packet_received (gv, msg, NULL, (size_t) sz, hdr->vendorid);
   }
+#ifdef DDS_HAS_SECURITY
+  else if (allow_offload && gv->secrecv && ddsi_secrecv_enqueue (gv->secrecv, conn, guidprefix, rmsg, msg, sz, pktinfo))
+  {
+    /* protected message, decoding and processing is done by a secure receive worker */
+  }
+#endif
   else
   {
     hdr->guid_prefix = ddsi_ntoh_guid_prefix (hdr->guid_prefix);
@@ -3300,7 +3312,7 @@ static void handle_rtps_message (struct ddsi_thread_state * const thrst, struct
 
 void ddsi_handle_rtps_message (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool, struct ddsi_rmsg *rmsg, size_t sz, unsigned char *msg, const struct ddsi_network_packet_info *pktinfo)
 {
-  handle_rtps_message (thrst, gv, conn, guidprefix, rbpool, rmsg, sz, msg, pktinfo);
+  handle_rtps_message (thrst, gv, conn, guidprefix, rbpool, rmsg, sz, msg, pktinfo, false);
 }
 
 static bool do_packet (struct ddsi_thread_state * const thrst, struct ddsi_domaingv *gv, struct ddsi_tran_conn * conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rbufpool *rbpool)
@@ -3390,8 +3402,10 @@ static bool do_packet (struct ddsi_thread_state * const thrst, struct ddsi_domai
 
   if (sz > 0 && !gv->deaf)
   {
+    const ddsrt_mtime_t tstart = ddsi_lathist_start (gv->lathist_recv);
     ddsi_rmsg_setsize (rmsg, (uint32_t) sz);
-    handle_rtps_message(thrst, gv, conn, guidprefix, rbpool, rmsg, (size_t) sz, buff, &pktinfo);
+    handle_rtps_message (thrst, gv, conn, guidprefix, rbpool, rmsg, (size_t) sz, buff, &pktinfo, true);
+    ddsi_lathist_record_since (gv->lathist_recv, tstart);
   }
   ddsi_rmsg_commit (rmsg);
   return (sz > 0);
@@ -3675,8 +3689,12 @@ uint32_t ddsi_recv_thread (void *vrecv_thread_arg)
             guid_prefix = NULL;
           else
             guid_prefix = &lps.ps[(unsigned)idx - num_fixed].guid_prefix;
-          /* Process message and clean out connection if failed or closed */
-          if (!do_packet (thrst, gv, conn, guid_prefix, rbpool) && !conn->m_connless)
+          /* Process message(s) and clean out connection if failed or closed, more
+             messages may have been buffered by the transport when reading this one */
+          bool ok;
+          while ((ok = do_packet (thrst, gv, conn, guid_prefix, rbpool)) && ddsi_conn_has_buffered_message (conn))
+            ;
+          if (!ok && !conn->m_connless)
             ddsi_conn_free (conn);
         }
       }
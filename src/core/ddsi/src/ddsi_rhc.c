@@ -12,6 +12,7 @@
 
 extern inline void ddsi_rhc_free (struct ddsi_rhc *rhc);
 extern inline bool ddsi_rhc_store (struct ddsi_rhc *rhc, const struct ddsi_writer_info *wrinfo, struct ddsi_serdata *sample, struct ddsi_tkmap_instance *tk);
+extern inline bool ddsi_rhc_get_stats (struct ddsi_rhc *rhc, struct ddsi_rhc_stats *stats);
 extern inline void ddsi_rhc_unregister_wr (struct ddsi_rhc *rhc, const struct ddsi_writer_info *wrinfo);
 extern inline void ddsi_rhc_relinquish_ownership (struct ddsi_rhc *rhc, const uint64_t wr_iid);
 extern inline void ddsi_rhc_set_qos (struct ddsi_rhc *rhc, const struct dds_qos *qos);
@@ -0,0 +1,274 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/time.h"
+#include "dds/ddsrt/mh3.h"
+#include "dds/ddsi/ddsi_log.h"
+#include "dds/ddsi/ddsi_domaingv.h"
+#include "ddsi__thread.h"
+#include "ddsi__radmin.h"
+#include "ddsi__receive.h"
+#include "ddsi__protocol.h"
+#include "ddsi__secrecv.h"
+
+/* Maximum number of packets queued for a single worker, when it is reached
+   the receive thread waits for the worker to catch up, just like it would
+   have to if it were to do the decoding itself. */
+#define SECRECV_MAX_QUEUED 256
+
+/* Packets are handed off in the receive buffer they were received in: the
+   descriptor is allocated in the same rmsg and the rmsg is kept alive by an
+   additional reference until the worker is done with it.  Decoding copies the
+   plaintext into an rmsg from the worker's own pool, as the processing of the
+   submessages requires an uncommitted rmsg owned by the processing thread. */
+struct ddsi_secrecv_packet {
+  struct ddsi_secrecv_packet *next;
+  struct ddsi_rmsg *rmsg;
+  unsigned char *msg;
+  struct ddsi_tran_conn *conn;
+  bool has_guidprefix;
+  ddsi_guid_prefix_t guidprefix;
+  struct ddsi_network_packet_info pktinfo;
+  ddsrt_mtime_t tenqueue;
+  size_t size;
+};
+
+struct ddsi_secrecv_worker {
+  struct ddsi_secrecv *sr;
+  char name[24];
+  struct ddsi_thread_state *thrst;
+  struct ddsi_rbufpool *rbpool;
+
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  struct ddsi_secrecv_packet *head;
+  struct ddsi_secrecv_packet *tail;
+  uint32_t length;
+  bool stop;
+
+  /* statistics, protected by lock */
+  uint64_t packets;
+  uint64_t bytes;
+  uint64_t time_queued;
+  uint64_t time_process;
+  uint32_t length_max;
+};
+
+struct ddsi_secrecv {
+  struct ddsi_domaingv *gv;
+  uint32_t nworkers;
+  struct ddsi_secrecv_worker *workers;
+};
+
+static void process_packet (struct ddsi_thread_state * const thrst, struct ddsi_secrecv_worker *w, const struct ddsi_secrecv_packet *pkt)
+{
+  struct ddsi_domaingv * const gv = w->sr->gv;
+  struct ddsi_rmsg *rmsg;
+  /* Empty rmsg: decoding replaces it with one containing the plaintext */
+  if ((rmsg = ddsi_rmsg_new (w->rbpool)) == NULL)
+  {
+    GVWARNING ("%s: can't allocate receive buffer, dropping packet\n", w->name);
+    return;
+  }
+  ddsi_handle_rtps_message (thrst, gv, pkt->conn, pkt->has_guidprefix ? &pkt->guidprefix : NULL, w->rbpool, rmsg, pkt->size, pkt->msg, &pkt->pktinfo);
+  ddsi_rmsg_commit (rmsg);
+}
+
+static uint32_t secrecv_worker_thread (void *varg)
+{
+  struct ddsi_secrecv_worker * const w = varg;
+  struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
+  ddsi_rbufpool_setowner (w->rbpool, ddsrt_thread_self ());
+  ddsrt_mutex_lock (&w->lock);
+  while (!(w->stop && w->head == NULL))
+  {
+    struct ddsi_secrecv_packet *pkt;
+    if ((pkt = w->head) == NULL)
+    {
+      (void) ddsrt_cond_wait (&w->cond, &w->lock);
+      continue;
+    }
+    if ((w->head = pkt->next) == NULL)
+      w->tail = NULL;
+    if (w->length-- == SECRECV_MAX_QUEUED)
+      ddsrt_cond_broadcast (&w->cond);
+    ddsrt_mutex_unlock (&w->lock);
+
+    const ddsrt_mtime_t tstart = ddsrt_time_monotonic ();
+    process_packet (thrst, w, pkt);
+    const ddsrt_mtime_t tend = ddsrt_time_monotonic ();
+
+    const size_t size = pkt->size;
+    const ddsrt_mtime_t tenqueue = pkt->tenqueue;
+    ddsi_rmsg_unref (pkt->rmsg);
+
+    ddsrt_mutex_lock (&w->lock);
+    w->packets++;
+    w->bytes += size;
+    w->time_queued += (uint64_t) (tstart.v - tenqueue.v);
+    w->time_process += (uint64_t) (tend.v - tstart.v);
+  }
+  ddsrt_mutex_unlock (&w->lock);
+  return 0;
+}
+
+struct ddsi_secrecv *ddsi_secrecv_new (struct ddsi_domaingv *gv, uint32_t nworkers)
+{
+  struct ddsi_secrecv *sr = ddsrt_malloc (sizeof (*sr));
+  assert (nworkers > 0);
+  sr->gv = gv;
+  sr->nworkers = nworkers;
+  sr->workers = ddsrt_malloc (nworkers * sizeof (*sr->workers));
+  for (uint32_t i = 0; i < nworkers; i++)
+  {
+    struct ddsi_secrecv_worker *w = &sr->workers[i];
+    memset (w, 0, sizeof (*w));
+    w->sr = sr;
+    (void) snprintf (w->name, sizeof (w->name), "secrecv.%"PRIu32, i);
+    ddsrt_mutex_init (&w->lock);
+    ddsrt_cond_init (&w->cond);
+    if ((w->rbpool = ddsi_rbufpool_new (&gv->logconfig, gv->config.rbuf_size, gv->config.rmsg_chunk_size)) == NULL)
+    {
+      GVERROR ("ddsi_secrecv_new: can't allocate receive buffer pool for thread %s\n", w->name);
+      sr->nworkers = i + 1;
+      ddsi_secrecv_free (sr);
+      return NULL;
+    }
+  }
+  return sr;
+}
+
+dds_return_t ddsi_secrecv_start (struct ddsi_secrecv *sr)
+{
+  for (uint32_t i = 0; i < sr->nworkers; i++)
+  {
+    struct ddsi_secrecv_worker *w = &sr->workers[i];
+    dds_return_t rc;
+    if ((rc = ddsi_create_thread (&w->thrst, sr->gv, w->name, secrecv_worker_thread, w)) != DDS_RETCODE_OK)
+    {
+      struct ddsi_domaingv * const gv = sr->gv;
+      GVERROR ("ddsi_secrecv_start: failed to start thread %s\n", w->name);
+      ddsi_secrecv_stop (sr);
+      return rc;
+    }
+  }
+  return DDS_RETCODE_OK;
+}
+
+void ddsi_secrecv_stop (struct ddsi_secrecv *sr)
+{
+  for (uint32_t i = 0; i < sr->nworkers; i++)
+  {
+    struct ddsi_secrecv_worker *w = &sr->workers[i];
+    ddsrt_mutex_lock (&w->lock);
+    w->stop = true;
+    ddsrt_cond_broadcast (&w->cond);
+    ddsrt_mutex_unlock (&w->lock);
+  }
+  for (uint32_t i = 0; i < sr->nworkers; i++)
+  {
+    struct ddsi_secrecv_worker *w = &sr->workers[i];
+    if (w->thrst)
+    {
+      ddsi_join_thread (w->thrst);
+      w->thrst = NULL;
+    }
+  }
+}
+
+void ddsi_secrecv_free (struct ddsi_secrecv *sr)
+{
+  for (uint32_t i = 0; i < sr->nworkers; i++)
+  {
+    struct ddsi_secrecv_worker *w = &sr->workers[i];
+    assert (w->thrst == NULL);
+    assert (w->head == NULL);
+    if (w->rbpool)
+      ddsi_rbufpool_free (w->rbpool);
+    ddsrt_cond_destroy (&w->cond);
+    ddsrt_mutex_destroy (&w->lock);
+  }
+  ddsrt_free (sr->workers);
+  ddsrt_free (sr);
+}
+
+bool ddsi_secrecv_enqueue (struct ddsi_secrecv *sr, struct ddsi_tran_conn *conn, const ddsi_guid_prefix_t *guidprefix, struct ddsi_rmsg *rmsg, unsigned char *msg, size_t sz, const struct ddsi_network_packet_info *pktinfo)
+{
+  /* Stream-oriented connections can be closed and freed at any time, packets
+     received on them are processed by the receive thread.  Other than that,
+     only messages that are protected at the RTPS message level are handed off
+     to a worker. */
+  if (!conn->m_connless || sz < DDSI_RTPS_MESSAGE_HEADER_SIZE + DDSI_RTPS_SUBMESSAGE_HEADER_SIZE)
+    return false;
+  const ddsi_rtps_submessage_header_t *submsg = (const ddsi_rtps_submessage_header_t *) (msg + DDSI_RTPS_MESSAGE_HEADER_SIZE);
+  if (submsg->submessageId != DDSI_RTPS_SMID_SRTPS_PREFIX)
+    return false;
+
+  /* Byte order of the GUID prefix is irrelevant for selecting a worker */
+  const ddsi_rtps_header_t *hdr = (const ddsi_rtps_header_t *) msg;
+  const uint32_t h = ddsrt_mh3 (&hdr->guid_prefix, sizeof (hdr->guid_prefix), 0);
+  struct ddsi_secrecv_worker * const w = &sr->workers[h % sr->nworkers];
+
+  struct ddsi_secrecv_packet *pkt;
+  if ((pkt = ddsi_rmsg_alloc (rmsg, sizeof (*pkt))) == NULL)
+    return false;
+  ddsi_rmsg_addref (rmsg);
+  pkt->next = NULL;
+  pkt->rmsg = rmsg;
+  pkt->msg = msg;
+  pkt->conn = conn;
+  if ((pkt->has_guidprefix = (guidprefix != NULL)))
+    pkt->guidprefix = *guidprefix;
+  pkt->pktinfo = *pktinfo;
+  pkt->size = sz;
+
+  ddsrt_mutex_lock (&w->lock);
+  while (w->length >= SECRECV_MAX_QUEUED && !w->stop)
+    (void) ddsrt_cond_wait (&w->cond, &w->lock);
+  pkt->tenqueue = ddsrt_time_monotonic ();
+  if (w->head == NULL)
+  {
+    w->head = pkt;
+    ddsrt_cond_broadcast (&w->cond);
+  }
+  else
+  {
+    w->tail->next = pkt;
+  }
+  w->tail = pkt;
+  if (++w->length > w->length_max)
+    w->length_max = w->length;
+  ddsrt_mutex_unlock (&w->lock);
+  return true;
+}
+
+void ddsi_secrecv_stats (const struct ddsi_secrecv *sr, uint64_t *packets, uint64_t *bytes, uint64_t *time_queued, uint64_t *time_process, uint32_t *queue_length_max)
+{
+  *packets = *bytes = *time_queued = *time_process = 0;
+  *queue_length_max = 0;
+  for (uint32_t i = 0; i < sr->nworkers; i++)
+  {
+    struct ddsi_secrecv_worker *w = &sr->workers[i];
+    ddsrt_mutex_lock (&w->lock);
+    *packets += w->packets;
+    *bytes += w->bytes;
+    *time_queued += w->time_queued;
+    *time_process += w->time_process;
+    if (w->length_max > *queue_length_max)
+      *queue_length_max = w->length_max;
+    ddsrt_mutex_unlock (&w->lock);
+  }
+}
@@ -32,6 +32,11 @@ void ddsi_sertype_v0 (struct ddsi_sertype_v0 *dummy)
 {
   (void) dummy;
 }
+
+void ddsi_sertype_v1 (struct ddsi_sertype_v0 *dummy)
+{
+  (void) dummy;
+}
 #endif
 
 bool ddsi_sertype_equal (const struct ddsi_sertype *a, const struct ddsi_sertype *b)
@@ -165,8 +170,7 @@ void ddsi_sertype_unref (struct ddsi_sertype *sertype)
 
 void ddsi_sertype_init_props (struct ddsi_sertype *tp, const char *type_name, const struct ddsi_sertype_ops *sertype_ops, const struct ddsi_serdata_ops *serdata_ops, size_t sizeof_type, dds_data_type_properties_t data_type_props, uint32_t allowed_data_representation, uint32_t flags)
 {
-  // only one version for now
-  assert (sertype_ops->version == ddsi_sertype_v0);
+  assert (sertype_ops->version == ddsi_sertype_v0 || sertype_ops->version == ddsi_sertype_v1);
   assert ((flags & ~(uint32_t)DDSI_SERTYPE_PROPS_FLAG_MASK) == 0);
   assert (sizeof_type > 0 || !(data_type_props & DDS_DATA_TYPE_IS_MEMCPY_SAFE));
   assert (sizeof_type <= UINT32_MAX);
@@ -311,3 +315,4 @@ DDS_EXPORT extern inline struct ddsi_sertype * ddsi_sertype_derive_sertype (cons
 
 DDS_EXPORT extern inline dds_return_t ddsi_sertype_get_serialized_size(const struct ddsi_sertype *tp, enum ddsi_serdata_kind sdkind, const void *sample, size_t *size, uint16_t *enc_identifier);
 DDS_EXPORT extern inline bool ddsi_sertype_serialize_into(const struct ddsi_sertype *tp, enum ddsi_serdata_kind sdkind, const void *sample, void *dst_buffer, size_t dst_size);
+DDS_EXPORT extern inline struct ddsi_sertype_content_filter *ddsi_sertype_content_filter_new (const struct ddsi_sertype *tp, const struct ddsi_content_filter_property *cfp);
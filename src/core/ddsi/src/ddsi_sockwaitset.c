@@ -339,13 +339,18 @@ static int add_entry_locked (struct ddsi_sock_waitset * ws, struct ddsi_tran_con
       ws->entries[idx].fd = -1;
     fidx = sz;
   }
+  /* the receive thread may get an event for the socket as soon as it is added to the
+     epoll set and doesn't hold the lock, so the entry must be complete by then */
+  ws->entries[fidx].conn = conn;
+  ws->entries[fidx].fd = fd;
+  ws->entries[fidx].index = n;
   ev.events = EPOLLIN;
   ev.data.ptr = &ws->entries[fidx];
   if (epoll_ctl (ws->epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+  {
+    ws->entries[fidx].fd = -1;
     return -1;
-  ws->entries[fidx].conn = conn;
-  ws->entries[fidx].fd = fd;
-  ws->entries[fidx].index = n;
+  }
   return 1;
 }
 
@@ -18,14 +18,18 @@
 #include "ddsi__endpoint_match.h"
 #include "ddsi__radmin.h"
 #include "ddsi__proxy_endpoint.h"
+#ifdef DDS_HAS_SECURITY
+#include "ddsi__secrecv.h"
+#endif
 
-void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit)
+void ddsi_get_writer_stats (struct ddsi_writer *wr, uint64_t *rexmit_bytes, uint32_t *throttle_count, uint64_t *time_throttled, uint64_t *time_retransmit, uint64_t *filtered_count)
 {
   ddsrt_mutex_lock (&wr->e.lock);
   *rexmit_bytes = wr->rexmit_bytes;
   *throttle_count = wr->throttle_count;
   *time_throttled = wr->time_throttled;
   *time_retransmit = wr->time_retransmit;
+  *filtered_count = wr->filtered_count;
   ddsrt_mutex_unlock (&wr->e.lock);
 }
 
@@ -65,3 +69,18 @@ void ddsi_get_reader_stats (struct ddsi_reader *rd, uint64_t *discarded_bytes)
   }
   ddsrt_mutex_unlock (&rd->e.lock);
 }
+
+void ddsi_get_secrecv_stats (const struct ddsi_domaingv *gv, uint64_t *packets, uint64_t *bytes, uint64_t *time_queued, uint64_t *time_process, uint32_t *queue_length_max)
+{
+#ifdef DDS_HAS_SECURITY
+  if (gv->secrecv)
+  {
+    ddsi_secrecv_stats (gv->secrecv, packets, bytes, time_queued, time_process, queue_length_max);
+    return;
+  }
+#else
+  (void) gv;
+#endif
+  *packets = *bytes = *time_queued = *time_process = 0;
+  *queue_length_max = 0;
+}
@@ -17,6 +17,8 @@
 #include "dds/ddsrt/log.h"
 #include "dds/ddsrt/sockets.h"
 #include "dds/ddsrt/avl.h"
+#include "dds/ddsrt/bswap.h"
+#include "dds/ddsrt/eventfd.h"
 #include "dds/ddsi/ddsi_log.h"
 #include "dds/ddsi/ddsi_endpoint.h"
 #include "dds/ddsi/ddsi_domaingv.h"
@@ -28,6 +30,12 @@
 #include "ddsi__ssl.h"
 #include "ddsi__proxy_participant.h"
 #include "ddsi__sockwaitset.h"
+#include "ddsi__protocol.h"
+#include "ddsi__thread.h"
+
+#if DDSRT_HAVE_EVENTFD
+#include <poll.h>
+#endif
 
 #define INVALID_PORT (~0u)
 
@@ -40,6 +48,31 @@
   is not removed from cache but simply flagged as failed (may be subsequently
   replaced). Similarly server side sockets are not closed as are also used in socket
   wait set that manages their lifecycle.
+
+  Received data is read into a per-connection buffer (if enabled), reading as much
+  as is available rather than exactly the number of bytes requested. Multiple framed
+  DDSI messages can thus be obtained from a single recv call, which is why the
+  receive thread checks for a complete message remaining in the buffer (see
+  ddsi_tcp_conn_buffered) before waiting for the socket to become readable again.
+  The buffer is only accessed by the (single) receive thread reading from the
+  connection and so doesn't need protection by m_mutex.
+
+  If TCP/SendQueueSize is set, DDSI connections have an outbound queue: data that
+  can't be written without blocking is appended to it, and the connection is
+  registered with the sender thread of the factory that then transmits the queued
+  data as the socket becomes writable.  Where available, the sender thread blocks in
+  poll on the registered sockets and an event file descriptor that is signalled when
+  a connection is registered, otherwise it checks for new registrations periodically. Writes append to the queue for as long as
+  it is non-empty to preserve the order of the messages.  The queue is protected
+  by m_mutex; while registered with the sender thread, the sender thread holds a
+  reference to the connection.
+
+  Connections that have been handed to the receive thread hold a reference that is
+  only dropped by the receive thread once reading from it fails, which doesn't happen
+  if the connection is closed by another thread first or if the domain is shut down
+  while the connection is still open. All connections are therefore also kept in a
+  list in the factory, so that any remaining ones can be released once all threads
+  that could hold a reference have stopped.
 */
 
 union addr {
@@ -59,8 +92,42 @@ typedef struct ddsi_tcp_conn {
 #ifdef DDS_HAS_TCP_TLS
   SSL * m_ssl;
 #endif
+  unsigned char *m_rbuf; /* receive buffer, allocated on first read, unconsumed data is [m_rbuf_pos,m_rbuf_end) */
+  size_t m_rbuf_size;
+  size_t m_rbuf_pos;
+  size_t m_rbuf_end;
+  bool m_sendq_enabled;
+  bool m_sendq_registered; /* registered with sender thread */
+  bool m_sendq_failed; /* sender thread failed to write, connection is being shut down */
+  ddsrt_cond_t m_sendq_cond; /* signalled when space becomes available in the queue */
+  struct ddsi_tcp_sendq_elem *m_sendq_head;
+  struct ddsi_tcp_sendq_elem *m_sendq_tail;
+  size_t m_sendq_head_pos; /* bytes of head already written */
+  size_t m_sendq_bytes; /* bytes in queue not yet written */
+  size_t m_sendq_bytes_max;
+  uint64_t m_sendq_dropped;
+  uint64_t m_sendq_blocked;
+  struct ddsi_tcp_conn *m_sendq_next; /* protected by sender lock */
+  struct ddsi_tcp_conn *m_live_prev, *m_live_next; /* protected by factory's live lock */
 } *ddsi_tcp_conn_t;
 
+struct ddsi_tcp_sendq_elem {
+  struct ddsi_tcp_sendq_elem *next;
+  size_t size;
+  unsigned char data[];
+};
+
+struct ddsi_tcp_sender {
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  struct ddsi_thread_state *thrst; /* started on demand */
+  bool stop;
+  struct ddsi_tcp_conn *conns; /* registered connections */
+#if DDSRT_HAVE_EVENTFD
+  ddsrt_eventfd_t wakeup; /* created with the thread, signalled on registration and stop */
+#endif
+};
+
 typedef struct ddsi_tcp_listener {
   struct ddsi_tran_listener m_base;
   ddsrt_socket_t m_sock;
@@ -75,6 +142,9 @@ struct ddsi_tran_factory_tcp {
   ddsrt_mutex_t ddsi_tcp_cache_lock_g;
   ddsrt_avl_tree_t ddsi_tcp_cache_g;
   struct ddsi_tcp_conn ddsi_tcp_conn_client;
+  struct ddsi_tcp_sender m_sender;
+  ddsrt_mutex_t m_live_lock;
+  struct ddsi_tcp_conn *m_live; /* all connections that haven't been freed yet */
 #ifdef DDS_HAS_TCP_TLS
   struct ddsi_ssl_plugins ddsi_tcp_ssl_plugin;
 #endif
@@ -481,28 +551,55 @@ static ssize_t ddsi_tcp_conn_read (struct ddsi_tran_conn * conn, unsigned char *
   }
 #endif
 
-  while (true)
+  /* Consume buffered data first */
+  if (tcp->m_rbuf_pos < tcp->m_rbuf_end)
+  {
+    pos = tcp->m_rbuf_end - tcp->m_rbuf_pos;
+    if (pos > len)
+      pos = len;
+    memcpy (buf, tcp->m_rbuf + tcp->m_rbuf_pos, pos);
+    tcp->m_rbuf_pos += pos;
+  }
+
+  while (pos < len)
   {
-    n = rd (tcp, (char *) buf + pos, len - pos, &rc);
+    /* Read into the buffer as much as is available if the request is smaller than the
+       buffer, otherwise read directly into the caller's buffer to avoid copying large
+       messages.  The buffer is empty at this point. */
+    const size_t need = len - pos;
+    const bool buffered = (need < gv->config.tcp_read_buffer_size);
+    if (buffered)
+    {
+      if (tcp->m_rbuf == NULL)
+      {
+        tcp->m_rbuf_size = gv->config.tcp_read_buffer_size;
+        tcp->m_rbuf = ddsrt_malloc (tcp->m_rbuf_size);
+      }
+      tcp->m_rbuf_pos = tcp->m_rbuf_end = 0;
+      n = rd (tcp, tcp->m_rbuf, tcp->m_rbuf_size, &rc);
+    }
+    else
+    {
+      n = rd (tcp, (char *) buf + pos, need, &rc);
+    }
+
     if (n > 0)
     {
-      pos += (size_t) n;
-      if (pos == len)
+      if (!buffered)
+        pos += (size_t) n;
+      else
       {
-        if (pktinfo)
-        {
-          const int32_t kind = addrfam_to_locator_kind (tcp->m_peer_addr.a.sa_family);
-          ddsi_ipaddr_to_loc (&pktinfo->src, &tcp->m_peer_addr.a, kind);
-          pktinfo->if_index = 0;
-          pktinfo->dst.kind = DDSI_LOCATOR_KIND_INVALID;
-        }
-        return (ssize_t) pos;
+        const size_t m = ((size_t) n < need) ? (size_t) n : need;
+        memcpy ((char *) buf + pos, tcp->m_rbuf, m);
+        tcp->m_rbuf_pos = m;
+        tcp->m_rbuf_end = (size_t) n;
+        pos += m;
       }
     }
     else if (n == 0)
     {
       GVLOG (DDS_LC_TCP, "tcp read: sock %"PRIdSOCK" closed-by-peer\n", tcp->m_sock);
-      break;
+      goto fail;
     }
     else
     {
@@ -514,21 +611,52 @@ static ssize_t ddsi_tcp_conn_read (struct ddsi_tran_conn * conn, unsigned char *
             return 0;
           const int64_t timeout = gv->config.tcp_read_timeout;
           if (ddsi_tcp_select (gv, tcp->m_sock, true, pos, timeout) == false)
-            break;
+            goto fail;
         }
         else
         {
           GVLOG (DDS_LC_TCP, "tcp read: sock %"PRIdSOCK" error %"PRId32"\n", tcp->m_sock, rc);
-          break;
+          goto fail;
         }
       }
     }
   }
 
+  if (pktinfo)
+  {
+    const int32_t kind = addrfam_to_locator_kind (tcp->m_peer_addr.a.sa_family);
+    ddsi_ipaddr_to_loc (&pktinfo->src, &tcp->m_peer_addr.a, kind);
+    pktinfo->if_index = 0;
+    pktinfo->dst.kind = DDSI_LOCATOR_KIND_INVALID;
+  }
+  return (ssize_t) pos;
+
+fail:
   ddsi_tcp_cache_remove (tcp);
   return -1;
 }
 
+static bool ddsi_tcp_conn_buffered (struct ddsi_tran_conn * conn)
+{
+  /* Peeks at the DDSI header and MSG_LEN submessage at the start of the buffered data
+     to see whether it contains a complete message.  If it contains only part of one,
+     the socket becomes readable once the remainder arrives.  A malformed header is
+     reported as a complete message so that it gets handled by the receive thread. */
+  const ddsi_tcp_conn_t tcp = (ddsi_tcp_conn_t) conn;
+  const size_t avail = tcp->m_rbuf_end - tcp->m_rbuf_pos;
+  ddsi_rtps_msg_len_t ml;
+  if (avail < DDSI_RTPS_MESSAGE_HEADER_SIZE + sizeof (ml))
+    return false;
+  memcpy (&ml, tcp->m_rbuf + tcp->m_rbuf_pos + DDSI_RTPS_MESSAGE_HEADER_SIZE, sizeof (ml));
+  if (ml.smhdr.submessageId != DDSI_RTPS_SMID_ADLINK_MSG_LEN)
+    return true;
+  DDSRT_WARNING_MSVC_OFF(6326)
+  if ((ml.smhdr.flags & DDSI_RTPS_SUBMESSAGE_FLAG_ENDIANNESS) ? (DDSRT_ENDIAN != DDSRT_LITTLE_ENDIAN) : (DDSRT_ENDIAN == DDSRT_LITTLE_ENDIAN))
+    ml.length = ddsrt_bswap4u (ml.length);
+  DDSRT_WARNING_MSVC_ON(6326)
+  return ml.length <= avail;
+}
+
 static ssize_t ddsi_tcp_conn_write_plain (ddsi_tcp_conn_t conn, const void * buf, size_t len, dds_return_t *rc)
 {
   ssize_t sent = -1;
@@ -590,6 +718,430 @@ static ssize_t ddsi_tcp_block_write (ssize_t (*wr) (ddsi_tcp_conn_t, const void
   return (pos == sz) ? (ssize_t) pos : -1;
 }
 
+static ssize_t ddsi_tcp_block_writev (ddsi_tcp_conn_t conn, const ddsrt_msghdr_t *msg, size_t pos, size_t len)
+{
+  /* Write the remainder of a partially sent message, starting at offset pos.  All
+     remaining fragments are passed to sendmsg each time the socket becomes writable,
+     rather than writing them one by one, which with TCP_NODELAY set would result
+     in a separate (often tiny) TCP segment for each fragment */
+  struct ddsi_domaingv const * const gv = conn->m_base.m_base.gv;
+  const size_t niov = (size_t) msg->msg_iovlen;
+  ddsrt_iovec_t *iov = ddsrt_malloc (niov * sizeof (*iov));
+  ddsrt_msghdr_t m;
+  size_t i = 0, skip = pos;
+  int sendflags = 0;
+  dds_return_t rc;
+  ssize_t n;
+
+#ifdef MSG_NOSIGNAL
+  sendflags |= MSG_NOSIGNAL;
+#endif
+  memcpy (iov, msg->msg_iov, niov * sizeof (*iov));
+  memset (&m, 0, sizeof (m));
+  while (pos < len)
+  {
+    while (skip >= (size_t) iov[i].iov_len)
+      skip -= (size_t) iov[i++].iov_len;
+    assert (i < niov);
+    iov[i].iov_base = (char *) iov[i].iov_base + skip;
+    iov[i].iov_len -= (ddsrt_iov_len_t) skip;
+    m.msg_iov = &iov[i];
+    m.msg_iovlen = (ddsrt_msg_iovlen_t) (niov - i);
+    rc = ddsrt_sendmsg (conn->m_sock, &m, sendflags, &n);
+    if (rc == DDS_RETCODE_OK && n > 0)
+    {
+      pos += (size_t) n;
+      skip = (size_t) n;
+    }
+    else
+    {
+      skip = 0;
+      if (rc == DDS_RETCODE_TRY_AGAIN)
+      {
+        if (ddsi_tcp_select (gv, conn->m_sock, false, pos, gv->config.tcp_write_timeout) == false)
+          break;
+      }
+      else if (rc != DDS_RETCODE_INTERRUPTED)
+      {
+        GVLOG (DDS_LC_TCP, "tcp write: sock %"PRIdSOCK" error %"PRId32"\n", conn->m_sock, rc);
+        break;
+      }
+    }
+  }
+  ddsrt_free (iov);
+  return (pos == len) ? (ssize_t) pos : -1;
+}
+
+#if !DDSRT_HAVE_EVENTFD
+/* Maximum interval between checks for newly registered connections by the sender thread
+   while it is waiting for others to become writable */
+#define SENDQ_POLL_INTERVAL DDS_MSECS (10)
+#endif
+
+/* Maximum number of queued messages written in a single call */
+#define SENDQ_MAX_IOV 32
+
+static void ddsi_tcp_conn_unref (ddsi_tcp_conn_t conn);
+static void ddsi_tcp_sendq_register (ddsi_tcp_conn_t conn);
+
+static int ddsi_tcp_sendq_flags (void)
+{
+  int sendflags = 0;
+#ifdef MSG_NOSIGNAL
+  sendflags |= MSG_NOSIGNAL;
+#endif
+  return sendflags;
+}
+
+static void ddsi_tcp_sendq_discard (ddsi_tcp_conn_t conn)
+{
+  struct ddsi_tcp_sendq_elem *e;
+  while ((e = conn->m_sendq_head) != NULL)
+  {
+    conn->m_sendq_head = e->next;
+    ddsrt_free (e);
+  }
+  conn->m_sendq_tail = NULL;
+  conn->m_sendq_head_pos = 0;
+  conn->m_sendq_bytes = 0;
+  ddsrt_cond_broadcast (&conn->m_sendq_cond);
+}
+
+static void ddsi_tcp_sendq_append (ddsi_tcp_conn_t conn, const ddsrt_msghdr_t *msg, size_t pos, size_t len)
+{
+  /* Copies bytes [pos,len) of the message into the queue */
+  struct ddsi_tcp_sendq_elem *e = ddsrt_malloc (sizeof (*e) + len - pos);
+  size_t off = 0, skip = pos;
+  for (size_t i = 0; i < (size_t) msg->msg_iovlen; i++)
+  {
+    const size_t n = (size_t) msg->msg_iov[i].iov_len;
+    if (skip >= n)
+      skip -= n;
+    else
+    {
+      memcpy (e->data + off, (const char *) msg->msg_iov[i].iov_base + skip, n - skip);
+      off += n - skip;
+      skip = 0;
+    }
+  }
+  assert (off == len - pos);
+  e->next = NULL;
+  e->size = off;
+  if (conn->m_sendq_head == NULL)
+    conn->m_sendq_head = e;
+  else
+    conn->m_sendq_tail->next = e;
+  conn->m_sendq_tail = e;
+  conn->m_sendq_bytes += off;
+  if (conn->m_sendq_bytes > conn->m_sendq_bytes_max)
+    conn->m_sendq_bytes_max = conn->m_sendq_bytes;
+  if (!conn->m_sendq_registered)
+    ddsi_tcp_sendq_register (conn);
+}
+
+static bool ddsi_tcp_sendq_drain (ddsi_tcp_conn_t conn)
+{
+  /* Writes as much queued data as possible without blocking, returns true if data
+     remains queued.  On failure, discards the queue and shuts down the connection:
+     the receive thread then notices the connection is gone and cleans it up. */
+  struct ddsi_domaingv const * const gv = conn->m_base.m_base.gv;
+  const size_t bytes_before = conn->m_sendq_bytes;
+  while (conn->m_sendq_head && !conn->m_sendq_failed)
+  {
+    ddsrt_iovec_t iov[SENDQ_MAX_IOV];
+    ddsrt_msghdr_t m;
+    size_t niov = 0;
+    for (struct ddsi_tcp_sendq_elem *e = conn->m_sendq_head; e && niov < SENDQ_MAX_IOV; e = e->next, niov++)
+    {
+      const size_t skip = (niov == 0) ? conn->m_sendq_head_pos : 0;
+      iov[niov].iov_base = e->data + skip;
+      iov[niov].iov_len = (ddsrt_iov_len_t) (e->size - skip);
+    }
+    memset (&m, 0, sizeof (m));
+    m.msg_iov = iov;
+    m.msg_iovlen = (ddsrt_msg_iovlen_t) niov;
+    dds_return_t rc;
+    ssize_t n;
+    if ((rc = ddsrt_sendmsg (conn->m_sock, &m, ddsi_tcp_sendq_flags (), &n)) == DDS_RETCODE_OK)
+    {
+      size_t done = (size_t) n;
+      conn->m_sendq_bytes -= done;
+      done += conn->m_sendq_head_pos;
+      while (conn->m_sendq_head && done >= conn->m_sendq_head->size)
+      {
+        struct ddsi_tcp_sendq_elem *e = conn->m_sendq_head;
+        done -= e->size;
+        if ((conn->m_sendq_head = e->next) == NULL)
+          conn->m_sendq_tail = NULL;
+        ddsrt_free (e);
+      }
+      conn->m_sendq_head_pos = done;
+    }
+    else if (rc == DDS_RETCODE_TRY_AGAIN)
+    {
+      break;
+    }
+    else if (rc != DDS_RETCODE_INTERRUPTED)
+    {
+      GVLOG (DDS_LC_TCP, "tcp send queue: sock %"PRIdSOCK" error %"PRId32"\n", conn->m_sock, rc);
+      conn->m_sendq_failed = true;
+      ddsi_tcp_sendq_discard (conn);
+      (void) ddsrt_shutdown (conn->m_sock, DDSRT_SHUTDOWN_READ_WRITE);
+    }
+  }
+  if (conn->m_sendq_bytes < bytes_before)
+    ddsrt_cond_broadcast (&conn->m_sendq_cond);
+  return conn->m_sendq_head != NULL;
+}
+
+#if DDSRT_HAVE_EVENTFD
+typedef struct pollfd ddsi_tcp_sender_pollfd_t;
+
+static void ddsi_tcp_sender_wait (struct ddsi_tcp_sender *s, const struct ddsi_tcp_conn *conns, ddsi_tcp_sender_pollfd_t **pfds, size_t *pfds_size)
+{
+  /* Waits until one of the sockets is writable (or failed), or a connection is registered */
+  size_t n = 1;
+  for (const struct ddsi_tcp_conn *c = conns; c; c = c->m_sendq_next)
+    n++;
+  if (n > *pfds_size)
+  {
+    *pfds = ddsrt_realloc (*pfds, n * sizeof (**pfds));
+    *pfds_size = n;
+  }
+  (*pfds)[0] = (struct pollfd) { .fd = ddsrt_eventfd_get_fd (&s->wakeup), .events = POLLIN };
+  n = 1;
+  for (const struct ddsi_tcp_conn *c = conns; c; c = c->m_sendq_next)
+    (*pfds)[n++] = (struct pollfd) { .fd = c->m_sock, .events = POLLOUT };
+  if (poll (*pfds, (nfds_t) n, -1) > 0 && ((*pfds)[0].revents & POLLIN))
+    ddsrt_eventfd_drain (&s->wakeup);
+}
+#else
+typedef char ddsi_tcp_sender_pollfd_t;
+
+static void ddsi_tcp_sender_wait (struct ddsi_tcp_sender *s, const struct ddsi_tcp_conn *conns, ddsi_tcp_sender_pollfd_t **pfds, size_t *pfds_size)
+{
+  /* Without a way to interrupt select, wait for a bounded time so newly registered
+     connections get picked up.  This fallback is only used on platforms where fd_set
+     is not a bitmap indexed by the socket (Windows, lwIP), and so sockets beyond
+     FD_SETSIZE are merely not waited for, rather than overrunning the set */
+  (void) s; (void) pfds; (void) pfds_size;
+  fd_set wrset;
+  ddsrt_socket_t maxsock = 0;
+  FD_ZERO (&wrset);
+  for (const struct ddsi_tcp_conn *c = conns; c; c = c->m_sendq_next)
+  {
+#if LWIP_SOCKET == 1
+    DDSRT_WARNING_GNUC_OFF(sign-conversion)
+#endif
+    FD_SET (c->m_sock, &wrset);
+#if LWIP_SOCKET == 1
+    DDSRT_WARNING_GNUC_ON(sign-conversion)
+#endif
+    if (c->m_sock > maxsock)
+      maxsock = c->m_sock;
+  }
+  (void) ddsrt_select (maxsock + 1, NULL, &wrset, NULL, SENDQ_POLL_INTERVAL);
+}
+#endif
+
+static uint32_t ddsi_tcp_sender_thread (void *vfact)
+{
+  struct ddsi_tran_factory_tcp * const fact = vfact;
+  struct ddsi_tcp_sender * const s = &fact->m_sender;
+  ddsi_tcp_sender_pollfd_t *pfds = NULL;
+  size_t pfds_size = 0;
+  ddsrt_mutex_lock (&s->lock);
+  while (!s->stop)
+  {
+    if (s->conns == NULL)
+    {
+      ddsrt_cond_wait (&s->cond, &s->lock);
+      continue;
+    }
+
+    /* Detach the registered connections, so that connections can be registered while
+       waiting and they can be processed without holding the sender lock */
+    struct ddsi_tcp_conn *conns = s->conns;
+    s->conns = NULL;
+    ddsrt_mutex_unlock (&s->lock);
+
+    ddsi_tcp_sender_wait (s, conns, &pfds, &pfds_size);
+
+    struct ddsi_tcp_conn *remaining = NULL, *c, *next;
+    for (c = conns; c; c = next)
+    {
+      next = c->m_sendq_next;
+      ddsrt_mutex_lock (&c->m_mutex);
+      if (ddsi_tcp_sendq_drain (c))
+      {
+        ddsrt_mutex_unlock (&c->m_mutex);
+        c->m_sendq_next = remaining;
+        remaining = c;
+      }
+      else
+      {
+        c->m_sendq_registered = false;
+        ddsrt_mutex_unlock (&c->m_mutex);
+        ddsi_tcp_conn_unref (c);
+      }
+    }
+
+    ddsrt_mutex_lock (&s->lock);
+    while ((c = remaining) != NULL)
+    {
+      remaining = c->m_sendq_next;
+      c->m_sendq_next = s->conns;
+      s->conns = c;
+    }
+  }
+  ddsrt_mutex_unlock (&s->lock);
+  ddsrt_free (pfds);
+  return 0;
+}
+
+static void ddsi_tcp_sendq_register (ddsi_tcp_conn_t conn)
+{
+  /* conn->m_mutex held */
+  struct ddsi_tran_factory_tcp * const fact = (struct ddsi_tran_factory_tcp *) conn->m_base.m_factory;
+  struct ddsi_tcp_sender * const s = &fact->m_sender;
+  struct ddsi_domaingv * const gv = fact->fact.gv;
+  assert (!conn->m_sendq_registered);
+  ddsrt_mutex_lock (&s->lock);
+  if (s->thrst == NULL && !s->stop)
+  {
+    dds_return_t rc = DDS_RETCODE_OK;
+#if DDSRT_HAVE_EVENTFD
+    if ((rc = ddsrt_eventfd_init (&s->wakeup)) != DDS_RETCODE_OK)
+      GVERROR ("tcp send queue: failed to create wakeup descriptor for sender thread\n");
+#endif
+    if (rc == DDS_RETCODE_OK && ddsi_create_thread (&s->thrst, gv, "tcpsend", ddsi_tcp_sender_thread, fact) != DDS_RETCODE_OK)
+    {
+      GVERROR ("tcp send queue: failed to start sender thread\n");
+      s->thrst = NULL;
+#if DDSRT_HAVE_EVENTFD
+      ddsrt_eventfd_fini (&s->wakeup);
+#endif
+    }
+  }
+  if (s->thrst != NULL)
+  {
+    ddsrt_atomic_inc32 (&conn->m_base.m_count);
+    conn->m_sendq_registered = true;
+    conn->m_sendq_next = s->conns;
+    s->conns = conn;
+    ddsrt_cond_broadcast (&s->cond);
+#if DDSRT_HAVE_EVENTFD
+    ddsrt_eventfd_signal (&s->wakeup);
+#endif
+  }
+  else
+  {
+    /* Without a sender thread, queued data can never be written */
+    conn->m_sendq_failed = true;
+    ddsi_tcp_sendq_discard (conn);
+    (void) ddsrt_shutdown (conn->m_sock, DDSRT_SHUTDOWN_READ_WRITE);
+  }
+  ddsrt_mutex_unlock (&s->lock);
+}
+
+static void ddsi_tcp_sender_stop (struct ddsi_tran_factory_tcp *fact)
+{
+  struct ddsi_tcp_sender * const s = &fact->m_sender;
+  struct ddsi_tcp_conn *c;
+  ddsrt_mutex_lock (&s->lock);
+  s->stop = true;
+  ddsrt_cond_broadcast (&s->cond);
+#if DDSRT_HAVE_EVENTFD
+  if (s->thrst)
+    ddsrt_eventfd_signal (&s->wakeup);
+#endif
+  ddsrt_mutex_unlock (&s->lock);
+  if (s->thrst)
+  {
+    ddsi_join_thread (s->thrst);
+    s->thrst = NULL;
+#if DDSRT_HAVE_EVENTFD
+    ddsrt_eventfd_fini (&s->wakeup);
+#endif
+  }
+  while ((c = s->conns) != NULL)
+  {
+    s->conns = c->m_sendq_next;
+    ddsrt_mutex_lock (&c->m_mutex);
+    ddsi_tcp_sendq_discard (c);
+    c->m_sendq_registered = false;
+    ddsrt_mutex_unlock (&c->m_mutex);
+    ddsi_tcp_conn_unref (c);
+  }
+}
+
+static ssize_t ddsi_tcp_conn_write_queued (ddsi_tcp_conn_t conn, const ddsrt_msghdr_t *msg, size_t len, uint32_t flags)
+{
+  /* conn->m_mutex held; returns len if the message was written, queued or dropped
+     and -1 if the connection failed */
+  struct ddsi_domaingv const * const gv = conn->m_base.m_base.gv;
+  const size_t limit = gv->config.tcp_sendq_size;
+  ddsrt_mtime_t tblocked = DDSRT_MTIME_NEVER;
+  while (!conn->m_sendq_failed)
+  {
+    if (conn->m_sendq_head == NULL)
+    {
+      /* Nothing queued: try to write it immediately, queue whatever remains.  A
+         partially written message must be completed, whatever the queue size. */
+      ddsrt_msghdr_t m = *msg;
+      dds_return_t rc;
+      ssize_t n;
+      m.msg_name = NULL;
+      m.msg_namelen = 0;
+      do {
+        rc = ddsrt_sendmsg (conn->m_sock, &m, ddsi_tcp_sendq_flags (), &n);
+      } while (rc == DDS_RETCODE_INTERRUPTED);
+      if (rc == DDS_RETCODE_OK)
+      {
+        if ((size_t) n < len)
+          ddsi_tcp_sendq_append (conn, msg, (size_t) n, len);
+        return (ssize_t) len;
+      }
+      else if (rc != DDS_RETCODE_TRY_AGAIN)
+      {
+        GVLOG (DDS_LC_TCP, "tcp write: sock %"PRIdSOCK" error %"PRId32"\n", conn->m_sock, rc);
+        return -1;
+      }
+      ddsi_tcp_sendq_append (conn, msg, 0, len);
+      return (ssize_t) len;
+    }
+    else if (conn->m_sendq_bytes + len <= limit)
+    {
+      ddsi_tcp_sendq_append (conn, msg, 0, len);
+      return (ssize_t) len;
+    }
+
+    /* Queue is full */
+    const enum ddsi_tcp_sendq_policy policy =
+      (flags & DDSI_TRAN_BEST_EFFORT) ? gv->config.tcp_sendq_policy_best_effort : gv->config.tcp_sendq_policy_reliable;
+    if (policy == DDSI_TCP_SENDQ_DROP)
+    {
+      GVLOG (DDS_LC_TCP, "tcp write: sock %"PRIdSOCK" send queue full, dropping message\n", conn->m_sock);
+      conn->m_sendq_dropped++;
+      return (ssize_t) len;
+    }
+    if (tblocked.v == DDS_NEVER)
+    {
+      GVLOG (DDS_LC_TCP, "tcp write: sock %"PRIdSOCK" send queue full, blocking\n", conn->m_sock);
+      conn->m_sendq_blocked++;
+      tblocked = ddsrt_time_monotonic ();
+    }
+    const dds_duration_t remaining = gv->config.tcp_write_timeout - (ddsrt_time_monotonic ().v - tblocked.v);
+    if (remaining <= 0)
+    {
+      GVWARNING ("tcp abandoning write on socket %"PRIdSOCK": send queue full for too long\n", conn->m_sock);
+      return -1;
+    }
+    (void) ddsrt_cond_waitfor (&conn->m_sendq_cond, &conn->m_mutex, remaining);
+  }
+  return -1;
+}
+
 static size_t iovlen_sum (size_t niov, const ddsrt_iovec_t *iov)
 {
   size_t tot = 0;
@@ -665,6 +1217,15 @@ static ssize_t ddsi_tcp_conn_write (struct ddsi_tran_conn * base, const ddsi_loc
     return (ssize_t) len;
   }
 
+  if (conn->m_sendq_enabled)
+  {
+    ret = ddsi_tcp_conn_write_queued (conn, &msg, len, flags);
+    ddsrt_mutex_unlock (&conn->m_mutex);
+    if (ret == -1)
+      ddsi_tcp_cache_remove (conn);
+    return ret;
+  }
+
 #ifdef DDS_HAS_TCP_TLS
   if (gv->config.ssl_enable)
   {
@@ -749,16 +1310,23 @@ static ssize_t ddsi_tcp_conn_write (struct ddsi_tran_conn * base, const ddsi_loc
     }
 #endif
 
-    assert (msg.msg_iov[i].iov_len > 0);
-    while (ret >= (ssize_t) msg.msg_iov[i].iov_len)
+    if (wr == ddsi_tcp_conn_write_plain)
     {
-      ret -= (ssize_t) msg.msg_iov[i++].iov_len;
+      ret = ddsi_tcp_block_writev (conn, &msg, (size_t) ret, len);
     }
-    assert (i < (int) msg.msg_iovlen);
-    ret = ddsi_tcp_block_write (wr, conn, (const char *) msg.msg_iov[i].iov_base + ret, msg.msg_iov[i].iov_len - (size_t) ret);
-    while (ret > 0 && ++i < (int) msg.msg_iovlen)
+    else
     {
-      ret = ddsi_tcp_block_write (wr, conn, msg.msg_iov[i].iov_base, msg.msg_iov[i].iov_len);
+      assert (msg.msg_iov[i].iov_len > 0);
+      while (ret >= (ssize_t) msg.msg_iov[i].iov_len)
+      {
+        ret -= (ssize_t) msg.msg_iov[i++].iov_len;
+      }
+      assert (i < (int) msg.msg_iovlen);
+      ret = ddsi_tcp_block_write (wr, conn, (const char *) msg.msg_iov[i].iov_base + ret, msg.msg_iov[i].iov_len - (size_t) ret);
+      while (ret > 0 && ++i < (int) msg.msg_iovlen)
+      {
+        ret = ddsi_tcp_block_write (wr, conn, msg.msg_iov[i].iov_base, msg.msg_iov[i].iov_len);
+      }
     }
   }
 
@@ -900,6 +1468,9 @@ static struct ddsi_tran_conn * ddsi_tcp_accept (struct ddsi_tran_listener * list
     tcp->m_ssl = ssl;
 #endif
     tcp->m_base.m_listener = listener;
+    /* Only DDSI connections have a send queue, the debug monitor also uses TCP */
+    if (listener != gv->listener)
+      tcp->m_sendq_enabled = false;
     tcp->m_base.m_conn = listener->m_connections;
     listener->m_connections = &tcp->m_base;
 
@@ -945,6 +1516,7 @@ static void ddsi_tcp_base_init (const struct ddsi_tran_factory_tcp *fact, const
   base->m_base.m_trantype = DDSI_TRAN_CONN;
   base->m_base.m_handle_fn = ddsi_tcp_conn_handle;
   base->m_read_fn = ddsi_tcp_conn_read;
+  base->m_buffered_fn = ddsi_tcp_conn_buffered;
   base->m_write_fn = ddsi_tcp_conn_write;
   base->m_peer_locator_fn = ddsi_tcp_conn_peer_locator;
   base->m_disable_multiplexing_fn = 0;
@@ -958,6 +1530,12 @@ static ddsi_tcp_conn_t ddsi_tcp_new_conn (struct ddsi_tran_factory_tcp *fact, co
   memset (conn, 0, sizeof (*conn));
   ddsi_tcp_base_init (fact, interf, &conn->m_base);
   ddsrt_mutex_init (&conn->m_mutex);
+  ddsrt_cond_init (&conn->m_sendq_cond);
+  conn->m_sendq_enabled = (fact->fact.gv->config.tcp_sendq_size > 0);
+#ifdef DDS_HAS_TCP_TLS
+  if (fact->fact.gv->config.ssl_enable)
+    conn->m_sendq_enabled = false;
+#endif
   conn->m_sock = DDSRT_INVALID_SOCKET;
   (void)memcpy(&conn->m_peer_addr, peer, (size_t)ddsrt_sockaddr_get_size(peer));
   conn->m_peer_port = ddsrt_sockaddr_get_port (peer);
@@ -965,6 +1543,11 @@ static ddsi_tcp_conn_t ddsi_tcp_new_conn (struct ddsi_tran_factory_tcp *fact, co
   conn->m_base.m_base.m_port = INVALID_PORT;
   ddsi_tcp_conn_set_socket (conn, sock);
 
+  ddsrt_mutex_lock (&fact->m_live_lock);
+  if ((conn->m_live_next = fact->m_live) != NULL)
+    conn->m_live_next->m_live_prev = conn;
+  fact->m_live = conn;
+  ddsrt_mutex_unlock (&fact->m_live_lock);
   return conn;
 }
 
@@ -1027,10 +1610,59 @@ static void ddsi_tcp_conn_delete (ddsi_tcp_conn_t conn)
   {
     ddsi_tcp_sock_free (gv, conn->m_sock, "connection");
   }
+  assert (conn->m_sendq_head == NULL && !conn->m_sendq_registered);
+  ddsrt_mutex_lock (&fact->m_live_lock);
+  if (conn->m_live_prev)
+    conn->m_live_prev->m_live_next = conn->m_live_next;
+  else
+    fact->m_live = conn->m_live_next;
+  if (conn->m_live_next)
+    conn->m_live_next->m_live_prev = conn->m_live_prev;
+  ddsrt_mutex_unlock (&fact->m_live_lock);
+  ddsrt_cond_destroy (&conn->m_sendq_cond);
   ddsrt_mutex_destroy (&conn->m_mutex);
+  ddsrt_free (conn->m_rbuf);
   ddsrt_free (conn);
 }
 
+static void ddsi_tcp_conn_unref (ddsi_tcp_conn_t conn)
+{
+  if (ddsrt_atomic_dec32_ov (&conn->m_base.m_count) == 1)
+    ddsi_tcp_conn_delete (conn);
+}
+
+size_t ddsi_tcp_get_sendq_stats (struct ddsi_tran_factory *fact_generic, struct ddsi_tcp_sendq_stats **stats)
+{
+  struct ddsi_tran_factory_tcp * const fact = (struct ddsi_tran_factory_tcp *) fact_generic;
+  ddsrt_avl_iter_t iter;
+  ddsi_tcp_node_t n;
+  size_t count = 0, size = 0;
+  *stats = NULL;
+  ddsrt_mutex_lock (&fact->ddsi_tcp_cache_lock_g);
+  for (n = ddsrt_avl_iter_first (&ddsi_tcp_treedef, &fact->ddsi_tcp_cache_g, &iter); n; n = ddsrt_avl_iter_next (&iter))
+  {
+    ddsi_tcp_conn_t conn = n->m_conn;
+    if (!conn->m_sendq_enabled)
+      continue;
+    if (count == size)
+    {
+      size = (size == 0) ? 4 : 2 * size;
+      *stats = ddsrt_realloc (*stats, size * sizeof (**stats));
+    }
+    struct ddsi_tcp_sendq_stats * const s = &(*stats)[count++];
+    ddsi_ipaddr_to_loc (&s->peer, &conn->m_peer_addr.a, addrfam_to_locator_kind (conn->m_peer_addr.a.sa_family));
+    s->peer.port = conn->m_peer_port;
+    ddsrt_mutex_lock (&conn->m_mutex);
+    s->queued = conn->m_sendq_bytes;
+    s->queued_max = conn->m_sendq_bytes_max;
+    s->dropped = conn->m_sendq_dropped;
+    s->blocked = conn->m_sendq_blocked;
+    ddsrt_mutex_unlock (&conn->m_mutex);
+  }
+  ddsrt_mutex_unlock (&fact->ddsi_tcp_cache_lock_g);
+  return count;
+}
+
 static void ddsi_tcp_close_conn (struct ddsi_tran_conn * tc)
 {
   struct ddsi_tran_factory_tcp * const fact_tcp = (struct ddsi_tran_factory_tcp *) tc->m_factory;
@@ -1127,8 +1759,30 @@ static void ddsi_tcp_release_factory (struct ddsi_tran_factory *fact_cmn)
 {
   struct ddsi_tran_factory_tcp * const fact = (struct ddsi_tran_factory_tcp *) fact_cmn;
   struct ddsi_domaingv const * const gv = fact->fact.gv;
+  ddsi_tcp_sender_stop (fact);
+  ddsrt_cond_destroy (&fact->m_sender.cond);
+  ddsrt_mutex_destroy (&fact->m_sender.lock);
   ddsrt_avl_free (&ddsi_tcp_treedef, &fact->ddsi_tcp_cache_g, ddsi_tcp_node_free);
   ddsrt_mutex_destroy (&fact->ddsi_tcp_cache_lock_g);
+
+  /* Receive threads, sender thread and debug monitor have all stopped and the cache
+     has dropped its references, so whatever references remain belong to a receive
+     thread that will never release them.  It always holds at most one. */
+  ddsi_tcp_conn_t conn, next;
+  for (conn = fact->m_live; conn; conn = next)
+  {
+    next = conn->m_live_next;
+    const uint32_t refc = ddsrt_atomic_ld32 (&conn->m_base.m_count);
+    if (refc == 1)
+      ddsi_conn_free (&conn->m_base);
+    else
+    {
+      char buff[DDSI_LOCSTRLEN];
+      sockaddr_to_string_with_port (buff, sizeof (buff), &conn->m_peer_addr.a);
+      GVWARNING ("tcp connection to %s still has %"PRIu32" references at de-initialization\n", buff, refc);
+    }
+  }
+  ddsrt_mutex_destroy (&fact->m_live_lock);
 #ifdef DDS_HAS_TCP_TLS
   if (fact->ddsi_tcp_ssl_plugin.fini)
   {
@@ -1278,6 +1932,9 @@ int ddsi_tcp_init (struct ddsi_domaingv *gv)
 
   ddsrt_avl_init (&ddsi_tcp_treedef, &fact->ddsi_tcp_cache_g);
   ddsrt_mutex_init (&fact->ddsi_tcp_cache_lock_g);
+  ddsrt_mutex_init (&fact->m_live_lock);
+  ddsrt_mutex_init (&fact->m_sender.lock);
+  ddsrt_cond_init (&fact->m_sender.cond);
 
   GVLOG (DDS_LC_CONFIG, "tcp initialized\n");
   return 0;
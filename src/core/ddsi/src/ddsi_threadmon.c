@@ -15,6 +15,7 @@
 #include "dds/ddsrt/sync.h"
 #include "dds/ddsrt/time.h"
 #include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/rusage.h"
 #include "dds/ddsrt/hopscotch.h"
 #include "dds/ddsi/ddsi_threadmon.h"
 #include "dds/ddsi/ddsi_unused.h"
@@ -22,6 +23,10 @@
 #include "ddsi__log.h"
 #include "ddsi__thread.h"
 #include "ddsi__receive.h"
+#include "ddsi__radmin.h"
+#include "ddsi__xevent.h"
+
+#define THREADMON_CPU (DDSRT_HAVE_RUSAGE && DDSRT_HAVE_THREAD_LIST)
 
 struct alive_vt {
   bool alive;
@@ -33,7 +38,18 @@ struct threadmon_domain {
   unsigned n_not_alive;
   size_t msgpos;
   char msg[2048];
+  uint64_t xev_handled;      /* timed events handled at the previous sample */
+  uint64_t xev_lateness_sum; /* total lateness of those */
+};
+
+#if THREADMON_CPU
+struct threadmon_cpu {
+  ddsrt_thread_list_id_t tid;
+  int64_t cputime;           /* user + system time at the last sample (ns) */
+  double util, prev_util;    /* fraction of a core used in the last two intervals, < 0 if unknown */
+  char name[32];             /* lazily retrieved, empty if not yet known */
 };
+#endif
 
 struct ddsi_threadmon {
   int keepgoing;
@@ -48,6 +64,14 @@ struct ddsi_threadmon {
   ddsrt_cond_t cond;
   struct ddsi_thread_state *thrst;
   struct ddsrt_hh *domains;
+
+  ddsrt_mtime_t tsample;     /* time of last CPU/scheduling sample */
+#if THREADMON_CPU
+  size_t tids_size;
+  ddsrt_thread_list_id_t *tids;
+  size_t ncpu;
+  struct threadmon_cpu *cpu;
+#endif
 };
 
 static struct threadmon_domain *find_domain (struct ddsi_threadmon *sl, const struct ddsi_domaingv *gv)
@@ -78,6 +102,130 @@ static void update_av_ary (struct ddsi_threadmon *sl, uint32_t nthreads)
   }
 }
 
+#if THREADMON_CPU
+static bool sample_cpu (struct ddsi_threadmon *sl, double dt)
+{
+  /* Same approach as ddsperf: list all threads in the process and get the
+     CPU time of each, which covers application threads as well as ours */
+  dds_return_t n;
+  while ((n = ddsrt_thread_list (sl->tids, sl->tids_size)) > 0 && (size_t) n > sl->tids_size)
+  {
+    sl->tids_size = (size_t) n + 8;
+    sl->tids = ddsrt_realloc (sl->tids, sl->tids_size * sizeof (*sl->tids));
+  }
+  if (n <= 0)
+    return false;
+
+  struct threadmon_cpu *cpu = ddsrt_malloc ((size_t) n * sizeof (*cpu));
+  size_t ncpu = 0, j = 0;
+  for (size_t i = 0; i < (size_t) n; i++)
+  {
+    ddsrt_rusage_t u;
+    if (ddsrt_getrusage_anythread (sl->tids[i], &u) < 0)
+      continue; /* presumably it terminated in the meantime */
+    struct threadmon_cpu * const c = &cpu[ncpu++];
+    c->tid = sl->tids[i];
+    c->cputime = u.utime + u.stime;
+    c->util = c->prev_util = -1.0;
+    c->name[0] = 0;
+
+    /* The thread list is in practice in the same order every time, so
+       looking for the previous sample where the last one was found is
+       almost always an immediate hit */
+    size_t k;
+    for (k = 0; k < sl->ncpu && sl->cpu[j].tid != c->tid; k++)
+      j = (j + 1 < sl->ncpu) ? j + 1 : 0;
+    const struct threadmon_cpu * const prev = (k < sl->ncpu) ? &sl->cpu[j] : NULL;
+    /* a decrease in CPU time means the id got reused by a new thread */
+    if (prev && prev->cputime <= c->cputime)
+    {
+      c->util = (double) (c->cputime - prev->cputime) / 1e9 / dt;
+      c->prev_util = prev->util;
+      memcpy (c->name, prev->name, sizeof (c->name));
+    }
+  }
+  ddsrt_free (sl->cpu);
+  sl->cpu = cpu;
+  sl->ncpu = ncpu;
+  return true;
+}
+
+static const char *cpu_name (struct threadmon_cpu *c)
+{
+  /* Threads typically set their name immediately after creation, so getting
+     it on first use rather than on first sighting avoids seeing the name
+     inherited from the creating thread */
+  if (c->name[0] == 0 && ddsrt_thread_getname_anythread (c->tid, c->name, sizeof (c->name)) < 0)
+    (void) snprintf (c->name, sizeof (c->name), "(unknown)");
+  return c->name;
+}
+
+static void log_cpu (struct ddsi_threadmon *sl, const struct ddsi_domaingv *gv)
+{
+  const double thres = gv->config.thread_cpu_warning_threshold / 100.0;
+  if (thres > 0.0)
+  {
+    for (size_t i = 0; i < sl->ncpu; i++)
+    {
+      struct threadmon_cpu * const c = &sl->cpu[i];
+      if (c->util < 0.0)
+        continue;
+      const bool above = (c->util >= thres), was_above = (c->prev_util >= thres);
+      if (above != was_above)
+        DDS_CLOG (above ? DDS_LC_WARNING : DDS_LC_INFO, &gv->logconfig, "thread %s CPU utilization %.0f%% %s threshold of %"PRIu32"%%\n",
+                  cpu_name (c), 100.0 * c->util, above ? "exceeds" : "once again below", gv->config.thread_cpu_warning_threshold);
+    }
+  }
+  if (gv->logconfig.c.mask & DDS_LC_TIMING)
+  {
+    char line[1024];
+    size_t pos = 0;
+    line[0] = 0;
+    for (size_t i = 0; i < sl->ncpu && pos < sizeof (line); i++)
+    {
+      struct threadmon_cpu * const c = &sl->cpu[i];
+      if (c->util >= 0.005)
+        pos += (size_t) snprintf (line + pos, sizeof (line) - pos, " %s:%.0f%%", cpu_name (c), 100.0 * c->util);
+    }
+    DDS_CLOG (DDS_LC_TIMING, &gv->logconfig, "threadcpu:%s\n", line);
+  }
+}
+#endif /* THREADMON_CPU */
+
+static void log_sched (struct threadmon_domain *tmdom)
+{
+  /* Wakeup-to-run latencies: the delay in handling timed events by the event
+     thread (averaged over the interval) and the time from a delivery queue
+     becoming non-empty to processing by the delivery thread (both only if
+     stage latency statistics are enabled), plus the queue depths */
+  const struct ddsi_domaingv * const gv = tmdom->gv;
+  struct ddsi_xeventq_stats xst;
+  struct ddsi_dqueue_stats dqst[2];
+  ddsi_xeventq_get_stats (gv->xevents, &xst);
+  ddsi_dqueue_get_stats (gv->builtins_dqueue, &dqst[0]);
+  ddsi_dqueue_get_stats (gv->user_dqueue, &dqst[1]);
+  const uint64_t n = xst.n_handled - tmdom->xev_handled;
+  char tevlat[64] = "";
+  if (gv->config.stage_latency_statistics)
+  {
+    const double late = (n == 0) ? 0.0 : (double) (xst.lateness_sum - tmdom->xev_lateness_sum) / (double) n / 1e3;
+    (void) snprintf (tevlat, sizeof (tevlat), " late %.0fus max %.0fus", late, (double) xst.lateness.max / 1e3);
+  }
+  tmdom->xev_handled = xst.n_handled;
+  tmdom->xev_lateness_sum = xst.lateness_sum;
+  char dqlat[64] = "";
+  if (gv->lathist_dqueue)
+  {
+    struct ddsi_lathist_summary s;
+    ddsi_lathist_summarize (gv->lathist_dqueue, &s);
+    (void) snprintf (dqlat, sizeof (dqlat), " dqwake p99 %.0fus max %.0fus", (double) s.p99 / 1e3, (double) s.max / 1e3);
+  }
+  DDS_CLOG (DDS_LC_TIMING, &gv->logconfig,
+            "sched: tev %"PRIu64"%s timed %"PRIu32" queued %zu dq %s:%"PRIu32" %s:%"PRIu32"%s\n",
+            n, tevlat, xst.n_timed, xst.n_nontimed,
+            dqst[0].name, dqst[0].nof_samples, dqst[1].name, dqst[1].nof_samples, dqlat);
+}
+
 static uint32_t threadmon_thread (void *vsl)
 {
   struct ddsi_threadmon * const sl = vsl;
@@ -202,6 +350,39 @@ static uint32_t threadmon_thread (void *vsl)
     }
 
     was_alive = (n_not_alive == 0);
+
+    /* CPU utilization and scheduling: once a second is more than enough and
+       gives more meaningful utilization numbers than the liveliness check
+       interval */
+    if (tnow.v >= sl->tsample.v + DDS_SECS (1))
+    {
+      bool want_cpu = false, want_sched = false;
+      for (struct threadmon_domain *tmdom = ddsrt_hh_iter_first (sl->domains, &it); tmdom != NULL; tmdom = ddsrt_hh_iter_next (&it))
+      {
+        want_cpu = want_cpu || tmdom->gv->config.thread_cpu_warning_threshold > 0 || (tmdom->gv->logconfig.c.mask & DDS_LC_TIMING);
+        want_sched = want_sched || (tmdom->gv->logconfig.c.mask & DDS_LC_TIMING);
+      }
+#if THREADMON_CPU
+      const bool have_cpu = want_cpu && sample_cpu (sl, (double) (tnow.v - sl->tsample.v) / 1e9);
+      if (!want_cpu)
+        sl->ncpu = 0; /* stale by the time it is needed again */
+#else
+      (void) want_cpu;
+#endif
+      if (want_cpu || want_sched)
+      {
+        for (struct threadmon_domain *tmdom = ddsrt_hh_iter_first (sl->domains, &it); tmdom != NULL; tmdom = ddsrt_hh_iter_next (&it))
+        {
+#if THREADMON_CPU
+          if (have_cpu)
+            log_cpu (sl, tmdom->gv);
+#endif
+          if (tmdom->gv->logconfig.c.mask & DDS_LC_TIMING)
+            log_sched (tmdom);
+        }
+      }
+      sl->tsample = tnow;
+    }
   }
   ddsrt_mutex_unlock (&sl->lock);
   return 0;
@@ -235,6 +416,13 @@ struct ddsi_threadmon *ddsi_threadmon_new (int64_t liveliness_monitoring_interva
   /* service lease update thread dynamically grows av_ary */
   sl->av_ary_size = 0;
   sl->av_ary = NULL;
+  sl->tsample = ddsrt_time_monotonic ();
+#if THREADMON_CPU
+  sl->tids_size = 0;
+  sl->tids = NULL;
+  sl->ncpu = 0;
+  sl->cpu = NULL;
+#endif
 
   ddsrt_mutex_init (&sl->lock);
   ddsrt_cond_init (&sl->cond);
@@ -267,6 +455,8 @@ void ddsi_threadmon_register_domain (struct ddsi_threadmon *sl, const struct dds
     tmdom->n_not_alive = 0;
     tmdom->msgpos = 0;
     tmdom->msg[0] = 0;
+    tmdom->xev_handled = 0;
+    tmdom->xev_lateness_sum = 0;
 
     ddsrt_mutex_lock (&sl->lock);
     ddsrt_hh_add_absent (sl->domains, tmdom);
@@ -311,5 +501,9 @@ void ddsi_threadmon_free (struct ddsi_threadmon *sl)
   ddsrt_mutex_destroy (&sl->lock);
   ddsrt_hh_free (sl->domains);
   ddsrt_free (sl->av_ary);
+#if THREADMON_CPU
+  ddsrt_free (sl->tids);
+  ddsrt_free (sl->cpu);
+#endif
   ddsrt_free (sl);
 }
@@ -36,6 +36,7 @@ extern inline int ddsi_listener_locator (struct ddsi_tran_listener * listener, d
 extern inline int ddsi_listener_listen (struct ddsi_tran_listener * listener);
 extern inline struct ddsi_tran_conn * ddsi_listener_accept (struct ddsi_tran_listener * listener);
 extern inline ssize_t ddsi_conn_read (struct ddsi_tran_conn * conn, unsigned char * buf, size_t len, bool allow_spurious, struct ddsi_network_packet_info *pktinfo);
+extern inline bool ddsi_conn_has_buffered_message (struct ddsi_tran_conn * conn);
 extern inline ssize_t ddsi_conn_write (struct ddsi_tran_conn * conn, const ddsi_locator_t *dst, const ddsi_tran_write_msgfrags_t *msgfrags, uint32_t flags);
 extern inline uint32_t ddsi_tran_get_locator_port (const struct ddsi_tran_factory *factory, const ddsi_locator_t *loc);
 extern inline void ddsi_tran_set_locator_port (const struct ddsi_tran_factory *factory, ddsi_locator_t *loc, uint32_t port);
@@ -180,6 +181,7 @@ void ddsi_factory_conn_init (const struct ddsi_tran_factory *factory, const stru
   conn->m_factory = (struct ddsi_tran_factory *) factory;
   conn->m_interf = interf;
   conn->m_base.gv = factory->gv;
+  conn->m_buffered_fn = 0;
 }
 
 void ddsi_conn_disable_multiplexing (struct ddsi_tran_conn * conn)
@@ -21,6 +21,7 @@
 #include "dds/ddsi/ddsi_tkmap.h"
 #include "dds/ddsi/ddsi_serdata.h"
 #include "dds/ddsi/ddsi_sertype.h"
+#include "dds/ddsi/ddsi_lathist.h"
 #include "ddsi__entity.h"
 #include "ddsi__participant.h"
 #include "ddsi__entity_index.h"
@@ -414,7 +415,7 @@ static void transmit_sample_lgmsg_unlocks_wr (struct ddsi_xpack *xp, struct ddsi
     }
     ddsrt_mutex_unlock (&wr->e.lock);
 
-    if(fmsg) ddsi_xpack_addmsg (xp, fmsg, 0);
+    if(fmsg) ddsi_xpack_addmsg (xp, fmsg, wr->reliable ? 0 : DDSI_TRAN_BEST_EFFORT);
     if(hmsg) ddsi_xpack_addmsg (xp, hmsg, 0);
 
     ddsrt_mutex_lock (&wr->e.lock);
@@ -450,7 +451,7 @@ static void transmit_sample_unlocks_wr (struct ddsi_xpack *xp, struct ddsi_write
   {
     struct ddsi_xmsg *fmsg;
     if (ddsi_create_fragment_message_simple (wr, seq, serdata, &fmsg) >= 0)
-      ddsi_xpack_addmsg (xp, fmsg, 0);
+      ddsi_xpack_addmsg (xp, fmsg, wr->reliable ? 0 : DDSI_TRAN_BEST_EFFORT);
   }
 
   if (wr->heartbeat_xevent)
@@ -812,6 +813,69 @@ prd_is_deleting:
   return r;
 }
 
+static bool writer_all_readers_reject_sample_wrlock_held (const struct ddsi_writer *wr, const struct ddsi_serdata *serdata)
+{
+  /* Only if every matched proxy reader has a content filter the writer can
+     evaluate is it possible to skip the sample altogether */
+  if (wr->num_readers == 0 || wr->num_readers_content_filtered != wr->num_readers)
+    return false;
+  ddsrt_avl_iter_t it;
+  for (const struct ddsi_wr_prd_match *m = ddsrt_avl_iter_first (&ddsi_wr_readers_treedef, &wr->readers, &it); m; m = ddsrt_avl_iter_next (&it))
+  {
+    assert (m->content_filter != NULL);
+    if (m->content_filter->accept (m->content_filter, serdata))
+      return false;
+  }
+  return true;
+}
+
+void ddsi_writer_send_filtered_gaps_wrlock_held (struct ddsi_writer *wr)
+{
+  /* Reliable readers need to be told the filtered samples won't be coming,
+     otherwise they would keep requesting them; best-effort ones don't care.
+     The filtered samples are always consecutive, so one GAP per reader
+     suffices. */
+  struct ddsi_domaingv * const gv = wr->e.gv;
+  ASSERT_MUTEX_HELD (&wr->e.lock);
+  if (wr->filtered_gap_start == wr->filtered_gap_end)
+    return;
+  ddsrt_avl_iter_t it;
+  for (const struct ddsi_wr_prd_match *m = ddsrt_avl_iter_first (&ddsi_wr_readers_treedef, &wr->readers, &it); m; m = ddsrt_avl_iter_next (&it))
+  {
+    struct ddsi_proxy_reader *prd;
+    struct ddsi_xmsg *gap;
+    struct ddsi_gap_info gi;
+    if (!m->is_reliable || m->via_psmx)
+      continue;
+    if ((prd = ddsi_entidx_lookup_proxy_reader_guid (gv->entity_index, &m->prd_guid)) == NULL)
+      continue;
+    ddsi_gap_info_init (&gi);
+    gi.gapstart = wr->filtered_gap_start;
+    gi.gapend = wr->filtered_gap_end;
+    if ((gap = ddsi_gap_info_create_gap (wr, prd, &gi)) != NULL)
+      ddsi_qxev_msg (wr->evq, gap);
+  }
+  wr->filtered_gap_start = wr->filtered_gap_end;
+}
+
+static void writer_add_filtered_gap_wrlock_held (struct ddsi_writer *wr, ddsi_seqno_t seq, ddsrt_mtime_t tnow)
+{
+  /* Sending a GAP for each filtered sample to each reader is expensive, so
+     they are accumulated until the writer sends data or a heartbeat (or the
+     set of matching readers changes).  Scheduling a heartbeat bounds the
+     time a reader has to wait for the GAP. */
+  if (wr->num_reliable_readers == 0)
+    return;
+  if (seq != wr->filtered_gap_end)
+  {
+    ddsi_writer_send_filtered_gaps_wrlock_held (wr);
+    wr->filtered_gap_start = seq;
+  }
+  wr->filtered_gap_end = seq + 1;
+  if (wr->heartbeat_xevent)
+    ddsi_writer_hbcontrol_note_asyncwrite (wr, tnow);
+}
+
 static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpack *xp, struct ddsi_writer *wr, struct ddsi_serdata *serdata, struct ddsi_tkmap_instance *tk, int gc_allowed)
 {
   struct ddsi_domaingv const * const gv = wr->e.gv;
@@ -887,7 +951,9 @@ static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpa
   serdata->twrite = tnow;
 
   seq = ++wr->seq;
-  if ((r = insert_sample_in_whc (wr, seq, serdata, tk)) < 0)
+  r = insert_sample_in_whc (wr, seq, serdata, tk);
+  ddsi_lathist_record_since (wr->lathist_whc, tnow);
+  if (r < 0)
   {
     /* Failure of some kind */
     ddsrt_mutex_unlock (&wr->e.lock);
@@ -909,8 +975,22 @@ static int write_sample (struct ddsi_thread_state * const thrst, struct ddsi_xpa
     ddsi_writer_update_seq_xmit (wr, seq);
     ddsrt_mutex_unlock (&wr->e.lock);
   }
+  else if (writer_all_readers_reject_sample_wrlock_held (wr, serdata))
+  {
+    /* None of the readers wants it: send GAPs instead of the data.  The
+       sample stays in the WHC just like any other, if a reader changes its
+       filter before acknowledging it, it can still be retransmitted. */
+    GVTRACE ("filtered %"PRIu64"\n", seq);
+    writer_add_filtered_gap_wrlock_held (wr, seq, tnow);
+    wr->filtered_count++;
+    ddsi_writer_update_seq_xmit (wr, seq);
+    ddsrt_mutex_unlock (&wr->e.lock);
+  }
   else
   {
+    /* Readers can't deliver this sample before they know the filtered
+       ones preceding it won't be coming */
+    ddsi_writer_send_filtered_gaps_wrlock_held (wr);
     /* Note the subtlety of enqueueing with the lock held but
        transmitting without holding the lock. Still working on
        cleaning that up. */
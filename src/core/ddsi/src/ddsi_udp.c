@@ -206,7 +206,7 @@ static ssize_t ddsi_udp_conn_read (struct ddsi_tran_conn * conn_cmn, unsigned ch
     translate_pktinfo (pktinfo, &msghdr, conn->m_base.m_base.m_port, src.a.sa_family == AF_INET6);
   }
 
-  if (gv->pcap_fp)
+  if (gv->pcap)
   {
     union addr dest;
     socklen_t dest_len = sizeof (dest);
@@ -298,7 +298,7 @@ static ssize_t ddsi_udp_conn_write (struct ddsi_tran_conn * conn_cmn, const ddsi
     }
   }
 
-  if (nsent > 0 && gv->pcap_fp)
+  if (nsent > 0 && gv->pcap)
   {
     union addr sa;
     socklen_t alen = sizeof (sa);
@@ -43,6 +43,7 @@ struct ddsi_xevent
   ddsrt_fibheap_node_t heapnode;
   struct ddsi_xeventq *evq;
   ddsrt_mtime_t tsched;
+  ddsrt_mtime_t tdue; /* max (tsched, time it was scheduled), only if measuring lateness */
 
   enum cb_sync_on_delete_state sync_state;
   union {
@@ -109,6 +110,13 @@ struct ddsi_xeventq {
   size_t ntxl_length;
   ddsrt_mtime_t ntxl_t_last_update;
   uint64_t ntxl_length_time;
+
+  /* For monitoring: number of events in the heap (including those pending
+     deletion), number of timed events handled and how late they were */
+  uint32_t n_timed;
+  uint64_t n_handled;
+  uint64_t lateness_sum;
+  struct ddsi_lathist *lateness;
 };
 
 static uint32_t xevent_thread (void *vxevq);
@@ -261,6 +269,16 @@ static int nontimed_xevent_in_queue (struct ddsi_xeventq *evq, struct ddsi_xeven
 }
 #endif
 
+static void set_tdue (struct ddsi_xevent *ev)
+{
+  // events are often scheduled "now" by passing a time in the past (even 0),
+  // lateness is then measured relative to the time it was scheduled
+  if (ev->evq->lateness == NULL)
+    return;
+  const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  ev->tdue = (ev->tsched.v < tnow.v) ? tnow : ev->tsched;
+}
+
 static void free_xevent (struct ddsi_xevent *ev)
 {
   ddsrt_free (ev);
@@ -281,6 +299,7 @@ static void ddsi_delete_xevent_nosync (struct ddsi_xeventq *evq, struct ddsi_xev
   {
     ev->tsched.v = TSCHED_DELETE;
     ddsrt_fibheap_insert (&evq_xevents_fhdef, &evq->xevents, ev);
+    evq->n_timed++;
   }
   /* TSCHED_DELETE is absolute minimum time, so chances are we need to
      wake up the thread.  The superfluous signal is harmless. */
@@ -296,6 +315,7 @@ static void ddsi_delete_xevent_sync (struct ddsi_xeventq *evq, struct ddsi_xeven
     {
       assert (ev->tsched.v != TSCHED_DELETE);
       ddsrt_fibheap_delete (&evq_xevents_fhdef, &evq->xevents, ev);
+      evq->n_timed--;
       ev->tsched.v = DDS_NEVER;
     }
     if (ev->sync_state == CSODS_EXECUTING)
@@ -349,7 +369,9 @@ int ddsi_resched_xevent_if_earlier (struct ddsi_xevent *ev, ddsrt_mtime_t tsched
     {
       ev->tsched = tsched;
       ddsrt_fibheap_insert (&evq_xevents_fhdef, &evq->xevents, ev);
+      evq->n_timed++;
     }
+    set_tdue (ev);
     is_resched = 1;
     if (tsched.v < tbefore.v)
       ddsrt_cond_broadcast (&evq->cond);
@@ -405,7 +427,9 @@ static void qxev_insert (struct ddsi_xevent *ev)
   if (ev->tsched.v != DDS_NEVER)
   {
     ddsrt_mtime_t tbefore = earliest_in_xeventq (evq);
+    set_tdue (ev);
     ddsrt_fibheap_insert (&evq_xevents_fhdef, &evq->xevents, ev);
+    evq->n_timed++;
     if (ev->tsched.v < tbefore.v)
       ddsrt_cond_broadcast (&evq->cond);
   }
@@ -448,6 +472,10 @@ struct ddsi_xeventq * ddsi_xeventq_new (struct ddsi_domaingv *gv, size_t max_que
   evq->ntxl_length_time = 0;
   evq->ntxl_length = 0;
   evq->ntxl_t_last_update = ddsrt_time_monotonic ();
+  evq->n_timed = 0;
+  evq->n_handled = 0;
+  evq->lateness_sum = 0;
+  evq->lateness = gv->config.stage_latency_statistics ? ddsi_lathist_new () : NULL;
   return evq;
 }
 
@@ -508,6 +536,7 @@ void ddsi_xeventq_free (struct ddsi_xeventq *evq)
   }
 
   assert (ddsrt_avl_is_empty (&evq->msg_xevents));
+  ddsi_lathist_free (evq->lateness);
   ddsrt_cond_destroy (&evq->cond);
   ddsrt_mutex_destroy (&evq->lock);
   ddsrt_free (evq);
@@ -594,10 +623,18 @@ static void handle_xevents (struct ddsi_thread_state * const thrst, struct ddsi_
     while (earliest_in_xeventq (xevq).v <= tnow.v)
     {
       struct ddsi_xevent *xev = ddsrt_fibheap_extract_min (&evq_xevents_fhdef, &xevq->xevents);
+      xevq->n_timed--;
       if (xev->tsched.v == TSCHED_DELETE)
         free_xevent (xev);
       else
       {
+        xevq->n_handled++;
+        if (xevq->lateness)
+        {
+          const int64_t lateness = (tnow.v > xev->tdue.v) ? tnow.v - xev->tdue.v : 0;
+          xevq->lateness_sum += (uint64_t) lateness;
+          ddsi_lathist_record (xevq->lateness, lateness);
+        }
         ddsi_thread_state_awake_to_awake_no_nest (thrst);
         handle_timed_xevent (xevq, xev, xp, tnow);
         cont = true;
@@ -617,6 +654,22 @@ static void handle_xevents (struct ddsi_thread_state * const thrst, struct ddsi_
   ASSERT_MUTEX_HELD (&xevq->lock);
 }
 
+void ddsi_xeventq_get_stats (struct ddsi_xeventq *evq, struct ddsi_xeventq_stats *stats)
+{
+  ddsrt_mutex_lock (&evq->lock);
+  stats->n_timed = evq->n_timed;
+  stats->n_nontimed = evq->ntxl_length;
+  stats->queued_rexmit_bytes = evq->queued_rexmit_bytes;
+  stats->queued_rexmit_msgs = evq->queued_rexmit_msgs;
+  stats->n_handled = evq->n_handled;
+  stats->lateness_sum = evq->lateness_sum;
+  ddsrt_mutex_unlock (&evq->lock);
+  if (evq->lateness)
+    ddsi_lathist_summarize (evq->lateness, &stats->lateness);
+  else
+    memset (&stats->lateness, 0, sizeof (stats->lateness));
+}
+
 void ddsi_xeventq_step (struct ddsi_xeventq *evq)
 {
   struct ddsi_thread_state * const thrst = ddsi_lookup_thread_state ();
@@ -28,6 +28,7 @@
 #include "dds/ddsi/ddsi_domaingv.h"
 #include "dds/ddsi/ddsi_serdata.h"
 #include "dds/ddsi/ddsi_freelist.h"
+#include "dds/ddsi/ddsi_lathist.h"
 #include "ddsi__protocol.h"
 #include "ddsi__addrset.h"
 #include "ddsi__misc.h"
@@ -170,7 +171,9 @@ struct ddsi_xpack
   } dstaddr;
 
   bool includes_rexmit;
+  bool best_effort; /* all messages added with DDSI_TRAN_BEST_EFFORT */
   struct ddsi_xmsg_chain included_msgs;
+  ddsrt_mtime_t tfirst; /* time first message got added, only if gv->lathist_xpack */
 
 #ifdef DDS_HAS_NETWORK_PARTITIONS
   uint32_t encoderId;
@@ -1069,6 +1072,7 @@ static void ddsi_xpack_reinit (struct ddsi_xpack *xp)
   xp->call_flags = 0;
   xp->msg_len.length = 0;
   xp->includes_rexmit = false;
+  xp->best_effort = false;
   xp->included_msgs.latest = NULL;
   xp->maxdelay = DDS_INFINITY;
 #ifdef DDS_HAS_SECURITY
@@ -1119,6 +1123,7 @@ void ddsi_xpack_free (struct ddsi_xpack *xp)
 
 static ssize_t ddsi_xpack_send_rtps(struct ddsi_xpack * xp, const ddsi_xlocator_t *loc)
 {
+  const uint32_t flags = xp->call_flags | (xp->best_effort ? DDSI_TRAN_BEST_EFFORT : 0);
   ssize_t ret = -1;
 
 #ifdef DDS_HAS_SECURITY
@@ -1130,7 +1135,7 @@ static ssize_t ddsi_xpack_send_rtps(struct ddsi_xpack * xp, const ddsi_xlocator_
                       loc->conn,
                       &loc->c,
                       xp->msgfrags,
-                      xp->call_flags,
+                      flags,
                       &(xp->msg_len),
                       (xp->dstmode == NN_XMSG_DST_ONE || xp->dstmode == NN_XMSG_DST_ALL_UC),
                       &(xp->sec_info),
@@ -1139,7 +1144,7 @@ static ssize_t ddsi_xpack_send_rtps(struct ddsi_xpack * xp, const ddsi_xlocator_
   else
 #endif /* DDS_HAS_SECURITY */
   {
-    ret = ddsi_conn_write (loc->conn, &loc->c, xp->msgfrags, xp->call_flags);
+    ret = ddsi_conn_write (loc->conn, &loc->c, xp->msgfrags, flags);
   }
 
   return ret;
@@ -1216,6 +1221,9 @@ static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
 
   assert (xp->dstmode != NN_XMSG_DST_UNSET);
 
+  ddsi_lathist_record_since (gv->lathist_xpack, xp->tfirst);
+  const ddsrt_mtime_t tsend = ddsi_lathist_start (gv->lathist_send);
+
   if (gv->logconfig.c.mask & DDS_LC_TRACE)
   {
     int i;
@@ -1256,6 +1264,7 @@ static void ddsi_xpack_send_real (struct ddsi_xpack *xp)
       break;
   }
   GVTRACE (" ]\n");
+  ddsi_lathist_record_since (gv->lathist_send, tsend);
   if (calls)
   {
     GVLOG (DDS_LC_TRAFFIC, "traffic-xmit (%lu) %"PRIu32"\n", (unsigned long) calls, xp->msg_len.length);
@@ -1436,9 +1445,9 @@ static int ddsi_xpack_mayaddmsg (const struct ddsi_xpack *xp, const struct ddsi_
     return 0;
   }
 
-  /* Check if different call semantics */
+  /* Check if different call semantics, best-effort-ness is merely advisory */
 
-  if (xp->call_flags != flags)
+  if (xp->call_flags != (flags & ~(uint32_t) DDSI_TRAN_BEST_EFFORT))
   {
     return 0;
   }
@@ -1524,6 +1533,7 @@ int ddsi_xpack_addmsg (struct ddsi_xpack *xp, struct ddsi_xmsg *m, const uint32_
 
   if (niov == 0)
   {
+    xp->tfirst = ddsi_lathist_start (gv->lathist_xpack);
     copy_addressing_info (xp, m);
     xp->hdr.guid_prefix = m->data->src.guid_prefix;
     xp->msgfrags->iov[niov].iov_base = (void*) &xp->hdr;
@@ -1646,7 +1656,8 @@ int ddsi_xpack_addmsg (struct ddsi_xpack *xp, struct ddsi_xmsg *m, const uint32_
   }
   else
   {
-    xp->call_flags = flags;
+    xp->call_flags = flags & ~(uint32_t) DDSI_TRAN_BEST_EFFORT;
+    xp->best_effort = (xpo_niov == 0 || xp->best_effort) && (flags & DDSI_TRAN_BEST_EFFORT);
     if (ddsi_xmsg_is_rexmit (m))
       xp->includes_rexmit = true;
     ddsi_xmsg_chain_add (&xp->included_msgs, m);
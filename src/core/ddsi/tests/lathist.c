@@ -0,0 +1,93 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdint.h>
+
+#include "dds/ddsi/ddsi_lathist.h"
+#include "CUnit/Test.h"
+
+CU_Test (ddsi_lathist, empty)
+{
+  struct ddsi_lathist *h = ddsi_lathist_new ();
+  struct ddsi_lathist_summary s;
+  ddsi_lathist_summarize (h, &s);
+  CU_ASSERT_EQUAL (s.count, 0);
+  CU_ASSERT_EQUAL (s.p50, 0);
+  CU_ASSERT_EQUAL (s.max, 0);
+  ddsi_lathist_free (h);
+}
+
+CU_Test (ddsi_lathist, exact_small_values)
+{
+  struct ddsi_lathist *h = ddsi_lathist_new ();
+  struct ddsi_lathist_summary s;
+  for (int64_t v = 1; v <= 10; v++)
+    ddsi_lathist_record (h, v);
+  ddsi_lathist_record (h, -5); // clamped to 0
+  ddsi_lathist_summarize (h, &s);
+  CU_ASSERT_EQUAL (s.count, 11);
+  CU_ASSERT_EQUAL (s.p50, 5);
+  CU_ASSERT_EQUAL (s.p90, 9);
+  CU_ASSERT_EQUAL (s.max, 10);
+  ddsi_lathist_free (h);
+}
+
+CU_Test (ddsi_lathist, relative_error)
+{
+  struct ddsi_lathist *h = ddsi_lathist_new ();
+  struct ddsi_lathist_summary s;
+  // one value per iteration, so max is the upper bound of the bucket holding v
+  for (uint64_t v = 17; v < ((uint64_t) 1 << 40); v = v * 3 + 1)
+  {
+    ddsi_lathist_record (h, (int64_t) v);
+    ddsi_lathist_summarize (h, &s);
+    CU_ASSERT_FATAL (s.max >= v);
+    CU_ASSERT_FATAL (s.max - v <= v >> DDSI_LATHIST_SUBBITS);
+  }
+  // anything beyond the range lands in the last bucket
+  ddsi_lathist_record (h, INT64_MAX);
+  ddsi_lathist_summarize (h, &s);
+  CU_ASSERT (s.max >= ((uint64_t) 1 << DDSI_LATHIST_MAXEXP) - 1);
+  ddsi_lathist_free (h);
+}
+
+CU_Test (ddsi_lathist, percentiles)
+{
+  struct ddsi_lathist *h = ddsi_lathist_new ();
+  struct ddsi_lathist_summary s;
+  ddsi_lathist_record_n (h, 1000, 90);
+  ddsi_lathist_record_n (h, 100000, 9);
+  ddsi_lathist_record (h, 10000000);
+  ddsi_lathist_summarize (h, &s);
+  CU_ASSERT_EQUAL (s.count, 100);
+  CU_ASSERT (s.p50 >= 1000 && s.p50 < 1000 + (1000 >> DDSI_LATHIST_SUBBITS));
+  CU_ASSERT (s.p90 >= 1000 && s.p90 < 1000 + (1000 >> DDSI_LATHIST_SUBBITS));
+  CU_ASSERT (s.p99 >= 100000 && s.p99 < 100000 + (100000 >> DDSI_LATHIST_SUBBITS));
+  CU_ASSERT (s.max >= 10000000 && s.max < 10000000 + (10000000 >> DDSI_LATHIST_SUBBITS));
+  ddsi_lathist_free (h);
+}
+
+CU_Test (ddsi_lathist, bucket_upper_bounds)
+{
+  // bounds must be increasing and contiguous for histograms to be mergeable
+  struct ddsi_lathist *h = ddsi_lathist_new ();
+  for (uint32_t i = 0; i < DDSI_LATHIST_NBUCKETS - 1; i++)
+  {
+    const uint64_t ub = ddsi_lathist_bucket_upper_bound (i);
+    if (i > 0)
+      CU_ASSERT_FATAL (ub > ddsi_lathist_bucket_upper_bound (i - 1));
+    ddsi_lathist_record (h, (int64_t) ub);
+    CU_ASSERT_EQUAL_FATAL (ddsrt_atomic_ld32 (&h->bucket[i]), 1);
+    ddsi_lathist_record (h, (int64_t) ub + 1);
+    CU_ASSERT_EQUAL_FATAL (ddsrt_atomic_ld32 (&h->bucket[i + 1]), 1);
+    ddsrt_atomic_st32 (&h->bucket[i + 1], 0);
+  }
+  ddsi_lathist_free (h);
+}
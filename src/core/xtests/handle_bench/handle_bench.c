@@ -0,0 +1,139 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "dds/dds.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/time.h"
+#include "dds__handles.h"
+
+/* Measures how many times per second threads can pin and unpin an entity
+   handle, which is what every operation on an entity does first.  Each
+   thread either uses a handle of its own, like application threads that
+   each write with their own writer, or all threads use the same handle.
+
+   usage: handle_bench [DURATION-MS [MAX-THREADS]]
+
+   Pinning must never fail and must always return the entity that was
+   asked for, if it does, the exit status is non-zero. */
+
+#define MAX_THREADS 64
+
+struct pin_arg {
+  ddsrt_atomic_uint32_t *stop;
+  dds_entity_t entity;
+  uint64_t npins;
+  uint64_t nfailed;
+  uint64_t nwrong;
+};
+
+static uint32_t pin_unpin_thread (void *varg)
+{
+  struct pin_arg * const arg = varg;
+  while (!ddsrt_atomic_ld32 (arg->stop))
+  {
+    struct dds_handle_link *link;
+    if (dds_handle_pin (arg->entity, &link) != DDS_RETCODE_OK)
+      arg->nfailed++;
+    else
+    {
+      if (link->hdl != arg->entity)
+        arg->nwrong++;
+      dds_handle_unpin (link);
+      arg->npins++;
+    }
+  }
+  return 0;
+}
+
+static bool run (const char *mode, uint32_t nthreads, const dds_entity_t *entities, dds_duration_t duration)
+{
+  ddsrt_atomic_uint32_t stop = DDSRT_ATOMIC_UINT32_INIT (0);
+  struct pin_arg args[MAX_THREADS];
+  ddsrt_thread_t tids[MAX_THREADS];
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  for (uint32_t i = 0; i < nthreads; i++)
+  {
+    args[i] = (struct pin_arg) { .stop = &stop, .entity = entities[i], .npins = 0, .nfailed = 0, .nwrong = 0 };
+    if (ddsrt_thread_create (&tids[i], "pin", &tattr, pin_unpin_thread, &args[i]) != DDS_RETCODE_OK)
+    {
+      fprintf (stderr, "failed to create thread\n");
+      exit (2);
+    }
+  }
+  const dds_time_t tstart = dds_time ();
+  dds_sleepfor (duration);
+  ddsrt_atomic_st32 (&stop, 1);
+  for (uint32_t i = 0; i < nthreads; i++)
+    (void) ddsrt_thread_join (tids[i], NULL);
+  const double dt = (double) (dds_time () - tstart) / 1e9;
+
+  uint64_t npins = 0, nfailed = 0, nwrong = 0, nmin = UINT64_MAX;
+  for (uint32_t i = 0; i < nthreads; i++)
+  {
+    npins += args[i].npins;
+    nfailed += args[i].nfailed;
+    nwrong += args[i].nwrong;
+    if (args[i].npins < nmin)
+      nmin = args[i].npins;
+  }
+  printf ("%-7s %2"PRIu32" threads: %8.2f Mpins/s total %8.2f Mpins/s per thread (slowest %.2f)",
+          mode, nthreads, (double) npins / dt / 1e6, (double) npins / nthreads / dt / 1e6, (double) nmin / dt / 1e6);
+  if (nfailed || nwrong)
+    printf (" %"PRIu64" failed %"PRIu64" wrong", nfailed, nwrong);
+  printf ("\n");
+  return nfailed == 0 && nwrong == 0 && nmin > 0;
+}
+
+int main (int argc, char **argv)
+{
+  dds_duration_t duration = DDS_SECS (1);
+  uint32_t max_threads = 16;
+  if (argc > 1)
+    duration = DDS_MSECS (atoi (argv[1]));
+  if (argc > 2)
+    max_threads = (uint32_t) atoi (argv[2]);
+  if (duration <= 0 || max_threads < 1 || max_threads > MAX_THREADS)
+  {
+    fprintf (stderr, "usage: %s [DURATION-MS [MAX-THREADS]]\n", argv[0]);
+    return 2;
+  }
+
+  const dds_entity_t pp = dds_create_participant (DDS_DOMAIN_DEFAULT, NULL, NULL);
+  if (pp < 0)
+  {
+    fprintf (stderr, "dds_create_participant: %s\n", dds_strretcode (pp));
+    return 2;
+  }
+  dds_entity_t own[MAX_THREADS], shared[MAX_THREADS];
+  for (uint32_t i = 0; i < max_threads; i++)
+  {
+    if ((own[i] = dds_create_guardcondition (pp)) < 0)
+    {
+      fprintf (stderr, "dds_create_guardcondition: %s\n", dds_strretcode (own[i]));
+      return 2;
+    }
+    shared[i] = own[0];
+  }
+
+  bool ok = true;
+  for (uint32_t nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+    ok = run ("own", nthreads, own, duration) && ok;
+  for (uint32_t nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+    ok = run ("shared", nthreads, shared, duration) && ok;
+
+  (void) dds_delete (DDS_CYCLONEDDS_HANDLE);
+  return ok ? 0 : 1;
+}
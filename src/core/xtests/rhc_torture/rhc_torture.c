@@ -575,6 +575,14 @@ static dds_entity_t readcond_wrapper (dds_entity_t reader, uint32_t mask, dds_qu
   return dds_create_readcondition (reader, mask);
 }
 
+static dds_entity_t key_querycond_wrapper (dds_entity_t reader, uint32_t mask, dds_querycondition_filter_fn filter)
+{
+  if (filter == qcpred_key)
+    return dds_create_key_querycondition (reader, mask, filter);
+  else
+    return dds_create_querycondition (reader, mask, filter);
+}
+
 static struct ddsi_domaingv *get_gv (dds_entity_t e)
 {
   struct ddsi_domaingv *gv;
@@ -1151,7 +1159,8 @@ int main (int argc, char **argv)
     } zztab[] = {
       { readcond_wrapper, 0, 0 },
       { dds_create_querycondition, qcpred_key, qcpred_attr2 },
-      { dds_create_querycondition, qcpred_attr2, qcpred_attr3 }
+      { dds_create_querycondition, qcpred_attr2, qcpred_attr3 },
+      { key_querycond_wrapper, qcpred_key, qcpred_attr2 }
     };
     for (int zz = 0; zz < (int) (sizeof (zztab) / sizeof (zztab[0])); zz++)
       if (zz + 2 >= first)
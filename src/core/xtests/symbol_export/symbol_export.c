@@ -30,6 +30,8 @@
 #include "dds/ddsrt/random.h"
 #include "dds/ddsrt/retcode.h"
 #include "dds/ddsrt/log.h"
+#include "dds/ddsrt/bintrace.h"
+#include "dds/ddsrt/threadring.h"
 #include "dds/ddsrt/sockets.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/string.h"
@@ -47,6 +49,9 @@
 #if DDSRT_HAVE_RUSAGE
 #include "dds/ddsrt/rusage.h"
 #endif
+#if DDSRT_HAVE_EVENTFD
+#include "dds/ddsrt/eventfd.h"
+#endif
 
 #include "dds/ddsi/ddsi_config.h"
 #include "dds/ddsi/ddsi_thread.h"
@@ -180,6 +185,7 @@ int main (int argc, char **argv)
   dds_get_type_name (1, ptr, 0);
   dds_set_topic_filter_and_arg (1, 0, ptr);
   dds_set_topic_filter_extended (1, ptr);
+  dds_set_topic_filter_predicates (1, 0, ptr);
   dds_get_topic_filter_and_arg (1, ptr, ptr);
   dds_get_topic_filter_extended (1, ptr);
   dds_create_subscriber (1, ptr, ptr);
@@ -209,8 +215,12 @@ int main (int argc, char **argv)
   dds_writecdr (1, ptr);
   dds_forwardcdr (1, ptr);
   dds_write_ts (1, ptr, 0);
+  dds_write_n (1, ptr, 0);
+  dds_write_n_ts (1, ptr, 0, 0);
+  dds_writecdr_n (1, ptr, 0);
   dds_create_readcondition (1, 0);
   dds_create_querycondition (1, 0, 0);
+  dds_create_key_querycondition (1, 0, 0);
   dds_create_guardcondition (1);
   dds_set_guardcondition (1, 0);
   dds_read_guardcondition (1, ptr);
@@ -222,6 +232,7 @@ int main (int argc, char **argv)
   dds_waitset_set_trigger (1, 0);
   dds_waitset_wait (1, ptr, 0, 0);
   dds_waitset_wait_until (1, ptr, 0, 0);
+  dds_waitset_get_fd (1, ptr);
   dds_peek (1, ptr, ptr, 0, 0);
   dds_peek_mask (1, ptr, ptr, 0, 0, 0);
   dds_peek_instance (1, ptr, ptr, 0, 0, 1);
@@ -256,6 +267,8 @@ int main (int argc, char **argv)
   dds_peek_with_collector (1, 0, 1, 0, test_collect_sample, ptr);
   dds_read_with_collector (1, 0, 1, 0, test_collect_sample, ptr);
   dds_take_with_collector (1, 0, 1, 0, test_collect_sample, ptr);
+  dds_read_deferred (1, ptr, ptr, 0, 0, 0, 0, ptr);
+  dds_take_deferred (1, ptr, ptr, 0, 0, 0, 0, ptr);
   dds_lookup_instance (1, ptr);
   dds_instance_get_key (1, 1, ptr);
   dds_begin_coherent (1);
@@ -469,6 +482,7 @@ int main (int argc, char **argv)
   // dds_rhs.h
   dds_rhc_associate (ptr, NULL, NULL, NULL);
   dds_rhc_store (ptr, NULL, NULL, NULL);
+  dds_rhc_store_n (ptr, 0, NULL, NULL, NULL, NULL);
   dds_rhc_unregister_wr (ptr, NULL);
   dds_rhc_relinquish_ownership (ptr, 1);
   dds_rhc_set_qos (ptr, ptr);
@@ -526,6 +540,9 @@ int main (int argc, char **argv)
   dds_stream_extract_key_from_key (ptr, ptr2, 0, ptr3, ptr4);
   dds_stream_extract_keyBE_from_data (ptr, ptr2, ptr3, ptr4);
   dds_stream_extract_keyBE_from_key (ptr, ptr2, 0, ptr3, ptr4);
+  dds_stream_member_path (ptr, 0, ptr2, ptr3, 0);
+  dds_stream_locate_member (ptr, ptr2, 0, ptr3);
+  dds_stream_member_at_path (ptr, 0, ptr2, ptr3);
   dds_cdrstream_desc_from_topic_desc (ptr, ptr2);
   dds_cdrstream_desc_init (ptr, ptr2, 0, 0, 0, ptr3, ptr4, 0);
   dds_cdrstream_desc_fini (ptr, ptr2);
@@ -546,6 +563,8 @@ int main (int argc, char **argv)
   dds_loaned_sample_unref (ptr);
   dds_reader_store_loaned_sample (1, ptr);
   dds_reader_store_loaned_sample_wr_metadata (0, ptr, 0, 0, 0);
+  dds_reader_store_loaned_samples (1, 0, ptr);
+  dds_reader_store_loaned_samples_wr_metadata (0, 0, ptr, 0, 0, 0);
 
 #ifdef DDS_HAS_SECURITY
   // dds_security_timed_cb.h
@@ -654,6 +673,7 @@ int main (int argc, char **argv)
   // ddsi_sertype.h
   struct dds_type_consistency_enforcement_qospolicy tce = { 0, false, false, false, false, false };
   ddsi_sertype_v0 (ptr);
+  ddsi_sertype_v1 (ptr);
   ddsi_sertype_init_props (ptr, ptr, ptr, ptr, 0, 0, 0, 0);
   ddsi_sertype_init_flags (ptr, ptr, ptr, ptr, 0);
   ddsi_sertype_init (ptr, ptr, ptr, ptr, 0);
@@ -1096,6 +1116,15 @@ int main (int argc, char **argv)
   ddsrt_netstat_get (ptr, ptr);
 #endif
 
+#if DDSRT_HAVE_EVENTFD
+  // ddsrt/eventfd.h
+  ddsrt_eventfd_init (ptr);
+  ddsrt_eventfd_fini (ptr);
+  ddsrt_eventfd_get_fd (ptr);
+  ddsrt_eventfd_signal (ptr);
+  ddsrt_eventfd_drain (ptr);
+#endif
+
 #if DDSRT_HAVE_RUSAGE && DDSRT_HAVE_THREAD_LIST
   // ddsrt/rusage.h
   ddsrt_thread_list_id_t tids[1];
@@ -1119,6 +1148,22 @@ int main (int argc, char **argv)
   dds_set_log_mask (0); // ROS 2 rmw_cyclonedds_cpp needs this, probably erroneously
   dds_get_log_mask ();
 
+  // ddsrt/bintrace.h
+  ddsrt_bintrace_new (ptr, 0, 0);
+  ddsrt_bintrace_free (ptr);
+  ddsrt_bintrace_decode (ptr, ptr);
+
+  // ddsrt/threadring.h
+  ddsrt_thread_ring_set_init (ptr, 0, 0, 0, 0, ptr);
+  ddsrt_thread_ring_set_fini (ptr);
+  ddsrt_thread_ring_get (ptr);
+  ddsrt_thread_ring_reserve (ptr, 0, ptr);
+  ddsrt_thread_ring_copy_in (ptr, 0, ptr, 0);
+  ddsrt_thread_ring_copy_out (ptr, 0, ptr, 0);
+  ddsrt_thread_ring_commit (ptr, 0);
+  ddsrt_thread_ring_consume (ptr, 0);
+  ddsrt_thread_ring_set_drain (ptr, 0, ptr);
+
   // ddsrt/sockets.h
 #if DDSRT_HAVE_GETHOSTNAME
   ddsrt_gethostname (ptr, 0);
@@ -0,0 +1,99 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+/** @file
+ *
+ * @brief Binary trace output
+ *
+ * Binary tracing records the address of the format string and the raw
+ * arguments of each trace call in a per-thread lock-free ring buffer. A
+ * background thread drains the rings into a file, which can be converted
+ * into the regular text format by @ref ddsrt_bintrace_decode.
+ */
+#ifndef DDSRT_BINTRACE_H
+#define DDSRT_BINTRACE_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "dds/export.h"
+#include "dds/ddsrt/attributes.h"
+#include "dds/ddsrt/retcode.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+struct ddsrt_bintrace;
+
+/**
+ * @brief Create a binary trace writer
+ *
+ * Writes the file header and starts the thread that copies the contents of
+ * the per-thread ring buffers to the file.
+ *
+ * @param[in] fp        File to write to, it remains owned by the caller
+ * @param[in] domid     Domain id to include in the decoded output
+ * @param[in] ringsize  Size of each per-thread ring buffer in bytes, rounded
+ *                      up to a power of 2
+ *
+ * @returns the binary trace writer, or NULL on failure
+ */
+DDS_EXPORT struct ddsrt_bintrace *
+ddsrt_bintrace_new (FILE *fp, uint32_t domid, uint32_t ringsize)
+  ddsrt_nonnull_all;
+
+/**
+ * @brief Flush all buffered trace records and free the trace writer
+ *
+ * No thread may call @ref ddsrt_bintrace_vlog on it once this has been
+ * called. The file is not closed.
+ */
+DDS_EXPORT void
+ddsrt_bintrace_free (struct ddsrt_bintrace *bt)
+  ddsrt_nonnull_all;
+
+/**
+ * @brief Record a trace message
+ *
+ * The format string must remain valid until the trace writer has been
+ * freed (in practice: it must be a string literal). Messages are dropped
+ * (and the number of dropped messages recorded) if the calling thread's
+ * ring buffer is full.
+ */
+DDS_EXPORT void
+ddsrt_bintrace_vlog (struct ddsrt_bintrace *bt, const char *fmt, va_list ap)
+  ddsrt_nonnull ((1, 2));
+
+/**
+ * @brief Convert a binary trace file to the text format
+ *
+ * @param[in] in   Binary trace file
+ * @param[in] out  Output file
+ *
+ * @returns a dds_return_t indicating success or failure
+ *
+ * @retval DDS_RETCODE_OK
+ *             The trace was converted
+ * @retval DDS_RETCODE_BAD_PARAMETER
+ *             The input is not a binary trace or is corrupt
+ * @retval DDS_RETCODE_OUT_OF_RESOURCES
+ *             Memory allocation failed
+ */
+DDS_EXPORT dds_return_t
+ddsrt_bintrace_decode (FILE *in, FILE *out)
+  ddsrt_nonnull_all;
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSRT_BINTRACE_H */
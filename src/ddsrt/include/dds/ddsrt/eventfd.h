@@ -0,0 +1,82 @@
+// Copyright(c) 2026 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef DDSRT_EVENTFD_H
+#define DDSRT_EVENTFD_H
+
+#include "dds/export.h"
+#include "dds/config.h"
+#include "dds/ddsrt/retcode.h"
+
+#if DDSRT_HAVE_EVENTFD
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief File descriptor that can be made readable to wake up a thread blocked
+ * in poll/select/epoll on it
+ *
+ * This is an eventfd on Linux and a pipe on other platforms.
+ */
+typedef struct ddsrt_eventfd {
+  int fds[2]; /**< read and write end, identical for an eventfd */
+} ddsrt_eventfd_t;
+
+/**
+ * @brief Create a non-blocking, close-on-exec event file descriptor in the
+ * non-readable state
+ *
+ * @param[out] ev  event file descriptor to initialize
+ *
+ * @returns DDS_RETCODE_OK or DDS_RETCODE_OUT_OF_RESOURCES
+ */
+DDS_EXPORT dds_return_t
+ddsrt_eventfd_init (
+  ddsrt_eventfd_t *ev);
+
+/**
+ * @brief Close the event file descriptor
+ */
+DDS_EXPORT void
+ddsrt_eventfd_fini (
+  ddsrt_eventfd_t *ev);
+
+/**
+ * @brief File descriptor to poll for readability
+ */
+DDS_EXPORT int
+ddsrt_eventfd_get_fd (
+  const ddsrt_eventfd_t *ev);
+
+/**
+ * @brief Make the file descriptor readable
+ *
+ * Signalling an already readable file descriptor is allowed and has no effect.
+ */
+DDS_EXPORT void
+ddsrt_eventfd_signal (
+  ddsrt_eventfd_t *ev);
+
+/**
+ * @brief Make the file descriptor non-readable again
+ */
+DDS_EXPORT void
+ddsrt_eventfd_drain (
+  ddsrt_eventfd_t *ev);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* DDSRT_HAVE_EVENTFD */
+
+#endif /* DDSRT_EVENTFD_H */
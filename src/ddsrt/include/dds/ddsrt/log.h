@@ -261,6 +261,23 @@ dds_log_cfg_init(
     FILE *log_fp,
     FILE *trace_fp);
 
+struct ddsrt_bintrace;
+
+/**
+ * @brief Make a log configuration write trace messages in binary form
+ *
+ * Trace messages are then recorded using @ref ddsrt_bintrace_vlog instead of
+ * being formatted and written to the trace sink. Messages in the log
+ * categories are also recorded, in addition to being written to the log sink.
+ *
+ * @param[in,out] cfg  Log configuration initialised by #dds_log_cfg_init
+ * @param[in]     bt   Binary trace writer, or NULL for text tracing
+ */
+void
+dds_log_cfg_set_bintrace(
+    struct ddsrt_log_cfg *cfg,
+    struct ddsrt_bintrace *bt);
+
 /**
  * @brief Write a log or trace message for a specific logging configuraiton
  * (categories, id, sinks).
@@ -0,0 +1,176 @@
+// Copyright(c) 2026 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+/** @file
+ *
+ * @brief Per-thread single-producer, single-consumer byte rings
+ *
+ * A ring set gives every thread that produces data a ring buffer of its own,
+ * so that producing never takes a lock, while a single consumer drains the
+ * rings of all threads. A thread's ring is created on first use and found
+ * again through thread-local storage. It is removed from the set once it has
+ * been drained after the producing thread terminated or evicted it from its
+ * thread-local storage (a thread can use a few ring sets at the same time).
+ *
+ * Positions are free-running 32-bit counters, the ring size is a power of 2.
+ */
+#ifndef DDSRT_THREADRING_H
+#define DDSRT_THREADRING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dds/export.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/sync.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Ring buffer of one producing thread
+ *
+ * Users embed it as the first member of a larger structure for any
+ * per-thread state of their own.
+ */
+struct ddsrt_thread_ring {
+  struct ddsrt_thread_ring *next; /**< next ring in the set, owned by the set */
+  uint32_t size; /**< size of buf in bytes */
+  ddsrt_atomic_uint32_t refc; /**< producing thread and set */
+  ddsrt_atomic_uint32_t orphan; /**< set once the producing thread no longer uses it */
+  unsigned char *buf;
+  char pad0[64];
+  ddsrt_atomic_uint32_t head; /**< written by producing thread */
+  char pad1[64];
+  ddsrt_atomic_uint32_t tail; /**< written by consumer */
+  char pad2[64];
+};
+
+/**
+ * @brief Initializes the user part of a newly created ring
+ *
+ * Called in the producing thread before the ring becomes visible to the
+ * consumer, returning false causes the ring not to be created.
+ */
+typedef bool (*ddsrt_thread_ring_init_fn) (struct ddsrt_thread_ring *r, void *arg);
+
+/**
+ * @brief Releases the resources of the user part of a ring
+ *
+ * Called once, when the set is freed or, if that is earlier, when the last
+ * reference to the ring is dropped. Also called if the init function failed.
+ */
+typedef void (*ddsrt_thread_ring_release_fn) (struct ddsrt_thread_ring *r);
+
+/**
+ * @brief Processes the data in a ring while draining a set
+ *
+ * The data is in [tail,head); the ring is not removed from the set before the
+ * next drain, so the function may retain the pointer and consume the data
+ * later using @ref ddsrt_thread_ring_consume.
+ */
+typedef void (*ddsrt_thread_ring_drain_fn) (struct ddsrt_thread_ring *r, uint32_t tail, uint32_t head, void *arg);
+
+/**
+ * @brief Set of per-thread rings
+ */
+struct ddsrt_thread_ring_set {
+  uint32_t serial; /**< identifies the set in thread-local storage */
+  uint32_t ringsize;
+  size_t objsize;
+  ddsrt_thread_ring_init_fn init;
+  ddsrt_thread_ring_release_fn release;
+  void *arg;
+  ddsrt_mutex_t lock;
+  struct ddsrt_thread_ring *rings;
+};
+
+/**
+ * @brief Initialize a ring set
+ *
+ * @param[out] set       Set to initialize
+ * @param[in]  ringsize  Size of each ring in bytes, rounded up to a power of 2
+ *                       of at least 4096 bytes and at most 1GB
+ * @param[in]  objsize   Size of the structure embedding the ring
+ * @param[in]  init      Initialization function for new rings, may be NULL
+ * @param[in]  release   Release function for rings, may be NULL
+ * @param[in]  arg       Argument passed to init
+ */
+DDS_EXPORT void
+ddsrt_thread_ring_set_init (struct ddsrt_thread_ring_set *set, uint32_t ringsize, size_t objsize, ddsrt_thread_ring_init_fn init, ddsrt_thread_ring_release_fn release, void *arg);
+
+/**
+ * @brief Free the rings of a set
+ *
+ * No thread may produce data in the set and the consumer must have stopped.
+ * The buffers are freed immediately, a ring structure itself lives until its
+ * producing thread terminates.
+ */
+DDS_EXPORT void
+ddsrt_thread_ring_set_fini (struct ddsrt_thread_ring_set *set);
+
+/**
+ * @brief Get the calling thread's ring in the set, creating it if necessary
+ *
+ * @returns the ring, or NULL if it needed to be created and that failed
+ */
+DDS_EXPORT struct ddsrt_thread_ring *
+ddsrt_thread_ring_get (struct ddsrt_thread_ring_set *set);
+
+/**
+ * @brief Check that a ring has room for n bytes and get the position at which
+ * the producer may write them
+ */
+DDS_EXPORT bool
+ddsrt_thread_ring_reserve (const struct ddsrt_thread_ring *r, uint32_t n, uint32_t *pos);
+
+/**
+ * @brief Copy n bytes into the ring at pos, returns pos + n
+ */
+DDS_EXPORT uint32_t
+ddsrt_thread_ring_copy_in (struct ddsrt_thread_ring *r, uint32_t pos, const void *src, uint32_t n);
+
+/**
+ * @brief Copy n bytes out of the ring at pos, returns pos + n
+ */
+DDS_EXPORT uint32_t
+ddsrt_thread_ring_copy_out (const struct ddsrt_thread_ring *r, uint32_t pos, void *dst, uint32_t n);
+
+/**
+ * @brief Make the data up to pos available to the consumer
+ *
+ * @returns true if this made the ring more than half full, a hint to wake up
+ * the consumer
+ */
+DDS_EXPORT bool
+ddsrt_thread_ring_commit (struct ddsrt_thread_ring *r, uint32_t pos);
+
+/**
+ * @brief Release the space up to pos to the producer
+ */
+DDS_EXPORT void
+ddsrt_thread_ring_consume (struct ddsrt_thread_ring *r, uint32_t pos);
+
+/**
+ * @brief Pass the non-empty rings of the set to a function and remove the
+ * rings no longer in use that were empty
+ *
+ * Must only be called by the consumer, removed rings may be freed.
+ */
+DDS_EXPORT void
+ddsrt_thread_ring_set_drain (struct ddsrt_thread_ring_set *set, ddsrt_thread_ring_drain_fn fn, void *arg);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* DDSRT_THREADRING_H */
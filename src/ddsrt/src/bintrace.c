@@ -0,0 +1,1053 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dds/ddsrt/bintrace.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/bswap.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/mh3.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/threadring.h"
+#include "dds/ddsrt/time.h"
+
+/* File layout, fixed-size integers in the byte order of the writer:
+
+     header: "CDDSBTR\0" u32 byte-order-mark u32 version u32 domid
+     chunk:  u32 ring-id u32 length, followed by a sequence of complete
+             records copied verbatim from the ring buffer of one thread
+
+   Each record starts with a u8 record type and a u16 payload length.
+   Format strings are referenced by the index of the thread's format cache
+   slot, a FMT record (re)defines the format for a slot.  Timestamps are
+   only recorded for messages that complete a line and are encoded as the
+   difference with the previous timestamp in the ring.  Integers and
+   pointers are stored as varints (zig-zag encoded if signed), floating
+   point numbers as 8 bytes and strings as a varint length + 1 followed by
+   the bytes (0 for a null pointer).  A file written with AppendToFile set
+   may contain multiple headers. */
+
+#define BT_MAGIC "CDDSBTR"
+#define BT_MAGIC_LEN 8
+#define BT_BOM 0x01020304u
+#define BT_VERSION 1u
+#define BT_HEADER_SIZE (BT_MAGIC_LEN + 12)
+
+enum bt_rectype {
+  BT_REC_THREAD = 1, /* varint tid, name */
+  BT_REC_FMT = 2,    /* u8 slot, format string */
+  BT_REC_MSG = 3,    /* u8 slot, [time delta if format ends in newline], arguments */
+  BT_REC_TEXT = 4,   /* time delta, u8 leading newlines, u8 eol, text */
+  BT_REC_DROP = 5    /* time delta, varint number of dropped records */
+};
+
+#define BT_RECHDR_SIZE 3
+#define BT_VARINT_MAX 10
+
+/* Same as the line buffer in log.c, which limits the length of the lines
+   in the text output */
+#define BT_LINE_SIZE (2048 - 43)
+#define BT_MAX_MSG 2048
+
+#define BT_MAX_ARGS 24
+#define BT_FMTCACHE_SIZE 256
+#define BT_FALLBACK UINT8_MAX
+#define BT_PREC_NONE UINT16_MAX
+#define BT_PREC_STAR (UINT16_MAX - 1)
+
+#define BT_DRAIN_INTERVAL DDS_MSECS (10)
+
+enum bt_length { BTL_NONE, BTL_HH, BTL_H, BTL_L, BTL_LL, BTL_J, BTL_Z, BTL_T, BTL_LD };
+
+enum bt_argtype {
+  BTA_INT, BTA_UINT, BTA_SCHAR, BTA_UCHAR, BTA_SHORT, BTA_USHORT,
+  BTA_LONG, BTA_ULONG, BTA_LLONG, BTA_ULLONG, BTA_INTMAX, BTA_UINTMAX,
+  BTA_PTRDIFF, BTA_SIZE, BTA_DOUBLE, BTA_LDOUBLE, BTA_STRING, BTA_POINTER,
+  BTA_PRECSTAR
+};
+
+struct bt_conv {
+  const char *flags;
+  size_t nflags;
+  bool width_star;
+  const char *width;
+  size_t nwidth;
+  bool has_prec;
+  bool prec_star;
+  const char *prec;
+  size_t nprec;
+  enum bt_length length;
+  char conv;
+};
+
+struct bt_fmtcache {
+  char *fmt; /* copy of the format string, null if slot unused */
+  size_t fmtlen;
+  uint8_t nargs;
+  bool eol;
+  uint8_t types[BT_MAX_ARGS];
+  uint16_t prec[BT_MAX_ARGS];
+};
+
+struct bt_ring {
+  struct ddsrt_thread_ring c;
+  uint32_t id;
+  struct bt_fmtcache *fmtcache;
+  dds_time_t tprev;
+  uint32_t ndropped;
+};
+
+struct ddsrt_bintrace {
+  FILE *fp;
+  struct ddsrt_thread_ring_set rings;
+  ddsrt_mutex_t lock;
+  ddsrt_cond_t cond;
+  bool terminate;
+  bool wrote; /* [lock] set while draining */
+  ddsrt_atomic_uint32_t next_ring_id;
+  ddsrt_thread_t tid;
+};
+
+static size_t bt_varint (unsigned char *p, uint64_t v)
+{
+  size_t n = 0;
+  while (v >= 0x80)
+  {
+    p[n++] = (unsigned char) (v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (unsigned char) v;
+  return n;
+}
+
+static uint64_t bt_zigzag (int64_t v)
+{
+  return ((uint64_t) v << 1) ^ (0 - ((uint64_t) v >> 63));
+}
+
+/* Parses the conversion specification following the '%' at *fmt, on success
+   advances *fmt past the conversion character.  Only the subset of printf
+   that can be captured and reproduced is accepted. */
+static bool bt_parse_conv (const char **fmt, struct bt_conv *c)
+{
+  const char *p = *fmt + 1;
+  c->flags = p;
+  while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+    p++;
+  c->nflags = (size_t) (p - c->flags);
+  c->width_star = (*p == '*');
+  c->width = p;
+  if (c->width_star)
+    p++;
+  else
+    while (*p >= '0' && *p <= '9')
+      p++;
+  c->nwidth = (size_t) (p - c->width);
+  c->has_prec = (*p == '.');
+  c->prec_star = false;
+  c->prec = p;
+  c->nprec = 0;
+  if (c->has_prec)
+  {
+    c->prec = ++p;
+    if ((c->prec_star = (*p == '*')) == true)
+      p++;
+    else
+      while (*p >= '0' && *p <= '9')
+        p++;
+    c->nprec = (size_t) (p - c->prec);
+  }
+  switch (*p)
+  {
+    case 'h': p++; if (*p == 'h') { p++; c->length = BTL_HH; } else { c->length = BTL_H; } break;
+    case 'l': p++; if (*p == 'l') { p++; c->length = BTL_LL; } else { c->length = BTL_L; } break;
+    case 'j': p++; c->length = BTL_J; break;
+    case 'z': p++; c->length = BTL_Z; break;
+    case 't': p++; c->length = BTL_T; break;
+    case 'L': p++; c->length = BTL_LD; break;
+    default: c->length = BTL_NONE; break;
+  }
+  c->conv = *p;
+  switch (c->conv)
+  {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+      if (c->length == BTL_LD)
+        return false;
+      break;
+    case 'c': case 's': case 'p':
+      if (c->length != BTL_NONE)
+        return false;
+      break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+      if (c->length != BTL_NONE && c->length != BTL_L && c->length != BTL_LD)
+        return false;
+      break;
+    default:
+      return false;
+  }
+  *fmt = p + 1;
+  return true;
+}
+
+static enum bt_argtype bt_conv_argtype (const struct bt_conv *c)
+{
+  static const enum bt_argtype sints[] = {
+    [BTL_NONE] = BTA_INT, [BTL_HH] = BTA_SCHAR, [BTL_H] = BTA_SHORT, [BTL_L] = BTA_LONG,
+    [BTL_LL] = BTA_LLONG, [BTL_J] = BTA_INTMAX, [BTL_Z] = BTA_PTRDIFF, [BTL_T] = BTA_PTRDIFF
+  };
+  static const enum bt_argtype uints[] = {
+    [BTL_NONE] = BTA_UINT, [BTL_HH] = BTA_UCHAR, [BTL_H] = BTA_USHORT, [BTL_L] = BTA_ULONG,
+    [BTL_LL] = BTA_ULLONG, [BTL_J] = BTA_UINTMAX, [BTL_Z] = BTA_SIZE, [BTL_T] = BTA_SIZE
+  };
+  switch (c->conv)
+  {
+    case 'd': case 'i': return sints[c->length];
+    case 'o': case 'u': case 'x': case 'X': return uints[c->length];
+    case 'c': return BTA_INT;
+    case 's': return BTA_STRING;
+    case 'p': return BTA_POINTER;
+    default: return (c->length == BTL_LD) ? BTA_LDOUBLE : BTA_DOUBLE;
+  }
+}
+
+
+static bool bt_compile (struct bt_fmtcache *fc, const char *fmt)
+{
+  const char * const fmt0 = fmt;
+  struct bt_conv c;
+  fc->nargs = 0;
+  while (*fmt)
+  {
+    if (*fmt != '%')
+      fmt++;
+    else if (fmt[1] == '%')
+      fmt += 2;
+    else if (!bt_parse_conv (&fmt, &c))
+      return false;
+    else
+    {
+      if (fc->nargs + 3 > BT_MAX_ARGS)
+        return false;
+      if (c.width_star)
+        fc->types[fc->nargs++] = BTA_INT;
+      if (c.prec_star)
+        fc->types[fc->nargs++] = BTA_PRECSTAR;
+      if (!c.has_prec)
+        fc->prec[fc->nargs] = BT_PREC_NONE;
+      else if (c.prec_star)
+        fc->prec[fc->nargs] = BT_PREC_STAR;
+      else
+      {
+        unsigned long p = strtoul (c.prec, NULL, 10);
+        fc->prec[fc->nargs] = (uint16_t) ((p < BT_PREC_STAR) ? p : BT_PREC_STAR - 1);
+      }
+      fc->types[fc->nargs++] = (uint8_t) bt_conv_argtype (&c);
+    }
+  }
+  if (fmt - fmt0 >= UINT16_MAX)
+    return false;
+  fc->eol = (fmt > fmt0 && fmt[-1] == '\n');
+  return true;
+}
+
+static void bt_fmtcache_free (struct bt_fmtcache *fmtcache)
+{
+  if (fmtcache == NULL)
+    return;
+  for (uint32_t i = 0; i < BT_FMTCACHE_SIZE; i++)
+    ddsrt_free (fmtcache[i].fmt);
+  ddsrt_free (fmtcache);
+}
+
+static bool bt_put (struct ddsrt_bintrace *bt, struct bt_ring *r, enum bt_rectype type, const void *a, size_t alen, const void *b, size_t blen)
+{
+  const size_t len = alen + blen;
+  uint32_t pos;
+  if (len > UINT16_MAX || !ddsrt_thread_ring_reserve (&r->c, BT_RECHDR_SIZE + (uint32_t) len, &pos))
+    return false;
+  const uint16_t len16 = (uint16_t) len;
+  unsigned char hdr[BT_RECHDR_SIZE];
+  hdr[0] = (unsigned char) type;
+  memcpy (hdr + 1, &len16, sizeof (len16));
+  pos = ddsrt_thread_ring_copy_in (&r->c, pos, hdr, BT_RECHDR_SIZE);
+  pos = ddsrt_thread_ring_copy_in (&r->c, pos, a, (uint32_t) alen);
+  if (blen > 0)
+    pos = ddsrt_thread_ring_copy_in (&r->c, pos, b, (uint32_t) blen);
+  /* no need to hold the lock: a missed wakeup only delays writing */
+  if (ddsrt_thread_ring_commit (&r->c, pos))
+    ddsrt_cond_broadcast (&bt->cond);
+  return true;
+}
+
+static bool bt_put_drops (struct ddsrt_bintrace *bt, struct bt_ring *r)
+{
+  unsigned char rec[2 * BT_VARINT_MAX];
+  if (r->ndropped == 0)
+    return true;
+  const dds_time_t t = dds_time ();
+  size_t n = bt_varint (rec, bt_zigzag (t - r->tprev));
+  n += bt_varint (rec + n, r->ndropped);
+  if (!bt_put (bt, r, BT_REC_DROP, rec, n, NULL, 0))
+    return false;
+  r->tprev = t;
+  r->ndropped = 0;
+  return true;
+}
+
+static bool bt_ring_init (struct ddsrt_thread_ring *vr, void *vbt)
+{
+  struct bt_ring * const r = (struct bt_ring *) vr;
+  struct ddsrt_bintrace * const bt = vbt;
+  if ((r->fmtcache = ddsrt_calloc_s (BT_FMTCACHE_SIZE, sizeof (*r->fmtcache))) == NULL)
+    return false;
+  r->id = ddsrt_atomic_inc32_ov (&bt->next_ring_id);
+
+  char name[64];
+  unsigned char tid[BT_VARINT_MAX];
+  const size_t ntid = bt_varint (tid, (uint64_t) ddsrt_gettid ());
+  (void) ddsrt_thread_getname (name, sizeof (name));
+  (void) bt_put (bt, r, BT_REC_THREAD, tid, ntid, name, strlen (name));
+  return true;
+}
+
+static void bt_ring_release (struct ddsrt_thread_ring *vr)
+{
+  struct bt_ring * const r = (struct bt_ring *) vr;
+  bt_fmtcache_free (r->fmtcache);
+  r->fmtcache = NULL;
+}
+
+static void bt_put_text (struct ddsrt_bintrace *bt, struct bt_ring *r, const char *fmt, va_list ap)
+{
+  unsigned char hdr[BT_VARINT_MAX + 2];
+  char text[BT_MAX_MSG];
+  int n = vsnprintf (text, sizeof (text), fmt, ap);
+  if (n < 0)
+    return;
+  else if ((size_t) n >= sizeof (text))
+    n = (int) sizeof (text) - 1;
+  uint8_t nlead = 0;
+  while (fmt[nlead] == '\n' && nlead < UINT8_MAX)
+    nlead++;
+  const dds_time_t t = dds_time ();
+  size_t pos = bt_varint (hdr, bt_zigzag (t - r->tprev));
+  hdr[pos++] = nlead;
+  hdr[pos++] = (*fmt && fmt[strlen (fmt) - 1] == '\n');
+  if (!bt_put_drops (bt, r) || !bt_put (bt, r, BT_REC_TEXT, hdr, pos, text, (size_t) n))
+    r->ndropped++;
+  else
+    r->tprev = t;
+}
+
+void ddsrt_bintrace_vlog (struct ddsrt_bintrace *bt, const char *fmt, va_list ap)
+{
+  struct bt_ring * const r = (struct bt_ring *) ddsrt_thread_ring_get (&bt->rings);
+  if (r == NULL)
+    return;
+  /* Keyed by contents rather than address: format strings need not be literals,
+     and a buffer may well be reused for a different format */
+  const size_t fmtlen = strlen (fmt);
+  const uint8_t slot = (uint8_t) (ddsrt_mh3 (fmt, fmtlen, 0) % BT_FMTCACHE_SIZE);
+  struct bt_fmtcache * const fc = &r->fmtcache[slot];
+  if (fc->fmt == NULL || fc->fmtlen != fmtlen || memcmp (fc->fmt, fmt, fmtlen) != 0)
+  {
+    ddsrt_free (fc->fmt);
+    fc->fmt = NULL;
+    if (!bt_compile (fc, fmt))
+      fc->nargs = BT_FALLBACK;
+    else if (!bt_put_drops (bt, r) || !bt_put (bt, r, BT_REC_FMT, &slot, 1, fmt, fmtlen))
+    {
+      r->ndropped++;
+      return;
+    }
+    /* if out of memory, the format is simply not cached and recompiled next time */
+    if ((fc->fmt = ddsrt_malloc_s (fmtlen + 1)) != NULL)
+    {
+      memcpy (fc->fmt, fmt, fmtlen + 1);
+      fc->fmtlen = fmtlen;
+    }
+  }
+  if (fc->nargs == BT_FALLBACK)
+  {
+    bt_put_text (bt, r, fmt, ap);
+    return;
+  }
+
+  /* worst case size of the fixed part and the arguments except strings */
+  unsigned char msg[1 + BT_VARINT_MAX + BT_MAX_ARGS * BT_VARINT_MAX + BT_MAX_MSG];
+  size_t pos = 0;
+  dds_time_t t = 0;
+  msg[pos++] = slot;
+  if (fc->eol)
+  {
+    t = dds_time ();
+    pos += bt_varint (msg + pos, bt_zigzag (t - r->tprev));
+  }
+  int prec_star = -1;
+  size_t strspace = BT_MAX_MSG;
+  for (uint32_t i = 0; i < fc->nargs; i++)
+  {
+    switch ((enum bt_argtype) fc->types[i])
+    {
+      case BTA_INT: pos += bt_varint (msg + pos, bt_zigzag (va_arg (ap, int))); break;
+      case BTA_UINT: pos += bt_varint (msg + pos, va_arg (ap, unsigned)); break;
+      case BTA_SCHAR: pos += bt_varint (msg + pos, bt_zigzag ((signed char) va_arg (ap, int))); break;
+      case BTA_UCHAR: pos += bt_varint (msg + pos, (unsigned char) va_arg (ap, unsigned)); break;
+      case BTA_SHORT: pos += bt_varint (msg + pos, bt_zigzag ((short) va_arg (ap, int))); break;
+      case BTA_USHORT: pos += bt_varint (msg + pos, (unsigned short) va_arg (ap, unsigned)); break;
+      case BTA_LONG: pos += bt_varint (msg + pos, bt_zigzag (va_arg (ap, long))); break;
+      case BTA_ULONG: pos += bt_varint (msg + pos, va_arg (ap, unsigned long)); break;
+      case BTA_LLONG: pos += bt_varint (msg + pos, bt_zigzag (va_arg (ap, long long))); break;
+      case BTA_ULLONG: pos += bt_varint (msg + pos, va_arg (ap, unsigned long long)); break;
+      case BTA_INTMAX: pos += bt_varint (msg + pos, bt_zigzag (va_arg (ap, intmax_t))); break;
+      case BTA_UINTMAX: pos += bt_varint (msg + pos, va_arg (ap, uintmax_t)); break;
+      case BTA_PTRDIFF: pos += bt_varint (msg + pos, bt_zigzag (va_arg (ap, ptrdiff_t))); break;
+      case BTA_SIZE: pos += bt_varint (msg + pos, va_arg (ap, size_t)); break;
+      case BTA_POINTER: pos += bt_varint (msg + pos, (uintptr_t) va_arg (ap, void *)); break;
+      case BTA_DOUBLE: case BTA_LDOUBLE: {
+        const double d = (fc->types[i] == BTA_DOUBLE) ? va_arg (ap, double) : (double) va_arg (ap, long double);
+        memcpy (msg + pos, &d, sizeof (d));
+        pos += sizeof (d);
+        break;
+      }
+      case BTA_PRECSTAR:
+        prec_star = va_arg (ap, int);
+        pos += bt_varint (msg + pos, bt_zigzag (prec_star));
+        continue;
+      case BTA_STRING: {
+        /* the output line gets truncated long before the total length of
+           the strings could matter */
+        const char *s = va_arg (ap, const char *);
+        size_t len = 0;
+        if (s != NULL)
+        {
+          size_t maxlen = strspace;
+          if (fc->prec[i] == BT_PREC_STAR && prec_star >= 0 && (size_t) prec_star < maxlen)
+            maxlen = (size_t) prec_star;
+          else if (fc->prec[i] < BT_PREC_STAR && fc->prec[i] < maxlen)
+            maxlen = fc->prec[i];
+          const char *z = memchr (s, 0, maxlen);
+          len = z ? (size_t) (z - s) : maxlen;
+          strspace -= len;
+        }
+        pos += bt_varint (msg + pos, (s == NULL) ? 0 : len + 1);
+        if (len > 0)
+        {
+          memcpy (msg + pos, s, len);
+          pos += len;
+        }
+        break;
+      }
+    }
+    prec_star = -1;
+  }
+  if (!bt_put_drops (bt, r) || !bt_put (bt, r, BT_REC_MSG, msg, pos, NULL, 0))
+    r->ndropped++;
+  else if (fc->eol)
+    r->tprev = t;
+}
+
+static void bt_write_chunk (struct ddsrt_bintrace *bt, uint32_t id, const unsigned char *a, uint32_t alen, const unsigned char *b, uint32_t blen)
+{
+  const uint32_t hdr[2] = { id, alen + blen };
+  (void) fwrite (hdr, sizeof (hdr), 1, bt->fp);
+  (void) fwrite (a, 1, alen, bt->fp);
+  if (blen > 0)
+    (void) fwrite (b, 1, blen, bt->fp);
+}
+
+static void bt_drain_ring (struct ddsrt_thread_ring *vr, uint32_t tail, uint32_t head, void *vbt)
+{
+  struct bt_ring * const r = (struct bt_ring *) vr;
+  struct ddsrt_bintrace * const bt = vbt;
+  const uint32_t off = tail & (vr->size - 1), n = head - tail;
+  if (off + n <= vr->size)
+    bt_write_chunk (bt, r->id, vr->buf + off, n, NULL, 0);
+  else
+    bt_write_chunk (bt, r->id, vr->buf + off, vr->size - off, vr->buf, n - (vr->size - off));
+  ddsrt_thread_ring_consume (vr, head);
+  bt->wrote = true;
+}
+
+static void bt_drain (struct ddsrt_bintrace *bt)
+{
+  bt->wrote = false;
+  ddsrt_thread_ring_set_drain (&bt->rings, bt_drain_ring, bt);
+  if (bt->wrote)
+    (void) fflush (bt->fp);
+}
+
+static uint32_t bt_writer_thread (void *vbt)
+{
+  struct ddsrt_bintrace * const bt = vbt;
+  ddsrt_mutex_lock (&bt->lock);
+  while (!bt->terminate)
+  {
+    bt_drain (bt);
+    (void) ddsrt_cond_waitfor (&bt->cond, &bt->lock, BT_DRAIN_INTERVAL);
+  }
+  bt_drain (bt);
+  ddsrt_mutex_unlock (&bt->lock);
+  return 0;
+}
+
+struct ddsrt_bintrace *ddsrt_bintrace_new (FILE *fp, uint32_t domid, uint32_t ringsize)
+{
+  struct ddsrt_bintrace *bt;
+  const uint32_t hdr[3] = { BT_BOM, BT_VERSION, domid };
+  if (fwrite (BT_MAGIC, BT_MAGIC_LEN, 1, fp) != 1 || fwrite (hdr, sizeof (hdr), 1, fp) != 1)
+    return NULL;
+  if ((bt = ddsrt_malloc_s (sizeof (*bt))) == NULL)
+    return NULL;
+  bt->fp = fp;
+  bt->terminate = false;
+  bt->wrote = false;
+  ddsrt_atomic_st32 (&bt->next_ring_id, 0);
+  ddsrt_thread_ring_set_init (&bt->rings, ringsize, sizeof (struct bt_ring), bt_ring_init, bt_ring_release, bt);
+  ddsrt_mutex_init (&bt->lock);
+  ddsrt_cond_init (&bt->cond);
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  if (ddsrt_thread_create (&bt->tid, "bintrace", &tattr, bt_writer_thread, bt) != DDS_RETCODE_OK)
+  {
+    ddsrt_cond_destroy (&bt->cond);
+    ddsrt_mutex_destroy (&bt->lock);
+    ddsrt_thread_ring_set_fini (&bt->rings);
+    ddsrt_free (bt);
+    return NULL;
+  }
+  return bt;
+}
+
+void ddsrt_bintrace_free (struct ddsrt_bintrace *bt)
+{
+  ddsrt_mutex_lock (&bt->lock);
+  bt->terminate = true;
+  ddsrt_cond_broadcast (&bt->cond);
+  ddsrt_mutex_unlock (&bt->lock);
+  (void) ddsrt_thread_join (bt->tid, NULL);
+  ddsrt_thread_ring_set_fini (&bt->rings);
+  ddsrt_cond_destroy (&bt->cond);
+  ddsrt_mutex_destroy (&bt->lock);
+  ddsrt_free (bt);
+}
+
+/* Decoding */
+
+struct bt_dec_thread {
+  char name[64];
+  char *fmts[BT_FMTCACHE_SIZE];
+  dds_time_t tprev;
+  size_t pos;
+  char line[BT_LINE_SIZE];
+};
+
+struct bt_dec_line {
+  dds_time_t t;
+  uint64_t seq;
+  char *text;
+};
+
+struct bt_dec {
+  bool swap;
+  uint32_t domid;
+  uint32_t nthreads;
+  struct bt_dec_thread **threads;
+  uint64_t nlines, maxlines;
+  struct bt_dec_line *lines;
+  char *str;
+  size_t strpos, strsize;
+};
+
+struct bt_dec_buf {
+  const unsigned char *p;
+  const unsigned char *end;
+};
+
+static uint32_t bt_dec_u32 (const struct bt_dec *d, const unsigned char *p)
+{
+  uint32_t v;
+  memcpy (&v, p, sizeof (v));
+  return d->swap ? ddsrt_bswap4u (v) : v;
+}
+
+static bool bt_dec_varint (struct bt_dec_buf *b, uint64_t *v)
+{
+  *v = 0;
+  for (unsigned shift = 0; b->p < b->end && shift < 64; shift += 7)
+  {
+    const unsigned char c = *b->p++;
+    *v |= (uint64_t) (c & 0x7f) << shift;
+    if (!(c & 0x80))
+      return true;
+  }
+  return false;
+}
+
+static bool bt_dec_zigzag (struct bt_dec_buf *b, int64_t *v)
+{
+  uint64_t u;
+  if (!bt_dec_varint (b, &u))
+    return false;
+  *v = (int64_t) ((u >> 1) ^ (0 - (u & 1)));
+  return true;
+}
+
+static bool bt_dec_int (struct bt_dec_buf *b, int *v)
+{
+  int64_t x;
+  if (!bt_dec_zigzag (b, &x))
+    return false;
+  *v = (int) x;
+  return true;
+}
+
+static bool bt_dec_time (struct bt_dec_buf *b, struct bt_dec_thread *th, dds_time_t *t)
+{
+  int64_t delta;
+  if (!bt_dec_zigzag (b, &delta))
+    return false;
+  *t = th->tprev = th->tprev + delta;
+  return true;
+}
+
+static void bt_dec_reset_threads (struct bt_dec *d)
+{
+  for (uint32_t i = 0; i < d->nthreads; i++)
+  {
+    if (d->threads[i] == NULL)
+      continue;
+    for (uint32_t j = 0; j < BT_FMTCACHE_SIZE; j++)
+      ddsrt_free (d->threads[i]->fmts[j]);
+    ddsrt_free (d->threads[i]);
+  }
+  ddsrt_free (d->threads);
+  d->threads = NULL;
+  d->nthreads = 0;
+}
+
+static struct bt_dec_thread *bt_dec_get_thread (struct bt_dec *d, uint32_t id)
+{
+  if (id >= d->nthreads)
+  {
+    uint32_t n = d->nthreads ? d->nthreads : 16;
+    while (n <= id)
+      n *= 2;
+    d->threads = ddsrt_realloc (d->threads, n * sizeof (*d->threads));
+    memset (d->threads + d->nthreads, 0, (n - d->nthreads) * sizeof (*d->threads));
+    d->nthreads = n;
+  }
+  if (d->threads[id] == NULL)
+  {
+    struct bt_dec_thread *th = ddsrt_malloc (sizeof (*th));
+    memset (th, 0, offsetof (struct bt_dec_thread, line));
+    (void) ddsrt_strlcpy (th->name, "(anon)", sizeof (th->name));
+    d->threads[id] = th;
+  }
+  return d->threads[id];
+}
+
+static void bt_dec_str_reserve (struct bt_dec *d, size_t n)
+{
+  if (d->strpos + n > d->strsize)
+  {
+    while (d->strpos + n > d->strsize)
+      d->strsize = d->strsize ? 2 * d->strsize : 4096;
+    d->str = ddsrt_realloc (d->str, d->strsize);
+  }
+}
+
+static void bt_dec_str_append (struct bt_dec *d, const char *s, size_t n)
+{
+  bt_dec_str_reserve (d, n + 1);
+  memcpy (d->str + d->strpos, s, n);
+  d->strpos += n;
+  d->str[d->strpos] = 0;
+}
+
+static void bt_dec_str_printf (struct bt_dec *d, const char *spec, ...)
+{
+  va_list ap, ap1;
+  va_start (ap, spec);
+  va_copy (ap1, ap);
+  int n = vsnprintf (NULL, 0, spec, ap1);
+  va_end (ap1);
+  if (n > 0)
+  {
+    bt_dec_str_reserve (d, (size_t) n + 1);
+    (void) vsnprintf (d->str + d->strpos, (size_t) n + 1, spec, ap);
+    d->strpos += (size_t) n;
+  }
+  va_end (ap);
+}
+
+/* Formats fmt with the recorded arguments into d->str, with the length
+   modifiers of integer conversions replaced by "ll" because all integers
+   are recorded as 64-bit values */
+static bool bt_dec_format (struct bt_dec *d, const char *fmt, struct bt_dec_buf *b)
+{
+  d->strpos = 0;
+  bt_dec_str_reserve (d, 1);
+  d->str[0] = 0;
+  while (*fmt)
+  {
+    struct bt_conv c;
+    const char *lit = fmt;
+    while (*fmt && *fmt != '%')
+      fmt++;
+    bt_dec_str_append (d, lit, (size_t) (fmt - lit));
+    if (*fmt == 0)
+      break;
+    if (fmt[1] == '%')
+    {
+      bt_dec_str_append (d, "%", 1);
+      fmt += 2;
+      continue;
+    }
+    if (!bt_parse_conv (&fmt, &c))
+      return false;
+    char spec[64];
+    int width = 0, prec = 0;
+    if (c.nflags + c.nwidth + c.nprec > 40)
+      return false;
+    if (c.width_star && !bt_dec_int (b, &width))
+      return false;
+    if (c.prec_star && !bt_dec_int (b, &prec))
+      return false;
+    size_t sp = 0;
+    spec[sp++] = '%';
+    memcpy (spec + sp, c.flags, c.nflags); sp += c.nflags;
+    if (c.width_star)
+      sp += (size_t) snprintf (spec + sp, sizeof (spec) - sp, "%d", width);
+    else
+    {
+      memcpy (spec + sp, c.width, c.nwidth); sp += c.nwidth;
+    }
+    if (c.has_prec)
+    {
+      spec[sp++] = '.';
+      if (c.prec_star)
+        sp += (size_t) snprintf (spec + sp, sizeof (spec) - sp, "%d", prec);
+      else
+      {
+        memcpy (spec + sp, c.prec, c.nprec); sp += c.nprec;
+      }
+    }
+    uint64_t u;
+    int64_t i;
+    switch (c.conv)
+    {
+      case 's': {
+        if (!bt_dec_varint (b, &u) || u > (uint64_t) (b->end - b->p) + 1)
+          return false;
+        spec[sp++] = 's';
+        spec[sp] = 0;
+        if (u == 0)
+          bt_dec_str_printf (d, spec, "(null)");
+        else
+        {
+          const size_t len = (size_t) u - 1;
+          char *s = ddsrt_malloc (len + 1);
+          memcpy (s, b->p, len);
+          s[len] = 0;
+          b->p += len;
+          bt_dec_str_printf (d, spec, s);
+          ddsrt_free (s);
+        }
+        break;
+      }
+      case 'c':
+        if (!bt_dec_zigzag (b, &i))
+          return false;
+        spec[sp++] = c.conv;
+        spec[sp] = 0;
+        bt_dec_str_printf (d, spec, (int) i);
+        break;
+      case 'p':
+        if (!bt_dec_varint (b, &u))
+          return false;
+        spec[sp++] = c.conv;
+        spec[sp] = 0;
+        bt_dec_str_printf (d, spec, (void *) (uintptr_t) u);
+        break;
+      case 'd': case 'i':
+        if (!bt_dec_zigzag (b, &i))
+          return false;
+        memcpy (spec + sp, "ll", 2); sp += 2;
+        spec[sp++] = c.conv;
+        spec[sp] = 0;
+        bt_dec_str_printf (d, spec, (long long) i);
+        break;
+      case 'o': case 'u': case 'x': case 'X':
+        if (!bt_dec_varint (b, &u))
+          return false;
+        memcpy (spec + sp, "ll", 2); sp += 2;
+        spec[sp++] = c.conv;
+        spec[sp] = 0;
+        bt_dec_str_printf (d, spec, (unsigned long long) u);
+        break;
+      default: {
+        double x;
+        if (b->end - b->p < 8)
+          return false;
+        memcpy (&u, b->p, sizeof (u));
+        b->p += 8;
+        if (d->swap)
+          u = ddsrt_bswap8u (u);
+        memcpy (&x, &u, sizeof (x));
+        spec[sp++] = c.conv;
+        spec[sp] = 0;
+        bt_dec_str_printf (d, spec, x);
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+static void bt_dec_emit (struct bt_dec *d, const struct bt_dec_thread *th, dds_time_t t, const char *text, size_t n)
+{
+  /* same header as log.c */
+  const unsigned sec = (unsigned) (t / DDS_NSECS_IN_SEC);
+  const int usec = (int) ((t % DDS_NSECS_IN_SEC) / DDS_NSECS_IN_USEC);
+  char hdr[64];
+  if (d->domid == UINT32_MAX)
+    (void) snprintf (hdr, sizeof (hdr), "%10u.%06d [] %10.10s: ", sec, usec, th->name);
+  else
+    (void) snprintf (hdr, sizeof (hdr), "%10u.%06d [%"PRIu32"] %10.10s: ", sec, usec, d->domid, th->name);
+  if (d->nlines == d->maxlines)
+  {
+    d->maxlines = d->maxlines ? 2 * d->maxlines : 1024;
+    d->lines = ddsrt_realloc (d->lines, (size_t) d->maxlines * sizeof (*d->lines));
+  }
+  struct bt_dec_line *l = &d->lines[d->nlines];
+  const size_t hdrlen = strlen (hdr);
+  l->t = t;
+  l->seq = d->nlines++;
+  l->text = ddsrt_malloc (hdrlen + n + 1);
+  memcpy (l->text, hdr, hdrlen);
+  memcpy (l->text + hdrlen, text, n);
+  l->text[hdrlen + n] = 0;
+}
+
+/* Appends a fragment to the thread's line buffer following the rules
+   of vlog1 in log.c */
+static void bt_dec_append (struct bt_dec *d, struct bt_dec_thread *th, dds_time_t t, const char *s, size_t n, bool eol)
+{
+  const size_t nrem = sizeof (th->line) - th->pos;
+  if (nrem > 0)
+  {
+    if (n < nrem)
+    {
+      memcpy (th->line + th->pos, s, n);
+      th->pos += n;
+    }
+    else
+    {
+      static const char msg[] = "(trunc)\n";
+      memcpy (th->line + th->pos, s, nrem - 1);
+      th->pos = sizeof (th->line);
+      memcpy (th->line + th->pos - (sizeof (msg) - 1), msg, sizeof (msg) - 1);
+    }
+  }
+  if (eol && th->pos > 1)
+  {
+    bt_dec_emit (d, th, t, th->line, th->pos);
+    th->pos = 0;
+  }
+}
+
+static bool bt_dec_record (struct bt_dec *d, struct bt_dec_thread *th, enum bt_rectype type, struct bt_dec_buf *b)
+{
+  uint64_t u;
+  dds_time_t t = 0;
+  switch (type)
+  {
+    case BT_REC_THREAD: {
+      if (!bt_dec_varint (b, &u))
+        return false;
+      const size_t len = (size_t) (b->end - b->p);
+      const size_t n = (len < sizeof (th->name)) ? len : sizeof (th->name) - 1;
+      memcpy (th->name, b->p, n);
+      th->name[n] = 0;
+      if (n == 0)
+        (void) ddsrt_strlcpy (th->name, "(anon)", sizeof (th->name));
+      return true;
+    }
+    case BT_REC_FMT: {
+      if (b->p == b->end)
+        return false;
+      const uint8_t slot = *b->p++;
+      const size_t len = (size_t) (b->end - b->p);
+      ddsrt_free (th->fmts[slot]);
+      th->fmts[slot] = ddsrt_malloc (len + 1);
+      memcpy (th->fmts[slot], b->p, len);
+      th->fmts[slot][len] = 0;
+      return true;
+    }
+    case BT_REC_MSG: {
+      if (b->p == b->end || th->fmts[*b->p] == NULL)
+        return false;
+      const char *fmt = th->fmts[*b->p++];
+      const size_t fmtlen = strlen (fmt);
+      const bool eol = (fmtlen > 0 && fmt[fmtlen - 1] == '\n');
+      if (eol && !bt_dec_time (b, th, &t))
+        return false;
+      if (th->pos == 0)
+        while (*fmt == '\n')
+          fmt++;
+      if (*fmt == 0)
+        return true;
+      if (!bt_dec_format (d, fmt, b))
+        return false;
+      bt_dec_append (d, th, t, d->str, d->strpos, eol);
+      return true;
+    }
+    case BT_REC_TEXT: {
+      if (!bt_dec_time (b, th, &t) || b->end - b->p < 2)
+        return false;
+      const size_t nlead = b->p[0];
+      const bool eol = b->p[1];
+      const char *s = (const char *) b->p + 2;
+      size_t n = (size_t) (b->end - b->p) - 2;
+      if (th->pos == 0 && nlead <= n)
+      {
+        s += nlead;
+        n -= nlead;
+        if (n == 0)
+          return true;
+      }
+      bt_dec_append (d, th, t, s, n, eol);
+      return true;
+    }
+    case BT_REC_DROP: {
+      char msg[64];
+      if (!bt_dec_time (b, th, &t) || !bt_dec_varint (b, &u))
+        return false;
+      const int n = snprintf (msg, sizeof (msg), "(%"PRIu64" trace messages dropped)\n", u);
+      bt_dec_emit (d, th, t, msg, (size_t) n);
+      return true;
+    }
+  }
+  return false;
+}
+
+static int bt_dec_line_cmp (const void *va, const void *vb)
+{
+  const struct bt_dec_line *a = va, *b = vb;
+  if (a->t != b->t)
+    return (a->t < b->t) ? -1 : 1;
+  return (a->seq < b->seq) ? -1 : (a->seq > b->seq);
+}
+
+static dds_return_t bt_dec_header (struct bt_dec *d, const unsigned char *hdr)
+{
+  uint32_t bom;
+  if (memcmp (hdr, BT_MAGIC, BT_MAGIC_LEN) != 0)
+    return DDS_RETCODE_BAD_PARAMETER;
+  memcpy (&bom, hdr + BT_MAGIC_LEN, 4);
+  if (bom == BT_BOM)
+    d->swap = false;
+  else if (bom == ddsrt_bswap4u (BT_BOM))
+    d->swap = true;
+  else
+    return DDS_RETCODE_BAD_PARAMETER;
+  if (bt_dec_u32 (d, hdr + BT_MAGIC_LEN + 4) != BT_VERSION)
+    return DDS_RETCODE_BAD_PARAMETER;
+  d->domid = bt_dec_u32 (d, hdr + BT_MAGIC_LEN + 8);
+  bt_dec_reset_threads (d);
+  return DDS_RETCODE_OK;
+}
+
+dds_return_t ddsrt_bintrace_decode (FILE *in, FILE *out)
+{
+  struct bt_dec d;
+  unsigned char hdr[BT_HEADER_SIZE];
+  unsigned char *chunk = NULL;
+  size_t chunksize = 0;
+  dds_return_t ret;
+  memset (&d, 0, sizeof (d));
+  if (fread (hdr, sizeof (hdr), 1, in) != 1)
+    return DDS_RETCODE_BAD_PARAMETER;
+  if ((ret = bt_dec_header (&d, hdr)) != DDS_RETCODE_OK)
+    return ret;
+  while (ret == DDS_RETCODE_OK && fread (hdr, 8, 1, in) == 1)
+  {
+    if (memcmp (hdr, BT_MAGIC, BT_MAGIC_LEN) == 0)
+    {
+      /* appended trace of a new run */
+      if (fread (hdr + 8, sizeof (hdr) - 8, 1, in) != 1)
+        ret = DDS_RETCODE_BAD_PARAMETER;
+      else
+        ret = bt_dec_header (&d, hdr);
+      continue;
+    }
+    const uint32_t id = bt_dec_u32 (&d, hdr);
+    const uint32_t len = bt_dec_u32 (&d, hdr + 4);
+    if (id >= (1u << 24) || len > (1u << 30))
+    {
+      ret = DDS_RETCODE_BAD_PARAMETER;
+      break;
+    }
+    if (len > chunksize)
+    {
+      chunksize = len;
+      chunk = ddsrt_realloc (chunk, chunksize);
+    }
+    if (fread (chunk, 1, len, in) != len)
+    {
+      ret = DDS_RETCODE_BAD_PARAMETER;
+      break;
+    }
+    struct bt_dec_thread * const th = bt_dec_get_thread (&d, id);
+    uint32_t pos = 0;
+    while (pos < len && ret == DDS_RETCODE_OK)
+    {
+      uint16_t reclen;
+      if (len - pos < BT_RECHDR_SIZE)
+      {
+        ret = DDS_RETCODE_BAD_PARAMETER;
+        break;
+      }
+      memcpy (&reclen, chunk + pos + 1, sizeof (reclen));
+      if (d.swap)
+        reclen = ddsrt_bswap2u (reclen);
+      if (reclen > len - pos - BT_RECHDR_SIZE)
+        ret = DDS_RETCODE_BAD_PARAMETER;
+      else
+      {
+        struct bt_dec_buf b = { .p = chunk + pos + BT_RECHDR_SIZE, .end = chunk + pos + BT_RECHDR_SIZE + reclen };
+        if (!bt_dec_record (&d, th, (enum bt_rectype) chunk[pos], &b))
+          ret = DDS_RETCODE_BAD_PARAMETER;
+      }
+      pos += BT_RECHDR_SIZE + reclen;
+    }
+  }
+
+  qsort (d.lines, (size_t) d.nlines, sizeof (*d.lines), bt_dec_line_cmp);
+  for (uint64_t i = 0; i < d.nlines; i++)
+  {
+    (void) fputs (d.lines[i].text, out);
+    ddsrt_free (d.lines[i].text);
+  }
+  ddsrt_free (d.lines);
+  bt_dec_reset_threads (&d);
+  ddsrt_free (d.str);
+  ddsrt_free (chunk);
+  return ret;
+}
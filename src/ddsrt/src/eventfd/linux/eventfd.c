@@ -0,0 +1,51 @@
+// Copyright(c) 2026 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "dds/ddsrt/eventfd.h"
+
+dds_return_t ddsrt_eventfd_init (ddsrt_eventfd_t *ev)
+{
+  const int fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd == -1)
+    return DDS_RETCODE_OUT_OF_RESOURCES;
+  ev->fds[0] = ev->fds[1] = fd;
+  return DDS_RETCODE_OK;
+}
+
+void ddsrt_eventfd_fini (ddsrt_eventfd_t *ev)
+{
+  (void) close (ev->fds[0]);
+}
+
+int ddsrt_eventfd_get_fd (const ddsrt_eventfd_t *ev)
+{
+  return ev->fds[0];
+}
+
+void ddsrt_eventfd_signal (ddsrt_eventfd_t *ev)
+{
+  // an eventfd at its maximum value is readable, so failing is harmless
+  const uint64_t one = 1;
+  while (write (ev->fds[1], &one, sizeof (one)) == -1 && errno == EINTR)
+    ;
+}
+
+void ddsrt_eventfd_drain (ddsrt_eventfd_t *ev)
+{
+  // reading resets the counter to 0
+  uint64_t value;
+  while (read (ev->fds[0], &value, sizeof (value)) == -1 && errno == EINTR)
+    ;
+}
@@ -0,0 +1,59 @@
+// Copyright(c) 2026 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "dds/ddsrt/eventfd.h"
+
+dds_return_t ddsrt_eventfd_init (ddsrt_eventfd_t *ev)
+{
+  if (pipe (ev->fds) == -1)
+    return DDS_RETCODE_OUT_OF_RESOURCES;
+  for (int i = 0; i < 2; i++)
+  {
+    if (fcntl (ev->fds[i], F_SETFD, fcntl (ev->fds[i], F_GETFD) | FD_CLOEXEC) == -1 ||
+        fcntl (ev->fds[i], F_SETFL, fcntl (ev->fds[i], F_GETFL) | O_NONBLOCK) == -1)
+    {
+      (void) close (ev->fds[0]);
+      (void) close (ev->fds[1]);
+      return DDS_RETCODE_OUT_OF_RESOURCES;
+    }
+  }
+  return DDS_RETCODE_OK;
+}
+
+void ddsrt_eventfd_fini (ddsrt_eventfd_t *ev)
+{
+  (void) close (ev->fds[0]);
+  (void) close (ev->fds[1]);
+}
+
+int ddsrt_eventfd_get_fd (const ddsrt_eventfd_t *ev)
+{
+  return ev->fds[0];
+}
+
+void ddsrt_eventfd_signal (ddsrt_eventfd_t *ev)
+{
+  // a full pipe is readable, so failing is harmless
+  const char one = 1;
+  while (write (ev->fds[1], &one, sizeof (one)) == -1 && errno == EINTR)
+    ;
+}
+
+void ddsrt_eventfd_drain (ddsrt_eventfd_t *ev)
+{
+  char buf[64];
+  ssize_t n;
+  while ((n = read (ev->fds[0], buf, sizeof (buf))) > 0 || (n == -1 && errno == EINTR))
+    ;
+}
@@ -10,11 +10,13 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "dds/ddsrt/log.h"
+#include "dds/ddsrt/bintrace.h"
 #include "dds/ddsrt/sync.h"
 #include "dds/ddsrt/threads.h"
 #include "dds/ddsrt/static_assert.h"
@@ -45,6 +47,7 @@ static ddsrt_rwlock_t lock;
 struct ddsrt_log_cfg_impl {
   struct ddsrt_log_cfg_common c;
   FILE *sink_fps[2];
+  struct ddsrt_bintrace *bintrace;
 };
 
 DDSRT_STATIC_ASSERT (sizeof (struct ddsrt_log_cfg_impl) <= sizeof (struct ddsrt_log_cfg));
@@ -167,6 +170,12 @@ void dds_log_cfg_init (struct ddsrt_log_cfg *cfg, uint32_t domid, uint32_t trace
   cfgimpl->sink_fps[TRACE] = trace_fp;
 }
 
+void dds_log_cfg_set_bintrace (struct ddsrt_log_cfg *cfg, struct ddsrt_bintrace *bt)
+{
+  struct ddsrt_log_cfg_impl *cfgimpl = (struct ddsrt_log_cfg_impl *) cfg;
+  cfgimpl->bintrace = bt;
+}
+
 static size_t print_header (char *str, uint32_t id)
 {
   int cnt, off;
@@ -201,7 +210,7 @@ static size_t print_header (char *str, uint32_t id)
   return (size_t) (cnt + 1);
 }
 
-static void vlog1 (const struct ddsrt_log_cfg_impl *cfg, uint32_t cat, uint32_t domid, const char *file, uint32_t line, const char *func, const char *fmt, va_list ap)
+static void vlog1 (const struct ddsrt_log_cfg_impl *cfg, uint32_t cat, uint32_t domid, const char *file, uint32_t line, const char *func, bool trace, const char *fmt, va_list ap)
 {
   int n, trunc = 0;
   size_t nrem;
@@ -279,7 +288,7 @@ static void vlog1 (const struct ddsrt_log_cfg_impl *cfg, uint32_t cat, uint32_t
     /* if tracing is enabled, then print to trace if it matches the
        trace flags or if it got written to the log
        (mask == (tracemask | DDS_LOG_MASK)) */
-    if (cfg->c.tracemask && (cat & cfg->c.mask))
+    if (trace && cfg->c.tracemask && (cat & cfg->c.mask))
     {
       dds_log_write_fn_t const g = sinks[TRACE].func;
       void * const g_arg = (g == default_sink) ? cfg->sink_fps[TRACE] : sinks[TRACE].ptr;
@@ -295,8 +304,21 @@ static void vlog1 (const struct ddsrt_log_cfg_impl *cfg, uint32_t cat, uint32_t
 
 static void vlog (const struct ddsrt_log_cfg_impl *cfg, uint32_t cat, uint32_t domid, const char *file, uint32_t line, const char *func, const char *fmt, va_list ap)
 {
+  bool trace = true;
+  if (cfg->bintrace && cfg->c.tracemask)
+  {
+    /* binary trace doesn't need the sink lock nor formatting; messages in
+       the log categories still go to the log sink */
+    va_list ap1;
+    va_copy (ap1, ap);
+    ddsrt_bintrace_vlog (cfg->bintrace, fmt, ap1);
+    va_end (ap1);
+    if (!(cat & DDS_LOG_MASK))
+      return;
+    trace = false;
+  }
   lock_sink (RDLOCK);
-  vlog1 (cfg, cat, domid, file, line, func, fmt, ap);
+  vlog1 (cfg, cat, domid, file, line, func, trace, fmt, ap);
   unlock_sink ();
   if (cat & DDS_LC_FATAL)
     abort();
@@ -0,0 +1,213 @@
+// Copyright(c) 2026 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <assert.h>
+#include <string.h>
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/threadring.h"
+
+#define THREAD_RING_TLS_SLOTS 8
+
+struct thread_ring_tls_slot {
+  uint32_t serial;
+  struct ddsrt_thread_ring *ring;
+};
+
+static ddsrt_atomic_uint32_t thread_ring_serial = DDSRT_ATOMIC_UINT32_INIT (0);
+static ddsrt_thread_local struct thread_ring_tls_slot thread_ring_tls[THREAD_RING_TLS_SLOTS];
+
+void ddsrt_thread_ring_set_init (struct ddsrt_thread_ring_set *set, uint32_t ringsize, size_t objsize, ddsrt_thread_ring_init_fn init, ddsrt_thread_ring_release_fn release, void *arg)
+{
+  uint32_t size = 4096;
+  while (size < ringsize && size < (1u << 30))
+    size *= 2;
+  assert (objsize >= sizeof (struct ddsrt_thread_ring));
+  /* thread-local slots use 0 for "unused" */
+  while ((set->serial = ddsrt_atomic_inc32_nv (&thread_ring_serial)) == 0)
+    ;
+  set->ringsize = size;
+  set->objsize = objsize;
+  set->init = init;
+  set->release = release;
+  set->arg = arg;
+  ddsrt_mutex_init (&set->lock);
+  set->rings = NULL;
+}
+
+static void thread_ring_release (struct ddsrt_thread_ring_set *set, struct ddsrt_thread_ring *r)
+{
+  if (set->release)
+    set->release (r);
+  ddsrt_free (r->buf);
+  r->buf = NULL;
+}
+
+static void thread_ring_unref (struct ddsrt_thread_ring *r)
+{
+  /* the set releases the buffers before dropping its reference */
+  if (ddsrt_atomic_dec32_nv (&r->refc) == 0)
+  {
+    assert (r->buf == NULL);
+    ddsrt_free (r);
+  }
+}
+
+void ddsrt_thread_ring_set_fini (struct ddsrt_thread_ring_set *set)
+{
+  while (set->rings)
+  {
+    struct ddsrt_thread_ring * const r = set->rings;
+    set->rings = r->next;
+    thread_ring_release (set, r);
+    thread_ring_unref (r);
+  }
+  ddsrt_mutex_destroy (&set->lock);
+}
+
+static void thread_ring_thread_exit (void *vr)
+{
+  struct ddsrt_thread_ring * const r = vr;
+  ddsrt_atomic_fence_rel ();
+  ddsrt_atomic_st32 (&r->orphan, 1);
+  thread_ring_unref (r);
+}
+
+static struct ddsrt_thread_ring *thread_ring_new (struct ddsrt_thread_ring_set *set)
+{
+  struct ddsrt_thread_ring *r;
+  if ((r = ddsrt_malloc_s (set->objsize)) == NULL)
+    return NULL;
+  memset (r, 0, set->objsize);
+  r->size = set->ringsize;
+  /* one reference for the owning thread, one for the set */
+  ddsrt_atomic_st32 (&r->refc, 2);
+  if ((r->buf = ddsrt_malloc_s (r->size)) == NULL)
+  {
+    ddsrt_free (r);
+    return NULL;
+  }
+  if ((set->init && !set->init (r, set->arg)) || ddsrt_thread_cleanup_push (thread_ring_thread_exit, r) != DDS_RETCODE_OK)
+  {
+    thread_ring_release (set, r);
+    ddsrt_free (r);
+    return NULL;
+  }
+
+  ddsrt_mutex_lock (&set->lock);
+  r->next = set->rings;
+  set->rings = r;
+  ddsrt_mutex_unlock (&set->lock);
+
+  struct thread_ring_tls_slot *slot = &thread_ring_tls[set->serial % THREAD_RING_TLS_SLOTS];
+  for (uint32_t i = 0; i < THREAD_RING_TLS_SLOTS; i++)
+    if (thread_ring_tls[i].ring == NULL)
+      slot = &thread_ring_tls[i];
+  if (slot->ring)
+  {
+    /* evicted: the consumer may release it once it has been drained */
+    ddsrt_atomic_fence_rel ();
+    ddsrt_atomic_st32 (&slot->ring->orphan, 1);
+  }
+  slot->serial = set->serial;
+  slot->ring = r;
+  return r;
+}
+
+struct ddsrt_thread_ring *ddsrt_thread_ring_get (struct ddsrt_thread_ring_set *set)
+{
+  for (uint32_t i = 0; i < THREAD_RING_TLS_SLOTS; i++)
+    if (thread_ring_tls[i].serial == set->serial)
+      return thread_ring_tls[i].ring;
+  return thread_ring_new (set);
+}
+
+bool ddsrt_thread_ring_reserve (const struct ddsrt_thread_ring *r, uint32_t n, uint32_t *pos)
+{
+  const uint32_t head = ddsrt_atomic_ld32 (&r->head);
+  const uint32_t tail = ddsrt_atomic_ld32 (&r->tail);
+  ddsrt_atomic_fence_acq ();
+  if (n > r->size - (head - tail))
+    return false;
+  *pos = head;
+  return true;
+}
+
+uint32_t ddsrt_thread_ring_copy_in (struct ddsrt_thread_ring *r, uint32_t pos, const void *src, uint32_t n)
+{
+  const uint32_t off = pos & (r->size - 1);
+  if (off + n <= r->size)
+    memcpy (r->buf + off, src, n);
+  else
+  {
+    const uint32_t n1 = r->size - off;
+    memcpy (r->buf + off, src, n1);
+    memcpy (r->buf, (const unsigned char *) src + n1, n - n1);
+  }
+  return pos + n;
+}
+
+uint32_t ddsrt_thread_ring_copy_out (const struct ddsrt_thread_ring *r, uint32_t pos, void *dst, uint32_t n)
+{
+  const uint32_t off = pos & (r->size - 1);
+  if (off + n <= r->size)
+    memcpy (dst, r->buf + off, n);
+  else
+  {
+    const uint32_t n1 = r->size - off;
+    memcpy (dst, r->buf + off, n1);
+    memcpy ((unsigned char *) dst + n1, r->buf, n - n1);
+  }
+  return pos + n;
+}
+
+bool ddsrt_thread_ring_commit (struct ddsrt_thread_ring *r, uint32_t pos)
+{
+  const uint32_t head = ddsrt_atomic_ld32 (&r->head);
+  const uint32_t tail = ddsrt_atomic_ld32 (&r->tail);
+  ddsrt_atomic_fence_rel ();
+  ddsrt_atomic_st32 (&r->head, pos);
+  return head - tail <= r->size / 2 && pos - tail > r->size / 2;
+}
+
+void ddsrt_thread_ring_consume (struct ddsrt_thread_ring *r, uint32_t pos)
+{
+  ddsrt_atomic_fence_rel ();
+  ddsrt_atomic_st32 (&r->tail, pos);
+}
+
+void ddsrt_thread_ring_set_drain (struct ddsrt_thread_ring_set *set, ddsrt_thread_ring_drain_fn fn, void *arg)
+{
+  ddsrt_mutex_lock (&set->lock);
+  struct ddsrt_thread_ring **pr = &set->rings;
+  while (*pr)
+  {
+    struct ddsrt_thread_ring * const r = *pr;
+    const bool orphan = ddsrt_atomic_ld32 (&r->orphan);
+    ddsrt_atomic_fence_acq ();
+    const uint32_t head = ddsrt_atomic_ld32 (&r->head);
+    const uint32_t tail = ddsrt_atomic_ld32 (&r->tail);
+    ddsrt_atomic_fence_acq ();
+    if (head != tail)
+      fn (r, tail, head, arg);
+    /* an orphan only gets removed once it has been drained completely, if it is
+       non-empty now it will be removed the next time */
+    if (!orphan || head != tail)
+      pr = &r->next;
+    else
+    {
+      *pr = r->next;
+      thread_ring_release (set, r);
+      thread_ring_unref (r);
+    }
+  }
+  ddsrt_mutex_unlock (&set->lock);
+}
@@ -0,0 +1,58 @@
+// Copyright(c) 2026 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <poll.h>
+#include <fcntl.h>
+
+#include "CUnit/Test.h"
+#include "dds/ddsrt/eventfd.h"
+
+static bool is_readable (const ddsrt_eventfd_t *ev)
+{
+  struct pollfd pfd = { .fd = ddsrt_eventfd_get_fd (ev), .events = POLLIN };
+  const int n = poll (&pfd, 1, 0);
+  CU_ASSERT_FATAL (n >= 0);
+  return n > 0 && (pfd.revents & POLLIN);
+}
+
+CU_Test(ddsrt_eventfd, signal_drain)
+{
+  ddsrt_eventfd_t ev;
+  dds_return_t rc = ddsrt_eventfd_init (&ev);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  const int fd = ddsrt_eventfd_get_fd (&ev);
+  CU_ASSERT ((fcntl (fd, F_GETFL) & O_NONBLOCK) != 0);
+  CU_ASSERT ((fcntl (fd, F_GETFD) & FD_CLOEXEC) != 0);
+  CU_ASSERT (!is_readable (&ev));
+  ddsrt_eventfd_drain (&ev);
+  CU_ASSERT (!is_readable (&ev));
+  ddsrt_eventfd_signal (&ev);
+  CU_ASSERT (is_readable (&ev));
+  ddsrt_eventfd_signal (&ev);
+  CU_ASSERT (is_readable (&ev));
+  ddsrt_eventfd_drain (&ev);
+  CU_ASSERT (!is_readable (&ev));
+  ddsrt_eventfd_fini (&ev);
+}
+
+CU_Test(ddsrt_eventfd, many_signals)
+{
+  // a pipe fills up after some thousands of signals, it must remain readable
+  // and be drained completely
+  ddsrt_eventfd_t ev;
+  dds_return_t rc = ddsrt_eventfd_init (&ev);
+  CU_ASSERT_FATAL (rc == DDS_RETCODE_OK);
+  for (int i = 0; i < 100000; i++)
+    ddsrt_eventfd_signal (&ev);
+  CU_ASSERT (is_readable (&ev));
+  ddsrt_eventfd_drain (&ev);
+  CU_ASSERT (!is_readable (&ev));
+  ddsrt_eventfd_fini (&ev);
+}
@@ -10,6 +10,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include <setjmp.h>
@@ -21,6 +22,7 @@
 
 #include "CUnit/Test.h"
 #include "CUnit/Theory.h"
+#include "dds/ddsrt/bintrace.h"
 #include "dds/ddsrt/heap.h"
 #include "dds/ddsrt/log.h"
 #include "dds/ddsrt/misc.h"
@@ -510,3 +512,103 @@ CU_Theory((bool local, int mode, bool expect_in_trace), dds_log, fatal_aborts)
   CU_PASS ("test skipped on this platform");
 #endif
 }
+
+static void bintrace_lines (const struct ddsrt_log_cfg *cfg)
+{
+  char longstr[3000];
+  memset (longstr, 'x', sizeof (longstr) - 1);
+  longstr[sizeof (longstr) - 1] = 0;
+  DDS_CTRACE (cfg, "plain\n");
+  DDS_CTRACE (cfg, "\n\nleading newlines %d\n", 1);
+  DDS_CTRACE (cfg, "a=%d", -5);
+  DDS_CTRACE (cfg, " b=%u c=%"PRIx64, 7u, UINT64_C (0xdeadbeef12345678));
+  DDS_CTRACE (cfg, " d=%hhd e=%hu f=%ld", 300, 70000, -1234567L);
+  DDS_CTRACE (cfg, " s=%s s2=%.*s s3=%-6.2s|", "str", 3, "abcdef", "xyz");
+  DDS_CTRACE (cfg, " p=%p g=%.3f h=%g i=%*d", (void *) &longstr, 3.14159, 1e10, 5, 42);
+  DDS_CTRACE (cfg, " j=%c %% k=%zu\n", 'x', (size_t) 42);
+  DDS_CTRACE (cfg, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
+              1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25);
+  DDS_CTRACE (cfg, "long %s\n", longstr);
+  /* format strings needn't be literals, the same buffer holding a different format
+     must not be mistaken for the previous one */
+  char fmtbuf[16];
+  (void) snprintf (fmtbuf, sizeof (fmtbuf), "reused %%d\n");
+  DDS_CTRACE (cfg, fmtbuf, 1);
+  (void) snprintf (fmtbuf, sizeof (fmtbuf), "reused %%s\n");
+  DDS_CTRACE (cfg, fmtbuf, "two");
+}
+
+static uint32_t bintrace_thread (void *vcfg)
+{
+  DDS_CTRACE ((const struct ddsrt_log_cfg *) vcfg, "from %s\n", "thread");
+  return 0;
+}
+
+static void bintrace_run (const struct ddsrt_log_cfg *cfg)
+{
+  ddsrt_thread_t tid;
+  ddsrt_threadattr_t tattr;
+  bintrace_lines (cfg);
+  ddsrt_threadattr_init (&tattr);
+  CU_ASSERT_FATAL (ddsrt_thread_create (&tid, "bttest", &tattr, bintrace_thread, (void *) cfg) == DDS_RETCODE_OK);
+  CU_ASSERT_FATAL (ddsrt_thread_join (tid, NULL) == DDS_RETCODE_OK);
+}
+
+static char *read_all (FILE *fp)
+{
+  long size;
+  char *buf;
+  CU_ASSERT_FATAL (fseek (fp, 0, SEEK_END) == 0);
+  size = ftell (fp);
+  CU_ASSERT_FATAL (size >= 0);
+  rewind (fp);
+  buf = ddsrt_malloc ((size_t) size + 1);
+  CU_ASSERT_FATAL (fread (buf, 1, (size_t) size, fp) == (size_t) size);
+  buf[size] = 0;
+  return buf;
+}
+
+/* The decoded binary trace must be identical to the text trace, apart
+   from the timestamps */
+CU_Test(dds_log, bintrace, .fini=reset)
+{
+  ddsrt_log_cfg_t tcfg, bcfg;
+  FILE *ft = tmpfile (), *fb = tmpfile (), *fd = tmpfile ();
+  CU_ASSERT_FATAL (ft != NULL && fb != NULL && fd != NULL);
+
+  dds_log_cfg_init (&tcfg, 0, DDS_LC_TRACE, NULL, ft);
+  bintrace_run (&tcfg);
+
+  struct ddsrt_bintrace *bt = ddsrt_bintrace_new (fb, 0, 65536);
+  CU_ASSERT_FATAL (bt != NULL);
+  dds_log_cfg_init (&bcfg, 0, DDS_LC_TRACE, NULL, NULL);
+  dds_log_cfg_set_bintrace (&bcfg, bt);
+  bintrace_run (&bcfg);
+  ddsrt_bintrace_free (bt);
+  rewind (fb);
+  CU_ASSERT_FATAL (ddsrt_bintrace_decode (fb, fd) == DDS_RETCODE_OK);
+
+  char *text = read_all (ft), *decoded = read_all (fd);
+  char *tl, *dl, *tcursor, *dcursor;
+  int nlines = 0;
+  tcursor = text;
+  dcursor = decoded;
+  tl = ddsrt_strsep (&tcursor, "\n");
+  dl = ddsrt_strsep (&dcursor, "\n");
+  while (tl && dl && *tl)
+  {
+    /* skip "%10u.%06d " */
+    CU_ASSERT_FATAL (strlen (tl) > 18 && strlen (dl) > 18);
+    CU_ASSERT_STRING_EQUAL (tl + 18, dl + 18);
+    nlines++;
+    tl = ddsrt_strsep (&tcursor, "\n");
+    dl = ddsrt_strsep (&dcursor, "\n");
+  }
+  CU_ASSERT (nlines == 8);
+  CU_ASSERT ((tl == NULL || *tl == 0) && (dl == NULL || *dl == 0));
+  ddsrt_free (text);
+  ddsrt_free (decoded);
+  fclose (ft);
+  fclose (fb);
+  fclose (fd);
+}
@@ -0,0 +1,178 @@
+// Copyright(c) 2026 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include "CUnit/Test.h"
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/threadring.h"
+
+struct test_ring {
+  struct ddsrt_thread_ring c;
+  uint32_t id;
+};
+
+struct drain_arg {
+  uint32_t nrings;
+  uint32_t sum;
+};
+
+static bool test_ring_init (struct ddsrt_thread_ring *vr, void *varg)
+{
+  struct test_ring * const r = (struct test_ring *) vr;
+  ddsrt_atomic_uint32_t * const next_id = varg;
+  r->id = ddsrt_atomic_inc32_ov (next_id);
+  return true;
+}
+
+static size_t count_rings (const struct ddsrt_thread_ring_set *set)
+{
+  size_t n = 0;
+  for (const struct ddsrt_thread_ring *r = set->rings; r; r = r->next)
+    n++;
+  return n;
+}
+
+static void drain_sum (struct ddsrt_thread_ring *r, uint32_t tail, uint32_t head, void *varg)
+{
+  struct drain_arg * const arg = varg;
+  arg->nrings++;
+  while (tail != head)
+  {
+    uint32_t x;
+    tail = ddsrt_thread_ring_copy_out (r, tail, &x, sizeof (x));
+    arg->sum += x;
+  }
+  ddsrt_thread_ring_consume (r, tail);
+}
+
+static bool put (struct ddsrt_thread_ring_set *set, uint32_t x)
+{
+  struct ddsrt_thread_ring * const r = ddsrt_thread_ring_get (set);
+  uint32_t pos;
+  if (r == NULL || !ddsrt_thread_ring_reserve (r, sizeof (x), &pos))
+    return false;
+  pos = ddsrt_thread_ring_copy_in (r, pos, &x, sizeof (x));
+  (void) ddsrt_thread_ring_commit (r, pos);
+  return true;
+}
+
+CU_Test(ddsrt_thread_ring, full)
+{
+  struct ddsrt_thread_ring_set set;
+  ddsrt_atomic_uint32_t next_id = DDSRT_ATOMIC_UINT32_INIT (0);
+  ddsrt_thread_ring_set_init (&set, 1, sizeof (struct test_ring), test_ring_init, NULL, &next_id);
+  struct ddsrt_thread_ring * const r = ddsrt_thread_ring_get (&set);
+  CU_ASSERT_FATAL (r != NULL);
+  CU_ASSERT_FATAL (r->size == 4096);
+  CU_ASSERT (ddsrt_thread_ring_get (&set) == r);
+  CU_ASSERT (ddsrt_atomic_ld32 (&next_id) == 1);
+
+  // the hint to wake the consumer is given once, when crossing half full
+  uint32_t pos, nhints = 0;
+  for (uint32_t i = 0; i < r->size / sizeof (uint32_t); i++)
+  {
+    CU_ASSERT_FATAL (ddsrt_thread_ring_reserve (r, sizeof (i), &pos));
+    pos = ddsrt_thread_ring_copy_in (r, pos, &i, sizeof (i));
+    if (ddsrt_thread_ring_commit (r, pos))
+      nhints++;
+  }
+  CU_ASSERT (nhints == 1);
+  CU_ASSERT (!ddsrt_thread_ring_reserve (r, 1, &pos));
+
+  struct drain_arg arg = { 0, 0 };
+  ddsrt_thread_ring_set_drain (&set, drain_sum, &arg);
+  const uint32_t n = r->size / sizeof (uint32_t);
+  CU_ASSERT (arg.nrings == 1);
+  CU_ASSERT (arg.sum == n * (n - 1) / 2);
+  CU_ASSERT (ddsrt_thread_ring_reserve (r, r->size, &pos));
+
+  // wraps around the end of the buffer
+  CU_ASSERT_FATAL (put (&set, 3));
+  arg = (struct drain_arg) { 0, 0 };
+  ddsrt_thread_ring_set_drain (&set, drain_sum, &arg);
+  CU_ASSERT (arg.sum == 3);
+  ddsrt_thread_ring_set_fini (&set);
+}
+
+static uint32_t producer (void *varg)
+{
+  struct ddsrt_thread_ring_set * const set = varg;
+  uint32_t nfailed = 0;
+  for (uint32_t i = 1; i <= 100; i++)
+    if (!put (set, i))
+      nfailed++;
+  return nfailed;
+}
+
+CU_Test(ddsrt_thread_ring, thread_exit)
+{
+  struct ddsrt_thread_ring_set set;
+  ddsrt_atomic_uint32_t next_id = DDSRT_ATOMIC_UINT32_INIT (0);
+  ddsrt_thread_ring_set_init (&set, 0, sizeof (struct test_ring), test_ring_init, NULL, &next_id);
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  ddsrt_thread_t tids[4];
+  for (uint32_t i = 0; i < 4; i++)
+    CU_ASSERT_FATAL (ddsrt_thread_create (&tids[i], "producer", &tattr, producer, &set) == DDS_RETCODE_OK);
+  for (uint32_t i = 0; i < 4; i++)
+  {
+    uint32_t nfailed;
+    CU_ASSERT_FATAL (ddsrt_thread_join (tids[i], &nfailed) == DDS_RETCODE_OK);
+    CU_ASSERT (nfailed == 0);
+  }
+  CU_ASSERT (ddsrt_atomic_ld32 (&next_id) == 4);
+  CU_ASSERT (count_rings (&set) == 4);
+
+  // rings of terminated threads are removed once drained
+  struct drain_arg arg = { 0, 0 };
+  ddsrt_thread_ring_set_drain (&set, drain_sum, &arg);
+  CU_ASSERT (arg.nrings == 4);
+  CU_ASSERT (arg.sum == 4 * 5050);
+  CU_ASSERT (count_rings (&set) == 4);
+  ddsrt_thread_ring_set_drain (&set, drain_sum, &arg);
+  CU_ASSERT (arg.nrings == 4);
+  CU_ASSERT (count_rings (&set) == 0);
+  ddsrt_thread_ring_set_fini (&set);
+}
+
+CU_Test(ddsrt_thread_ring, evict)
+{
+  // a thread using many sets evicts its rings of some of them, those rings are
+  // removed once drained and a new one is created if the thread uses the set again
+  struct ddsrt_thread_ring_set sets[16];
+  ddsrt_atomic_uint32_t next_id = DDSRT_ATOMIC_UINT32_INIT (0);
+  for (uint32_t i = 0; i < 16; i++)
+  {
+    ddsrt_thread_ring_set_init (&sets[i], 0, sizeof (struct test_ring), test_ring_init, NULL, &next_id);
+    CU_ASSERT_FATAL (put (&sets[i], i));
+  }
+  CU_ASSERT (ddsrt_atomic_ld32 (&next_id) == 16);
+  uint32_t nremoved = 0;
+  for (uint32_t i = 0; i < 16; i++)
+  {
+    struct drain_arg arg = { 0, 0 };
+    ddsrt_thread_ring_set_drain (&sets[i], drain_sum, &arg);
+    CU_ASSERT (arg.nrings == 1 && arg.sum == i);
+    ddsrt_thread_ring_set_drain (&sets[i], drain_sum, &arg);
+    if (count_rings (&sets[i]) == 0)
+      nremoved++;
+  }
+  CU_ASSERT (nremoved > 0);
+  for (uint32_t i = 0; i < 16; i++)
+    CU_ASSERT_FATAL (put (&sets[i], i));
+  CU_ASSERT (ddsrt_atomic_ld32 (&next_id) > 16);
+  for (uint32_t i = 0; i < 16; i++)
+  {
+    struct drain_arg arg = { 0, 0 };
+    ddsrt_thread_ring_set_drain (&sets[i], drain_sum, &arg);
+    CU_ASSERT (arg.sum == i);
+    ddsrt_thread_ring_set_fini (&sets[i]);
+  }
+}
@@ -36,6 +36,7 @@ struct idl_declaration {
     IDL_FORWARD_DECLARATION
   } kind;
   idl_declaration_t *next;
+  idl_declaration_t *hash_next; /**< next declaration in same bucket of scope index */
   const idl_scope_t *local_scope; /**< scope local to declaration */
   idl_name_t *name;
   idl_scoped_name_t *scoped_name;
@@ -63,6 +64,11 @@ struct idl_scope {
   struct {
     idl_declaration_t *first, *last;
   } declarations;
+  /** declarations hashed on identifier, ignoring case, buckets are in order of declaration */
+  struct {
+    size_t size, count;
+    idl_declaration_t **buckets;
+  } index;
   struct {
     idl_import_t *first, *last;
   } imports;
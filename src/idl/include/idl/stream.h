@@ -12,14 +12,24 @@
 #define IDL_STREAM_H
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
 
 #include "idl/export.h"
 #include "idl/attributes.h"
+#include "idl/retcode.h"
 
 IDL_EXPORT FILE *idl_fopen(const char *pathname, const char *mode);
 IDL_EXPORT int   idl_fclose(FILE * file);
 
+/* Files opened for writing with idl_fopen between idl_defer_writes and
+   idl_commit_writes are written to a temporary file next to them instead.
+   idl_commit_writes replaces a file by its temporary file only if keep is
+   set and the contents differ, so that files that did not change keep their
+   modification time. All files must be closed before committing. */
+IDL_EXPORT void idl_defer_writes(void);
+IDL_EXPORT idl_retcode_t idl_commit_writes(bool keep);
+
 IDL_EXPORT int idl_fprintf(FILE *fp, const char *fmt, ...)
 idl_attribute_format_printf(2, 3);
 
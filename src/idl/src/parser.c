@@ -723,26 +723,26 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   290,   290,   292,   297,   299,   304,   306,   310,   314,
-     321,   328,   333,   335,   337,   344,   349,   351,   353,   355,
-     357,   359,   361,   375,   378,   379,   387,   388,   396,   397,
-     405,   406,   414,   415,   418,   419,   427,   428,   431,   433,
-     441,   442,   443,   446,   451,   456,   457,   458,   462,   478,
-     480,   485,   507,   530,   537,   544,   555,   557,   562,   569,
-     585,   590,   591,   595,   597,   601,   603,   616,   617,   618,
-     619,   620,   621,   625,   626,   627,   631,   632,   636,   637,
-     638,   640,   641,   642,   643,   647,   648,   649,   651,   652,
-     653,   654,   658,   661,   664,   667,   670,   671,   672,   676,
-     678,   683,   685,   690,   692,   697,   698,   699,   700,   704,
-     705,   709,   714,   721,   726,   729,   744,   748,   753,   755,
-     760,   767,   768,   772,   779,   784,   789,   800,   802,   804,
-     806,   812,   814,   819,   821,   826,   833,   835,   840,   842,
-     849,   855,   858,   863,   865,   870,   876,   879,   884,   886,
-     891,   898,   903,   905,   910,   915,   919,   922,   924,   941,
-     943,   948,   949,   953,   972,   983,   982,   991,   993,   995,
-     997,   999,  1001,  1006,  1011,  1013,  1018,  1020,  1025,  1030,
-    1032,  1037,  1039,  1044,  1055,  1054,  1080,  1082,  1084,  1091,
-    1093,  1095,  1100,  1102,  1108,  1107
+       0,   296,   296,   298,   303,   307,   319,   321,   325,   329,
+     336,   343,   348,   350,   352,   359,   364,   366,   368,   370,
+     372,   374,   376,   390,   393,   394,   402,   403,   411,   412,
+     420,   421,   429,   430,   433,   434,   442,   443,   446,   448,
+     456,   457,   458,   461,   466,   471,   472,   473,   477,   493,
+     495,   500,   522,   545,   552,   559,   570,   572,   577,   584,
+     600,   605,   606,   610,   612,   616,   618,   631,   632,   633,
+     634,   635,   636,   640,   641,   642,   646,   647,   651,   652,
+     653,   655,   656,   657,   658,   662,   663,   664,   666,   667,
+     668,   669,   673,   676,   679,   682,   685,   686,   687,   691,
+     693,   698,   700,   705,   707,   712,   713,   714,   715,   719,
+     720,   724,   729,   736,   741,   744,   759,   763,   768,   770,
+     775,   782,   783,   787,   794,   799,   804,   815,   817,   819,
+     821,   827,   829,   834,   836,   841,   848,   850,   855,   857,
+     864,   870,   873,   878,   880,   885,   891,   894,   899,   901,
+     906,   913,   918,   920,   925,   930,   934,   937,   939,   956,
+     958,   963,   964,   968,   987,   998,   997,  1006,  1008,  1010,
+    1012,  1014,  1016,  1021,  1026,  1028,  1033,  1035,  1040,  1045,
+    1047,  1052,  1054,  1059,  1070,  1069,  1095,  1097,  1099,  1106,
+    1108,  1110,  1115,  1117,  1123,  1122
 };
 #endif
 
@@ -1428,469 +1428,469 @@ yydestruct (const char *yymsg,
   switch (yykind)
     {
     case YYSYMBOL_definitions: /* definitions  */
-#line 218 "src/parser.y"
-            { idl_delete_node(((*yyvaluep).node)); }
+#line 222 "src/parser.y"
+            { idl_delete_node(((*yyvaluep).nodes).first); }
 #line 1434 "parser.c"
         break;
 
     case YYSYMBOL_definition: /* definition  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).node)); }
 #line 1440 "parser.c"
         break;
 
     case YYSYMBOL_module_dcl: /* module_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).module_dcl)); }
 #line 1446 "parser.c"
         break;
 
     case YYSYMBOL_module_header: /* module_header  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).module_dcl)); }
 #line 1452 "parser.c"
         break;
 
     case YYSYMBOL_scoped_name: /* scoped_name  */
-#line 212 "src/parser.y"
+#line 216 "src/parser.y"
             { idl_delete_scoped_name(((*yyvaluep).scoped_name)); }
 #line 1458 "parser.c"
         break;
 
     case YYSYMBOL_const_dcl: /* const_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).const_dcl)); }
 #line 1464 "parser.c"
         break;
 
     case YYSYMBOL_const_type: /* const_type  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).type_spec)); }
 #line 1470 "parser.c"
         break;
 
     case YYSYMBOL_const_expr: /* const_expr  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1476 "parser.c"
         break;
 
     case YYSYMBOL_or_expr: /* or_expr  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1482 "parser.c"
         break;
 
     case YYSYMBOL_xor_expr: /* xor_expr  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1488 "parser.c"
         break;
 
     case YYSYMBOL_and_expr: /* and_expr  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1494 "parser.c"
         break;
 
     case YYSYMBOL_shift_expr: /* shift_expr  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1500 "parser.c"
         break;
 
     case YYSYMBOL_add_expr: /* add_expr  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1506 "parser.c"
         break;
 
     case YYSYMBOL_mult_expr: /* mult_expr  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1512 "parser.c"
         break;
 
     case YYSYMBOL_unary_expr: /* unary_expr  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1518 "parser.c"
         break;
 
     case YYSYMBOL_primary_expr: /* primary_expr  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1524 "parser.c"
         break;
 
     case YYSYMBOL_literal: /* literal  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).literal)); }
 #line 1530 "parser.c"
         break;
 
     case YYSYMBOL_string_literal: /* string_literal  */
-#line 207 "src/parser.y"
+#line 211 "src/parser.y"
             { idl_free(((*yyvaluep).string_literal)); }
 #line 1536 "parser.c"
         break;
 
     case YYSYMBOL_positive_int_const: /* positive_int_const  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).literal)); }
 #line 1542 "parser.c"
         break;
 
     case YYSYMBOL_type_dcl: /* type_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).node)); }
 #line 1548 "parser.c"
         break;
 
     case YYSYMBOL_type_spec: /* type_spec  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).type_spec)); }
 #line 1554 "parser.c"
         break;
 
     case YYSYMBOL_simple_type_spec: /* simple_type_spec  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).type_spec)); }
 #line 1560 "parser.c"
         break;
 
     case YYSYMBOL_template_type_spec: /* template_type_spec  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).type_spec)); }
 #line 1566 "parser.c"
         break;
 
     case YYSYMBOL_sequence_type: /* sequence_type  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).sequence)); }
 #line 1572 "parser.c"
         break;
 
     case YYSYMBOL_string_type: /* string_type  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).string)); }
 #line 1578 "parser.c"
         break;
 
     case YYSYMBOL_wstring_type: /* wstring_type  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).wstring)); }
 #line 1584 "parser.c"
         break;
 
     case YYSYMBOL_constr_type_dcl: /* constr_type_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).node)); }
 #line 1590 "parser.c"
         break;
 
     case YYSYMBOL_struct_dcl: /* struct_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).node)); }
 #line 1596 "parser.c"
         break;
 
     case YYSYMBOL_struct_forward_dcl: /* struct_forward_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).forward)); }
 #line 1602 "parser.c"
         break;
 
     case YYSYMBOL_struct_def: /* struct_def  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).struct_dcl)); }
 #line 1608 "parser.c"
         break;
 
     case YYSYMBOL_struct_header: /* struct_header  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).struct_dcl)); }
 #line 1614 "parser.c"
         break;
 
     case YYSYMBOL_struct_inherit_spec: /* struct_inherit_spec  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).type_spec)); }
 #line 1620 "parser.c"
         break;
 
     case YYSYMBOL_struct_body: /* struct_body  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).member)); }
 #line 1626 "parser.c"
         break;
 
     case YYSYMBOL_members: /* members  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).member)); }
 #line 1632 "parser.c"
         break;
 
     case YYSYMBOL_member: /* member  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).member)); }
 #line 1638 "parser.c"
         break;
 
     case YYSYMBOL_union_dcl: /* union_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).node)); }
 #line 1644 "parser.c"
         break;
 
     case YYSYMBOL_union_def: /* union_def  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).union_dcl)); }
 #line 1650 "parser.c"
         break;
 
     case YYSYMBOL_union_forward_dcl: /* union_forward_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).forward)); }
 #line 1656 "parser.c"
         break;
 
     case YYSYMBOL_union_header: /* union_header  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).union_dcl)); }
 #line 1662 "parser.c"
         break;
 
     case YYSYMBOL_switch_header: /* switch_header  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).switch_type_spec)); }
 #line 1668 "parser.c"
         break;
 
     case YYSYMBOL_switch_type_spec: /* switch_type_spec  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).type_spec)); }
 #line 1674 "parser.c"
         break;
 
     case YYSYMBOL_switch_body: /* switch_body  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep)._case)); }
 #line 1680 "parser.c"
         break;
 
     case YYSYMBOL_case: /* case  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep)._case)); }
 #line 1686 "parser.c"
         break;
 
     case YYSYMBOL_case_labels: /* case_labels  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).case_label)); }
 #line 1692 "parser.c"
         break;
 
     case YYSYMBOL_case_label: /* case_label  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).case_label)); }
 #line 1698 "parser.c"
         break;
 
     case YYSYMBOL_element_spec: /* element_spec  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep)._case)); }
 #line 1704 "parser.c"
         break;
 
     case YYSYMBOL_enum_dcl: /* enum_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).node)); }
 #line 1710 "parser.c"
         break;
 
     case YYSYMBOL_enum_def: /* enum_def  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).enum_dcl)); }
 #line 1716 "parser.c"
         break;
 
     case YYSYMBOL_enumerators: /* enumerators  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).enumerator)); }
 #line 1722 "parser.c"
         break;
 
     case YYSYMBOL_enumerator: /* enumerator  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).enumerator)); }
 #line 1728 "parser.c"
         break;
 
     case YYSYMBOL_bitmask_dcl: /* bitmask_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).node)); }
 #line 1734 "parser.c"
         break;
 
     case YYSYMBOL_bitmask_def: /* bitmask_def  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).bitmask_dcl)); }
 #line 1740 "parser.c"
         break;
 
     case YYSYMBOL_bit_values: /* bit_values  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).bit_value)); }
 #line 1746 "parser.c"
         break;
 
     case YYSYMBOL_bit_value: /* bit_value  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).bit_value)); }
 #line 1752 "parser.c"
         break;
 
     case YYSYMBOL_array_declarator: /* array_declarator  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).declarator)); }
 #line 1758 "parser.c"
         break;
 
     case YYSYMBOL_fixed_array_sizes: /* fixed_array_sizes  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).literal)); }
 #line 1764 "parser.c"
         break;
 
     case YYSYMBOL_fixed_array_size: /* fixed_array_size  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).literal)); }
 #line 1770 "parser.c"
         break;
 
     case YYSYMBOL_simple_declarator: /* simple_declarator  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).declarator)); }
 #line 1776 "parser.c"
         break;
 
     case YYSYMBOL_complex_declarator: /* complex_declarator  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).declarator)); }
 #line 1782 "parser.c"
         break;
 
     case YYSYMBOL_typedef_dcl: /* typedef_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).typedef_dcl)); }
 #line 1788 "parser.c"
         break;
 
     case YYSYMBOL_declarators: /* declarators  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).declarator)); }
 #line 1794 "parser.c"
         break;
 
     case YYSYMBOL_declarator: /* declarator  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).declarator)); }
 #line 1800 "parser.c"
         break;
 
     case YYSYMBOL_identifier: /* identifier  */
-#line 209 "src/parser.y"
+#line 213 "src/parser.y"
             { idl_delete_name(((*yyvaluep).name)); }
 #line 1806 "parser.c"
         break;
 
     case YYSYMBOL_annotation_dcl: /* annotation_dcl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation)); }
 #line 1812 "parser.c"
         break;
 
     case YYSYMBOL_annotation_header: /* annotation_header  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation)); }
 #line 1818 "parser.c"
         break;
 
     case YYSYMBOL_annotation_body: /* annotation_body  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation_member)); }
 #line 1824 "parser.c"
         break;
 
     case YYSYMBOL_annotation_member: /* annotation_member  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation_member)); }
 #line 1830 "parser.c"
         break;
 
     case YYSYMBOL_annotation_member_type: /* annotation_member_type  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).type_spec)); }
 #line 1836 "parser.c"
         break;
 
     case YYSYMBOL_annotation_member_default: /* annotation_member_default  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).const_expr)); }
 #line 1842 "parser.c"
         break;
 
     case YYSYMBOL_any_const_type: /* any_const_type  */
-#line 215 "src/parser.y"
+#line 219 "src/parser.y"
             { idl_unreference_node(((*yyvaluep).type_spec)); }
 #line 1848 "parser.c"
         break;
 
     case YYSYMBOL_annotations: /* annotations  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation_appl)); }
 #line 1854 "parser.c"
         break;
 
     case YYSYMBOL_annotation_appls: /* annotation_appls  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation_appl)); }
 #line 1860 "parser.c"
         break;
 
     case YYSYMBOL_annotation_appl: /* annotation_appl  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation_appl)); }
 #line 1866 "parser.c"
         break;
 
     case YYSYMBOL_annotation_appl_header: /* annotation_appl_header  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation_appl)); }
 #line 1872 "parser.c"
         break;
 
     case YYSYMBOL_annotation_appl_name: /* annotation_appl_name  */
-#line 212 "src/parser.y"
+#line 216 "src/parser.y"
             { idl_delete_scoped_name(((*yyvaluep).scoped_name)); }
 #line 1878 "parser.c"
         break;
 
     case YYSYMBOL_annotation_appl_params: /* annotation_appl_params  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation_appl_param)); }
 #line 1884 "parser.c"
         break;
 
     case YYSYMBOL_annotation_appl_keyword_params: /* annotation_appl_keyword_params  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation_appl_param)); }
 #line 1890 "parser.c"
         break;
 
     case YYSYMBOL_annotation_appl_keyword_param: /* annotation_appl_keyword_param  */
-#line 218 "src/parser.y"
+#line 224 "src/parser.y"
             { idl_delete_node(((*yyvaluep).annotation_appl_param)); }
 #line 1896 "parser.c"
         break;
@@ -2256,137 +2256,146 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* specification: %empty  */
-#line 291 "src/parser.y"
+#line 297 "src/parser.y"
       { pstate->root = NULL; }
 #line 2262 "parser.c"
     break;
 
   case 3: /* specification: definitions  */
-#line 293 "src/parser.y"
-      { pstate->root = (yyvsp[0].node); }
+#line 299 "src/parser.y"
+      { pstate->root = (yyvsp[0].nodes).first; }
 #line 2268 "parser.c"
     break;
 
   case 4: /* definitions: definition  */
-#line 298 "src/parser.y"
-      { (yyval.node) = (yyvsp[0].node); }
-#line 2274 "parser.c"
+#line 304 "src/parser.y"
+      { (yyval.nodes).first = (yyvsp[0].node);
+        (yyval.nodes).last = idl_last_node((yyvsp[0].node));
+      }
+#line 2276 "parser.c"
     break;
 
   case 5: /* definitions: definitions definition  */
-#line 300 "src/parser.y"
-      { (yyval.node) = idl_push_node((yyvsp[-1].node), (yyvsp[0].node)); }
-#line 2280 "parser.c"
+#line 308 "src/parser.y"
+      { (yyval.nodes) = (yyvsp[-1].nodes);
+        if (!(yyval.nodes).first)
+          (yyval.nodes).first = (yyvsp[0].node);
+        else
+          (void)idl_push_node((yyval.nodes).last, (yyvsp[0].node));
+        if ((yyvsp[0].node))
+          (yyval.nodes).last = idl_last_node((yyvsp[0].node));
+      }
+#line 2289 "parser.c"
     break;
 
   case 6: /* definition: annotation_dcl ';'  */
-#line 305 "src/parser.y"
+#line 320 "src/parser.y"
       { (yyval.node) = (yyvsp[-1].annotation); }
-#line 2286 "parser.c"
+#line 2295 "parser.c"
     break;
 
   case 7: /* definition: annotations module_dcl ';'  */
-#line 307 "src/parser.y"
+#line 322 "src/parser.y"
       { TRY(idl_annotate(pstate, (yyvsp[-1].module_dcl), (yyvsp[-2].annotation_appl)));
         (yyval.node) = (yyvsp[-1].module_dcl);
       }
-#line 2294 "parser.c"
+#line 2303 "parser.c"
     break;
 
   case 8: /* definition: annotations const_dcl ';'  */
-#line 311 "src/parser.y"
+#line 326 "src/parser.y"
       { TRY(idl_annotate(pstate, (yyvsp[-1].const_dcl), (yyvsp[-2].annotation_appl)));
         (yyval.node) = (yyvsp[-1].const_dcl);
       }
-#line 2302 "parser.c"
+#line 2311 "parser.c"
     break;
 
   case 9: /* definition: annotations type_dcl ';'  */
-#line 315 "src/parser.y"
+#line 330 "src/parser.y"
       { TRY(idl_annotate(pstate, (yyvsp[-1].node), (yyvsp[-2].annotation_appl)));
         (yyval.node) = (yyvsp[-1].node);
       }
-#line 2310 "parser.c"
+#line 2319 "parser.c"
     break;
 
   case 10: /* module_dcl: module_header '{' definitions '}'  */
-#line 322 "src/parser.y"
-      { TRY(idl_finalize_module(pstate, LOC((yylsp[-3]).first, (yylsp[0]).last), (yyvsp[-3].module_dcl), (yyvsp[-1].node)));
+#line 337 "src/parser.y"
+      { TRY(idl_finalize_module(pstate, LOC((yylsp[-3]).first, (yylsp[0]).last), (yyvsp[-3].module_dcl), (yyvsp[-1].nodes).first));
         (yyval.module_dcl) = (yyvsp[-3].module_dcl);
       }
-#line 2318 "parser.c"
+#line 2327 "parser.c"
     break;
 
   case 11: /* module_header: "module" identifier  */
-#line 329 "src/parser.y"
+#line 344 "src/parser.y"
       { TRY(idl_create_module(pstate, LOC((yylsp[-1]).first, (yylsp[0]).last), (yyvsp[0].name), &(yyval.module_dcl))); }
-#line 2324 "parser.c"
+#line 2333 "parser.c"
     break;
 
   case 12: /* scoped_name: identifier  */
-#line 334 "src/parser.y"
+#line 349 "src/parser.y"
       { TRY(idl_create_scoped_name(pstate, &(yylsp[0]), (yyvsp[0].name), false, &(yyval.scoped_name))); }
-#line 2330 "parser.c"
+#line 2339 "parser.c"
     break;
 
   case 13: /* scoped_name: IDL_TOKEN_SCOPE identifier  */
-#line 336 "src/parser.y"
+#line 351 "src/parser.y"
       { TRY(idl_create_scoped_name(pstate, LOC((yylsp[-1]).first, (yylsp[0]).last), (yyvsp[0].name), true, &(yyval.scoped_name))); }
-#line 2336 "parser.c"
+#line 2345 "parser.c"
     break;
 
   case 14: /* scoped_name: scoped_name IDL_TOKEN_SCOPE identifier  */
-#line 338 "src/parser.y"
+#line 353 "src/parser.y"
       { TRY(idl_push_scoped_name(pstate, (yyvsp[-2].scoped_name), (yyvsp[0].name)));
         (yyval.scoped_name) = (yyvsp[-2].scoped_name);
       }
-#line 2344 "parser.c"
+#line 2353 "parser.c"
     break;
 
   case 15: /* const_dcl: "const" const_type identifier '=' const_expr  */
-#line 345 "src/parser.y"
+#line 360 "src/parser.y"
       { TRY(idl_create_const(pstate, LOC((yylsp[-4]).first, (yylsp[0]).last), (yyvsp[-3].type_spec), (yyvsp[-2].name), (yyvsp[0].const_expr), &(yyval.const_dcl))); }
-#line 2350 "parser.c"
+#line 2359 "parser.c"
     break;
 
   case 16: /* const_type: integer_type  */
-#line 350 "src/parser.y"
+#line 365 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 2356 "parser.c"
+#line 2365 "parser.c"
     break;
 
   case 17: /* const_type: floating_pt_type  */
-#line 352 "src/parser.y"
+#line 367 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 2362 "parser.c"
+#line 2371 "parser.c"
     break;
 
   case 18: /* const_type: char_type  */
-#line 354 "src/parser.y"
+#line 369 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 2368 "parser.c"
+#line 2377 "parser.c"
     break;
 
   case 19: /* const_type: boolean_type  */
-#line 356 "src/parser.y"
+#line 371 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 2374 "parser.c"
+#line 2383 "parser.c"
     break;
 
   case 20: /* const_type: octet_type  */
-#line 358 "src/parser.y"
+#line 373 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 2380 "parser.c"
+#line 2389 "parser.c"
     break;
 
   case 21: /* const_type: string_type  */
-#line 360 "src/parser.y"
+#line 375 "src/parser.y"
       { (yyval.type_spec) = (idl_type_spec_t *)(yyvsp[0].string); }
-#line 2386 "parser.c"
+#line 2395 "parser.c"
     break;
 
   case 22: /* const_type: scoped_name  */
-#line 362 "src/parser.y"
+#line 377 "src/parser.y"
       { idl_node_t *node;
         const idl_declaration_t *declaration;
         static const char fmt[] =
@@ -2398,152 +2407,152 @@ yyreduce:
         (yyval.type_spec) = idl_reference_node((idl_node_t *)declaration->node);
         idl_delete_scoped_name((yyvsp[0].scoped_name));
       }
-#line 2402 "parser.c"
+#line 2411 "parser.c"
     break;
 
   case 23: /* const_expr: or_expr  */
-#line 375 "src/parser.y"
+#line 390 "src/parser.y"
                     { (yyval.const_expr) = (yyvsp[0].const_expr); }
-#line 2408 "parser.c"
+#line 2417 "parser.c"
     break;
 
   case 25: /* or_expr: or_expr '|' xor_expr  */
-#line 380 "src/parser.y"
+#line 395 "src/parser.y"
       { (yyval.const_expr) = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           TRY(idl_create_binary_expr(pstate, &(yylsp[-1]), IDL_OR, (yyvsp[-2].const_expr), (yyvsp[0].const_expr), &(yyval.const_expr)));
       }
-#line 2417 "parser.c"
+#line 2426 "parser.c"
     break;
 
   case 27: /* xor_expr: xor_expr '^' and_expr  */
-#line 389 "src/parser.y"
+#line 404 "src/parser.y"
       { (yyval.const_expr) = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           TRY(idl_create_binary_expr(pstate, &(yylsp[-1]), IDL_XOR, (yyvsp[-2].const_expr), (yyvsp[0].const_expr), &(yyval.const_expr)));
       }
-#line 2426 "parser.c"
+#line 2435 "parser.c"
     break;
 
   case 29: /* and_expr: and_expr '&' shift_expr  */
-#line 398 "src/parser.y"
+#line 413 "src/parser.y"
       { (yyval.const_expr) = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           TRY(idl_create_binary_expr(pstate, &(yylsp[-1]), IDL_AND, (yyvsp[-2].const_expr), (yyvsp[0].const_expr), &(yyval.const_expr)));
       }
-#line 2435 "parser.c"
+#line 2444 "parser.c"
     break;
 
   case 31: /* shift_expr: shift_expr shift_operator add_expr  */
-#line 407 "src/parser.y"
+#line 422 "src/parser.y"
       { (yyval.const_expr) = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           TRY(idl_create_binary_expr(pstate, &(yylsp[-1]), (yyvsp[-1].kind), (yyvsp[-2].const_expr), (yyvsp[0].const_expr), &(yyval.const_expr)));
       }
-#line 2444 "parser.c"
+#line 2453 "parser.c"
     break;
 
   case 32: /* shift_operator: ">>"  */
-#line 414 "src/parser.y"
+#line 429 "src/parser.y"
          { (yyval.kind) = IDL_RSHIFT; }
-#line 2450 "parser.c"
+#line 2459 "parser.c"
     break;
 
   case 33: /* shift_operator: "<<"  */
-#line 415 "src/parser.y"
+#line 430 "src/parser.y"
          { (yyval.kind) = IDL_LSHIFT; }
-#line 2456 "parser.c"
+#line 2465 "parser.c"
     break;
 
   case 35: /* add_expr: add_expr add_operator mult_expr  */
-#line 420 "src/parser.y"
+#line 435 "src/parser.y"
       { (yyval.const_expr) = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           TRY(idl_create_binary_expr(pstate, &(yylsp[-1]), (yyvsp[-1].kind), (yyvsp[-2].const_expr), (yyvsp[0].const_expr), &(yyval.const_expr)));
       }
-#line 2465 "parser.c"
+#line 2474 "parser.c"
     break;
 
   case 36: /* add_operator: '+'  */
-#line 427 "src/parser.y"
+#line 442 "src/parser.y"
         { (yyval.kind) = IDL_ADD; }
-#line 2471 "parser.c"
+#line 2480 "parser.c"
     break;
 
   case 37: /* add_operator: '-'  */
-#line 428 "src/parser.y"
+#line 443 "src/parser.y"
         { (yyval.kind) = IDL_SUBTRACT; }
-#line 2477 "parser.c"
+#line 2486 "parser.c"
     break;
 
   case 38: /* mult_expr: unary_expr  */
-#line 432 "src/parser.y"
+#line 447 "src/parser.y"
       { (yyval.const_expr) = (yyvsp[0].const_expr); }
-#line 2483 "parser.c"
+#line 2492 "parser.c"
     break;
 
   case 39: /* mult_expr: mult_expr mult_operator unary_expr  */
-#line 434 "src/parser.y"
+#line 449 "src/parser.y"
       { (yyval.const_expr) = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           TRY(idl_create_binary_expr(pstate, &(yylsp[-1]), (yyvsp[-1].kind), (yyvsp[-2].const_expr), (yyvsp[0].const_expr), &(yyval.const_expr)));
       }
-#line 2492 "parser.c"
+#line 2501 "parser.c"
     break;
 
   case 40: /* mult_operator: '*'  */
-#line 441 "src/parser.y"
+#line 456 "src/parser.y"
         { (yyval.kind) = IDL_MULTIPLY; }
-#line 2498 "parser.c"
+#line 2507 "parser.c"
     break;
 
   case 41: /* mult_operator: '/'  */
-#line 442 "src/parser.y"
+#line 457 "src/parser.y"
         { (yyval.kind) = IDL_DIVIDE; }
-#line 2504 "parser.c"
+#line 2513 "parser.c"
     break;
 
   case 42: /* mult_operator: '%'  */
-#line 443 "src/parser.y"
+#line 458 "src/parser.y"
         { (yyval.kind) = IDL_MODULO; }
-#line 2510 "parser.c"
+#line 2519 "parser.c"
     break;
 
   case 43: /* unary_expr: unary_operator primary_expr  */
-#line 447 "src/parser.y"
+#line 462 "src/parser.y"
       { (yyval.const_expr) = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           TRY(idl_create_unary_expr(pstate, &(yylsp[-1]), (yyvsp[-1].kind), (yyvsp[0].const_expr), &(yyval.const_expr)));
       }
-#line 2519 "parser.c"
+#line 2528 "parser.c"
     break;
 
   case 44: /* unary_expr: primary_expr  */
-#line 452 "src/parser.y"
+#line 467 "src/parser.y"
       { (yyval.const_expr) = (yyvsp[0].const_expr); }
-#line 2525 "parser.c"
+#line 2534 "parser.c"
     break;
 
   case 45: /* unary_operator: '-'  */
-#line 456 "src/parser.y"
+#line 471 "src/parser.y"
         { (yyval.kind) = IDL_MINUS; }
-#line 2531 "parser.c"
+#line 2540 "parser.c"
     break;
 
   case 46: /* unary_operator: '+'  */
-#line 457 "src/parser.y"
+#line 472 "src/parser.y"
         { (yyval.kind) = IDL_PLUS; }
-#line 2537 "parser.c"
+#line 2546 "parser.c"
     break;
 
   case 47: /* unary_operator: '~'  */
-#line 458 "src/parser.y"
+#line 473 "src/parser.y"
         { (yyval.kind) = IDL_NOT; }
-#line 2543 "parser.c"
+#line 2552 "parser.c"
     break;
 
   case 48: /* primary_expr: scoped_name  */
-#line 463 "src/parser.y"
+#line 478 "src/parser.y"
       { (yyval.const_expr) = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS) {
           /* disregard scoped names in application of unknown annotations.
@@ -2559,23 +2568,23 @@ yyreduce:
         }
         idl_delete_scoped_name((yyvsp[0].scoped_name));
       }
-#line 2563 "parser.c"
+#line 2572 "parser.c"
     break;
 
   case 49: /* primary_expr: literal  */
-#line 479 "src/parser.y"
+#line 494 "src/parser.y"
       { (yyval.const_expr) = (yyvsp[0].literal); }
-#line 2569 "parser.c"
+#line 2578 "parser.c"
     break;
 
   case 50: /* primary_expr: '(' const_expr ')'  */
-#line 481 "src/parser.y"
+#line 496 "src/parser.y"
       { (yyval.const_expr) = (yyvsp[-1].const_expr); }
-#line 2575 "parser.c"
+#line 2584 "parser.c"
     break;
 
   case 51: /* literal: IDL_TOKEN_INTEGER_LITERAL  */
-#line 486 "src/parser.y"
+#line 501 "src/parser.y"
       { idl_type_t type;
         idl_literal_t literal;
         (yyval.literal) = NULL;
@@ -2597,11 +2606,11 @@ yyreduce:
         TRY(idl_create_literal(pstate, &(yylsp[0]), type, &(yyval.literal)));
         (yyval.literal)->value = literal.value;
       }
-#line 2601 "parser.c"
+#line 2610 "parser.c"
     break;
 
   case 52: /* literal: IDL_TOKEN_FLOATING_PT_LITERAL  */
-#line 508 "src/parser.y"
+#line 523 "src/parser.y"
       { idl_type_t type;
         idl_literal_t literal;
         (yyval.literal) = NULL;
@@ -2624,67 +2633,67 @@ _Pragma("GCC diagnostic pop")
         TRY(idl_create_literal(pstate, &(yylsp[0]), type, &(yyval.literal)));
         (yyval.literal)->value = literal.value;
       }
-#line 2628 "parser.c"
+#line 2637 "parser.c"
     break;
 
   case 53: /* literal: IDL_TOKEN_CHAR_LITERAL  */
-#line 531 "src/parser.y"
+#line 546 "src/parser.y"
       { (yyval.literal) = NULL;
         if (pstate->parser.state == IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           break;
         TRY(idl_create_literal(pstate, &(yylsp[0]), IDL_CHAR, &(yyval.literal)));
         (yyval.literal)->value.chr = (yyvsp[0].chr);
       }
-#line 2639 "parser.c"
+#line 2648 "parser.c"
     break;
 
   case 54: /* literal: boolean_literal  */
-#line 538 "src/parser.y"
+#line 553 "src/parser.y"
       { (yyval.literal) = NULL;
         if (pstate->parser.state == IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           break;
         TRY(idl_create_literal(pstate, &(yylsp[0]), IDL_BOOL, &(yyval.literal)));
         (yyval.literal)->value.bln = (yyvsp[0].bln);
       }
-#line 2650 "parser.c"
+#line 2659 "parser.c"
     break;
 
   case 55: /* literal: string_literal  */
-#line 545 "src/parser.y"
+#line 560 "src/parser.y"
       { (yyval.literal) = NULL;
         if (pstate->parser.state == IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           break;
         TRY(idl_create_literal(pstate, &(yylsp[0]), IDL_STRING, &(yyval.literal)));
         (yyval.literal)->value.str = (yyvsp[0].string_literal);
       }
-#line 2661 "parser.c"
+#line 2670 "parser.c"
     break;
 
   case 56: /* boolean_literal: "TRUE"  */
-#line 556 "src/parser.y"
+#line 571 "src/parser.y"
       { (yyval.bln) = true; }
-#line 2667 "parser.c"
+#line 2676 "parser.c"
     break;
 
   case 57: /* boolean_literal: "FALSE"  */
-#line 558 "src/parser.y"
+#line 573 "src/parser.y"
       { (yyval.bln) = false; }
-#line 2673 "parser.c"
+#line 2682 "parser.c"
     break;
 
   case 58: /* string_literal: IDL_TOKEN_STRING_LITERAL  */
-#line 563 "src/parser.y"
+#line 578 "src/parser.y"
       { (yyval.string_literal) = NULL;
         if (pstate->parser.state == IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           break;
         if (!((yyval.string_literal) = idl_strdup((yyvsp[0].str))))
           NO_MEMORY();
       }
-#line 2684 "parser.c"
+#line 2693 "parser.c"
     break;
 
   case 59: /* string_literal: string_literal IDL_TOKEN_STRING_LITERAL  */
-#line 570 "src/parser.y"
+#line 585 "src/parser.y"
       { size_t n1, n2;
         (yyval.string_literal) = NULL;
         if (pstate->parser.state == IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
@@ -2697,35 +2706,35 @@ _Pragma("GCC diagnostic pop")
         memmove((yyval.string_literal)+n1, (yyvsp[0].str), n2);
         (yyval.string_literal)[n1+n2] = '\0';
       }
-#line 2701 "parser.c"
+#line 2710 "parser.c"
     break;
 
   case 60: /* positive_int_const: const_expr  */
-#line 586 "src/parser.y"
+#line 601 "src/parser.y"
       { TRY(idl_evaluate(pstate, (yyvsp[0].const_expr), IDL_ULONG, &(yyval.literal))); }
-#line 2707 "parser.c"
+#line 2716 "parser.c"
     break;
 
   case 61: /* type_dcl: constr_type_dcl  */
-#line 590 "src/parser.y"
+#line 605 "src/parser.y"
                     { (yyval.node) = (yyvsp[0].node); }
-#line 2713 "parser.c"
+#line 2722 "parser.c"
     break;
 
   case 62: /* type_dcl: typedef_dcl  */
-#line 591 "src/parser.y"
+#line 606 "src/parser.y"
                 { (yyval.node) = (yyvsp[0].typedef_dcl); }
-#line 2719 "parser.c"
+#line 2728 "parser.c"
     break;
 
   case 65: /* simple_type_spec: base_type_spec  */
-#line 602 "src/parser.y"
+#line 617 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 2725 "parser.c"
+#line 2734 "parser.c"
     break;
 
   case 66: /* simple_type_spec: scoped_name  */
-#line 604 "src/parser.y"
+#line 619 "src/parser.y"
       { const idl_declaration_t *declaration = NULL;
         static const char fmt[] =
           "Scoped name '%s' does not resolve to a type";
@@ -2735,229 +2744,229 @@ _Pragma("GCC diagnostic pop")
         (yyval.type_spec) = idl_reference_node((idl_node_t *)declaration->node);
         idl_delete_scoped_name((yyvsp[0].scoped_name));
       }
-#line 2739 "parser.c"
+#line 2748 "parser.c"
     break;
 
   case 73: /* floating_pt_type: "float"  */
-#line 625 "src/parser.y"
+#line 640 "src/parser.y"
             { (yyval.kind) = IDL_FLOAT; }
-#line 2745 "parser.c"
+#line 2754 "parser.c"
     break;
 
   case 74: /* floating_pt_type: "double"  */
-#line 626 "src/parser.y"
+#line 641 "src/parser.y"
              { (yyval.kind) = IDL_DOUBLE; }
-#line 2751 "parser.c"
+#line 2760 "parser.c"
     break;
 
   case 75: /* floating_pt_type: "long" "double"  */
-#line 627 "src/parser.y"
+#line 642 "src/parser.y"
                     { (yyval.kind) = IDL_LDOUBLE; }
-#line 2757 "parser.c"
+#line 2766 "parser.c"
     break;
 
   case 78: /* signed_int: "short"  */
-#line 636 "src/parser.y"
+#line 651 "src/parser.y"
             { (yyval.kind) = IDL_SHORT; }
-#line 2763 "parser.c"
+#line 2772 "parser.c"
     break;
 
   case 79: /* signed_int: "long"  */
-#line 637 "src/parser.y"
+#line 652 "src/parser.y"
            { (yyval.kind) = IDL_LONG; }
-#line 2769 "parser.c"
+#line 2778 "parser.c"
     break;
 
   case 80: /* signed_int: "long" "long"  */
-#line 638 "src/parser.y"
+#line 653 "src/parser.y"
                   { (yyval.kind) = IDL_LLONG; }
-#line 2775 "parser.c"
+#line 2784 "parser.c"
     break;
 
   case 81: /* signed_int: "int8"  */
-#line 640 "src/parser.y"
+#line 655 "src/parser.y"
            { (yyval.kind) = IDL_INT8; }
-#line 2781 "parser.c"
+#line 2790 "parser.c"
     break;
 
   case 82: /* signed_int: "int16"  */
-#line 641 "src/parser.y"
+#line 656 "src/parser.y"
             { (yyval.kind) = IDL_INT16; }
-#line 2787 "parser.c"
+#line 2796 "parser.c"
     break;
 
   case 83: /* signed_int: "int32"  */
-#line 642 "src/parser.y"
+#line 657 "src/parser.y"
             { (yyval.kind) = IDL_INT32; }
-#line 2793 "parser.c"
+#line 2802 "parser.c"
     break;
 
   case 84: /* signed_int: "int64"  */
-#line 643 "src/parser.y"
+#line 658 "src/parser.y"
             { (yyval.kind) = IDL_INT64; }
-#line 2799 "parser.c"
+#line 2808 "parser.c"
     break;
 
   case 85: /* unsigned_int: "unsigned" "short"  */
-#line 647 "src/parser.y"
+#line 662 "src/parser.y"
                        { (yyval.kind) = IDL_USHORT; }
-#line 2805 "parser.c"
+#line 2814 "parser.c"
     break;
 
   case 86: /* unsigned_int: "unsigned" "long"  */
-#line 648 "src/parser.y"
+#line 663 "src/parser.y"
                       { (yyval.kind) = IDL_ULONG; }
-#line 2811 "parser.c"
+#line 2820 "parser.c"
     break;
 
   case 87: /* unsigned_int: "unsigned" "long" "long"  */
-#line 649 "src/parser.y"
+#line 664 "src/parser.y"
                              { (yyval.kind) = IDL_ULLONG; }
-#line 2817 "parser.c"
+#line 2826 "parser.c"
     break;
 
   case 88: /* unsigned_int: "uint8"  */
-#line 651 "src/parser.y"
+#line 666 "src/parser.y"
             { (yyval.kind) = IDL_UINT8; }
-#line 2823 "parser.c"
+#line 2832 "parser.c"
     break;
 
   case 89: /* unsigned_int: "uint16"  */
-#line 652 "src/parser.y"
+#line 667 "src/parser.y"
              { (yyval.kind) = IDL_UINT16; }
-#line 2829 "parser.c"
+#line 2838 "parser.c"
     break;
 
   case 90: /* unsigned_int: "uint32"  */
-#line 653 "src/parser.y"
+#line 668 "src/parser.y"
              { (yyval.kind) = IDL_UINT32; }
-#line 2835 "parser.c"
+#line 2844 "parser.c"
     break;
 
   case 91: /* unsigned_int: "uint64"  */
-#line 654 "src/parser.y"
+#line 669 "src/parser.y"
              { (yyval.kind) = IDL_UINT64; }
-#line 2841 "parser.c"
+#line 2850 "parser.c"
     break;
 
   case 92: /* char_type: "char"  */
-#line 658 "src/parser.y"
+#line 673 "src/parser.y"
            { (yyval.kind) = IDL_CHAR; }
-#line 2847 "parser.c"
+#line 2856 "parser.c"
     break;
 
   case 93: /* wide_char_type: "wchar"  */
-#line 661 "src/parser.y"
+#line 676 "src/parser.y"
             { (yyval.kind) = IDL_WCHAR; }
-#line 2853 "parser.c"
+#line 2862 "parser.c"
     break;
 
   case 94: /* boolean_type: "boolean"  */
-#line 664 "src/parser.y"
+#line 679 "src/parser.y"
               { (yyval.kind) = IDL_BOOL; }
-#line 2859 "parser.c"
+#line 2868 "parser.c"
     break;
 
   case 95: /* octet_type: "octet"  */
-#line 667 "src/parser.y"
+#line 682 "src/parser.y"
             { (yyval.kind) = IDL_OCTET; }
-#line 2865 "parser.c"
+#line 2874 "parser.c"
     break;
 
   case 96: /* template_type_spec: sequence_type  */
-#line 670 "src/parser.y"
+#line 685 "src/parser.y"
                   { (yyval.type_spec) = (yyvsp[0].sequence); }
-#line 2871 "parser.c"
+#line 2880 "parser.c"
     break;
 
   case 97: /* template_type_spec: string_type  */
-#line 671 "src/parser.y"
+#line 686 "src/parser.y"
                   { (yyval.type_spec) = (yyvsp[0].string); }
-#line 2877 "parser.c"
+#line 2886 "parser.c"
     break;
 
   case 98: /* template_type_spec: wstring_type  */
-#line 672 "src/parser.y"
+#line 687 "src/parser.y"
                   { (yyval.type_spec) = (yyvsp[0].wstring); }
-#line 2883 "parser.c"
+#line 2892 "parser.c"
     break;
 
   case 99: /* sequence_type: "sequence" '<' type_spec ',' positive_int_const '>'  */
-#line 677 "src/parser.y"
+#line 692 "src/parser.y"
       { TRY(idl_create_sequence(pstate, LOC((yylsp[-5]).first, (yylsp[0]).last), (yyvsp[-3].type_spec), (yyvsp[-1].literal), &(yyval.sequence))); }
-#line 2889 "parser.c"
+#line 2898 "parser.c"
     break;
 
   case 100: /* sequence_type: "sequence" '<' type_spec '>'  */
-#line 679 "src/parser.y"
+#line 694 "src/parser.y"
       { TRY(idl_create_sequence(pstate, LOC((yylsp[-3]).first, (yylsp[0]).last), (yyvsp[-1].type_spec), NULL, &(yyval.sequence))); }
-#line 2895 "parser.c"
+#line 2904 "parser.c"
     break;
 
   case 101: /* string_type: "string" '<' positive_int_const '>'  */
-#line 684 "src/parser.y"
+#line 699 "src/parser.y"
       { TRY(idl_create_string(pstate, LOC((yylsp[-3]).first, (yylsp[0]).last), (yyvsp[-1].literal), &(yyval.string))); }
-#line 2901 "parser.c"
+#line 2910 "parser.c"
     break;
 
   case 102: /* string_type: "string"  */
-#line 686 "src/parser.y"
+#line 701 "src/parser.y"
       { TRY(idl_create_string(pstate, LOC((yylsp[0]).first, (yylsp[0]).last), NULL, &(yyval.string))); }
-#line 2907 "parser.c"
+#line 2916 "parser.c"
     break;
 
   case 103: /* wstring_type: "wstring" '<' positive_int_const '>'  */
-#line 691 "src/parser.y"
+#line 706 "src/parser.y"
       { TRY(idl_create_wstring(pstate, LOC((yylsp[-3]).first, (yylsp[0]).last), (yyvsp[-1].literal), &(yyval.wstring))); }
-#line 2913 "parser.c"
+#line 2922 "parser.c"
     break;
 
   case 104: /* wstring_type: "wstring"  */
-#line 693 "src/parser.y"
+#line 708 "src/parser.y"
       { TRY(idl_create_wstring(pstate, LOC((yylsp[0]).first, (yylsp[0]).last), NULL, &(yyval.wstring))); }
-#line 2919 "parser.c"
+#line 2928 "parser.c"
     break;
 
   case 109: /* struct_dcl: struct_def  */
-#line 704 "src/parser.y"
+#line 719 "src/parser.y"
                { (yyval.node) = (yyvsp[0].struct_dcl); }
-#line 2925 "parser.c"
+#line 2934 "parser.c"
     break;
 
   case 110: /* struct_dcl: struct_forward_dcl  */
-#line 705 "src/parser.y"
+#line 720 "src/parser.y"
                        { (yyval.node) = (yyvsp[0].forward); }
-#line 2931 "parser.c"
+#line 2940 "parser.c"
     break;
 
   case 111: /* struct_forward_dcl: "struct" identifier  */
-#line 710 "src/parser.y"
+#line 725 "src/parser.y"
       { TRY(idl_create_forward(pstate, &(yylsp[-1]), (yyvsp[0].name), IDL_STRUCT, &(yyval.forward))); }
-#line 2937 "parser.c"
+#line 2946 "parser.c"
     break;
 
   case 112: /* struct_def: struct_header '{' struct_body '}'  */
-#line 715 "src/parser.y"
+#line 730 "src/parser.y"
       { TRY(idl_finalize_struct(pstate, LOC((yylsp[-3]).first, (yylsp[0]).last), (yyvsp[-3].struct_dcl), (yyvsp[-1].member)));
         (yyval.struct_dcl) = (yyvsp[-3].struct_dcl);
       }
-#line 2945 "parser.c"
+#line 2954 "parser.c"
     break;
 
   case 113: /* struct_header: "struct" identifier struct_inherit_spec  */
-#line 722 "src/parser.y"
+#line 737 "src/parser.y"
       { TRY(idl_create_struct(pstate, LOC((yylsp[-2]).first, (yyvsp[0].type_spec) ? (yylsp[0]).last : (yylsp[-1]).last), (yyvsp[-1].name), (yyvsp[0].type_spec), &(yyval.struct_dcl))); }
-#line 2951 "parser.c"
+#line 2960 "parser.c"
     break;
 
   case 114: /* struct_inherit_spec: %empty  */
-#line 726 "src/parser.y"
+#line 741 "src/parser.y"
             { (yyval.type_spec) = NULL; }
-#line 2957 "parser.c"
+#line 2966 "parser.c"
     break;
 
   case 115: /* struct_inherit_spec: ':' scoped_name  */
-#line 730 "src/parser.y"
+#line 745 "src/parser.y"
       { idl_node_t *node;
         const idl_declaration_t *declaration;
         static const char fmt[] =
@@ -2969,75 +2978,75 @@ _Pragma("GCC diagnostic pop")
         TRY(idl_create_inherit_spec(pstate, &(yylsp[0]), idl_reference_node(node), &(yyval.type_spec)));
         idl_delete_scoped_name((yyvsp[0].scoped_name));
       }
-#line 2973 "parser.c"
+#line 2982 "parser.c"
     break;
 
   case 116: /* struct_body: members  */
-#line 745 "src/parser.y"
+#line 760 "src/parser.y"
       { (yyval.member) = (yyvsp[0].member); }
-#line 2979 "parser.c"
+#line 2988 "parser.c"
     break;
 
   case 117: /* struct_body: %empty  */
-#line 749 "src/parser.y"
+#line 764 "src/parser.y"
       { (yyval.member) = NULL; }
-#line 2985 "parser.c"
+#line 2994 "parser.c"
     break;
 
   case 118: /* members: member  */
-#line 754 "src/parser.y"
+#line 769 "src/parser.y"
       { (yyval.member) = (yyvsp[0].member); }
-#line 2991 "parser.c"
+#line 3000 "parser.c"
     break;
 
   case 119: /* members: members member  */
-#line 756 "src/parser.y"
+#line 771 "src/parser.y"
       { (yyval.member) = idl_push_node((yyvsp[-1].member), (yyvsp[0].member)); }
-#line 2997 "parser.c"
+#line 3006 "parser.c"
     break;
 
   case 120: /* member: annotations type_spec declarators ';'  */
-#line 761 "src/parser.y"
+#line 776 "src/parser.y"
       { TRY(idl_create_member(pstate, LOC((yylsp[-2]).first, (yylsp[0]).last), (yyvsp[-2].type_spec), (yyvsp[-1].declarator), &(yyval.member)));
         TRY_EXCEPT(idl_annotate(pstate, (yyval.member), (yyvsp[-3].annotation_appl)), idl_free((yyval.member)));
       }
-#line 3005 "parser.c"
+#line 3014 "parser.c"
     break;
 
   case 121: /* union_dcl: union_def  */
-#line 767 "src/parser.y"
+#line 782 "src/parser.y"
               { (yyval.node) = (yyvsp[0].union_dcl); }
-#line 3011 "parser.c"
+#line 3020 "parser.c"
     break;
 
   case 122: /* union_dcl: union_forward_dcl  */
-#line 768 "src/parser.y"
+#line 783 "src/parser.y"
                       { (yyval.node) = (yyvsp[0].forward); }
-#line 3017 "parser.c"
+#line 3026 "parser.c"
     break;
 
   case 123: /* union_def: union_header '{' switch_body '}'  */
-#line 773 "src/parser.y"
+#line 788 "src/parser.y"
       { TRY(idl_finalize_union(pstate, LOC((yylsp[-3]).first, (yylsp[0]).last), (yyvsp[-3].union_dcl), (yyvsp[-1]._case)));
         (yyval.union_dcl) = (yyvsp[-3].union_dcl);
       }
-#line 3025 "parser.c"
+#line 3034 "parser.c"
     break;
 
   case 124: /* union_forward_dcl: "union" identifier  */
-#line 780 "src/parser.y"
+#line 795 "src/parser.y"
       { TRY(idl_create_forward(pstate, &(yylsp[-1]), (yyvsp[0].name), IDL_UNION, &(yyval.forward))); }
-#line 3031 "parser.c"
+#line 3040 "parser.c"
     break;
 
   case 125: /* union_header: "union" identifier switch_header  */
-#line 785 "src/parser.y"
+#line 800 "src/parser.y"
       { TRY(idl_create_union(pstate, LOC((yylsp[-2]).first, (yylsp[0]).last), (yyvsp[-1].name), (yyvsp[0].switch_type_spec), &(yyval.union_dcl))); }
-#line 3037 "parser.c"
+#line 3046 "parser.c"
     break;
 
   case 126: /* switch_header: "switch" '(' annotations switch_type_spec ')'  */
-#line 790 "src/parser.y"
+#line 805 "src/parser.y"
       { /* switch_header action is a separate non-terminal, as opposed to a
            mid-rule action, to avoid freeing the type specifier twice (once
            through destruction of the type-spec and once through destruction
@@ -3045,203 +3054,203 @@ _Pragma("GCC diagnostic pop")
         TRY(idl_create_switch_type_spec(pstate, &(yylsp[-1]), (yyvsp[-1].type_spec), &(yyval.switch_type_spec)));
         TRY_EXCEPT(idl_annotate(pstate, (yyval.switch_type_spec), (yyvsp[-2].annotation_appl)), idl_delete_node((yyval.switch_type_spec)));
       }
-#line 3049 "parser.c"
+#line 3058 "parser.c"
     break;
 
   case 127: /* switch_type_spec: integer_type  */
-#line 801 "src/parser.y"
+#line 816 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 3055 "parser.c"
+#line 3064 "parser.c"
     break;
 
   case 128: /* switch_type_spec: char_type  */
-#line 803 "src/parser.y"
+#line 818 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 3061 "parser.c"
+#line 3070 "parser.c"
     break;
 
   case 129: /* switch_type_spec: boolean_type  */
-#line 805 "src/parser.y"
+#line 820 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 3067 "parser.c"
+#line 3076 "parser.c"
     break;
 
   case 130: /* switch_type_spec: scoped_name  */
-#line 807 "src/parser.y"
+#line 822 "src/parser.y"
       { const idl_declaration_t *declaration;
         TRY(idl_resolve(pstate, 0u, (yyvsp[0].scoped_name), &declaration));
         idl_delete_scoped_name((yyvsp[0].scoped_name));
         (yyval.type_spec) = idl_reference_node((idl_node_t *)declaration->node);
       }
-#line 3077 "parser.c"
+#line 3086 "parser.c"
     break;
 
   case 131: /* switch_type_spec: wide_char_type  */
-#line 813 "src/parser.y"
+#line 828 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 3083 "parser.c"
+#line 3092 "parser.c"
     break;
 
   case 132: /* switch_type_spec: octet_type  */
-#line 815 "src/parser.y"
+#line 830 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), (yyvsp[0].kind), &(yyval.type_spec))); }
-#line 3089 "parser.c"
+#line 3098 "parser.c"
     break;
 
   case 133: /* switch_body: case  */
-#line 820 "src/parser.y"
+#line 835 "src/parser.y"
       { (yyval._case) = (yyvsp[0]._case); }
-#line 3095 "parser.c"
+#line 3104 "parser.c"
     break;
 
   case 134: /* switch_body: switch_body case  */
-#line 822 "src/parser.y"
+#line 837 "src/parser.y"
       { (yyval._case) = idl_push_node((yyvsp[-1]._case), (yyvsp[0]._case)); }
-#line 3101 "parser.c"
+#line 3110 "parser.c"
     break;
 
   case 135: /* case: case_labels element_spec ';'  */
-#line 827 "src/parser.y"
+#line 842 "src/parser.y"
       { TRY(idl_finalize_case(pstate, &(yylsp[-1]), (yyvsp[-1]._case), (yyvsp[-2].case_label)));
         (yyval._case) = (yyvsp[-1]._case);
       }
-#line 3109 "parser.c"
+#line 3118 "parser.c"
     break;
 
   case 136: /* case_labels: case_label  */
-#line 834 "src/parser.y"
+#line 849 "src/parser.y"
       { (yyval.case_label) = (yyvsp[0].case_label); }
-#line 3115 "parser.c"
+#line 3124 "parser.c"
     break;
 
   case 137: /* case_labels: case_labels case_label  */
-#line 836 "src/parser.y"
+#line 851 "src/parser.y"
       { (yyval.case_label) = idl_push_node((yyvsp[-1].case_label), (yyvsp[0].case_label)); }
-#line 3121 "parser.c"
+#line 3130 "parser.c"
     break;
 
   case 138: /* case_label: "case" const_expr ':'  */
-#line 841 "src/parser.y"
+#line 856 "src/parser.y"
       { TRY(idl_create_case_label(pstate, LOC((yylsp[-2]).first, (yylsp[-1]).last), (yyvsp[-1].const_expr), &(yyval.case_label))); }
-#line 3127 "parser.c"
+#line 3136 "parser.c"
     break;
 
   case 139: /* case_label: "default" ':'  */
-#line 843 "src/parser.y"
+#line 858 "src/parser.y"
       { TRY(idl_create_case_label(pstate, &(yylsp[-1]), NULL, &(yyval.case_label))); }
-#line 3133 "parser.c"
+#line 3142 "parser.c"
     break;
 
   case 140: /* element_spec: annotations type_spec declarator  */
-#line 850 "src/parser.y"
+#line 865 "src/parser.y"
       { TRY(idl_create_case(pstate, LOC((yylsp[-2]).first, (yylsp[0]).last), (yyvsp[-1].type_spec), (yyvsp[0].declarator), &(yyval._case)));
         TRY_EXCEPT(idl_annotate(pstate, (yyval._case), (yyvsp[-2].annotation_appl)), idl_free((yyval._case)));
       }
-#line 3141 "parser.c"
+#line 3150 "parser.c"
     break;
 
   case 141: /* enum_dcl: enum_def  */
-#line 855 "src/parser.y"
+#line 870 "src/parser.y"
                    { (yyval.node) = (yyvsp[0].enum_dcl); }
-#line 3147 "parser.c"
+#line 3156 "parser.c"
     break;
 
   case 142: /* enum_def: "enum" identifier '{' enumerators '}'  */
-#line 859 "src/parser.y"
+#line 874 "src/parser.y"
       { TRY(idl_create_enum(pstate, LOC((yylsp[-4]).first, (yylsp[0]).last), (yyvsp[-3].name), (yyvsp[-1].enumerator), &(yyval.enum_dcl))); }
-#line 3153 "parser.c"
+#line 3162 "parser.c"
     break;
 
   case 143: /* enumerators: enumerator  */
-#line 864 "src/parser.y"
+#line 879 "src/parser.y"
       { (yyval.enumerator) = (yyvsp[0].enumerator); }
-#line 3159 "parser.c"
+#line 3168 "parser.c"
     break;
 
   case 144: /* enumerators: enumerators ',' enumerator  */
-#line 866 "src/parser.y"
+#line 881 "src/parser.y"
       { (yyval.enumerator) = idl_push_node((yyvsp[-2].enumerator), (yyvsp[0].enumerator)); }
-#line 3165 "parser.c"
+#line 3174 "parser.c"
     break;
 
   case 145: /* enumerator: annotations identifier  */
-#line 871 "src/parser.y"
+#line 886 "src/parser.y"
       { TRY(idl_create_enumerator(pstate, &(yylsp[0]), (yyvsp[0].name), &(yyval.enumerator)));
         TRY_EXCEPT(idl_annotate(pstate, (yyval.enumerator), (yyvsp[-1].annotation_appl)), idl_free((yyval.enumerator)));
       }
-#line 3173 "parser.c"
+#line 3182 "parser.c"
     break;
 
   case 146: /* bitmask_dcl: bitmask_def  */
-#line 876 "src/parser.y"
+#line 891 "src/parser.y"
                          { (yyval.node) = (yyvsp[0].bitmask_dcl); }
-#line 3179 "parser.c"
+#line 3188 "parser.c"
     break;
 
   case 147: /* bitmask_def: "bitmask" identifier '{' bit_values '}'  */
-#line 880 "src/parser.y"
+#line 895 "src/parser.y"
       { TRY(idl_create_bitmask(pstate, LOC((yylsp[-4]).first, (yylsp[0]).last), (yyvsp[-3].name), (yyvsp[-1].bit_value), &(yyval.bitmask_dcl))); }
-#line 3185 "parser.c"
+#line 3194 "parser.c"
     break;
 
   case 148: /* bit_values: bit_value  */
-#line 885 "src/parser.y"
+#line 900 "src/parser.y"
       { (yyval.bit_value) = (yyvsp[0].bit_value); }
-#line 3191 "parser.c"
+#line 3200 "parser.c"
     break;
 
   case 149: /* bit_values: bit_values ',' bit_value  */
-#line 887 "src/parser.y"
+#line 902 "src/parser.y"
       { (yyval.bit_value) = idl_push_node((yyvsp[-2].bit_value), (yyvsp[0].bit_value)); }
-#line 3197 "parser.c"
+#line 3206 "parser.c"
     break;
 
   case 150: /* bit_value: annotations identifier  */
-#line 892 "src/parser.y"
+#line 907 "src/parser.y"
       { TRY(idl_create_bit_value(pstate, &(yylsp[0]), (yyvsp[0].name), &(yyval.bit_value)));
         TRY_EXCEPT(idl_annotate(pstate, (yyval.bit_value), (yyvsp[-1].annotation_appl)), idl_free((yyval.bit_value)));
       }
-#line 3205 "parser.c"
+#line 3214 "parser.c"
     break;
 
   case 151: /* array_declarator: identifier fixed_array_sizes  */
-#line 899 "src/parser.y"
+#line 914 "src/parser.y"
       { TRY(idl_create_declarator(pstate, LOC((yylsp[-1]).first, (yylsp[0]).last), (yyvsp[-1].name), (yyvsp[0].literal), &(yyval.declarator))); }
-#line 3211 "parser.c"
+#line 3220 "parser.c"
     break;
 
   case 152: /* fixed_array_sizes: fixed_array_size  */
-#line 904 "src/parser.y"
+#line 919 "src/parser.y"
       { (yyval.literal) = (yyvsp[0].literal); }
-#line 3217 "parser.c"
+#line 3226 "parser.c"
     break;
 
   case 153: /* fixed_array_sizes: fixed_array_sizes fixed_array_size  */
-#line 906 "src/parser.y"
+#line 921 "src/parser.y"
       { (yyval.literal) = idl_push_node((yyvsp[-1].literal), (yyvsp[0].literal)); }
-#line 3223 "parser.c"
+#line 3232 "parser.c"
     break;
 
   case 154: /* fixed_array_size: '[' positive_int_const ']'  */
-#line 911 "src/parser.y"
+#line 926 "src/parser.y"
       { (yyval.literal) = (yyvsp[-1].literal); }
-#line 3229 "parser.c"
+#line 3238 "parser.c"
     break;
 
   case 155: /* simple_declarator: identifier  */
-#line 916 "src/parser.y"
+#line 931 "src/parser.y"
       { TRY(idl_create_declarator(pstate, &(yylsp[0]), (yyvsp[0].name), NULL, &(yyval.declarator))); }
-#line 3235 "parser.c"
+#line 3244 "parser.c"
     break;
 
   case 157: /* typedef_dcl: "typedef" type_spec declarators  */
-#line 923 "src/parser.y"
+#line 938 "src/parser.y"
       { TRY(idl_create_typedef(pstate, LOC((yylsp[-2]).first, (yylsp[0]).last), (yyvsp[-1].type_spec), (yyvsp[0].declarator), &(yyval.typedef_dcl))); }
-#line 3241 "parser.c"
+#line 3250 "parser.c"
     break;
 
   case 158: /* typedef_dcl: "typedef" constr_type_dcl declarators  */
-#line 925 "src/parser.y"
+#line 940 "src/parser.y"
       {
         idl_typedef_t *node;
         idl_type_spec_t *type_spec;
@@ -3255,23 +3264,23 @@ _Pragma("GCC diagnostic pop")
         idl_reference_node(type_spec);
         (yyval.typedef_dcl) = idl_push_node((yyvsp[-1].node), node);
       }
-#line 3259 "parser.c"
+#line 3268 "parser.c"
     break;
 
   case 159: /* declarators: declarator  */
-#line 942 "src/parser.y"
+#line 957 "src/parser.y"
       { (yyval.declarator) = (yyvsp[0].declarator); }
-#line 3265 "parser.c"
+#line 3274 "parser.c"
     break;
 
   case 160: /* declarators: declarators ',' declarator  */
-#line 944 "src/parser.y"
+#line 959 "src/parser.y"
       { (yyval.declarator) = idl_push_node((yyvsp[-2].declarator), (yyvsp[0].declarator)); }
-#line 3271 "parser.c"
+#line 3280 "parser.c"
     break;
 
   case 163: /* identifier: IDL_TOKEN_IDENTIFIER  */
-#line 954 "src/parser.y"
+#line 969 "src/parser.y"
       { (yyval.name) = NULL;
         size_t n;
         bool nocase = (pstate->config.flags & IDL_FLAG_CASE_SENSITIVE) == 0;
@@ -3287,149 +3296,149 @@ _Pragma("GCC diagnostic pop")
           TRY(idl_create_name(pstate, &(yylsp[0]), idl_strdup((yyvsp[0].str)+n), is_annotation, &(yyval.name)));
         }
       }
-#line 3291 "parser.c"
+#line 3300 "parser.c"
     break;
 
   case 164: /* annotation_dcl: annotation_header '{' annotation_body '}'  */
-#line 973 "src/parser.y"
+#line 988 "src/parser.y"
       { (yyval.annotation) = NULL;
         /* discard annotation in case of redefinition */
         if (pstate->parser.state != IDL_PARSE_EXISTING_ANNOTATION_BODY)
           (yyval.annotation) = (yyvsp[-3].annotation);
         TRY(idl_finalize_annotation(pstate, LOC((yylsp[-3]).first, (yylsp[0]).last), (yyvsp[-3].annotation), (yyvsp[-1].annotation_member)));
       }
-#line 3302 "parser.c"
+#line 3311 "parser.c"
     break;
 
   case 165: /* $@1: %empty  */
-#line 983 "src/parser.y"
+#line 998 "src/parser.y"
       { pstate->annotations = true; /* register annotation occurence */
         pstate->parser.state = IDL_PARSE_ANNOTATION;
       }
-#line 3310 "parser.c"
+#line 3319 "parser.c"
     break;
 
   case 166: /* annotation_header: "@" "annotation" $@1 identifier  */
-#line 987 "src/parser.y"
+#line 1002 "src/parser.y"
       { TRY(idl_create_annotation(pstate, LOC((yylsp[-3]).first, (yylsp[-2]).last), (yyvsp[0].name), &(yyval.annotation))); }
-#line 3316 "parser.c"
+#line 3325 "parser.c"
     break;
 
   case 167: /* annotation_body: %empty  */
-#line 992 "src/parser.y"
+#line 1007 "src/parser.y"
       { (yyval.annotation_member) = NULL; }
-#line 3322 "parser.c"
+#line 3331 "parser.c"
     break;
 
   case 168: /* annotation_body: annotation_body annotation_member ';'  */
-#line 994 "src/parser.y"
+#line 1009 "src/parser.y"
       { (yyval.annotation_member) = idl_push_node((yyvsp[-2].annotation_member), (yyvsp[-1].annotation_member)); }
-#line 3328 "parser.c"
+#line 3337 "parser.c"
     break;
 
   case 169: /* annotation_body: annotation_body enum_dcl ';'  */
-#line 996 "src/parser.y"
+#line 1011 "src/parser.y"
       { (yyval.annotation_member) = idl_push_node((yyvsp[-2].annotation_member), (yyvsp[-1].node)); }
-#line 3334 "parser.c"
+#line 3343 "parser.c"
     break;
 
   case 170: /* annotation_body: annotation_body bitmask_dcl ';'  */
-#line 998 "src/parser.y"
+#line 1013 "src/parser.y"
       { (yyval.annotation_member) = idl_push_node((yyvsp[-2].annotation_member), (yyvsp[-1].node)); }
-#line 3340 "parser.c"
+#line 3349 "parser.c"
     break;
 
   case 171: /* annotation_body: annotation_body const_dcl ';'  */
-#line 1000 "src/parser.y"
+#line 1015 "src/parser.y"
       { (yyval.annotation_member) = idl_push_node((yyvsp[-2].annotation_member), (yyvsp[-1].const_dcl)); }
-#line 3346 "parser.c"
+#line 3355 "parser.c"
     break;
 
   case 172: /* annotation_body: annotation_body typedef_dcl ';'  */
-#line 1002 "src/parser.y"
+#line 1017 "src/parser.y"
       { (yyval.annotation_member) = idl_push_node((yyvsp[-2].annotation_member), (yyvsp[-1].typedef_dcl)); }
-#line 3352 "parser.c"
+#line 3361 "parser.c"
     break;
 
   case 173: /* annotation_member: annotation_member_type simple_declarator annotation_member_default  */
-#line 1007 "src/parser.y"
+#line 1022 "src/parser.y"
       { TRY(idl_create_annotation_member(pstate, LOC((yylsp[-2]).first, (yylsp[0]).last), (yyvsp[-2].type_spec), (yyvsp[-1].declarator), (yyvsp[0].const_expr), &(yyval.annotation_member))); }
-#line 3358 "parser.c"
+#line 3367 "parser.c"
     break;
 
   case 174: /* annotation_member_type: const_type  */
-#line 1012 "src/parser.y"
+#line 1027 "src/parser.y"
       { (yyval.type_spec) = (yyvsp[0].type_spec); }
-#line 3364 "parser.c"
+#line 3373 "parser.c"
     break;
 
   case 175: /* annotation_member_type: any_const_type  */
-#line 1014 "src/parser.y"
+#line 1029 "src/parser.y"
       { (yyval.type_spec) = (yyvsp[0].type_spec); }
-#line 3370 "parser.c"
+#line 3379 "parser.c"
     break;
 
   case 176: /* annotation_member_default: %empty  */
-#line 1019 "src/parser.y"
+#line 1034 "src/parser.y"
       { (yyval.const_expr) = NULL; }
-#line 3376 "parser.c"
+#line 3385 "parser.c"
     break;
 
   case 177: /* annotation_member_default: "default" const_expr  */
-#line 1021 "src/parser.y"
+#line 1036 "src/parser.y"
       { (yyval.const_expr) = (yyvsp[0].const_expr); }
-#line 3382 "parser.c"
+#line 3391 "parser.c"
     break;
 
   case 178: /* any_const_type: "any"  */
-#line 1026 "src/parser.y"
+#line 1041 "src/parser.y"
       { TRY(idl_create_base_type(pstate, &(yylsp[0]), IDL_ANY, &(yyval.type_spec))); }
-#line 3388 "parser.c"
+#line 3397 "parser.c"
     break;
 
   case 179: /* annotations: annotation_appls  */
-#line 1031 "src/parser.y"
+#line 1046 "src/parser.y"
       { (yyval.annotation_appl) = (yyvsp[0].annotation_appl); }
-#line 3394 "parser.c"
+#line 3403 "parser.c"
     break;
 
   case 180: /* annotations: %empty  */
-#line 1033 "src/parser.y"
+#line 1048 "src/parser.y"
       { (yyval.annotation_appl) = NULL; }
-#line 3400 "parser.c"
+#line 3409 "parser.c"
     break;
 
   case 181: /* annotation_appls: annotation_appl  */
-#line 1038 "src/parser.y"
+#line 1053 "src/parser.y"
       { (yyval.annotation_appl) = (yyvsp[0].annotation_appl); }
-#line 3406 "parser.c"
+#line 3415 "parser.c"
     break;
 
   case 182: /* annotation_appls: annotation_appls annotation_appl  */
-#line 1040 "src/parser.y"
+#line 1055 "src/parser.y"
       { (yyval.annotation_appl) = idl_push_node((yyvsp[-1].annotation_appl), (yyvsp[0].annotation_appl)); }
-#line 3412 "parser.c"
+#line 3421 "parser.c"
     break;
 
   case 183: /* annotation_appl: annotation_appl_header annotation_appl_params  */
-#line 1045 "src/parser.y"
+#line 1060 "src/parser.y"
       { if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS)
           TRY(idl_finalize_annotation_appl(pstate, LOC((yylsp[-1]).first, (yylsp[0]).last), (yyvsp[-1].annotation_appl), (yyvsp[0].annotation_appl_param)));
         pstate->parser.state = IDL_PARSE;
         pstate->annotation_scope = NULL;
         (yyval.annotation_appl) = (yyvsp[-1].annotation_appl);
       }
-#line 3423 "parser.c"
+#line 3432 "parser.c"
     break;
 
   case 184: /* $@2: %empty  */
-#line 1055 "src/parser.y"
+#line 1070 "src/parser.y"
       { pstate->parser.state = IDL_PARSE_ANNOTATION_APPL; }
-#line 3429 "parser.c"
+#line 3438 "parser.c"
     break;
 
   case 185: /* annotation_appl_header: "@" $@2 annotation_appl_name  */
-#line 1057 "src/parser.y"
+#line 1072 "src/parser.y"
       { const idl_annotation_t *annotation;
         const idl_declaration_t *declaration =
           idl_find_scoped_name(pstate, NULL, (yyvsp[0].scoped_name), IDL_FIND_ANNOTATION);
@@ -3450,61 +3459,61 @@ _Pragma("GCC diagnostic pop")
 
         idl_delete_scoped_name((yyvsp[0].scoped_name));
       }
-#line 3454 "parser.c"
+#line 3463 "parser.c"
     break;
 
   case 186: /* annotation_appl_name: identifier  */
-#line 1081 "src/parser.y"
+#line 1096 "src/parser.y"
       { TRY(idl_create_scoped_name(pstate, &(yylsp[0]), (yyvsp[0].name), false, &(yyval.scoped_name))); }
-#line 3460 "parser.c"
+#line 3469 "parser.c"
     break;
 
   case 187: /* annotation_appl_name: IDL_TOKEN_SCOPE_NO_SPACE identifier  */
-#line 1083 "src/parser.y"
+#line 1098 "src/parser.y"
       { TRY(idl_create_scoped_name(pstate, LOC((yylsp[-1]).first, (yylsp[0]).last), (yyvsp[0].name), true, &(yyval.scoped_name))); }
-#line 3466 "parser.c"
+#line 3475 "parser.c"
     break;
 
   case 188: /* annotation_appl_name: annotation_appl_name IDL_TOKEN_SCOPE_NO_SPACE identifier  */
-#line 1085 "src/parser.y"
+#line 1100 "src/parser.y"
       { TRY(idl_push_scoped_name(pstate, (yyvsp[-2].scoped_name), (yyvsp[0].name)));
         (yyval.scoped_name) = (yyvsp[-2].scoped_name);
       }
-#line 3474 "parser.c"
+#line 3483 "parser.c"
     break;
 
   case 189: /* annotation_appl_params: %empty  */
-#line 1092 "src/parser.y"
+#line 1107 "src/parser.y"
       { (yyval.annotation_appl_param) = NULL; }
-#line 3480 "parser.c"
+#line 3489 "parser.c"
     break;
 
   case 190: /* annotation_appl_params: '(' const_expr ')'  */
-#line 1094 "src/parser.y"
+#line 1109 "src/parser.y"
       { (yyval.annotation_appl_param) = (yyvsp[-1].const_expr); }
-#line 3486 "parser.c"
+#line 3495 "parser.c"
     break;
 
   case 191: /* annotation_appl_params: '(' annotation_appl_keyword_params ')'  */
-#line 1096 "src/parser.y"
+#line 1111 "src/parser.y"
       { (yyval.annotation_appl_param) = (yyvsp[-1].annotation_appl_param); }
-#line 3492 "parser.c"
+#line 3501 "parser.c"
     break;
 
   case 192: /* annotation_appl_keyword_params: annotation_appl_keyword_param  */
-#line 1101 "src/parser.y"
+#line 1116 "src/parser.y"
       { (yyval.annotation_appl_param) = (yyvsp[0].annotation_appl_param); }
-#line 3498 "parser.c"
+#line 3507 "parser.c"
     break;
 
   case 193: /* annotation_appl_keyword_params: annotation_appl_keyword_params ',' annotation_appl_keyword_param  */
-#line 1103 "src/parser.y"
+#line 1118 "src/parser.y"
       { (yyval.annotation_appl_param) = idl_push_node((yyvsp[-2].annotation_appl_param), (yyvsp[0].annotation_appl_param)); }
-#line 3504 "parser.c"
+#line 3513 "parser.c"
     break;
 
   case 194: /* @3: %empty  */
-#line 1108 "src/parser.y"
+#line 1123 "src/parser.y"
       { idl_annotation_member_t *node = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS) {
           const idl_declaration_t *declaration = NULL;
@@ -3520,21 +3529,21 @@ _Pragma("GCC diagnostic pop")
         (yyval.annotation_member) = node;
         idl_delete_name((yyvsp[0].name));
       }
-#line 3524 "parser.c"
+#line 3533 "parser.c"
     break;
 
   case 195: /* annotation_appl_keyword_param: identifier @3 '=' const_expr  */
-#line 1124 "src/parser.y"
+#line 1139 "src/parser.y"
       { (yyval.annotation_appl_param) = NULL;
         if (pstate->parser.state != IDL_PARSE_UNKNOWN_ANNOTATION_APPL_PARAMS) {
           TRY(idl_create_annotation_appl_param(pstate, &(yylsp[-3]), (yyvsp[-2].annotation_member), (yyvsp[0].const_expr), &(yyval.annotation_appl_param)));
         }
       }
-#line 3534 "parser.c"
+#line 3543 "parser.c"
     break;
 
 
-#line 3538 "parser.c"
+#line 3547 "parser.c"
 
       default: break;
     }
@@ -3748,7 +3757,7 @@ yypushreturn:
 #undef yyls
 #undef yylsp
 #undef yystacksize
-#line 1131 "src/parser.y"
+#line 1146 "src/parser.y"
 
 
 #if defined(__GNUC__)
@@ -3838,4 +3847,4 @@ yyerror(idl_location_t *loc, idl_pstate_t *pstate, idl_retcode_t *result, const
   idl_error(pstate, loc, "%s", str);
   *result = IDL_RETCODE_SYNTAX_ERROR;
 }
-/* generated from parser.y[3f81580cb244497effa9931afbac0c4d770b40ba] */
+/* generated from parser.y[bc33f8dfb8c81668398c6a3879feda8937427e7d] */
@@ -35,8 +35,8 @@
    especially those whose name start with YY_ or yy_.  They are
    private implementation details that can be changed or removed.  */
 
-#ifndef YY_IDL_YY_PARSER_H_INCLUDED
-# define YY_IDL_YY_PARSER_H_INCLUDED
+#ifndef YY_IDL_YY_ROOT_REPO_GATE_BUILD_SRC_IDL_PARSER_H_INCLUDED
+# define YY_IDL_YY_ROOT_REPO_GATE_BUILD_SRC_IDL_PARSER_H_INCLUDED
 /* Debug traces.  */
 #ifndef IDL_YYDEBUG
 # if defined YYDEBUG
@@ -140,6 +140,9 @@ union IDL_YYSTYPE
 #line 105 "src/parser.y"
 
   void *node;
+  /* lists that can grow long keep track of the last node to avoid having to
+     traverse the list on every push */
+  struct { void *first, *last; } nodes;
   /* expressions */
   idl_literal_t *literal;
   idl_const_expr_t *const_expr;
@@ -183,7 +186,7 @@ union IDL_YYSTYPE
   unsigned long long ullng;
   long double ldbl;
 
-#line 187 "parser.h"
+#line 190 "parser.h"
 
 };
 typedef union IDL_YYSTYPE IDL_YYSTYPE;
@@ -228,7 +231,7 @@ void idl_yypstate_delete (idl_yypstate *ps);
 int idl_iskeyword(idl_pstate_t *pstate, const char *str, int nc);
 void idl_yypstate_delete_stack(idl_yypstate *yyps);
 
-#line 232 "parser.h"
+#line 235 "parser.h"
 
-#endif /* !YY_IDL_YY_PARSER_H_INCLUDED  */
-/* generated from parser.y[3f81580cb244497effa9931afbac0c4d770b40ba] */
+#endif /* !YY_IDL_YY_ROOT_REPO_GATE_BUILD_SRC_IDL_PARSER_H_INCLUDED  */
+/* generated from parser.y[bc33f8dfb8c81668398c6a3879feda8937427e7d] */
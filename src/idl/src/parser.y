@@ -104,6 +104,9 @@ void idl_yypstate_delete_stack(idl_yypstate *yyps);
 
 %union {
   void *node;
+  /* lists that can grow long keep track of the last node to avoid having to
+     traverse the list on every push */
+  struct { void *first, *last; } nodes;
   /* expressions */
   idl_literal_t *literal;
   idl_const_expr_t *const_expr;
@@ -162,7 +165,8 @@ void idl_yypstate_delete_stack(idl_yypstate *yyps);
 
 %start specification
 
-%type <node> definitions definition type_dcl
+%type <nodes> definitions
+%type <node> definition type_dcl
              constr_type_dcl struct_dcl union_dcl enum_dcl bitmask_dcl
 %type <type_spec> type_spec simple_type_spec template_type_spec
                   switch_type_spec const_type annotation_member_type
@@ -215,6 +219,8 @@ void idl_yypstate_delete_stack(idl_yypstate *yyps);
 %destructor { idl_unreference_node($$); }
   <type_spec> <const_expr>
 
+%destructor { idl_delete_node($$.first); } <nodes>
+
 %destructor { idl_delete_node($$); } <node> <literal> <sequence>
                                      <string> <wstring> <module_dcl> <struct_dcl> <member> <union_dcl>
                                      <_case> <case_label> <enum_dcl> <enumerator> <bitmask_dcl> <bit_value> <declarator> <typedef_dcl>
@@ -290,14 +296,23 @@ specification:
     %empty
       { pstate->root = NULL; }
   | definitions
-      { pstate->root = $1; }
+      { pstate->root = $1.first; }
   ;
 
 definitions:
     definition
-      { $$ = $1; }
+      { $$.first = $1;
+        $$.last = idl_last_node($1);
+      }
   | definitions definition
-      { $$ = idl_push_node($1, $2); }
+      { $$ = $1;
+        if (!$$.first)
+          $$.first = $2;
+        else
+          (void)idl_push_node($$.last, $2);
+        if ($2)
+          $$.last = idl_last_node($2);
+      }
   ;
 
 definition:
@@ -319,7 +334,7 @@ definition:
 
 module_dcl:
     module_header '{' definitions '}'
-      { TRY(idl_finalize_module(pstate, LOC(@1.first, @4.last), $1, $3));
+      { TRY(idl_finalize_module(pstate, LOC(@1.first, @4.last), $1, $3.first));
         $$ = $1;
       }
   ;
@@ -488,12 +488,9 @@ set_nestedness(
       idl_module_t *mod = node;
       if (!mod->default_nested.annotation)
         mod->default_nested.value = current_fallback;
-      else
-        current_fallback = mod->default_nested.value;
-
-      IDL_FOREACH(node, mod->definitions) {
-        set_nestedness(pstate, node, current_fallback);
-      }
+      /* the fallback of a module applies to its definitions, not to the
+         definitions that follow it */
+      set_nestedness(pstate, mod->definitions, mod->default_nested.value);
     } else if (idl_is_union(node) && !((idl_union_t*)node)->nested.annotation) {
       ((idl_union_t*)node)->nested.value = current_fallback;
     } else if (idl_is_struct(node) && !((idl_struct_t*)node)->nested.annotation) {
@@ -34,6 +34,59 @@ static int namecasecmp(const idl_name_t *n1, const idl_name_t *n2)
   return idl_strcasecmp(n1->identifier, n2->identifier);
 }
 
+/* hash is case insensitive (like idl_strcasecmp in the POSIX locale), so that
+   identifiers that differ only in case end up in the same bucket */
+static uint32_t hash_name(const idl_name_t *name)
+{
+  uint32_t h = 2166136261u;
+  for (const char *p = name->identifier; *p; p++) {
+    const unsigned char c = (unsigned char)*p;
+    h ^= (uint32_t)((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c);
+    h *= 16777619u;
+  }
+  return name->is_annotation ? ~h : h;
+}
+
+static idl_declaration_t *
+index_first(const idl_scope_t *scope, const idl_name_t *name)
+{
+  if (scope->index.size == 0)
+    return NULL;
+  return scope->index.buckets[hash_name(name) & (scope->index.size - 1)];
+}
+
+static void
+index_append(idl_scope_t *scope, idl_declaration_t *declaration)
+{
+  idl_declaration_t **entryp;
+  entryp = &scope->index.buckets[hash_name(declaration->name) & (scope->index.size - 1)];
+  while (*entryp)
+    entryp = &(*entryp)->hash_next;
+  declaration->hash_next = NULL;
+  *entryp = declaration;
+}
+
+/* must be called before appending the declaration to the list of declarations,
+   lookups depend on the entries in a bucket being in order of declaration */
+static idl_retcode_t
+index_add(idl_scope_t *scope, idl_declaration_t *declaration)
+{
+  if (scope->index.count >= scope->index.size) {
+    size_t size = scope->index.size ? 2 * scope->index.size : 8;
+    idl_declaration_t **buckets;
+    if (!(buckets = idl_calloc(size, sizeof(*buckets))))
+      return IDL_RETCODE_NO_MEMORY;
+    idl_free(scope->index.buckets);
+    scope->index.buckets = buckets;
+    scope->index.size = size;
+    for (idl_declaration_t *entry = scope->declarations.first; entry; entry = entry->next)
+      index_append(scope, entry);
+  }
+  index_append(scope, declaration);
+  scope->index.count++;
+  return IDL_RETCODE_OK;
+}
+
 static idl_retcode_t
 create_declaration(
   idl_pstate_t *pstate,
@@ -99,10 +152,17 @@ idl_create_scope(
   scope->parent = pstate->scope;
   scope->kind = kind;
   scope->name = (const idl_name_t *)entry->name;
+  scope->declarations.first = scope->declarations.last = NULL;
+  scope->index.size = scope->index.count = 0;
+  scope->index.buckets = NULL;
+  if (index_add(scope, entry))
+    goto err_index;
   scope->declarations.first = scope->declarations.last = entry;
   scope->imports.first = scope->imports.last = NULL;
   *scopep = scope;
   return IDL_RETCODE_OK;
+err_index:
+  idl_free(scope);
 err_scope:
   delete_declaration(entry);
 err_declaration:
@@ -123,6 +183,7 @@ void idl_delete_scope(idl_scope_t *scope)
       q = p->next;
       idl_free(p);
     }
+    idl_free(scope->index.buckets);
     idl_free(scope);
   }
 }
@@ -188,8 +249,9 @@ idl_declare(
   assert(pstate && pstate->scope);
   cmp = (pstate->config.flags & IDL_FLAG_CASE_SENSITIVE) ? &namecmp : &namecasecmp;
 
-  /* ensure there is no collision with an earlier declaration */
-  for (entry = pstate->scope->declarations.first; entry; entry = entry->next) {
+  /* ensure there is no collision with an earlier declaration, all of which
+     are in the same bucket in the index */
+  for (entry = index_first(pstate->scope, name); entry; entry = entry->hash_next) {
     /* identifiers that differ only in case collide, and will yield a
        compilation error under certain circumstances */
     if (cmp(name, entry->name) == 0) {
@@ -286,6 +348,10 @@ clash:
   entry->node = node;
   entry->scope = scope;
 
+  if (index_add(pstate->scope, entry)) {
+    delete_declaration(entry);
+    return IDL_RETCODE_NO_MEMORY;
+  }
   if (pstate->scope->declarations.first) {
     assert(pstate->scope->declarations.last);
     pstate->scope->declarations.last->next = entry;
@@ -395,7 +461,7 @@ idl_find(
      mappings to case-sensitive languages */
   cmp = (flags & IDL_FIND_IGNORE_CASE) ? &namecasecmp : &namecmp;
 
-  for (entry = scope->declarations.first; entry; entry = entry->next) {
+  for (entry = index_first(scope, name); entry; entry = entry->hash_next) {
     if ((is_annotation(scope, entry) && !(flags & IDL_FIND_ANNOTATION))
         || (entry->kind == IDL_SCOPE_DECLARATION && !(flags & IDL_FIND_SCOPE_DECLARATION)))
       continue;
@@ -343,7 +343,13 @@ int idl_fprintf(FILE *fp, const char *fmt, ...)
   return ret;
 }
 
-FILE *idl_fopen(const char *pathname, const char *mode)
+static struct {
+  bool active;
+  size_t count, size;
+  struct deferred_write { char *path, *temp_path; } *files;
+} deferred_writes;
+
+static FILE *fopen_path(const char *pathname, const char *mode)
 {
 #if _MSC_VER
   FILE *fp = NULL;
@@ -356,6 +362,98 @@ FILE *idl_fopen(const char *pathname, const char *mode)
 #endif
 }
 
+static const struct deferred_write *defer_write(const char *pathname)
+{
+  struct deferred_write *file;
+
+  for (size_t i = 0; i < deferred_writes.count; i++) {
+    if (strcmp(deferred_writes.files[i].path, pathname) == 0)
+      return &deferred_writes.files[i];
+  }
+  if (deferred_writes.count == deferred_writes.size) {
+    size_t size = deferred_writes.size ? 2 * deferred_writes.size : 4;
+    if (!(file = idl_realloc(deferred_writes.files, size * sizeof(*file))))
+      return NULL;
+    deferred_writes.files = file;
+    deferred_writes.size = size;
+  }
+  file = &deferred_writes.files[deferred_writes.count];
+  if (!(file->path = idl_strdup(pathname)))
+    return NULL;
+  if (idl_asprintf(&file->temp_path, "%s.tmp", pathname) < 0) {
+    idl_free(file->path);
+    return NULL;
+  }
+  deferred_writes.count++;
+  return file;
+}
+
+FILE *idl_fopen(const char *pathname, const char *mode)
+{
+  const struct deferred_write *file;
+
+  if (!deferred_writes.active || mode[0] != 'w')
+    return fopen_path(pathname, mode);
+  if (!(file = defer_write(pathname)))
+    return NULL;
+  return fopen_path(file->temp_path, mode);
+}
+
+static bool same_contents(const char *path1, const char *path2)
+{
+  FILE *fh1, *fh2;
+  char buf1[4096], buf2[4096];
+  size_t n1, n2;
+  bool same = false;
+
+  if (!(fh1 = fopen_path(path1, "rb")))
+    return false;
+  if (!(fh2 = fopen_path(path2, "rb"))) {
+    fclose(fh1);
+    return false;
+  }
+  do {
+    n1 = fread(buf1, 1, sizeof(buf1), fh1);
+    n2 = fread(buf2, 1, sizeof(buf2), fh2);
+    same = (n1 == n2 && memcmp(buf1, buf2, n1) == 0);
+  } while (same && n1 == sizeof(buf1));
+  same = same && !ferror(fh1) && !ferror(fh2);
+  fclose(fh1);
+  fclose(fh2);
+  return same;
+}
+
+void idl_defer_writes(void)
+{
+  assert(!deferred_writes.active);
+  deferred_writes.active = true;
+}
+
+idl_retcode_t idl_commit_writes(bool keep)
+{
+  idl_retcode_t ret = IDL_RETCODE_OK;
+
+  assert(deferred_writes.active);
+  for (size_t i = 0; i < deferred_writes.count; i++) {
+    const struct deferred_write *file = &deferred_writes.files[i];
+    if (!keep || same_contents(file->temp_path, file->path)) {
+      (void)remove(file->temp_path);
+    } else if (rename(file->temp_path, file->path) != 0) {
+      /* rename does not replace an existing file on Windows */
+      (void)remove(file->path);
+      if (rename(file->temp_path, file->path) != 0) {
+        (void)remove(file->temp_path);
+        ret = IDL_RETCODE_NO_ACCESS;
+      }
+    }
+    idl_free(file->path);
+    idl_free(file->temp_path);
+  }
+  idl_free(deferred_writes.files);
+  memset(&deferred_writes, 0, sizeof(deferred_writes));
+  return ret;
+}
+
 int idl_fclose(FILE *fp)
 {
   return fclose(fp);
@@ -42,6 +42,15 @@ void *idl_push_node(void *list, void *node)
   return list;
 }
 
+void *idl_last_node(void *list)
+{
+  idl_node_t *last = list;
+
+  if (last)
+    for (; last->next; last = last->next) ;
+  return last;
+}
+
 void *idl_reference_node(void *node)
 {
   if (node)
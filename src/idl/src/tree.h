@@ -30,6 +30,7 @@ struct idl_unary_expr {
 };
 
 void *idl_push_node(void *list, void *node);
+void *idl_last_node(void *list);
 void *idl_reference_node(void *node);
 void *idl_unreference_node(void *node);
 void *idl_delete_node(void *node);
@@ -487,6 +487,48 @@ CU_Test(idl_annotation, default_nested)
       idl_delete_pstate(pstate);
   }
 }
+
+CU_Test(idl_annotation, default_nested_sibling_modules)
+{
+  static const struct {
+    const char *str;
+    bool v[3];
+    bool pstate_default_nested;
+  } tests[] = {
+    {          M("m1", S("s1"))         M("m2", S("s2")) M("m3", S("s3")), {0,0,0}, false },
+    {          M("m1", S("s1"))         M("m2", S("s2")) M("m3", S("s3")), {1,1,1}, true },
+    { DN(NO)   M("m1", S("s1"))         M("m2", S("s2")) M("m3", S("s3")), {0,1,1}, true },
+    {          M("m1", S("s1")) DN(YES) M("m2", S("s2")) M("m3", S("s3")), {0,1,0}, false },
+  };
+
+  static const size_t n = sizeof(tests)/sizeof(tests[0]);
+
+  idl_retcode_t ret;
+  idl_pstate_t *pstate;
+
+  for (size_t i=0; i < n; i++) {
+    pstate = NULL;
+    ret = idl_create_pstate(IDL_FLAG_ANNOTATIONS, NULL, &pstate);
+    if (IDL_RETCODE_OK == ret) {
+      pstate->config.default_extensibility = IDL_FINAL;
+      pstate->config.default_nested = tests[i].pstate_default_nested;
+      ret = idl_parse_string(pstate, tests[i].str);
+    }
+
+    CU_ASSERT_EQUAL(ret, IDL_RETCODE_OK);
+    if (ret == IDL_RETCODE_OK) {
+      idl_module_t *m = (idl_module_t *)pstate->root;
+      for (size_t j=0; j < 3; j++, m = idl_next(m)) {
+        CU_ASSERT_FATAL(idl_is_module(m));
+        idl_struct_t *s = m->definitions;
+        CU_ASSERT_FATAL(idl_is_struct(s));
+        CU_ASSERT(s->nested.value == tests[i].v[j]);
+      }
+    }
+    if (pstate)
+      idl_delete_pstate(pstate);
+  }
+}
 #undef M
 #undef S
 #undef DN
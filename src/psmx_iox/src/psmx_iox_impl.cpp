@@ -555,32 +555,43 @@ static void on_incoming_data_callback(iox::popo::UntypedSubscriber * subscriber,
       std::cerr << ERROR_PREFIX "failed to apply scheduling settings" << std::endl;
   }
 
-  psmx_endpoint->lock.lock();
-  while (subscriber->hasData())
-  {
-    subscriber->take().and_then([psmx_endpoint](auto& sample) {
-      psmx_endpoint->lock.unlock();
-      auto data = incoming_sample_to_loan(psmx_endpoint, sample);
-      if (psmx_endpoint->_parent._parent._allow_nondisc_wr)
-      {
-        // By using dds_reader_store_loaned_sample_wr_metadata, Cyclone will accept data
-        // from writers that are not discovered and use the provided defaults for the
-        // relevant QoS settings.
-        int32_t ownership_strength = 0;
-        bool autodispose_unregistered_instances = false;
-        dds_duration_t lifespan_duration = DDS_INFINITY;
-        (void) dds_reader_store_loaned_sample_wr_metadata(psmx_endpoint->cdds_endpoint, data, ownership_strength, autodispose_unregistered_instances, lifespan_duration);
-      }
-      else
-      {
-        (void) dds_reader_store_loaned_sample(psmx_endpoint->cdds_endpoint, data);
-      }
+  // Take samples in batches so that they can be stored in the reader history cache
+  // with a single call, amortizing the locking of the reader and the triggering of
+  // listeners and waitsets
+  constexpr uint32_t max_batch = 32;
+  dds_loaned_sample_t *batch[max_batch];
+  uint32_t n;
+  do {
+    n = 0;
+    psmx_endpoint->lock.lock();
+    while (n < max_batch && subscriber->hasData())
+    {
+      subscriber->take().and_then([psmx_endpoint, &batch, &n](auto& sample) {
+        batch[n++] = incoming_sample_to_loan(psmx_endpoint, sample);
+      });
+    }
+    psmx_endpoint->lock.unlock();
+    if (n == 0)
+      break;
 
-      dds_loaned_sample_unref(data);
-      psmx_endpoint->lock.lock();
-    });
-  }
-  psmx_endpoint->lock.unlock();
+    if (psmx_endpoint->_parent._parent._allow_nondisc_wr)
+    {
+      // By using dds_reader_store_loaned_samples_wr_metadata, Cyclone will accept data
+      // from writers that are not discovered and use the provided defaults for the
+      // relevant QoS settings.
+      int32_t ownership_strength = 0;
+      bool autodispose_unregistered_instances = false;
+      dds_duration_t lifespan_duration = DDS_INFINITY;
+      (void) dds_reader_store_loaned_samples_wr_metadata(psmx_endpoint->cdds_endpoint, n, batch, ownership_strength, autodispose_unregistered_instances, lifespan_duration);
+    }
+    else
+    {
+      (void) dds_reader_store_loaned_samples(psmx_endpoint->cdds_endpoint, n, batch);
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+      dds_loaned_sample_unref(batch[i]);
+  } while (n == max_batch);
 }
 
 static dds_return_t iox_on_data_available(struct dds_psmx_endpoint * psmx_endpoint, dds_entity_t reader)
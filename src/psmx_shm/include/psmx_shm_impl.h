@@ -0,0 +1,41 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef PSMX_SHM_IMPL_H
+#define PSMX_SHM_IMPL_H
+
+#include "dds/dds.h"
+#include "dds/ddsc/dds_loaned_sample.h"
+#include "dds/ddsc/dds_psmx.h"
+#include "psmx_shm_export.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Constructor for the POSIX shared memory PSMX plugin
+ *
+ * Recognized configuration options (in addition to INSTANCE_NAME/SERVICE_NAME):
+ * - LOCATOR: 32 hex digits, defaults to the contents of /etc/machine-id
+ * - KEYED_TOPICS: true/false, default true
+ * - SLOT_SIZE: minimum payload size of a slot in bytes, default 65536
+ * - NSLOTS: number of slots in a segment, default 512
+ * - RING_SIZE: number of entries in the ring of published samples, default 64
+ *
+ * The slot/ring geometry is fixed by the process that creates the segment.
+ */
+DDS_PSMX_SHM_EXPORT dds_return_t shm_create_psmx (struct dds_psmx **psmx, dds_psmx_instance_id_t instance_id, const char *config);
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* PSMX_SHM_IMPL_H */
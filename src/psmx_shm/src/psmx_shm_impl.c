@@ -0,0 +1,1119 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+// PSMX plugin using POSIX shared memory, without any daemon.
+//
+// Each (instance, partition, topic, type) maps to a shared memory segment containing:
+//
+// - a header with the geometry and the attach count;
+// - a table of registered readers, each with its own read position;
+// - a table of registered writers, each with the last ring position it claimed;
+// - a ring of published samples, each entry encoding (sequence number << SHM_SLOT_BITS) | slot;
+// - a pool of fixed-size, reference counted slots holding the metadata and the payload,
+//   free slots are kept in a lock-free stack.
+//
+// A writer loan is a slot taken from the pool.  Writing transfers the slot to the ring,
+// dropping the ring's reference to the slot that previously occupied the entry.  Readers
+// take a reference to the slot before advancing their read position, so a slot stays
+// valid for as long as a reader (or an application holding a loan) uses it.  Writers
+// wait for readers to catch up before overwriting an entry they haven't consumed yet,
+// bounded by the max. blocking time for reliable writers and not at all for best-effort
+// ones.  Readers lagging beyond that lose the overwritten samples.
+//
+// Writers claim a ring position by incrementing the write position, and only then fill
+// in the entry.  A writer that finds the previous use of its entry not yet filled in waits
+// for it, until the writer that claimed it turns out to be dead or for at most its own max.
+// blocking time.  After that, it marks the previous use as lost (a ring entry without a
+// slot) and carries on; should the claimer still be alive, it discovers this when it
+// fills in the entry and drops its sample.
+//
+// Reader wake-ups go through a futex in the segment header that writers bump after each
+// publication.
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "dds/ddsrt/atomics.h"
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/log.h"
+#include "dds/ddsrt/mh3.h"
+#include "dds/ddsrt/sockets.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/strtol.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/time.h"
+#include "psmx_shm_impl.h"
+
+#define SHM_MAGIC UINT64_C (0x434444535053484d) // "CDDSPSHM"
+#define SHM_VERSION 2
+
+#define SHM_STATE_INIT 0u
+#define SHM_STATE_READY 1u
+
+#define SHM_REFS_DEAD 0x80000000u
+
+#define SHM_SLOT_BITS 20
+#define SHM_SLOT_MASK ((UINT64_C (1) << SHM_SLOT_BITS) - 1)
+#define SHM_MAX_SLOTS ((uint32_t) SHM_SLOT_MASK)
+#define SHM_NO_SLOT UINT32_MAX
+
+#define SHM_MAX_READERS 64
+#define SHM_READER_FREE 0u
+#define SHM_READER_CLAIMED 1u
+#define SHM_READER_ACTIVE 2u
+
+#define SHM_MAX_WRITERS 64
+#define SHM_WRITER_FREE 0u
+#define SHM_WRITER_CLAIMED 1u
+#define SHM_WRITER_ACTIVE 2u
+#define SHM_NO_WRITER UINT32_MAX
+
+// minimum time a writer waits for a live writer to fill in the previous use of a ring
+// entry, and the maximum time it waits if it can't tell which writer claimed it
+#define SHM_MIN_CLAIM_WAIT DDS_MSECS (100)
+
+#define SHM_KEY_MAX 512
+#define SHM_ALIGN 64
+
+// maximum number of samples handed to Cyclone DDS in one call by a delivery thread
+#define SHM_DELIVERY_BATCH 32
+
+#define SHM_DEFAULT_SLOT_SIZE 65536
+#define SHM_DEFAULT_NSLOTS 512
+#define SHM_DEFAULT_RING_SIZE 64
+
+struct shm_reader_entry {
+  ddsrt_atomic_uint32_t state;
+  int32_t pid;
+  ddsrt_atomic_uint64_t read_pos;
+  uint64_t pidns;
+  char pad[SHM_ALIGN - 24];
+};
+
+struct shm_writer_entry {
+  ddsrt_atomic_uint32_t state;
+  int32_t pid;
+  ddsrt_atomic_uint64_t claim; // last claimed ring position, UINT64_MAX if none
+  uint64_t pidns;
+  char pad[SHM_ALIGN - 24];
+};
+
+struct shm_slot {
+  ddsrt_atomic_uint32_t refc;
+  uint32_t next; // index + 1 of next free slot, 0 terminates the list
+  dds_psmx_metadata_t metadata;
+};
+
+struct shm_header {
+  uint64_t magic;
+  uint32_t version;
+  ddsrt_atomic_uint32_t state;
+  ddsrt_atomic_uint32_t refs;
+  uint32_t nslots;
+  uint32_t slot_size;
+  uint32_t slot_stride;
+  uint32_t ring_size;
+  uint32_t keylen;
+  uint64_t size;
+  uint64_t off_readers;
+  uint64_t off_writers;
+  uint64_t off_ring;
+  uint64_t off_slots;
+  char key[SHM_KEY_MAX];
+  // frequently updated fields each in their own cache line
+  char pad0[SHM_ALIGN];
+  ddsrt_atomic_uint64_t freelist; // (tag << 32) | (index + 1)
+  char pad1[SHM_ALIGN - 8];
+  ddsrt_atomic_uint64_t write_pos;
+  char pad2[SHM_ALIGN - 8];
+  ddsrt_atomic_uint32_t notify;
+  ddsrt_atomic_uint32_t nwaiters;
+  char pad3[SHM_ALIGN - 8];
+};
+
+struct shm_segment {
+  ddsrt_atomic_uint32_t refc;
+  struct shm_header *hdr;
+  struct shm_reader_entry *readers;
+  struct shm_writer_entry *writers;
+  ddsrt_atomic_uint64_t *ring;
+  unsigned char *slots;
+  size_t size;
+  uint64_t pidns; // PID namespace of this process
+  char name[32];
+};
+
+struct shm_psmx {
+  struct dds_psmx c;
+  dds_psmx_node_identifier_t node_id;
+  bool support_keyed_topics;
+  uint32_t slot_size;
+  uint32_t nslots;
+  uint32_t ring_size;
+};
+
+struct shm_psmx_topic {
+  struct dds_psmx_topic c;
+  uint32_t sizeof_type;
+};
+
+struct shm_psmx_endpoint {
+  struct dds_psmx_endpoint c;
+  struct shm_segment *seg;
+  dds_duration_t max_blocking_time;
+  uint32_t reader_index;
+  uint32_t writer_index;
+  dds_entity_t reader;
+  bool delivery_running;
+  ddsrt_atomic_uint32_t delivery_stop;
+  ddsrt_thread_t delivery_tid;
+};
+
+struct shm_loan {
+  dds_loaned_sample_t c;
+  struct shm_segment *seg;
+  uint32_t slot;
+  dds_psmx_metadata_t metadata; // private copy on the reading side
+};
+
+static bool shm_type_qos_supported (struct dds_psmx *psmx, dds_psmx_endpoint_type_t forwhat, dds_data_type_properties_t data_type_props, const struct dds_qos *qos);
+static struct dds_psmx_topic *shm_create_topic (struct dds_psmx *psmx, const char *topic_name, const char *type_name, dds_data_type_properties_t data_type_props, const struct ddsi_type *type_definition, uint32_t sizeof_type);
+static dds_return_t shm_delete_topic (struct dds_psmx_topic *psmx_topic);
+static void shm_delete_psmx (struct dds_psmx *psmx);
+static dds_psmx_node_identifier_t shm_get_node_id (const struct dds_psmx *psmx);
+static dds_psmx_features_t shm_supported_features (const struct dds_psmx *psmx);
+
+static const dds_psmx_ops_t psmx_ops = {
+  .type_qos_supported = shm_type_qos_supported,
+  .create_topic = NULL,
+  .delete_topic = shm_delete_topic,
+  .deinit = NULL,
+  .get_node_id = shm_get_node_id,
+  .supported_features = shm_supported_features,
+  .create_topic_with_type = shm_create_topic,
+  .delete_psmx = shm_delete_psmx
+};
+
+static struct dds_psmx_endpoint *shm_create_endpoint (struct dds_psmx_topic *psmx_topic, const struct dds_qos *qos, dds_psmx_endpoint_type_t endpoint_type);
+static dds_return_t shm_delete_endpoint (struct dds_psmx_endpoint *psmx_endpoint);
+
+static const dds_psmx_topic_ops_t psmx_topic_ops = {
+  .create_endpoint = shm_create_endpoint,
+  .delete_endpoint = shm_delete_endpoint
+};
+
+static dds_loaned_sample_t *shm_ep_request_loan (struct dds_psmx_endpoint *psmx_endpoint, uint32_t size_requested);
+static dds_return_t shm_ep_write_with_key (struct dds_psmx_endpoint *psmx_endpoint, dds_loaned_sample_t *data, size_t keysz, const void *key);
+static dds_loaned_sample_t *shm_ep_take (struct dds_psmx_endpoint *psmx_endpoint);
+static dds_return_t shm_ep_on_data_available (struct dds_psmx_endpoint *psmx_endpoint, dds_entity_t reader);
+
+static const dds_psmx_endpoint_ops_t psmx_ep_ops = {
+  .request_loan = shm_ep_request_loan,
+  .write = NULL,
+  .take = shm_ep_take,
+  .on_data_available = shm_ep_on_data_available,
+  .write_with_key = shm_ep_write_with_key
+};
+
+static void shm_loan_free (struct dds_loaned_sample *loaned_sample);
+
+static const dds_loaned_sample_ops_t loan_ops = {
+  .free = shm_loan_free
+};
+
+static uint64_t align_up (uint64_t x)
+{
+  return (x + SHM_ALIGN - 1) & ~(uint64_t) (SHM_ALIGN - 1);
+}
+
+static void futex_wait (ddsrt_atomic_uint32_t *word, uint32_t value, dds_duration_t timeout)
+{
+  struct timespec ts = { .tv_sec = (time_t) (timeout / DDS_NSECS_IN_SEC), .tv_nsec = (long) (timeout % DDS_NSECS_IN_SEC) };
+  // shared between processes, so not FUTEX_WAIT_PRIVATE
+  (void) syscall (SYS_futex, &word->v, FUTEX_WAIT, value, &ts, NULL, 0);
+}
+
+static void futex_wake (ddsrt_atomic_uint32_t *word)
+{
+  (void) syscall (SYS_futex, &word->v, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static uint64_t own_pidns (void)
+{
+  struct stat st;
+  return (stat ("/proc/self/ns/pid", &st) == 0) ? (uint64_t) st.st_ino : 0;
+}
+
+static bool process_alive (const struct shm_segment *seg, int32_t pid, uint64_t pidns)
+{
+  // Process ids are only meaningful within a PID namespace: processes in different
+  // containers sharing /dev/shm can't check each other's existence with kill() and
+  // so the other process is assumed to be alive.  That leaves time-outs as the only
+  // way of dealing with a process in another namespace that died.
+  if (pidns != seg->pidns)
+    return true;
+  return !(kill ((pid_t) pid, 0) == -1 && errno == ESRCH);
+}
+
+static struct shm_slot *slot_ptr (const struct shm_segment *seg, uint32_t slot)
+{
+  assert (slot < seg->hdr->nslots);
+  return (struct shm_slot *) (seg->slots + (size_t) slot * seg->hdr->slot_stride);
+}
+
+static void *slot_data (const struct shm_segment *seg, uint32_t slot)
+{
+  return (unsigned char *) slot_ptr (seg, slot) + align_up (sizeof (struct shm_slot));
+}
+
+static bool slot_alloc (struct shm_segment *seg, uint32_t *slot)
+{
+  // Treiber stack, the tag in the upper half of the head avoids the ABA problem
+  uint64_t head, new_head;
+  uint32_t idx1;
+  do {
+    head = ddsrt_atomic_ld64 (&seg->hdr->freelist);
+    if ((idx1 = (uint32_t) head) == 0)
+      return false;
+    const uint32_t next = slot_ptr (seg, idx1 - 1)->next;
+    new_head = (((head >> 32) + 1) << 32) | next;
+  } while (!ddsrt_atomic_cas64 (&seg->hdr->freelist, head, new_head));
+  ddsrt_atomic_st32 (&slot_ptr (seg, idx1 - 1)->refc, 1);
+  *slot = idx1 - 1;
+  return true;
+}
+
+static void slot_free (struct shm_segment *seg, uint32_t slot)
+{
+  struct shm_slot * const s = slot_ptr (seg, slot);
+  uint64_t head, new_head;
+  do {
+    head = ddsrt_atomic_ld64 (&seg->hdr->freelist);
+    s->next = (uint32_t) head;
+    ddsrt_atomic_fence_rel ();
+    new_head = (((head >> 32) + 1) << 32) | (slot + 1);
+  } while (!ddsrt_atomic_cas64 (&seg->hdr->freelist, head, new_head));
+}
+
+static bool slot_ref_if_live (struct shm_segment *seg, uint32_t slot)
+{
+  struct shm_slot * const s = slot_ptr (seg, slot);
+  uint32_t refc;
+  while ((refc = ddsrt_atomic_ld32 (&s->refc)) > 0)
+    if (ddsrt_atomic_cas32 (&s->refc, refc, refc + 1))
+      return true;
+  return false;
+}
+
+static void slot_unref (struct shm_segment *seg, uint32_t slot)
+{
+  if (ddsrt_atomic_dec32_nv (&slot_ptr (seg, slot)->refc) == 0)
+    slot_free (seg, slot);
+}
+
+static void segment_name (char *name, size_t size, const char *key, size_t keylen)
+{
+  const uint64_t h = ((uint64_t) ddsrt_mh3 (key, keylen, 0) << 32) | ddsrt_mh3 (key, keylen, 0x9e3779b9);
+  (void) snprintf (name, size, "/cdds-psmx-%016"PRIx64, h);
+}
+
+static void segment_init (struct shm_header *hdr, const char *key, size_t keylen, uint32_t nslots, uint32_t slot_size, uint32_t ring_size)
+{
+  // memory from ftruncate is zero-initialized, so only non-zero fields need setting
+  hdr->magic = SHM_MAGIC;
+  hdr->version = SHM_VERSION;
+  hdr->nslots = nslots;
+  hdr->slot_size = slot_size;
+  hdr->slot_stride = (uint32_t) (align_up (sizeof (struct shm_slot)) + align_up (slot_size));
+  hdr->ring_size = ring_size;
+  hdr->keylen = (uint32_t) keylen;
+  memcpy (hdr->key, key, keylen);
+  hdr->off_readers = align_up (sizeof (*hdr));
+  hdr->off_writers = hdr->off_readers + align_up (SHM_MAX_READERS * sizeof (struct shm_reader_entry));
+  hdr->off_ring = hdr->off_writers + align_up (SHM_MAX_WRITERS * sizeof (struct shm_writer_entry));
+  hdr->off_slots = hdr->off_ring + align_up (ring_size * sizeof (ddsrt_atomic_uint64_t));
+  hdr->size = hdr->off_slots + (uint64_t) nslots * hdr->slot_stride;
+  unsigned char *slots = (unsigned char *) hdr + hdr->off_slots;
+  for (uint32_t i = 0; i < nslots; i++)
+  {
+    struct shm_slot *s = (struct shm_slot *) (slots + (size_t) i * hdr->slot_stride);
+    s->next = (i + 1 < nslots) ? i + 2 : 0;
+  }
+  ddsrt_atomic_st64 (&hdr->freelist, 1);
+}
+
+static size_t segment_size (uint32_t nslots, uint32_t slot_size, uint32_t ring_size)
+{
+  return (size_t) (align_up (sizeof (struct shm_header)) +
+                   align_up (SHM_MAX_READERS * sizeof (struct shm_reader_entry)) +
+                   align_up (SHM_MAX_WRITERS * sizeof (struct shm_writer_entry)) +
+                   align_up (ring_size * sizeof (ddsrt_atomic_uint64_t)) +
+                   (uint64_t) nslots * (align_up (sizeof (struct shm_slot)) + align_up (slot_size)));
+}
+
+static struct shm_segment *segment_new (const char *name, struct shm_header *hdr, size_t size)
+{
+  struct shm_segment *seg = ddsrt_malloc (sizeof (*seg));
+  ddsrt_atomic_st32 (&seg->refc, 1);
+  seg->hdr = hdr;
+  seg->readers = (struct shm_reader_entry *) ((unsigned char *) hdr + hdr->off_readers);
+  seg->writers = (struct shm_writer_entry *) ((unsigned char *) hdr + hdr->off_writers);
+  seg->ring = (ddsrt_atomic_uint64_t *) ((unsigned char *) hdr + hdr->off_ring);
+  seg->slots = (unsigned char *) hdr + hdr->off_slots;
+  seg->size = size;
+  seg->pidns = own_pidns ();
+  (void) ddsrt_strlcpy (seg->name, name, sizeof (seg->name));
+  return seg;
+}
+
+static bool segment_try_attach (struct shm_header *hdr)
+{
+  uint32_t refs;
+  do {
+    if ((refs = ddsrt_atomic_ld32 (&hdr->refs)) & SHM_REFS_DEAD)
+      return false;
+  } while (!ddsrt_atomic_cas32 (&hdr->refs, refs, refs + 1));
+  return true;
+}
+
+static struct shm_header *segment_open_existing (int fd, const char *key, size_t keylen, size_t *size)
+{
+  // The creator may not yet have set the size or finished initializing it
+  const dds_time_t tend = dds_time () + DDS_SECS (1);
+  struct stat st;
+  while (fstat (fd, &st) == 0 && (size_t) st.st_size < sizeof (struct shm_header))
+  {
+    if (dds_time () > tend)
+      return NULL;
+    dds_sleepfor (DDS_MSECS (1));
+  }
+  if ((size_t) st.st_size < sizeof (struct shm_header))
+    return NULL;
+  void *addr = mmap (NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED)
+    return NULL;
+  struct shm_header *hdr = addr;
+  while (ddsrt_atomic_ld32 (&hdr->state) != SHM_STATE_READY)
+  {
+    if (dds_time () > tend)
+      goto fail;
+    dds_sleepfor (DDS_MSECS (1));
+  }
+  ddsrt_atomic_fence_acq ();
+  if (hdr->magic != SHM_MAGIC || hdr->version != SHM_VERSION || hdr->size != (uint64_t) st.st_size ||
+      hdr->keylen != keylen || memcmp (hdr->key, key, keylen) != 0)
+  {
+    DDS_ERROR ("psmx_shm: shared memory segment for %.*s exists but is incompatible\n", (int) keylen, key);
+    goto fail;
+  }
+  *size = (size_t) st.st_size;
+  return hdr;
+fail:
+  (void) munmap (addr, (size_t) st.st_size);
+  return NULL;
+}
+
+static struct shm_segment *segment_attach (const struct shm_psmx *psmx, const char *key, size_t keylen, uint32_t slot_size)
+{
+  char name[32];
+  segment_name (name, sizeof (name), key, keylen);
+  const size_t size = segment_size (psmx->nslots, slot_size, psmx->ring_size);
+  // Opening races with the last process detaching (and unlinking) the segment, if it
+  // has been marked dead by the time we try to attach, it is gone and we need to retry
+  for (int attempt = 0; attempt < 100; attempt++)
+  {
+    int fd;
+    if ((fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, 0600)) >= 0)
+    {
+      void *addr;
+      if (ftruncate (fd, (off_t) size) != 0 ||
+          (addr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+      {
+        DDS_ERROR ("psmx_shm: failed to create shared memory segment %s of %zu bytes (%s)\n", name, size, strerror (errno));
+        (void) close (fd);
+        (void) shm_unlink (name);
+        return NULL;
+      }
+      (void) close (fd);
+      struct shm_header *hdr = addr;
+      segment_init (hdr, key, keylen, psmx->nslots, slot_size, psmx->ring_size);
+      assert (hdr->size == size);
+      ddsrt_atomic_st32 (&hdr->refs, 1);
+      ddsrt_atomic_fence_rel ();
+      ddsrt_atomic_st32 (&hdr->state, SHM_STATE_READY);
+      return segment_new (name, hdr, size);
+    }
+    else if (errno != EEXIST)
+    {
+      DDS_ERROR ("psmx_shm: failed to create shared memory segment %s (%s)\n", name, strerror (errno));
+      return NULL;
+    }
+    else if ((fd = shm_open (name, O_RDWR, 0)) < 0)
+    {
+      if (errno == ENOENT)
+        continue;
+      DDS_ERROR ("psmx_shm: failed to open shared memory segment %s (%s)\n", name, strerror (errno));
+      return NULL;
+    }
+    else
+    {
+      size_t existing_size = 0;
+      struct shm_header *hdr = segment_open_existing (fd, key, keylen, &existing_size);
+      (void) close (fd);
+      if (hdr == NULL)
+        return NULL;
+      if (segment_try_attach (hdr))
+        return segment_new (name, hdr, existing_size);
+      (void) munmap (hdr, existing_size);
+      sched_yield ();
+    }
+  }
+  DDS_ERROR ("psmx_shm: failed to attach to shared memory segment %s\n", name);
+  return NULL;
+}
+
+static void segment_detach (struct shm_segment *seg)
+{
+  struct shm_header * const hdr = seg->hdr;
+  uint32_t refs, new_refs;
+  do {
+    refs = ddsrt_atomic_ld32 (&hdr->refs);
+    assert (refs > 0 && !(refs & SHM_REFS_DEAD));
+    new_refs = (refs == 1) ? SHM_REFS_DEAD : refs - 1;
+  } while (!ddsrt_atomic_cas32 (&hdr->refs, refs, new_refs));
+  if (new_refs == SHM_REFS_DEAD)
+    (void) shm_unlink (seg->name);
+  (void) munmap (hdr, seg->size);
+}
+
+static void segment_unref (struct shm_segment *seg)
+{
+  if (ddsrt_atomic_dec32_nv (&seg->refc) == 0)
+  {
+    segment_detach (seg);
+    ddsrt_free (seg);
+  }
+}
+
+static bool reader_register (struct shm_segment *seg, uint32_t *index)
+{
+  struct shm_header * const hdr = seg->hdr;
+  for (uint32_t i = 0; i < SHM_MAX_READERS; i++)
+  {
+    struct shm_reader_entry * const r = &seg->readers[i];
+    if (ddsrt_atomic_ld32 (&r->state) == SHM_READER_ACTIVE && !process_alive (seg, r->pid, r->pidns))
+      (void) ddsrt_atomic_cas32 (&r->state, SHM_READER_ACTIVE, SHM_READER_FREE);
+    if (ddsrt_atomic_cas32 (&r->state, SHM_READER_FREE, SHM_READER_CLAIMED))
+    {
+      // Start at the next sample to be written; should that one be overwritten
+      // before the reader becomes active, the reader will simply skip it.
+      r->pid = (int32_t) getpid ();
+      r->pidns = seg->pidns;
+      ddsrt_atomic_st64 (&r->read_pos, ddsrt_atomic_ld64 (&hdr->write_pos));
+      ddsrt_atomic_fence_rel ();
+      ddsrt_atomic_st32 (&r->state, SHM_READER_ACTIVE);
+      *index = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+static uint32_t writer_register (struct shm_segment *seg)
+{
+  // The table only serves to find out whether the writer that claimed a ring position
+  // is still alive, a writer without an entry works just fine
+  for (uint32_t i = 0; i < SHM_MAX_WRITERS; i++)
+  {
+    struct shm_writer_entry * const w = &seg->writers[i];
+    if (ddsrt_atomic_ld32 (&w->state) == SHM_WRITER_ACTIVE && !process_alive (seg, w->pid, w->pidns))
+      (void) ddsrt_atomic_cas32 (&w->state, SHM_WRITER_ACTIVE, SHM_WRITER_FREE);
+    if (ddsrt_atomic_cas32 (&w->state, SHM_WRITER_FREE, SHM_WRITER_CLAIMED))
+    {
+      w->pid = (int32_t) getpid ();
+      w->pidns = seg->pidns;
+      ddsrt_atomic_st64 (&w->claim, UINT64_MAX);
+      ddsrt_atomic_fence_rel ();
+      ddsrt_atomic_st32 (&w->state, SHM_WRITER_ACTIVE);
+      return i;
+    }
+  }
+  return SHM_NO_WRITER;
+}
+
+static const struct shm_writer_entry *find_claimer (const struct shm_segment *seg, uint64_t pos)
+{
+  for (uint32_t i = 0; i < SHM_MAX_WRITERS; i++)
+  {
+    const struct shm_writer_entry * const w = &seg->writers[i];
+    if (ddsrt_atomic_ld32 (&w->state) == SHM_WRITER_ACTIVE && ddsrt_atomic_ld64 (&w->claim) == pos)
+      return w;
+  }
+  return NULL;
+}
+
+static void wait_for_readers (struct shm_segment *seg, uint64_t pos, dds_duration_t max_blocking_time)
+{
+  // Readers that haven't yet consumed the entry at "pos" will lose it once it is
+  // overwritten, give them a chance to catch up.  A reader that doesn't do so in time,
+  // or that belongs to a process that no longer exists, is moved past it.
+  const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  const ddsrt_mtime_t tend = ddsrt_mtime_add_duration (tnow, max_blocking_time);
+  for (uint32_t i = 0; i < SHM_MAX_READERS; i++)
+  {
+    struct shm_reader_entry * const r = &seg->readers[i];
+    uint64_t rpos;
+    int spins = 0;
+    while (ddsrt_atomic_ld32 (&r->state) == SHM_READER_ACTIVE && (rpos = ddsrt_atomic_ld64 (&r->read_pos)) <= pos)
+    {
+      if (!process_alive (seg, r->pid, r->pidns))
+      {
+        (void) ddsrt_atomic_cas32 (&r->state, SHM_READER_ACTIVE, SHM_READER_FREE);
+        break;
+      }
+      else if (ddsrt_time_monotonic ().v >= tend.v)
+      {
+        (void) ddsrt_atomic_cas64 (&r->read_pos, rpos, pos + 1);
+      }
+      else if (++spins < 100)
+      {
+        sched_yield ();
+      }
+      else
+      {
+        dds_sleepfor (DDS_USECS (100));
+      }
+    }
+  }
+}
+
+static bool entry_has_slot (uint64_t e)
+{
+  // entries that were never written and entries marked lost don't reference a slot
+  return (e >> SHM_SLOT_BITS) != 0 && (e & SHM_SLOT_MASK) != SHM_SLOT_MASK;
+}
+
+static bool wait_for_previous_use (struct shm_segment *seg, uint64_t pos, dds_duration_t max_blocking_time, uint64_t *old_entry)
+{
+  // The writer that claimed the previous use of this entry ("pos - n") may not have filled
+  // it in yet.  That is a very short window, unless that writer is waiting for readers or
+  // its process died.  If it is dead, or if it takes longer than we are willing to block,
+  // the previous use is marked lost.  Likewise, if a later writer gave up waiting for us,
+  // it will have marked our use of the entry as lost and there is nothing left to do.
+  const uint64_t n = seg->hdr->ring_size;
+  ddsrt_atomic_uint64_t * const entry = &seg->ring[pos % n];
+  const uint64_t prev_seq = (pos < n) ? 0 : pos - n + 1;
+  const ddsrt_mtime_t tnow = ddsrt_time_monotonic ();
+  const ddsrt_mtime_t tend = ddsrt_mtime_add_duration (tnow, (max_blocking_time > SHM_MIN_CLAIM_WAIT) ? max_blocking_time : SHM_MIN_CLAIM_WAIT);
+  const ddsrt_mtime_t tend_unknown = ddsrt_mtime_add_duration (tnow, SHM_MIN_CLAIM_WAIT);
+  int spins = 0;
+  while (true)
+  {
+    const uint64_t e = ddsrt_atomic_ld64 (entry);
+    const uint64_t seq = e >> SHM_SLOT_BITS;
+    if (seq > prev_seq)
+      return false;
+    else if (seq == prev_seq)
+    {
+      *old_entry = e;
+      return true;
+    }
+
+    // If the claimer can't be found, it either died before recording its claim, is
+    // just about to record it, or there was no room for it in the table of writers
+    const struct shm_writer_entry * const w = find_claimer (seg, pos - n);
+    const ddsrt_mtime_t tnow1 = ddsrt_time_monotonic ();
+    if ((w && !process_alive (seg, w->pid, w->pidns)) || tnow1.v >= (w ? tend.v : tend_unknown.v))
+    {
+      // Readers skip lost entries; the slot of whatever the entry held before (if any)
+      // is no longer referenced by the ring
+      if (ddsrt_atomic_cas64 (entry, e, (prev_seq << SHM_SLOT_BITS) | SHM_SLOT_MASK) && entry_has_slot (e))
+        slot_unref (seg, (uint32_t) (e & SHM_SLOT_MASK));
+    }
+    else if (++spins < 100)
+    {
+      sched_yield ();
+    }
+    else
+    {
+      dds_sleepfor (DDS_USECS (100));
+    }
+  }
+}
+
+static bool publish (struct shm_psmx_endpoint *ep, uint32_t slot)
+{
+  struct shm_segment * const seg = ep->seg;
+  struct shm_header * const hdr = seg->hdr;
+  const uint64_t n = hdr->ring_size;
+  const uint64_t pos = ddsrt_atomic_add64_ov (&hdr->write_pos, 1);
+  if (ep->writer_index != SHM_NO_WRITER)
+    ddsrt_atomic_st64 (&seg->writers[ep->writer_index].claim, pos);
+  ddsrt_atomic_uint64_t * const entry = &seg->ring[pos % n];
+  const uint64_t new_entry = ((pos + 1) << SHM_SLOT_BITS) | slot;
+  uint64_t old_entry;
+  bool ok = wait_for_previous_use (seg, pos, ep->max_blocking_time, &old_entry);
+  if (ok)
+  {
+    if (pos >= n)
+      wait_for_readers (seg, pos - n, ep->max_blocking_time);
+    ddsrt_atomic_fence_rel ();
+    // Fails if another writer gave up waiting for us while we were waiting for readers
+    ok = ddsrt_atomic_cas64 (entry, old_entry, new_entry);
+  }
+  if (!ok)
+  {
+    // no longer referenced by the loan, nor by the ring
+    slot_unref (seg, slot);
+  }
+  else if (entry_has_slot (old_entry))
+  {
+    // A reader validates the entry after taking a reference to the slot, so the ring's
+    // reference may be dropped as soon as the entry no longer refers to it
+    slot_unref (seg, (uint32_t) (old_entry & SHM_SLOT_MASK));
+  }
+  ddsrt_atomic_inc32 (&hdr->notify);
+  if (ddsrt_atomic_ld32 (&hdr->nwaiters) > 0)
+    futex_wake (&hdr->notify);
+  return ok;
+}
+
+static bool take_slot (struct shm_psmx_endpoint *ep, uint32_t *slot)
+{
+  struct shm_segment * const seg = ep->seg;
+  struct shm_reader_entry * const r = &seg->readers[ep->reader_index];
+  const uint64_t n = seg->hdr->ring_size;
+  while (true)
+  {
+    const uint64_t rpos = ddsrt_atomic_ld64 (&r->read_pos);
+    ddsrt_atomic_uint64_t * const entry = &seg->ring[rpos % n];
+    const uint64_t e = ddsrt_atomic_ld64 (entry);
+    const uint64_t seq = e >> SHM_SLOT_BITS;
+    if (seq < rpos + 1)
+    {
+      // not yet published
+      return false;
+    }
+    else if (seq > rpos + 1)
+    {
+      // overwritten: skip it
+      (void) ddsrt_atomic_cas64 (&r->read_pos, rpos, rpos + 1);
+      continue;
+    }
+    const uint32_t s = (uint32_t) (e & SHM_SLOT_MASK);
+    if (s == SHM_SLOT_MASK)
+    {
+      // lost because the writer died or took too long: skip it
+      (void) ddsrt_atomic_cas64 (&r->read_pos, rpos, rpos + 1);
+      continue;
+    }
+    if (!slot_ref_if_live (seg, s))
+      continue;
+    if (ddsrt_atomic_ld64 (entry) != e || !ddsrt_atomic_cas64 (&r->read_pos, rpos, rpos + 1))
+    {
+      // overwritten or skipped by a writer in the meantime
+      slot_unref (seg, s);
+      continue;
+    }
+    ddsrt_atomic_fence_acq ();
+    *slot = s;
+    return true;
+  }
+}
+
+static bool is_wildcard_partition (const char *str)
+{
+  return strchr (str, '*') || strchr (str, '?');
+}
+
+static bool shm_type_qos_supported (struct dds_psmx *psmx, dds_psmx_endpoint_type_t forwhat, dds_data_type_properties_t data_type_props, const struct dds_qos *qos)
+{
+  const struct shm_psmx *spsmx = (const struct shm_psmx *) psmx;
+  if ((data_type_props & DDS_DATA_TYPE_CONTAINS_KEY) && !spsmx->support_keyed_topics)
+    return false;
+  if (forwhat == DDS_PSMX_ENDPOINT_TYPE_UNSET)
+    return true;
+
+  // No history is kept in the segment, so volatile only
+  dds_durability_kind_t d_kind = DDS_DURABILITY_VOLATILE;
+  if (dds_qget_durability (qos, &d_kind) && d_kind != DDS_DURABILITY_VOLATILE)
+    return false;
+
+  uint32_t n_partitions;
+  char **partitions;
+  if (dds_qget_partition (qos, &n_partitions, &partitions))
+  {
+    bool supported = n_partitions == 0 || (n_partitions == 1 && !is_wildcard_partition (partitions[0]));
+    for (uint32_t n = 0; n < n_partitions; n++)
+      dds_free (partitions[n]);
+    if (n_partitions > 0)
+      dds_free (partitions);
+    if (!supported)
+      return false;
+  }
+
+  dds_ignorelocal_kind_t ignore_local;
+  if (dds_qget_ignorelocal (qos, &ignore_local) && ignore_local != DDS_IGNORELOCAL_NONE)
+    return false;
+  dds_liveliness_kind_t liveliness_kind;
+  if (dds_qget_liveliness (qos, &liveliness_kind, NULL) && liveliness_kind != DDS_LIVELINESS_AUTOMATIC)
+    return false;
+  dds_duration_t deadline_duration;
+  if (dds_qget_deadline (qos, &deadline_duration) && deadline_duration != DDS_INFINITY)
+    return false;
+  return true;
+}
+
+static struct dds_psmx_topic *shm_create_topic (struct dds_psmx *psmx, const char *topic_name, const char *type_name, dds_data_type_properties_t data_type_props, const struct ddsi_type *type_definition, uint32_t sizeof_type)
+{
+  (void) psmx; (void) topic_name; (void) type_name; (void) data_type_props; (void) type_definition;
+  struct shm_psmx_topic *stp = ddsrt_malloc (sizeof (*stp));
+  memset (stp, 0, sizeof (*stp));
+  stp->c.ops = psmx_topic_ops;
+  stp->sizeof_type = sizeof_type;
+  return &stp->c;
+}
+
+static dds_return_t shm_delete_topic (struct dds_psmx_topic *psmx_topic)
+{
+  ddsrt_free (psmx_topic);
+  return DDS_RETCODE_OK;
+}
+
+static void shm_delete_psmx (struct dds_psmx *psmx)
+{
+  ddsrt_free (psmx);
+}
+
+static dds_psmx_node_identifier_t shm_get_node_id (const struct dds_psmx *psmx)
+{
+  return ((const struct shm_psmx *) psmx)->node_id;
+}
+
+static dds_psmx_features_t shm_supported_features (const struct dds_psmx *psmx)
+{
+  (void) psmx;
+  return DDS_PSMX_FEATURE_SHARED_MEMORY | DDS_PSMX_FEATURE_ZERO_COPY;
+}
+
+static size_t append_key_part (char *key, size_t pos, const char *str)
+{
+  // length-prefixed so that no choice of names can result in the same key
+  const size_t len = strlen (str);
+  if (pos < SHM_KEY_MAX)
+  {
+    int n = snprintf (key + pos, SHM_KEY_MAX - pos, "%zu:%s", len, str);
+    pos += (size_t) n;
+  }
+  return pos < SHM_KEY_MAX ? pos : SHM_KEY_MAX - 1;
+}
+
+static struct dds_psmx_endpoint *shm_create_endpoint (struct dds_psmx_topic *psmx_topic, const struct dds_qos *qos, dds_psmx_endpoint_type_t endpoint_type)
+{
+  struct shm_psmx_topic * const stp = (struct shm_psmx_topic *) psmx_topic;
+  struct shm_psmx * const spsmx = (struct shm_psmx *) psmx_topic->psmx_instance;
+  if (endpoint_type != DDS_PSMX_ENDPOINT_TYPE_READER && endpoint_type != DDS_PSMX_ENDPOINT_TYPE_WRITER)
+    return NULL;
+
+  uint32_t n_partitions = 0;
+  char **partitions = NULL;
+  (void) dds_qget_partition (qos, &n_partitions, &partitions);
+  assert (n_partitions == 0 || n_partitions == 1);
+  char key[SHM_KEY_MAX];
+  size_t keylen = 0;
+  keylen = append_key_part (key, keylen, spsmx->c.instance_name ? spsmx->c.instance_name : "");
+  keylen = append_key_part (key, keylen, (n_partitions == 0) ? "" : partitions[0]);
+  keylen = append_key_part (key, keylen, psmx_topic->topic_name);
+  keylen = append_key_part (key, keylen, psmx_topic->type_name);
+  for (uint32_t n = 0; n < n_partitions; n++)
+    dds_free (partitions[n]);
+  if (n_partitions > 0)
+    dds_free (partitions);
+
+  const uint32_t slot_size = (stp->sizeof_type > spsmx->slot_size) ? stp->sizeof_type : spsmx->slot_size;
+  struct shm_segment *seg;
+  if ((seg = segment_attach (spsmx, key, keylen, slot_size)) == NULL)
+    return NULL;
+
+  struct shm_psmx_endpoint *ep = ddsrt_malloc (sizeof (*ep));
+  memset (ep, 0, sizeof (*ep));
+  ep->c.ops = psmx_ep_ops;
+  ep->seg = seg;
+  ep->reader = 0;
+  ddsrt_atomic_st32 (&ep->delivery_stop, 0);
+  if (endpoint_type == DDS_PSMX_ENDPOINT_TYPE_WRITER)
+  {
+    dds_reliability_kind_t kind = DDS_RELIABILITY_RELIABLE;
+    dds_duration_t max_blocking_time = DDS_MSECS (100);
+    (void) dds_qget_reliability (qos, &kind, &max_blocking_time);
+    ep->max_blocking_time = (kind == DDS_RELIABILITY_RELIABLE) ? max_blocking_time : 0;
+    ep->writer_index = writer_register (seg);
+  }
+  else if (!reader_register (seg, &ep->reader_index))
+  {
+    DDS_ERROR ("psmx_shm: too many readers for %s\n", psmx_topic->topic_name);
+    segment_unref (seg);
+    ddsrt_free (ep);
+    return NULL;
+  }
+  return &ep->c;
+}
+
+static dds_return_t shm_delete_endpoint (struct dds_psmx_endpoint *psmx_endpoint)
+{
+  struct shm_psmx_endpoint * const ep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  struct shm_segment * const seg = ep->seg;
+  if (ep->c.endpoint_type == DDS_PSMX_ENDPOINT_TYPE_READER)
+  {
+    if (ep->delivery_running)
+    {
+      ddsrt_atomic_st32 (&ep->delivery_stop, 1);
+      ddsrt_atomic_inc32 (&seg->hdr->notify);
+      futex_wake (&seg->hdr->notify);
+      (void) ddsrt_thread_join (ep->delivery_tid, NULL);
+    }
+    ddsrt_atomic_st32 (&seg->readers[ep->reader_index].state, SHM_READER_FREE);
+  }
+  else if (ep->writer_index != SHM_NO_WRITER)
+  {
+    ddsrt_atomic_st32 (&seg->writers[ep->writer_index].state, SHM_WRITER_FREE);
+  }
+  segment_unref (seg);
+  ddsrt_free (ep);
+  return DDS_RETCODE_OK;
+}
+
+static dds_loaned_sample_t *shm_ep_request_loan (struct dds_psmx_endpoint *psmx_endpoint, uint32_t size_requested)
+{
+  struct shm_psmx_endpoint * const ep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  struct shm_segment * const seg = ep->seg;
+  uint32_t slot;
+  if (size_requested > seg->hdr->slot_size || !slot_alloc (seg, &slot))
+    return NULL;
+  struct shm_loan *loan = ddsrt_malloc (sizeof (*loan));
+  loan->c.ops = loan_ops;
+  loan->c.metadata = &slot_ptr (seg, slot)->metadata;
+  loan->c.sample_ptr = slot_data (seg, slot);
+  loan->seg = seg;
+  loan->slot = slot;
+  ddsrt_atomic_inc32 (&seg->refc);
+  return &loan->c;
+}
+
+static dds_return_t shm_ep_write_with_key (struct dds_psmx_endpoint *psmx_endpoint, dds_loaned_sample_t *data, size_t keysz, const void *key)
+{
+  // Every reader of the segment gets all samples, so the key is not needed
+  (void) keysz; (void) key;
+  struct shm_psmx_endpoint * const ep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  struct shm_loan * const loan = (struct shm_loan *) data;
+  assert (loan->seg == ep->seg && loan->slot != SHM_NO_SLOT);
+  // The loan's reference to the slot is transferred to the ring
+  const bool ok = publish (ep, loan->slot);
+  loan->slot = SHM_NO_SLOT;
+  data->metadata = NULL;
+  data->sample_ptr = NULL;
+  return ok ? DDS_RETCODE_OK : DDS_RETCODE_TIMEOUT;
+}
+
+static dds_loaned_sample_t *shm_ep_take (struct dds_psmx_endpoint *psmx_endpoint)
+{
+  struct shm_psmx_endpoint * const ep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  struct shm_segment * const seg = ep->seg;
+  uint32_t slot;
+  if (ep->c.endpoint_type != DDS_PSMX_ENDPOINT_TYPE_READER || !take_slot (ep, &slot))
+    return NULL;
+  struct shm_loan *loan = ddsrt_malloc (sizeof (*loan));
+  loan->c.ops = loan_ops;
+  loan->c.loan_origin.origin_kind = DDS_LOAN_ORIGIN_KIND_PSMX;
+  loan->c.loan_origin.psmx_endpoint = psmx_endpoint;
+  loan->metadata = slot_ptr (seg, slot)->metadata;
+  loan->c.metadata = &loan->metadata;
+  loan->c.sample_ptr = slot_data (seg, slot);
+  ddsrt_atomic_st32 (&loan->c.refc, 1);
+  loan->seg = seg;
+  loan->slot = slot;
+  ddsrt_atomic_inc32 (&seg->refc);
+  return &loan->c;
+}
+
+static uint32_t take_batch (struct dds_psmx_endpoint *psmx_endpoint, uint32_t max_samples, dds_loaned_sample_t **samples)
+{
+  uint32_t n = 0;
+  while (n < max_samples && (samples[n] = shm_ep_take (psmx_endpoint)) != NULL)
+    n++;
+  return n;
+}
+
+static void shm_loan_free (struct dds_loaned_sample *loaned_sample)
+{
+  struct shm_loan * const loan = (struct shm_loan *) loaned_sample;
+  if (loan->slot != SHM_NO_SLOT)
+    slot_unref (loan->seg, loan->slot);
+  segment_unref (loan->seg);
+  ddsrt_free (loan);
+}
+
+static uint32_t delivery_thread (void *varg)
+{
+  struct shm_psmx_endpoint * const ep = varg;
+  struct shm_header * const hdr = ep->seg->hdr;
+  while (!ddsrt_atomic_ld32 (&ep->delivery_stop))
+  {
+    const uint32_t notify = ddsrt_atomic_ld32 (&hdr->notify);
+    dds_loaned_sample_t *ls[SHM_DELIVERY_BATCH];
+    uint32_t n;
+    while ((n = take_batch (&ep->c, SHM_DELIVERY_BATCH, ls)) > 0)
+    {
+      (void) dds_reader_store_loaned_samples (ep->reader, n, ls);
+      for (uint32_t i = 0; i < n; i++)
+        dds_loaned_sample_unref (ls[i]);
+    }
+    // a writer bumps "notify" before checking "nwaiters", so either it sees us
+    // waiting or we see a different value of "notify"
+    ddsrt_atomic_inc32 (&hdr->nwaiters);
+    if (!ddsrt_atomic_ld32 (&ep->delivery_stop))
+      futex_wait (&hdr->notify, notify, DDS_SECS (1));
+    ddsrt_atomic_dec32 (&hdr->nwaiters);
+  }
+  return 0;
+}
+
+static dds_return_t shm_ep_on_data_available (struct dds_psmx_endpoint *psmx_endpoint, dds_entity_t reader)
+{
+  struct shm_psmx_endpoint * const ep = (struct shm_psmx_endpoint *) psmx_endpoint;
+  if (ep->c.endpoint_type != DDS_PSMX_ENDPOINT_TYPE_READER || ep->delivery_running)
+    return DDS_RETCODE_BAD_PARAMETER;
+  ep->reader = reader;
+  ddsrt_threadattr_t tattr;
+  ddsrt_threadattr_init (&tattr);
+  if (ddsrt_thread_create (&ep->delivery_tid, "psmx_shm_rd", &tattr, delivery_thread, ep) != DDS_RETCODE_OK)
+    return DDS_RETCODE_ERROR;
+  ep->delivery_running = true;
+  return DDS_RETCODE_OK;
+}
+
+static bool parse_node_id (const char *str, dds_psmx_node_identifier_t *id)
+{
+  if (strlen (str) != 2 * sizeof (id->x))
+    return false;
+  for (size_t n = 0; n < sizeof (id->x); n++)
+  {
+    const int32_t hi = ddsrt_todigit (str[2 * n]), lo = ddsrt_todigit (str[2 * n + 1]);
+    if (hi < 0 || hi > 15 || lo < 0 || lo > 15)
+      return false;
+    id->x[n] = (uint8_t) ((hi << 4) | lo);
+  }
+  return true;
+}
+
+static bool get_machine_id (dds_psmx_node_identifier_t *id)
+{
+  char buf[64];
+  bool ok = false;
+  FILE *fp;
+  if ((fp = fopen ("/etc/machine-id", "r")) != NULL)
+  {
+    if (fgets (buf, sizeof (buf), fp) != NULL)
+    {
+      buf[strcspn (buf, "\r\n")] = 0;
+      ok = parse_node_id (buf, id);
+    }
+    fclose (fp);
+  }
+  if (!ok)
+  {
+    // fall back to a hash of the host name
+    char hostname[256];
+    if (ddsrt_gethostname (hostname, sizeof (hostname)) != DDS_RETCODE_OK)
+      return false;
+    for (uint32_t n = 0; n < sizeof (id->x) / 4; n++)
+    {
+      const uint32_t h = ddsrt_mh3 (hostname, strlen (hostname), n);
+      memcpy (id->x + 4 * n, &h, 4);
+    }
+    ok = true;
+  }
+  return ok;
+}
+
+static bool get_config_uint32 (const char *config, const char *option_name, uint32_t min, uint32_t max, uint32_t *value)
+{
+  char *str = dds_psmx_get_config_option_value (config, option_name);
+  if (str == NULL)
+    return true;
+  char *end;
+  unsigned long long v;
+  const bool ok = (ddsrt_strtoull (str, &end, 0, &v) == DDS_RETCODE_OK && *end == 0 && v >= min && v <= max);
+  if (ok)
+    *value = (uint32_t) v;
+  else
+    DDS_ERROR ("psmx_shm: invalid value for %s: %s\n", option_name, str);
+  ddsrt_free (str);
+  return ok;
+}
+
+dds_return_t shm_create_psmx (struct dds_psmx **psmx, dds_psmx_instance_id_t instance_id, const char *config)
+{
+  (void) instance_id;
+  assert (psmx);
+
+  dds_psmx_node_identifier_t node_id;
+  char *locator = dds_psmx_get_config_option_value (config, "LOCATOR");
+  const bool have_node_id = locator ? parse_node_id (locator, &node_id) : get_machine_id (&node_id);
+  if (!have_node_id)
+  {
+    DDS_ERROR ("psmx_shm: invalid LOCATOR or unable to determine machine id\n");
+    ddsrt_free (locator);
+    return DDS_RETCODE_ERROR;
+  }
+  ddsrt_free (locator);
+
+  bool keyed_topics = true;
+  char *keyed_topics_str = dds_psmx_get_config_option_value (config, "KEYED_TOPICS");
+  if (keyed_topics_str)
+  {
+    keyed_topics = (ddsrt_strcasecmp (keyed_topics_str, "false") != 0);
+    ddsrt_free (keyed_topics_str);
+  }
+
+  uint32_t slot_size = SHM_DEFAULT_SLOT_SIZE, nslots = SHM_DEFAULT_NSLOTS, ring_size = SHM_DEFAULT_RING_SIZE;
+  // the ring holds on to "ring_size" slots, at least as many are needed for loans
+  if (!get_config_uint32 (config, "SLOT_SIZE", 1, INT32_MAX, &slot_size) ||
+      !get_config_uint32 (config, "NSLOTS", 2, SHM_MAX_SLOTS, &nslots) ||
+      !get_config_uint32 (config, "RING_SIZE", 1, SHM_MAX_SLOTS, &ring_size))
+    return DDS_RETCODE_BAD_PARAMETER;
+  if (ring_size >= nslots)
+  {
+    DDS_ERROR ("psmx_shm: RING_SIZE (%"PRIu32") must be less than NSLOTS (%"PRIu32")\n", ring_size, nslots);
+    return DDS_RETCODE_BAD_PARAMETER;
+  }
+
+  struct shm_psmx *spsmx = ddsrt_malloc (sizeof (*spsmx));
+  memset (spsmx, 0, sizeof (*spsmx));
+  spsmx->c.ops = psmx_ops;
+  spsmx->node_id = node_id;
+  spsmx->support_keyed_topics = keyed_topics;
+  spsmx->slot_size = slot_size;
+  spsmx->nslots = nslots;
+  spsmx->ring_size = ring_size;
+  *psmx = &spsmx->c;
+  return DDS_RETCODE_OK;
+}
@@ -12,6 +12,7 @@
 #include <assert.h>
 
 #include "dds/dds.h"
+#include "dds/ddsc/dds_statistics.h"
 #include "CUnit/Test.h"
 #include "CUnit/Theory.h"
 
@@ -61,6 +62,9 @@ static const char *config =
     "      <Library finalizeFunction=\"finalize_test_cryptography_wrapped\" initFunction=\"init_test_cryptography_wrapped\" path=\"" WRAPPERLIB_PATH("dds_security_cryptography_wrapper") "\"/>"
     "    </Cryptographic>"
     "  </Security>"
+    "  <Internal>"
+    "    <SecureReceiveThreads>${SECURE_RECV_THREADS}</SecureReceiveThreads>"
+    "  </Internal>"
     "</Domain>";
 
 #define DDS_DOMAINID_PUB 0
@@ -89,6 +93,7 @@ struct domain_sec_config {
   const char * pp_userdata_secret;
   const char * groupdata_secret;
   const char * ep_userdata_secret;
+  uint32_t secure_recv_threads;
 };
 
 typedef void (*set_crypto_params_fn)(struct dds_security_cryptography_impl *, const struct domain_sec_config *);
@@ -155,8 +160,12 @@ static void test_init(const struct domain_sec_config * domain_config, size_t n_s
   char * gov_topic_rule = get_governance_topic_rule ("*", true, true, true, true, domain_config->metadata_pk, domain_config->payload_pk);
   char * gov_config_signed = get_governance_config (false, true, domain_config->discovery_pk, domain_config->liveliness_pk, domain_config->rtps_pk, gov_topic_rule, false);
 
+  char secure_recv_threads[16];
+  (void) snprintf (secure_recv_threads, sizeof (secure_recv_threads), "%"PRIu32, domain_config->secure_recv_threads);
+
   struct kvp config_vars[] = {
     { "GOVERNANCE_DATA", gov_config_signed, 1 },
+    { "SECURE_RECV_THREADS", secure_recv_threads, 1 },
     { NULL, NULL, 0 }
   };
 
@@ -288,6 +297,23 @@ static void test_write_read(struct domain_sec_config *domain_config,
     }
   }
 
+  /* With RTPS protection and secure receive workers, all protected messages
+     go through the workers */
+  if (domain_config->secure_recv_threads > 0 && domain_config->rtps_pk != PK_N)
+  {
+    for (size_t d = 0; d < n_sub_domains; d++)
+    {
+      struct dds_statistics *stats = dds_create_statistics (g_sub_domains[d]);
+      CU_ASSERT_FATAL (stats != NULL);
+      const struct dds_stat_keyvalue *packets = dds_lookup_statistic (stats, "secrecv_packets");
+      const struct dds_stat_keyvalue *bytes = dds_lookup_statistic (stats, "secrecv_bytes");
+      CU_ASSERT_FATAL (packets != NULL && bytes != NULL);
+      CU_ASSERT (packets->u.u64 > 0);
+      CU_ASSERT (bytes->u.u64 > packets->u.u64);
+      dds_delete_statistics (stats);
+    }
+  }
+
   /* Cleanup */
   dds_delete_qos (qos);
   test_fini (n_sub_domains, n_pub_domains);
@@ -326,6 +352,12 @@ static void test_data_protection_kind(DDS_Security_ProtectionKind rtps_pk, DDS_S
   test_write_read (&domain_config, 1, 1, 1, 1, 1, 1, set_encryption_parameters_basic);
 }
 
+static void test_secure_recv_threads(uint32_t n_threads, size_t n_dom, DDS_Security_ProtectionKind rtps_pk, DDS_Security_ProtectionKind metadata_pk)
+{
+  struct domain_sec_config domain_config = { PK_N, PK_N, rtps_pk, metadata_pk, BPK_N, NULL, NULL, NULL, NULL, n_threads };
+  test_write_read (&domain_config, n_dom, 1, 1, n_dom, 1, 2, set_encryption_parameters_basic);
+}
+
 static void test_multiple_readers(size_t n_dom, size_t n_pp, size_t n_rd, DDS_Security_ProtectionKind metadata_pk, DDS_Security_BasicProtectionKind payload_pk)
 {
   struct domain_sec_config domain_config = { PK_N, PK_N, PK_N, metadata_pk, payload_pk, NULL };
@@ -420,6 +452,21 @@ CU_Test(ddssec_secure_communication, discovery_liveliness_protection, .timeout =
   }
 }
 
+/* Test communication with RTPS message protection when decoding of protected
+   messages is offloaded to secure receive worker threads */
+CU_Test(ddssec_secure_communication, secure_recv_threads, .timeout = 60)
+{
+  DDS_Security_ProtectionKind rtps_pk[] = { PK_S, PK_E };
+  uint32_t n_threads[] = { 1, 3 };
+  for (size_t rtps = 0; rtps < sizeof (rtps_pk) / sizeof (rtps_pk[0]); rtps++)
+  {
+    for (size_t t = 0; t < sizeof (n_threads) / sizeof (n_threads[0]); t++)
+    {
+      test_secure_recv_threads (n_threads[t], 2, rtps_pk[rtps], PK_E);
+    }
+  }
+}
+
 /* Test that a specific character sequence from the plain data does not appear in
    encrypted payload, submessage or rtps message when protection kind is ENCRYPT*/
 CU_Test(ddssec_secure_communication, check_encrypted_secret, .timeout = 60)
@@ -47,6 +47,8 @@ void gendef_pf_boolean_default (FILE *fp, void *parent, struct cfgelem const * c
 void gendef_pf_besmode (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_protocol_version (FILE *out, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_retransmit_merging (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
+void gendef_pf_tcp_sendq_policy (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
+void gendef_pf_trace_format (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_sched_class (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_entity_naming_mode (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
 void gendef_pf_random_seed (FILE *fp, void *parent, struct cfgelem const * const cfgelem);
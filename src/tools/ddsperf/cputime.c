@@ -113,7 +113,25 @@ static bool above_threshold (double *max, double *du_skip, double *ds_skip, doub
   }
 }
 
-bool record_cputime (struct record_cputime_state *state, const char *prefix, dds_time_t tnow)
+static void output_cputime (struct output *out, const struct CPUStats *s)
+{
+  output_begin (out, "cpu", NULL);
+  output_double (out, "rss", s->maxrss);
+  output_uint (out, "vcsw", s->vcsw);
+  output_uint (out, "ivcsw", s->ivcsw);
+  for (uint32_t i = 0; i < s->cpu._length; i++)
+  {
+    const struct CPUStatThread * const thr = &s->cpu._buffer[i];
+    char key[64];
+    snprintf (key, sizeof (key), "%s.user", thr->name);
+    output_uint (out, key, (uint64_t) thr->u_pct);
+    snprintf (key, sizeof (key), "%s.sys", thr->name);
+    output_uint (out, key, (uint64_t) thr->s_pct);
+  }
+  output_end (out);
+}
+
+bool record_cputime (struct record_cputime_state *state, const char *prefix, dds_time_t tnow, struct output *out)
 {
   if (state == NULL)
     return false;
@@ -180,6 +198,8 @@ bool record_cputime (struct record_cputime_state *state, const char *prefix, dds
   state->tprev = tnow;
   state->s.some_above = some_above;
   (void) dds_write (state->wr, &state->s);
+  if (out)
+    output_cputime (out, &state->s);
   return print_cputime (&state->s, prefix, false, true);
 }
 
@@ -259,11 +279,12 @@ void record_cputime_free (struct record_cputime_state *state)
 
 #else
 
-bool record_cputime (struct record_cputime_state *state, const char *prefix, dds_time_t tnow)
+bool record_cputime (struct record_cputime_state *state, const char *prefix, dds_time_t tnow, struct output *out)
 {
   (void) state;
   (void) prefix;
   (void) tnow;
+  (void) out;
   return false;
 }
 
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+#
+# Copyright(c) 2024 ZettaScale Technology and others
+#
+# This program and the accompanying materials are made available under the
+# terms of the Eclipse Public License v. 2.0 which is available at
+# http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+# v. 1.0 which is available at
+# http://www.eclipse.org/org/documents/edl-v10.php.
+#
+# SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+#
+"""Compare two sets of ddsperf runs recorded with "-O json:FILE".
+
+Each side can consist of several files (e.g., the publishing and the
+subscribing process, or repeated runs); their records are merged. Latency
+histograms are merged by adding bucket counts, rates and CPU figures are
+averaged over the reporting intervals.
+
+A metric is flagged as a regression if it got worse by more than the
+threshold and, for metrics with a value per interval, the difference is
+also large compared to the interval-to-interval variation. The exit status
+is 1 if any regression is flagged, 0 otherwise.
+"""
+
+import argparse
+import json
+import math
+import sys
+from collections import defaultdict
+
+LATENCY_RECORDS = ("sublat", "roundtrip", "scale")
+PERCENTILES = (50, 90, 99, 99.9)
+
+
+class Run:
+    def __init__(self):
+        self.hists = defaultdict(lambda: defaultdict(int))  # record -> ub -> count
+        self.series = defaultdict(list)  # metric -> per-interval values
+        self.scalars = {}  # metric -> single value
+
+    def add_hist(self, record, buckets):
+        h = self.hists[record]
+        for ub, cnt in buckets:
+            h[ub] += cnt
+
+    def load(self, path, warmup):
+        # intervals of different processes at the same time are summed first
+        per_time = defaultdict(lambda: defaultdict(float))
+        with open(path) as f:
+            for lineno, line in enumerate(f, 1):
+                line = line.strip()
+                if not line:
+                    continue
+                try:
+                    r = json.loads(line)
+                except json.JSONDecodeError as e:
+                    sys.exit(f"{path}:{lineno}: {e}")
+                rec = r["record"]
+                if rec == "scale_discovery":
+                    self.scalars["scale discovery time [s]"] = r["match_s"]
+                    continue
+                if rec == "scale_summary":
+                    continue
+                if r["time"] < warmup:
+                    continue
+                t = (path, round(r["time"]))
+                if rec in ("sublat", "roundtrip"):
+                    self.add_hist(rec, r["hdr"])
+                elif rec == "scale":
+                    self.add_hist(rec, r["latency"])
+                    per_time["scale written [S/s]"][t] += r["written"]
+                    per_time["scale received [S/s]"][t] += r["received"]
+                    per_time["scale late writes [/s]"][t] += r["late"]
+                    self.series["scale cpu per sample [us]"].append(r["cpu_per_sample_us"])
+                elif rec == "pub":
+                    per_time["pub rate [S/s]"][t] += r["rate"]
+                elif rec == "sub":
+                    per_time["sub rate [S/s]"][t] += r["rate"]
+                    per_time["sub lost [/s]"][t] += r["lost"]
+                elif rec == "cpu":
+                    cpu = sum(v for k, v in r.items() if k.endswith(".user") or k.endswith(".sys"))
+                    per_time["cpu [%]"][t] += cpu
+                    per_time["rss [MB]"][t] += r["rss"] / 1048576.0
+                elif rec == "netload":
+                    per_time["net xmit [Mb/s]"][t] += r["xmit_bps"] / 1e6
+                    per_time["net recv [Mb/s]"][t] += r["recv_bps"] / 1e6
+                elif rec == "extended":
+                    per_time["rexmit bytes"][t] = r["rexmit_bytes"]
+        for metric, values in per_time.items():
+            self.series[metric].extend(values.values())
+
+
+def hist_percentile(hist, pct):
+    n = sum(hist.values())
+    if n == 0:
+        return None
+    rank = math.ceil(n * pct / 100.0)
+    cum = 0
+    for ub in sorted(hist):
+        cum += hist[ub]
+        if cum >= rank:
+            return ub
+    return max(hist)
+
+
+def mean_stderr(values):
+    n = len(values)
+    if n == 0:
+        return None, None
+    m = sum(values) / n
+    if n < 2:
+        return m, 0.0
+    var = sum((x - m) ** 2 for x in values) / (n - 1)
+    return m, math.sqrt(var / n)
+
+
+# metrics where a larger value is better, everything else is a cost
+HIGHER_IS_BETTER = ("pub rate [S/s]", "sub rate [S/s]", "scale written [S/s]", "scale received [S/s]")
+# counters that are not interesting as regressions: they follow the configured load
+INFORMATIONAL = ("net xmit [Mb/s]", "net recv [Mb/s]", "rexmit bytes")
+
+
+def compare(base, new, threshold, sigma):
+    rows = []
+
+    def add(metric, b, n, significant, unit_scale=1.0):
+        if b is None or n is None:
+            return
+        b *= unit_scale
+        n *= unit_scale
+        if b == 0:
+            rel = 0.0 if n == 0 else math.inf
+        else:
+            rel = (n - b) / abs(b) * 100.0
+        worse = -rel if metric in HIGHER_IS_BETTER else rel
+        flag = ""
+        if metric not in INFORMATIONAL and significant and worse > threshold:
+            flag = "REGRESSION"
+        elif metric not in INFORMATIONAL and significant and -worse > threshold:
+            flag = "improved"
+        rows.append((metric, b, n, rel, flag))
+
+    for rec in LATENCY_RECORDS:
+        hb, hn = base.hists.get(rec), new.hists.get(rec)
+        if not hb or not hn:
+            continue
+        for pct in PERCENTILES:
+            # the histogram resolution is 1/16th, so smaller differences are noise
+            add(f"{rec} latency p{pct} [us]", hist_percentile(hb, pct), hist_percentile(hn, pct), True, 1e-3)
+        add(f"{rec} latency max [us]", max(hb), max(hn), True, 1e-3)
+
+    for metric in sorted(set(base.series) | set(new.series)):
+        mb, sb = mean_stderr(base.series.get(metric, []))
+        mn, sn = mean_stderr(new.series.get(metric, []))
+        if mb is None or mn is None:
+            continue
+        significant = abs(mn - mb) > sigma * math.sqrt(sb * sb + sn * sn)
+        add(metric, mb, mn, significant)
+
+    for metric in sorted(set(base.scalars) & set(new.scalars)):
+        add(metric, base.scalars[metric], new.scalars[metric], True)
+    return rows
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("-b", "--base", action="append", required=True, metavar="FILE", help="baseline run (repeatable)")
+    ap.add_argument("-n", "--new", action="append", required=True, metavar="FILE", help="new run (repeatable)")
+    ap.add_argument("-t", "--threshold", type=float, default=10.0, metavar="PCT", help="relative change considered significant (default 10%%)")
+    ap.add_argument("-s", "--sigma", type=float, default=2.0, help="required difference in standard errors for per-interval metrics (default 2)")
+    ap.add_argument("-w", "--warmup", type=float, default=2.0, metavar="SEC", help="ignore intervals in the first SEC seconds (default 2)")
+    args = ap.parse_args()
+
+    base, new = Run(), Run()
+    for f in args.base:
+        base.load(f, args.warmup)
+    for f in args.new:
+        new.load(f, args.warmup)
+
+    rows = compare(base, new, args.threshold, args.sigma)
+    if not rows:
+        sys.exit("no common metrics found")
+    width = max(len(r[0]) for r in rows)
+    print(f"{'metric':<{width}} {'base':>12} {'new':>12} {'change':>9}")
+    regressions = 0
+    for metric, b, n, rel, flag in rows:
+        print(f"{metric:<{width}} {b:12.4g} {n:12.4g} {rel:+8.1f}% {flag}")
+        if flag == "REGRESSION":
+            regressions += 1
+    if regressions:
+        print(f"{regressions} regression(s) beyond {args.threshold:g}%")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -24,6 +24,7 @@
 
 #include "dds/dds.h"
 #include "dds/ddsc/dds_statistics.h"
+#include "dds/ddsi/ddsi_lathist.h"
 #include "ddsperf_types.h"
 #include "async_listener.h"
 
@@ -40,6 +41,8 @@
 
 #include "cputime.h"
 #include "netload.h"
+#include "scale.h"
+#include "output.h"
 
 #if !defined(_WIN32) && !defined(LWIP_SOCKET)
 #include <errno.h>
@@ -86,7 +89,7 @@ static dds_entity_t rd_participants, rd_subscriptions, rd_publications;
 /* Topics, readers, writers (except for pong writers: there are
    many of those) */
 static dds_entity_t tp_data, tp_ping, tp_pong, tp_stat;
-static char tpname_data[32], tpname_ping[32], tpname_pong[32];
+static char tpname_data[32], tpname_ping[32], tpname_pong[32], tpname_scale[32];
 static dds_entity_t sub, pub, wr_data, wr_ping, wr_stat, rd_data, rd_ping, rd_pong, rd_stat;
 
 /* Number of different key values to use (must be 1 for OU type) */
@@ -102,7 +105,8 @@ static enum submode pingpongmode = SM_LISTENER;
 /* Whether to show "sub" stats every second even when nothing happens */
 static bool substat_every_second = false;
 
-/* Whether to show extended statistics (currently just rexmit info) */
+/* Whether to show extended statistics (rexmit info and, if enabled in the
+   configuration, the stage latency breakdown) */
 static bool extended_stats = false;
 
 /* Size of the sequence in KeyedSeq type in bytes */
@@ -191,6 +195,17 @@ static bool sublatency = false;
 /* Use writer loans (only for memcpy-able types) */
 static bool use_writer_loan = false;
 
+/* Write each burst using a single call to dds_write_n */
+static bool use_write_n = false;
+
+/* Scaling mode: many topics with many writers and readers each */
+static bool scale_mode = false;
+static struct scale_params scale_params;
+static struct scale_state *scale;
+
+/* Machine-readable output (-O), if any */
+static struct output *machine_output;
+
 /* Event queue for processing discovery events (data available on
    DCPSParticipant, subscription & publication matched)
    asynchronously to avoid deadlocking on creating a reader from
@@ -219,6 +234,7 @@ struct latencystat {
   uint32_t cnt;
   uint64_t totcnt;
   int64_t *raw;
+  struct ddsi_lathist hdr; /* all samples in the interval, for machine-readable output */
 };
 
 /* Subscriber statistics for tracking number of samples received
@@ -528,6 +544,22 @@ static void hist_record (struct hist *h, uint64_t x, unsigned weight)
     h->bins[(x - h->bin0) / h->binwidth] += weight;
 }
 
+static void hist_output (struct output *out, const struct hist *h, dds_time_t dt)
+{
+  uint64_t cnt = h->under + h->over;
+  for (unsigned i = 0; i < h->nbins; i++)
+    cnt += h->bins[i];
+  output_begin (out, "pub", NULL);
+  output_uint (out, "written", cnt);
+  output_double (out, "rate", (double) cnt / ((double) dt / 1e9));
+  if (cnt > 0)
+  {
+    output_uint (out, "write_min", h->min);
+    output_uint (out, "write_max", h->max);
+  }
+  output_end (out);
+}
+
 static void xsnprintf(char *buf, size_t bufsz, size_t *p, const char *fmt, ...) ddsrt_attribute_format_printf(4, 5);
 
 static void xsnprintf(char *buf, size_t bufsz, size_t *p, const char *fmt, ...)
@@ -695,6 +727,88 @@ static void *init_sample (union data *data, uint32_t seq)
   return baggage;
 }
 
+static void pubthread_write_n (const union data *data, size_t seqoff, size_t keyvaloff)
+{
+  // Each burst is written in a single call, with copies of the template sample that
+  // differ in sequence number and key value only.  The lsb of the timestamp is always
+  // 0 because pings aren't supported in this mode.
+  union data *samples = malloc (burstsize * sizeof (*samples));
+  void **ptrs = malloc (burstsize * sizeof (*ptrs));
+  uint32_t seq = *((uint32_t *) ((char *) data + seqoff));
+  uint32_t keyval = 0;
+  dds_time_t ntot = 0;
+  const dds_time_t tfirst = dds_time ();
+  assert (samples && ptrs);
+  while (!ddsrt_atomic_ld32 (&termflag))
+  {
+    for (uint32_t i = 0; i < burstsize; i++)
+    {
+      void *dataptr;
+      dds_return_t result;
+      if (!use_writer_loan)
+      {
+        samples[i] = *data;
+        dataptr = &samples[i];
+      }
+      else if ((result = dds_request_loan (wr_data, &dataptr)) < 0)
+      {
+        printf ("request loan error: %d\n", result);
+        fflush (stdout);
+        exit (2);
+      }
+      *((uint32_t *) ((char *) dataptr + seqoff)) = seq++;
+      if (keyvaloff != SIZE_MAX)
+      {
+        *((uint32_t *) ((char *) dataptr + keyvaloff)) = keyval;
+        keyval = (keyval + 1) % nkeyvals;
+      }
+      ptrs[i] = dataptr;
+    }
+
+    const dds_time_t t_write = dds_time ();
+    const dds_return_t result = dds_write_n_ts (wr_data, (const void * const *) ptrs, burstsize, t_write & ~1);
+    // the sample that failed took over its loan like a successful write, the ones
+    // following it were never written and their loans still have to be returned
+    const uint32_t nused = (result < 0) ? 1 : ((uint32_t) result < burstsize) ? (uint32_t) result + 1 : burstsize;
+    if (use_writer_loan && nused < burstsize)
+    {
+      dds_return_t rc;
+      if ((rc = dds_return_loan (wr_data, &ptrs[nused], (int32_t) (burstsize - nused))) != DDS_RETCODE_OK)
+      {
+        printf ("return loan error: %d\n", (int) rc);
+        fflush (stdout);
+        exit (2);
+      }
+    }
+    if (result < 0)
+    {
+      printf ("write error: %d\n", (int) result);
+      fflush (stdout);
+      if (result != DDS_RETCODE_TIMEOUT)
+        exit (2);
+      continue;
+    }
+    const dds_time_t t_post_write = dds_time ();
+    ddsrt_mutex_lock (&pubstat_lock);
+    hist_record (pubstat_hist, (uint64_t) (t_post_write - t_write) / (uint64_t) result, (unsigned) result);
+    ntot += result;
+    ddsrt_mutex_unlock (&pubstat_lock);
+
+    if (pub_rate < HUGE_VAL)
+    {
+      dds_time_t t = t_post_write;
+      while (((double) (ntot / burstsize) / ((double) (t - tfirst) / 1e9 + 5e-3)) > pub_rate && !ddsrt_atomic_ld32 (&termflag))
+      {
+        dds_write_flush (wr_data);
+        dds_sleepfor (DDS_MSECS (1));
+        t = dds_time ();
+      }
+    }
+  }
+  free (ptrs);
+  free (samples);
+}
+
 static uint32_t pubthread (void *varg)
 {
   int result;
@@ -733,6 +847,15 @@ static uint32_t pubthread (void *varg)
     }
   }
 
+  if (use_write_n)
+  {
+    pubthread_write_n (&data, seqoff, keyvaloff);
+    if (baggage)
+      free (baggage);
+    free (ihs);
+    return 0;
+  }
+
   uint32_t time_interval = 1; // call dds_time() once for this many samples
   uint32_t time_counter = time_interval; // how many more samples on current time stamp
   uint32_t batch_counter = 0; // number of samples in current batch
@@ -850,6 +973,12 @@ static uint32_t topic_payload_size (enum topicsel tp, uint32_t bgsize)
   return size;
 }
 
+static void lathist_clear (struct ddsi_lathist *h)
+{
+  for (uint32_t i = 0; i < DDSI_LATHIST_NBUCKETS; i++)
+    ddsrt_atomic_st32 (&h->bucket[i], 0);
+}
+
 static void latencystat_init (struct latencystat *x)
 {
   x->min = INT64_MAX;
@@ -857,6 +986,7 @@ static void latencystat_init (struct latencystat *x)
   x->sum = x->cnt = 0;
   x->raw = malloc (PINGPONG_RAWSIZE * sizeof (*x->raw));
   assert(x->raw);
+  lathist_clear (&x->hdr);
 }
 
 static void latencystat_fini (struct latencystat *x)
@@ -870,6 +1000,7 @@ static void latencystat_reset (struct latencystat *x, int64_t *newraw)
   x->min = INT64_MAX;
   x->max = INT64_MIN;
   x->sum = x->cnt = 0;
+  lathist_clear (&x->hdr);
 }
 
 static int cmp_int64 (const void *va, const void *vb)
@@ -879,7 +1010,23 @@ static int cmp_int64 (const void *va, const void *vb)
   return (*a == *b) ? 0 : (*a < *b) ? -1 : 1;
 }
 
-static int64_t *latencystat_print (struct latencystat *y, const char *prefix, const char *subprefix, dds_instance_handle_t pubhandle, dds_instance_handle_t pphandle, uint32_t size)
+static void latencystat_output (struct latencystat *y, const char *record, const char *ppinfo, uint32_t size, uint32_t rawcnt)
+{
+  struct output * const out = machine_output;
+  output_begin (out, record, ppinfo);
+  output_uint (out, "size", size);
+  output_uint (out, "count", y->cnt);
+  output_double (out, "mean", (double) y->sum / (double) y->cnt);
+  output_uint (out, "min", (uint64_t) y->min);
+  output_uint (out, "p50", (uint64_t) y->raw[rawcnt - (rawcnt + 1) / 2]);
+  output_uint (out, "p90", (uint64_t) y->raw[rawcnt - (rawcnt + 9) / 10]);
+  output_uint (out, "p99", (uint64_t) y->raw[rawcnt - (rawcnt + 99) / 100]);
+  output_uint (out, "max", (uint64_t) y->max);
+  output_lathist (out, "hdr", &y->hdr);
+  output_end (out);
+}
+
+static int64_t *latencystat_print (struct latencystat *y, const char *prefix, const char *subprefix, const char *record, dds_instance_handle_t pubhandle, dds_instance_handle_t pphandle, uint32_t size)
 {
   if (y->cnt > 0)
   {
@@ -903,6 +1050,8 @@ static int64_t *latencystat_print (struct latencystat *y, const char *prefix, co
             (double) y->raw[rawcnt - (rawcnt + 99) / 100] / 1e3,
             (double) y->max / 1e3,
             y->cnt);
+    if (machine_output)
+      latencystat_output (y, record, ppinfo, size, rawcnt);
   }
   return y->raw;
 }
@@ -912,6 +1061,7 @@ static void latencystat_update (struct latencystat *x, int64_t tdelta)
   if (tdelta < x->min) x->min = tdelta;
   if (tdelta > x->max) x->max = tdelta;
   x->sum += tdelta;
+  ddsi_lathist_record (&x->hdr, tdelta);
   if (x->cnt < PINGPONG_RAWSIZE)
     x->raw[x->cnt] = tdelta;
   x->cnt++;
@@ -1653,6 +1803,8 @@ static void set_data_available_listener (dds_entity_t rd, const char *rd_name, d
   dds_delete_listener (listener);
 }
 
+#define MAX_LATSTATS 6
+
 struct dds_stats {
   struct dds_statistics *pubstat;
   const struct dds_stat_keyvalue *rexmit_bytes;
@@ -1661,23 +1813,118 @@ struct dds_stats {
   const struct dds_stat_keyvalue *throttle_count;
   struct dds_statistics *substat;
   const struct dds_stat_keyvalue *discarded_bytes;
+  uint32_t nlatstats;
+  const char *latstat_name[MAX_LATSTATS];
+  struct dds_statistics *latstat[MAX_LATSTATS];
 };
 
+static void latstats_init (struct dds_stats *stats)
+{
+  const struct { const char *name; dds_entity_t e; } es[MAX_LATSTATS] = {
+    { "domain", dds_get_parent (dp) },
+    { "wr_data", wr_data }, { "rd_data", rd_data },
+    { "wr_ping", wr_ping }, { "rd_ping", rd_ping }, { "rd_pong", rd_pong }
+  };
+  stats->nlatstats = 0;
+  for (size_t i = 0; i < sizeof (es) / sizeof (es[0]); i++)
+  {
+    struct dds_statistics *stat;
+    if (es[i].e <= 0 || (stat = dds_create_statistics (es[i].e)) == NULL)
+      continue;
+    /* only keep those that have latency data, which requires enabling it in the config */
+    bool has_latency = false;
+    for (size_t j = 0; j < stat->count && !has_latency; j++)
+      has_latency = (strncmp (stat->kv[j].name, "latency_", 8) == 0);
+    if (!has_latency)
+      dds_delete_statistics (stat);
+    else
+    {
+      stats->latstat_name[stats->nlatstats] = es[i].name;
+      stats->latstat[stats->nlatstats] = stat;
+      stats->nlatstats++;
+    }
+  }
+}
+
+static void latstats_fini (struct dds_stats *stats)
+{
+  for (uint32_t i = 0; i < stats->nlatstats; i++)
+    dds_delete_statistics (stats->latstat[i]);
+}
+
+static void latstats_print (const char *prefix, struct dds_stats *stats)
+{
+  for (uint32_t i = 0; i < stats->nlatstats; i++)
+  {
+    struct dds_statistics * const stat = stats->latstat[i];
+    bool first = true;
+    (void) dds_refresh_statistics (stat);
+    /* keys come in groups of latency_STAGE_{count,p50,p90,p99,max} */
+    for (size_t j = 0; j + 4 < stat->count; j++)
+    {
+      const char *name = stat->kv[j].name;
+      const size_t len = strlen (name);
+      if (len <= 14 || strncmp (name, "latency_", 8) != 0 || strcmp (name + len - 6, "_count") != 0)
+        continue;
+      if (stat->kv[j].u.u64 > 0)
+      {
+        if (first)
+          printf ("%s %s latency", prefix, stats->latstat_name[i]);
+        printf ("%s %.*s n %"PRIu64" %.1f/%.1f/%.1f/%.1fus", first ? "" : ",", (int) (len - 14), name + 8, stat->kv[j].u.u64,
+                (double) stat->kv[j+1].u.u64 / 1e3, (double) stat->kv[j+2].u.u64 / 1e3,
+                (double) stat->kv[j+3].u.u64 / 1e3, (double) stat->kv[j+4].u.u64 / 1e3);
+        first = false;
+      }
+      j += 4;
+    }
+    if (!first)
+      printf (" (p50/p90/p99/max)\n");
+  }
+}
+
+static void extended_stats_output (struct output *out, struct dds_stats *stats)
+{
+  output_begin (out, "extended", NULL);
+  output_uint (out, "discarded_bytes", stats->discarded_bytes->u.u64);
+  output_uint (out, "rexmit_bytes", stats->rexmit_bytes->u.u64);
+  output_uint (out, "time_rexmit", stats->time_rexmit->u.u64);
+  output_uint (out, "time_throttle", stats->time_throttle->u.u64);
+  output_uint (out, "throttle_count", stats->throttle_count->u.u32);
+  output_end (out);
+  for (uint32_t i = 0; i < stats->nlatstats; i++)
+  {
+    struct dds_statistics * const stat = stats->latstat[i];
+    (void) dds_refresh_statistics (stat);
+    output_begin (out, "stage_latency", stats->latstat_name[i]);
+    for (size_t j = 0; j < stat->count; j++)
+      if (strncmp (stat->kv[j].name, "latency_", 8) == 0 && stat->kv[j].kind == DDS_STAT_KIND_UINT64)
+        output_uint (out, stat->kv[j].name + 8, stat->kv[j].u.u64);
+    output_end (out);
+  }
+}
+
 static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, struct record_cputime_state *cputime_state, struct record_netload_state *netload_state, struct dds_stats *stats)
 {
   char prefix[128];
   const double ts = (double) (tnow - tref) / 1e9;
   bool output = false;
   snprintf (prefix, sizeof (prefix), "[%"PRIdPID"] %.3f ", ddsrt_getpid (), ts);
+  if (machine_output)
+    output_set_time (machine_output, ts);
 
   if (pub_rate > 0)
   {
     ddsrt_mutex_lock (&pubstat_lock);
+    if (machine_output)
+      hist_output (machine_output, pubstat_hist, tnow - tprev);
     hist_print (prefix, pubstat_hist, tnow - tprev, 1);
     ddsrt_mutex_unlock (&pubstat_lock);
     output = true;
   }
 
+  if (scale && scale_print (scale, prefix, machine_output))
+    output = true;
+
   int64_t *newraw = malloc (PINGPONG_RAWSIZE * sizeof (*newraw));
   assert(newraw);
   if (submode != SM_NONE)
@@ -1718,6 +1965,20 @@ static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, str
               (double) nrecv10s * 1e6 / (10 * dt), (double) nrecv10s_bytes * 8 * 1e3 / (10 * dt));
       output = true;
     }
+    if (machine_output)
+    {
+      struct output * const out = machine_output;
+      const double dt = (double) (tnow - tprev) / 1e9;
+      output_begin (out, "sub", NULL);
+      output_uint (out, "size", last_size);
+      output_uint (out, "total", tot_nrecv);
+      output_uint (out, "total_lost", tot_nlost);
+      output_uint (out, "received", nrecv);
+      output_uint (out, "lost", nlost);
+      output_double (out, "rate", (double) nrecv / dt);
+      output_double (out, "bps", (double) nrecv_bytes * 8 / dt);
+      output_end (out);
+    }
 
     if (sublatency)
     {
@@ -1732,7 +1993,7 @@ static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, str
         ddsrt_mutex_unlock (&ea->lock);
         if (y.cnt > 0)
           output = true;
-        newraw = latencystat_print (&y, prefix, " sublat", ea->ph[i], ea->pph[i], x->last_size);
+        newraw = latencystat_print (&y, prefix, " sublat", "sublat", ea->ph[i], ea->pph[i], x->last_size);
         ddsrt_mutex_lock (&ea->lock);
       }
       ddsrt_mutex_unlock (&ea->lock);
@@ -1750,13 +2011,13 @@ static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, str
     ddsrt_mutex_unlock (&pongstat_lock);
     if (y.info.cnt > 0)
       output = true;
-    newraw = latencystat_print (&y.info, prefix, "", y.pubhandle, y.pphandle, topic_payload_size (topicsel, baggagesize));
+    newraw = latencystat_print (&y.info, prefix, "", "roundtrip", y.pubhandle, y.pphandle, topic_payload_size (topicsel, baggagesize));
     ddsrt_mutex_lock (&pongstat_lock);
   }
   ddsrt_mutex_unlock (&pongstat_lock);
   free (newraw);
 
-  if (record_cputime (cputime_state, prefix, tnow))
+  if (record_cputime (cputime_state, prefix, tnow, machine_output))
     output = true;
 
   if (rd_stat)
@@ -1789,14 +2050,21 @@ static bool print_stats (dds_time_t tref, dds_time_t tnow, dds_time_t tprev, str
 #undef MAXS
   }
 
-  if (output)
-    record_netload (netload_state, prefix, tnow);
+  if (output || machine_output)
+    record_netload (netload_state, prefix, tnow, machine_output);
 
+  if (extended_stats && stats && machine_output)
+  {
+    (void) dds_refresh_statistics (stats->substat);
+    (void) dds_refresh_statistics (stats->pubstat);
+    extended_stats_output (machine_output, stats);
+  }
   if (extended_stats && output && stats)
   {
     (void) dds_refresh_statistics (stats->substat);
     (void) dds_refresh_statistics (stats->pubstat);
     printf ("%s discarded %"PRIu64" rexmit %"PRIu64" Trexmit %"PRIu64" Tthrottle %"PRIu64" Nthrottle %"PRIu32"\n", prefix, stats->discarded_bytes->u.u64, stats->rexmit_bytes->u.u64, stats->time_rexmit->u.u64, stats->time_throttle->u.u64, stats->throttle_count->u.u32);
+    latstats_print (prefix, stats);
   }
 
   fflush (stdout);
@@ -1921,8 +2189,17 @@ OPTIONS:\n\
                       anything.)\n\
   -1                  print \"sub\" stats every second, even when there is\n\
                       data\n\
-  -X                  output extended statistics\n\
+  -X                  output extended statistics, including a breakdown of\n\
+                      latency by stage of the data path if enabled with\n\
+                      Internal/StageLatencyStatistics\n\
   -i ID               use domain ID instead of the default domain\n\
+  -O json:FILE        also write all statistics to FILE (\"-\" for stdout) in\n\
+  -O csv:FILE         a machine-readable form: JSON, one object per line, or\n\
+                      CSV, one line per value.  Latency is written as a\n\
+                      full histogram, the non-empty buckets are identified\n\
+                      by their upper bound in ns and can be merged across\n\
+                      runs and processes.  ddsperf-compare.py compares two\n\
+                      such (JSON) files\n\
 \n\
 MODE... is zero or more of:\n\
   ping [R[Hz]] [size S] [waitset|listener]\n\
@@ -1936,16 +2213,31 @@ MODE... is zero or more of:\n\
   sub [waitset|listener|polling]\n\
     Subscribe to data, with calls to take occurring either in a listener\n\
     (default), when a waitset is triggered, or by polling at 1kHz.\n\
-  pub [R[Hz]] [size S] [burst N] [[ping] X%%] [loan]\n\
+  pub [R[Hz]] [size S] [burst N] [batch] [[ping] X%%] [loan]\n\
     Publish bursts of data at rate R, optionally suffixed with Hz/kHz.  If\n\
     no rate is given or R is \"inf\", data is published as fast as\n\
     possible.  Each burst is a single sample by default, but can be set\n\
-    to larger value using \"burst N\".  Sample size is controlled using\n\
+    to larger value using \"burst N\".  With \"batch\", each burst is\n\
+    written using a single call to dds_write_n instead of one call per\n\
+    sample (pings are not supported).  Sample size is controlled using\n\
     \"size S\", S may be suffixed with k/M/kB/MB/KiB/MiB.\n\
     If desired, a fraction of the samples can be treated as if it were a\n\
     ping, for this, specify a percentage either as \"ping X%%\" (the\n\
     \"ping\" keyword is optional, the %% sign is not).  \"loan\" uses\n\
     loans on the writer.\n\
+  scale [topics N] [writers M] [readers K] [rate SPEC] [poisson] [size S]\n\
+    Create N topics (default 100), each with M writers and K readers\n\
+    (default 1 of each), all writers publishing from a single thread.  The\n\
+    rate of each writer is either fixed (\"rate R\", optionally suffixed\n\
+    with Hz/kHz, default 10Hz), drawn uniformly from a range (\"rate LO-HI\")\n\
+    or drawn from an exponential distribution (\"rate exp:R\", R the mean).\n\
+    Writes are periodic unless \"poisson\" is given, in which case the\n\
+    intervals are exponentially distributed.  Reports the time it takes to\n\
+    create and match all readers/writers, the aggregate write/receive rate,\n\
+    the number of writes more than 1ms late, one-way latency percentiles\n\
+    and process CPU time per sample written or received, every second and\n\
+    as a summary at the end.  Without -L, matching requires a peer process\n\
+    running a compatible \"scale\" mode.\n\
 \n\
   Payload size (including fixed part of topic) may be set as part of a\n\
   \"ping\" or \"pub\" specification for topic KS (there is only size,\n\
@@ -1968,6 +2260,9 @@ EXAMPLES:\n\
   ddsperf -L -TOU -D10 pub sub\n\
     basic throughput test within the process with tiny, keyless samples,\n\
     running for 10s\n\
+  ddsperf -L -D30 scale topics 2000 rate 10-50Hz\n\
+    2000 topics, each with one writer publishing at 10 to 50Hz and one\n\
+    reader, within a single process, running for 30s\n\
 ", argv0, argv0, argv0);
   fflush (stdout);
   exit (3);
@@ -1983,6 +2278,7 @@ static const struct string_int_map_elem modestrings[] = {
   { "pong", 2 },
   { "sub", 3 },
   { "pub", 4 },
+  { "scale", 5 },
   { NULL, 0 }
 };
 
@@ -2181,6 +2477,10 @@ static void set_mode_pub (int *xoptind, int xargc, char * const xargv[])
     {
       use_writer_loan = true;
     }
+    else if (strcmp (xargv[*xoptind], "batch") == 0)
+    {
+      use_write_n = true;
+    }
     else
     {
       error3 ("%s: unrecognised publish specification\n", xargv[*xoptind]);
@@ -2189,6 +2489,83 @@ static void set_mode_pub (int *xoptind, int xargc, char * const xargv[])
   }
 }
 
+static bool parse_scale_rate (const char *str, double *r)
+{
+  int pos = 0, mult;
+  if (sscanf (str, "%lf%n", r, &pos) != 1 || *r <= 0 || (mult = lookup_multiplier (frequency_units, str + pos)) == 0)
+    return false;
+  *r *= mult;
+  return true;
+}
+
+static void set_mode_scale (int *xoptind, int xargc, char * const xargv[])
+{
+  scale_mode = true;
+  scale_params.ntopics = 100;
+  scale_params.nwriters = 1;
+  scale_params.nreaders = 1;
+  scale_params.ratedist = SRD_FIXED;
+  scale_params.rate_lo = scale_params.rate_hi = 10.0;
+  scale_params.poisson = false;
+  while (*xoptind < xargc && exact_string_int_map_lookup (modestrings, "mode string", xargv[*xoptind], false) == -1)
+  {
+    if (set_simple_uint32 (xoptind, xargc, xargv, "topics", NULL, &scale_params.ntopics) ||
+        set_simple_uint32 (xoptind, xargc, xargv, "writers", NULL, &scale_params.nwriters) ||
+        set_simple_uint32 (xoptind, xargc, xargv, "readers", NULL, &scale_params.nreaders) ||
+        set_simple_uint32 (xoptind, xargc, xargv, "size", size_units, &baggagesize))
+    {
+      /* no further work needed */
+    }
+    else if (strcmp (xargv[*xoptind], "poisson") == 0)
+    {
+      scale_params.poisson = true;
+    }
+    else if (strcmp (xargv[*xoptind], "rate") == 0)
+    {
+      char lo[64];
+      const char *str, *dash;
+      if (++(*xoptind) == xargc)
+        error3 ("argument missing in rate specification\n");
+      str = xargv[*xoptind];
+      if (strncmp (str, "exp:", 4) == 0)
+      {
+        scale_params.ratedist = SRD_EXP;
+        if (!parse_scale_rate (str + 4, &scale_params.rate_lo))
+          error3 ("%s: invalid rate specification\n", str);
+      }
+      else if ((dash = strchr (str, '-')) != NULL && (size_t) (dash - str) < sizeof (lo))
+      {
+        /* LO-HI, with an optional unit at the end that applies to both */
+        int pos = 0, pos1 = 0, mult;
+        memcpy (lo, str, (size_t) (dash - str));
+        lo[dash - str] = 0;
+        scale_params.ratedist = SRD_UNIFORM;
+        if (sscanf (lo, "%lf%n", &scale_params.rate_lo, &pos) != 1 || lo[pos] != 0 || scale_params.rate_lo <= 0 ||
+            sscanf (dash + 1, "%lf%n", &scale_params.rate_hi, &pos1) != 1 ||
+            (mult = lookup_multiplier (frequency_units, dash + 1 + pos1)) == 0)
+          error3 ("%s: invalid rate specification\n", str);
+        scale_params.rate_lo *= mult;
+        scale_params.rate_hi *= mult;
+        if (scale_params.rate_hi < scale_params.rate_lo)
+          error3 ("%s: invalid rate range\n", str);
+      }
+      else
+      {
+        scale_params.ratedist = SRD_FIXED;
+        if (!parse_scale_rate (str, &scale_params.rate_lo))
+          error3 ("%s: invalid rate specification\n", str);
+      }
+    }
+    else
+    {
+      error3 ("%s: unrecognised scale specification\n", xargv[*xoptind]);
+    }
+    (*xoptind)++;
+  }
+  if (scale_params.ntopics == 0)
+    error3 ("scale: need at least one topic\n");
+}
+
 static void set_mode (int xoptind, int xargc, char * const xargv[])
 {
   int code;
@@ -2206,6 +2583,7 @@ static void set_mode (int xoptind, int xargc, char * const xargv[])
       case 2: set_mode_pong (&xoptind, xargc, xargv); break;
       case 3: set_mode_sub (&xoptind, xargc, xargv); break;
       case 4: set_mode_pub (&xoptind, xargc, xargv); break;
+      case 5: set_mode_scale (&xoptind, xargc, xargv); break;
     }
   }
   if (xoptind != xargc)
@@ -2259,11 +2637,13 @@ int main (int argc, char *argv[])
   double netload_bw = -1;
   double rss_init = 0.0, rss_final = 0.0;
   double livemem_init = 0.0, livemem_final = 0.0;
+  union data scale_data;
+  void *scale_baggage = NULL;
   ddsrt_threadattr_init (&attr);
 
   argv0 = argv[0];
 
-  while ((opt = getopt (argc, argv, "1cd:D:i:n:k:ulLK:T:Q:R:Xh")) != EOF)
+  while ((opt = getopt (argc, argv, "1cd:D:i:n:k:ulLK:O:T:Q:R:Xh")) != EOF)
   {
     int pos;
     switch (opt)
@@ -2330,6 +2710,11 @@ int main (int argc, char *argv[])
         break;
       }
       case 'X': extended_stats = true; break;
+      case 'O':
+        output_free (machine_output);
+        if ((machine_output = output_new (optarg)) == NULL)
+          error3 ("-O %s: invalid output specification or can't open file\n", optarg);
+        break;
       case 'R': {
         tref = 0;
         if (sscanf (optarg, "%"SCNd64"%n", &tref, &pos) != 1 || optarg[pos] != 0)
@@ -2360,6 +2745,8 @@ int main (int argc, char *argv[])
     error3 ("size %"PRIu32" invalid: only topic KS has a sequence\n", baggagesize);
   if (topicsel == KS && use_writer_loan)
     error3 ("topic KS is not supported with writer loans because it contains a sequence\n");
+  if (use_write_n && ping_frac != 0)
+    error3 ("pings in the published data are not supported in batch mode\n");
   if (baggagesize != 0 && baggagesize < 12)
     error3 ("size %"PRIu32" invalid: too small to allow for overhead\n", baggagesize);
   else if (baggagesize > 0)
@@ -2427,9 +2814,9 @@ int main (int argc, char *argv[])
     error2 ("dds_create_topic(%s) failed: %d\n", "DDSPerfCPUStats", (int) tp_stat);
   dds_delete_qos (qos);
 
+  const dds_topic_descriptor_t *tp_desc = NULL;
   {
     const char *tp_suf = "KS";
-    const dds_topic_descriptor_t *tp_desc = NULL;
     switch (topicsel)
     {
       case KS:                        tp_desc = &KeyedSeq_desc; break;
@@ -2447,6 +2834,7 @@ int main (int argc, char *argv[])
     snprintf (tpname_data, sizeof (tpname_data), "DDSPerf%cData%s", reliable ? 'R' : 'U', tp_suf);
     snprintf (tpname_ping, sizeof (tpname_ping), "DDSPerf%cPing%s", reliable ? 'R' : 'U', tp_suf);
     snprintf (tpname_pong, sizeof (tpname_pong), "DDSPerf%cPong%s", reliable ? 'R' : 'U', tp_suf);
+    snprintf (tpname_scale, sizeof (tpname_scale), "DDSPerf%cScale%s", reliable ? 'R' : 'U', tp_suf);
     qos = dds_create_qos ();
     dds_qset_reliability (qos, reliable ? DDS_RELIABILITY_RELIABLE : DDS_RELIABILITY_BEST_EFFORT, DDS_SECS (10));
     if ((tp_data = dds_create_topic (dp, tp_desc, tpname_data, qos, NULL)) < 0)
@@ -2555,6 +2943,20 @@ int main (int argc, char *argv[])
       error2 ("dds_create_reader(%s) failed: %d\n", tpname_pong, (int) rd_pong);
     dds_delete_listener (listener);
   }
+
+  /* Scaling mode readers/writers use the same QoS as the data reader/writer.  Local
+     readers/writers only match each other with -L, otherwise a peer process with the
+     same configuration is needed, and then at least one match is all we can expect */
+  if (scale_mode)
+  {
+    dds_qos_t *tpqos = dds_create_qos ();
+    dds_qset_reliability (tpqos, reliable ? DDS_RELIABILITY_RELIABLE : DDS_RELIABILITY_BEST_EFFORT, DDS_SECS (10));
+    const bool local = (ignorelocal == DDS_IGNORELOCAL_NONE);
+    scale_params.wr_expect = (local && scale_params.nreaders > 0) ? scale_params.nreaders : 1;
+    scale_params.rd_expect = (local && scale_params.nwriters > 0) ? scale_params.nwriters : 1;
+    scale = scale_new (dp, pub, sub, tp_desc, tpname_scale, tpqos, qos, &scale_params);
+    dds_delete_qos (tpqos);
+  }
   dds_delete_qos (qos);
 
   if ((termcond = dds_create_guardcondition (dp)) < 0)
@@ -2592,6 +2994,11 @@ int main (int argc, char *argv[])
 
   if (pub_rate > 0)
     ddsrt_thread_create (&pubtid, "pub", &attr, pubthread, NULL);
+  if (scale)
+  {
+    scale_baggage = init_sample (&scale_data, 0);
+    scale_start (scale, &scale_data, sizeof (scale_data), getseqoff (), getkeyvaloff ());
+  }
   if (subthread_func != NULL)
     ddsrt_thread_create (&subtid, "sub", &attr, subthread_func, &subarg_data);
   else if (submode == SM_LISTENER)
@@ -2647,6 +3054,7 @@ int main (int argc, char *argv[])
   {
     abort ();
   }
+  latstats_init (&stats);
 
   /* I hate Unix signals in multi-threaded processes ... */
 #ifdef _WIN32
@@ -2781,6 +3189,7 @@ int main (int argc, char *argv[])
 
   dds_delete_statistics (stats.pubstat);
   dds_delete_statistics (stats.substat);
+  latstats_fini (&stats);
   record_netload_free (netload_state);
   record_cputime_free (cputime_state);
 
@@ -2822,6 +3231,17 @@ err_minmatch_wait:
   dds_set_listener (rd_subscriptions, NULL);
   dds_set_listener (rd_publications, NULL);
 
+  bool scale_ok = true;
+  if (scale)
+  {
+    char prefix[32];
+    snprintf (prefix, sizeof (prefix), "[%"PRIdPID"]", ddsrt_getpid ());
+    scale_stop (scale);
+    scale_ok = scale_summary (scale, prefix, machine_output);
+    scale_free (scale);
+    free (scale_baggage);
+  }
+
   /* Delete rd_data early to workaround a deadlock deleting a reader
      or writer while the receive thread (or a delivery thread) got
      stuck trying to write into a reader that hit its resource limits.
@@ -2886,6 +3306,7 @@ err_minmatch_wait:
   }
 
   ddsrt_avl_free (&ppants_td, &ppants, free_ppant);
+  output_free (machine_output);
 
   if (matchcount < minmatch)
   {
@@ -2902,6 +3323,11 @@ err_minmatch_wait:
     printf ("[%"PRIdPID"] error: too few roundtrips for some peers\n", ddsrt_getpid ());
     ok = false;
   }
+  if (!scale_ok)
+  {
+    printf ("[%"PRIdPID"] error: not all scale mode readers/writers matched\n", ddsrt_getpid ());
+    ok = false;
+  }
   if (!received_ok)
   {
     printf ("[%"PRIdPID"] error: too few samples received from some peers\n", ddsrt_getpid ());
@@ -35,7 +35,7 @@ struct record_netload_state {
   uint64_t obytes;
 };
 
-void record_netload (struct record_netload_state *st, const char *prefix, dds_time_t tnow)
+void record_netload (struct record_netload_state *st, const char *prefix, dds_time_t tnow, struct output *out)
 {
   if (st && !st->errored)
   {
@@ -50,6 +50,17 @@ void record_netload (struct record_netload_state *st, const char *prefix, dds_ti
         const double dt = (double) (tnow - st->tprev) / 1e9;
         const double dx = 8 * (double) (x.obytes - st->obytes) / dt;
         const double dr = 8 * (double) (x.ibytes - st->ibytes) / dt;
+        if (out)
+        {
+          output_begin (out, "netload", st->name);
+          output_double (out, "xmit_bps", dx);
+          output_double (out, "recv_bps", dr);
+          output_uint (out, "obytes", x.obytes);
+          output_uint (out, "ibytes", x.ibytes);
+          if (st->bw > 0)
+            output_double (out, "bandwidth", st->bw);
+          output_end (out);
+        }
         if (st->bw > 0)
         {
           const double dxpct = 100.0 * dx / st->bw;
@@ -90,7 +101,7 @@ DDSRT_WARNING_MSVC_OFF(4996);
   st->bw = bw;
   st->data_valid = false;
   st->errored = false;
-  record_netload (st, "", dds_time ());
+  record_netload (st, "", dds_time (), NULL);
   return st;
 DDSRT_WARNING_MSVC_ON(4996);
 }
@@ -107,11 +118,12 @@ void record_netload_free (struct record_netload_state *st)
 
 #else
 
-void record_netload (struct record_netload_state *st, const char *prefix, dds_time_t tnow)
+void record_netload (struct record_netload_state *st, const char *prefix, dds_time_t tnow, struct output *out)
 {
   (void) st;
   (void) prefix;
-  (void ) tnow;
+  (void) tnow;
+  (void) out;
 }
 
 struct record_netload_state *record_netload_new (const char *dev, double bw)
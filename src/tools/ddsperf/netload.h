@@ -12,10 +12,11 @@
 #define NETLOAD_H
 
 #include <dds/dds.h>
+#include "output.h"
 
 struct record_netload_state;
 
-void record_netload (struct record_netload_state *st, const char *prefix, dds_time_t tnow);
+void record_netload (struct record_netload_state *st, const char *prefix, dds_time_t tnow, struct output *out);
 struct record_netload_state *record_netload_new (const char *dev, double bw);
 void record_netload_free (struct record_netload_state *st);
 
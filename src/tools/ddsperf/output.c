@@ -0,0 +1,252 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <math.h>
+
+#include "dds/dds.h"
+#include "dds/ddsrt/string.h"
+#include "dds/ddsrt/process.h"
+#include "dds/ddsrt/misc.h"
+
+#include "output.h"
+
+enum output_format {
+  OF_JSON,
+  OF_CSV
+};
+
+struct output {
+  enum output_format format;
+  FILE *fp;
+  double ts;
+  ddsrt_pid_t pid;
+  /* current record */
+  const char *record;
+  char subject[256];
+};
+
+static void json_string (FILE *fp, const char *s)
+{
+  fputc ('"', fp);
+  for (; *s; s++)
+  {
+    const unsigned char c = (unsigned char) *s;
+    if (c == '"' || c == '\\')
+      fprintf (fp, "\\%c", c);
+    else if (c < 0x20)
+      fprintf (fp, "\\u%04x", c);
+    else
+      fputc (c, fp);
+  }
+  fputc ('"', fp);
+}
+
+static void csv_string (FILE *fp, const char *s)
+{
+  if (strpbrk (s, ",\"\r\n") == NULL)
+    fputs (s, fp);
+  else
+  {
+    fputc ('"', fp);
+    for (; *s; s++)
+    {
+      if (*s == '"')
+        fputc ('"', fp);
+      fputc (*s, fp);
+    }
+    fputc ('"', fp);
+  }
+}
+
+struct output *output_new (const char *spec)
+{
+  enum output_format format;
+  const char *file;
+  if (strncmp (spec, "json:", 5) == 0)
+  {
+    format = OF_JSON;
+    file = spec + 5;
+  }
+  else if (strncmp (spec, "csv:", 4) == 0)
+  {
+    format = OF_CSV;
+    file = spec + 4;
+  }
+  else
+  {
+    return NULL;
+  }
+  if (*file == 0)
+    return NULL;
+
+  struct output *out = malloc (sizeof (*out));
+  assert (out);
+  out->format = format;
+  out->ts = 0.0;
+  out->pid = ddsrt_getpid ();
+  out->record = NULL;
+  out->subject[0] = 0;
+  if (strcmp (file, "-") == 0)
+    out->fp = stdout;
+  else
+  {
+DDSRT_WARNING_MSVC_OFF(4996);
+    if ((out->fp = fopen (file, "w")) == NULL)
+    {
+      free (out);
+      return NULL;
+    }
+DDSRT_WARNING_MSVC_ON(4996);
+  }
+  if (out->format == OF_CSV)
+    fprintf (out->fp, "time,pid,record,subject,key,value\n");
+  return out;
+}
+
+void output_free (struct output *out)
+{
+  if (out == NULL)
+    return;
+  if (out->fp == stdout)
+    fflush (out->fp);
+  else
+    fclose (out->fp);
+  free (out);
+}
+
+void output_set_time (struct output *out, double ts)
+{
+  out->ts = ts;
+}
+
+void output_begin (struct output *out, const char *record, const char *subject)
+{
+  out->record = record;
+  (void) ddsrt_strlcpy (out->subject, subject ? subject : "", sizeof (out->subject));
+  if (out->format == OF_JSON)
+  {
+    fprintf (out->fp, "{\"record\":");
+    json_string (out->fp, record);
+    fprintf (out->fp, ",\"time\":%.6f,\"pid\":%"PRIdPID, out->ts, out->pid);
+    if (subject)
+    {
+      fprintf (out->fp, ",\"subject\":");
+      json_string (out->fp, subject);
+    }
+  }
+}
+
+static void csv_prefix (struct output *out, const char *key)
+{
+  fprintf (out->fp, "%.6f,%"PRIdPID",%s,", out->ts, out->pid, out->record);
+  csv_string (out->fp, out->subject);
+  fputc (',', out->fp);
+  csv_string (out->fp, key);
+  fputc (',', out->fp);
+}
+
+static void json_key (struct output *out, const char *key)
+{
+  fputc (',', out->fp);
+  json_string (out->fp, key);
+  fputc (':', out->fp);
+}
+
+void output_uint (struct output *out, const char *key, uint64_t v)
+{
+  if (out->format == OF_JSON)
+  {
+    json_key (out, key);
+    fprintf (out->fp, "%"PRIu64, v);
+  }
+  else
+  {
+    csv_prefix (out, key);
+    fprintf (out->fp, "%"PRIu64"\n", v);
+  }
+}
+
+void output_double (struct output *out, const char *key, double v)
+{
+  /* JSON has no representation for infinities and NaNs */
+  if (out->format == OF_JSON)
+  {
+    json_key (out, key);
+    if (isfinite (v))
+      fprintf (out->fp, "%.9g", v);
+    else
+      fprintf (out->fp, "null");
+  }
+  else
+  {
+    csv_prefix (out, key);
+    fprintf (out->fp, "%.9g\n", v);
+  }
+}
+
+void output_string (struct output *out, const char *key, const char *v)
+{
+  if (out->format == OF_JSON)
+  {
+    json_key (out, key);
+    json_string (out->fp, v);
+  }
+  else
+  {
+    csv_prefix (out, key);
+    csv_string (out->fp, v);
+    fputc ('\n', out->fp);
+  }
+}
+
+void output_lathist (struct output *out, const char *key, const struct ddsi_lathist *h)
+{
+  /* JSON: "key":[[upper_bound_ns,count],...], CSV: one row per bucket with
+     key "key:upper_bound_ns" */
+  bool first = true;
+  if (out->format == OF_JSON)
+  {
+    json_key (out, key);
+    fputc ('[', out->fp);
+  }
+  for (uint32_t i = 0; i < DDSI_LATHIST_NBUCKETS; i++)
+  {
+    const uint32_t cnt = ddsrt_atomic_ld32 (&h->bucket[i]);
+    if (cnt == 0)
+      continue;
+    const uint64_t ub = ddsi_lathist_bucket_upper_bound (i);
+    if (out->format == OF_JSON)
+      fprintf (out->fp, "%s[%"PRIu64",%"PRIu32"]", first ? "" : ",", ub, cnt);
+    else
+    {
+      char bkey[64];
+      snprintf (bkey, sizeof (bkey), "%s:%"PRIu64, key, ub);
+      csv_prefix (out, bkey);
+      fprintf (out->fp, "%"PRIu32"\n", cnt);
+    }
+    first = false;
+  }
+  if (out->format == OF_JSON)
+    fputc (']', out->fp);
+}
+
+void output_end (struct output *out)
+{
+  if (out->format == OF_JSON)
+    fprintf (out->fp, "}\n");
+  out->record = NULL;
+  fflush (out->fp);
+}
@@ -0,0 +1,39 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdint.h>
+#include "dds/dds.h"
+#include "dds/ddsi/ddsi_lathist.h"
+
+/* Machine-readable output of the statistics ddsperf prints: either JSON,
+   one object per line per record, or CSV, with one row per value in the
+   form "time,pid,record,subject,key,value".  Latency histograms are
+   written as the non-empty buckets of a ddsi_lathist, identified by their
+   upper bound in ns, so that histograms from different runs and processes
+   can be merged by adding the counts.
+
+   Only to be used from a single thread. */
+
+struct output;
+
+struct output *output_new (const char *spec);
+void output_free (struct output *out);
+void output_set_time (struct output *out, double ts);
+void output_begin (struct output *out, const char *record, const char *subject);
+void output_uint (struct output *out, const char *key, uint64_t v);
+void output_double (struct output *out, const char *key, double v);
+void output_string (struct output *out, const char *key, const char *v);
+void output_lathist (struct output *out, const char *key, const struct ddsi_lathist *h);
+void output_end (struct output *out);
+
+#endif
@@ -0,0 +1,510 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#define _ISOC99_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <inttypes.h>
+
+#include "dds/dds.h"
+#include "dds/ddsi/ddsi_lathist.h"
+
+#include "dds/ddsrt/heap.h"
+#include "dds/ddsrt/sync.h"
+#include "dds/ddsrt/threads.h"
+#include "dds/ddsrt/random.h"
+#include "dds/ddsrt/rusage.h"
+#include "dds/ddsrt/fibheap.h"
+#include "dds/ddsrt/atomics.h"
+
+#include "scale.h"
+
+/* Anything written more than this after the scheduled time counts as late:
+   it means the publishing thread can't keep up with the configured load */
+#define SCALE_LATE_THRESHOLD DDS_MSECS (1)
+
+struct scale_writer {
+  ddsrt_fibheap_node_t fhnode;
+  struct scale_state *st;
+  dds_entity_t wr;
+  uint32_t keyval;
+  uint32_t seq;
+  dds_duration_t period;
+  dds_time_t tnext;
+  bool matched; /* protected by st->lock */
+};
+
+struct scale_reader {
+  struct scale_state *st;
+  dds_entity_t rd;
+  bool matched; /* protected by st->lock */
+};
+
+struct scale_counts {
+  uint64_t nwritten, nlate, nrecv;
+  dds_time_t cputime;
+};
+
+struct scale_state {
+  struct scale_params params;
+  uint32_t nwr, nrd;
+  dds_entity_t *tps;
+  struct scale_writer *wrs;
+  struct scale_reader *rds;
+  ddsrt_fibheap_t sched;
+
+  ddsrt_mutex_t lock;
+  uint32_t nunmatched;
+  dds_time_t tdiscovered;
+  uint64_t nwritten, nlate, nrecv;
+
+  dds_time_t tcreate, tcreated;
+  bool discovery_reported;
+
+  /* latency of all samples received, the snapshot is used to derive the
+     distribution over the last reporting interval */
+  struct ddsi_lathist *lat;
+  uint32_t latsnap[DDSI_LATHIST_NBUCKETS];
+  struct scale_counts prev, start, end;
+
+  /* publishing thread */
+  ddsrt_atomic_uint32_t stop;
+  bool started;
+  ddsrt_thread_t tid;
+  void *sample;
+  size_t seqoff, keyvaloff;
+};
+
+static int cmp_writer_tnext (const void *va, const void *vb)
+{
+  const struct scale_writer *a = va;
+  const struct scale_writer *b = vb;
+  return (a->tnext == b->tnext) ? 0 : (a->tnext < b->tnext) ? -1 : 1;
+}
+
+static const ddsrt_fibheap_def_t scale_sched_fhd = DDSRT_FIBHEAPDEF_INITIALIZER (offsetof (struct scale_writer, fhnode), cmp_writer_tnext);
+
+static double random_unit (void)
+{
+  /* uniform in [0,1) */
+  return (double) ddsrt_random () / 4294967296.0;
+}
+
+static dds_time_t read_cputime (void)
+{
+#if DDSRT_HAVE_RUSAGE
+  ddsrt_rusage_t usage;
+  if (ddsrt_getrusage (DDSRT_RUSAGE_SELF, &usage) == 0)
+    return usage.utime + usage.stime;
+#endif
+  return 0;
+}
+
+static void read_counts (struct scale_state *st, struct scale_counts *c)
+{
+  ddsrt_mutex_lock (&st->lock);
+  c->nwritten = st->nwritten;
+  c->nlate = st->nlate;
+  c->nrecv = st->nrecv;
+  ddsrt_mutex_unlock (&st->lock);
+  c->cputime = read_cputime ();
+}
+
+static void update_matched_locked (struct scale_state *st, bool *matched, bool now_matched)
+{
+  if (*matched == now_matched)
+    return;
+  *matched = now_matched;
+  if (!now_matched)
+    st->nunmatched++;
+  else if (--st->nunmatched == 0 && st->tdiscovered == DDS_NEVER)
+    st->tdiscovered = dds_time ();
+}
+
+static void scale_publication_matched (dds_entity_t wr, const dds_publication_matched_status_t status, void *arg)
+{
+  struct scale_writer * const w = arg;
+  struct scale_state * const st = w->st;
+  (void) wr;
+  ddsrt_mutex_lock (&st->lock);
+  update_matched_locked (st, &w->matched, status.current_count >= st->params.wr_expect);
+  ddsrt_mutex_unlock (&st->lock);
+}
+
+static void scale_subscription_matched (dds_entity_t rd, const dds_subscription_matched_status_t status, void *arg)
+{
+  struct scale_reader * const r = arg;
+  struct scale_state * const st = r->st;
+  (void) rd;
+  ddsrt_mutex_lock (&st->lock);
+  update_matched_locked (st, &r->matched, status.current_count >= st->params.rd_expect);
+  ddsrt_mutex_unlock (&st->lock);
+}
+
+static void scale_data_available (dds_entity_t rd, void *arg)
+{
+#define MAXS 16
+  struct scale_reader * const r = arg;
+  struct scale_state * const st = r->st;
+  void *mseq[MAXS];
+  dds_sample_info_t iseq[MAXS];
+  int32_t n;
+  do {
+    mseq[0] = NULL;
+    if ((n = dds_take (rd, mseq, iseq, MAXS, MAXS)) <= 0)
+      break;
+    const dds_time_t tnow = dds_time ();
+    uint32_t nvalid = 0;
+    for (int32_t i = 0; i < n; i++)
+    {
+      if (iseq[i].valid_data)
+      {
+        ddsi_lathist_record (st->lat, tnow - iseq[i].source_timestamp);
+        nvalid++;
+      }
+    }
+    (void) dds_return_loan (rd, mseq, n);
+    ddsrt_mutex_lock (&st->lock);
+    st->nrecv += nvalid;
+    ddsrt_mutex_unlock (&st->lock);
+  } while (n == MAXS);
+#undef MAXS
+}
+
+static double draw_rate (const struct scale_params *params)
+{
+  double r = params->rate_lo;
+  switch (params->ratedist)
+  {
+    case SRD_FIXED:   break;
+    case SRD_UNIFORM: r = params->rate_lo + (params->rate_hi - params->rate_lo) * random_unit (); break;
+    case SRD_EXP:     r = -params->rate_lo * log (1.0 - random_unit ()); break;
+  }
+  /* an exponential distribution occasionally yields absurdly low rates */
+  return (r < 1e-3) ? 1e-3 : r;
+}
+
+static dds_duration_t next_interval (const struct scale_state *st, const struct scale_writer *w)
+{
+  if (!st->params.poisson)
+    return w->period;
+  const dds_duration_t d = (dds_duration_t) (-(double) w->period * log (1.0 - random_unit ()));
+  return (d > 0) ? d : 1;
+}
+
+struct scale_state *scale_new (dds_entity_t pp, dds_entity_t pub, dds_entity_t sub, const dds_topic_descriptor_t *desc, const char *tpname_prefix, const dds_qos_t *tpqos, const dds_qos_t *qos, const struct scale_params *params)
+{
+  struct scale_state *st = ddsrt_malloc (sizeof (*st));
+  memset (st, 0, sizeof (*st));
+  st->params = *params;
+  st->nwr = params->ntopics * params->nwriters;
+  st->nrd = params->ntopics * params->nreaders;
+  st->tps = ddsrt_malloc (params->ntopics * sizeof (*st->tps));
+  st->wrs = ddsrt_malloc ((st->nwr > 0 ? st->nwr : 1) * sizeof (*st->wrs));
+  st->rds = ddsrt_malloc ((st->nrd > 0 ? st->nrd : 1) * sizeof (*st->rds));
+  ddsrt_fibheap_init (&scale_sched_fhd, &st->sched);
+  ddsrt_mutex_init (&st->lock);
+  st->lat = ddsi_lathist_new ();
+  ddsrt_atomic_st32 (&st->stop, 0);
+  st->tdiscovered = DDS_NEVER;
+
+  /* everything starts out unmatched, unless nothing needs to be matched; the
+     listeners may trigger while creating the entities */
+  st->nunmatched = 0;
+  for (uint32_t i = 0; i < st->nwr; i++)
+  {
+    struct scale_writer * const w = &st->wrs[i];
+    w->st = st;
+    w->wr = 0;
+    w->keyval = i % (params->nwriters > 0 ? params->nwriters : 1);
+    w->seq = 0;
+    w->period = (dds_duration_t) (1e9 / draw_rate (params) + 0.5);
+    w->matched = (params->wr_expect == 0);
+    if (!w->matched)
+      st->nunmatched++;
+  }
+  for (uint32_t i = 0; i < st->nrd; i++)
+  {
+    struct scale_reader * const r = &st->rds[i];
+    r->st = st;
+    r->rd = 0;
+    r->matched = (params->rd_expect == 0);
+    if (!r->matched)
+      st->nunmatched++;
+  }
+
+  st->tcreate = dds_time ();
+  if (st->nunmatched == 0)
+    st->tdiscovered = st->tcreate;
+  dds_listener_t *listener = dds_create_listener (NULL);
+  for (uint32_t t = 0; t < params->ntopics; t++)
+  {
+    char tpname[128];
+    snprintf (tpname, sizeof (tpname), "%s_%"PRIu32, tpname_prefix, t);
+    if ((st->tps[t] = dds_create_topic (pp, desc, tpname, tpqos, NULL)) < 0)
+    {
+      printf ("dds_create_topic(%s) failed: %d\n", tpname, (int) st->tps[t]);
+      fflush (stdout);
+      exit (2);
+    }
+    for (uint32_t j = 0; j < params->nreaders; j++)
+    {
+      struct scale_reader * const r = &st->rds[t * params->nreaders + j];
+      dds_reset_listener (listener);
+      dds_lset_subscription_matched_arg (listener, scale_subscription_matched, r, true);
+      dds_lset_data_available_arg (listener, scale_data_available, r, true);
+      if ((r->rd = dds_create_reader (sub, st->tps[t], qos, listener)) < 0)
+      {
+        printf ("dds_create_reader(%s) failed: %d\n", tpname, (int) r->rd);
+        fflush (stdout);
+        exit (2);
+      }
+    }
+    for (uint32_t j = 0; j < params->nwriters; j++)
+    {
+      struct scale_writer * const w = &st->wrs[t * params->nwriters + j];
+      dds_reset_listener (listener);
+      dds_lset_publication_matched_arg (listener, scale_publication_matched, w, true);
+      if ((w->wr = dds_create_writer (pub, st->tps[t], qos, listener)) < 0)
+      {
+        printf ("dds_create_writer(%s) failed: %d\n", tpname, (int) w->wr);
+        fflush (stdout);
+        exit (2);
+      }
+    }
+  }
+  dds_delete_listener (listener);
+  st->tcreated = dds_time ();
+  return st;
+}
+
+static uint32_t scale_pubthread (void *varg)
+{
+  struct scale_state * const st = varg;
+  struct scale_writer *w;
+  while (!ddsrt_atomic_ld32 (&st->stop) && (w = ddsrt_fibheap_min (&scale_sched_fhd, &st->sched)) != NULL)
+  {
+    dds_time_t tnow = dds_time ();
+    if (w->tnext > tnow)
+    {
+      /* wake up regularly to notice a request to stop */
+      const dds_duration_t d = w->tnext - tnow;
+      dds_sleepfor ((d < DDS_MSECS (100)) ? d : DDS_MSECS (100));
+      continue;
+    }
+
+    dds_return_t rc;
+    *((uint32_t *) ((char *) st->sample + st->seqoff)) = w->seq++;
+    if (st->keyvaloff != SIZE_MAX)
+      *((uint32_t *) ((char *) st->sample + st->keyvaloff)) = w->keyval;
+    if ((rc = dds_write (w->wr, st->sample)) != DDS_RETCODE_OK && rc != DDS_RETCODE_TIMEOUT)
+    {
+      printf ("scale: write error: %d\n", (int) rc);
+      fflush (stdout);
+      exit (2);
+    }
+    const bool late = (tnow - w->tnext > SCALE_LATE_THRESHOLD);
+    ddsrt_mutex_lock (&st->lock);
+    st->nwritten++;
+    if (late)
+      st->nlate++;
+    ddsrt_mutex_unlock (&st->lock);
+
+    /* when hopelessly behind, don't try to catch up by writing a burst */
+    (void) ddsrt_fibheap_extract_min (&scale_sched_fhd, &st->sched);
+    w->tnext += next_interval (st, w);
+    if (w->tnext < tnow - DDS_SECS (1))
+      w->tnext = tnow;
+    ddsrt_fibheap_insert (&scale_sched_fhd, &st->sched, w);
+  }
+  return 0;
+}
+
+void scale_start (struct scale_state *st, const void *sample, size_t samplesize, size_t seqoff, size_t keyvaloff)
+{
+  ddsrt_threadattr_t attr;
+  assert (!st->started);
+  st->sample = ddsrt_malloc (samplesize);
+  memcpy (st->sample, sample, samplesize);
+  st->seqoff = seqoff;
+  st->keyvaloff = keyvaloff;
+
+  /* random phase for each writer so they don't all fire at the same time */
+  const dds_time_t tnow = dds_time ();
+  for (uint32_t i = 0; i < st->nwr; i++)
+  {
+    struct scale_writer * const w = &st->wrs[i];
+    w->tnext = tnow + (dds_duration_t) ((double) w->period * random_unit ());
+    ddsrt_fibheap_insert (&scale_sched_fhd, &st->sched, w);
+  }
+
+  read_counts (st, &st->start);
+  st->prev = st->start;
+  ddsrt_threadattr_init (&attr);
+  if (ddsrt_thread_create (&st->tid, "scale", &attr, scale_pubthread, st) != DDS_RETCODE_OK)
+  {
+    printf ("scale: failed to create publishing thread\n");
+    fflush (stdout);
+    exit (2);
+  }
+  st->started = true;
+}
+
+static void print_latency (const struct ddsi_lathist_summary *s)
+{
+  printf (" lat %.1f/%.1f/%.1f/%.1fus", (double) s->p50 / 1e3, (double) s->p90 / 1e3, (double) s->p99 / 1e3, (double) s->max / 1e3);
+}
+
+static double cpu_per_sample (const struct scale_counts *a, const struct scale_counts *b)
+{
+  const uint64_t n = (b->nwritten - a->nwritten) + (b->nrecv - a->nrecv);
+  return (n == 0) ? 0.0 : (double) (b->cputime - a->cputime) / 1e3 / (double) n;
+}
+
+bool scale_print (struct scale_state *st, const char *prefix, struct output *out)
+{
+  bool output = false;
+  dds_time_t tdisc;
+  uint32_t nunmatched;
+  ddsrt_mutex_lock (&st->lock);
+  tdisc = st->tdiscovered;
+  nunmatched = st->nunmatched;
+  ddsrt_mutex_unlock (&st->lock);
+  if (!st->discovery_reported && tdisc != DDS_NEVER)
+  {
+    printf ("%s scale discovery %"PRIu32" topics %"PRIu32" writers %"PRIu32" readers created in %.3fs all matched in %.3fs\n",
+            prefix, st->params.ntopics, st->nwr, st->nrd,
+            (double) (st->tcreated - st->tcreate) / 1e9, (double) (tdisc - st->tcreate) / 1e9);
+    if (out)
+    {
+      output_begin (out, "scale_discovery", NULL);
+      output_uint (out, "topics", st->params.ntopics);
+      output_uint (out, "writers", st->nwr);
+      output_uint (out, "readers", st->nrd);
+      output_double (out, "create_s", (double) (st->tcreated - st->tcreate) / 1e9);
+      output_double (out, "match_s", (double) (tdisc - st->tcreate) / 1e9);
+      output_end (out);
+    }
+    st->discovery_reported = true;
+    output = true;
+  }
+
+  if (!st->started)
+    return output;
+
+  /* interval histogram: difference between the cumulative one and the last snapshot */
+  struct ddsi_lathist *ilat = ddsi_lathist_new ();
+  for (uint32_t i = 0; i < DDSI_LATHIST_NBUCKETS; i++)
+  {
+    const uint32_t x = ddsrt_atomic_ld32 (&st->lat->bucket[i]);
+    ddsrt_atomic_st32 (&ilat->bucket[i], x - st->latsnap[i]);
+    st->latsnap[i] = x;
+  }
+  struct ddsi_lathist_summary s;
+  ddsi_lathist_summarize (ilat, &s);
+
+  struct scale_counts c;
+  read_counts (st, &c);
+  const uint64_t nw = c.nwritten - st->prev.nwritten, nr = c.nrecv - st->prev.nrecv;
+  if (out)
+  {
+    output_begin (out, "scale", NULL);
+    output_uint (out, "written", nw);
+    output_uint (out, "late", c.nlate - st->prev.nlate);
+    output_uint (out, "received", nr);
+    output_uint (out, "unmatched", nunmatched);
+    output_double (out, "cpu_per_sample_us", cpu_per_sample (&st->prev, &c));
+    output_lathist (out, "latency", ilat);
+    output_end (out);
+  }
+  ddsi_lathist_free (ilat);
+  if (nw > 0 || nr > 0)
+  {
+    printf ("%s scale wr %"PRIu64" late %"PRIu64" rd %"PRIu64, prefix, nw, c.nlate - st->prev.nlate, nr);
+    if (s.count > 0)
+      print_latency (&s);
+    printf (" cpu %.2fus/sample", cpu_per_sample (&st->prev, &c));
+    if (nunmatched > 0)
+      printf (" unmatched %"PRIu32, nunmatched);
+    printf ("\n");
+    output = true;
+  }
+  st->prev = c;
+  return output;
+}
+
+void scale_stop (struct scale_state *st)
+{
+  if (!st->started || ddsrt_atomic_ld32 (&st->stop))
+    return;
+  ddsrt_atomic_st32 (&st->stop, 1);
+  (void) ddsrt_thread_join (st->tid, NULL);
+  read_counts (st, &st->end);
+}
+
+bool scale_summary (struct scale_state *st, const char *prefix, struct output *out)
+{
+  dds_time_t tdisc;
+  ddsrt_mutex_lock (&st->lock);
+  tdisc = st->tdiscovered;
+  ddsrt_mutex_unlock (&st->lock);
+  printf ("%s scale summary topics %"PRIu32" writers %"PRIu32" readers %"PRIu32" create %.3fs", prefix,
+          st->params.ntopics, st->nwr, st->nrd, (double) (st->tcreated - st->tcreate) / 1e9);
+  if (tdisc == DDS_NEVER)
+    printf (" discovery incomplete");
+  else
+    printf (" discovery %.3fs", (double) (tdisc - st->tcreate) / 1e9);
+  if (st->started && ddsrt_atomic_ld32 (&st->stop))
+  {
+    struct ddsi_lathist_summary s;
+    ddsi_lathist_summarize (st->lat, &s);
+    printf (" written %"PRIu64" late %"PRIu64" received %"PRIu64, st->end.nwritten - st->start.nwritten, st->end.nlate - st->start.nlate, st->end.nrecv - st->start.nrecv);
+    if (s.count > 0)
+      print_latency (&s);
+    printf (" cpu %.2fus/sample", cpu_per_sample (&st->start, &st->end));
+    if (out)
+    {
+      output_begin (out, "scale_summary", NULL);
+      output_uint (out, "written", st->end.nwritten - st->start.nwritten);
+      output_uint (out, "late", st->end.nlate - st->start.nlate);
+      output_uint (out, "received", st->end.nrecv - st->start.nrecv);
+      output_double (out, "cpu_per_sample_us", cpu_per_sample (&st->start, &st->end));
+      if (tdisc != DDS_NEVER)
+        output_double (out, "match_s", (double) (tdisc - st->tcreate) / 1e9);
+      output_lathist (out, "latency", st->lat);
+      output_end (out);
+    }
+  }
+  printf ("\n");
+  fflush (stdout);
+  return tdisc != DDS_NEVER;
+}
+
+void scale_free (struct scale_state *st)
+{
+  scale_stop (st);
+  /* readers have listeners referencing st */
+  for (uint32_t i = 0; i < st->nrd; i++)
+    (void) dds_delete (st->rds[i].rd);
+  for (uint32_t i = 0; i < st->nwr; i++)
+    (void) dds_delete (st->wrs[i].wr);
+  for (uint32_t t = 0; t < st->params.ntopics; t++)
+    (void) dds_delete (st->tps[t]);
+  ddsi_lathist_free (st->lat);
+  ddsrt_mutex_destroy (&st->lock);
+  ddsrt_free (st->sample);
+  ddsrt_free (st->tps);
+  ddsrt_free (st->wrs);
+  ddsrt_free (st->rds);
+  ddsrt_free (st);
+}
@@ -0,0 +1,44 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#ifndef SCALE_H
+#define SCALE_H
+
+#include <stdbool.h>
+#include "dds/dds.h"
+#include "output.h"
+
+enum scale_ratedist {
+  SRD_FIXED,   /* every writer publishes at rate_lo */
+  SRD_UNIFORM, /* writer rates uniformly distributed over [rate_lo,rate_hi] */
+  SRD_EXP      /* writer rates exponentially distributed with mean rate_lo */
+};
+
+struct scale_params {
+  uint32_t ntopics;   /* number of topics */
+  uint32_t nwriters;  /* writers per topic */
+  uint32_t nreaders;  /* readers per topic */
+  enum scale_ratedist ratedist;
+  double rate_lo, rate_hi; /* in Hz */
+  bool poisson;       /* exponentially distributed intervals instead of periodic writes */
+  uint32_t wr_expect; /* readers each writer must match for discovery to be complete */
+  uint32_t rd_expect; /* writers each reader must match for discovery to be complete */
+};
+
+struct scale_state;
+
+struct scale_state *scale_new (dds_entity_t pp, dds_entity_t pub, dds_entity_t sub, const dds_topic_descriptor_t *desc, const char *tpname_prefix, const dds_qos_t *tpqos, const dds_qos_t *qos, const struct scale_params *params);
+void scale_start (struct scale_state *st, const void *sample, size_t samplesize, size_t seqoff, size_t keyvaloff);
+bool scale_print (struct scale_state *st, const char *prefix, struct output *out);
+void scale_stop (struct scale_state *st);
+bool scale_summary (struct scale_state *st, const char *prefix, struct output *out);
+void scale_free (struct scale_state *st);
+
+#endif
@@ -0,0 +1,60 @@
+// Copyright(c) 2024 ZettaScale Technology and others
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+// v. 1.0 which is available at
+// http://www.eclipse.org/org/documents/edl-v10.php.
+//
+// SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include "dds/ddsrt/bintrace.h"
+
+static void usage (const char *argv0)
+{
+  fprintf (stderr, "\
+usage: %s [INPUT [OUTPUT]]\n\
+\n\
+Converts a trace written with Tracing/OutputFormat set to \"binary\" to\n\
+the text format. INPUT and OUTPUT default to standard input and standard\n\
+output, \"-\" can be used to explicitly select these.\n", argv0);
+  exit (2);
+}
+
+int main (int argc, char **argv)
+{
+  FILE *in = stdin, *out = stdout;
+  if (argc > 3 || (argc > 1 && argv[1][0] == '-' && argv[1][1] != 0))
+    usage (argv[0]);
+  if (argc > 1 && strcmp (argv[1], "-") != 0 && (in = fopen (argv[1], "rb")) == NULL)
+  {
+    perror (argv[1]);
+    return 1;
+  }
+#ifdef _WIN32
+  else if (in == stdin)
+    (void) _setmode (_fileno (stdin), _O_BINARY);
+#endif
+  if (argc > 2 && strcmp (argv[2], "-") != 0 && (out = fopen (argv[2], "w")) == NULL)
+  {
+    perror (argv[2]);
+    return 1;
+  }
+  const dds_return_t ret = ddsrt_bintrace_decode (in, out);
+  if (ret != DDS_RETCODE_OK)
+    fprintf (stderr, "%s: %s\n", (argc > 1) ? argv[1] : "stdin", (ret == DDS_RETCODE_BAD_PARAMETER) ? "not a binary trace or corrupt" : dds_strretcode (ret));
+  if (in != stdin)
+    fclose (in);
+  if (out != stdout && fclose (out) != 0)
+    return 1;
+  return (ret == DDS_RETCODE_OK) ? 0 : 1;
+}
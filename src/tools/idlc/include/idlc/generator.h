@@ -33,6 +33,8 @@ typedef struct idlc_generator_config idlc_generator_config_t;
 
 typedef const idlc_option_t **(*idlc_generator_options_t)(void);
 typedef const idl_builtin_annotation_t **(*idlc_generator_annotations_t)(void);
+/* Output files must be opened with idl_fopen for "-f write-if-changed" to
+   leave unchanged files alone, and must be closed before returning */
 typedef int(*idlc_generate_t)(const idl_pstate_t *, const idlc_generator_config_t *);
 
 typedef struct idlc_generator_plugin idlc_generator_plugin_t;
@@ -67,6 +67,7 @@ static struct {
   bool default_nested;
   struct idlc_disable_warning_list disable_warnings;
   bool werror;
+  int write_if_changed;
   int help;
   int version;
 #ifdef DDS_HAS_TYPELIB
@@ -594,6 +595,11 @@ static const idlc_option_t *compopts[] = {
     IDLC_FLAG, { .flag = &config.case_sensitive }, 'f', "case-sensitive", "",
     "Switch to case-sensitive mode of operation. e.g. to allow constructed "
     "entities to contain fields that differ only in case." },
+  &(idlc_option_t){
+    IDLC_FLAG, { .flag = &config.write_if_changed }, 'f', "write-if-changed", "",
+    "Leave output files that would not change untouched, so that their "
+    "modification times are preserved and what depends on them is not "
+    "rebuilt." },
   &(idlc_option_t){
     IDLC_FLAG, { .flag = &config.help }, 'h', "", "",
     "Display available options." },
@@ -675,6 +681,73 @@ static const char *figure_language(int argc, char **argv)
 #define xstr(s) str(s)
 #define str(s) #s
 
+static int compile_file(
+  const idlc_generator_plugin_t *gen,
+  const idl_builtin_annotation_t **generator_annotations,
+  const char *file)
+{
+  idl_retcode_t ret;
+
+  config.file = (char *)file;
+  config.argv[config.argc] = config.file;
+  config.argc++;
+  retcode = IDL_RETCODE_OK;
+  ret = idlc_parse(generator_annotations);
+  config.argc--;
+  if (ret) {
+    /* assume other errors are reported by processor */
+    if (ret == IDL_RETCODE_NO_MEMORY)
+      fprintf(stderr, "Out of memory\n");
+    return -1;
+  } else if (config.compile) {
+    idlc_generator_config_t generator_config;
+    memset(&generator_config, 0, sizeof(generator_config));
+
+    ret = IDL_RETCODE_NO_MEMORY;
+    // Duplicate/Untaint the output dir to keep header guards neat
+    if(config.output_dir) {
+      if(!(generator_config.output_dir = idl_strdup(config.output_dir)))
+        goto err_config;
+      if(idl_untaint_path(generator_config.output_dir) < 0)
+        goto err_config;
+    }
+    // Root dir must be normalized because relativity comparison will be done
+    if(config.base_dir) {
+      if(idl_normalize_path(config.base_dir, &generator_config.base_dir) < 0)
+        goto err_config;
+    }
+#ifdef DDS_HAS_TYPELIB
+    if(!config.no_type_info)
+      generator_config.generate_type_info = true;
+    generator_config.generate_typeinfo_typemap = generate_type_meta_ser;
+#endif // DDS_HAS_TYPELIB
+    ret = IDL_RETCODE_OK;
+    /* handled here rather than in the generator, so that it applies to every
+       generator that opens its output files with idl_fopen */
+    if (config.write_if_changed)
+      idl_defer_writes();
+    if (gen->generate)
+      ret = gen->generate(pstate, &generator_config);
+    if (config.write_if_changed) {
+      idl_retcode_t commit_ret = idl_commit_writes(ret == IDL_RETCODE_OK);
+      ret = ret ? ret : commit_ret;
+    }
+
+err_config:
+    if(generator_config.output_dir)
+      idl_free(generator_config.output_dir);
+    if(generator_config.base_dir)
+      idl_free(generator_config.base_dir);
+    idl_delete_pstate(pstate);
+    pstate = NULL;
+    if (ret) {
+      fprintf(stderr, "Failed to compile '%s'\n", config.file);
+      return -1;
+    }
+  }
+  return 0;
+}
+
 int main(int argc, char *argv[])
 {
   int exit_code = EXIT_FAILURE;
@@ -746,22 +819,26 @@ int main(int argc, char *argv[])
       fprintf(stderr, "%s: conflicting options in generator %s\n", prog, lang);
       /* fall through */
     default:
-      print_usage(prog, "[OPTIONS] FILE");
+      print_usage(prog, "[OPTIONS] FILE...");
       goto err_parse_opts;
   }
 
   if (config.help) {
-    print_help(prog, "[OPTIONS] FILE", opts);
+    print_help(prog, "[OPTIONS] FILE...", opts);
   } else if (config.version) {
     print_version(prog);
   } else {
-    idl_retcode_t ret;
-    if (optind != (argc - 1)) {
-      print_usage(prog, "[OPTIONS] FILE");
+    if (optind == argc) {
+      print_usage(prog, "[OPTIONS] FILE...");
       goto err_parse_opts;
     }
-    config.file = argv[optind];
-    config.argv[config.argc++] = config.file;
+    /* stdin cannot be combined with other input files */
+    for (int i = optind; i < argc; i++) {
+      if (strcmp(argv[i], "-") == 0 && argc - optind > 1) {
+        print_usage(prog, "[OPTIONS] FILE...");
+        goto err_parse_opts;
+      }
+    }
 
     if (gen.generator_annotations) {
       generator_annotations = gen.generator_annotations();
@@ -769,49 +846,16 @@ int main(int argc, char *argv[])
       generator_annotations = NULL;
     }
 
-    if ((ret = idlc_parse(generator_annotations))) {
-      /* assume other errors are reported by processor */
-      if (ret == IDL_RETCODE_NO_MEMORY)
-        fprintf(stderr, "Out of memory\n");
-      goto err_parse;
-    } else if (config.compile) {
-      idlc_generator_config_t generator_config;
-      memset(&generator_config, 0, sizeof(generator_config));
-
-      // Duplicate/Untaint the output dir to keep header guards neat
-      if(config.output_dir) {
-        if(!(generator_config.output_dir = idl_strdup(config.output_dir)))
-          goto err_generate;
-        if(idl_untaint_path(generator_config.output_dir) < 0)
-          goto err_generate;
-      }
-      // Root dir must be normalized because relativity comparison will be done
-      if(config.base_dir) {
-        if(idl_normalize_path(config.base_dir, &generator_config.base_dir) < 0)
-          goto err_generate;
-      }
-#ifdef DDS_HAS_TYPELIB
-      if(!config.no_type_info)
-        generator_config.generate_type_info = true;
-      generator_config.generate_typeinfo_typemap = generate_type_meta_ser;
-#endif // DDS_HAS_TYPELIB
-      if (gen.generate)
-        ret = gen.generate(pstate, &generator_config);
-
-      if(generator_config.output_dir)
-        idl_free(generator_config.output_dir);
-      if(generator_config.base_dir)
-        idl_free(generator_config.base_dir);
-      if (ret) {
-        fprintf(stderr, "Failed to compile '%s'\n", config.file);
-        goto err_generate;
-      }
+    /* the files are compiled one after the other, sharing the loaded
+       generator and the preprocessor arguments */
+    for (int i = optind; i < argc; i++) {
+      if (compile_file(&gen, generator_annotations, argv[i]) != 0)
+        goto err_compile;
     }
   }
   exit_code = (has_warnings && config.werror) ? EXIT_FAILURE : EXIT_SUCCESS;
 
-err_generate:
-err_parse:
+err_compile:
 err_parse_opts:
   idl_free(opts);
 err_alloc_opts:
@@ -0,0 +1,74 @@
+#
+# Copyright(c) 2024 ZettaScale Technology and others
+#
+# This program and the accompanying materials are made available under the
+# terms of the Eclipse Public License v. 2.0 which is available at
+# http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+# v. 1.0 which is available at
+# http://www.eclipse.org/org/documents/edl-v10.php.
+#
+# SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+#
+
+# Compiles multiple files that include a common file in a single run of
+# IDLC with "-f write-if-changed" and checks that compiling them again only
+# rewrites the output of the file that was modified.
+
+if(NOT IDLC)
+  message(FATAL_ERROR "IDL compiler not set")
+endif()
+if(NOT WORKDIR)
+  message(FATAL_ERROR "Working directory not set")
+endif()
+
+file(REMOVE_RECURSE "${WORKDIR}")
+file(MAKE_DIRECTORY "${WORKDIR}")
+file(WRITE "${WORKDIR}/common.idl"
+  "module c { struct s { @key long k; string v; }; };\n")
+file(WRITE "${WORKDIR}/a.idl"
+  "#include \"common.idl\"\nmodule a { struct t { @key long k; c::s v; }; };\n")
+file(WRITE "${WORKDIR}/b.idl"
+  "#include \"common.idl\"\nmodule b { struct t { @key long k; sequence<c::s> v; }; };\n")
+
+set(_outputs common.c common.h a.c a.h b.c b.h)
+
+function(compile)
+  execute_process(
+    COMMAND "${IDLC}" -x final -f write-if-changed -o "${WORKDIR}"
+      "${WORKDIR}/common.idl" "${WORKDIR}/a.idl" "${WORKDIR}/b.idl"
+    RESULT_VARIABLE _result)
+  if(NOT _result EQUAL 0)
+    message(FATAL_ERROR "Compiling failed: ${_result}")
+  endif()
+  foreach(_output ${_outputs})
+    if(NOT EXISTS "${WORKDIR}/${_output}")
+      message(FATAL_ERROR "${_output} not generated")
+    endif()
+    if(EXISTS "${WORKDIR}/${_output}.tmp")
+      message(FATAL_ERROR "${_output}.tmp not removed")
+    endif()
+    file(TIMESTAMP "${WORKDIR}/${_output}" _stamp "%s")
+    set(stamp_${_output} "${_stamp}" PARENT_SCOPE)
+  endforeach()
+endfunction()
+
+compile()
+foreach(_output ${_outputs})
+  set(_first_${_output} "${stamp_${_output}}")
+endforeach()
+
+# timestamps have a resolution of a second
+execute_process(COMMAND "${CMAKE_COMMAND}" -E sleep 1.5)
+file(APPEND "${WORKDIR}/b.idl" "module b { struct u { long x; }; };\n")
+compile()
+
+foreach(_output common.c common.h a.c a.h)
+  if(NOT stamp_${_output} EQUAL _first_${_output})
+    message(FATAL_ERROR "${_output} rewritten while unchanged")
+  endif()
+endforeach()
+foreach(_output b.c b.h)
+  if(stamp_${_output} EQUAL _first_${_output})
+    message(FATAL_ERROR "${_output} not rewritten while changed")
+  endif()
+endforeach()
@@ -0,0 +1,61 @@
+#
+# Copyright(c) 2024 ZettaScale Technology and others
+#
+# This program and the accompanying materials are made available under the
+# terms of the Eclipse Public License v. 2.0 which is available at
+# http://www.eclipse.org/legal/epl-2.0, or the Eclipse Distribution License
+# v. 1.0 which is available at
+# http://www.eclipse.org/org/documents/edl-v10.php.
+#
+# SPDX-License-Identifier: EPL-2.0 OR BSD-3-Clause
+#
+
+# Generates an IDL file with TYPES types spread over MODULES modules and
+# compiles it with IDLC. Every struct references the typedefs through both
+# a fully scoped and a partially scoped name, so that most time goes into
+# declaring and resolving names. Run with the time limit set on the test,
+# anything that does not scale linearly in the number of types shows up as
+# a timeout. Also usable standalone for measurements, e.g.:
+#   cmake -DIDLC=.../idlc -DTYPES=100000 -DWORKDIR=/tmp -P Scale.cmake
+
+if(NOT IDLC)
+  message(FATAL_ERROR "IDL compiler not set")
+endif()
+if(NOT WORKDIR)
+  message(FATAL_ERROR "Working directory not set")
+endif()
+if(NOT TYPES)
+  set(TYPES 10000)
+endif()
+if(NOT MODULES)
+  set(MODULES 2)
+endif()
+
+# a typedef and a struct per iteration
+math(EXPR _last_module "${MODULES} - 1")
+math(EXPR _last_type "${TYPES} / ${MODULES} / 2 - 1")
+
+set(_idl "")
+foreach(_m RANGE ${_last_module})
+  string(APPEND _idl "module m${_m} {\n")
+  foreach(_t RANGE ${_last_type})
+    string(APPEND _idl
+      "  typedef long a${_t};\n"
+      "  struct t${_t} { @key a${_t} k; ::m0::a${_t} v; m${_m}::a${_t} w; };\n")
+  endforeach()
+  string(APPEND _idl "};\n")
+endforeach()
+
+file(MAKE_DIRECTORY "${WORKDIR}")
+file(WRITE "${WORKDIR}/scale.idl" "${_idl}")
+
+string(TIMESTAMP _start "%s")
+execute_process(
+  COMMAND "${IDLC}" -x final -o "${WORKDIR}" "${WORKDIR}/scale.idl"
+  RESULT_VARIABLE _result)
+string(TIMESTAMP _end "%s")
+if(NOT _result EQUAL 0)
+  message(FATAL_ERROR "Compiling ${TYPES} types failed: ${_result}")
+endif()
+math(EXPR _elapsed "${_end} - ${_start}")
+message(STATUS "Compiled ${TYPES} types in about ${_elapsed}s")
@@ -5077,4 +5077,5 @@ void clean_system(void)
 {
   if (sharp_filename != NULL)
     free(sharp_filename);
+  sharp_filename = NULL;
 }